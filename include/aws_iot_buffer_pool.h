@@ -0,0 +1,149 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_buffer_pool.h
+ * @brief Size class buffer pool shared by MQTT clients
+ *
+ * A pool hands out fixed size blocks from a few size classes, each carved from memory supplied by
+ * the application. MQTT clients initialized with a pool take their TX and RX buffers from it
+ * instead of embedding AWS_IOT_MQTT_TX_BUF_LEN and AWS_IOT_MQTT_RX_BUF_LEN bytes each, and borrow
+ * a larger block for the one packet that does not fit their own buffer.
+ *
+ * The SDK never allocates memory, so the pool cannot grow past the blocks it was given. Define
+ * DISABLE_IOT_MQTT_EMBEDDED_BUFFERS to drop the embedded buffers from AWS_IoT_Client, every
+ * client then needs a pool.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_BUFFER_POOL_H
+#define AWS_IOT_SDK_SRC_IOT_BUFFER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_error.h"
+#include "aws_iot_config.h"
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+#include "threads_interface.h"
+#endif
+
+#ifndef AWS_IOT_BUFFER_POOL_MAX_CLASSES
+#define AWS_IOT_BUFFER_POOL_MAX_CLASSES 4
+#endif
+
+/**
+ * @brief One size class of a buffer pool, as supplied by the application
+ */
+typedef struct {
+	size_t blockSize;		///< Size of each block, a multiple of sizeof(void *)
+	uint16_t blockCount;		///< Number of blocks
+	unsigned char *pMemory;		///< blockSize * blockCount bytes aligned for a pointer
+} IoT_Buffer_Pool_Class_t;
+
+/**
+ * @brief State of one size class
+ */
+typedef struct {
+	IoT_Buffer_Pool_Class_t config;	///< Blocks of the class
+	void *pFreeList;		///< First free block, each free block starts with the next one
+	uint16_t freeCount;		///< Blocks currently free
+	uint16_t minFreeCount;		///< Fewest blocks free at any time since init
+} IoT_Buffer_Pool_Size_Class_t;
+
+/**
+ * @brief Buffer pool
+ */
+typedef struct {
+	IoT_Buffer_Pool_Size_Class_t classes[AWS_IOT_BUFFER_POOL_MAX_CLASSES];	///< Size classes, smallest first
+	uint8_t classCount;		///< Number of size classes in use
+#ifdef _ENABLE_THREAD_SUPPORT_
+	IoT_Mutex_t lock;		///< Serializes acquire and release between clients
+#endif
+} IoT_Buffer_Pool_t;
+
+/**
+ * @brief Set up a pool over application supplied memory
+ *
+ * The classes are copied and sorted by block size, the memory they point to must stay valid as
+ * long as the pool is used.
+ *
+ * @param pPool pool to initialize
+ * @param pClasses size classes
+ * @param classCount number of size classes, at most AWS_IOT_BUFFER_POOL_MAX_CLASSES
+ *
+ * @return NULL_VALUE_ERROR, FAILURE if a class is empty, has a block size that is not a multiple of
+ * sizeof(void *) or misaligned memory, LIMIT_EXCEEDED_ERROR for too many classes, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_buffer_pool_init(IoT_Buffer_Pool_t *pPool, const IoT_Buffer_Pool_Class_t *pClasses,
+									 uint8_t classCount);
+
+/**
+ * @brief Release the resources of a pool
+ *
+ * Blocks still acquired are not tracked, the pool must not be used afterwards.
+ *
+ * @param pPool pool
+ *
+ * @return NULL_VALUE_ERROR or the result of destroying the lock
+ */
+IoT_Error_t aws_iot_buffer_pool_destroy(IoT_Buffer_Pool_t *pPool);
+
+/**
+ * @brief Take a block of at least minSize bytes
+ *
+ * The smallest class that fits and has a free block is used.
+ *
+ * @param pPool pool
+ * @param minSize bytes needed
+ * @param ppBuffer set to the block
+ * @param pBufferSize set to the size of the block, at least minSize
+ *
+ * @return NULL_VALUE_ERROR, LIMIT_EXCEEDED_ERROR if no class fitting minSize has a free block,
+ * otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_buffer_pool_acquire(IoT_Buffer_Pool_t *pPool, size_t minSize, unsigned char **ppBuffer,
+										size_t *pBufferSize);
+
+/**
+ * @brief Return a block taken with aws_iot_buffer_pool_acquire
+ *
+ * @param pPool pool the block was taken from
+ * @param pBuffer the block
+ *
+ * @return NULL_VALUE_ERROR, FAILURE if pBuffer is not the start of a block of the pool, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_buffer_pool_release(IoT_Buffer_Pool_t *pPool, unsigned char *pBuffer);
+
+/**
+ * @brief Number of free blocks of the class with the given block size
+ *
+ * @param pPool pool
+ * @param blockSize block size of the class
+ * @param pMinFreeCount set to the fewest blocks free since init, may be NULL
+ *
+ * @return free blocks, 0 if the pool has no class of that size
+ */
+uint16_t aws_iot_buffer_pool_get_free_count(IoT_Buffer_Pool_t *pPool, size_t blockSize, uint16_t *pMinFreeCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_BUFFER_POOL_H */
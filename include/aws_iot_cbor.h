@@ -0,0 +1,162 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_cbor.h
+ * @brief CBOR encoding and decoding of jsonStruct_t fields, a binary alternative to JSON for telemetry
+ *
+ * A set of fields is encoded as one CBOR map (RFC 7049) from the field keys to their values, using
+ * the same jsonStruct_t descriptors as the shadow JSON builder. Integers take the smallest CBOR
+ * head that holds them and floating point values the smallest of half, single and double precision
+ * that keeps them exact. Decoding updates the fields whose key and type match, like a shadow delta.
+ *
+ * The writer follows the JSON writer: it appends to a caller supplied buffer, output that does not
+ * fit is cut off and the length keeps counting what would have been written.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_CBOR_H_
+#define AWS_IOT_SDK_SRC_CBOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_error.h"
+#include "aws_iot_shadow_json_data.h"
+
+/**
+ * @brief CBOR writer state
+ */
+typedef struct {
+	uint8_t *pBuffer;	///< Destination, may be NULL when only measuring
+	size_t bufferSize;	///< Size of pBuffer
+	size_t length;		///< Bytes written so far, including those that did not fit
+} IoT_Cbor_Writer_t;
+
+/**
+ * @brief Start writing at the beginning of a buffer
+ *
+ * @param pWriter writer to initialize
+ * @param pBuffer destination buffer, may be NULL together with bufferSize 0
+ * @param bufferSize size of pBuffer
+ */
+void aws_iot_cbor_writer_init(IoT_Cbor_Writer_t *pWriter, uint8_t *pBuffer, size_t bufferSize);
+
+/**
+ * @brief Check whether everything written so far fits the buffer
+ *
+ * @param pWriter writer
+ *
+ * @return true if output was cut off
+ */
+bool aws_iot_cbor_writer_is_truncated(const IoT_Cbor_Writer_t *pWriter);
+
+/**
+ * @brief Append the head of a map of pairCount key value pairs, the pairs follow
+ */
+void aws_iot_cbor_writer_map(IoT_Cbor_Writer_t *pWriter, uint32_t pairCount);
+
+/**
+ * @brief Append the head of an array of itemCount items, the items follow
+ */
+void aws_iot_cbor_writer_array(IoT_Cbor_Writer_t *pWriter, uint32_t itemCount);
+
+/**
+ * @brief Append a UTF-8 text string
+ */
+void aws_iot_cbor_writer_text(IoT_Cbor_Writer_t *pWriter, const char *pText, size_t textLen);
+
+/**
+ * @brief Append a byte string
+ */
+void aws_iot_cbor_writer_bytes(IoT_Cbor_Writer_t *pWriter, const uint8_t *pData, size_t dataLen);
+
+/**
+ * @brief Append a signed integer
+ */
+void aws_iot_cbor_writer_int(IoT_Cbor_Writer_t *pWriter, int64_t value);
+
+/**
+ * @brief Append an unsigned integer
+ */
+void aws_iot_cbor_writer_uint(IoT_Cbor_Writer_t *pWriter, uint64_t value);
+
+/**
+ * @brief Append a double as the smallest floating point type that holds it exactly
+ */
+void aws_iot_cbor_writer_double(IoT_Cbor_Writer_t *pWriter, double value);
+
+/**
+ * @brief Append a float as a half precision value when that holds it exactly, single precision otherwise
+ */
+void aws_iot_cbor_writer_float(IoT_Cbor_Writer_t *pWriter, float value);
+
+/**
+ * @brief Append true or false
+ */
+void aws_iot_cbor_writer_bool(IoT_Cbor_Writer_t *pWriter, bool value);
+
+/**
+ * @brief Append null
+ */
+void aws_iot_cbor_writer_null(IoT_Cbor_Writer_t *pWriter);
+
+/**
+ * @brief Encode fields as a CBOR map from their keys to their values
+ *
+ * SHADOW_JSON_STRING values are NUL terminated strings. SHADOW_JSON_OBJECT fields hold JSON text
+ * and cannot be encoded.
+ *
+ * @param pBuffer destination buffer, may be NULL together with bufferSize 0 to measure
+ * @param bufferSize size of pBuffer
+ * @param pEncodedLength set to the length of the encoding, also when it does not fit
+ * @param count number of fields
+ * @param ppStructs the fields
+ *
+ * @return NULL_VALUE_ERROR if a field, its key or its data is NULL, SHADOW_JSON_ERROR for a
+ * SHADOW_JSON_OBJECT field, SHADOW_JSON_BUFFER_TRUNCATED if the encoding does not fit, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_cbor_encode_fields(uint8_t *pBuffer, size_t bufferSize, size_t *pEncodedLength, uint8_t count,
+									   jsonStruct_t *const *ppStructs);
+
+/**
+ * @brief Update fields from a CBOR map
+ *
+ * Every pair whose key is the key of a field and whose value fits the field type updates the
+ * field data and then calls its callback, with the CBOR encoded value in place of the JSON text.
+ * Integers are accepted by the floating point types, and floating point values by neither of the
+ * integer types. Other pairs are skipped.
+ *
+ * @param pBuffer the encoded map
+ * @param bufferLength length of the encoded map
+ * @param count number of fields
+ * @param ppStructs the fields
+ * @param pUpdatedCount set to the number of fields updated, may be NULL
+ *
+ * @return NULL_VALUE_ERROR, JSON_PARSE_ERROR if the buffer is not a well formed map of definite
+ * length, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_cbor_decode_fields(const uint8_t *pBuffer, size_t bufferLength, uint8_t count,
+									   jsonStruct_t *const *ppStructs, uint8_t *pUpdatedCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_CBOR_H_ */
@@ -156,7 +156,13 @@ typedef enum {
 	/** Some limit has been exceeded, e.g. the maximum number of subscriptions has been reached */
 			LIMIT_EXCEEDED_ERROR = -51,
 	/** Invalid input topic type */
-			INVALID_TOPIC_TYPE_ERROR = -52
+			INVALID_TOPIC_TYPE_ERROR = -52,
+	/** Condition variable or semaphore initialization, wait, signal or destroy failed */
+			THREAD_SYNC_ERROR = -53,
+	/** A timed wait on a condition variable or semaphore expired */
+			THREAD_WAIT_TIMEOUT_ERROR = -54,
+	/** A thread could not be created with the requested attributes or could not be joined */
+			THREAD_CREATE_ERROR = -55
 } IoT_Error_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_jobs_engine.h
+ * @brief Runs job executions on worker threads and keeps the next execution prefetched.
+ *
+ * The engine owns the notify-next and start-next subscriptions of one thing. Executions it
+ * receives are copied into a fixed table and handed to the application handler by
+ * aws_iot_jobs_engine_run_next, which the application calls from its own loop, or by the engine's
+ * worker threads (see aws_iot_jobs_engine_start_workers), which sleep until an execution is queued. The MQTT traffic stays on the thread that yields:
+ * aws_iot_jobs_engine_service sends the final status of finished executions, the latest progress
+ * reported by running handlers at most once per update interval, and a start-next request right
+ * behind every final status. The service hands out one execution per start-next, so the next job
+ * document is already on the device when the current update is accepted, without waiting for the
+ * notify-next round trip.
+ */
+
+#ifndef AWS_IOT_JOBS_ENGINE_H_
+#define AWS_IOT_JOBS_ENGINE_H_
+
+#ifdef DISABLE_IOT_JOBS
+#error "Jobs API is disabled"
+#endif
+
+#include "aws_iot_config.h"
+#include "aws_iot_jobs_interface.h"
+#include "aws_iot_json_utils.h"
+#include "timer_interface.h"
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+#include "threads_interface.h"
+#include "aws_iot_thread_pool.h"
+
+#if AWS_IOT_JOBS_ENGINE_MAX_WORKERS > AWS_IOT_THREAD_POOL_MAX_THREADS
+#error "AWS_IOT_JOBS_ENGINE_MAX_WORKERS must not exceed AWS_IOT_THREAD_POOL_MAX_THREADS"
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * One job execution as seen by a handler. The job document is NUL terminated and stays valid
+ * until the handler returns.
+ */
+typedef struct {
+	char jobId[MAX_SIZE_OF_JOB_ID + 1];
+	const char *pJobDocument;
+	size_t jobDocumentLength;
+	int64_t versionNumber;
+	int64_t executionNumber;
+} AwsIotJobsEngineJob;
+
+typedef struct AwsIotJobsEngine AwsIotJobsEngine;
+
+/**
+ * @brief Job handler, called on a worker thread
+ *
+ * The handler may report progress with aws_iot_jobs_engine_report_progress while it runs.
+ * \param pEngine the engine running the job
+ * \param pJob the job execution
+ * \param pContext the context passed in AwsIotJobsEngineParams
+ * \return the final status, JOB_EXECUTION_SUCCEEDED, JOB_EXECUTION_FAILED or
+ *   JOB_EXECUTION_REJECTED. Any other value is reported as JOB_EXECUTION_FAILED.
+ */
+typedef JobExecutionStatus (*AwsIotJobsEngineHandler)(AwsIotJobsEngine *pEngine, AwsIotJobsEngineJob *pJob,
+													   void *pContext);
+
+typedef enum {
+	JOBS_ENGINE_SLOT_FREE = 0,
+	JOBS_ENGINE_SLOT_QUEUED,
+	JOBS_ENGINE_SLOT_RUNNING,
+	JOBS_ENGINE_SLOT_FINISHED
+} AwsIotJobsEngineSlotState;
+
+typedef struct {
+	AwsIotJobsEngineJob job;
+	AwsIotJobsEngineSlotState state;
+	uint32_t sequence;
+	JobExecutionStatus finalStatus;
+	bool isProgressPending;
+	char jobDocument[AWS_IOT_JOBS_ENGINE_DOCUMENT_BYTES];
+	char statusDetails[AWS_IOT_JOBS_ENGINE_STATUS_DETAILS_BYTES];
+} AwsIotJobsEngineSlot;
+
+typedef struct {
+	char jobId[MAX_SIZE_OF_JOB_ID + 1];
+	int64_t executionNumber;
+} AwsIotJobsEngineCompletedJob;
+
+typedef enum {
+	JOBS_ENGINE_WORKERS_STOPPED = 0,
+	JOBS_ENGINE_WORKERS_RUNNING,
+	JOBS_ENGINE_WORKERS_STOPPING
+} AwsIotJobsEngineWorkersState;
+
+/**
+ * Parameters of a jobs engine
+ */
+typedef struct {
+	const char *pThingName;				///< Thing whose job executions are run, must stay valid
+	QoS qos;							///< QoS of the subscriptions and of the requests
+	AwsIotJobsEngineHandler handler;	///< Handler run for every job execution
+	void *pHandlerContext;				///< Passed to the handler
+	uint32_t updateIntervalMs;			///< Minimum time between two batches of progress updates
+} AwsIotJobsEngineParams;
+
+#define AwsIotJobsEngineParams_initializer { NULL, QOS0, NULL, NULL, AWS_IOT_JOBS_ENGINE_UPDATE_INTERVAL_MS }
+
+extern const AwsIotJobsEngineParams awsIotJobsEngineParamsDefault;
+
+/**
+ * State of a jobs engine. Allocated by the application, set up by aws_iot_jobs_engine_init.
+ */
+struct AwsIotJobsEngine {
+	AWS_IoT_Client *pClient;
+	AwsIotJobsEngineParams params;
+	AwsIotJobsEngineSlot slots[AWS_IOT_JOBS_ENGINE_MAX_JOBS];
+	AwsIotJobsEngineCompletedJob completed[AWS_IOT_JOBS_ENGINE_MAX_JOBS];
+	uint8_t nextCompleted;
+	uint32_t nextSequence;
+	bool isSubscribed;
+	bool isStartNextWanted;
+	bool isStartNextInFlight;
+	Timer startNextTimer;
+	Timer progressTimer;
+	char notifyNextTopic[MAX_JOB_TOPIC_LENGTH_BYTES];
+	char startNextAcceptedTopic[MAX_JOB_TOPIC_LENGTH_BYTES];
+	char startNextRejectedTopic[MAX_JOB_TOPIC_LENGTH_BYTES];
+	char requestTopic[MAX_JOB_TOPIC_LENGTH_BYTES];
+	char requestBuffer[MAX_SIZE_OF_JOB_REQUEST];
+	jsmn_parser parser;
+	jsmntok_t tokens[MAX_JOB_JSON_TOKEN_EXPECTED];
+	jsonTapeEntry_t tape[MAX_JOB_JSON_TOKEN_EXPECTED];
+#ifdef _ENABLE_THREAD_SUPPORT_
+	IoT_Mutex_t lock;
+	IoT_Thread_Pool_t workers;
+	AwsIotJobsEngineWorkersState workersState;
+#endif
+};
+
+/**
+ * @brief Set up a jobs engine
+ * \param pEngine the engine to set up
+ * \param pClient the client the engine sends and receives on
+ * \param pParams the engine parameters, copied
+ * \return NULL_VALUE_ERROR if a required input is NULL, MAX_SIZE_ERROR if the thing name is too
+ *   long, otherwise SUCCESS or the error initialising the engine lock
+ */
+IoT_Error_t aws_iot_jobs_engine_init(AwsIotJobsEngine *pEngine, AWS_IoT_Client *pClient,
+									 const AwsIotJobsEngineParams *pParams);
+
+/**
+ * @brief Subscribe to the notify-next and start-next replies and ask for the first execution
+ * The start-next request itself is sent by the next call to aws_iot_jobs_engine_service.
+ * \param pEngine the engine
+ * \return SUCCESS or the first error of aws_iot_jobs_subscribe_to_job_messages
+ */
+IoT_Error_t aws_iot_jobs_engine_start(AwsIotJobsEngine *pEngine);
+
+/**
+ * @brief Remove the subscriptions created by aws_iot_jobs_engine_start
+ * Executions already received are kept and can still be run and reported.
+ * \param pEngine the engine
+ * \return SUCCESS or the first error encountered
+ */
+IoT_Error_t aws_iot_jobs_engine_stop(AwsIotJobsEngine *pEngine);
+
+/**
+ * @brief Release the resources of an engine
+ * Workers must have been stopped before.
+ * \param pEngine the engine
+ * \return SUCCESS or the error destroying the engine lock
+ */
+IoT_Error_t aws_iot_jobs_engine_free(AwsIotJobsEngine *pEngine);
+
+/**
+ * @brief Run the oldest queued execution on the calling thread
+ * Called by the worker threads. The engine lock is not held while the handler runs.
+ * \param pEngine the engine
+ * \return true if an execution was run, false if none was queued
+ */
+bool aws_iot_jobs_engine_run_next(AwsIotJobsEngine *pEngine);
+
+/**
+ * @brief Report the progress of a running execution
+ * Only the latest details of an execution are kept, they are sent as an IN_PROGRESS update by
+ * the next batch and are also carried by the final update.
+ * \param pEngine the engine
+ * \param pJob the execution passed to the handler
+ * \param pStatusDetails a JSON object of string values
+ * \return NULL_VALUE_ERROR, LIMIT_EXCEEDED_ERROR if the details do not fit
+ *   AWS_IOT_JOBS_ENGINE_STATUS_DETAILS_BYTES, FAILURE if the execution is not running, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_jobs_engine_report_progress(AwsIotJobsEngine *pEngine, AwsIotJobsEngineJob *pJob,
+												const char *pStatusDetails);
+
+/**
+ * @brief Send the pending updates and the prefetching start-next request
+ * Must be called on the thread that yields the client, after each yield. Final updates are sent
+ * first, then progress updates when the update interval has elapsed, up to
+ * AWS_IOT_JOBS_ENGINE_MAX_UPDATES_PER_BATCH updates per call.
+ * \param pEngine the engine
+ * \return SUCCESS or the first publish error, the failed update is retried by the next call
+ */
+IoT_Error_t aws_iot_jobs_engine_service(AwsIotJobsEngine *pEngine);
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+/**
+ * @brief Start the worker threads running aws_iot_jobs_engine_run_next
+ * The workers are a thread pool owned by the engine. Every execution queued by the service wakes a
+ * worker, idle workers do not run. Each engine can have its own workers.
+ * \param pEngine the engine
+ * \param workerCount number of threads, 1 to AWS_IOT_JOBS_ENGINE_MAX_WORKERS
+ * \return SUCCESS, NULL_VALUE_ERROR, MAX_SIZE_ERROR for a bad worker count, FAILURE if the engine
+ *   already has workers, or the error of aws_iot_thread_pool_init
+ */
+IoT_Error_t aws_iot_jobs_engine_start_workers(AwsIotJobsEngine *pEngine, uint8_t workerCount);
+
+/**
+ * @brief Stop the worker threads once their current handler returns
+ * Executions still queued stay queued, for aws_iot_jobs_engine_run_next or the next workers.
+ * \param pEngine the engine
+ * \return SUCCESS, NULL_VALUE_ERROR, FAILURE if the engine has no workers, or the error of
+ *   aws_iot_thread_pool_destroy
+ */
+IoT_Error_t aws_iot_jobs_engine_stop_workers(AwsIotJobsEngine *pEngine);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_JOBS_ENGINE_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_json_tokenizer.h
+ * @brief Vectorised drop-in replacement for jsmn_parse
+ *
+ * The tokenizer produces exactly the tokens, return codes and parser state of jsmn_parse, but
+ * skips string bodies, whitespace runs and primitives 16 bytes at a time with SSE2 or NEON
+ * compares. Targets without either instruction set use a scalar scan.
+ *
+ * The gain is modest. On x86-64, tests/benchmark/aws_iot_bench_json_tokenizer measures between
+ * 1.0x and 1.45x the throughput of jsmn_parse on 4 KB shadow documents, depending on the host and
+ * the run. Measure on the target before enabling it.
+ *
+ * Defining ENABLE_IOT_JSON_SIMD makes the SDK tokenize every shadow document with it, otherwise
+ * aws_iot_json_parse is jsmn_parse.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_JSON_TOKENIZER_H_
+#define AWS_IOT_SDK_SRC_JSON_TOKENIZER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "jsmn.h"
+
+/**
+ * @brief Tokenize a JSON document with the vectorised scanner
+ *
+ * Same contract as jsmn_parse: the parser must have been initialised with jsmn_init, parsing stops at
+ * the first NUL byte and the parser state allows resuming after JSMN_ERROR_PART. Builds defining
+ * JSMN_STRICT or JSMN_PARENT_LINKS, and calls without a token array, are passed on to jsmn_parse.
+ *
+ * @param pParser jsmn parser state
+ * @param pJson JSON document
+ * @param length Length of the document
+ * @param pTokens Token array to fill
+ * @param maxTokens Number of entries in pTokens
+ *
+ * @return Number of tokens or a negative jsmnerr code, identical to jsmn_parse
+ */
+int aws_iot_json_tokenize(jsmn_parser *pParser, const char *pJson, size_t length, jsmntok_t *pTokens,
+						  unsigned int maxTokens);
+
+/**
+ * @brief Tokenizer used by the SDK
+ *
+ * aws_iot_json_tokenize when built with ENABLE_IOT_JSON_SIMD, jsmn_parse otherwise.
+ *
+ * @param pParser jsmn parser state
+ * @param pJson JSON document
+ * @param length Length of the document
+ * @param pTokens Token array to fill
+ * @param maxTokens Number of entries in pTokens
+ *
+ * @return Number of tokens or a negative jsmnerr code
+ */
+int aws_iot_json_parse(jsmn_parser *pParser, const char *pJson, size_t length, jsmntok_t *pTokens,
+					   unsigned int maxTokens);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_JSON_TOKENIZER_H_ */
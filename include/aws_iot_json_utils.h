@@ -50,6 +50,72 @@ extern "C" {
  */
 int8_t jsoneq(const char *json, jsmntok_t *tok, const char *s);
 
+/**
+ * @brief          Parse a decimal unsigned integer from a character range.
+ *
+ * Length bounded and locale independent, the whole range [pFirst, pLast) must be
+ * digits. Values above maxValue are rejected instead of wrapping.
+ *
+ * @param pFirst		first character of the number
+ * @param pLast			one past the last character of the number
+ * @param maxValue		largest accepted value
+ * @param pValue		address of the result, only updated on success
+ *
+ * @return         		SUCCESS - success
+ * @return				JSON_PARSE_ERROR - not a number or out of range
+ */
+IoT_Error_t parseUnsignedIntegerFromChars(const char *pFirst, const char *pLast, uint64_t maxValue,
+										  uint64_t *pValue);
+
+/**
+ * @brief          Parse a decimal signed integer from a character range.
+ *
+ * Like parseUnsignedIntegerFromChars with an optional leading '-'. A leading '-' is rejected
+ * when minValue is not negative, even for "-0".
+ *
+ * @param pFirst		first character of the number
+ * @param pLast			one past the last character of the number
+ * @param minValue		smallest accepted value
+ * @param maxValue		largest accepted value
+ * @param pValue		address of the result, only updated on success
+ *
+ * @return         		SUCCESS - success
+ * @return				JSON_PARSE_ERROR - not a number or out of range
+ */
+IoT_Error_t parseSignedIntegerFromChars(const char *pFirst, const char *pLast, int64_t minValue, int64_t maxValue,
+										int64_t *pValue);
+
+/**
+ * @brief          Parse a JSON number into a double from a character range.
+ *
+ * Numbers with up to 15 significant digits and a small exponent, the usual
+ * telemetry values, are converted exactly without strtod. Other numbers are
+ * handed to strtod, so results are always correctly rounded. The decimal point
+ * is '.' regardless of the locale.
+ *
+ * @param pFirst		first character of the number
+ * @param pLast			one past the last character of the number
+ * @param pValue		address of the result, only updated on success
+ *
+ * @return         		SUCCESS - success
+ * @return				JSON_PARSE_ERROR - not a JSON number or out of range
+ */
+IoT_Error_t parseDoubleFromChars(const char *pFirst, const char *pLast, double *pValue);
+
+/**
+ * @brief          Parse a JSON number into a float from a character range.
+ *
+ * Float counterpart of parseDoubleFromChars, falling back to strtof.
+ *
+ * @param pFirst		first character of the number
+ * @param pLast			one past the last character of the number
+ * @param pValue		address of the result, only updated on success
+ *
+ * @return         		SUCCESS - success
+ * @return				JSON_PARSE_ERROR - not a JSON number or out of range
+ */
+IoT_Error_t parseFloatFromChars(const char *pFirst, const char *pLast, float *pValue);
+
 /**
  * @brief          Parse a signed 32-bit integer value from a JSON node.
  *
@@ -205,6 +271,46 @@ IoT_Error_t parseStringValue(char *buf, size_t bufLen, const char *jsonString, j
  */
 jsmntok_t *findToken(const char *key, const char *jsonString, jsmntok_t *token);
 
+/**
+ * @brief          Navigation links of a parsed JSON token.
+ *
+ * A tape holds one entry per token returned by jsmn_parse. It lets lookups jump
+ * over a value instead of scanning the tokens it contains.
+ */
+typedef struct {
+	int32_t parent;	///< Index of the enclosing object or array, -1 for the top-level token
+	int32_t next;	///< Index of the first token after this token and everything it contains
+} jsonTapeEntry_t;
+
+/**
+ * @brief          Build the tape of parsed JSON tokens.
+ *
+ * Runs in a single pass over the tokens, without any memory beside the tape.
+ *
+ * @param pTokens		tokens filled by a successful jsmn_parse
+ * @param tokenCount	number of tokens returned by jsmn_parse
+ * @param pTape			array of at least tokenCount entries to fill
+ */
+void buildJsonTape(const jsmntok_t *pTokens, int32_t tokenCount, jsonTapeEntry_t *pTape);
+
+/**
+ * @brief          Find the JSON node associated with the given key in the given object, using a tape.
+ *
+ * Same as findToken, but each member value is skipped in one step, so the cost only
+ * depends on the number of members of the object.
+ *
+ * @param key			json key
+ * @param jsonString 	json string
+ * @param pTokens		tokens the tape was built from
+ * @param pTape			tape built by buildJsonTape
+ * @param token 		json token - pointer to JSON object in pTokens
+ *
+ * @return 				pointer to found property value
+ * @return 				NULL - not found
+ */
+jsmntok_t *findTokenOnTape(const char *key, const char *jsonString, jsmntok_t *pTokens, const jsonTapeEntry_t *pTape,
+						   jsmntok_t *token);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_json_writer.h
+ * @brief Single pass JSON writer used to build shadow and jobs documents
+ *
+ * The writer appends to a caller supplied buffer and keeps the write position, so building
+ * a document costs one pass over its bytes. Output follows snprintf semantics: the buffer
+ * is always NUL terminated, output that does not fit is cut off and the length keeps
+ * counting what would have been written, which lets callers size buffers with a NULL one.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_JSON_WRITER_H_
+#define AWS_IOT_SDK_SRC_JSON_WRITER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Buffer size that fits any number written by the format functions, including the NUL
+ */
+#define AWS_IOT_JSON_NUMBER_MAX_LEN 32
+
+/**
+ * @brief JSON writer state
+ */
+typedef struct {
+	char *pBuffer;       ///< Destination, may be NULL when only measuring
+	size_t bufferSize;   ///< Size of pBuffer including room for the NUL
+	size_t length;       ///< Characters written so far, including those that did not fit
+} IoT_Json_Writer_t;
+
+/**
+ * @brief Start writing at an offset of a buffer
+ *
+ * @param pWriter writer to initialize
+ * @param pBuffer destination buffer, may be NULL together with bufferSize 0
+ * @param bufferSize size of pBuffer
+ * @param offset number of characters already in pBuffer to keep
+ */
+void aws_iot_json_writer_init(IoT_Json_Writer_t *pWriter, char *pBuffer, size_t bufferSize, size_t offset);
+
+/**
+ * @brief Check whether everything written so far fits the buffer
+ *
+ * @param pWriter writer
+ *
+ * @return true if output was cut off
+ */
+bool aws_iot_json_writer_is_truncated(const IoT_Json_Writer_t *pWriter);
+
+/**
+ * @brief Append characters as they are
+ */
+void aws_iot_json_writer_raw(IoT_Json_Writer_t *pWriter, const char *pData, size_t dataLen);
+
+/**
+ * @brief Append a NUL terminated string as it is, e.g. a nested JSON document
+ */
+void aws_iot_json_writer_raw_string(IoT_Json_Writer_t *pWriter, const char *pData);
+
+/**
+ * @brief Append a single character
+ */
+void aws_iot_json_writer_char(IoT_Json_Writer_t *pWriter, char c);
+
+/**
+ * @brief Append a quoted string, escaping quotes, backslashes and control characters
+ */
+void aws_iot_json_writer_string(IoT_Json_Writer_t *pWriter, const char *pString);
+
+/**
+ * @brief Append a quoted and escaped key followed by ':'
+ */
+void aws_iot_json_writer_key(IoT_Json_Writer_t *pWriter, const char *pKey);
+
+/**
+ * @brief Append a signed integer
+ */
+void aws_iot_json_writer_int(IoT_Json_Writer_t *pWriter, int64_t value);
+
+/**
+ * @brief Append an unsigned integer
+ */
+void aws_iot_json_writer_uint(IoT_Json_Writer_t *pWriter, uint64_t value);
+
+/**
+ * @brief Append a double using the shortest representation that reads back to the same value
+ */
+void aws_iot_json_writer_double(IoT_Json_Writer_t *pWriter, double value);
+
+/**
+ * @brief Append a float using the shortest representation that reads back to the same float
+ */
+void aws_iot_json_writer_float(IoT_Json_Writer_t *pWriter, float value);
+
+/**
+ * @brief Append true or false
+ */
+void aws_iot_json_writer_bool(IoT_Json_Writer_t *pWriter, bool value);
+
+/**
+ * @brief Format a double with the fewest digits that parse back to the same value
+ *
+ * Uses the Grisu2 algorithm, which yields the shortest digits for almost all values and a
+ * correctly round-tripping one otherwise. Exponents are used below 1e-6 and from 1e21 on.
+ * JSON has no NaN or infinity, they are written as null.
+ *
+ * @param value number to format
+ * @param pBuf destination of at least AWS_IOT_JSON_NUMBER_MAX_LEN characters
+ *
+ * @return number of characters written, excluding the terminating NUL
+ */
+size_t aws_iot_json_format_double(double value, char *pBuf);
+
+/**
+ * @brief Format a float with the fewest digits that parse back to the same float
+ *
+ * @param value number to format
+ * @param pBuf destination of at least AWS_IOT_JSON_NUMBER_MAX_LEN characters
+ *
+ * @return number of characters written, excluding the terminating NUL
+ */
+size_t aws_iot_json_format_float(float value, char *pBuf);
+
+/**
+ * @brief Format an unsigned integer in decimal
+ *
+ * @param value number to format
+ * @param pBuf destination of at least AWS_IOT_JSON_NUMBER_MAX_LEN characters
+ *
+ * @return number of characters written, excluding the terminating NUL
+ */
+size_t aws_iot_json_format_uint(uint64_t value, char *pBuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_JSON_WRITER_H_ */
@@ -23,6 +23,9 @@
  *
  * It is expected that the macros below will be modified or replaced when porting to
  * specific hardware platforms as printf may not be the desired behavior.
+ *
+ * Defining ENABLE_IOT_LOG_ASYNC routes the macros to the asynchronous ring-buffer logger
+ * described in aws_iot_log_async.h instead of calling printf on the logging thread.
  */
 
 #ifndef _IOT_LOG_H
@@ -35,18 +38,45 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef ENABLE_IOT_LOG_ASYNC
+#include "aws_iot_log_async.h"
+
+/**
+ * @brief Module the log records of the current source file belong to.
+ *
+ * SDK source files define this before including any header.
+ */
+#ifndef IOT_LOG_MODULE
+#define IOT_LOG_MODULE IOT_LOG_MODULE_APP
+#endif
+
+/**
+ * @brief Capture a record into the asynchronous logger if the module level allows it.
+ */
+#define IOT_LOG_ASYNC_WRITE(level, pFunction, ...) \
+	{\
+	if(aws_iot_log_async_is_enabled(IOT_LOG_MODULE, level)) { \
+		(void) aws_iot_log_async_write(level, IOT_LOG_MODULE, pFunction, (uint16_t) __LINE__, __VA_ARGS__); \
+	} \
+	}
+#endif
+
 /**
  * @brief Debug level logging macro.
  *
  * Macro to expose function, line number as well as desired log message.
  */
 #ifdef ENABLE_IOT_DEBUG
+#ifdef ENABLE_IOT_LOG_ASYNC
+#define IOT_DEBUG(...) IOT_LOG_ASYNC_WRITE(IOT_LOG_LEVEL_DEBUG, __func__, __VA_ARGS__)
+#else
 #define IOT_DEBUG(...)    \
 	{\
 	printf("DEBUG:   %s L#%d ", __func__, __LINE__);  \
 	printf(__VA_ARGS__); \
 	printf("\n"); \
 	}
+#endif
 #else
 #define IOT_DEBUG(...)
 #endif
@@ -54,9 +84,25 @@ extern "C" {
 /**
  * @brief Debug level trace logging macro.
  *
- * Macro to print message function entry and exit
+ * Macro to print message function entry and exit.
+ * With ENABLE_IOT_PROFILE the same macros feed the per-function profiler in aws_iot_profile.h instead.
  */
-#ifdef ENABLE_IOT_TRACE
+#if defined(ENABLE_IOT_PROFILE)
+#include "aws_iot_profile.h"
+#define FUNC_ENTRY    \
+	{\
+	aws_iot_profile_enter(__func__);  \
+	}
+#define FUNC_EXIT    \
+	{\
+	aws_iot_profile_exit(__func__);  \
+	}
+#define FUNC_EXIT_RC(x)    \
+	{\
+	aws_iot_profile_exit(__func__);  \
+	return x; \
+	}
+#elif defined(ENABLE_IOT_TRACE)
 #define FUNC_ENTRY    \
 	{\
 	printf("FUNC_ENTRY:   %s L#%d \n", __func__, __LINE__);  \
@@ -83,11 +129,15 @@ extern "C" {
  * Macro to expose desired log message.  Info messages do not include automatic function names and line numbers.
  */
 #ifdef ENABLE_IOT_INFO
+#ifdef ENABLE_IOT_LOG_ASYNC
+#define IOT_INFO(...) IOT_LOG_ASYNC_WRITE(IOT_LOG_LEVEL_INFO, NULL, __VA_ARGS__)
+#else
 #define IOT_INFO(...)    \
 	{\
 	printf(__VA_ARGS__); \
 	printf("\n"); \
 	}
+#endif
 #else
 #define IOT_INFO(...)
 #endif
@@ -98,12 +148,16 @@ extern "C" {
  * Macro to expose function, line number as well as desired log message.
  */
 #ifdef ENABLE_IOT_WARN
+#ifdef ENABLE_IOT_LOG_ASYNC
+#define IOT_WARN(...) IOT_LOG_ASYNC_WRITE(IOT_LOG_LEVEL_WARN, __func__, __VA_ARGS__)
+#else
 #define IOT_WARN(...)   \
 	{ \
 	printf("WARN:  %s L#%d ", __func__, __LINE__);  \
 	printf(__VA_ARGS__); \
 	printf("\n"); \
 	}
+#endif
 #else
 #define IOT_WARN(...)
 #endif
@@ -114,12 +168,16 @@ extern "C" {
  * Macro to expose function, line number as well as desired log message.
  */
 #ifdef ENABLE_IOT_ERROR
+#ifdef ENABLE_IOT_LOG_ASYNC
+#define IOT_ERROR(...) IOT_LOG_ASYNC_WRITE(IOT_LOG_LEVEL_ERROR, __func__, __VA_ARGS__)
+#else
 #define IOT_ERROR(...)  \
 	{ \
 	printf("ERROR: %s L#%d ", __func__, __LINE__); \
 	printf(__VA_ARGS__); \
 	printf("\n"); \
 	}
+#endif
 #else
 #define IOT_ERROR(...)
 #endif
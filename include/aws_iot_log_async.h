@@ -0,0 +1,231 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_log_async.h
+ * @brief Asynchronous ring-buffer logging backend.
+ *
+ * When the SDK is built with ENABLE_IOT_LOG_ASYNC the IOT_* logging macros do not call printf
+ * on the calling thread. Instead the format string pointer and the raw arguments are captured
+ * into a fixed size record and pushed into a lock-free multi-producer ring buffer. Formatting
+ * happens later, when the ring is drained by aws_iot_log_async_flush() or by the background
+ * flusher, and the formatted lines are handed to a pluggable sink (stdout by default).
+ *
+ * Only the capture cost is paid on the MQTT/TLS hot path. If the ring is full the record is
+ * dropped and counted rather than blocking the caller.
+ *
+ * Every SDK module tags its records with a module ID so the level can be changed at runtime
+ * per module. The compile time ENABLE_IOT_<LEVEL> flags still decide which macros exist at all.
+ */
+
+#ifndef _IOT_LOG_ASYNC_H
+#define _IOT_LOG_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "aws_iot_error.h"
+
+/**
+ * @brief Number of records in the ring buffer. Must be a power of two.
+ */
+#ifndef AWS_IOT_LOG_ASYNC_RING_SIZE
+#define AWS_IOT_LOG_ASYNC_RING_SIZE 128
+#endif
+
+/**
+ * @brief Maximum number of arguments captured for one log record.
+ *
+ * Conversions beyond this count are emitted literally.
+ */
+#ifndef AWS_IOT_LOG_ASYNC_MAX_ARGS
+#define AWS_IOT_LOG_ASYNC_MAX_ARGS 8
+#endif
+
+/**
+ * @brief Bytes reserved per record for copies of string (%s) arguments.
+ *
+ * String arguments may not outlive the logging call so they are copied into the record.
+ * Longer strings are truncated.
+ */
+#ifndef AWS_IOT_LOG_ASYNC_STRING_BYTES
+#define AWS_IOT_LOG_ASYNC_STRING_BYTES 128
+#endif
+
+/**
+ * @brief Maximum length of one formatted log line handed to the sink.
+ */
+#ifndef AWS_IOT_LOG_ASYNC_LINE_LEN
+#define AWS_IOT_LOG_ASYNC_LINE_LEN 512
+#endif
+
+/**
+ * @brief Log levels in increasing order of severity
+ */
+typedef enum {
+	IOT_LOG_LEVEL_DEBUG = 0,
+	IOT_LOG_LEVEL_INFO = 1,
+	IOT_LOG_LEVEL_WARN = 2,
+	IOT_LOG_LEVEL_ERROR = 3,
+	IOT_LOG_LEVEL_NONE = 4
+} IoT_Log_Level_t;
+
+/**
+ * @brief Modules that can have their log level set independently
+ *
+ * Source files select their module by defining IOT_LOG_MODULE before including aws_iot_log.h.
+ * Application code defaults to IOT_LOG_MODULE_APP.
+ */
+typedef enum {
+	IOT_LOG_MODULE_APP = 0,
+	IOT_LOG_MODULE_MQTT = 1,
+	IOT_LOG_MODULE_SHADOW = 2,
+	IOT_LOG_MODULE_JOBS = 3,
+	IOT_LOG_MODULE_JSON = 4,
+	IOT_LOG_MODULE_NETWORK = 5,
+	IOT_LOG_MODULE_COUNT
+} IoT_Log_Module_t;
+
+/**
+ * @brief Sink that receives formatted log lines
+ *
+ * Called from the thread that drains the ring. The line is not NUL terminated past length
+ * guarantees and does not include the trailing newline.
+ *
+ * @param pContext the context registered with aws_iot_log_async_set_sink
+ * @param level level of the record
+ * @param pLine formatted line
+ * @param lineLen length of the formatted line
+ */
+typedef void (*IoT_Log_Sink_t)(void *pContext, IoT_Log_Level_t level, const char *pLine, size_t lineLen);
+
+/**
+ * @brief Runtime level per module. Read by the logging macros, use the setters below to change.
+ */
+extern volatile uint8_t aws_iot_log_async_module_level[IOT_LOG_MODULE_COUNT];
+
+/**
+ * @brief Check if a record of this level would be accepted for the module
+ */
+#define aws_iot_log_async_is_enabled(module, level) \
+	((uint8_t) (level) >= aws_iot_log_async_module_level[(module)])
+
+/**
+ * @brief Capture one log record into the ring buffer
+ *
+ * This is the target of the IOT_* macros. Arguments are captured according to the conversions
+ * in pFormat; nothing is formatted on the calling thread.
+ *
+ * @param level level of the record
+ * @param module module emitting the record
+ * @param pFunction name of the calling function, NULL if not to be printed
+ * @param line line number of the call
+ * @param pFormat printf style format string. Must be a string literal or otherwise outlive the ring
+ *
+ * @return SUCCESS if captured, FAILURE if the ring was full and the record was dropped
+ */
+IoT_Error_t aws_iot_log_async_write(IoT_Log_Level_t level, IoT_Log_Module_t module, const char *pFunction,
+									uint16_t line, const char *pFormat, ...)
+#if defined(__GNUC__)
+__attribute__((format(printf, 5, 6)))
+#endif
+;
+
+/**
+ * @brief Drain the ring buffer
+ *
+ * Formats every pending record and hands it to the sink. Safe to call from any thread; if another
+ * thread is already draining this call returns immediately.
+ *
+ * @return Number of records written to the sink
+ */
+size_t aws_iot_log_async_flush(void);
+
+/**
+ * @brief Replace the sink. Passing NULL restores the default stdout sink
+ *
+ * @param sink function receiving formatted lines
+ * @param pContext passed back to the sink on every call
+ */
+void aws_iot_log_async_set_sink(IoT_Log_Sink_t sink, void *pContext);
+
+/**
+ * @brief Set the minimum level for a module
+ *
+ * @param module module to change
+ * @param level records below this level are discarded before capture
+ *
+ * @return SUCCESS or NULL_VALUE_ERROR for an unknown module
+ */
+IoT_Error_t aws_iot_log_async_set_level(IoT_Log_Module_t module, IoT_Log_Level_t level);
+
+/**
+ * @brief Set the minimum level for all modules
+ *
+ * @param level records below this level are discarded before capture
+ */
+void aws_iot_log_async_set_level_all(IoT_Log_Level_t level);
+
+/**
+ * @brief Get the minimum level for a module
+ *
+ * @param module module to query
+ *
+ * @return Current level, IOT_LOG_LEVEL_NONE for an unknown module
+ */
+IoT_Log_Level_t aws_iot_log_async_get_level(IoT_Log_Module_t module);
+
+/**
+ * @brief Number of records dropped because the ring was full
+ *
+ * @return Dropped record count since start or last reset
+ */
+uint32_t aws_iot_log_async_get_dropped_count(void);
+
+/**
+ * @brief Reset the dropped record count
+ */
+void aws_iot_log_async_reset_dropped_count(void);
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+/**
+ * @brief Start the background flusher thread
+ *
+ * The flusher drains the ring every intervalMs. Implemented by the platform threading layer.
+ *
+ * @param intervalMs drain period in milliseconds
+ *
+ * @return SUCCESS or FAILURE if the thread could not be started
+ */
+IoT_Error_t aws_iot_log_async_start_flusher(uint32_t intervalMs);
+
+/**
+ * @brief Stop the background flusher thread, draining the ring one last time
+ *
+ * @return SUCCESS or FAILURE if no flusher was running
+ */
+IoT_Error_t aws_iot_log_async_stop_flusher(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _IOT_LOG_ASYNC_H
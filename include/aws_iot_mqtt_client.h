@@ -52,6 +52,7 @@ extern "C" {
 /* AWS Specific header files */
 #include "aws_iot_error.h"
 #include "aws_iot_config.h"
+#include "aws_iot_buffer_pool.h"
 
 /* Platform specific implementation header files */
 #include "network_interface.h"
@@ -61,8 +62,17 @@ extern "C" {
 #include "threads_interface.h"
 #endif
 
+#ifndef DISABLE_IOT_CLIENT_METRICS
+#include "aws_iot_mqtt_client_metrics.h"
+#endif
+
 #define MAX_PACKET_ID 65535
 
+/* Longest topic a publish handle holds, AWS IoT rejects topics longer than 256 bytes */
+#ifndef AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN
+#define AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN 256
+#endif
+
 typedef struct _Client AWS_IoT_Client;
 
 /**
@@ -88,10 +98,24 @@ typedef struct {
 	uint8_t isRetained;	///< Retained messages are \b NOT supported by the AWS IoT Service at the time of this SDK release.
 	uint8_t isDup;		///< Is this message a duplicate QoS > 0 message?  Handled automatically by the MQTT client.
 	uint16_t id;		///< Message sequence identifier.  Handled automatically by the MQTT client.
-	void *payload;		///< Pointer to MQTT message payload (bytes).
+	void *payload;		///< Pointer to MQTT message payload (bytes). Received payloads are followed by a NUL byte in the read buffer.
 	size_t payloadLen;	///< Length of MQTT payload.
 } IoT_Publish_Message_Params;
 
+/**
+ * @brief Publish Handle Type
+ *
+ * Topic, QoS and fixed header of a publish, encoded once by aws_iot_mqtt_publish_handle_create
+ * into a prefix owned by the handle and copied as is into every publish made with the handle.
+ *
+ */
+typedef struct {
+	QoS qos;								///< Quality of Service of the messages
+	uint32_t variableHeaderLen;				///< Remaining length of a publish without payload
+	uint16_t prefixLen;						///< Bytes of the prefix in use
+	unsigned char prefix[3 + AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN];	///< Fixed header byte, topic name length and topic name as sent
+} IoT_Publish_Handle;
+
 /**
  * @brief MQTT Version Type
  *
@@ -175,6 +199,9 @@ typedef struct {
 	bool isSSLHostnameVerify;			///< Client should perform server certificate hostname validation
 	iot_disconnect_handler disconnectHandler;	///< Callback to be invoked upon connection loss
 	void *disconnectHandlerData;			///< Data to pass as argument when disconnect handler is called
+	IoT_Buffer_Pool_t *pBufferPool;			///< Pool the TX and RX buffers are taken from, NULL to use the buffers embedded in the client
+	size_t writeBufSize;				///< Size of the TX buffer taken from pBufferPool, 0 for AWS_IOT_MQTT_TX_BUF_LEN
+	size_t readBufSize;				///< Size of the RX buffer taken from pBufferPool, 0 for AWS_IOT_MQTT_RX_BUF_LEN
 #ifdef _ENABLE_THREAD_SUPPORT_
 	bool isBlockOnThreadLockEnabled;		///< Timeout for Thread blocking calls. Set to 0 to block until lock is obtained. In milliseconds
 #endif
@@ -182,9 +209,9 @@ typedef struct {
 extern const IoT_Client_Init_Params iotClientInitParamsDefault;
 
 #ifdef _ENABLE_THREAD_SUPPORT_
-#define IoT_Client_Init_Params_initializer { true, NULL, 0, NULL, NULL, NULL, 2000, 20000, 5000, true, NULL, NULL, false }
+#define IoT_Client_Init_Params_initializer { true, NULL, 0, NULL, NULL, NULL, 2000, 20000, 5000, true, NULL, NULL, NULL, 0, 0, false }
 #else
-#define IoT_Client_Init_Params_initializer { true, NULL, 0, NULL, NULL, NULL, 2000, 20000, 5000, true, NULL, NULL }
+#define IoT_Client_Init_Params_initializer { true, NULL, 0, NULL, NULL, NULL, 2000, 20000, 5000, true, NULL, NULL, NULL, 0, 0 }
 #endif
 
 /**
@@ -221,18 +248,21 @@ typedef void (*pApplicationHandler_t)(AWS_IoT_Client *pClient, char *pTopicName,
 									  IoT_Publish_Message_Params *pParams, void *pClientData);
 
 /**
- * @brief MQTT Message Handler
+ * @brief MQTT Message Handlers
  *
  * Defining a type for MQTT Message Handlers.
  * Used to pass incoming data back to the application
  *
+ * Each field is a separate array indexed by subscription, so matching an incoming
+ * topic only walks the dense topic lengths and pointers.
+ *
  */
 typedef struct _MessageHandlers {
-	const char *topicName;
-	uint16_t topicNameLen;
-	QoS qos;
-	pApplicationHandler_t pApplicationHandler;
-	void *pApplicationHandlerData;
+	uint16_t topicNameLen[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	const char *topicName[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	QoS qos[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	pApplicationHandler_t pApplicationHandler[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	void *pApplicationHandlerData[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
 } MessageHandlers;   /* Message handlers are indexed by subscription topic */
 
 /**
@@ -243,7 +273,7 @@ typedef struct _MessageHandlers {
  *
  */
 typedef struct _ClientStatus {
-	ClientState clientState;
+	ClientState clientState;	/* Changed by compare and swap with thread support, see aws_iot_mqtt_set_client_state */
 	bool isPingOutstanding;
 	bool isAutoReconnectEnabled;
 } ClientStatus;
@@ -256,36 +286,48 @@ typedef struct _ClientStatus {
  *
  */
 typedef struct _ClientData {
-	uint16_t nextPacketId;
-
+	/* Hot state read on every packet, kept together at the start */
+	unsigned char *writeBuf;
+	unsigned char *readBuf;
+	/* Sizes of the buffers in use, which differ from the own
+	 * buffers below only while a packet too large for those
+	 * is handled in a buffer borrowed from the pool */
+	size_t writeBufSize;
+	size_t readBufSize;
+	size_t readBufIndex;
 	uint32_t packetTimeoutMs;
 	uint32_t commandTimeoutMs;
+	uint16_t nextPacketId;
 	uint16_t keepAliveInterval;
+#ifdef _ENABLE_THREAD_SUPPORT_
+	bool isBlockOnThreadLockEnabled;
+#endif
+	bool isWakeupPending;
 	uint32_t currentReconnectWaitInterval;
 	uint32_t counterNetworkDisconnected;
 
-	/* The below values are initialized with the
-	 * lengths of the TX/RX buffers and never modified
-	 * afterwards */
-	size_t writeBufSize;
-	size_t readBufSize;
-    size_t readBufIndex;
-	unsigned char writeBuf[AWS_IOT_MQTT_TX_BUF_LEN];
-	unsigned char readBuf[AWS_IOT_MQTT_RX_BUF_LEN];
+	MessageHandlers messageHandlers;
 
 #ifdef _ENABLE_THREAD_SUPPORT_
-	bool isBlockOnThreadLockEnabled;
-	IoT_Mutex_t state_change_mutex;
 	IoT_Mutex_t tls_read_mutex;
 	IoT_Mutex_t tls_write_mutex;
 #endif
 
 	IoT_Client_Connect_Params options;
 
-	MessageHandlers messageHandlers[AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS];
+	IoT_Buffer_Pool_t *pBufferPool;
+	unsigned char *pOwnWriteBuf;
+	unsigned char *pOwnReadBuf;
+	size_t ownWriteBufSize;
+	size_t ownReadBufSize;
+
 	iot_disconnect_handler disconnectHandler;
 
 	void *disconnectHandlerData;
+
+#ifndef DISABLE_IOT_CLIENT_METRICS
+	IoT_Client_Metrics_t metrics;
+#endif
 } ClientData;
 
 /**
@@ -295,12 +337,18 @@ typedef struct _ClientData {
  *
  */
 struct _Client {
-	Timer pingTimer;
-	Timer reconnectDelayTimer;
-
 	ClientStatus clientStatus;
 	ClientData clientData;
 	Network networkStack;
+
+	Timer pingTimer;
+	Timer reconnectDelayTimer;
+
+#ifndef DISABLE_IOT_MQTT_EMBEDDED_BUFFERS
+	/* Packet buffers of clients without a buffer pool, placed last so that they do not separate the state above */
+	unsigned char writeBufStorage[AWS_IOT_MQTT_TX_BUF_LEN];
+	unsigned char readBufStorage[AWS_IOT_MQTT_RX_BUF_LEN];
+#endif
 };
 
 /**
@@ -411,6 +459,60 @@ uint32_t aws_iot_mqtt_get_network_disconnected_count(AWS_IoT_Client *pClient);
  */
 void aws_iot_mqtt_reset_network_disconnected_count(AWS_IoT_Client *pClient);
 
+#ifndef DISABLE_IOT_CLIENT_METRICS
+/**
+ * @brief Get a snapshot of the client metrics
+ *
+ * Called to copy the packet counters and latency histograms of the client.
+ * When other threads are using the client the copy may mix values from before and after
+ * their current operation.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pMetrics Filled with the current metrics
+ *
+ * @return IoT_Error_t Type defining successful/failed API call
+ */
+IoT_Error_t aws_iot_mqtt_get_client_metrics(AWS_IoT_Client *pClient, IoT_Client_Metrics_t *pMetrics);
+
+/**
+ * @brief Reset the client metrics
+ *
+ * Called to set all counters and histograms of the client to zero
+ *
+ * @param pClient Reference to the IoT Client
+ *
+ * @return IoT_Error_t Type defining successful/failed API call
+ */
+IoT_Error_t aws_iot_mqtt_reset_client_metrics(AWS_IoT_Client *pClient);
+#endif
+
+#if defined(_ENABLE_THREAD_SUPPORT_) && defined(ENABLE_IOT_MUTEX_STATS)
+/**
+ * @brief Get the contention statistics of the client TLS locks
+ *
+ * Called to copy how often the TLS read and write mutexes were taken, how often a thread found
+ * them held and how long threads waited for and held them. With isBlockOnThreadLockEnabled false
+ * a held mutex makes the call fail, those failures are counted in failedTryCount.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pReadStats Filled with the statistics of the TLS read mutex, may be NULL
+ * @param pWriteStats Filled with the statistics of the TLS write mutex, may be NULL
+ *
+ * @return IoT_Error_t Type defining successful/failed API call
+ */
+IoT_Error_t aws_iot_mqtt_get_lock_stats(AWS_IoT_Client *pClient, IoT_Mutex_Stats_t *pReadStats,
+										IoT_Mutex_Stats_t *pWriteStats);
+
+/**
+ * @brief Reset the contention statistics of the client TLS locks
+ *
+ * @param pClient Reference to the IoT Client
+ *
+ * @return IoT_Error_t Type defining successful/failed API call
+ */
+IoT_Error_t aws_iot_mqtt_reset_lock_stats(AWS_IoT_Client *pClient);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
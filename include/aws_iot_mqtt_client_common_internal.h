@@ -85,6 +85,10 @@ typedef union {
 IoT_Error_t aws_iot_mqtt_internal_init_header(MQTTHeader *pHeader, MessageTypes message_type,
 											  QoS qos, uint8_t dup, uint8_t retained);
 
+IoT_Error_t aws_iot_mqtt_internal_serialize_publish_with_handle(unsigned char *pTxBuf, size_t txBufLen,
+																const IoT_Publish_Handle *pHandle, uint16_t packetId,
+																const unsigned char *pPayload, size_t payloadLen,
+																uint32_t *pSerializedLen);
 IoT_Error_t aws_iot_mqtt_internal_serialize_ack(unsigned char *pTxBuf, size_t txBufLen,
 												MessageTypes msgType, uint8_t dup, uint16_t packetId,
 												uint32_t *pSerializedLen);
@@ -105,6 +109,9 @@ void aws_iot_mqtt_internal_write_char(unsigned char **pptr, unsigned char c);
 void aws_iot_mqtt_internal_write_utf8_string(unsigned char **pptr, const char *string, uint16_t stringLen);
 
 IoT_Error_t aws_iot_mqtt_internal_flushBuffers( AWS_IoT_Client *pClient );
+IoT_Error_t aws_iot_mqtt_internal_grow_write_buffer(AWS_IoT_Client *pClient, size_t minSize);
+void aws_iot_mqtt_internal_restore_write_buffer(AWS_IoT_Client *pClient);
+void aws_iot_mqtt_internal_restore_read_buffer(AWS_IoT_Client *pClient);
 IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t length, Timer *pTimer);
 IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTimer, uint8_t *pPacketType);
 IoT_Error_t aws_iot_mqtt_internal_wait_for_read(AWS_IoT_Client *pClient, uint8_t packetType, Timer *pTimer);
@@ -119,6 +126,40 @@ IoT_Error_t aws_iot_mqtt_internal_deserialize_publish(uint8_t *dup, QoS *qos,
 IoT_Error_t aws_iot_mqtt_set_client_state(AWS_IoT_Client *pClient, ClientState expectedCurrentState,
 										  ClientState newState);
 
+/* Client state accesses outside aws_iot_mqtt_set_client_state, atomic with thread support */
+#ifdef _ENABLE_THREAD_SUPPORT_
+#define IOT_CLIENT_STATE_LOAD(pClient) __atomic_load_n(&((pClient)->clientStatus.clientState), __ATOMIC_ACQUIRE)
+#define IOT_CLIENT_STATE_STORE(pClient, state) \
+	__atomic_store_n(&((pClient)->clientStatus.clientState), (state), __ATOMIC_RELEASE)
+#else
+#define IOT_CLIENT_STATE_LOAD(pClient) ((pClient)->clientStatus.clientState)
+#define IOT_CLIENT_STATE_STORE(pClient, state) ((pClient)->clientStatus.clientState = (state))
+#endif
+
+#ifndef DISABLE_IOT_CLIENT_METRICS
+
+void aws_iot_mqtt_internal_metrics_record_duration(IoT_Client_Latency_Histogram_t *pHistogram, uint64_t startNs);
+
+void aws_iot_mqtt_internal_metrics_count_packet(IoT_Client_Packet_Counters_t *pCounters, uint8_t packetType,
+												size_t length);
+
+/* Metrics hooks, compiled out with DISABLE_IOT_CLIENT_METRICS */
+#define IOT_CLIENT_METRICS_TIMESTAMP(startNs) uint64_t startNs = get_monotonic_time_ns()
+#define IOT_CLIENT_METRICS_RECORD_DURATION(pClient, histogram, startNs) \
+	aws_iot_mqtt_internal_metrics_record_duration(&((pClient)->clientData.metrics.histogram), startNs)
+#define IOT_CLIENT_METRICS_COUNT_PACKET(pClient, direction, packetType, length) \
+	aws_iot_mqtt_internal_metrics_count_packet(&((pClient)->clientData.metrics.direction), packetType, length)
+#define IOT_CLIENT_METRICS_ADD(pClient, counter, value) ((pClient)->clientData.metrics.counter += (value))
+
+#else
+
+#define IOT_CLIENT_METRICS_TIMESTAMP(startNs)
+#define IOT_CLIENT_METRICS_RECORD_DURATION(pClient, histogram, startNs)
+#define IOT_CLIENT_METRICS_COUNT_PACKET(pClient, direction, packetType, length)
+#define IOT_CLIENT_METRICS_ADD(pClient, counter, value)
+
+#endif
+
 #ifdef _ENABLE_THREAD_SUPPORT_
 
 IoT_Error_t aws_iot_mqtt_client_lock_mutex(AWS_IoT_Client *pClient, IoT_Mutex_t *pMutex);
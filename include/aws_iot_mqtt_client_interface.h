@@ -63,6 +63,7 @@ extern "C" {
 * @brief Clean mqtt client from all dynamic memory allocate
 *
 * This function will free up memory that was dynamically allocated for the client.
+* TX and RX buffers taken from a buffer pool at init are returned to it.
 *
 * @param pClient MQTT Client that was previously created by calling aws_iot_mqtt_init
 * @return An IoT Error Type defining successful/failed freeing
@@ -74,10 +75,16 @@ extern "C" {
  *
  * Called to initialize the MQTT Client
  *
+ * When pInitParams->pBufferPool is set the TX and RX buffers are taken from the pool instead of
+ * the ones embedded in the client, and must be given back with aws_iot_mqtt_free. A received or
+ * published packet that does not fit then borrows a larger block from the pool for as long as
+ * it is handled.
+ *
  * @param pClient Reference to the IoT Client
  * @param pInitParams Pointer to MQTT connection parameters
  *
- * @return IoT_Error_t Type defining successful/failed API call
+ * @return IoT_Error_t Type defining successful/failed API call, LIMIT_EXCEEDED_ERROR if the pool
+ * has no free block for the buffers
  */
 IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, IoT_Client_Init_Params *pInitParams);
 
@@ -111,6 +118,44 @@ IoT_Error_t aws_iot_mqtt_connect(AWS_IoT_Client *pClient, IoT_Client_Connect_Par
 IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
 								 IoT_Publish_Message_Params *pParams);
 
+/**
+ * @brief Create a publish handle for repeated publishes on one topic
+ *
+ * Validates the topic once and encodes the fixed header, the topic length and a copy of
+ * the topic into the handle. Publishes made with aws_iot_mqtt_publish_with_handle skip
+ * validating and encoding the topic again, the send itself is the same as aws_iot_mqtt_publish.
+ *
+ * @param pHandle Handle to fill
+ * @param pTopicName Topic Name to publish to, copied into the handle
+ * @param topicNameLen Length of the topic name
+ * @param qos Quality of Service of the messages
+ * @param isRetained Retained flag of the messages
+ *
+ * @return NULL_VALUE_ERROR for a NULL or empty input, MAX_SIZE_ERROR if the topic is longer
+ * than AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN, FAILURE if the topic holds a wildcard,
+ * otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_mqtt_publish_handle_create(IoT_Publish_Handle *pHandle, const char *pTopicName,
+											   uint16_t topicNameLen, QoS qos, uint8_t isRetained);
+
+/**
+ * @brief Publish an MQTT message on the topic of a publish handle
+ *
+ * Same behavior as aws_iot_mqtt_publish with the topic and QoS of the handle.
+ * @note Call is blocking.  In the case of a QoS 1 handle the function returns after
+ * the receipt of the PUBACK control packet.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pHandle Handle created by aws_iot_mqtt_publish_handle_create
+ * @param pPayload Pointer to MQTT message payload (bytes)
+ * @param payloadLen Length of the payload
+ * @param pPacketId Set to the packet identifier of a QoS 1 publish, 0 for QoS 0. May be NULL
+ *
+ * @return An IoT Error Type defining successful/failed publish
+ */
+IoT_Error_t aws_iot_mqtt_publish_with_handle(AWS_IoT_Client *pClient, const IoT_Publish_Handle *pHandle,
+											 const void *pPayload, size_t payloadLen, uint16_t *pPacketId);
+
 /**
  * @brief Subscribe to an MQTT topic.
  *
@@ -191,6 +236,20 @@ IoT_Error_t aws_iot_mqtt_disconnect(AWS_IoT_Client *pClient);
  */
 IoT_Error_t aws_iot_mqtt_yield(AWS_IoT_Client *pClient, uint32_t timeout_ms);
 
+/**
+ * @brief Make a yield return early
+ *
+ * Called from any other thread, such as one running GPIO interrupt callbacks, when the application
+ * has work for the thread that yields. A yield in progress returns SUCCESS once it has handled the packet it is
+ * reading, without waiting for its timeout. When no yield is in progress the next one returns after
+ * its first pass. This lets applications yield with long timeouts and still react quickly to events.
+ *
+ * @param pClient Reference to the IoT Client
+ *
+ * @return An IoT Error Type defining successful/failed wakeup
+ */
+IoT_Error_t aws_iot_mqtt_wakeup(AWS_IoT_Client *pClient);
+
 /**
  * @brief MQTT Manual Re-Connection Function
  *
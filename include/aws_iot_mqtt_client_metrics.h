@@ -0,0 +1,115 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_mqtt_client_metrics.h
+ * @brief Runtime metrics kept per MQTT client
+ *
+ * Every AWS_IoT_Client carries counters of the packets and bytes it sent and received per MQTT
+ * packet type, latency histograms for the blocking request/response exchanges and the time spent
+ * in yield, subscription callbacks and the network connect (TCP and TLS handshake). Take a copy
+ * with aws_iot_mqtt_get_client_metrics() and clear them with aws_iot_mqtt_reset_client_metrics().
+ *
+ * Metrics cost a few hundred bytes per client. Define DISABLE_IOT_CLIENT_METRICS to compile them out.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_MQTT_CLIENT_METRICS_H
+#define AWS_IOT_SDK_SRC_IOT_MQTT_CLIENT_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aws_iot_error.h"
+
+/**
+ * @brief Number of packet type slots, indexed by the MQTT control packet type (1 = CONNECT ... 14 = DISCONNECT)
+ */
+#define AWS_IOT_CLIENT_METRICS_PACKET_TYPES 16
+
+/**
+ * @brief Number of buckets in a latency histogram
+ *
+ * Bucket 0 counts samples below 16 microseconds, bucket i counts samples in [16 * 2^(i-1), 16 * 2^i)
+ * microseconds and the last bucket counts everything above.
+ */
+#define AWS_IOT_CLIENT_METRICS_HISTOGRAM_BUCKETS 20
+
+/**
+ * @brief Upper bound of the first histogram bucket in microseconds
+ */
+#define AWS_IOT_CLIENT_METRICS_HISTOGRAM_FIRST_BOUND_US 16
+
+/**
+ * @brief Log2 latency histogram
+ */
+typedef struct {
+	uint32_t count;     ///< Number of samples
+	uint64_t sumUs;     ///< Sum of all samples in microseconds
+	uint32_t maxUs;     ///< Largest sample in microseconds
+	uint32_t buckets[AWS_IOT_CLIENT_METRICS_HISTOGRAM_BUCKETS]; ///< Samples per bucket, not cumulative
+} IoT_Client_Latency_Histogram_t;
+
+/**
+ * @brief Packet and byte counters for one direction
+ */
+typedef struct {
+	uint32_t packets[AWS_IOT_CLIENT_METRICS_PACKET_TYPES];  ///< Complete packets per MQTT packet type
+	uint64_t bytes[AWS_IOT_CLIENT_METRICS_PACKET_TYPES];    ///< Bytes including fixed header per MQTT packet type
+} IoT_Client_Packet_Counters_t;
+
+/**
+ * @brief Metrics of one MQTT client
+ */
+typedef struct {
+	IoT_Client_Packet_Counters_t sent;                  ///< Packets written to the network
+	IoT_Client_Packet_Counters_t received;              ///< Packets read from the network
+	IoT_Client_Latency_Histogram_t publishAckLatency;   ///< QoS1 PUBLISH sent to PUBACK received
+	IoT_Client_Latency_Histogram_t subscribeAckLatency; ///< SUBSCRIBE sent to SUBACK received
+	IoT_Client_Latency_Histogram_t yieldDuration;       ///< Time spent in aws_iot_mqtt_yield
+	IoT_Client_Latency_Histogram_t callbackDuration;    ///< Time spent in subscription callbacks
+	IoT_Client_Latency_Histogram_t networkConnectDuration; ///< Successful network connect, including the TLS handshake
+	uint32_t reconnectAttempts;                         ///< Calls to aws_iot_mqtt_attempt_reconnect
+	uint32_t reconnectSuccesses;                        ///< Reconnect attempts that completed
+	uint32_t droppedOversizeMessages;                   ///< Incoming packets dropped because they did not fit the RX buffer
+	uint64_t droppedOversizeBytes;                      ///< Remaining length of the dropped packets
+} IoT_Client_Metrics_t;
+
+/**
+ * @brief Render a metrics snapshot as text
+ *
+ * One "name{labels} value" line per value, in the Prometheus text exposition format, so the
+ * output can be scraped or read by a person. Histograms are rendered with cumulative buckets.
+ *
+ * @param pMetrics snapshot to render
+ * @param pClientLabel value of the client label on every line, may be NULL
+ * @param pBuf destination buffer
+ * @param bufLen size of the destination buffer
+ * @param pWrittenLen set to the number of characters written, excluding the terminating NUL
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR or MAX_SIZE_ERROR if pBuf was too small, the output then holds the
+ *         lines that fit
+ */
+IoT_Error_t aws_iot_mqtt_client_metrics_to_text(const IoT_Client_Metrics_t *pMetrics, const char *pClientLabel,
+												char *pBuf, size_t bufLen, size_t *pWrittenLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_MQTT_CLIENT_METRICS_H */
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_profile.h
+ * @brief Per-function profiling driven by FUNC_ENTRY and FUNC_EXIT_RC.
+ *
+ * When the SDK is built with ENABLE_IOT_PROFILE the FUNC_ENTRY/FUNC_EXIT/FUNC_EXIT_RC macros
+ * stop printing trace lines and instead timestamp function entry and exit with
+ * get_monotonic_time_ns(). Each thread keeps its own call stack and its own table of call counts,
+ * inclusive time and maximum latency per function, so recording takes no lock. The report API
+ * merges the per-thread tables and returns the functions with the most inclusive time.
+ *
+ * A function that returns without FUNC_EXIT_RC leaves its frame on the stack; the frame is
+ * discarded, unmeasured, when an enclosing function exits.
+ */
+
+#ifndef _IOT_PROFILE_H
+#define _IOT_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum nesting of profiled calls tracked per thread
+ */
+#ifndef AWS_IOT_PROFILE_STACK_DEPTH
+#define AWS_IOT_PROFILE_STACK_DEPTH 32
+#endif
+
+/**
+ * @brief Number of distinct functions tracked per thread. Must be a power of two.
+ */
+#ifndef AWS_IOT_PROFILE_MAX_FUNCTIONS
+#define AWS_IOT_PROFILE_MAX_FUNCTIONS 128
+#endif
+
+/**
+ * @brief Number of threads that can record profiling data
+ */
+#ifndef AWS_IOT_PROFILE_MAX_THREADS
+#define AWS_IOT_PROFILE_MAX_THREADS 8
+#endif
+
+/**
+ * @brief Aggregated profile of one function
+ */
+typedef struct {
+	const char *pFunction;   ///< Function name as given by __func__
+	uint32_t callCount;      ///< Number of completed calls
+	uint64_t totalNs;        ///< Inclusive time spent in the function
+	uint64_t maxNs;          ///< Longest single call
+} IoT_Profile_Entry_t;
+
+/**
+ * @brief Record entry into a function. Target of FUNC_ENTRY.
+ *
+ * @param pFunction __func__ of the function being entered
+ */
+void aws_iot_profile_enter(const char *pFunction);
+
+/**
+ * @brief Record exit from a function. Target of FUNC_EXIT and FUNC_EXIT_RC.
+ *
+ * @param pFunction __func__ of the function returning
+ */
+void aws_iot_profile_exit(const char *pFunction);
+
+/**
+ * @brief Get the hottest functions across all threads
+ *
+ * Merges the per-thread tables and sorts by inclusive time, highest first. Values recorded by
+ * other threads while the report is built may be partially included.
+ *
+ * @param pEntries array filled with the report
+ * @param maxEntries size of pEntries
+ *
+ * @return Number of entries written
+ */
+size_t aws_iot_profile_get_report(IoT_Profile_Entry_t *pEntries, size_t maxEntries);
+
+/**
+ * @brief Print the hottest functions with printf
+ *
+ * @param maxEntries number of functions to print
+ */
+void aws_iot_profile_print_report(size_t maxEntries);
+
+/**
+ * @brief Clear all recorded profiling data
+ *
+ * Call-in-progress frames are kept so calls spanning the reset are still measured.
+ */
+void aws_iot_profile_reset(void);
+
+/**
+ * @brief Number of calls not recorded because a stack, function table or thread table was full
+ *
+ * @return Count of lost samples since start or last reset
+ */
+uint32_t aws_iot_profile_get_overflow_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _IOT_PROFILE_H
@@ -20,12 +20,17 @@
 extern "C" {
 #endif
 
-#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_client.h"
 
 IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions_t action,
 										   const char *pJsonDocumentToBeSent, size_t jsonSize, fpActionCallback_t callback,
 										   void *pCallbackContext, uint32_t timeout_seconds, bool isSticky);
 
+IoT_Error_t aws_iot_shadow_internal_client_action(ShadowClient_t *pShadow, const char *pThingName,
+												  ShadowActions_t action, const char *pJsonDocumentToBeSent,
+												  size_t jsonSize, fpActionCallback_t callback,
+												  void *pCallbackContext, uint32_t timeout_seconds, bool isSticky);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,588 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_SHADOW_CLIENT_H_
+#define AWS_IOT_SDK_SRC_IOT_SHADOW_CLIENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file aws_iot_shadow_client.h
+ * @brief Shadow client context, for running several shadow clients in one process
+ *
+ * A ShadowClient_t owns everything the shadow SDK keeps between calls: the MQTT client, the thing name and client
+ * id, the pending acknowledgments, the subscriptions, the delta handlers, the receive buffer and the JSON tokens,
+ * the last received version, the reported cache, the coalesced updates and the mirrors. Received messages are parsed
+ * in place in the read buffer of the MQTT client. Every function of
+ * aws_iot_shadow_interface.h has an aws_iot_shadow_client_ counterpart taking the context as first argument; the
+ * former work on a default context bound to the MQTT client they are given.
+ *
+ * A context is not thread safe. Each context must be used by one thread at a time, different contexts can be used
+ * from different threads concurrently. Each context needs its own AWS_IoT_Client.
+ *
+ * Like AWS_IoT_Client the struct is public so that it can be allocated statically, its members are not part of
+ * the API.
+ */
+
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_config.h"
+#include "timer_interface.h"
+#include "jsmn.h"
+#include "aws_iot_json_utils.h"
+#include "aws_iot_shadow_schema.h"
+
+#ifndef MAX_SHADOW_REPORTED_CACHE_ENTRIES
+#define MAX_SHADOW_REPORTED_CACHE_ENTRIES 16
+#endif
+#ifndef MAX_SHADOW_COALESCED_UPDATES
+#define MAX_SHADOW_COALESCED_UPDATES 4
+#endif
+#ifndef MAX_SHADOW_COALESCED_FIELDS
+#define MAX_SHADOW_COALESCED_FIELDS 16
+#endif
+#ifndef MAX_SHADOW_COALESCED_CALLBACKS
+#define MAX_SHADOW_COALESCED_CALLBACKS 8
+#endif
+#ifndef SHADOW_COALESCED_UPDATE_BUFFER_BYTES
+#define SHADOW_COALESCED_UPDATE_BUFFER_BYTES 512
+#endif
+#ifndef SHADOW_COALESCE_WINDOW_MS
+#define SHADOW_COALESCE_WINDOW_MS 200
+#endif
+#ifndef MAX_SHADOW_MIRRORS
+#define MAX_SHADOW_MIRRORS 2
+#endif
+#ifndef MAX_SHADOW_MIRROR_FIELDS
+#define MAX_SHADOW_MIRROR_FIELDS 32
+#endif
+#ifndef SHADOW_MIRROR_BUFFER_BYTES
+#define SHADOW_MIRROR_BUFFER_BYTES 1024
+#endif
+#ifndef SHADOW_MIRROR_MAX_PATH_LENGTH
+#define SHADOW_MIRROR_MAX_PATH_LENGTH 64
+#endif
+#ifndef MAX_SHADOW_TOPIC_TABLES
+#define MAX_SHADOW_TOPIC_TABLES 4
+#endif
+
+#define MAX_TOPICS_AT_ANY_GIVEN_TIME 2*MAX_THINGNAME_HANDLED_AT_ANY_GIVEN_TIME
+/* Quotes, colon and comma around every field plus the state, section and client token framing */
+#define COALESCED_DOCUMENT_OVERHEAD (4 * MAX_SHADOW_COALESCED_FIELDS + 64 + MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE)
+#define SHADOW_MIRROR_MAX_FILE_PATH_LENGTH 128
+/* Quotes, colon and comma around every field plus the version and section framing */
+#define SHADOW_MIRROR_SNAPSHOT_OVERHEAD (4 * MAX_SHADOW_MIRROR_FIELDS + 64)
+/* get, update and delete each with an accepted and a rejected topic, plus update/delta */
+#define SHADOW_TOPIC_COUNT 10
+#define SHADOW_TOPIC_STRING_COUNT 7
+/* "$aws/things/", "/shadow/", the longest suffix "update/accepted" and the terminator */
+#define SHADOW_TOPIC_TABLE_BYTES (SHADOW_TOPIC_STRING_COUNT * (MAX_SIZE_OF_THING_NAME + 36))
+
+/**
+ * @brief Action waiting for its accepted or rejected response
+ */
+typedef struct {
+	char clientTokenID[MAX_SIZE_CLIENT_ID_WITH_SEQUENCE];
+	uint32_t tokenSequence;
+	bool hasTokenSequence;
+	char thingName[MAX_SIZE_OF_THING_NAME];
+	ShadowActions_t action;
+	fpActionCallback_t callback;
+	void *pCallbackContext;
+	bool isFree;
+	Timer timer;
+} ToBeReceivedAckRecord_t;
+
+/**
+ * @brief Key or dotted path registered on the delta topic
+ */
+typedef struct {
+	const char *pKey;
+	void *pStruct;
+	jsonStructCallback_t callback;
+	bool isFree;
+	bool isPath;
+} JsonTokenTable_t;
+
+/**
+ * @brief Accepted or rejected topic subscribed to, shared by the actions waiting on it
+ *
+ * The record is the handler data of its subscription, the action and status of its messages are known from it.
+ */
+typedef struct {
+	char Topic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	uint8_t count;
+	bool isFree;
+	bool isSticky;
+	struct _ShadowClient *pShadow;
+	ShadowActions_t action;
+	Shadow_Ack_Status_t status;
+	bool isMyThing;
+} SubscriptionRecord_t;
+
+/**
+ * @brief JSON parser, the tokens of the last parsed document and their tape
+ */
+typedef struct {
+	jsmn_parser parser;
+	jsmntok_t tokens[MAX_JSON_TOKEN_EXPECTED];
+	jsonTapeEntry_t tape[MAX_JSON_TOKEN_EXPECTED];
+} ShadowJsonParser_t;
+
+/**
+ * @brief Acknowledged reported value, numbers are kept widened, strings and objects as a hash of their JSON text
+ */
+typedef union {
+	int64_t i;
+	uint64_t u;
+	double d;
+	uint32_t hash;
+} ReportedValue_t;
+
+/**
+ * @brief Key registered with the reported cache
+ */
+typedef struct {
+	jsonStruct_t *pStruct;
+	double epsilon;
+	ReportedValue_t acked;
+	bool hasAckedValue;
+	bool isForced;
+} ReportedCacheEntry_t;
+
+/**
+ * @brief State of a coalesced update slot
+ */
+typedef enum {
+	COALESCED_UPDATE_FREE, COALESCED_UPDATE_PENDING, COALESCED_UPDATE_IN_FLIGHT
+} CoalescedUpdateState_t;
+
+/**
+ * @brief Member of a coalesced update, key and value are offsets in the update buffer
+ */
+typedef struct {
+	uint8_t section;
+	uint16_t keyOffset;
+	uint16_t keyLength;
+	uint16_t valueOffset;
+	uint16_t valueLength;
+} CoalescedField_t;
+
+/**
+ * @brief Callback of one of the updates merged into a coalesced update
+ */
+typedef struct {
+	fpActionCallback_t callback;
+	void *pContextData;
+} CoalescedCallback_t;
+
+/**
+ * @brief Updates to one thing merged during a window
+ */
+typedef struct {
+	CoalescedUpdateState_t state;
+	char thingName[MAX_SIZE_OF_THING_NAME];
+	Timer windowTimer;
+	uint8_t timeoutSeconds;
+	bool isPersistentSubscribe;
+	uint8_t fieldCount;
+	uint8_t callbackCount;
+	uint16_t bufferUsed;
+	CoalescedField_t fields[MAX_SHADOW_COALESCED_FIELDS];
+	CoalescedCallback_t callbacks[MAX_SHADOW_COALESCED_CALLBACKS];
+	char buffer[SHADOW_COALESCED_UPDATE_BUFFER_BYTES];
+} CoalescedUpdate_t;
+
+/**
+ * @brief Mirrored leaf value, stored as its path immediately followed by its value, strings keep their quotes
+ */
+typedef struct {
+	uint16_t offset;
+	uint16_t valueLength;
+	uint8_t pathLength;
+	uint8_t section;
+} MirrorField_t;
+
+/**
+ * @brief In-memory copy of the shadow of one thing
+ */
+typedef struct {
+	bool isUsed;
+	bool hasDocument;
+	bool isDirty;
+	char thingName[MAX_SIZE_OF_THING_NAME];
+	uint32_t version;
+	char snapshotFile[SHADOW_MIRROR_MAX_FILE_PATH_LENGTH];
+	uint32_t snapshotIntervalMs;
+	Timer snapshotTimer;
+	uint16_t fieldCount;
+	uint16_t bufferUsed;
+	MirrorField_t fields[MAX_SHADOW_MIRROR_FIELDS];
+	char buffer[SHADOW_MIRROR_BUFFER_BYTES];
+} ShadowMirror_t;
+
+/**
+ * @brief Location of one topic in the storage of a topic table
+ */
+typedef struct {
+	uint16_t offset;
+	uint16_t length;
+} ShadowTopicSpan_t;
+
+/**
+ * @brief Shadow topics of one thing, built once and then indexed by action and response type
+ *
+ * Only the accepted, rejected and delta topics are stored, each NUL terminated. The topic an
+ * action is published on is the start of its accepted topic.
+ */
+typedef struct {
+	bool isUsed;
+	char thingName[MAX_SIZE_OF_THING_NAME];
+	ShadowTopicSpan_t topics[SHADOW_TOPIC_COUNT];
+	char storage[SHADOW_TOPIC_TABLE_BYTES];
+} ShadowTopicTable_t;
+
+/**
+ * @brief Shadow client context
+ */
+typedef struct _ShadowClient {
+	AWS_IoT_Client *pMqttClient;
+	char myThingName[MAX_SIZE_OF_THING_NAME];
+	char mqttClientID[MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES];
+	uint16_t mqttClientIDLength;
+	char deltaTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	char deleteAcceptedTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	uint32_t clientTokenNum;
+	uint32_t jsonVersionNum;
+	bool discardOldDeltaFlag;
+	bool deltaTopicSubscribedFlag;
+	ToBeReceivedAckRecord_t ackWaitList[MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME];
+	SubscriptionRecord_t subscriptionList[MAX_TOPICS_AT_ANY_GIVEN_TIME];
+	JsonTokenTable_t tokenTable[MAX_JSON_TOKEN_EXPECTED];
+	uint32_t tokenTableIndex;
+	ShadowSchemaDelta_t *pSchemaDelta;
+	ShadowJsonParser_t jsonParser;
+	ReportedCacheEntry_t reportedCache[MAX_SHADOW_REPORTED_CACHE_ENTRIES];
+	uint8_t reportedCacheCount;
+	CoalescedUpdate_t coalescedUpdates[MAX_SHADOW_COALESCED_UPDATES];
+	char coalescedDocument[SHADOW_COALESCED_UPDATE_BUFFER_BYTES + COALESCED_DOCUMENT_OVERHEAD];
+	uint32_t coalesceWindowMs;
+	ShadowTopicTable_t topicTables[MAX_SHADOW_TOPIC_TABLES];
+	uint8_t nextTopicTable;
+	ShadowMirror_t mirrors[MAX_SHADOW_MIRRORS];
+	char mirrorSnapshotBuffer[SHADOW_MIRROR_BUFFER_BYTES + SHADOW_MIRROR_SNAPSHOT_OVERHEAD];
+} ShadowClient_t;
+
+/**
+ * @brief Initialize a shadow client context before use
+ *
+ * Resets all the state of the context and initializes the MQTT client like \c aws_iot_shadow_init.
+ *
+ * @param pShadow Context to initialize
+ * @param pClient A new MQTT Client owned by this context. Will be initialized with pParams.
+ * @param pParams Initialization parameters
+ * @return An IoT Error Type defining successful/failed Initialization
+ */
+IoT_Error_t aws_iot_shadow_client_init(ShadowClient_t *pShadow, AWS_IoT_Client *pClient,
+									   ShadowInitParameters_t *pParams);
+
+/**
+ * @brief Connect the context's MQTT client, see \c aws_iot_shadow_connect
+ *
+ * @param pShadow Initialized context
+ * @param pParams Thing name and client id of this context
+ * @return An IoT Error Type defining successful/failed connection
+ */
+IoT_Error_t aws_iot_shadow_client_connect(ShadowClient_t *pShadow, ShadowConnectParameters_t *pParams);
+
+/**
+ * @brief Handle the timeouts, coalesced updates and snapshots of the context and yield its MQTT client, see
+ * \c aws_iot_shadow_yield
+ *
+ * @param pShadow Connected context
+ * @param timeout in milliseconds, the time the MQTT client waits for messages
+ * @return An IoT Error Type defining successful/failed yield
+ */
+IoT_Error_t aws_iot_shadow_client_yield(ShadowClient_t *pShadow, uint32_t timeout);
+
+/**
+ * @brief Disconnect the context's MQTT client
+ *
+ * @param pShadow Connected context
+ * @return An IoT Error Type defining successful/failed disconnect
+ */
+IoT_Error_t aws_iot_shadow_client_disconnect(ShadowClient_t *pShadow);
+
+/**
+ * @brief Free the memory dynamically allocated by the context's MQTT client
+ *
+ * @param pShadow Initialized context
+ * @return An IoT Error Type defining successful/failed freeing
+ */
+IoT_Error_t aws_iot_shadow_client_free(ShadowClient_t *pShadow);
+
+/**
+ * @brief Enable or disable auto reconnect of the context's MQTT client
+ *
+ * @param pShadow Initialized context
+ * @param newStatus true to enable auto reconnect
+ * @return An IoT Error Type defining successful/failed operation
+ */
+IoT_Error_t aws_iot_shadow_client_set_autoreconnect_status(ShadowClient_t *pShadow, bool newStatus);
+
+/**
+ * @brief Update a Thing Name's Shadow through the context, see \c aws_iot_shadow_update
+ *
+ * @param pShadow Connected context
+ * @param pThingName Thing Name of the shadow that needs to be Updated
+ * @param pJsonString The update action expects a JSON document to send
+ * @param callback Callback to be invoked on the response, may be NULL
+ * @param pContextData Passed to the callback
+ * @param timeout_seconds Time to wait for the response before calling the callback with SHADOW_ACK_TIMEOUT
+ * @param isPersistentSubscribe Keep the accepted and rejected subscriptions after the response
+ * @return An IoT Error Type defining successful/failed update action
+ */
+IoT_Error_t aws_iot_shadow_client_update(ShadowClient_t *pShadow, const char *pThingName, char *pJsonString,
+										 fpActionCallback_t callback, void *pContextData, uint8_t timeout_seconds,
+										 bool isPersistentSubscribe);
+
+/**
+ * @brief Queue an update to be merged with the others to the same thing, see \c aws_iot_shadow_update_coalesced
+ *
+ * @param pShadow Connected context
+ * @param pThingName Thing Name of the shadow that needs to be Updated
+ * @param pJsonString Update document, may be released once the call returns
+ * @param callback Callback to be invoked on the response of the merged update, may be NULL
+ * @param pContextData Passed to the callback
+ * @param timeout_seconds Response timeout, the merged update uses the largest
+ * @param isPersistentSubscribe Keep the accepted and rejected subscriptions after the response
+ * @return An IoT Error Type defining successful/failed queuing
+ */
+IoT_Error_t aws_iot_shadow_client_update_coalesced(ShadowClient_t *pShadow, const char *pThingName,
+												   const char *pJsonString, fpActionCallback_t callback,
+												   void *pContextData, uint8_t timeout_seconds,
+												   bool isPersistentSubscribe);
+
+/**
+ * @brief Send the context's pending coalesced updates without waiting for their window
+ *
+ * @param pShadow Connected context
+ * @return An IoT Error Type, the first error when several updates fail
+ */
+IoT_Error_t aws_iot_shadow_client_flush_coalesced_updates(ShadowClient_t *pShadow);
+
+/**
+ * @brief Set the window during which the context merges updates to the same thing
+ *
+ * @param pShadow Initialized context
+ * @param windowMs Window in milliseconds
+ */
+void aws_iot_shadow_client_set_update_coalescing_window(ShadowClient_t *pShadow, uint32_t windowMs);
+
+/**
+ * @brief Get a Thing Name's Shadow through the context, see \c aws_iot_shadow_get
+ *
+ * @param pShadow Connected context
+ * @param pThingName Thing Name of the JSON document that is needed
+ * @param callback Callback to be invoked on the response
+ * @param pContextData Passed to the callback
+ * @param timeout_seconds Time to wait for the response before calling the callback with SHADOW_ACK_TIMEOUT
+ * @param isPersistentSubscribe Keep the accepted and rejected subscriptions after the response
+ * @return An IoT Error Type defining successful/failed get action
+ */
+IoT_Error_t aws_iot_shadow_client_get(ShadowClient_t *pShadow, const char *pThingName, fpActionCallback_t callback,
+									  void *pContextData, uint8_t timeout_seconds, bool isPersistentSubscribe);
+
+/**
+ * @brief Delete a Thing Name's Shadow through the context, see \c aws_iot_shadow_delete
+ *
+ * @param pShadow Connected context
+ * @param pThingName Thing Name of the Shadow that should be deleted
+ * @param callback Callback to be invoked on the response
+ * @param pContextData Passed to the callback
+ * @param timeout_seconds Time to wait for the response before calling the callback with SHADOW_ACK_TIMEOUT
+ * @param isPersistentSubscribe Keep the accepted and rejected subscriptions after the response
+ * @return An IoT Error Type defining successful/failed delete action
+ */
+IoT_Error_t aws_iot_shadow_client_delete(ShadowClient_t *pShadow, const char *pThingName, fpActionCallback_t callback,
+										 void *pContextData, uint8_t timeout_seconds, bool isPersistentSubscribe);
+
+/**
+ * @brief Register a key of the context's thing on the delta topic, see \c aws_iot_shadow_register_delta
+ *
+ * @param pShadow Connected context
+ * @param pStruct JSON key, its value and the callback invoked when it changes
+ * @return An IoT Error Type defining successful/failed registration
+ */
+IoT_Error_t aws_iot_shadow_client_register_delta(ShadowClient_t *pShadow, jsonStruct_t *pStruct);
+
+/**
+ * @brief Register a schema on the delta topic of the context's thing, see \c aws_iot_shadow_register_delta_schema
+ *
+ * @param pShadow Connected context
+ * @param pSchemaDelta Schema, state and callback, it must stay valid while registered
+ * @return An IoT Error Type defining successful/failed registration
+ */
+IoT_Error_t aws_iot_shadow_client_register_delta_schema(ShadowClient_t *pShadow, ShadowSchemaDelta_t *pSchemaDelta);
+
+/**
+ * @brief Reset the last received version of the context to 0
+ *
+ * @param pShadow Initialized context
+ */
+void aws_iot_shadow_client_reset_last_received_version(ShadowClient_t *pShadow);
+
+/**
+ * @brief Version of the last get/accepted or delta document received by the context
+ *
+ * @param pShadow Initialized context
+ * @return The last received version
+ */
+uint32_t aws_iot_shadow_client_get_last_received_version(ShadowClient_t *pShadow);
+
+/**
+ * @brief Ignore the delta messages older than the last received version, the default
+ *
+ * @param pShadow Initialized context
+ */
+void aws_iot_shadow_client_enable_discard_old_delta_msgs(ShadowClient_t *pShadow);
+
+/**
+ * @brief Deliver all delta messages regardless of their version
+ *
+ * @param pShadow Initialized context
+ */
+void aws_iot_shadow_client_disable_discard_old_delta_msgs(ShadowClient_t *pShadow);
+
+/**
+ * @brief Keep an in-memory copy of a Thing Name's Shadow in the context, see \c aws_iot_shadow_mirror_enable
+ *
+ * @param pShadow Initialized context
+ * @param pThingName Thing Name of the shadow to mirror
+ * @param pSnapshotFile File the mirror is saved to and restored from, NULL for none
+ * @param snapshotIntervalMs Delay between a change and the snapshot written by the yield
+ * @return An IoT Error Type, LIMIT_EXCEEDED_ERROR if MAX_SHADOW_MIRRORS things are already mirrored
+ */
+IoT_Error_t aws_iot_shadow_client_mirror_enable(ShadowClient_t *pShadow, const char *pThingName,
+												const char *pSnapshotFile, uint32_t snapshotIntervalMs);
+
+/**
+ * @brief Stop mirroring a Thing Name's Shadow in the context
+ *
+ * @param pShadow Initialized context
+ * @param pThingName Mirrored Thing Name
+ * @return An IoT Error Type, FAILURE if the thing is not mirrored
+ */
+IoT_Error_t aws_iot_shadow_client_mirror_disable(ShadowClient_t *pShadow, const char *pThingName);
+
+/**
+ * @brief Read a value from one of the context's mirrors, see \c aws_iot_shadow_mirror_get_field
+ *
+ * @param pShadow Initialized context
+ * @param pThingName Mirrored Thing Name
+ * @param section Desired or reported section
+ * @param pStruct Its pKey is the dotted path of the value, pData is updated like for a delta
+ * @return An IoT Error Type, FAILURE if the thing is not mirrored or the path is not in the mirror
+ */
+IoT_Error_t aws_iot_shadow_client_mirror_get_field(ShadowClient_t *pShadow, const char *pThingName,
+												   ShadowMirrorSection_t section, jsonStruct_t *pStruct);
+
+/**
+ * @brief Version of one of the context's mirrors
+ *
+ * @param pShadow Initialized context
+ * @param pThingName Mirrored Thing Name
+ * @param pVersion set to the version of the mirrored document
+ * @return An IoT Error Type, FAILURE until a whole document was received or restored
+ */
+IoT_Error_t aws_iot_shadow_client_mirror_get_version(ShadowClient_t *pShadow, const char *pThingName,
+													 uint32_t *pVersion);
+
+/**
+ * @brief Write the snapshot of one of the context's mirrors now
+ *
+ * @param pShadow Initialized context
+ * @param pThingName Mirrored Thing Name
+ * @return An IoT Error Type, FAILURE if the mirror has no snapshot file or it could not be written
+ */
+IoT_Error_t aws_iot_shadow_client_mirror_save(ShadowClient_t *pShadow, const char *pThingName);
+
+/**
+ * @brief Finalize the JSON document with a client token of the context, see \c aws_iot_finalize_json_document
+ *
+ * @param pShadow Connected context
+ * @param pJsonDocument The JSON Document filled in this char buffer
+ * @param maxSizeOfJsonDocument maximum size of the pJsonDocument that can be used to fill the JSON document
+ * @return An IoT Error Type defining if the buffer was null or the entire string was not filled up
+ */
+IoT_Error_t aws_iot_shadow_client_finalize_json_document(ShadowClient_t *pShadow, char *pJsonDocument,
+														 size_t maxSizeOfJsonDocument);
+
+/**
+ * @brief Fill the given buffer with a client token of the context, see \c aws_iot_fill_with_client_token
+ *
+ * @param pShadow Connected context
+ * @param pBufferToBeUpdatedWithClientToken buffer to be updated with the client token string
+ * @param maxSizeOfJsonDocument maximum size of the pBufferToBeUpdatedWithClientToken that can be used
+ * @return An IoT Error Type defining if the buffer was null or the entire string was not filled up
+ */
+IoT_Error_t aws_iot_shadow_client_fill_with_client_token(ShadowClient_t *pShadow,
+														 char *pBufferToBeUpdatedWithClientToken,
+														 size_t maxSizeOfJsonDocument);
+
+/**
+ * @brief Register a reported key with the context's reported cache, see \c aws_iot_shadow_register_reported
+ *
+ * @param pShadow Initialized context
+ * @param pStruct jsonStruct_t of the reported key, it must stay valid while registered
+ * @param epsilon Largest change of a float or double key that is not reported
+ * @return An IoT Error Type, FAILURE if MAX_SHADOW_REPORTED_CACHE_ENTRIES keys are already registered
+ */
+IoT_Error_t aws_iot_shadow_client_register_reported(ShadowClient_t *pShadow, jsonStruct_t *pStruct, float epsilon);
+
+/**
+ * @brief Report a registered key with the next dirty section even if it did not change
+ *
+ * @param pShadow Initialized context
+ * @param pStruct jsonStruct_t previously registered with the context
+ * @return An IoT Error Type, FAILURE if the key is not registered
+ */
+IoT_Error_t aws_iot_shadow_client_mark_reported_dirty(ShadowClient_t *pShadow, jsonStruct_t *pStruct);
+
+/**
+ * @brief Add the reported section with the context's keys that changed, see \c aws_iot_shadow_add_reported_dirty
+ *
+ * @param pShadow Initialized context
+ * @param pJsonDocument The JSON Document filled in this char buffer
+ * @param maxSizeOfJsonDocument maximum size of the pJsonDocument that can be used to fill the JSON document
+ * @param pDirtyCount set to the number of keys added
+ * @return An IoT Error Type defining if the buffer was null or the entire string was not filled up
+ */
+IoT_Error_t aws_iot_shadow_client_add_reported_dirty(ShadowClient_t *pShadow, char *pJsonDocument,
+													 size_t maxSizeOfJsonDocument, uint8_t *pDirtyCount);
+
+/**
+ * @brief Forget the acknowledged values of the context's reported cache
+ *
+ * @param pShadow Initialized context
+ */
+void aws_iot_shadow_client_reset_reported_cache(ShadowClient_t *pShadow);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_SHADOW_CLIENT_H_ */
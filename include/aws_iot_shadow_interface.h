@@ -176,7 +176,7 @@ typedef enum {
  * @param pThingName Thing Name of the response received
  * @param action The response of the action
  * @param status Informs if the action was Accepted/Rejected or Timed out
- * @param pReceivedJsonDocument Received JSON document
+ * @param pReceivedJsonDocument Received JSON document, an empty string on timeout. It points into the MQTT read buffer and is only valid during the callback
  * @param pContextData the void* data passed in during the action call(update, get or delete)
  *
  */
@@ -210,6 +210,56 @@ IoT_Error_t aws_iot_shadow_update(AWS_IoT_Client *pClient, const char *pThingNam
 								  fpActionCallback_t callback, void *pContextData, uint8_t timeout_seconds,
 								  bool isPersistentSubscribe);
 
+/**
+ * @brief Queue an update that is merged with the other updates to the same Thing Name's Shadow
+ *
+ * Instead of publishing right away, the members of the reported and desired sections of pJsonString are merged into
+ * a pending update for the thing. The pending update is sent as one document by \c aws_iot_shadow_yield once the
+ * coalescing window that started with the first queued update has passed, so a thing gets at most one update per
+ * window and uses a single entry of the response wait list. When a key is queued more than once the last value wins.
+ * Nested objects are not merged, a later object replaces the earlier one.
+ *
+ * Every callback of the merged updates is called with the response of the combined document.
+ *
+ * Documents that hold a version for optimistic locking are not merged, the pending update of the thing is sent
+ * first and the document right after it, as \c aws_iot_shadow_update would. The client token of pJsonString is
+ * ignored. When the pending update is full it is sent early and a new one is started. If the response wait list is
+ * full when the window ends, the update stays pending and is retried one window later.
+ *
+ * A pending update that cannot be sent early, before a versioned or a non fitting document, is kept the same way
+ * and retried one window later. pJsonString is then not queued, so that it never overtakes the pending update, and
+ * the error of the send is returned. The call can be repeated once the pending update went out.
+ *
+ * @param pClient	MQTT Client used as the protocol layer
+ * @param pThingName Thing Name of the shadow that needs to be Updated
+ * @param pJsonString JSON document following the AWS IoT Thing Shadow specification, it can be reused as soon as this function returns
+ * @param callback Called with the response of the combined document, could be NULL
+ * @param pContextData This is an extra parameter that could be passed along with the callback. It should be set to NULL if not used
+ * @param timeout_seconds Time to wait for the response, the combined document uses the longest of the merged updates
+ * @param isPersistentSubscribe Keep the subscriptions to the response topics, set for the combined document if any merged update sets it
+ * @return An IoT Error Type, SHADOW_JSON_ERROR if pJsonString is not a valid document, MAX_SIZE_ERROR if it does not fit an empty pending update and the error of the send if a pending update could not be sent early
+ */
+IoT_Error_t aws_iot_shadow_update_coalesced(AWS_IoT_Client *pClient, const char *pThingName, const char *pJsonString,
+											fpActionCallback_t callback, void *pContextData, uint8_t timeout_seconds,
+											bool isPersistentSubscribe);
+
+/**
+ * @brief Send every pending coalesced update now without waiting for its window to end
+ *
+ * @param pClient	MQTT Client used as the protocol layer
+ * @return An IoT Error Type, the first error met while sending
+ */
+IoT_Error_t aws_iot_shadow_flush_coalesced_updates(AWS_IoT_Client *pClient);
+
+/**
+ * @brief Set the coalescing window used for the updates queued from now on
+ *
+ * Defaults to #SHADOW_COALESCE_WINDOW_MS from aws_iot_config.h
+ *
+ * @param windowMs Time in milliseconds updates to the same thing are merged for
+ */
+void aws_iot_shadow_set_update_coalescing_window(uint32_t windowMs);
+
 /**
  * @brief This function is the one used to perform an Get action to a Thing Name's Shadow.
  *
@@ -249,6 +299,8 @@ IoT_Error_t aws_iot_shadow_delete(AWS_IoT_Client *pClient, const char *pThingNam
  *
  * Any time a delta is published the Json document will be delivered to the pStruct->cb. If you don't want the parsing done by the SDK then use the jsonStruct_t key set to "state". A good example of this is displayed in the sample_apps/shadow_console_echo.c
  *
+ * A key containing dots, for example "config.led.color", is a path from the state object of the delta to a nested value. The value is parsed into pStruct->pData with the rest of the delta message, the callback does not need to parse it again.
+ *
  * @param pClient MQTT Client used as the protocol layer
  * @param pStruct The struct used to parse JSON value
  * @return An IoT Error Type defining successful/failed delta registering
@@ -286,6 +338,84 @@ void aws_iot_shadow_enable_discard_old_delta_msgs(void);
  */
 void aws_iot_shadow_disable_discard_old_delta_msgs(void);
 
+/**
+ * @brief Sections of a Thing Shadow held by the shadow mirror
+ */
+typedef enum {
+	SHADOW_MIRROR_DESIRED, SHADOW_MIRROR_REPORTED
+} ShadowMirrorSection_t;
+
+/**
+ * @brief Keep an in-memory copy of a Thing Name's Shadow
+ *
+ * The mirror holds the desired and reported leaf values of the shadow and its version. get/accepted replaces it,
+ * update/accepted and delete/accepted are merged into it and delta messages are merged into the desired section.
+ * Messages older than the mirrored version are ignored. Only the responses the SDK is subscribed to are seen: the
+ * accepted topics of actions sent with a callback or a persistent subscription and, for #AWS_IOT_MY_THING_NAME,
+ * the delta topic once \c aws_iot_shadow_register_delta was called.
+ *
+ * Nested objects are stored flattened, one value per dotted key path such as "led.color". Arrays are kept whole.
+ *
+ * With a snapshot file the mirror is loaded from it here, so the last known state is available before the first
+ * get/accepted is received, and written back from \c aws_iot_shadow_yield at most once per snapshot interval after
+ * it changed. The snapshot is read and written through \c snapshot_storage_interface.h, which replaces it
+ * atomically. On Linux a temporary file next to it is written, synced and renamed.
+ *
+ * Call it after \c aws_iot_shadow_init, which drops every mirror. Enabling a mirrored thing again reloads it.
+ *
+ * @param pThingName Thing Name of the shadow to mirror
+ * @param pSnapshotFile Path of the snapshot file, NULL to keep the mirror in memory only
+ * @param snapshotIntervalMs Minimum time between two snapshot writes
+ * @return An IoT Error Type, LIMIT_EXCEEDED_ERROR if #MAX_SHADOW_MIRRORS things are already mirrored. A missing or
+ *         unreadable snapshot file is not an error, the mirror then starts empty
+ */
+IoT_Error_t aws_iot_shadow_mirror_enable(const char *pThingName, const char *pSnapshotFile,
+										 uint32_t snapshotIntervalMs);
+
+/**
+ * @brief Stop mirroring a Thing Name's Shadow
+ *
+ * Pending changes are not written to the snapshot file, call \c aws_iot_shadow_mirror_save first to keep them.
+ *
+ * @param pThingName Thing Name of a mirrored shadow
+ * @return An IoT Error Type, FAILURE if the thing is not mirrored
+ */
+IoT_Error_t aws_iot_shadow_mirror_disable(const char *pThingName);
+
+/**
+ * @brief Read one value of a mirrored shadow
+ *
+ * pStruct->pKey is the dotted path of the value and pStruct->pData is filled as it would be from a delta message.
+ * SHADOW_JSON_OBJECT copies the JSON text of an array as a null terminated string. Objects themselves are not
+ * stored, only the values inside them can be read.
+ *
+ * @param pThingName Thing Name of a mirrored shadow
+ * @param section Section to read from
+ * @param pStruct Key path, type and destination of the value
+ * @return An IoT Error Type, FAILURE if the thing is not mirrored or the mirror holds no such value
+ */
+IoT_Error_t aws_iot_shadow_mirror_get_field(const char *pThingName, ShadowMirrorSection_t section,
+											jsonStruct_t *pStruct);
+
+/**
+ * @brief Version of a mirrored shadow
+ *
+ * @param pThingName Thing Name of a mirrored shadow
+ * @param pVersion set to the version of the mirrored document
+ * @return An IoT Error Type, FAILURE if the thing is not mirrored or the mirror was neither loaded from a snapshot
+ *         nor filled by a get/accepted or delete/accepted response yet, so it may miss values
+ */
+IoT_Error_t aws_iot_shadow_mirror_get_version(const char *pThingName, uint32_t *pVersion);
+
+/**
+ * @brief Write the snapshot file of a mirrored shadow now
+ *
+ * @param pThingName Thing Name of a mirrored shadow
+ * @return An IoT Error Type, FAILURE if the thing is not mirrored, has no snapshot file or the file could not be
+ *         written, SHADOW_JSON_BUFFER_TRUNCATED if the snapshot did not fit its buffer
+ */
+IoT_Error_t aws_iot_shadow_mirror_save(const char *pThingName);
+
 /**
  * @brief This function is used to enable or disable autoreconnect
  *
@@ -24,25 +24,66 @@ extern "C" {
 #include <stdarg.h>
 
 #include "aws_iot_error.h"
-#include "aws_iot_shadow_json_data.h"
+#include "aws_iot_shadow_client.h"
+#include "jsmn.h"
 
-bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, void *pJsonHandler, int32_t *pTokenCount);
+bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, ShadowJsonParser_t *pJsonHandler,
+						 int32_t *pTokenCount);
 
-bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, void *pJsonHandler, int32_t tokenCount,
+bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
 									 jsonStruct_t *pDataStruct, uint32_t *pDataLength, int32_t *pDataPosition);
 
+IoT_Error_t addJsonSectionFromArray(char *pJsonDocument, size_t maxSizeOfJsonDocument, const char *pSection,
+									uint8_t count, jsonStruct_t *const *ppStructs);
+
+IoT_Error_t UpdateValueIfNoObject(const char *pJsonString, jsonStruct_t *pDataStruct, jsmntok_t token);
+
+int32_t findJsonObjectMember(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							 int32_t objectIndex, const char *pKey);
+
+int32_t findJsonPath(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+					 int32_t objectIndex, const char *pPath);
+
+bool isJsonPathMatchingAndUpdateValue(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler,
+									  int32_t tokenCount, int32_t objectIndex, jsonStruct_t *pDataStruct,
+									  uint32_t *pDataLength, int32_t *pDataPosition);
+
+int32_t findJsonStateSection(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							 const char *pSection);
+
+bool extractJsonSectionValue(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							 int32_t sectionIndex, const char *pKey, jsmntok_t *pValueToken);
+
+/* Return false to stop the iteration */
+typedef bool (*jsonMemberVisitor_t)(const char *pJsonDocument, const jsmntok_t *pKey, const jsmntok_t *pValue,
+									int32_t valueIndex, void *pContext);
+
+int32_t forEachJsonObjectMember(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+								int32_t objectIndex, jsonMemberVisitor_t visitor, void *pContext);
+
 IoT_Error_t aws_iot_shadow_internal_get_request_json(char *pBuffer, size_t bufferSize);
 
+IoT_Error_t aws_iot_shadow_internal_client_get_request_json(ShadowClient_t *pShadow, char *pBuffer, size_t bufferSize);
+
 IoT_Error_t aws_iot_shadow_internal_delete_request_json(char *pBuffer, size_t bufferSize);
 
-void resetClientTokenSequenceNum(void);
+IoT_Error_t aws_iot_shadow_internal_client_delete_request_json(ShadowClient_t *pShadow, char *pBuffer,
+														 size_t bufferSize);
+
+
+bool isReceivedJsonValid(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, size_t jsonSize);
 
+bool extractClientToken(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, size_t jsonSize,
+						char *pExtractedClientToken, size_t clientTokenSize);
 
-bool isReceivedJsonValid(const char *pJsonDocument, size_t jsonSize);
+/* Same as extractClientToken on a document already parsed into pJsonHandler by isJsonValidAndParse */
+bool extractParsedClientToken(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							  char *pExtractedClientToken, size_t clientTokenSize);
 
-bool extractClientToken(const char *pJsonDocument, size_t jsonSize, char *pExtractedClientToken, size_t clientTokenSize);
+bool decodeClientTokenSequence(ShadowClient_t *pShadow, const char *pClientToken, uint32_t *pSequence);
 
-bool extractVersionNumber(const char *pJsonDocument, void *pJsonHandler, int32_t tokenCount, uint32_t *pVersionNumber);
+bool extractVersionNumber(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+						  uint32_t *pVersionNumber);
 
 #ifdef __cplusplus
 }
@@ -143,6 +143,60 @@ IoT_Error_t aws_iot_finalize_json_document(char *pJsonDocument, size_t maxSizeOf
 
 IoT_Error_t aws_iot_fill_with_client_token(char *pBufferToBeUpdatedWithClientToken, size_t maxSizeOfJsonDocument);
 
+/**
+ * @brief Register a reported key with the last reported state cache
+ *
+ * The SDK remembers the last value of every registered key that the Shadow service acknowledged, taken from the
+ * reported section of update/accepted and get/accepted responses for this device's thing. \c aws_iot_shadow_add_reported_dirty
+ * then only adds the keys whose current value differs from it. Responses are only received for actions sent with a
+ * callback, an update sent without one leaves its keys dirty.
+ *
+ * Strings and objects are compared by a hash of their text. A string holding characters that need escaping never
+ * matches and is always reported.
+ *
+ * Registering a key again replaces its jsonStruct_t and epsilon and keeps the cached value.
+ *
+ * @param pStruct jsonStruct_t of the reported key, it must stay valid while registered
+ * @param epsilon For SHADOW_JSON_FLOAT and SHADOW_JSON_DOUBLE keys, changes of at most epsilon from the acknowledged
+ *        value are not reported. Use 0 to report every change
+ * @return An IoT Error Type, FAILURE if MAX_SHADOW_REPORTED_CACHE_ENTRIES keys are already registered
+ */
+IoT_Error_t aws_iot_shadow_register_reported(jsonStruct_t *pStruct, float epsilon);
+
+/**
+ * @brief Report a registered key with the next \c aws_iot_shadow_add_reported_dirty call even if it did not change
+ *
+ * Useful for event like values such as a button press that must be reported every time. The key stays forced,
+ * and is added by every \c aws_iot_shadow_add_reported_dirty call, until an accepted update reports it. A rejected
+ * or timed out update leaves it forced.
+ *
+ * @param pStruct jsonStruct_t previously passed to \c aws_iot_shadow_register_reported
+ * @return An IoT Error Type, FAILURE if the key is not registered
+ */
+IoT_Error_t aws_iot_shadow_mark_reported_dirty(jsonStruct_t *pStruct);
+
+/**
+ * @brief Add the reported section with only the registered keys that changed since they were last acknowledged
+ *
+ * Works like \c aws_iot_shadow_add_reported with the registered keys as arguments, skipping the ones whose current
+ * value matches the cache. When no key changed nothing is written and pDirtyCount is set to 0, the update can then
+ * be skipped altogether.
+ *
+ * @param pJsonDocument The JSON Document filled in this char buffer
+ * @param maxSizeOfJsonDocument maximum size of the pJsonDocument that can be used to fill the JSON document
+ * @param pDirtyCount set to the number of keys added
+ * @return An IoT Error Type defining if the buffer was null or the entire string was not filled up
+ */
+IoT_Error_t aws_iot_shadow_add_reported_dirty(char *pJsonDocument, size_t maxSizeOfJsonDocument, uint8_t *pDirtyCount);
+
+/**
+ * @brief Forget the acknowledged values so that every registered key is reported again
+ *
+ * Done automatically when the shadow is deleted with \c aws_iot_shadow_delete. Call it when the shadow may have been
+ * changed behind the device's back.
+ */
+void aws_iot_shadow_reset_reported_cache(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,289 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_schema.h
+ * @brief Parsers and serializers compiled from a fixed shadow schema
+ *
+ * A schema lists the fields of a shadow section once, as an X-macro taking a FIELD and a STRING_FIELD macro:
+ *
+ * @code
+ * #define THERMOSTAT_SCHEMA(FIELD, STRING_FIELD) \
+ *     FIELD(temperature, float) \
+ *     FIELD(setPoint, int32_t) \
+ *     FIELD(windowOpen, bool) \
+ *     STRING_FIELD(mode, 16)
+ *
+ * AWS_IOT_SHADOW_SCHEMA_DECLARE(Thermostat, THERMOSTAT_SCHEMA)   // in a header
+ * AWS_IOT_SHADOW_SCHEMA_DEFINE(Thermostat, THERMOSTAT_SCHEMA)    // in one source file
+ * @endcode
+ *
+ * FIELD types are int32_t, int16_t, int8_t, uint32_t, uint16_t, uint8_t, float, double and bool. A STRING_FIELD
+ * is a char array of the given size, including the NUL. At most 32 fields are supported.
+ *
+ * The schema expands to a Thermostat_t struct holding the values and to functions in which every key is a
+ * string constant of known length and every value is parsed and written by the function of its type, so
+ * there is no key lookup by strcmp and no switch on a runtime type:
+ *
+ *  - Thermostat_parse() reads the members of a parsed JSON object into the struct
+ *  - Thermostat_add_reported() and Thermostat_add_desired() append a section like aws_iot_shadow_add_reported
+ *
+ * Parsers and serializers work on a set of fields, AWS_IOT_SHADOW_SCHEMA_FIELD(Thermostat, mode) is the bit of
+ * a field in that set and AWS_IOT_SHADOW_SCHEMA_ALL_FIELDS selects all of them. A ShadowSchemaDelta_t made with
+ * AWS_IOT_SHADOW_SCHEMA_DELTA_INIT and registered with aws_iot_shadow_register_delta_schema receives the
+ * state of every delta message.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_SHADOW_SCHEMA_H_
+#define AWS_IOT_SDK_SRC_IOT_SHADOW_SCHEMA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aws_iot_error.h"
+#include "aws_iot_json_utils.h"
+#include "aws_iot_json_writer.h"
+#include "aws_iot_mqtt_client_interface.h"
+
+/**
+ * @brief Set of fields selecting every field of a schema
+ */
+#define AWS_IOT_SHADOW_SCHEMA_ALL_FIELDS 0xFFFFFFFFu
+
+/**
+ * @brief Bit of a field in a set of fields of the schema Name
+ */
+#define AWS_IOT_SHADOW_SCHEMA_FIELD(Name, field) (1u << offsetof(Name##_Fields_t, field))
+
+/**
+ * @brief Reads the members of the object at objectIndex into pState
+ *
+ * @return Set of the fields that were present and valid
+ */
+typedef uint32_t (*ShadowSchemaParser_t)(const char *pJsonDocument, const jsmntok_t *pTokens,
+										 const jsonTapeEntry_t *pTape, int32_t objectIndex, void *pState);
+
+/**
+ * @brief Called after a delta message updated at least one field of a schema
+ *
+ * @param pState State the delta was parsed into
+ * @param fields Set of the fields updated by the delta
+ * @param pContext Context of the registration
+ */
+typedef void (*ShadowSchemaCallback_t)(void *pState, uint32_t fields, void *pContext);
+
+/**
+ * @brief Schema registered on the delta topic
+ */
+typedef struct {
+	ShadowSchemaParser_t parse;      ///< Name_parse_delta of the schema
+	void *pState;                    ///< Name_t the delta is parsed into
+	ShadowSchemaCallback_t callback; ///< Called with the updated fields, may be NULL
+	void *pContext;                  ///< Passed to the callback
+} ShadowSchemaDelta_t;
+
+/**
+ * @brief Initializer of a ShadowSchemaDelta_t for the schema Name
+ */
+#define AWS_IOT_SHADOW_SCHEMA_DELTA_INIT(Name, pState, callback, pContext) \
+	{ Name##_parse_delta, (pState), (callback), (pContext) }
+
+/**
+ * @brief Register a schema on the delta topic of #AWS_IOT_MY_THING_NAME
+ *
+ * The members of the state object of every delta message are parsed into pSchemaDelta->pState before the
+ * callback is invoked with the fields that were updated. Keys outside the schema are ignored, keys registered
+ * with \c aws_iot_shadow_register_delta are still delivered to their handlers. A second registration replaces
+ * the first.
+ *
+ * @param pClient MQTT Client used as the protocol layer
+ * @param pSchemaDelta Schema, state and callback, it must stay valid while registered
+ * @return An IoT Error Type defining successful/failed delta registering
+ */
+IoT_Error_t aws_iot_shadow_register_delta_schema(AWS_IoT_Client *pClient, ShadowSchemaDelta_t *pSchemaDelta);
+
+/**
+ * @brief Start a section of a shadow document, used by the generated serializers
+ *
+ * @param pWriter Writer positioned after "section":{ on success
+ * @param pJsonDocument Document started with \c aws_iot_shadow_init_json_document
+ * @param maxSizeOfJsonDocument Size of pJsonDocument
+ * @param pSection "reported" or "desired"
+ * @return An IoT Error Type defining if the buffer was null or the section did not fit
+ */
+IoT_Error_t aws_iot_shadow_schema_begin_section(IoT_Json_Writer_t *pWriter, char *pJsonDocument,
+												size_t maxSizeOfJsonDocument, const char *pSection);
+
+/**
+ * @brief Close a section started with \c aws_iot_shadow_schema_begin_section
+ *
+ * @param pWriter Writer of the section
+ * @return An IoT Error Type defining if the section did not fit
+ */
+IoT_Error_t aws_iot_shadow_schema_end_section(IoT_Json_Writer_t *pWriter);
+
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_int32_t parseInteger32Value
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_int16_t parseInteger16Value
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_int8_t parseInteger8Value
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_uint32_t parseUnsignedInteger32Value
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_uint16_t parseUnsignedInteger16Value
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_uint8_t parseUnsignedInteger8Value
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_float parseFloatValue
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_double parseDoubleValue
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_bool parseBooleanValue
+
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_int32_t aws_iot_json_writer_int
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_int16_t aws_iot_json_writer_int
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_int8_t aws_iot_json_writer_int
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_uint32_t aws_iot_json_writer_uint
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_uint16_t aws_iot_json_writer_uint
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_uint8_t aws_iot_json_writer_uint
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_float aws_iot_json_writer_float
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_double aws_iot_json_writer_double
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_bool aws_iot_json_writer_bool
+
+/* Expansions of the schema fields. The generated functions name their locals pJsonDocument, pKey, pValue,
+ * keyLength, pState, fields, writer and bodyStart and typedef the field index struct as SchemaFields_t */
+
+#define AWS_IOT_SHADOW_SCHEMA_MEMBER(name, type) type name;
+#define AWS_IOT_SHADOW_SCHEMA_STRING_MEMBER(name, size) char name[size];
+#define AWS_IOT_SHADOW_SCHEMA_INDEX(name, type) char name;
+#define AWS_IOT_SHADOW_SCHEMA_STRING_INDEX(name, size) char name;
+
+#define AWS_IOT_SHADOW_SCHEMA_KEY_MATCHES(name) \
+	(sizeof(#name) - 1 == keyLength && 0 == memcmp(pJsonDocument + pKey->start, #name, sizeof(#name) - 1))
+
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_FIELD(name, type) \
+	if(AWS_IOT_SHADOW_SCHEMA_KEY_MATCHES(name)) { \
+		if(SUCCESS == AWS_IOT_SHADOW_SCHEMA_PARSE_##type(&(pState->name), pJsonDocument, pValue)) { \
+			fields |= 1u << offsetof(SchemaFields_t, name); \
+		} \
+		continue; \
+	}
+
+#define AWS_IOT_SHADOW_SCHEMA_PARSE_STRING_FIELD(name, size) \
+	if(AWS_IOT_SHADOW_SCHEMA_KEY_MATCHES(name)) { \
+		if(SUCCESS == parseStringValue(pState->name, sizeof(pState->name), pJsonDocument, pValue)) { \
+			fields |= 1u << offsetof(SchemaFields_t, name); \
+		} \
+		continue; \
+	}
+
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_KEY(name) \
+	if(writer.length != bodyStart) { \
+		aws_iot_json_writer_char(&writer, ','); \
+	} \
+	aws_iot_json_writer_raw(&writer, "\"" #name "\":", sizeof(#name) + 2);
+
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_FIELD(name, type) \
+	if(0 != (fields & (1u << offsetof(SchemaFields_t, name)))) { \
+		AWS_IOT_SHADOW_SCHEMA_WRITE_KEY(name) \
+		AWS_IOT_SHADOW_SCHEMA_WRITE_##type(&writer, pState->name); \
+	}
+
+#define AWS_IOT_SHADOW_SCHEMA_WRITE_STRING_FIELD(name, size) \
+	if(0 != (fields & (1u << offsetof(SchemaFields_t, name)))) { \
+		AWS_IOT_SHADOW_SCHEMA_WRITE_KEY(name) \
+		aws_iot_json_writer_string(&writer, pState->name); \
+	}
+
+/**
+ * @brief Declare the state struct and functions of the schema Name
+ */
+#define AWS_IOT_SHADOW_SCHEMA_DECLARE(Name, SCHEMA) \
+	typedef struct { \
+		SCHEMA(AWS_IOT_SHADOW_SCHEMA_MEMBER, AWS_IOT_SHADOW_SCHEMA_STRING_MEMBER) \
+	} Name##_t; \
+	typedef struct { \
+		SCHEMA(AWS_IOT_SHADOW_SCHEMA_INDEX, AWS_IOT_SHADOW_SCHEMA_STRING_INDEX) \
+	} Name##_Fields_t; \
+	typedef char Name##_FieldCountCheck_t[(sizeof(Name##_Fields_t) <= 32) ? 1 : -1]; \
+	uint32_t Name##_parse(const char *pJsonDocument, const jsmntok_t *pTokens, const jsonTapeEntry_t *pTape, \
+						  int32_t objectIndex, Name##_t *pState); \
+	uint32_t Name##_parse_delta(const char *pJsonDocument, const jsmntok_t *pTokens, \
+								const jsonTapeEntry_t *pTape, int32_t objectIndex, void *pState); \
+	IoT_Error_t Name##_add_section(char *pJsonDocument, size_t maxSizeOfJsonDocument, const char *pSection, \
+								   const Name##_t *pState, uint32_t fields); \
+	IoT_Error_t Name##_add_reported(char *pJsonDocument, size_t maxSizeOfJsonDocument, const Name##_t *pState, \
+									uint32_t fields); \
+	IoT_Error_t Name##_add_desired(char *pJsonDocument, size_t maxSizeOfJsonDocument, const Name##_t *pState, \
+								   uint32_t fields);
+
+/**
+ * @brief Define the functions of the schema Name, in exactly one source file
+ */
+#define AWS_IOT_SHADOW_SCHEMA_DEFINE(Name, SCHEMA) \
+	uint32_t Name##_parse(const char *pJsonDocument, const jsmntok_t *pTokens, const jsonTapeEntry_t *pTape, \
+						  int32_t objectIndex, Name##_t *pState) { \
+		typedef Name##_Fields_t SchemaFields_t; \
+		const jsmntok_t *pKey; \
+		jsmntok_t *pValue; \
+		size_t keyLength; \
+		uint32_t fields = 0; \
+		int32_t end, i; \
+		if(NULL == pJsonDocument || NULL == pTokens || NULL == pTape || NULL == pState || objectIndex < 0 \
+		   || JSMN_OBJECT != pTokens[objectIndex].type) { \
+			return 0; \
+		} \
+		end = pTape[objectIndex].next; \
+		for(i = objectIndex + 1; i + 1 < end; i = pTape[i + 1].next) { \
+			pKey = &pTokens[i]; \
+			pValue = (jsmntok_t *) &pTokens[i + 1]; \
+			keyLength = (size_t) (pKey->end - pKey->start); \
+			SCHEMA(AWS_IOT_SHADOW_SCHEMA_PARSE_FIELD, AWS_IOT_SHADOW_SCHEMA_PARSE_STRING_FIELD) \
+		} \
+		return fields; \
+	} \
+	uint32_t Name##_parse_delta(const char *pJsonDocument, const jsmntok_t *pTokens, \
+								const jsonTapeEntry_t *pTape, int32_t objectIndex, void *pState) { \
+		return Name##_parse(pJsonDocument, pTokens, pTape, objectIndex, (Name##_t *) pState); \
+	} \
+	IoT_Error_t Name##_add_section(char *pJsonDocument, size_t maxSizeOfJsonDocument, const char *pSection, \
+								   const Name##_t *pState, uint32_t fields) { \
+		typedef Name##_Fields_t SchemaFields_t; \
+		IoT_Json_Writer_t writer; \
+		size_t bodyStart; \
+		IoT_Error_t rc; \
+		if(NULL == pState) { \
+			return NULL_VALUE_ERROR; \
+		} \
+		rc = aws_iot_shadow_schema_begin_section(&writer, pJsonDocument, maxSizeOfJsonDocument, pSection); \
+		if(SUCCESS != rc) { \
+			return rc; \
+		} \
+		bodyStart = writer.length; \
+		SCHEMA(AWS_IOT_SHADOW_SCHEMA_WRITE_FIELD, AWS_IOT_SHADOW_SCHEMA_WRITE_STRING_FIELD) \
+		return aws_iot_shadow_schema_end_section(&writer); \
+	} \
+	IoT_Error_t Name##_add_reported(char *pJsonDocument, size_t maxSizeOfJsonDocument, const Name##_t *pState, \
+									uint32_t fields) { \
+		return Name##_add_section(pJsonDocument, maxSizeOfJsonDocument, "reported", pState, fields); \
+	} \
+	IoT_Error_t Name##_add_desired(char *pJsonDocument, size_t maxSizeOfJsonDocument, const Name##_t *pState, \
+								   uint32_t fields) { \
+		return Name##_add_section(pJsonDocument, maxSizeOfJsonDocument, "desired", pState, fields); \
+	}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_SHADOW_SCHEMA_H_ */
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef SRC_SHADOW_AWS_IOT_SHADOW_TOPICS_H_
+#define SRC_SHADOW_AWS_IOT_SHADOW_TOPICS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "aws_iot_shadow_client.h"
+
+typedef enum {
+	SHADOW_ACCEPTED, SHADOW_REJECTED, SHADOW_ACTION
+} ShadowAckTopicTypes_t;
+
+void initShadowTopicTables(ShadowClient_t *pShadow);
+const ShadowTopicTable_t *getShadowTopicTable(ShadowClient_t *pShadow, const char *pThingName);
+const char *getShadowTopic(const ShadowTopicTable_t *pTable, ShadowActions_t action, ShadowAckTopicTypes_t ackType,
+						   uint16_t *pLength);
+const char *getShadowDeltaTopic(const ShadowTopicTable_t *pTable, uint16_t *pLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_SHADOW_AWS_IOT_SHADOW_TOPICS_H_ */
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_thread_pool.h
+ * @brief Fixed size pool of worker threads running queued tasks
+ *
+ * Built only on the threads interface, so it works on every platform port. Idle workers park on a
+ * condition variable instead of polling, submitting a task wakes exactly one of them. The task
+ * queue is a fixed ring of AWS_IOT_THREAD_POOL_QUEUE_SIZE entries, the pool never allocates.
+ */
+
+#ifndef AWS_IOT_SDK_SRC_IOT_THREAD_POOL_H
+#define AWS_IOT_SDK_SRC_IOT_THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "aws_iot_error.h"
+#include "aws_iot_config.h"
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+
+#include "threads_interface.h"
+
+#ifndef AWS_IOT_THREAD_POOL_MAX_THREADS
+#define AWS_IOT_THREAD_POOL_MAX_THREADS 4
+#endif
+
+#ifndef AWS_IOT_THREAD_POOL_QUEUE_SIZE
+#define AWS_IOT_THREAD_POOL_QUEUE_SIZE 16
+#endif
+
+/**
+ * @brief Task run by a pool worker
+ */
+typedef void (*IoT_Thread_Pool_Task_t)(void *pArg);
+
+/**
+ * @brief Queued task
+ */
+typedef struct {
+	IoT_Thread_Pool_Task_t task;	///< Function to run
+	void *pArg;			///< Argument passed to the function
+} IoT_Thread_Pool_Job_t;
+
+/**
+ * @brief Thread pool
+ */
+typedef struct {
+	IoT_Mutex_t lock;		///< Guards every field below
+	IoT_Cond_t workAvailable;	///< Signalled when a task is queued or the pool is stopping
+	IoT_Cond_t idle;		///< Broadcast when the queue is empty and no task is running
+	IoT_Thread_t threads[AWS_IOT_THREAD_POOL_MAX_THREADS];	///< Workers
+	IoT_Thread_Pool_Job_t queue[AWS_IOT_THREAD_POOL_QUEUE_SIZE];	///< Ring of queued tasks
+	uint16_t queueHead;		///< Index of the oldest queued task
+	uint16_t queueCount;		///< Number of queued tasks
+	uint8_t threadCount;		///< Workers started
+	uint8_t busyCount;		///< Workers running a task
+	bool isStopping;		///< Set by destroy, workers exit once the queue is empty
+} IoT_Thread_Pool_t;
+
+/**
+ * @brief Start the workers of a pool
+ *
+ * @param pPool pool to initialize
+ * @param threadCount number of workers, 1 to AWS_IOT_THREAD_POOL_MAX_THREADS
+ * @param pParams priority, CPU affinity and stack size of every worker, NULL for the defaults
+ *
+ * @return NULL_VALUE_ERROR, LIMIT_EXCEEDED_ERROR for a bad thread count, the error of the failed
+ * lock, condition variable or thread creation, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_thread_pool_init(IoT_Thread_Pool_t *pPool, uint8_t threadCount,
+									 const IoT_Thread_Params_t *pParams);
+
+/**
+ * @brief Queue a task, an idle worker runs it
+ *
+ * Tasks start in submission order. A task may submit further tasks but must not wait for the pool.
+ *
+ * @param pPool pool
+ * @param task function to run
+ * @param pArg argument passed to the function
+ *
+ * @return NULL_VALUE_ERROR, LIMIT_EXCEEDED_ERROR if the queue is full, FAILURE if the pool is
+ * stopping, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_thread_pool_submit(IoT_Thread_Pool_t *pPool, IoT_Thread_Pool_Task_t task, void *pArg);
+
+/**
+ * @brief Wait until every queued task has finished
+ *
+ * @param pPool pool
+ * @param timeoutMs maximum time to wait in milliseconds
+ *
+ * @return NULL_VALUE_ERROR, THREAD_WAIT_TIMEOUT_ERROR if tasks are still queued or running,
+ * otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_thread_pool_wait_idle(IoT_Thread_Pool_t *pPool, uint32_t timeoutMs);
+
+/**
+ * @brief Stop the workers once the queued tasks have run, and release the pool
+ *
+ * @param pPool pool
+ *
+ * @return NULL_VALUE_ERROR, the first error of joining the workers or destroying the lock and
+ * condition variables, otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_thread_pool_destroy(IoT_Thread_Pool_t *pPool);
+
+#endif /* _ENABLE_THREAD_SUPPORT_ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOT_SDK_SRC_IOT_THREAD_POOL_H */
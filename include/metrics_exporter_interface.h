@@ -0,0 +1,99 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file metrics_exporter_interface.h
+ * @brief Optional local endpoint serving the MQTT client metrics as text
+ *
+ * The exporter listens on a local endpoint (a Unix domain socket on Linux). Every connection that
+ * is pending when aws_iot_metrics_exporter_serve() is called receives the metrics of the given
+ * clients, rendered by aws_iot_mqtt_client_metrics_to_text(), and is then closed. Serving never
+ * blocks so it can be called from the application loop next to aws_iot_mqtt_yield(), e.g.
+ * `socat - UNIX-CONNECT:/tmp/aws_iot_metrics.sock` prints the current values.
+ *
+ * Not used by the SDK itself. Porting is only needed if the application uses the exporter.
+ */
+
+#ifndef __METRICS_EXPORTER_INTERFACE_H_
+#define __METRICS_EXPORTER_INTERFACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The platform specific header that defines the MetricsExporter struct
+ */
+#include "metrics_exporter_platform.h"
+
+#include <stddef.h>
+
+#include "aws_iot_error.h"
+#include "aws_iot_mqtt_client.h"
+
+/**
+ * @brief Size of the buffer the metrics of one client are rendered into
+ */
+#ifndef AWS_IOT_METRICS_EXPORTER_BUF_LEN
+#define AWS_IOT_METRICS_EXPORTER_BUF_LEN 8192
+#endif
+
+/**
+ * @brief Metrics exporter Type
+ *
+ * Forward declaration of the exporter struct. The definition of this struct is
+ * platform dependent.
+ */
+typedef struct MetricsExporter MetricsExporter;
+
+/**
+ * @brief Start listening for metrics requests
+ *
+ * @param pExporter exporter to initialize
+ * @param pEndpoint platform specific endpoint name, the socket path on Linux
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR or FAILURE if the endpoint could not be opened
+ */
+IoT_Error_t aws_iot_metrics_exporter_init(MetricsExporter *pExporter, const char *pEndpoint);
+
+/**
+ * @brief Answer all pending metrics requests
+ *
+ * Does not block. Clients without a label are numbered by their position in ppClients.
+ *
+ * @param pExporter initialized exporter
+ * @param ppClients clients whose metrics are served
+ * @param ppLabels value of the client label per client, may be NULL
+ * @param clientCount number of entries in ppClients
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR or FAILURE if accepting a request failed
+ */
+IoT_Error_t aws_iot_metrics_exporter_serve(MetricsExporter *pExporter, AWS_IoT_Client **ppClients,
+										   const char **ppLabels, size_t clientCount);
+
+/**
+ * @brief Stop listening and release the endpoint
+ *
+ * @param pExporter exporter to destroy
+ *
+ * @return SUCCESS or NULL_VALUE_ERROR
+ */
+IoT_Error_t aws_iot_metrics_exporter_destroy(MetricsExporter *pExporter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __METRICS_EXPORTER_INTERFACE_H_ */
@@ -70,6 +70,7 @@ struct Network {
 	IoT_Error_t (*disconnect)(Network *);    ///< Function pointer pointing to the network function to disconnect from the network
 	IoT_Error_t (*isConnected)(Network *);    ///< Function pointer pointing to the network function to check if TLS is connected
 	IoT_Error_t (*destroy)(Network *);        ///< Function pointer pointing to the network function to destroy the network object
+	IoT_Error_t (*wakeup)(Network *);        ///< Function pointer pointing to the network function to interrupt a read waiting for data, NULL if not supported
 
 	TLSConnectParams tlsConnectParams;        ///< TLSConnect params structure containing the common connection parameters
 	TLSDataParams tlsDataParams;            ///< TLSData params structure containing the connection data parameters that are specific to the library being used
@@ -160,6 +161,27 @@ IoT_Error_t iot_tls_destroy(Network *pNetwork);
  */
 IoT_Error_t iot_tls_is_connected(Network *pNetwork);
 
+/**
+ * @brief Interrupt a read waiting for data
+ *
+ * Makes a current or the next call to iot_tls_read that has not received any data yet return
+ * NETWORK_SSL_NOTHING_TO_READ without waiting for its timer. Safe to call from any thread.
+ *
+ * @param Network - Pointer to a Network struct defining the network interface
+ * @return IoT_Error_t - successful wakeup or TLS error code
+ */
+IoT_Error_t iot_tls_wakeup(Network *pNetwork);
+
+/**
+ * @brief Release what iot_tls_init set up
+ *
+ * Called once the network will not be used again, unlike iot_tls_destroy which ends one connection.
+ *
+ * @param Network - Pointer to a Network struct defining the network interface
+ * @return IoT_Error_t - successful cleanup or TLS error code
+ */
+IoT_Error_t iot_tls_free(Network *pNetwork);
+
 #ifdef __cplusplus
 }
 #endif
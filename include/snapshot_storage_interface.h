@@ -0,0 +1,69 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file snapshot_storage_interface.h
+ * @brief Storage of the shadow mirror snapshots
+ *
+ * A snapshot is a small document stored under a name, the snapshot file given to
+ * aws_iot_shadow_mirror_enable(). Writing must replace the stored snapshot atomically so
+ * that a power loss leaves either the old or the new one. On Linux the name is a file path,
+ * written through a temporary file that is synced before it is renamed.
+ *
+ * Only called by the shadow mirror, and from aws_iot_shadow_yield() at most once per snapshot
+ * interval. Porting is only needed if the application mirrors shadows with a snapshot.
+ */
+
+#ifndef __SNAPSHOT_STORAGE_INTERFACE_H_
+#define __SNAPSHOT_STORAGE_INTERFACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "aws_iot_error.h"
+
+/**
+ * @brief Replace the snapshot stored under a name
+ *
+ * @param pName name of the snapshot
+ * @param pData snapshot to store
+ * @param length length of pData
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR or FAILURE if the snapshot could not be stored, the
+ *         previous snapshot is then left in place
+ */
+IoT_Error_t aws_iot_snapshot_storage_write(const char *pName, const char *pData, size_t length);
+
+/**
+ * @brief Read the snapshot stored under a name
+ *
+ * @param pName name of the snapshot
+ * @param pBuffer buffer the snapshot is read into
+ * @param bufferLen size of pBuffer
+ * @param pLength set to the length of the snapshot
+ *
+ * @return SUCCESS, NULL_VALUE_ERROR, MAX_SIZE_ERROR if the snapshot is longer than bufferLen or
+ *         FAILURE if there is no snapshot or it could not be read
+ */
+IoT_Error_t aws_iot_snapshot_storage_read(const char *pName, char *pBuffer, size_t bufferLen, size_t *pLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SNAPSHOT_STORAGE_INTERFACE_H_ */
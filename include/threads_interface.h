@@ -31,6 +31,27 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ENABLE_IOT_MUTEX_STATS
+/**
+ * @brief Contention statistics of one mutex
+ *
+ * Kept by the platform when the SDK is built with ENABLE_IOT_MUTEX_STATS. Times are in nanoseconds.
+ * A thread waiting on a condition variable does not hold the mutex for that time.
+ */
+typedef struct {
+	uint64_t acquireCount;		///< Successful lock and trylock calls
+	uint64_t contendedCount;	///< Lock calls that had to wait plus trylock calls that failed
+	uint64_t failedTryCount;	///< Trylock calls that failed because the mutex was held
+	uint64_t totalWaitNs;		///< Time lock calls spent waiting for the mutex
+	uint64_t maxWaitNs;		///< Longest single wait
+	uint64_t totalHoldNs;		///< Time the mutex was held
+	uint64_t maxHoldNs;		///< Longest single hold
+} IoT_Mutex_Stats_t;
+#endif
+
 /**
  * The platform specific timer header that defines the Timer struct
  */
@@ -100,6 +121,193 @@ IoT_Error_t aws_iot_thread_mutex_unlock(IoT_Mutex_t *);
  */
 IoT_Error_t aws_iot_thread_mutex_destroy(IoT_Mutex_t *);
 
+#ifdef ENABLE_IOT_MUTEX_STATS
+/**
+ * @brief Copy the contention statistics of the provided mutex
+ *
+ * Does not take the mutex. Counters updated while copying may be off by the update in progress.
+ *
+ * @param IoT_Mutex_t - pointer to the mutex
+ * @param IoT_Mutex_Stats_t - filled with the statistics
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_mutex_get_stats(IoT_Mutex_t *, IoT_Mutex_Stats_t *);
+
+/**
+ * @brief Set the contention statistics of the provided mutex to zero
+ *
+ * @param IoT_Mutex_t - pointer to the mutex
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_mutex_reset_stats(IoT_Mutex_t *);
+#endif
+
+/**
+ * @brief Condition Variable Type
+ *
+ * Forward declaration of a condition variable struct. The definition of this struct is
+ * platform dependent. When porting to a new platform add this definition
+ * in "threads_platform.h".
+ *
+ */
+typedef struct _IoT_Cond_t IoT_Cond_t;
+
+/**
+ * @brief Counting Semaphore Type
+ *
+ * Forward declaration of a counting semaphore struct. The definition of this struct is
+ * platform dependent. When porting to a new platform add this definition
+ * in "threads_platform.h".
+ *
+ */
+typedef struct _IoT_Semaphore_t IoT_Semaphore_t;
+
+/**
+ * @brief Thread Type
+ *
+ * Forward declaration of a thread struct. The definition of this struct is
+ * platform dependent. When porting to a new platform add this definition
+ * in "threads_platform.h".
+ *
+ */
+typedef struct _IoT_Thread_t IoT_Thread_t;
+
+/**
+ * @brief Function run by a thread created with aws_iot_thread_create
+ */
+typedef void (*IoT_Thread_Routine_t)(void *pArg);
+
+/**
+ * @brief Thread creation parameters
+ *
+ * Platforms ignore the settings they cannot apply, see the platform port for their meaning.
+ */
+typedef struct {
+	int32_t priority;	///< Scheduling priority, 0 to inherit the scheduling of the creating thread
+	int32_t cpuAffinity;	///< Index of the CPU to run on, -1 for any CPU
+	size_t stackSize;	///< Stack size in bytes, 0 for the platform default
+} IoT_Thread_Params_t;
+extern const IoT_Thread_Params_t iotThreadParamsDefault;
+
+#define IoT_Thread_Params_initializer { 0, -1, 0 }
+
+/**
+ * @brief Initialize the provided condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable to be initialized
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_cond_init(IoT_Cond_t *);
+
+/**
+ * @brief Wait on the condition variable
+ *
+ * Call this function with the mutex locked. The mutex is released while waiting and locked again
+ * before returning. Wakeups may be spurious, check the awaited condition in a loop.
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @param IoT_Mutex_t - pointer to the locked mutex guarding the condition
+ * @param uint32_t - maximum time to wait in milliseconds
+ * @return IoT_Error_t - SUCCESS, THREAD_WAIT_TIMEOUT_ERROR or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_cond_timedwait(IoT_Cond_t *, IoT_Mutex_t *, uint32_t);
+
+/**
+ * @brief Wait on the condition variable without a timeout
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @param IoT_Mutex_t - pointer to the locked mutex guarding the condition
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_cond_wait(IoT_Cond_t *, IoT_Mutex_t *);
+
+/**
+ * @brief Wake one thread waiting on the condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_cond_signal(IoT_Cond_t *);
+
+/**
+ * @brief Wake all threads waiting on the condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_cond_broadcast(IoT_Cond_t *);
+
+/**
+ * @brief Destroy the provided condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable to be destroyed
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_cond_destroy(IoT_Cond_t *);
+
+/**
+ * @brief Initialize the provided counting semaphore
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore to be initialized
+ * @param uint32_t - initial count
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_semaphore_init(IoT_Semaphore_t *, uint32_t);
+
+/**
+ * @brief Take the semaphore, waiting at most the given time for its count to become positive
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore
+ * @param uint32_t - maximum time to wait in milliseconds, 0 to only try
+ * @return IoT_Error_t - SUCCESS, THREAD_WAIT_TIMEOUT_ERROR or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_semaphore_timedwait(IoT_Semaphore_t *, uint32_t);
+
+/**
+ * @brief Take the semaphore, waiting as long as its count is zero
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_semaphore_wait(IoT_Semaphore_t *);
+
+/**
+ * @brief Give the semaphore, waking one waiting thread
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_semaphore_post(IoT_Semaphore_t *);
+
+/**
+ * @brief Destroy the provided semaphore
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore to be destroyed
+ * @return IoT_Error_t - SUCCESS or THREAD_SYNC_ERROR
+ */
+IoT_Error_t aws_iot_thread_semaphore_destroy(IoT_Semaphore_t *);
+
+/**
+ * @brief Start a thread running the given routine
+ *
+ * The thread struct must stay valid until the thread is joined.
+ *
+ * @param IoT_Thread_t - pointer to the thread to be started
+ * @param IoT_Thread_Routine_t - routine run by the thread
+ * @param void * - argument passed to the routine
+ * @param IoT_Thread_Params_t - priority, CPU affinity and stack size, NULL for the defaults
+ * @return IoT_Error_t - SUCCESS or THREAD_CREATE_ERROR
+ */
+IoT_Error_t aws_iot_thread_create(IoT_Thread_t *, IoT_Thread_Routine_t, void *, const IoT_Thread_Params_t *);
+
+/**
+ * @brief Wait for a thread to return from its routine
+ *
+ * @param IoT_Thread_t - pointer to the thread to be joined
+ * @return IoT_Error_t - SUCCESS or THREAD_CREATE_ERROR
+ */
+IoT_Error_t aws_iot_thread_join(IoT_Thread_t *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -89,6 +89,17 @@ void countdown_sec(Timer *, uint32_t);
  */
 uint32_t left_ms(Timer *);
 
+/**
+ * @brief Read a monotonic clock (nanoseconds)
+ *
+ * Returns the current value of a clock that is not affected by wall clock changes.
+ * Only differences between two readings are meaningful. Used by the SDK to measure
+ * durations for profiling and client metrics, so it should be cheap to call.
+ *
+ * @return uint64_t - current monotonic time in nanoseconds
+ */
+uint64_t get_monotonic_time_ns(void);
+
 /**
  * @brief Initialize a timer
  *
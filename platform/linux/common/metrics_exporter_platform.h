@@ -0,0 +1,40 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AWS_IOTSDK_SRC_PLATFORM_LINUX_COMMON_METRICS_EXPORTER_PLATFORM_H_
+#define AWS_IOTSDK_SRC_PLATFORM_LINUX_COMMON_METRICS_EXPORTER_PLATFORM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file metrics_exporter_platform.h
+ */
+#include <sys/un.h>
+
+/**
+ * definition of the MetricsExporter struct. Platform specific
+ */
+struct MetricsExporter {
+	int listenFd;
+	char socketPath[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AWS_IOTSDK_SRC_PLATFORM_LINUX_COMMON_METRICS_EXPORTER_PLATFORM_H_ */
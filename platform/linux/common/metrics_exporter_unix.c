@@ -0,0 +1,154 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file metrics_exporter_unix.c
+ * @brief Linux implementation of the metrics exporter on a Unix domain socket
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "metrics_exporter_interface.h"
+
+#ifndef DISABLE_IOT_CLIENT_METRICS
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+IoT_Error_t aws_iot_metrics_exporter_init(MetricsExporter *pExporter, const char *pEndpoint) {
+	struct sockaddr_un addr;
+	int fd;
+
+	if(NULL == pExporter || NULL == pEndpoint) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pExporter->listenFd = -1;
+	if(strlen(pEndpoint) >= sizeof(addr.sun_path)) {
+		return FAILURE;
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0) {
+		return FAILURE;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, pEndpoint, sizeof(addr.sun_path) - 1);
+
+	/* A socket file left behind by a previous run would make bind fail */
+	unlink(pEndpoint);
+	if(0 != bind(fd, (struct sockaddr *) &addr, sizeof(addr)) || 0 != listen(fd, 4)
+	   || 0 != fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK)) {
+		close(fd);
+		return FAILURE;
+	}
+
+	pExporter->listenFd = fd;
+	strncpy(pExporter->socketPath, pEndpoint, sizeof(pExporter->socketPath) - 1);
+	pExporter->socketPath[sizeof(pExporter->socketPath) - 1] = '\0';
+
+	return SUCCESS;
+}
+
+static void _aws_iot_metrics_exporter_write(int fd, const char *pBuf, size_t len) {
+	ssize_t sent;
+
+	while(len > 0) {
+		/* Never block the application loop on a slow reader, what does not fit is dropped */
+		sent = send(fd, pBuf, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if(sent < 0 && EINTR == errno) {
+			continue;
+		}
+		if(sent <= 0) {
+			return;
+		}
+		pBuf += sent;
+		len -= (size_t) sent;
+	}
+}
+
+IoT_Error_t aws_iot_metrics_exporter_serve(MetricsExporter *pExporter, AWS_IoT_Client **ppClients,
+										   const char **ppLabels, size_t clientCount) {
+	static char textBuf[AWS_IOT_METRICS_EXPORTER_BUF_LEN];
+	IoT_Client_Metrics_t metrics;
+	char defaultLabel[24];
+	const char *pLabel;
+	size_t textLen, i;
+	int fd;
+
+	if(NULL == pExporter || (NULL == ppClients && 0 != clientCount)) {
+		return NULL_VALUE_ERROR;
+	}
+	if(pExporter->listenFd < 0) {
+		return FAILURE;
+	}
+
+	for(;;) {
+		fd = accept(pExporter->listenFd, NULL, NULL);
+		if(fd < 0) {
+			if(EAGAIN == errno || EWOULDBLOCK == errno) {
+				return SUCCESS;
+			}
+			if(EINTR == errno || ECONNABORTED == errno) {
+				continue;
+			}
+			return FAILURE;
+		}
+
+		for(i = 0; i < clientCount; i++) {
+			if(SUCCESS != aws_iot_mqtt_get_client_metrics(ppClients[i], &metrics)) {
+				continue;
+			}
+			pLabel = (NULL != ppLabels) ? ppLabels[i] : NULL;
+			if(NULL == pLabel) {
+				snprintf(defaultLabel, sizeof(defaultLabel), "%u", (unsigned int) i);
+				pLabel = defaultLabel;
+			}
+			/* On MAX_SIZE_ERROR the text still holds the complete lines that fit */
+			aws_iot_mqtt_client_metrics_to_text(&metrics, pLabel, textBuf, sizeof(textBuf), &textLen);
+			_aws_iot_metrics_exporter_write(fd, textBuf, textLen);
+		}
+
+		close(fd);
+	}
+}
+
+IoT_Error_t aws_iot_metrics_exporter_destroy(MetricsExporter *pExporter) {
+	if(NULL == pExporter) {
+		return NULL_VALUE_ERROR;
+	}
+
+	if(pExporter->listenFd >= 0) {
+		close(pExporter->listenFd);
+		unlink(pExporter->socketPath);
+		pExporter->listenFd = -1;
+	}
+
+	return SUCCESS;
+}
+
+#endif /* DISABLE_IOT_CLIENT_METRICS */
+
+#ifdef __cplusplus
+}
+#endif
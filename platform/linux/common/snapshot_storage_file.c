@@ -0,0 +1,96 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file snapshot_storage_file.c
+ * @brief Linux implementation of the snapshot storage on files
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "snapshot_storage_interface.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+
+IoT_Error_t aws_iot_snapshot_storage_write(const char *pName, const char *pData, size_t length) {
+	char tempFile[PATH_MAX];
+	FILE *pFile;
+	size_t written;
+	int rc;
+
+	if(NULL == pName || NULL == pData) {
+		return NULL_VALUE_ERROR;
+	}
+
+	if(snprintf(tempFile, sizeof(tempFile), "%s.tmp", pName) >= (int) sizeof(tempFile)) {
+		return FAILURE;
+	}
+	pFile = fopen(tempFile, "wb");
+	if(NULL == pFile) {
+		return FAILURE;
+	}
+
+	/* The data must be on disk before the rename makes it the snapshot */
+	written = fwrite(pData, 1, length, pFile);
+	rc = fflush(pFile);
+	if(0 == rc) {
+		rc = fsync(fileno(pFile));
+	}
+	if(0 != fclose(pFile) || 0 != rc || written != length || 0 != rename(tempFile, pName)) {
+		remove(tempFile);
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_snapshot_storage_read(const char *pName, char *pBuffer, size_t bufferLen, size_t *pLength) {
+	FILE *pFile;
+	size_t length;
+	bool isComplete;
+	bool isTooLarge;
+
+	if(NULL == pName || NULL == pBuffer || NULL == pLength) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pFile = fopen(pName, "rb");
+	if(NULL == pFile) {
+		return FAILURE;
+	}
+	/* A snapshot filling pBuffer exactly fits, it is too large only if a byte follows */
+	length = fread(pBuffer, 1, bufferLen, pFile);
+	isTooLarge = (length == bufferLen) && (EOF != fgetc(pFile));
+	isComplete = !isTooLarge && !ferror(pFile);
+	fclose(pFile);
+	if(isTooLarge) {
+		return MAX_SIZE_ERROR;
+	}
+	if(!isComplete) {
+		return FAILURE;
+	}
+
+	*pLength = length;
+	return SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,6 +26,7 @@ extern "C" {
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
 
 #include "timer_platform.h"
 
@@ -65,6 +66,12 @@ void countdown_sec(Timer *timer, uint32_t timeout) {
 	timeradd(&now, &interval, &timer->end_time);
 }
 
+uint64_t get_monotonic_time_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
 void init_timer(Timer *timer) {
 	timer->end_time = (struct timeval) {0, 0};
 }
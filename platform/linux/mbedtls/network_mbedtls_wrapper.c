@@ -17,8 +17,15 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_NETWORK
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include <timer_platform.h>
 #include <network_interface.h>
 
@@ -84,9 +91,17 @@ IoT_Error_t iot_tls_init(Network *pNetwork, char *pRootCALocation, char *pDevice
 	pNetwork->disconnect = iot_tls_disconnect;
 	pNetwork->isConnected = iot_tls_is_connected;
 	pNetwork->destroy = iot_tls_destroy;
+	pNetwork->wakeup = iot_tls_wakeup;
 
 	pNetwork->tlsDataParams.flags = 0;
 
+	/* Lives as long as the client, connections come and go through connect and destroy */
+	pNetwork->tlsDataParams.wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(-1 == pNetwork->tlsDataParams.wakeup_fd) {
+		IOT_ERROR(" failed\n  ! eventfd returned %d\n", errno);
+		return NETWORK_ERR_NET_SOCKET_FAILED;
+	}
+
 	return SUCCESS;
 }
 
@@ -315,12 +330,48 @@ IoT_Error_t iot_tls_write(Network *pNetwork, unsigned char *pMsg, size_t len, Ti
 	return SUCCESS;
 }
 
+/* Waits until the socket is readable, the timer expires or iot_tls_wakeup is called.
+ * Returns false when there is nothing to read */
+static bool _iot_tls_wait_readable(TLSDataParams *tlsDataParams, Timer *timer) {
+	struct pollfd fds[2];
+	uint64_t wakeups;
+	uint32_t waitMs;
+	int ret;
+
+	fds[0].fd = tlsDataParams->server_fd.fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = tlsDataParams->wakeup_fd;
+	fds[1].events = POLLIN;
+
+	do {
+		waitMs = left_ms(timer);
+		ret = poll(fds, 2, (waitMs > INT_MAX) ? INT_MAX : (int) waitMs);
+	} while (ret < 0 && EINTR == errno);
+
+	if (ret < 0 || 0 != fds[0].revents) {
+		// Data, hangup and poll errors are all reported by the read
+		return true;
+	}
+
+	if (0 != fds[1].revents) {
+		(void) read(tlsDataParams->wakeup_fd, &wakeups, sizeof(wakeups));
+	}
+
+	return false;
+}
+
 IoT_Error_t iot_tls_read(Network *pNetwork, unsigned char *pMsg, size_t len, Timer *timer, size_t *read_len) {
 	mbedtls_ssl_context *ssl = &(pNetwork->tlsDataParams.ssl);
 	size_t rxLen = 0;
 	int ret;
 
 	while (len > 0) {
+		// Until the first byte arrives, wait on the socket and the wakeup channel together
+		if (0 == rxLen && 0 == mbedtls_ssl_get_bytes_avail(ssl)
+			&& !_iot_tls_wait_readable(&(pNetwork->tlsDataParams), timer)) {
+			break;
+		}
+
 		// This read will timeout after IOT_SSL_READ_TIMEOUT if there's no data to be read
 		ret = mbedtls_ssl_read(ssl, pMsg, len);
 		if (ret > 0) {
@@ -362,6 +413,34 @@ IoT_Error_t iot_tls_disconnect(Network *pNetwork) {
 	return SUCCESS;
 }
 
+IoT_Error_t iot_tls_wakeup(Network *pNetwork) {
+	uint64_t wakeup = 1;
+
+	if(NULL == pNetwork) {
+		return NULL_VALUE_ERROR;
+	}
+
+	/* EAGAIN means the counter is full, the reader is woken either way */
+	if(sizeof(wakeup) != write(pNetwork->tlsDataParams.wakeup_fd, &wakeup, sizeof(wakeup)) && EAGAIN != errno) {
+		return NETWORK_ERR_NET_SOCKET_FAILED;
+	}
+
+	return SUCCESS;
+}
+
+IoT_Error_t iot_tls_free(Network *pNetwork) {
+	if(NULL == pNetwork) {
+		return NULL_VALUE_ERROR;
+	}
+
+	if(-1 != pNetwork->tlsDataParams.wakeup_fd) {
+		close(pNetwork->tlsDataParams.wakeup_fd);
+		pNetwork->tlsDataParams.wakeup_fd = -1;
+	}
+
+	return SUCCESS;
+}
+
 IoT_Error_t iot_tls_destroy(Network *pNetwork) {
 	TLSDataParams *tlsDataParams = &(pNetwork->tlsDataParams);
 
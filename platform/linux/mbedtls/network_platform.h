@@ -48,6 +48,7 @@ typedef struct _TLSDataParams {
 	mbedtls_x509_crt clicert;
 	mbedtls_pk_context pkey;
 	mbedtls_net_context server_fd;
+	int wakeup_fd;
 }TLSDataParams;
 
 #define IOTSDKC_NETWORK_MBEDTLS_PLATFORM_H_H
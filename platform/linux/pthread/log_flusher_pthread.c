@@ -0,0 +1,98 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file log_flusher_pthread.c
+ * @brief pthread implementation of the asynchronous logger background flusher
+ */
+
+#include "threads_platform.h"
+#if defined(_ENABLE_THREAD_SUPPORT_) && defined(ENABLE_IOT_LOG_ASYNC)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <time.h>
+
+#include "aws_iot_log_async.h"
+
+static pthread_t logFlusherThread;
+static uint8_t isLogFlusherRunning;
+static uint32_t logFlusherIntervalMs;
+
+static void *_log_flusher_thread_main(void *pArg) {
+	struct timespec interval;
+	IOT_UNUSED(pArg);
+
+	interval.tv_sec = logFlusherIntervalMs / 1000;
+	interval.tv_nsec = (long) (logFlusherIntervalMs % 1000) * 1000000L;
+
+	while(__atomic_load_n(&isLogFlusherRunning, __ATOMIC_ACQUIRE)) {
+		aws_iot_log_async_flush();
+		nanosleep(&interval, NULL);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Start the background flusher thread
+ *
+ * @param intervalMs - drain period in milliseconds
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_log_async_start_flusher(uint32_t intervalMs) {
+	uint8_t expected = 0;
+
+	if(0 == intervalMs) {
+		intervalMs = 1;
+	}
+	if(!__atomic_compare_exchange_n(&isLogFlusherRunning, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return FAILURE;
+	}
+
+	logFlusherIntervalMs = intervalMs;
+	if(0 != pthread_create(&logFlusherThread, NULL, _log_flusher_thread_main, NULL)) {
+		__atomic_store_n(&isLogFlusherRunning, 0, __ATOMIC_RELEASE);
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Stop the background flusher thread and drain what is left in the ring
+ *
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_log_async_stop_flusher(void) {
+	uint8_t expected = 1;
+
+	if(!__atomic_compare_exchange_n(&isLogFlusherRunning, &expected, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return FAILURE;
+	}
+
+	pthread_join(logFlusherThread, NULL);
+	aws_iot_log_async_flush();
+
+	return SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ENABLE_THREAD_SUPPORT_ && ENABLE_IOT_LOG_ASYNC */
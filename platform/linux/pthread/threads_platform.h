@@ -32,6 +32,45 @@ extern "C" {
  */
 struct _IoT_Mutex_t {
 	pthread_mutex_t lock;
+#ifdef ENABLE_IOT_MUTEX_STATS
+	IoT_Mutex_Stats_t stats;
+	uint64_t lockedAtNs;
+#endif
+};
+
+/**
+ * @brief Condition Variable Type
+ *
+ * definition of the Condition Variable struct. Platform specific, timed waits use the monotonic clock
+ *
+ */
+struct _IoT_Cond_t {
+	pthread_cond_t cond;
+};
+
+/**
+ * @brief Counting Semaphore Type
+ *
+ * definition of the Counting Semaphore struct. Platform specific, built on a condition variable
+ * so timed waits use the monotonic clock like the rest of the port
+ *
+ */
+struct _IoT_Semaphore_t {
+	pthread_mutex_t lock;
+	pthread_cond_t available;
+	uint32_t count;
+};
+
+/**
+ * @brief Thread Type
+ *
+ * definition of the Thread struct. Platform specific
+ *
+ */
+struct _IoT_Thread_t {
+	pthread_t thread;
+	void (*routine)(void *pArg);
+	void *pArg;
 };
 
 #ifdef __cplusplus
@@ -13,13 +13,97 @@
  * permissions and limitations under the License.
  */
 
+/* pthread_attr_setaffinity_np is a GNU extension */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "threads_platform.h"
 #ifdef _ENABLE_THREAD_SUPPORT_
 
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+const IoT_Thread_Params_t iotThreadParamsDefault = IoT_Thread_Params_initializer;
+
+/* Absolute CLOCK_MONOTONIC time timeoutMs from now, for the timed waits */
+static void _aws_iot_thread_deadline(struct timespec *pDeadline, uint32_t timeoutMs) {
+	clock_gettime(CLOCK_MONOTONIC, pDeadline);
+	pDeadline->tv_sec += timeoutMs / 1000;
+	pDeadline->tv_nsec += (long) (timeoutMs % 1000) * 1000000L;
+	if(pDeadline->tv_nsec >= 1000000000L) {
+		pDeadline->tv_sec++;
+		pDeadline->tv_nsec -= 1000000000L;
+	}
+}
+
+static int _aws_iot_thread_monotonic_cond_init(pthread_cond_t *pCond) {
+	pthread_condattr_t attr;
+	int rc;
+
+	if(0 != pthread_condattr_init(&attr)) {
+		return -1;
+	}
+	rc = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	if(0 == rc) {
+		rc = pthread_cond_init(pCond, &attr);
+	}
+	pthread_condattr_destroy(&attr);
+
+	return rc;
+}
+
+#ifdef ENABLE_IOT_MUTEX_STATS
+/* Counters are updated atomically so they can be read without the mutex. The max fields are only
+ * written while holding the mutex, so a plain compare before the store is enough. */
+#define MUTEX_STATS_ADD(pMutex, field, value) __atomic_fetch_add(&((pMutex)->stats.field), (value), __ATOMIC_RELAXED)
+#define MUTEX_STATS_MAX(pMutex, field, value) \
+	do { \
+		if((value) > __atomic_load_n(&((pMutex)->stats.field), __ATOMIC_RELAXED)) { \
+			__atomic_store_n(&((pMutex)->stats.field), (value), __ATOMIC_RELAXED); \
+		} \
+	} while(0)
+
+static uint64_t _aws_iot_thread_now_ns(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+/* Called with the mutex just acquired */
+static void _aws_iot_thread_mutex_stats_acquired(IoT_Mutex_t *pMutex, uint64_t waitNs) {
+	MUTEX_STATS_ADD(pMutex, acquireCount, 1);
+	if(0 != waitNs) {
+		MUTEX_STATS_ADD(pMutex, totalWaitNs, waitNs);
+		MUTEX_STATS_MAX(pMutex, maxWaitNs, waitNs);
+	}
+	pMutex->lockedAtNs = _aws_iot_thread_now_ns();
+}
+
+/* Called with the mutex still held, right before it is released */
+static void _aws_iot_thread_mutex_stats_releasing(IoT_Mutex_t *pMutex) {
+	uint64_t holdNs = _aws_iot_thread_now_ns() - pMutex->lockedAtNs;
+
+	MUTEX_STATS_ADD(pMutex, totalHoldNs, holdNs);
+	MUTEX_STATS_MAX(pMutex, maxHoldNs, holdNs);
+}
+#endif
+
+static void *_aws_iot_thread_start(void *pArg) {
+	IoT_Thread_t *pThread = (IoT_Thread_t *) pArg;
+
+	pThread->routine(pThread->pArg);
+
+	return NULL;
+}
+
 /**
  * @brief Initialize the provided mutex
  *
@@ -32,6 +116,10 @@ IoT_Error_t aws_iot_thread_mutex_init(IoT_Mutex_t *pMutex) {
 	if(0 != pthread_mutex_init(&(pMutex->lock), NULL)) {
 		return MUTEX_INIT_ERROR;
 	}
+#ifdef ENABLE_IOT_MUTEX_STATS
+	memset(&(pMutex->stats), 0, sizeof(IoT_Mutex_Stats_t));
+	pMutex->lockedAtNs = 0;
+#endif
 
 	return SUCCESS;
 }
@@ -46,10 +134,26 @@ IoT_Error_t aws_iot_thread_mutex_init(IoT_Mutex_t *pMutex) {
  * @return IoT_Error_t - error code indicating result of operation
  */
 IoT_Error_t aws_iot_thread_mutex_lock(IoT_Mutex_t *pMutex) {
+#ifdef ENABLE_IOT_MUTEX_STATS
+	uint64_t waitStartNs;
+
+	/* Only a lock that finds the mutex held is timed */
+	if(0 == pthread_mutex_trylock(&(pMutex->lock))) {
+		_aws_iot_thread_mutex_stats_acquired(pMutex, 0);
+		return SUCCESS;
+	}
+	MUTEX_STATS_ADD(pMutex, contendedCount, 1);
+	waitStartNs = _aws_iot_thread_now_ns();
+	if(0 != pthread_mutex_lock(&(pMutex->lock))) {
+		return MUTEX_LOCK_ERROR;
+	}
+	_aws_iot_thread_mutex_stats_acquired(pMutex, _aws_iot_thread_now_ns() - waitStartNs);
+#else
 int rc = pthread_mutex_lock(&(pMutex->lock));
 	if(0 != rc) {
 		return MUTEX_LOCK_ERROR;
 	}
+#endif
 
 	return SUCCESS;
 }
@@ -66,8 +170,17 @@ int rc = pthread_mutex_lock(&(pMutex->lock));
 IoT_Error_t aws_iot_thread_mutex_trylock(IoT_Mutex_t *pMutex) {
 int rc = pthread_mutex_trylock(&(pMutex->lock));
 	if(0 != rc) {
+#ifdef ENABLE_IOT_MUTEX_STATS
+		if(EBUSY == rc) {
+			MUTEX_STATS_ADD(pMutex, contendedCount, 1);
+			MUTEX_STATS_ADD(pMutex, failedTryCount, 1);
+		}
+#endif
 		return MUTEX_LOCK_ERROR;
 	}
+#ifdef ENABLE_IOT_MUTEX_STATS
+	_aws_iot_thread_mutex_stats_acquired(pMutex, 0);
+#endif
 
 	return SUCCESS;
 }
@@ -81,6 +194,9 @@ int rc = pthread_mutex_trylock(&(pMutex->lock));
  * @return IoT_Error_t - error code indicating result of operation
  */
 IoT_Error_t aws_iot_thread_mutex_unlock(IoT_Mutex_t *pMutex) {
+#ifdef ENABLE_IOT_MUTEX_STATS
+	_aws_iot_thread_mutex_stats_releasing(pMutex);
+#endif
 	if(0 != pthread_mutex_unlock(&(pMutex->lock))) {
 		return MUTEX_UNLOCK_ERROR;
 	}
@@ -104,6 +220,386 @@ IoT_Error_t aws_iot_thread_mutex_destroy(IoT_Mutex_t *pMutex) {
 	return SUCCESS;
 }
 
+#ifdef ENABLE_IOT_MUTEX_STATS
+/**
+ * @brief Copy the contention statistics of the provided mutex
+ *
+ * @param IoT_Mutex_t - pointer to the mutex
+ * @param IoT_Mutex_Stats_t - filled with the statistics
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_mutex_get_stats(IoT_Mutex_t *pMutex, IoT_Mutex_Stats_t *pStats) {
+	if(NULL == pMutex || NULL == pStats) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pStats->acquireCount = __atomic_load_n(&(pMutex->stats.acquireCount), __ATOMIC_RELAXED);
+	pStats->contendedCount = __atomic_load_n(&(pMutex->stats.contendedCount), __ATOMIC_RELAXED);
+	pStats->failedTryCount = __atomic_load_n(&(pMutex->stats.failedTryCount), __ATOMIC_RELAXED);
+	pStats->totalWaitNs = __atomic_load_n(&(pMutex->stats.totalWaitNs), __ATOMIC_RELAXED);
+	pStats->maxWaitNs = __atomic_load_n(&(pMutex->stats.maxWaitNs), __ATOMIC_RELAXED);
+	pStats->totalHoldNs = __atomic_load_n(&(pMutex->stats.totalHoldNs), __ATOMIC_RELAXED);
+	pStats->maxHoldNs = __atomic_load_n(&(pMutex->stats.maxHoldNs), __ATOMIC_RELAXED);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the contention statistics of the provided mutex to zero
+ *
+ * @param IoT_Mutex_t - pointer to the mutex
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_mutex_reset_stats(IoT_Mutex_t *pMutex) {
+	if(NULL == pMutex) {
+		return NULL_VALUE_ERROR;
+	}
+
+	__atomic_store_n(&(pMutex->stats.acquireCount), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&(pMutex->stats.contendedCount), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&(pMutex->stats.failedTryCount), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&(pMutex->stats.totalWaitNs), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&(pMutex->stats.maxWaitNs), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&(pMutex->stats.totalHoldNs), 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&(pMutex->stats.maxHoldNs), 0, __ATOMIC_RELAXED);
+
+	return SUCCESS;
+}
+#endif
+
+/**
+ * @brief Initialize the provided condition variable
+ *
+ * Timed waits on the condition variable are measured on CLOCK_MONOTONIC
+ *
+ * @param IoT_Cond_t - pointer to the condition variable to be initialized
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_cond_init(IoT_Cond_t *pCond) {
+	if(0 != _aws_iot_thread_monotonic_cond_init(&(pCond->cond))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wait on the provided condition variable for at most timeoutMs
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @param IoT_Mutex_t - pointer to the locked mutex guarding the condition
+ * @param uint32_t - maximum time to wait in milliseconds
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_cond_timedwait(IoT_Cond_t *pCond, IoT_Mutex_t *pMutex, uint32_t timeoutMs) {
+	struct timespec deadline;
+	int rc;
+
+	_aws_iot_thread_deadline(&deadline, timeoutMs);
+#ifdef ENABLE_IOT_MUTEX_STATS
+	_aws_iot_thread_mutex_stats_releasing(pMutex);
+#endif
+	rc = pthread_cond_timedwait(&(pCond->cond), &(pMutex->lock), &deadline);
+#ifdef ENABLE_IOT_MUTEX_STATS
+	pMutex->lockedAtNs = _aws_iot_thread_now_ns();
+#endif
+	if(ETIMEDOUT == rc) {
+		return THREAD_WAIT_TIMEOUT_ERROR;
+	}
+	if(0 != rc) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wait on the provided condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @param IoT_Mutex_t - pointer to the locked mutex guarding the condition
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_cond_wait(IoT_Cond_t *pCond, IoT_Mutex_t *pMutex) {
+	int rc;
+
+#ifdef ENABLE_IOT_MUTEX_STATS
+	_aws_iot_thread_mutex_stats_releasing(pMutex);
+#endif
+	rc = pthread_cond_wait(&(pCond->cond), &(pMutex->lock));
+#ifdef ENABLE_IOT_MUTEX_STATS
+	pMutex->lockedAtNs = _aws_iot_thread_now_ns();
+#endif
+	if(0 != rc) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wake one thread waiting on the provided condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_cond_signal(IoT_Cond_t *pCond) {
+	if(0 != pthread_cond_signal(&(pCond->cond))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wake all threads waiting on the provided condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_cond_broadcast(IoT_Cond_t *pCond) {
+	if(0 != pthread_cond_broadcast(&(pCond->cond))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Destroy the provided condition variable
+ *
+ * @param IoT_Cond_t - pointer to the condition variable to be destroyed
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_cond_destroy(IoT_Cond_t *pCond) {
+	if(0 != pthread_cond_destroy(&(pCond->cond))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Initialize the provided counting semaphore
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore to be initialized
+ * @param uint32_t - initial count
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_semaphore_init(IoT_Semaphore_t *pSemaphore, uint32_t initialCount) {
+	if(0 != pthread_mutex_init(&(pSemaphore->lock), NULL)) {
+		return THREAD_SYNC_ERROR;
+	}
+	if(0 != _aws_iot_thread_monotonic_cond_init(&(pSemaphore->available))) {
+		pthread_mutex_destroy(&(pSemaphore->lock));
+		return THREAD_SYNC_ERROR;
+	}
+	pSemaphore->count = initialCount;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Take the provided semaphore, waiting at most timeoutMs
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore
+ * @param uint32_t - maximum time to wait in milliseconds, 0 to only try
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_semaphore_timedwait(IoT_Semaphore_t *pSemaphore, uint32_t timeoutMs) {
+	IoT_Error_t rc = SUCCESS;
+	struct timespec deadline;
+	int waitRc;
+
+	if(0 != pthread_mutex_lock(&(pSemaphore->lock))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	_aws_iot_thread_deadline(&deadline, timeoutMs);
+	while(0 == pSemaphore->count) {
+		if(0 == timeoutMs) {
+			rc = THREAD_WAIT_TIMEOUT_ERROR;
+			break;
+		}
+		waitRc = pthread_cond_timedwait(&(pSemaphore->available), &(pSemaphore->lock), &deadline);
+		if(ETIMEDOUT == waitRc && 0 == pSemaphore->count) {
+			rc = THREAD_WAIT_TIMEOUT_ERROR;
+			break;
+		}
+		if(0 != waitRc && ETIMEDOUT != waitRc) {
+			rc = THREAD_SYNC_ERROR;
+			break;
+		}
+	}
+	if(SUCCESS == rc) {
+		pSemaphore->count--;
+	}
+
+	pthread_mutex_unlock(&(pSemaphore->lock));
+
+	return rc;
+}
+
+/**
+ * @brief Take the provided semaphore, waiting as long as its count is zero
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_semaphore_wait(IoT_Semaphore_t *pSemaphore) {
+	IoT_Error_t rc = SUCCESS;
+
+	if(0 != pthread_mutex_lock(&(pSemaphore->lock))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	while(0 == pSemaphore->count) {
+		if(0 != pthread_cond_wait(&(pSemaphore->available), &(pSemaphore->lock))) {
+			rc = THREAD_SYNC_ERROR;
+			break;
+		}
+	}
+	if(SUCCESS == rc) {
+		pSemaphore->count--;
+	}
+
+	pthread_mutex_unlock(&(pSemaphore->lock));
+
+	return rc;
+}
+
+/**
+ * @brief Give the provided semaphore
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_semaphore_post(IoT_Semaphore_t *pSemaphore) {
+	IoT_Error_t rc = SUCCESS;
+
+	if(0 != pthread_mutex_lock(&(pSemaphore->lock))) {
+		return THREAD_SYNC_ERROR;
+	}
+
+	if(UINT32_MAX == pSemaphore->count) {
+		rc = THREAD_SYNC_ERROR;
+	} else {
+		pSemaphore->count++;
+		if(0 != pthread_cond_signal(&(pSemaphore->available))) {
+			rc = THREAD_SYNC_ERROR;
+		}
+	}
+
+	pthread_mutex_unlock(&(pSemaphore->lock));
+
+	return rc;
+}
+
+/**
+ * @brief Destroy the provided semaphore
+ *
+ * @param IoT_Semaphore_t - pointer to the semaphore to be destroyed
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_semaphore_destroy(IoT_Semaphore_t *pSemaphore) {
+	IoT_Error_t rc = SUCCESS;
+
+	if(0 != pthread_cond_destroy(&(pSemaphore->available))) {
+		rc = THREAD_SYNC_ERROR;
+	}
+	if(0 != pthread_mutex_destroy(&(pSemaphore->lock))) {
+		rc = THREAD_SYNC_ERROR;
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Start a thread running the given routine
+ *
+ * A non zero priority runs the thread under SCHED_RR at that priority, which needs
+ * CAP_SYS_NICE or a suitable RLIMIT_RTPRIO. A CPU affinity pins the thread to that CPU.
+ *
+ * @param IoT_Thread_t - pointer to the thread to be started, valid until joined
+ * @param IoT_Thread_Routine_t - routine run by the thread
+ * @param void * - argument passed to the routine
+ * @param IoT_Thread_Params_t - priority, CPU affinity and stack size, NULL for the defaults
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_create(IoT_Thread_t *pThread, IoT_Thread_Routine_t routine, void *pArg,
+								  const IoT_Thread_Params_t *pParams) {
+	IoT_Error_t rc = SUCCESS;
+	struct sched_param schedParam;
+	pthread_attr_t attr;
+	cpu_set_t cpuSet;
+
+	if(NULL == pThread || NULL == routine) {
+		return NULL_VALUE_ERROR;
+	}
+	if(NULL == pParams) {
+		pParams = &iotThreadParamsDefault;
+	}
+
+	if(0 != pthread_attr_init(&attr)) {
+		return THREAD_CREATE_ERROR;
+	}
+
+	if(0 != pParams->stackSize && 0 != pthread_attr_setstacksize(&attr, pParams->stackSize)) {
+		rc = THREAD_CREATE_ERROR;
+	}
+
+	if(SUCCESS == rc && 0 != pParams->priority) {
+		memset(&schedParam, 0, sizeof(schedParam));
+		schedParam.sched_priority = pParams->priority;
+		if(0 != pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)
+		   || 0 != pthread_attr_setschedpolicy(&attr, SCHED_RR)
+		   || 0 != pthread_attr_setschedparam(&attr, &schedParam)) {
+			rc = THREAD_CREATE_ERROR;
+		}
+	}
+
+	if(SUCCESS == rc && 0 <= pParams->cpuAffinity) {
+		if(CPU_SETSIZE <= pParams->cpuAffinity) {
+			rc = THREAD_CREATE_ERROR;
+		} else {
+			CPU_ZERO(&cpuSet);
+			CPU_SET(pParams->cpuAffinity, &cpuSet);
+			if(0 != pthread_attr_setaffinity_np(&attr, sizeof(cpuSet), &cpuSet)) {
+				rc = THREAD_CREATE_ERROR;
+			}
+		}
+	}
+
+	if(SUCCESS == rc) {
+		pThread->routine = routine;
+		pThread->pArg = pArg;
+		if(0 != pthread_create(&(pThread->thread), &attr, _aws_iot_thread_start, pThread)) {
+			rc = THREAD_CREATE_ERROR;
+		}
+	}
+
+	pthread_attr_destroy(&attr);
+
+	return rc;
+}
+
+/**
+ * @brief Wait for a thread to return from its routine
+ *
+ * @param IoT_Thread_t - pointer to the thread to be joined
+ * @return IoT_Error_t - error code indicating result of operation
+ */
+IoT_Error_t aws_iot_thread_join(IoT_Thread_t *pThread) {
+	if(NULL == pThread) {
+		return NULL_VALUE_ERROR;
+	}
+	if(0 != pthread_join(pThread->thread, NULL)) {
+		return THREAD_CREATE_ERROR;
+	}
+
+	return SUCCESS;
+}
+
 #ifdef __cplusplus
 }
 #endif
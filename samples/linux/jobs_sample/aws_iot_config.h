@@ -51,6 +51,17 @@
 #define MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME 10 ///< At Any given time we will wait for this many responses. This will correlate to the rate at which the shadow actions are requested
 #define MAX_THINGNAME_HANDLED_AT_ANY_GIVEN_TIME 10 ///< We could perform shadow action on any thing Name and this is maximum Thing Names we can act on at any given time
 #define MAX_JSON_TOKEN_EXPECTED 120 ///< These are the max tokens that is expected to be in the Shadow JSON document. Include the metadata that gets published
+#define MAX_SHADOW_REPORTED_CACHE_ENTRIES 16 ///< Maximum number of reported keys whose last acknowledged value is cached for aws_iot_shadow_add_reported_dirty
+#define MAX_SHADOW_COALESCED_UPDATES 4 ///< Coalesced updates that can be pending or waiting for their response at any given time, see aws_iot_shadow_update_coalesced
+#define MAX_SHADOW_COALESCED_FIELDS 16 ///< Maximum number of distinct reported and desired keys merged into one coalesced update
+#define MAX_SHADOW_COALESCED_CALLBACKS 8 ///< Maximum number of update requests merged into one coalesced update
+#define SHADOW_COALESCED_UPDATE_BUFFER_BYTES 512 ///< Space for the keys and values of one coalesced update
+#define SHADOW_COALESCE_WINDOW_MS 200 ///< Default time updates to the same thing are merged for before they are sent
+#define MAX_SHADOW_MIRRORS 2 ///< Maximum number of things whose shadow is mirrored in memory, see aws_iot_shadow_mirror_enable
+#define MAX_SHADOW_MIRROR_FIELDS 32 ///< Maximum number of desired and reported leaf values held by one shadow mirror
+#define SHADOW_MIRROR_BUFFER_BYTES 1024 ///< Space for the key paths and values of one shadow mirror
+#define SHADOW_MIRROR_MAX_PATH_LENGTH 64 ///< Maximum length of a dotted key path, e.g. "led.color", kept by a shadow mirror
+#define MAX_SHADOW_TOPIC_TABLES 4 ///< Things whose shadow topics are built once and kept, the thing of the client included. Further things take over the other tables in turn
 #define MAX_SHADOW_TOPIC_LENGTH_WITHOUT_THINGNAME 60 ///< All shadow actions have to be published or subscribed to a topic which is of the format $aws/things/{thingName}/shadow/update/accepted. This refers to the size of the topic without the Thing Name
 #define MAX_SHADOW_TOPIC_LENGTH_BYTES MAX_SHADOW_TOPIC_LENGTH_WITHOUT_THINGNAME + MAX_SIZE_OF_THING_NAME ///< This size includes the length of topic with Thing Name
 
@@ -62,6 +73,14 @@
 
 #define MAX_JOB_TOPIC_LENGTH_WITHOUT_JOB_ID_OR_THING_NAME 40
 #define MAX_JOB_TOPIC_LENGTH_BYTES MAX_JOB_TOPIC_LENGTH_WITHOUT_JOB_ID_OR_THING_NAME + MAX_SIZE_OF_THING_NAME + MAX_SIZE_OF_JOB_ID + 2
+
+#define AWS_IOT_JOBS_ENGINE_MAX_JOBS 4 ///< Job executions a jobs engine holds at once, queued, running or waiting for their final update
+#define AWS_IOT_JOBS_ENGINE_MAX_WORKERS 2 ///< Maximum number of worker threads running job handlers, see aws_iot_jobs_engine_start_workers
+#define AWS_IOT_JOBS_ENGINE_DOCUMENT_BYTES 512 ///< Space for the job document of one execution, larger documents fail the execution
+#define AWS_IOT_JOBS_ENGINE_STATUS_DETAILS_BYTES 128 ///< Space for the statusDetails object reported by a job handler
+#define AWS_IOT_JOBS_ENGINE_UPDATE_INTERVAL_MS 1000 ///< Default minimum time between two batches of job progress updates
+#define AWS_IOT_JOBS_ENGINE_MAX_UPDATES_PER_BATCH 4 ///< Job updates sent by one call to aws_iot_jobs_engine_service
+#define AWS_IOT_JOBS_ENGINE_START_NEXT_TIMEOUT_MS 5000 ///< Time a start-next request waits for its reply before it is sent again
 #endif
 
 // Auto Reconnect specific config
@@ -37,6 +37,7 @@
 #include <string.h>
 
 #include "aws_iot_config.h"
+#include "aws_iot_json_tokenizer.h"
 #include "aws_iot_json_utils.h"
 #include "aws_iot_log.h"
 #include "aws_iot_version.h"
@@ -60,6 +61,7 @@ uint32_t port = AWS_IOT_MQTT_PORT;
 
 static jsmn_parser jsonParser;
 static jsmntok_t jsonTokenStruct[MAX_JSON_TOKEN_EXPECTED];
+static jsonTapeEntry_t jsonTape[MAX_JSON_TOKEN_EXPECTED];
 static int32_t tokenCount;
 
 void iot_get_pending_callback_handler(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
@@ -72,7 +74,7 @@ void iot_get_pending_callback_handler(AWS_IoT_Client *pClient, char *topicName,
 
 	jsmn_init(&jsonParser);
 
-	tokenCount = jsmn_parse(&jsonParser, params->payload, (int) params->payloadLen, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
+	tokenCount = aws_iot_json_parse(&jsonParser, params->payload, (int) params->payloadLen, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
 
 	if(tokenCount < 0) {
 		IOT_WARN("Failed to parse JSON: %d", tokenCount);
@@ -85,15 +87,18 @@ void iot_get_pending_callback_handler(AWS_IoT_Client *pClient, char *topicName,
 		return;
 	}
 
+	/* Lets the lookups below skip over large job documents in one step */
+	buildJsonTape(jsonTokenStruct, tokenCount, jsonTape);
+
 	jsmntok_t *jobs;
 
-	jobs = findToken("inProgressJobs", params->payload, jsonTokenStruct);
+	jobs = findTokenOnTape("inProgressJobs", params->payload, jsonTokenStruct, jsonTape, jsonTokenStruct);
 
 	if (jobs) {
 		IOT_INFO("inProgressJobs: %.*s", jobs->end - jobs->start, (char *)params->payload + jobs->start);
 	}	
 
-	jobs = findToken("queuedJobs", params->payload, jsonTokenStruct);
+	jobs = findTokenOnTape("queuedJobs", params->payload, jsonTokenStruct, jsonTape, jsonTokenStruct);
 
 	if (jobs) {
 		IOT_INFO("queuedJobs: %.*s", jobs->end - jobs->start, (char *)params->payload + jobs->start);
@@ -113,7 +118,7 @@ void iot_next_job_callback_handler(AWS_IoT_Client *pClient, char *topicName, uin
 
 	jsmn_init(&jsonParser);
 
-	tokenCount = jsmn_parse(&jsonParser, params->payload, (int) params->payloadLen, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
+	tokenCount = aws_iot_json_parse(&jsonParser, params->payload, (int) params->payloadLen, jsonTokenStruct, MAX_JSON_TOKEN_EXPECTED);
 
 	if(tokenCount < 0) {
 		IOT_WARN("Failed to parse JSON: %d", tokenCount);
@@ -126,16 +131,19 @@ void iot_next_job_callback_handler(AWS_IoT_Client *pClient, char *topicName, uin
 		return;
 	}
 
+	/* Lets the lookups below skip over large job documents in one step */
+	buildJsonTape(jsonTokenStruct, tokenCount, jsonTape);
+
 	jsmntok_t *tokExecution;
 
-	tokExecution = findToken("execution", params->payload, jsonTokenStruct);
+	tokExecution = findTokenOnTape("execution", params->payload, jsonTokenStruct, jsonTape, jsonTokenStruct);
 
 	if (tokExecution) {
 		IOT_INFO("execution: %.*s", tokExecution->end - tokExecution->start, (char *)params->payload + tokExecution->start);
 
 		jsmntok_t *tok;
 
-		tok = findToken("jobId", params->payload, tokExecution);
+		tok = findTokenOnTape("jobId", params->payload, jsonTokenStruct, jsonTape, tokExecution);
 
 		if (tok) {
 			IoT_Error_t rc;
@@ -150,7 +158,7 @@ void iot_next_job_callback_handler(AWS_IoT_Client *pClient, char *topicName, uin
 
 			IOT_INFO("jobId: %s", jobId);
 
-			tok = findToken("jobDocument", params->payload, tokExecution);
+			tok = findTokenOnTape("jobDocument", params->payload, jsonTokenStruct, jsonTape, tokExecution);
 
 			/*
 			 * Do your job processing here.
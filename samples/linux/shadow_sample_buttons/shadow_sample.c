@@ -254,9 +254,16 @@ int main(int argc, char **argv) {
         buttonEnabledHandler.dataLength = sizeof(uint8_t);
         buttonEnabledHandler.type = SHADOW_JSON_INT8;
 
+        // Only report what changed since the last accepted update, buttonPressed
+        // is forced on every interrupt below
+        aws_iot_shadow_register_reported(&buttonHandler, 0);
+        aws_iot_shadow_register_reported(&buttonEnabledHandler, 0);
+        uint8_t dirtyCount = 0;
+
         while (NETWORK_ATTEMPTING_RECONNECT == rc || NETWORK_RECONNECTED == rc ||
                SUCCESS == rc) {
-                rc = aws_iot_shadow_yield(&mqttClient, 10);
+                // Button interrupts wake the yield up, so it can wait a long time
+                rc = aws_iot_shadow_yield(&mqttClient, 1000);
                 if (NETWORK_ATTEMPTING_RECONNECT == rc) {
                         sleep(1);
                         // If the client is attempting to reconnect we will skip the rest of the
@@ -273,7 +280,8 @@ int main(int argc, char **argv) {
 
                 if (buttonInterruptCheck()) {
                         buttonPressed = buttonPressedMask();
-                        buttonHandler.pData = &buttonPressed;
+                        buttonEnabledMasKInt = buttonEnabledMask();
+                        aws_iot_shadow_mark_reported_dirty(&buttonHandler);
                         cleanButtonInterrupts();
                         IOT_INFO(
                                 "\n==============================================================="
@@ -282,9 +290,9 @@ int main(int argc, char **argv) {
                         rc = aws_iot_shadow_init_json_document(JsonDocumentBuffer,
                                                                sizeOfJsonDocumentBuffer);
                         if (SUCCESS == rc) {
-                                rc = aws_iot_shadow_add_reported(
-                                        JsonDocumentBuffer, sizeOfJsonDocumentBuffer, 2, &buttonHandler,&buttonEnabledHandler);
-                                if (SUCCESS == rc) {
+                                rc = aws_iot_shadow_add_reported_dirty(
+                                        JsonDocumentBuffer, sizeOfJsonDocumentBuffer, &dirtyCount);
+                                if (SUCCESS == rc && 0 != dirtyCount) {
                                         rc = aws_iot_finalize_json_document(JsonDocumentBuffer,
                                                                             sizeOfJsonDocumentBuffer);
                                         if (SUCCESS == rc) {
@@ -328,6 +336,7 @@ void buttonCallbackHandler(int button) {
                 printf("Falling Edge Button %d\n",button);
                 buttonTriggers[button] = true;
                 lastChange[button] = now;
+                aws_iot_mqtt_wakeup(&mqttClient);
         }
 
 
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_buffer_pool.c
+ * @brief Size class buffer pool with intrusive free lists
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
+#include "aws_iot_buffer_pool.h"
+
+#include <string.h>
+
+#include "aws_iot_log.h"
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+#define BUFFER_POOL_LOCK(pPool) aws_iot_thread_mutex_lock(&(pPool)->lock)
+#define BUFFER_POOL_UNLOCK(pPool) aws_iot_thread_mutex_unlock(&(pPool)->lock)
+#else
+#define BUFFER_POOL_LOCK(pPool)
+#define BUFFER_POOL_UNLOCK(pPool)
+#endif
+
+IoT_Error_t aws_iot_buffer_pool_init(IoT_Buffer_Pool_t *pPool, const IoT_Buffer_Pool_Class_t *pClasses,
+									 uint8_t classCount) {
+	IoT_Buffer_Pool_Size_Class_t entry;
+	IoT_Error_t rc = SUCCESS;
+	uint16_t block;
+	uint8_t i, j;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool || NULL == pClasses) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(classCount > AWS_IOT_BUFFER_POOL_MAX_CLASSES) {
+		FUNC_EXIT_RC(LIMIT_EXCEEDED_ERROR);
+	}
+
+	memset(pPool, 0, sizeof(IoT_Buffer_Pool_t));
+
+	for(i = 0; i < classCount; i++) {
+		if(NULL == pClasses[i].pMemory || 0 == pClasses[i].blockCount || 0 == pClasses[i].blockSize
+		   || 0 != pClasses[i].blockSize % sizeof(void *) || 0 != (uintptr_t) pClasses[i].pMemory % sizeof(void *)) {
+			IOT_ERROR("Buffer pool class %u is empty or misaligned", i);
+			FUNC_EXIT_RC(FAILURE);
+		}
+
+		/* Insertion sort keeps the classes smallest first */
+		entry.config = pClasses[i];
+		entry.pFreeList = NULL;
+		entry.freeCount = pClasses[i].blockCount;
+		entry.minFreeCount = pClasses[i].blockCount;
+		for(j = i; j > 0 && pPool->classes[j - 1].config.blockSize > entry.config.blockSize; j--) {
+			pPool->classes[j] = pPool->classes[j - 1];
+		}
+		pPool->classes[j] = entry;
+	}
+	pPool->classCount = classCount;
+
+	/* Thread each block onto its free list, the first block ends up at the head */
+	for(i = 0; i < classCount; i++) {
+		for(block = pPool->classes[i].config.blockCount; block > 0; block--) {
+			void **pBlock = (void **) (pPool->classes[i].config.pMemory
+									   + (size_t) (block - 1) * pPool->classes[i].config.blockSize);
+			*pBlock = pPool->classes[i].pFreeList;
+			pPool->classes[i].pFreeList = pBlock;
+		}
+	}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	rc = aws_iot_thread_mutex_init(&pPool->lock);
+#endif
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_buffer_pool_destroy(IoT_Buffer_Pool_t *pPool) {
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	rc = aws_iot_thread_mutex_destroy(&pPool->lock);
+#endif
+	pPool->classCount = 0;
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_buffer_pool_acquire(IoT_Buffer_Pool_t *pPool, size_t minSize, unsigned char **ppBuffer,
+										size_t *pBufferSize) {
+	IoT_Buffer_Pool_Size_Class_t *pClass;
+	IoT_Error_t rc = LIMIT_EXCEEDED_ERROR;
+	uint8_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool || NULL == ppBuffer || NULL == pBufferSize) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	BUFFER_POOL_LOCK(pPool);
+	for(i = 0; i < pPool->classCount; i++) {
+		pClass = &pPool->classes[i];
+		if(pClass->config.blockSize < minSize || NULL == pClass->pFreeList) {
+			continue;
+		}
+
+		*ppBuffer = (unsigned char *) pClass->pFreeList;
+		*pBufferSize = pClass->config.blockSize;
+		pClass->pFreeList = *(void **) pClass->pFreeList;
+		pClass->freeCount--;
+		if(pClass->freeCount < pClass->minFreeCount) {
+			pClass->minFreeCount = pClass->freeCount;
+		}
+		rc = SUCCESS;
+		break;
+	}
+	BUFFER_POOL_UNLOCK(pPool);
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_buffer_pool_release(IoT_Buffer_Pool_t *pPool, unsigned char *pBuffer) {
+	IoT_Buffer_Pool_Size_Class_t *pClass;
+	IoT_Error_t rc = FAILURE;
+	size_t offset;
+	uint8_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool || NULL == pBuffer) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	BUFFER_POOL_LOCK(pPool);
+	for(i = 0; i < pPool->classCount; i++) {
+		pClass = &pPool->classes[i];
+		if(pBuffer < pClass->config.pMemory) {
+			continue;
+		}
+		offset = (size_t) (pBuffer - pClass->config.pMemory);
+		if(offset >= pClass->config.blockSize * pClass->config.blockCount) {
+			continue;
+		}
+
+		if(0 == offset % pClass->config.blockSize && pClass->freeCount < pClass->config.blockCount) {
+			*(void **) pBuffer = pClass->pFreeList;
+			pClass->pFreeList = pBuffer;
+			pClass->freeCount++;
+			rc = SUCCESS;
+		}
+		break;
+	}
+	BUFFER_POOL_UNLOCK(pPool);
+
+	if(SUCCESS != rc) {
+		IOT_ERROR("Buffer %p was not acquired from this pool", (void *) pBuffer);
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+uint16_t aws_iot_buffer_pool_get_free_count(IoT_Buffer_Pool_t *pPool, size_t blockSize, uint16_t *pMinFreeCount) {
+	uint16_t freeCount = 0;
+	uint8_t i;
+
+	if(NULL == pPool) {
+		return 0;
+	}
+
+	BUFFER_POOL_LOCK(pPool);
+	for(i = 0; i < pPool->classCount; i++) {
+		if(pPool->classes[i].config.blockSize == blockSize) {
+			freeCount = pPool->classes[i].freeCount;
+			if(NULL != pMinFreeCount) {
+				*pMinFreeCount = pPool->classes[i].minFreeCount;
+			}
+			break;
+		}
+	}
+	BUFFER_POOL_UNLOCK(pPool);
+
+	return freeCount;
+}
+
+#ifdef __cplusplus
+}
+#endif
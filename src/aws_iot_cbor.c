@@ -0,0 +1,611 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_cbor.c
+ * @brief CBOR writer and jsonStruct_t field encoding and decoding
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_JSON
+
+#include "aws_iot_cbor.h"
+
+#include <float.h>
+#include <string.h>
+
+#include "aws_iot_log.h"
+
+#define CBOR_MAJOR_UNSIGNED 0
+#define CBOR_MAJOR_NEGATIVE 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_TAG 6
+#define CBOR_MAJOR_SIMPLE 7
+
+#define CBOR_INFO_ONE_BYTE 24
+#define CBOR_INFO_HALF 25
+#define CBOR_INFO_SINGLE 26
+#define CBOR_INFO_DOUBLE 27
+
+#define CBOR_SIMPLE_FALSE 20
+#define CBOR_SIMPLE_TRUE 21
+#define CBOR_SIMPLE_NULL 22
+
+#define CBOR_HALF_NAN 0x7E00
+
+/* Nesting accepted in values that are skipped while decoding */
+#define CBOR_MAX_SKIP_DEPTH 16
+
+static void writeRaw(IoT_Cbor_Writer_t *pWriter, const uint8_t *pData, size_t dataLen) {
+	if(pWriter->length < pWriter->bufferSize) {
+		size_t available = pWriter->bufferSize - pWriter->length;
+
+		memcpy(pWriter->pBuffer + pWriter->length, pData, dataLen > available ? available : dataLen);
+	}
+	pWriter->length += dataLen;
+}
+
+static void writeBigEndian(uint8_t *pOut, uint64_t value, size_t byteCount) {
+	size_t i;
+
+	for(i = byteCount; i > 0; i--) {
+		pOut[i - 1] = (uint8_t) value;
+		value >>= 8;
+	}
+}
+
+static void writeHead(IoT_Cbor_Writer_t *pWriter, uint8_t major, uint64_t value) {
+	uint8_t head[9];
+	size_t byteCount;
+
+	if(value < CBOR_INFO_ONE_BYTE) {
+		head[0] = (uint8_t) ((major << 5) | value);
+		writeRaw(pWriter, head, 1);
+		return;
+	}
+
+	if(value <= UINT8_MAX) {
+		head[0] = (uint8_t) ((major << 5) | CBOR_INFO_ONE_BYTE);
+		byteCount = 1;
+	} else if(value <= UINT16_MAX) {
+		head[0] = (uint8_t) ((major << 5) | CBOR_INFO_HALF);
+		byteCount = 2;
+	} else if(value <= UINT32_MAX) {
+		head[0] = (uint8_t) ((major << 5) | CBOR_INFO_SINGLE);
+		byteCount = 4;
+	} else {
+		head[0] = (uint8_t) ((major << 5) | CBOR_INFO_DOUBLE);
+		byteCount = 8;
+	}
+	writeBigEndian(head + 1, value, byteCount);
+	writeRaw(pWriter, head, byteCount + 1);
+}
+
+/* Half precision bits of a float, if the half holds it exactly */
+static bool floatToHalf(float value, uint16_t *pHalf) {
+	uint32_t bits;
+	uint16_t sign;
+	int32_t exponent;
+	uint32_t mantissa;
+	uint32_t shift;
+
+	memcpy(&bits, &value, sizeof(bits));
+	sign = (uint16_t) ((bits >> 16) & 0x8000);
+	exponent = (int32_t) ((bits >> 23) & 0xFF);
+	mantissa = bits & 0x7FFFFF;
+
+	if(0xFF == exponent) {
+		*pHalf = (0 == mantissa) ? (uint16_t) (sign | 0x7C00) : (uint16_t) CBOR_HALF_NAN;
+		return true;
+	}
+	if(0 == exponent) {
+		/* Zero, float subnormals are far below the half range */
+		*pHalf = sign;
+		return 0 == mantissa;
+	}
+
+	exponent -= 127;
+	if(exponent >= -14 && exponent <= 15) {
+		if(0 != (mantissa & 0x1FFF)) {
+			return false;
+		}
+		*pHalf = (uint16_t) (sign | ((uint32_t) (exponent + 15) << 10) | (mantissa >> 13));
+		return true;
+	}
+	if(exponent >= -24 && exponent < -14) {
+		/* Half subnormal, the implicit leading bit becomes part of the mantissa */
+		mantissa |= 0x800000;
+		shift = (uint32_t) (13 + (-14 - exponent));
+		if(0 != (mantissa & ((1u << shift) - 1))) {
+			return false;
+		}
+		*pHalf = (uint16_t) (sign | (mantissa >> shift));
+		return true;
+	}
+
+	return false;
+}
+
+static float halfToFloat(uint16_t half) {
+	uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+	int32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+	uint32_t bits;
+	float value;
+
+	if(0 == exponent) {
+		if(0 == mantissa) {
+			bits = sign;
+		} else {
+			exponent = -14;
+			while(0 == (mantissa & 0x400)) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | ((uint32_t) (exponent + 127) << 23) | ((mantissa & 0x3FF) << 13);
+		}
+	} else if(0x1F == exponent) {
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	} else {
+		bits = sign | ((uint32_t) (exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void aws_iot_cbor_writer_init(IoT_Cbor_Writer_t *pWriter, uint8_t *pBuffer, size_t bufferSize) {
+	pWriter->pBuffer = pBuffer;
+	pWriter->bufferSize = (NULL == pBuffer) ? 0 : bufferSize;
+	pWriter->length = 0;
+}
+
+bool aws_iot_cbor_writer_is_truncated(const IoT_Cbor_Writer_t *pWriter) {
+	return pWriter->length > pWriter->bufferSize;
+}
+
+void aws_iot_cbor_writer_map(IoT_Cbor_Writer_t *pWriter, uint32_t pairCount) {
+	writeHead(pWriter, CBOR_MAJOR_MAP, pairCount);
+}
+
+void aws_iot_cbor_writer_array(IoT_Cbor_Writer_t *pWriter, uint32_t itemCount) {
+	writeHead(pWriter, CBOR_MAJOR_ARRAY, itemCount);
+}
+
+void aws_iot_cbor_writer_text(IoT_Cbor_Writer_t *pWriter, const char *pText, size_t textLen) {
+	writeHead(pWriter, CBOR_MAJOR_TEXT, textLen);
+	writeRaw(pWriter, (const uint8_t *) pText, textLen);
+}
+
+void aws_iot_cbor_writer_bytes(IoT_Cbor_Writer_t *pWriter, const uint8_t *pData, size_t dataLen) {
+	writeHead(pWriter, CBOR_MAJOR_BYTES, dataLen);
+	writeRaw(pWriter, pData, dataLen);
+}
+
+void aws_iot_cbor_writer_int(IoT_Cbor_Writer_t *pWriter, int64_t value) {
+	if(value >= 0) {
+		writeHead(pWriter, CBOR_MAJOR_UNSIGNED, (uint64_t) value);
+	} else {
+		/* Negative integers are encoded as -1 - value */
+		writeHead(pWriter, CBOR_MAJOR_NEGATIVE, ~(uint64_t) value);
+	}
+}
+
+void aws_iot_cbor_writer_uint(IoT_Cbor_Writer_t *pWriter, uint64_t value) {
+	writeHead(pWriter, CBOR_MAJOR_UNSIGNED, value);
+}
+
+void aws_iot_cbor_writer_float(IoT_Cbor_Writer_t *pWriter, float value) {
+	uint8_t out[5];
+	uint16_t half;
+	uint32_t bits;
+
+	if(floatToHalf(value, &half)) {
+		out[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_INFO_HALF;
+		writeBigEndian(out + 1, half, 2);
+		writeRaw(pWriter, out, 3);
+	} else {
+		memcpy(&bits, &value, sizeof(bits));
+		out[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_INFO_SINGLE;
+		writeBigEndian(out + 1, bits, 4);
+		writeRaw(pWriter, out, 5);
+	}
+}
+
+void aws_iot_cbor_writer_double(IoT_Cbor_Writer_t *pWriter, double value) {
+	uint8_t out[9];
+	uint64_t bits;
+
+	/* NaN, infinities and every double that is a float in disguise take the float path */
+	if(value != value || value > DBL_MAX || value < -DBL_MAX
+	   || (value <= FLT_MAX && value >= -FLT_MAX && (double) (float) value == value)) {
+		aws_iot_cbor_writer_float(pWriter, (float) value);
+		return;
+	}
+
+	memcpy(&bits, &value, sizeof(bits));
+	out[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_INFO_DOUBLE;
+	writeBigEndian(out + 1, bits, 8);
+	writeRaw(pWriter, out, 9);
+}
+
+void aws_iot_cbor_writer_bool(IoT_Cbor_Writer_t *pWriter, bool value) {
+	writeHead(pWriter, CBOR_MAJOR_SIMPLE, value ? CBOR_SIMPLE_TRUE : CBOR_SIMPLE_FALSE);
+}
+
+void aws_iot_cbor_writer_null(IoT_Cbor_Writer_t *pWriter) {
+	writeHead(pWriter, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_NULL);
+}
+
+IoT_Error_t aws_iot_cbor_encode_fields(uint8_t *pBuffer, size_t bufferSize, size_t *pEncodedLength, uint8_t count,
+									   jsonStruct_t *const *ppStructs) {
+	IoT_Cbor_Writer_t writer;
+	const jsonStruct_t *pField;
+	uint8_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pEncodedLength || (NULL == ppStructs && 0 != count)) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	aws_iot_cbor_writer_init(&writer, pBuffer, bufferSize);
+	aws_iot_cbor_writer_map(&writer, count);
+
+	for(i = 0; i < count; i++) {
+		pField = ppStructs[i];
+		if(NULL == pField || NULL == pField->pKey || NULL == pField->pData) {
+			FUNC_EXIT_RC(NULL_VALUE_ERROR);
+		}
+
+		aws_iot_cbor_writer_text(&writer, pField->pKey, strlen(pField->pKey));
+		switch(pField->type) {
+			case SHADOW_JSON_INT32:
+				aws_iot_cbor_writer_int(&writer, *(int32_t *) pField->pData);
+				break;
+			case SHADOW_JSON_INT16:
+				aws_iot_cbor_writer_int(&writer, *(int16_t *) pField->pData);
+				break;
+			case SHADOW_JSON_INT8:
+				aws_iot_cbor_writer_int(&writer, *(int8_t *) pField->pData);
+				break;
+			case SHADOW_JSON_UINT32:
+				aws_iot_cbor_writer_uint(&writer, *(uint32_t *) pField->pData);
+				break;
+			case SHADOW_JSON_UINT16:
+				aws_iot_cbor_writer_uint(&writer, *(uint16_t *) pField->pData);
+				break;
+			case SHADOW_JSON_UINT8:
+				aws_iot_cbor_writer_uint(&writer, *(uint8_t *) pField->pData);
+				break;
+			case SHADOW_JSON_FLOAT:
+				aws_iot_cbor_writer_float(&writer, *(float *) pField->pData);
+				break;
+			case SHADOW_JSON_DOUBLE:
+				aws_iot_cbor_writer_double(&writer, *(double *) pField->pData);
+				break;
+			case SHADOW_JSON_BOOL:
+				aws_iot_cbor_writer_bool(&writer, *(bool *) pField->pData);
+				break;
+			case SHADOW_JSON_STRING:
+				aws_iot_cbor_writer_text(&writer, (const char *) pField->pData, strlen((const char *) pField->pData));
+				break;
+			case SHADOW_JSON_OBJECT:
+			default:
+				IOT_WARN("CBOR cannot encode the JSON text of %s\n", pField->pKey);
+				FUNC_EXIT_RC(SHADOW_JSON_ERROR);
+		}
+	}
+
+	*pEncodedLength = writer.length;
+	if(aws_iot_cbor_writer_is_truncated(&writer)) {
+		FUNC_EXIT_RC(SHADOW_JSON_BUFFER_TRUNCATED);
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+/* Reads the head of the next item. The value is the argument of the head: the integer, the length,
+ * the item count or the bits of a floating point value. Indefinite lengths are not supported. */
+static bool readHead(const uint8_t **ppData, const uint8_t *pEnd, uint8_t *pMajor, uint8_t *pInfo,
+					 uint64_t *pValue) {
+	const uint8_t *pData = *ppData;
+	size_t byteCount, i;
+
+	if(pData >= pEnd) {
+		return false;
+	}
+
+	*pMajor = (uint8_t) (*pData >> 5);
+	*pInfo = (uint8_t) (*pData & 0x1F);
+	pData++;
+
+	if(*pInfo < CBOR_INFO_ONE_BYTE) {
+		*pValue = *pInfo;
+	} else if(*pInfo <= CBOR_INFO_DOUBLE) {
+		byteCount = (size_t) 1 << (*pInfo - CBOR_INFO_ONE_BYTE);
+		if((size_t) (pEnd - pData) < byteCount) {
+			return false;
+		}
+		*pValue = 0;
+		for(i = 0; i < byteCount; i++) {
+			*pValue = (*pValue << 8) | pData[i];
+		}
+		pData += byteCount;
+	} else {
+		return false;
+	}
+
+	*ppData = pData;
+	return true;
+}
+
+static bool skipItem(const uint8_t **ppData, const uint8_t *pEnd, uint8_t depth) {
+	uint8_t major, info;
+	uint64_t value, i;
+
+	if(!readHead(ppData, pEnd, &major, &info, &value)) {
+		return false;
+	}
+
+	switch(major) {
+		case CBOR_MAJOR_BYTES:
+		case CBOR_MAJOR_TEXT:
+			if(value > (uint64_t) (pEnd - *ppData)) {
+				return false;
+			}
+			*ppData += value;
+			return true;
+		case CBOR_MAJOR_MAP:
+			if(value > UINT64_MAX / 2) {
+				return false;
+			}
+			value *= 2;
+			/* fall through */
+		case CBOR_MAJOR_ARRAY:
+			/* Every item takes at least one byte */
+			if(0 == depth || value > (uint64_t) (pEnd - *ppData)) {
+				return false;
+			}
+			for(i = 0; i < value; i++) {
+				if(!skipItem(ppData, pEnd, (uint8_t) (depth - 1))) {
+					return false;
+				}
+			}
+			return true;
+		case CBOR_MAJOR_TAG:
+			return 0 != depth && skipItem(ppData, pEnd, (uint8_t) (depth - 1));
+		default:
+			return true;
+	}
+}
+
+static bool readNumber(uint8_t major, uint8_t info, uint64_t value, double *pNumber) {
+	uint32_t singleBits;
+	float single;
+
+	if(CBOR_MAJOR_UNSIGNED == major) {
+		*pNumber = (double) value;
+	} else if(CBOR_MAJOR_NEGATIVE == major) {
+		*pNumber = -1.0 - (double) value;
+	} else if(CBOR_MAJOR_SIMPLE == major && CBOR_INFO_HALF == info) {
+		*pNumber = halfToFloat((uint16_t) value);
+	} else if(CBOR_MAJOR_SIMPLE == major && CBOR_INFO_SINGLE == info) {
+		singleBits = (uint32_t) value;
+		memcpy(&single, &singleBits, sizeof(single));
+		*pNumber = single;
+	} else if(CBOR_MAJOR_SIMPLE == major && CBOR_INFO_DOUBLE == info) {
+		memcpy(pNumber, &value, sizeof(*pNumber));
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+/* Integer value of an item within [minimum, maximum] */
+static bool readInteger(uint8_t major, uint64_t value, int64_t minimum, uint64_t maximum, int64_t *pSigned,
+						uint64_t *pUnsigned) {
+	if(CBOR_MAJOR_UNSIGNED == major) {
+		if(value > maximum) {
+			return false;
+		}
+		*pUnsigned = value;
+		*pSigned = (int64_t) value;
+		return true;
+	}
+	if(CBOR_MAJOR_NEGATIVE == major && minimum < 0 && value <= (uint64_t) (-(minimum + 1))) {
+		*pSigned = -1 - (int64_t) value;
+		return true;
+	}
+
+	return false;
+}
+
+/* Stores the value of an item in a field, if it fits the field type */
+static bool updateField(jsonStruct_t *pField, uint8_t major, uint8_t info, uint64_t value, const uint8_t *pText) {
+	int64_t signedValue = 0;
+	uint64_t unsignedValue = 0;
+	double number;
+
+	switch(pField->type) {
+		case SHADOW_JSON_INT32:
+			if(pField->dataLength < sizeof(int32_t)
+			   || !readInteger(major, value, INT32_MIN, INT32_MAX, &signedValue, &unsignedValue)) {
+				return false;
+			}
+			*(int32_t *) pField->pData = (int32_t) signedValue;
+			return true;
+		case SHADOW_JSON_INT16:
+			if(pField->dataLength < sizeof(int16_t)
+			   || !readInteger(major, value, INT16_MIN, INT16_MAX, &signedValue, &unsignedValue)) {
+				return false;
+			}
+			*(int16_t *) pField->pData = (int16_t) signedValue;
+			return true;
+		case SHADOW_JSON_INT8:
+			if(pField->dataLength < sizeof(int8_t)
+			   || !readInteger(major, value, INT8_MIN, INT8_MAX, &signedValue, &unsignedValue)) {
+				return false;
+			}
+			*(int8_t *) pField->pData = (int8_t) signedValue;
+			return true;
+		case SHADOW_JSON_UINT32:
+			if(pField->dataLength < sizeof(uint32_t)
+			   || !readInteger(major, value, 0, UINT32_MAX, &signedValue, &unsignedValue)) {
+				return false;
+			}
+			*(uint32_t *) pField->pData = (uint32_t) unsignedValue;
+			return true;
+		case SHADOW_JSON_UINT16:
+			if(pField->dataLength < sizeof(uint16_t)
+			   || !readInteger(major, value, 0, UINT16_MAX, &signedValue, &unsignedValue)) {
+				return false;
+			}
+			*(uint16_t *) pField->pData = (uint16_t) unsignedValue;
+			return true;
+		case SHADOW_JSON_UINT8:
+			if(pField->dataLength < sizeof(uint8_t)
+			   || !readInteger(major, value, 0, UINT8_MAX, &signedValue, &unsignedValue)) {
+				return false;
+			}
+			*(uint8_t *) pField->pData = (uint8_t) unsignedValue;
+			return true;
+		case SHADOW_JSON_FLOAT:
+			if(pField->dataLength < sizeof(float) || !readNumber(major, info, value, &number)) {
+				return false;
+			}
+			*(float *) pField->pData = (float) number;
+			return true;
+		case SHADOW_JSON_DOUBLE:
+			if(pField->dataLength < sizeof(double) || !readNumber(major, info, value, &number)) {
+				return false;
+			}
+			*(double *) pField->pData = number;
+			return true;
+		case SHADOW_JSON_BOOL:
+			if(pField->dataLength < sizeof(bool) || CBOR_MAJOR_SIMPLE != major
+			   || (CBOR_SIMPLE_TRUE != info && CBOR_SIMPLE_FALSE != info)) {
+				return false;
+			}
+			*(bool *) pField->pData = (CBOR_SIMPLE_TRUE == info);
+			return true;
+		case SHADOW_JSON_STRING:
+			if(CBOR_MAJOR_TEXT != major || value >= pField->dataLength) {
+				return false;
+			}
+			memcpy(pField->pData, pText, (size_t) value);
+			((char *) pField->pData)[value] = '\0';
+			return true;
+		case SHADOW_JSON_OBJECT:
+		default:
+			return false;
+	}
+}
+
+static jsonStruct_t *findField(const uint8_t *pKey, size_t keyLength, uint8_t count, jsonStruct_t *const *ppStructs) {
+	uint8_t i;
+
+	for(i = 0; i < count; i++) {
+		/* Keys come from the network and may hold NUL bytes, so compare the exact lengths */
+		if(NULL != ppStructs[i] && NULL != ppStructs[i]->pKey && NULL != ppStructs[i]->pData
+		   && strlen(ppStructs[i]->pKey) == keyLength && 0 == memcmp(ppStructs[i]->pKey, pKey, keyLength)) {
+			return ppStructs[i];
+		}
+	}
+
+	return NULL;
+}
+
+IoT_Error_t aws_iot_cbor_decode_fields(const uint8_t *pBuffer, size_t bufferLength, uint8_t count,
+									   jsonStruct_t *const *ppStructs, uint8_t *pUpdatedCount) {
+	const uint8_t *pData = pBuffer;
+	const uint8_t *pEnd;
+	const uint8_t *pKey, *pValue;
+	jsonStruct_t *pField;
+	uint8_t major, info;
+	uint64_t pairCount, keyLength, value, i;
+	uint8_t updatedCount = 0;
+
+	FUNC_ENTRY;
+
+	if(NULL == pBuffer || (NULL == ppStructs && 0 != count)) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+	pEnd = pBuffer + bufferLength;
+
+	if(!readHead(&pData, pEnd, &major, &info, &pairCount) || CBOR_MAJOR_MAP != major) {
+		FUNC_EXIT_RC(JSON_PARSE_ERROR);
+	}
+
+	for(i = 0; i < pairCount; i++) {
+		pKey = pData;
+		if(!readHead(&pData, pEnd, &major, &info, &keyLength)) {
+			FUNC_EXIT_RC(JSON_PARSE_ERROR);
+		}
+		if(CBOR_MAJOR_TEXT != major) {
+			/* Keys of other types cannot name a field, skip the whole pair */
+			pData = pKey;
+			if(!skipItem(&pData, pEnd, CBOR_MAX_SKIP_DEPTH) || !skipItem(&pData, pEnd, CBOR_MAX_SKIP_DEPTH)) {
+				FUNC_EXIT_RC(JSON_PARSE_ERROR);
+			}
+			continue;
+		}
+		if(keyLength > (uint64_t) (pEnd - pData)) {
+			FUNC_EXIT_RC(JSON_PARSE_ERROR);
+		}
+		pKey = pData;
+		pData += keyLength;
+
+		pValue = pData;
+		if(!readHead(&pData, pEnd, &major, &info, &value)) {
+			FUNC_EXIT_RC(JSON_PARSE_ERROR);
+		}
+		pData = pValue;
+		if(!skipItem(&pData, pEnd, CBOR_MAX_SKIP_DEPTH)) {
+			FUNC_EXIT_RC(JSON_PARSE_ERROR);
+		}
+
+		pField = findField(pKey, (size_t) keyLength, count, ppStructs);
+		if(NULL == pField) {
+			continue;
+		}
+		/* The text of a string value follows its head */
+		if(!updateField(pField, major, info, value, pData - (CBOR_MAJOR_TEXT == major ? value : 0))) {
+			IOT_DEBUG("CBOR value of %s does not fit its type\n", pField->pKey);
+			continue;
+		}
+		updatedCount++;
+		if(NULL != pField->cb) {
+			pField->cb((const char *) pValue, (uint32_t) (pData - pValue), pField);
+		}
+	}
+
+	if(NULL != pUpdatedCount) {
+		*pUpdatedCount = updatedCount;
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+#ifdef __cplusplus
+}
+#endif
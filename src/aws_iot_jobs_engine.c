@@ -0,0 +1,633 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_jobs_engine.c
+ * @brief Job execution table, worker threads and batched job updates
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_JOBS
+
+#include "aws_iot_jobs_engine.h"
+
+#include <string.h>
+
+#include "aws_iot_json_tokenizer.h"
+#include "aws_iot_log.h"
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+#define JOBS_ENGINE_LOCK(pEngine) aws_iot_thread_mutex_lock(&(pEngine)->lock)
+#define JOBS_ENGINE_UNLOCK(pEngine) aws_iot_thread_mutex_unlock(&(pEngine)->lock)
+#else
+#define JOBS_ENGINE_LOCK(pEngine)
+#define JOBS_ENGINE_UNLOCK(pEngine)
+#endif
+
+const AwsIotJobsEngineParams awsIotJobsEngineParamsDefault = AwsIotJobsEngineParams_initializer;
+
+static bool _is_job_held(AwsIotJobsEngine *pEngine, const char *pJobId) {
+	uint8_t i;
+
+	for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS; i++) {
+		if(JOBS_ENGINE_SLOT_FREE != pEngine->slots[i].state && 0 == strcmp(pEngine->slots[i].job.jobId, pJobId)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Replies racing with a final update can still carry the execution that was just completed */
+static bool _is_job_completed(AwsIotJobsEngine *pEngine, const char *pJobId, int64_t executionNumber) {
+	uint8_t i;
+
+	for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS; i++) {
+		if(executionNumber == pEngine->completed[i].executionNumber && 0 == strcmp(pEngine->completed[i].jobId, pJobId)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static AwsIotJobsEngineSlot *_find_free_slot(AwsIotJobsEngine *pEngine) {
+	uint8_t i;
+
+	for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS; i++) {
+		if(JOBS_ENGINE_SLOT_FREE == pEngine->slots[i].state) {
+			return &pEngine->slots[i];
+		}
+	}
+	return NULL;
+}
+
+static IoT_Error_t _parse_int64(const char *pJson, jsmntok_t *pToken, int64_t *pValue) {
+	if(NULL == pToken) {
+		*pValue = 0;
+		return SUCCESS;
+	}
+	if(JSMN_PRIMITIVE != pToken->type) {
+		return JSON_PARSE_ERROR;
+	}
+	return parseSignedIntegerFromChars(pJson + pToken->start, pJson + pToken->end, INT64_MIN, INT64_MAX, pValue);
+}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+static void _worker_task(void *pArg);
+
+/* Hands one queued execution to the workers, called with the engine lock held */
+static void _wake_worker(AwsIotJobsEngine *pEngine) {
+	IoT_Error_t rc;
+
+	if(JOBS_ENGINE_WORKERS_RUNNING != pEngine->workersState) {
+		return;
+	}
+	rc = aws_iot_thread_pool_submit(&pEngine->workers, _worker_task, pEngine);
+	if(SUCCESS != rc) {
+		/* The queued tasks run every execution they find, this one included */
+		IOT_WARN("Jobs engine worker queue full: %d", rc);
+	}
+}
+#else
+#define _wake_worker(pEngine)
+#endif
+
+/* Copies the execution into a free slot. Called on the yield thread, with the engine lock held. */
+static void _queue_execution(AwsIotJobsEngine *pEngine, const char *pJson, jsmntok_t *pExecution,
+							 bool isStartNextReply) {
+	char jobId[MAX_SIZE_OF_JOB_ID + 1];
+	int64_t versionNumber, executionNumber;
+	jsmntok_t *pToken;
+	AwsIotJobsEngineSlot *pSlot;
+	size_t documentLength = 0;
+
+	pToken = findTokenOnTape("jobId", pJson, pEngine->tokens, pEngine->tape, pExecution);
+	if(NULL == pToken || SUCCESS != parseStringValue(jobId, sizeof(jobId), pJson, pToken)) {
+		IOT_WARN("Job execution without a valid jobId");
+		return;
+	}
+	if(SUCCESS != _parse_int64(pJson, findTokenOnTape("versionNumber", pJson, pEngine->tokens, pEngine->tape,
+													   pExecution), &versionNumber)
+	   || SUCCESS != _parse_int64(pJson, findTokenOnTape("executionNumber", pJson, pEngine->tokens, pEngine->tape,
+														  pExecution), &executionNumber)) {
+		IOT_WARN("Job execution %s has an invalid version or execution number", jobId);
+		return;
+	}
+
+	if(_is_job_held(pEngine, jobId)) {
+		/* start-next hands the execution we are running back until its final update is in */
+		if(isStartNextReply) {
+			pEngine->isStartNextWanted = false;
+		}
+		return;
+	}
+	if(_is_job_completed(pEngine, jobId, executionNumber)) {
+		return;
+	}
+
+	pSlot = _find_free_slot(pEngine);
+	if(NULL == pSlot) {
+		/* The execution stays pending in the service, start-next will return it later */
+		pEngine->isStartNextWanted = true;
+		return;
+	}
+
+	memset(pSlot, 0, sizeof(AwsIotJobsEngineSlot));
+	strcpy(pSlot->job.jobId, jobId);
+	pSlot->job.versionNumber = versionNumber;
+	pSlot->job.executionNumber = executionNumber;
+	pSlot->job.pJobDocument = pSlot->jobDocument;
+	pSlot->sequence = pEngine->nextSequence++;
+
+	pToken = findTokenOnTape("jobDocument", pJson, pEngine->tokens, pEngine->tape, pExecution);
+	if(NULL != pToken) {
+		documentLength = (size_t) (pToken->end - pToken->start);
+	}
+	if(documentLength >= AWS_IOT_JOBS_ENGINE_DOCUMENT_BYTES) {
+		IOT_WARN("Job document of %s is %u bytes, failing the execution", jobId, (unsigned) documentLength);
+		strcpy(pSlot->statusDetails, "{\"reason\":\"job document too large\"}");
+		pSlot->finalStatus = JOB_EXECUTION_FAILED;
+		pSlot->state = JOBS_ENGINE_SLOT_FINISHED;
+		return;
+	}
+	if(0 < documentLength) {
+		memcpy(pSlot->jobDocument, pJson + pToken->start, documentLength);
+	}
+	pSlot->jobDocument[documentLength] = '\0';
+	pSlot->job.jobDocumentLength = documentLength;
+	pSlot->state = JOBS_ENGINE_SLOT_QUEUED;
+	_wake_worker(pEngine);
+}
+
+static void _on_execution_message(AwsIotJobsEngine *pEngine, IoT_Publish_Message_Params *pParams,
+								  bool isStartNextReply) {
+	const char *pJson = (const char *) pParams->payload;
+	jsmntok_t *pExecution;
+	int32_t tokenCount;
+
+	if(isStartNextReply) {
+		pEngine->isStartNextInFlight = false;
+		init_timer(&pEngine->startNextTimer);
+	}
+
+	jsmn_init(&pEngine->parser);
+	tokenCount = aws_iot_json_parse(&pEngine->parser, pJson, pParams->payloadLen, pEngine->tokens,
+									MAX_JOB_JSON_TOKEN_EXPECTED);
+	if(tokenCount < 1 || JSMN_OBJECT != pEngine->tokens[0].type) {
+		IOT_WARN("Failed to parse job execution message: %d", tokenCount);
+		return;
+	}
+	buildJsonTape(pEngine->tokens, tokenCount, pEngine->tape);
+
+	pExecution = findTokenOnTape("execution", pJson, pEngine->tokens, pEngine->tape, pEngine->tokens);
+	if(NULL == pExecution || JSMN_OBJECT != pExecution->type) {
+		/* Nothing pending, notify-next will announce the next execution */
+		if(isStartNextReply) {
+			pEngine->isStartNextWanted = false;
+		}
+		return;
+	}
+
+	JOBS_ENGINE_LOCK(pEngine);
+	_queue_execution(pEngine, pJson, pExecution, isStartNextReply);
+	JOBS_ENGINE_UNLOCK(pEngine);
+}
+
+static void _notify_next_callback(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
+								  IoT_Publish_Message_Params *pParams, void *pData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(topicName);
+	IOT_UNUSED(topicNameLen);
+
+	_on_execution_message((AwsIotJobsEngine *) pData, pParams, false);
+}
+
+static void _start_next_accepted_callback(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
+										  IoT_Publish_Message_Params *pParams, void *pData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(topicName);
+	IOT_UNUSED(topicNameLen);
+
+	_on_execution_message((AwsIotJobsEngine *) pData, pParams, true);
+}
+
+static void _start_next_rejected_callback(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
+										  IoT_Publish_Message_Params *pParams, void *pData) {
+	AwsIotJobsEngine *pEngine = (AwsIotJobsEngine *) pData;
+
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(topicName);
+	IOT_UNUSED(topicNameLen);
+
+	IOT_WARN("start-next rejected: %.*s", (int) pParams->payloadLen, (const char *) pParams->payload);
+
+	/* Retried once the start-next timeout has elapsed */
+	pEngine->isStartNextInFlight = false;
+	countdown_ms(&pEngine->startNextTimer, AWS_IOT_JOBS_ENGINE_START_NEXT_TIMEOUT_MS);
+}
+
+IoT_Error_t aws_iot_jobs_engine_init(AwsIotJobsEngine *pEngine, AWS_IoT_Client *pClient,
+									 const AwsIotJobsEngineParams *pParams) {
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine || NULL == pClient || NULL == pParams || NULL == pParams->pThingName
+	   || NULL == pParams->handler) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+	if(strlen(pParams->pThingName) > MAX_SIZE_OF_THING_NAME) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
+	memset(pEngine, 0, sizeof(AwsIotJobsEngine));
+	pEngine->pClient = pClient;
+	pEngine->params = *pParams;
+	init_timer(&pEngine->startNextTimer);
+	init_timer(&pEngine->progressTimer);
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	rc = aws_iot_thread_mutex_init(&pEngine->lock);
+#endif
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_jobs_engine_start(AwsIotJobsEngine *pEngine) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	rc = aws_iot_jobs_subscribe_to_job_messages(
+			pEngine->pClient, pEngine->params.qos, pEngine->params.pThingName, NULL, JOB_NOTIFY_NEXT_TOPIC,
+			JOB_REQUEST_TYPE, _notify_next_callback, pEngine, pEngine->notifyNextTopic,
+			sizeof(pEngine->notifyNextTopic));
+	if(SUCCESS == rc) {
+		rc = aws_iot_jobs_subscribe_to_job_messages(
+				pEngine->pClient, pEngine->params.qos, pEngine->params.pThingName, NULL, JOB_START_NEXT_TOPIC,
+				JOB_ACCEPTED_REPLY_TYPE, _start_next_accepted_callback, pEngine, pEngine->startNextAcceptedTopic,
+				sizeof(pEngine->startNextAcceptedTopic));
+	}
+	if(SUCCESS == rc) {
+		rc = aws_iot_jobs_subscribe_to_job_messages(
+				pEngine->pClient, pEngine->params.qos, pEngine->params.pThingName, NULL, JOB_START_NEXT_TOPIC,
+				JOB_REJECTED_REPLY_TYPE, _start_next_rejected_callback, pEngine, pEngine->startNextRejectedTopic,
+				sizeof(pEngine->startNextRejectedTopic));
+	}
+	if(SUCCESS != rc) {
+		IOT_ERROR("Jobs engine subscription failed: %d", rc);
+		FUNC_EXIT_RC(rc);
+	}
+
+	pEngine->isSubscribed = true;
+	pEngine->isStartNextWanted = true;
+	pEngine->isStartNextInFlight = false;
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+IoT_Error_t aws_iot_jobs_engine_stop(AwsIotJobsEngine *pEngine) {
+	IoT_Error_t rc, unsubscribeRc;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+	if(!pEngine->isSubscribed) {
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	rc = aws_iot_jobs_unsubscribe_from_job_messages(pEngine->pClient, pEngine->notifyNextTopic);
+	unsubscribeRc = aws_iot_jobs_unsubscribe_from_job_messages(pEngine->pClient, pEngine->startNextAcceptedTopic);
+	if(SUCCESS == rc) {
+		rc = unsubscribeRc;
+	}
+	unsubscribeRc = aws_iot_jobs_unsubscribe_from_job_messages(pEngine->pClient, pEngine->startNextRejectedTopic);
+	if(SUCCESS == rc) {
+		rc = unsubscribeRc;
+	}
+
+	pEngine->isSubscribed = false;
+	pEngine->isStartNextWanted = false;
+	pEngine->isStartNextInFlight = false;
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_jobs_engine_free(AwsIotJobsEngine *pEngine) {
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+	rc = aws_iot_thread_mutex_destroy(&pEngine->lock);
+#endif
+
+	FUNC_EXIT_RC(rc);
+}
+
+/* Runs the oldest queued execution. Worker tasks only take one while the workers are running. */
+static bool _run_next_execution(AwsIotJobsEngine *pEngine, bool isWorker) {
+	AwsIotJobsEngineSlot *pSlot = NULL;
+	JobExecutionStatus status;
+	uint8_t i;
+
+	JOBS_ENGINE_LOCK(pEngine);
+#ifdef _ENABLE_THREAD_SUPPORT_
+	if(isWorker && JOBS_ENGINE_WORKERS_RUNNING != pEngine->workersState) {
+		JOBS_ENGINE_UNLOCK(pEngine);
+		return false;
+	}
+#else
+	IOT_UNUSED(isWorker);
+#endif
+	for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS; i++) {
+		if(JOBS_ENGINE_SLOT_QUEUED == pEngine->slots[i].state
+		   && (NULL == pSlot || (int32_t) (pEngine->slots[i].sequence - pSlot->sequence) < 0)) {
+			pSlot = &pEngine->slots[i];
+		}
+	}
+	if(NULL != pSlot) {
+		pSlot->state = JOBS_ENGINE_SLOT_RUNNING;
+	}
+	JOBS_ENGINE_UNLOCK(pEngine);
+
+	if(NULL == pSlot) {
+		return false;
+	}
+
+	status = pEngine->params.handler(pEngine, &pSlot->job, pEngine->params.pHandlerContext);
+	if(JOB_EXECUTION_SUCCEEDED != status && JOB_EXECUTION_FAILED != status && JOB_EXECUTION_REJECTED != status) {
+		IOT_WARN("Job handler returned non-final status %d for %s", status, pSlot->job.jobId);
+		status = JOB_EXECUTION_FAILED;
+	}
+
+	JOBS_ENGINE_LOCK(pEngine);
+	pSlot->finalStatus = status;
+	pSlot->isProgressPending = false;
+	pSlot->state = JOBS_ENGINE_SLOT_FINISHED;
+	JOBS_ENGINE_UNLOCK(pEngine);
+
+	return true;
+}
+
+bool aws_iot_jobs_engine_run_next(AwsIotJobsEngine *pEngine) {
+	if(NULL == pEngine) {
+		return false;
+	}
+
+	return _run_next_execution(pEngine, false);
+}
+
+IoT_Error_t aws_iot_jobs_engine_report_progress(AwsIotJobsEngine *pEngine, AwsIotJobsEngineJob *pJob,
+												const char *pStatusDetails) {
+	AwsIotJobsEngineSlot *pSlot;
+	size_t length;
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine || NULL == pJob || NULL == pStatusDetails) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+	length = strlen(pStatusDetails);
+	if(length >= AWS_IOT_JOBS_ENGINE_STATUS_DETAILS_BYTES) {
+		FUNC_EXIT_RC(LIMIT_EXCEEDED_ERROR);
+	}
+
+	/* The job is the first member of its slot */
+	pSlot = (AwsIotJobsEngineSlot *) pJob;
+
+	JOBS_ENGINE_LOCK(pEngine);
+	if(JOBS_ENGINE_SLOT_RUNNING != pSlot->state) {
+		rc = FAILURE;
+	} else {
+		memcpy(pSlot->statusDetails, pStatusDetails, length + 1);
+		pSlot->isProgressPending = true;
+	}
+	JOBS_ENGINE_UNLOCK(pEngine);
+
+	FUNC_EXIT_RC(rc);
+}
+
+static IoT_Error_t _send_update(AwsIotJobsEngine *pEngine, const AwsIotJobsEngineJob *pJob,
+								JobExecutionStatus status, const char *pStatusDetails) {
+	AwsIotJobExecutionUpdateRequest updateRequest;
+
+	updateRequest.status = status;
+	updateRequest.statusDetails = ('\0' != pStatusDetails[0]) ? pStatusDetails : NULL;
+	updateRequest.expectedVersion = 0;
+	updateRequest.executionNumber = pJob->executionNumber;
+	updateRequest.includeJobExecutionState = false;
+	updateRequest.includeJobDocument = false;
+	updateRequest.clientToken = NULL;
+
+	return aws_iot_jobs_send_update(pEngine->pClient, pEngine->params.qos, pEngine->params.pThingName, pJob->jobId,
+									&updateRequest, pEngine->requestTopic, sizeof(pEngine->requestTopic),
+									pEngine->requestBuffer, sizeof(pEngine->requestBuffer));
+}
+
+static IoT_Error_t _send_start_next(AwsIotJobsEngine *pEngine) {
+	AwsIotStartNextPendingJobExecutionRequest startNextRequest;
+
+	startNextRequest.statusDetails = NULL;
+	startNextRequest.clientToken = NULL;
+
+	return aws_iot_jobs_start_next(pEngine->pClient, pEngine->params.qos, pEngine->params.pThingName,
+								   &startNextRequest, pEngine->requestTopic, sizeof(pEngine->requestTopic),
+								   pEngine->requestBuffer, sizeof(pEngine->requestBuffer));
+}
+
+IoT_Error_t aws_iot_jobs_engine_service(AwsIotJobsEngine *pEngine) {
+	char statusDetails[AWS_IOT_JOBS_ENGINE_STATUS_DETAILS_BYTES];
+	AwsIotJobsEngineSlot *pSlot;
+	AwsIotJobsEngineCompletedJob *pCompleted;
+	bool hasFreeSlot = false;
+	bool isFinished;
+	bool isProgressSent = false;
+	uint8_t updateCount = 0;
+	uint8_t i;
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	/* Final updates, workers no longer touch a slot once they have marked it finished under the lock */
+	for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS && updateCount < AWS_IOT_JOBS_ENGINE_MAX_UPDATES_PER_BATCH; i++) {
+		pSlot = &pEngine->slots[i];
+
+		JOBS_ENGINE_LOCK(pEngine);
+		isFinished = (JOBS_ENGINE_SLOT_FINISHED == pSlot->state);
+		JOBS_ENGINE_UNLOCK(pEngine);
+		if(!isFinished) {
+			continue;
+		}
+		rc = _send_update(pEngine, &pSlot->job, pSlot->finalStatus, pSlot->statusDetails);
+		if(SUCCESS != rc) {
+			IOT_ERROR("Final update of job %s failed: %d", pSlot->job.jobId, rc);
+			FUNC_EXIT_RC(rc);
+		}
+		updateCount++;
+
+		pCompleted = &pEngine->completed[pEngine->nextCompleted];
+		pEngine->nextCompleted = (uint8_t) ((pEngine->nextCompleted + 1) % AWS_IOT_JOBS_ENGINE_MAX_JOBS);
+		strcpy(pCompleted->jobId, pSlot->job.jobId);
+		pCompleted->executionNumber = pSlot->job.executionNumber;
+
+		JOBS_ENGINE_LOCK(pEngine);
+		pSlot->state = JOBS_ENGINE_SLOT_FREE;
+		JOBS_ENGINE_UNLOCK(pEngine);
+
+		pEngine->isStartNextWanted = pEngine->isSubscribed;
+	}
+
+	/* Progress updates, only the latest details of each execution, once per interval */
+	if(has_timer_expired(&pEngine->progressTimer)) {
+		for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS && updateCount < AWS_IOT_JOBS_ENGINE_MAX_UPDATES_PER_BATCH; i++) {
+			pSlot = &pEngine->slots[i];
+
+			JOBS_ENGINE_LOCK(pEngine);
+			if(JOBS_ENGINE_SLOT_RUNNING != pSlot->state || !pSlot->isProgressPending) {
+				JOBS_ENGINE_UNLOCK(pEngine);
+				continue;
+			}
+			strcpy(statusDetails, pSlot->statusDetails);
+			pSlot->isProgressPending = false;
+			JOBS_ENGINE_UNLOCK(pEngine);
+
+			rc = _send_update(pEngine, &pSlot->job, JOB_EXECUTION_IN_PROGRESS, statusDetails);
+			if(SUCCESS != rc) {
+				JOBS_ENGINE_LOCK(pEngine);
+				if(JOBS_ENGINE_SLOT_RUNNING == pSlot->state) {
+					pSlot->isProgressPending = true;
+				}
+				JOBS_ENGINE_UNLOCK(pEngine);
+				IOT_ERROR("Progress update of job %s failed: %d", pSlot->job.jobId, rc);
+				FUNC_EXIT_RC(rc);
+			}
+			updateCount++;
+			isProgressSent = true;
+		}
+		if(isProgressSent) {
+			countdown_ms(&pEngine->progressTimer, pEngine->params.updateIntervalMs);
+		}
+	}
+
+	/* Prefetch, right behind the final update so the next document arrives while it is processed */
+	if(pEngine->isStartNextInFlight && has_timer_expired(&pEngine->startNextTimer)) {
+		IOT_WARN("start-next reply timed out, asking again");
+		pEngine->isStartNextInFlight = false;
+	}
+	JOBS_ENGINE_LOCK(pEngine);
+	hasFreeSlot = (NULL != _find_free_slot(pEngine));
+	JOBS_ENGINE_UNLOCK(pEngine);
+
+	if(pEngine->isStartNextWanted && !pEngine->isStartNextInFlight && hasFreeSlot
+	   && has_timer_expired(&pEngine->startNextTimer)) {
+		rc = _send_start_next(pEngine);
+		if(SUCCESS != rc) {
+			IOT_ERROR("start-next request failed: %d", rc);
+			FUNC_EXIT_RC(rc);
+		}
+		pEngine->isStartNextInFlight = true;
+		countdown_ms(&pEngine->startNextTimer, AWS_IOT_JOBS_ENGINE_START_NEXT_TIMEOUT_MS);
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+/* One task is submitted per queued execution. A task runs executions until none is queued, so an
+ * execution whose task could not be submitted is run by a task queued before it. */
+static void _worker_task(void *pArg) {
+	AwsIotJobsEngine *pEngine = (AwsIotJobsEngine *) pArg;
+
+	while(_run_next_execution(pEngine, true)) {
+	}
+}
+
+IoT_Error_t aws_iot_jobs_engine_start_workers(AwsIotJobsEngine *pEngine, uint8_t workerCount) {
+	IoT_Error_t rc;
+	uint8_t i;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+	if(0 == workerCount || workerCount > AWS_IOT_JOBS_ENGINE_MAX_WORKERS) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
+	JOBS_ENGINE_LOCK(pEngine);
+	if(JOBS_ENGINE_WORKERS_STOPPED != pEngine->workersState) {
+		rc = FAILURE;
+	} else {
+		rc = aws_iot_thread_pool_init(&pEngine->workers, workerCount, NULL);
+	}
+	if(SUCCESS == rc) {
+		pEngine->workersState = JOBS_ENGINE_WORKERS_RUNNING;
+		/* Executions queued before the workers started */
+		for(i = 0; i < AWS_IOT_JOBS_ENGINE_MAX_JOBS; i++) {
+			if(JOBS_ENGINE_SLOT_QUEUED == pEngine->slots[i].state) {
+				_wake_worker(pEngine);
+			}
+		}
+	}
+	JOBS_ENGINE_UNLOCK(pEngine);
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_jobs_engine_stop_workers(AwsIotJobsEngine *pEngine) {
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+	if(NULL == pEngine) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	JOBS_ENGINE_LOCK(pEngine);
+	if(JOBS_ENGINE_WORKERS_RUNNING != pEngine->workersState) {
+		rc = FAILURE;
+	} else {
+		pEngine->workersState = JOBS_ENGINE_WORKERS_STOPPING;
+	}
+	JOBS_ENGINE_UNLOCK(pEngine);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
+	/* Tasks still queued return without running an execution */
+	rc = aws_iot_thread_pool_destroy(&pEngine->workers);
+
+	JOBS_ENGINE_LOCK(pEngine);
+	pEngine->workersState = JOBS_ENGINE_WORKERS_STOPPED;
+	JOBS_ENGINE_UNLOCK(pEngine);
+
+	FUNC_EXIT_RC(rc);
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,66 +22,21 @@ extern "C" {
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stddef.h>
-#include <stdio.h>
-#include <stdarg.h>
 
 #include "jsmn.h"
 #include "aws_iot_jobs_json.h"
+#include "aws_iot_json_writer.h"
 
-struct _SerializeState {
-	int totalSize;
-	char *nextPtr;
-	size_t remaingSize;
-};
-
-static void _printToBuffer(struct _SerializeState *state, const char *fmt, ...) {
-	if (state->totalSize == -1) return;
-
-	va_list vl;
-	va_start(vl, fmt);
-	int len = vsnprintf(state->nextPtr, state->remaingSize, fmt, vl);
-	if (len < 0) {
-		state->totalSize = -1;
-	} else {
-		state->totalSize += len;
-		if (state->nextPtr != NULL) {
-			if (state->remaingSize > (size_t) len) {
-				state->remaingSize -= (size_t) len;
-				state->nextPtr += len;
-			} else {
-				state->remaingSize = 0;
-				state->nextPtr = NULL;
-			}
-		}
-	}
-	va_end(vl);
+static void _printKey(IoT_Json_Writer_t *writer, bool first, const char *key) {
+	aws_iot_json_writer_char(writer, first ? '{' : ',');
+	aws_iot_json_writer_key(writer, key);
 }
 
-static void _printKey(struct _SerializeState *state, bool first, const char *key) {
-	if (first) {
-		_printToBuffer(state, "{\"%s\":", key);
-	} else {
-		_printToBuffer(state, ",\"%s\":", key);
-	}
-}
-
-static void _printStringValue(struct _SerializeState *state, const char *value) {
+static void _printStringValue(IoT_Json_Writer_t *writer, const char *value) {
 	if (value == NULL) {
-		_printToBuffer(state, "null");
-	} else {
-		_printToBuffer(state, "\"%s\"", value);
-	}
-}
-
-static void _printLongValue(struct _SerializeState *state, int64_t value) {
-	_printToBuffer(state, "%lld", value);
-}
-
-static void _printBooleanValue(struct _SerializeState *state, bool value) {
-	if(value) {
-		_printToBuffer(state, "true");
+		aws_iot_json_writer_raw(writer, "null", 4);
 	} else {
-		_printToBuffer(state, "false");
+		aws_iot_json_writer_string(writer, value);
 	}
 }
 
@@ -93,49 +48,51 @@ int aws_iot_jobs_json_serialize_update_job_execution_request(
 	if (statusStr == NULL) return -1;
 	if (requestBuffer == NULL) bufferSize = 0;
 
-	struct _SerializeState state = { 0, requestBuffer, bufferSize };
+	IoT_Json_Writer_t state;
+	aws_iot_json_writer_init(&state, requestBuffer, bufferSize, 0);
 	_printKey(&state, true, "status");
 	_printStringValue(&state, statusStr);
 	if (request->statusDetails != NULL) {
 		_printKey(&state, false, "statusDetails");
-		_printToBuffer(&state, "%s", request->statusDetails);
+		aws_iot_json_writer_raw_string(&state, request->statusDetails);
 	}
 	if (request->executionNumber != 0) {
 		_printKey(&state, false, "executionNumber");
-		_printLongValue(&state, request->executionNumber);
+		aws_iot_json_writer_int(&state, request->executionNumber);
 	}
 	if (request->expectedVersion != 0) {
 		_printKey(&state, false, "expectedVersion");
-		_printLongValue(&state, request->expectedVersion);
+		aws_iot_json_writer_int(&state, request->expectedVersion);
 	}
 	if (request->includeJobExecutionState) {
 		_printKey(&state, false, "includeJobExecutionState");
-		_printBooleanValue(&state, request->includeJobExecutionState);
+		aws_iot_json_writer_bool(&state, request->includeJobExecutionState);
 	}
 	if (request->includeJobDocument) {
 		_printKey(&state, false, "includeJobDocument");
-		_printBooleanValue(&state, request->includeJobDocument);
+		aws_iot_json_writer_bool(&state, request->includeJobDocument);
 	}
 	if (request->clientToken != NULL) {
 		_printKey(&state, false, "clientToken");
 		_printStringValue(&state, request->clientToken);
 	}
 
-	_printToBuffer(&state, "}");
+	aws_iot_json_writer_char(&state, '}');
 
-	return state.totalSize;
+	return (int) state.length;
 }
 
 int aws_iot_jobs_json_serialize_client_token_only_request(
 		char *requestBuffer, size_t bufferSize,
 		const char *clientToken)
 {
-	struct _SerializeState state = { 0, requestBuffer, bufferSize };
+	IoT_Json_Writer_t state;
+	aws_iot_json_writer_init(&state, requestBuffer, bufferSize, 0);
 	_printKey(&state, true, "clientToken");
 	_printStringValue(&state, clientToken);
-	_printToBuffer(&state, "}");
+	aws_iot_json_writer_char(&state, '}');
 
-	return state.totalSize;
+	return (int) state.length;
 }
 
 int aws_iot_jobs_json_serialize_describe_job_execution_request(
@@ -146,7 +103,8 @@ int aws_iot_jobs_json_serialize_describe_job_execution_request(
 
 	if (requestBuffer == NULL) return 0;
 
-	struct _SerializeState state = { 0, requestBuffer, bufferSize };
+	IoT_Json_Writer_t state;
+	aws_iot_json_writer_init(&state, requestBuffer, bufferSize, 0);
 	if (request->clientToken != NULL) {
 		_printKey(&state, first, "clientToken");
 		_printStringValue(&state, request->clientToken);
@@ -154,17 +112,17 @@ int aws_iot_jobs_json_serialize_describe_job_execution_request(
 	}
 	if (request->executionNumber != 0) {
 		_printKey(&state, first, "executionNumber");
-		_printLongValue(&state, request->executionNumber);
+		aws_iot_json_writer_int(&state, request->executionNumber);
 		first = false;
 	}
 	if (request->includeJobDocument) {
 		_printKey(&state, first, "includeJobDocument");
-		_printBooleanValue(&state, request->includeJobDocument);
+		aws_iot_json_writer_bool(&state, request->includeJobDocument);
 	}
 
-	_printToBuffer(&state, "}");
+	aws_iot_json_writer_char(&state, '}');
 
-	return state.totalSize;
+	return (int) state.length;
 }
 
 int aws_iot_jobs_json_serialize_start_next_job_execution_request(
@@ -172,10 +130,11 @@ int aws_iot_jobs_json_serialize_start_next_job_execution_request(
 		const AwsIotStartNextPendingJobExecutionRequest *request)
 {
 	if (requestBuffer == NULL) bufferSize = 0;
-	struct _SerializeState state = { 0, requestBuffer, bufferSize };
+	IoT_Json_Writer_t state;
+	aws_iot_json_writer_init(&state, requestBuffer, bufferSize, 0);
 	if (request->statusDetails != NULL) {
 		_printKey(&state, true, "statusDetails");
-		_printToBuffer(&state, "%s", request->statusDetails);
+		aws_iot_json_writer_raw_string(&state, request->statusDetails);
 	}
 	if (request->clientToken != NULL) {
 		if(request->statusDetails != NULL) {
@@ -186,10 +145,10 @@ int aws_iot_jobs_json_serialize_start_next_job_execution_request(
 		_printStringValue(&state, request->clientToken);
 	}
 	if (request->clientToken == NULL && request->statusDetails == NULL) {
-		_printToBuffer(&state, "{");
+		aws_iot_json_writer_char(&state, '{');
 	}
-	_printToBuffer(&state, "}");
-	return state.totalSize;
+	aws_iot_json_writer_char(&state, '}');
+	return (int) state.length;
 }
 
 #ifdef __cplusplus
@@ -19,7 +19,6 @@ extern "C" {
 
 #include "aws_iot_jobs_topics.h"
 #include <string.h>
-#include <stdio.h>
 #include <stdbool.h>
 
 #define BASE_THINGS_TOPIC "$aws/things/"
@@ -34,21 +33,46 @@ extern "C" {
 #define REJECTED_REPLY "rejected"
 #define WILDCARD_REPLY "+"
 
-static const char *_get_operation_for_base_topic(AwsIotJobExecutionTopicType topicType) {
+/* Topic parts with their lengths, so that topics are assembled with memcpy instead of formatted */
+typedef struct {
+	const char *pText;
+	size_t length;
+} _JobsTopicPart;
+
+#define JOBS_TOPIC_PART(text) { text, sizeof(text) - 1 }
+
+static const _JobsTopicPart notifyOperation = JOBS_TOPIC_PART(NOTIFY_OPERATION);
+static const _JobsTopicPart notifyNextOperation = JOBS_TOPIC_PART(NOTIFY_NEXT_OPERATION);
+static const _JobsTopicPart getOperation = JOBS_TOPIC_PART(GET_OPERATION);
+static const _JobsTopicPart startNextOperation = JOBS_TOPIC_PART(START_NEXT_OPERATION);
+static const _JobsTopicPart wildcardOperation = JOBS_TOPIC_PART(WILDCARD_OPERATION);
+static const _JobsTopicPart updateOperation = JOBS_TOPIC_PART(UPDATE_OPERATION);
+
+static const _JobsTopicPart requestSuffix = JOBS_TOPIC_PART("");
+static const _JobsTopicPart acceptedSuffix = JOBS_TOPIC_PART("/" ACCEPTED_REPLY);
+static const _JobsTopicPart rejectedSuffix = JOBS_TOPIC_PART("/" REJECTED_REPLY);
+static const _JobsTopicPart wildcardSuffix = JOBS_TOPIC_PART("/" WILDCARD_REPLY);
+
+static const _JobsTopicPart baseTopic = JOBS_TOPIC_PART(BASE_THINGS_TOPIC);
+static const _JobsTopicPart jobsInfix = JOBS_TOPIC_PART("/jobs/");
+static const _JobsTopicPart allJobsTopic = JOBS_TOPIC_PART("#");
+static const _JobsTopicPart separator = JOBS_TOPIC_PART("/");
+
+static const _JobsTopicPart *_get_operation_for_base_topic(AwsIotJobExecutionTopicType topicType) {
 	switch (topicType) {
 	case JOB_UPDATE_TOPIC:
-		return UPDATE_OPERATION;
+		return &updateOperation;
 	case JOB_NOTIFY_TOPIC:
-		return NOTIFY_OPERATION;
+		return &notifyOperation;
 	case JOB_NOTIFY_NEXT_TOPIC:
-	    return NOTIFY_NEXT_OPERATION;
+	    return &notifyNextOperation;
 	case JOB_GET_PENDING_TOPIC:
 	case JOB_DESCRIBE_TOPIC:
-		return GET_OPERATION;
+		return &getOperation;
 	case JOB_START_NEXT_TOPIC:
-	    return START_NEXT_OPERATION;
+	    return &startNextOperation;
 	case JOB_WILDCARD_TOPIC:
-		return WILDCARD_OPERATION;
+		return &wildcardOperation;
 	case JOB_UNRECOGNIZED_TOPIC:
 	default:
 		return NULL;
@@ -71,26 +95,38 @@ static bool _base_topic_requires_job_id(AwsIotJobExecutionTopicType topicType) {
 	}
 }
 
-static const char *_get_suffix_for_topic_type(AwsIotJobExecutionTopicReplyType replyType) {
+static const _JobsTopicPart *_get_suffix_for_topic_type(AwsIotJobExecutionTopicReplyType replyType) {
 	switch (replyType) {
 	case JOB_REQUEST_TYPE:
-		return "";
-		break;
+		return &requestSuffix;
 	case JOB_ACCEPTED_REPLY_TYPE:
-		return "/" ACCEPTED_REPLY;
-		break;
+		return &acceptedSuffix;
 	case JOB_REJECTED_REPLY_TYPE:
-		return "/" REJECTED_REPLY;
-		break;
+		return &rejectedSuffix;
 	case JOB_WILDCARD_REPLY_TYPE:
-		return "/" WILDCARD_REPLY;
-		break;
+		return &wildcardSuffix;
 	case JOB_UNRECOGNIZED_TOPIC_TYPE:
 	default:
 		return NULL;
 	}
 }
 
+/* Copies what still fits before the terminator and returns the full length of the topic so far,
+ * like snprintf does */
+static size_t _append_topic_part(char *buffer, size_t bufferSize, size_t used, const char *pText, size_t length) {
+	size_t toCopy;
+
+	if (used + 1 < bufferSize) {
+		toCopy = bufferSize - 1 - used;
+		if (toCopy > length) {
+			toCopy = length;
+		}
+		memcpy(buffer + used, pText, toCopy);
+	}
+
+	return used + length;
+}
+
 int aws_iot_jobs_get_api_topic(char *buffer, size_t bufferSize,
 		AwsIotJobExecutionTopicType topicType, AwsIotJobExecutionTopicReplyType replyType,
 		const char* thingName, const char* jobId)
@@ -108,20 +144,37 @@ int aws_iot_jobs_get_api_topic(char *buffer, size_t bufferSize,
 		return -1;
 	}
 
-	const char *operation = _get_operation_for_base_topic(topicType);
+	const _JobsTopicPart *operation = _get_operation_for_base_topic(topicType);
 	if (operation == NULL) {
 		return -1;
 	}
 
-	const char *suffix = _get_suffix_for_topic_type(replyType);
+	const _JobsTopicPart *suffix = _get_suffix_for_topic_type(replyType);
+	if (suffix == NULL) {
+		return -1;
+	}
+
+	size_t used = _append_topic_part(buffer, bufferSize, 0, baseTopic.pText, baseTopic.length);
+	used = _append_topic_part(buffer, bufferSize, used, thingName, strlen(thingName));
+	used = _append_topic_part(buffer, bufferSize, used, jobsInfix.pText, jobsInfix.length);
 
 	if (requireJobId || (topicType == JOB_WILDCARD_TOPIC && jobId != NULL)) {
-		return snprintf(buffer, bufferSize, BASE_THINGS_TOPIC "%s/jobs/%s/%s%s", thingName, jobId, operation, suffix);
+		used = _append_topic_part(buffer, bufferSize, used, jobId, strlen(jobId));
+		used = _append_topic_part(buffer, bufferSize, used, separator.pText, separator.length);
+		used = _append_topic_part(buffer, bufferSize, used, operation->pText, operation->length);
+		used = _append_topic_part(buffer, bufferSize, used, suffix->pText, suffix->length);
 	} else if (topicType == JOB_WILDCARD_TOPIC) {
-		return snprintf(buffer, bufferSize, BASE_THINGS_TOPIC "%s/jobs/#", thingName);
+		used = _append_topic_part(buffer, bufferSize, used, allJobsTopic.pText, allJobsTopic.length);
 	} else {
-		return snprintf(buffer, bufferSize, BASE_THINGS_TOPIC "%s/jobs/%s%s", thingName, operation, suffix);
+		used = _append_topic_part(buffer, bufferSize, used, operation->pText, operation->length);
+		used = _append_topic_part(buffer, bufferSize, used, suffix->pText, suffix->length);
+	}
+
+	if (bufferSize > 0) {
+		buffer[used < bufferSize ? used : bufferSize - 1] = '\0';
 	}
+
+	return (int) used;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,411 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_json_tokenizer.c
+ * @brief Vectorised drop-in replacement for jsmn_parse
+ *
+ * The structural state machine is the one of jsmn_parse in non-strict mode without parent links, so
+ * tokens and error codes match it byte for byte. Only the inner loops that walk string bodies,
+ * whitespace and primitives are replaced by block scans that classify 16 bytes per step.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_json_tokenizer.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SCAN_BLOCK_SIZE 16
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JSON_SCAN_BLOCK_SIZE 16
+#endif
+
+/* The scanners replace the inner loops of the jsmn configuration used by the SDK, other configurations
+ * are handed to jsmn_parse */
+#if !defined(JSMN_STRICT) && !defined(JSMN_PARENT_LINKS)
+
+#if defined(__SSE2__)
+
+static inline uint32_t firstMatchInBlock(__m128i match) {
+	uint32_t bits = (uint32_t) _mm_movemask_epi8(match);
+
+	return (0 == bits) ? JSON_SCAN_BLOCK_SIZE : (uint32_t) __builtin_ctz(bits);
+}
+
+/* Offset of the first quote or backslash, JSON_SCAN_BLOCK_SIZE if there is none */
+static inline uint32_t stringSpecialInBlock(const char *pBlock) {
+	__m128i v = _mm_loadu_si128((const __m128i *) pBlock);
+
+	return firstMatchInBlock(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+										  _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+}
+
+/* Offset of the first byte that ends a primitive or is not printable ASCII. Signed compare so
+ * bytes of 128 and above are below 33 too */
+static inline uint32_t primitiveEndInBlock(const char *pBlock) {
+	__m128i v = _mm_loadu_si128((const __m128i *) pBlock);
+	__m128i match = _mm_cmplt_epi8(v, _mm_set1_epi8(33));
+
+	match = _mm_or_si128(match, _mm_cmpeq_epi8(v, _mm_set1_epi8(127)));
+	match = _mm_or_si128(match, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+	match = _mm_or_si128(match, _mm_cmpeq_epi8(v, _mm_set1_epi8(']')));
+	match = _mm_or_si128(match, _mm_cmpeq_epi8(v, _mm_set1_epi8('}')));
+	match = _mm_or_si128(match, _mm_cmpeq_epi8(v, _mm_set1_epi8(':')));
+	return firstMatchInBlock(match);
+}
+
+/* Offset of the first byte that is not JSON whitespace */
+static inline uint32_t nonWhitespaceInBlock(const char *pBlock) {
+	__m128i v = _mm_loadu_si128((const __m128i *) pBlock);
+	__m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+
+	space = _mm_or_si128(space, _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+	space = _mm_or_si128(space, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+	return firstMatchInBlock(_mm_xor_si128(space, _mm_set1_epi8(-1)));
+}
+
+#elif defined(JSON_SCAN_BLOCK_SIZE)
+
+/* NEON has no movemask, narrowing the compare result leaves one nibble per byte */
+static inline uint32_t firstMatchInBlock(uint8x16_t match) {
+	uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+
+	return (0 == bits) ? JSON_SCAN_BLOCK_SIZE : (uint32_t) (__builtin_ctzll(bits) >> 2);
+}
+
+static inline uint32_t stringSpecialInBlock(const char *pBlock) {
+	uint8x16_t v = vld1q_u8((const uint8_t *) pBlock);
+
+	return firstMatchInBlock(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+}
+
+static inline uint32_t primitiveEndInBlock(const char *pBlock) {
+	uint8x16_t v = vld1q_u8((const uint8_t *) pBlock);
+	uint8x16_t match = vorrq_u8(vcltq_u8(v, vdupq_n_u8(33)), vcgeq_u8(v, vdupq_n_u8(127)));
+
+	match = vorrq_u8(match, vceqq_u8(v, vdupq_n_u8(',')));
+	match = vorrq_u8(match, vceqq_u8(v, vdupq_n_u8(']')));
+	match = vorrq_u8(match, vceqq_u8(v, vdupq_n_u8('}')));
+	match = vorrq_u8(match, vceqq_u8(v, vdupq_n_u8(':')));
+	return firstMatchInBlock(match);
+}
+
+static inline uint32_t nonWhitespaceInBlock(const char *pBlock) {
+	uint8x16_t v = vld1q_u8((const uint8_t *) pBlock);
+	uint8x16_t space = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\n')));
+
+	space = vorrq_u8(space, vceqq_u8(v, vdupq_n_u8('\t')));
+	space = vorrq_u8(space, vceqq_u8(v, vdupq_n_u8('\r')));
+	return firstMatchInBlock(vmvnq_u8(space));
+}
+
+#endif
+
+static bool isWhitespace(char c) {
+	return ' ' == c || '\n' == c || '\t' == c || '\r' == c;
+}
+
+static bool isPrimitiveDelimiter(char c) {
+	return isWhitespace(c) || ',' == c || ']' == c || '}' == c || ':' == c;
+}
+
+static bool isPrimitiveEnd(char c) {
+	unsigned char u = (unsigned char) c;
+
+	return u < 33 || u >= 127 || isPrimitiveDelimiter(c);
+}
+
+/* Position of the first quote or backslash at or after pos, length if there is none */
+static size_t skipStringBody(const char *pJson, size_t pos, size_t length) {
+#ifdef JSON_SCAN_BLOCK_SIZE
+	uint32_t offset;
+
+	while(pos + JSON_SCAN_BLOCK_SIZE <= length) {
+		offset = stringSpecialInBlock(pJson + pos);
+		pos += offset;
+		if(offset < JSON_SCAN_BLOCK_SIZE) {
+			return pos;
+		}
+	}
+#endif
+	for(; pos < length && '"' != pJson[pos] && '\\' != pJson[pos]; pos++);
+	return pos;
+}
+
+static size_t skipPrimitive(const char *pJson, size_t pos, size_t length) {
+#ifdef JSON_SCAN_BLOCK_SIZE
+	uint32_t offset;
+
+	while(pos + JSON_SCAN_BLOCK_SIZE <= length) {
+		offset = primitiveEndInBlock(pJson + pos);
+		pos += offset;
+		if(offset < JSON_SCAN_BLOCK_SIZE) {
+			return pos;
+		}
+	}
+#endif
+	for(; pos < length && !isPrimitiveEnd(pJson[pos]); pos++);
+	return pos;
+}
+
+static size_t skipWhitespace(const char *pJson, size_t pos, size_t length) {
+#ifdef JSON_SCAN_BLOCK_SIZE
+	uint32_t offset;
+
+	while(pos + JSON_SCAN_BLOCK_SIZE <= length) {
+		offset = nonWhitespaceInBlock(pJson + pos);
+		pos += offset;
+		if(offset < JSON_SCAN_BLOCK_SIZE) {
+			return pos;
+		}
+	}
+#endif
+	for(; pos < length && isWhitespace(pJson[pos]); pos++);
+	return pos;
+}
+
+static jsmntok_t *allocToken(jsmn_parser *pParser, jsmntok_t *pTokens, unsigned int maxTokens) {
+	jsmntok_t *pToken;
+
+	if(pParser->toknext >= maxTokens) {
+		return NULL;
+	}
+	pToken = &pTokens[pParser->toknext++];
+	pToken->start = pToken->end = -1;
+	pToken->size = 0;
+	return pToken;
+}
+
+static void fillToken(jsmntok_t *pToken, jsmntype_t type, int start, int end) {
+	pToken->type = type;
+	pToken->start = start;
+	pToken->end = end;
+	pToken->size = 0;
+}
+
+/* The parser is on the opening quote. fullLength is the length before truncation at a NUL byte, jsmn
+ * checks it rather than the NUL when looking at the byte after a backslash */
+static int parseString(jsmn_parser *pParser, const char *pJson, size_t length, size_t fullLength,
+					   jsmntok_t *pTokens, unsigned int maxTokens) {
+	jsmntok_t *pToken;
+	unsigned int start = pParser->pos;
+	size_t pos = skipStringBody(pJson, start + 1, length);
+	uint32_t i;
+
+	while(pos < length) {
+		if('"' == pJson[pos]) {
+			pToken = allocToken(pParser, pTokens, maxTokens);
+			if(NULL == pToken) {
+				return JSMN_ERROR_NOMEM;
+			}
+			fillToken(pToken, JSMN_STRING, (int) start + 1, (int) pos);
+			pParser->pos = (unsigned int) pos;
+			return 0;
+		}
+
+		if(pos + 1 < fullLength) {
+			pos++;
+			switch(pJson[pos]) {
+				case '"': case '/': case '\\': case 'b':
+				case 'f': case 'r': case 'n': case 't':
+					break;
+				case 'u':
+					pos++;
+					for(i = 0; i < 4 && pos < length; i++, pos++) {
+						if(!isxdigit((unsigned char) pJson[pos])) {
+							return JSMN_ERROR_INVAL;
+						}
+					}
+					pos--;
+					break;
+				default:
+					return JSMN_ERROR_INVAL;
+			}
+		}
+		pos = skipStringBody(pJson, pos + 1, length);
+	}
+
+	return JSMN_ERROR_PART;
+}
+
+static int parsePrimitive(jsmn_parser *pParser, const char *pJson, size_t length, jsmntok_t *pTokens,
+						  unsigned int maxTokens) {
+	jsmntok_t *pToken;
+	unsigned int start = pParser->pos;
+	size_t pos = skipPrimitive(pJson, start, length);
+
+	if(pos < length && !isPrimitiveDelimiter(pJson[pos])) {
+		return JSMN_ERROR_INVAL;
+	}
+
+	pToken = allocToken(pParser, pTokens, maxTokens);
+	if(NULL == pToken) {
+		return JSMN_ERROR_NOMEM;
+	}
+	fillToken(pToken, JSMN_PRIMITIVE, (int) start, (int) pos);
+	pParser->pos = (unsigned int) pos - 1;
+	return 0;
+}
+
+static int closeContainer(jsmn_parser *pParser, jsmntok_t *pTokens, char c) {
+	jsmntype_t type = ('}' == c) ? JSMN_OBJECT : JSMN_ARRAY;
+	int i;
+
+	for(i = (int) pParser->toknext - 1; i >= 0; i--) {
+		if(-1 != pTokens[i].start && -1 == pTokens[i].end) {
+			if(type != pTokens[i].type) {
+				return JSMN_ERROR_INVAL;
+			}
+			pParser->toksuper = -1;
+			pTokens[i].end = (int) pParser->pos + 1;
+			break;
+		}
+	}
+
+	/* Unmatched closing bracket */
+	if(-1 == i) {
+		return JSMN_ERROR_INVAL;
+	}
+
+	for(; i >= 0; i--) {
+		if(-1 != pTokens[i].start && -1 == pTokens[i].end) {
+			pParser->toksuper = i;
+			break;
+		}
+	}
+	return 0;
+}
+
+#endif
+
+int aws_iot_json_tokenize(jsmn_parser *pParser, const char *pJson, size_t length, jsmntok_t *pTokens,
+						  unsigned int maxTokens) {
+#if defined(JSMN_STRICT) || defined(JSMN_PARENT_LINKS)
+	return jsmn_parse(pParser, pJson, length, pTokens, maxTokens);
+#else
+	const char *pNul;
+	size_t fullLength = length;
+	jsmntok_t *pToken;
+	int count, rc, i;
+	char c;
+
+	if(NULL == pTokens) {
+		return jsmn_parse(pParser, pJson, length, pTokens, maxTokens);
+	}
+
+	/* jsmn stops at the first NUL byte, cut the document there once instead of testing every byte */
+	if(pParser->pos < length) {
+		pNul = (const char *) memchr(pJson + pParser->pos, '\0', length - pParser->pos);
+		if(NULL != pNul) {
+			length = (size_t) (pNul - pJson);
+		}
+	}
+
+	count = (int) pParser->toknext;
+	for(; pParser->pos < length; pParser->pos++) {
+		c = pJson[pParser->pos];
+		switch(c) {
+			case '{': case '[':
+				count++;
+				pToken = allocToken(pParser, pTokens, maxTokens);
+				if(NULL == pToken) {
+					return JSMN_ERROR_NOMEM;
+				}
+				if(-1 != pParser->toksuper) {
+					pTokens[pParser->toksuper].size++;
+				}
+				pToken->type = ('{' == c) ? JSMN_OBJECT : JSMN_ARRAY;
+				pToken->start = (int) pParser->pos;
+				pParser->toksuper = (int) pParser->toknext - 1;
+				break;
+			case '}': case ']':
+				rc = closeContainer(pParser, pTokens, c);
+				if(rc < 0) {
+					return rc;
+				}
+				break;
+			case '"':
+				rc = parseString(pParser, pJson, length, fullLength, pTokens, maxTokens);
+				if(rc < 0) {
+					return rc;
+				}
+				count++;
+				if(-1 != pParser->toksuper) {
+					pTokens[pParser->toksuper].size++;
+				}
+				break;
+			case '\t': case '\r': case '\n': case ' ':
+				pParser->pos = (unsigned int) skipWhitespace(pJson, pParser->pos + 1, length) - 1;
+				break;
+			case ':':
+				pParser->toksuper = (int) pParser->toknext - 1;
+				break;
+			case ',':
+				if(-1 != pParser->toksuper && JSMN_ARRAY != pTokens[pParser->toksuper].type
+				   && JSMN_OBJECT != pTokens[pParser->toksuper].type) {
+					for(i = (int) pParser->toknext - 1; i >= 0; i--) {
+						if((JSMN_ARRAY == pTokens[i].type || JSMN_OBJECT == pTokens[i].type)
+						   && -1 != pTokens[i].start && -1 == pTokens[i].end) {
+							pParser->toksuper = i;
+							break;
+						}
+					}
+				}
+				break;
+			default:
+				rc = parsePrimitive(pParser, pJson, length, pTokens, maxTokens);
+				if(rc < 0) {
+					return rc;
+				}
+				count++;
+				if(-1 != pParser->toksuper) {
+					pTokens[pParser->toksuper].size++;
+				}
+				break;
+		}
+	}
+
+	/* Unmatched opened object or array */
+	for(i = (int) pParser->toknext - 1; i >= 0; i--) {
+		if(-1 != pTokens[i].start && -1 == pTokens[i].end) {
+			return JSMN_ERROR_PART;
+		}
+	}
+
+	return count;
+#endif
+}
+
+int aws_iot_json_parse(jsmn_parser *pParser, const char *pJson, size_t length, jsmntok_t *pTokens,
+					   unsigned int maxTokens) {
+#ifdef ENABLE_IOT_JSON_SIMD
+	return aws_iot_json_tokenize(pParser, pJson, length, pTokens, maxTokens);
+#else
+	return jsmn_parse(pParser, pJson, length, pTokens, maxTokens);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,10 +26,15 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_JSON
+
 #include "aws_iot_json_utils.h"
 
-#include <stdio.h>
+#include <float.h>
+#include <locale.h>
+#include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "aws_iot_log.h"
@@ -45,87 +50,384 @@ int8_t jsoneq(const char *json, jsmntok_t *tok, const char *s) {
 	return -1;
 }
 
+/* Exact powers of ten for the fast path, 10^22 is the largest that fits a double mantissa */
+static const double doublePowersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define JSON_NUMBER_MAX_DIGITS 19
+#define JSON_NUMBER_MAX_EXPONENT 100000
+#define JSON_NUMBER_FALLBACK_LEN 64
+
+/* Double mantissa bits dropped when rounding to float, and their pattern for a value halfway between two floats */
+#define DOUBLE_FLOAT_ROUNDING_MASK ((1ULL << 29) - 1)
+#define DOUBLE_FLOAT_TIE_BITS (1ULL << 28)
+
+typedef struct {
+	bool isNegative;
+	bool isTruncated;       ///< Significant digits beyond JSON_NUMBER_MAX_DIGITS were dropped
+	uint64_t mantissa;
+	int32_t exponent;       ///< Decimal exponent applied to mantissa
+} JsonDecimal_t;
+
+static bool _isDigit(char c) {
+	return (c >= '0' && c <= '9');
+}
+
+/* Splits a JSON number into mantissa and decimal exponent, the whole range must be consumed */
+static IoT_Error_t _parseDecimal(const char *pFirst, const char *pLast, JsonDecimal_t *pDecimal) {
+	const char *p = pFirst;
+	uint32_t significantDigits = 0;
+	int32_t explicitExponent = 0;
+	bool isExponentNegative = false;
+
+	pDecimal->isNegative = false;
+	pDecimal->isTruncated = false;
+	pDecimal->mantissa = 0;
+	pDecimal->exponent = 0;
+
+	if(p < pLast && '-' == *p) {
+		pDecimal->isNegative = true;
+		p++;
+	}
+	if(p == pLast || !_isDigit(*p)) {
+		return JSON_PARSE_ERROR;
+	}
+
+	for(; p < pLast && _isDigit(*p); p++) {
+		if(significantDigits < JSON_NUMBER_MAX_DIGITS) {
+			pDecimal->mantissa = pDecimal->mantissa * 10 + (uint64_t) (*p - '0');
+			if(0 != pDecimal->mantissa) {
+				significantDigits++;
+			}
+		} else {
+			pDecimal->exponent++;
+			pDecimal->isTruncated |= ('0' != *p);
+		}
+	}
+
+	if(p < pLast && '.' == *p) {
+		p++;
+		if(p == pLast || !_isDigit(*p)) {
+			return JSON_PARSE_ERROR;
+		}
+		for(; p < pLast && _isDigit(*p); p++) {
+			if(significantDigits < JSON_NUMBER_MAX_DIGITS) {
+				pDecimal->mantissa = pDecimal->mantissa * 10 + (uint64_t) (*p - '0');
+				pDecimal->exponent--;
+				if(0 != pDecimal->mantissa) {
+					significantDigits++;
+				}
+			} else {
+				pDecimal->isTruncated |= ('0' != *p);
+			}
+		}
+	}
+
+	if(p < pLast && ('e' == *p || 'E' == *p)) {
+		p++;
+		if(p < pLast && ('-' == *p || '+' == *p)) {
+			isExponentNegative = ('-' == *p);
+			p++;
+		}
+		if(p == pLast || !_isDigit(*p)) {
+			return JSON_PARSE_ERROR;
+		}
+		for(; p < pLast && _isDigit(*p); p++) {
+			if(explicitExponent < JSON_NUMBER_MAX_EXPONENT) {
+				explicitExponent = explicitExponent * 10 + (*p - '0');
+			}
+		}
+		pDecimal->exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+	}
+
+	return (p == pLast) ? SUCCESS : JSON_PARSE_ERROR;
+}
+
+/* Copies the number into a NUL terminated buffer using the decimal point of the current locale */
+static bool _copyForStrtod(char *pBuf, const char *pFirst, const char *pLast) {
+	size_t length = (size_t) (pLast - pFirst);
+	char decimalPoint = localeconv()->decimal_point[0];
+	size_t i;
+
+	if(length >= JSON_NUMBER_FALLBACK_LEN) {
+		return false;
+	}
+	for(i = 0; i < length; i++) {
+		pBuf[i] = ('.' == pFirst[i]) ? decimalPoint : pFirst[i];
+	}
+	pBuf[length] = '\0';
+	return true;
+}
+
+/* Exact when the mantissa and the power of ten are both representable, the single operation then rounds correctly */
+static bool _convertExactDecimal(const JsonDecimal_t *pDecimal, double *pValue) {
+#if FLT_EVAL_METHOD == 0
+	double value;
+
+	if(pDecimal->isTruncated || pDecimal->mantissa > (1ULL << 53) || pDecimal->exponent < -22
+	   || pDecimal->exponent > 22) {
+		return false;
+	}
+
+	value = (double) pDecimal->mantissa;
+	if(pDecimal->exponent < 0) {
+		value /= doublePowersOfTen[-pDecimal->exponent];
+	} else {
+		value *= doublePowersOfTen[pDecimal->exponent];
+	}
+	*pValue = pDecimal->isNegative ? -value : value;
+	return true;
+#else
+	/* Excess precision would round twice */
+	IOT_UNUSED(pDecimal);
+	IOT_UNUSED(pValue);
+	return false;
+#endif
+}
+
+IoT_Error_t parseUnsignedIntegerFromChars(const char *pFirst, const char *pLast, uint64_t maxValue,
+										  uint64_t *pValue) {
+	const char *p = pFirst;
+	uint64_t value = 0;
+	uint64_t digit;
+
+	if(NULL == pFirst || NULL == pLast || NULL == pValue || p >= pLast) {
+		return JSON_PARSE_ERROR;
+	}
+
+	for(; p < pLast && _isDigit(*p); p++) {
+		digit = (uint64_t) (*p - '0');
+		if(digit > maxValue || value > (maxValue - digit) / 10) {
+			IOT_WARN("Integer out of range.");
+			return JSON_PARSE_ERROR;
+		}
+		value = value * 10 + digit;
+	}
+
+	if(p == pFirst || p != pLast) {
+		return JSON_PARSE_ERROR;
+	}
+
+	*pValue = value;
+	return SUCCESS;
+}
+
+IoT_Error_t parseSignedIntegerFromChars(const char *pFirst, const char *pLast, int64_t minValue, int64_t maxValue,
+										int64_t *pValue) {
+	uint64_t magnitude;
+	IoT_Error_t rc;
+
+	if(NULL == pFirst || NULL == pLast || NULL == pValue || pFirst >= pLast) {
+		return JSON_PARSE_ERROR;
+	}
+
+	if('-' == *pFirst) {
+		/* The negative bound below only holds for a negative minimum */
+		if(minValue >= 0) {
+			IOT_WARN("Integer out of range.");
+			return JSON_PARSE_ERROR;
+		}
+		/* -(minValue + 1) + 1 avoids overflowing on INT64_MIN */
+		rc = parseUnsignedIntegerFromChars(pFirst + 1, pLast, (uint64_t) (-(minValue + 1)) + 1, &magnitude);
+		if(SUCCESS == rc) {
+			*pValue = (0 == magnitude) ? 0 : -(int64_t) (magnitude - 1) - 1;
+		}
+	} else {
+		if(maxValue < 0) {
+			IOT_WARN("Integer out of range.");
+			return JSON_PARSE_ERROR;
+		}
+		rc = parseUnsignedIntegerFromChars(pFirst, pLast, (uint64_t) maxValue, &magnitude);
+		if(SUCCESS == rc) {
+			*pValue = (int64_t) magnitude;
+		}
+	}
+
+	return rc;
+}
+
+IoT_Error_t parseDoubleFromChars(const char *pFirst, const char *pLast, double *pValue) {
+	JsonDecimal_t decimal;
+	char buf[JSON_NUMBER_FALLBACK_LEN];
+	char *pEnd;
+	double value;
+
+	if(NULL == pFirst || NULL == pLast || NULL == pValue || SUCCESS != _parseDecimal(pFirst, pLast, &decimal)) {
+		return JSON_PARSE_ERROR;
+	}
+
+	if(0 == decimal.mantissa) {
+		*pValue = decimal.isNegative ? -0.0 : 0.0;
+		return SUCCESS;
+	}
+
+	if(_convertExactDecimal(&decimal, &value)) {
+		*pValue = value;
+		return SUCCESS;
+	}
+
+	if(!_copyForStrtod(buf, pFirst, pLast)) {
+		return JSON_PARSE_ERROR;
+	}
+	value = strtod(buf, &pEnd);
+	if('\0' != *pEnd) {
+		return JSON_PARSE_ERROR;
+	}
+	if(isinf(value)) {
+		IOT_WARN("Double out of range.");
+		return JSON_PARSE_ERROR;
+	}
+
+	*pValue = value;
+	return SUCCESS;
+}
+
+IoT_Error_t parseFloatFromChars(const char *pFirst, const char *pLast, float *pValue) {
+	JsonDecimal_t decimal;
+	char buf[JSON_NUMBER_FALLBACK_LEN];
+	char *pEnd;
+	double exactValue;
+	uint64_t bits;
+	float value;
+
+	if(NULL == pFirst || NULL == pLast || NULL == pValue || SUCCESS != _parseDecimal(pFirst, pLast, &decimal)) {
+		return JSON_PARSE_ERROR;
+	}
+
+	if(0 == decimal.mantissa) {
+		*pValue = decimal.isNegative ? -0.0f : 0.0f;
+		return SUCCESS;
+	}
+
+	/* Rounding the exact double again to float is only wrong when it lands on a tie between two floats */
+	if(_convertExactDecimal(&decimal, &exactValue) && fabs(exactValue) >= FLT_MIN && fabs(exactValue) <= FLT_MAX) {
+		memcpy(&bits, &exactValue, sizeof(bits));
+		if(DOUBLE_FLOAT_TIE_BITS != (bits & DOUBLE_FLOAT_ROUNDING_MASK)) {
+			*pValue = (float) exactValue;
+			return SUCCESS;
+		}
+	}
+
+	if(!_copyForStrtod(buf, pFirst, pLast)) {
+		return JSON_PARSE_ERROR;
+	}
+	value = strtof(buf, &pEnd);
+	if('\0' != *pEnd) {
+		return JSON_PARSE_ERROR;
+	}
+	if(isinf(value)) {
+		IOT_WARN("Float out of range.");
+		return JSON_PARSE_ERROR;
+	}
+
+	*pValue = value;
+	return SUCCESS;
+}
+
 IoT_Error_t parseUnsignedInteger32Value(uint32_t *i, const char *jsonString, jsmntok_t *token) {
+	uint64_t value;
+
 	if(token->type != JSMN_PRIMITIVE) {
 		IOT_WARN("Token was not an integer");
 		return JSON_PARSE_ERROR;
 	}
 
-	if(('-' == (char) (jsonString[token->start])) || (1 != sscanf(jsonString + token->start, "%u", i))) {
+	if(SUCCESS != parseUnsignedIntegerFromChars(jsonString + token->start, jsonString + token->end, UINT32_MAX, &value)) {
 		IOT_WARN("Token was not an unsigned integer.");
 		return JSON_PARSE_ERROR;
 	}
 
+	*i = (uint32_t) value;
 	return SUCCESS;
 }
 
 IoT_Error_t parseUnsignedInteger16Value(uint16_t *i, const char *jsonString, jsmntok_t *token) {
+	uint64_t value;
+
 	if(token->type != JSMN_PRIMITIVE) {
 		IOT_WARN("Token was not an integer");
 		return JSON_PARSE_ERROR;
 	}
 
-	if(('-' == (char) (jsonString[token->start])) || (1 != sscanf(jsonString + token->start, "%hu", i))) {
+	if(SUCCESS != parseUnsignedIntegerFromChars(jsonString + token->start, jsonString + token->end, UINT16_MAX, &value)) {
 		IOT_WARN("Token was not an unsigned integer.");
 		return JSON_PARSE_ERROR;
 	}
 
+	*i = (uint16_t) value;
 	return SUCCESS;
 }
 
 IoT_Error_t parseUnsignedInteger8Value(uint8_t *i, const char *jsonString, jsmntok_t *token) {
+	uint64_t value;
+
 	if(token->type != JSMN_PRIMITIVE) {
 		IOT_WARN("Token was not an integer");
 		return JSON_PARSE_ERROR;
 	}
 
-	if(('-' == (char) (jsonString[token->start])) || (1 != sscanf(jsonString + token->start, "%hhu", i))) {
+	if(SUCCESS != parseUnsignedIntegerFromChars(jsonString + token->start, jsonString + token->end, UINT8_MAX, &value)) {
 		IOT_WARN("Token was not an unsigned integer.");
 		return JSON_PARSE_ERROR;
 	}
 
+	*i = (uint8_t) value;
 	return SUCCESS;
 }
 
 IoT_Error_t parseInteger32Value(int32_t *i, const char *jsonString, jsmntok_t *token) {
+	int64_t value;
+
 	if(token->type != JSMN_PRIMITIVE) {
 		IOT_WARN("Token was not an integer");
 		return JSON_PARSE_ERROR;
 	}
 
-	if(1 != sscanf(jsonString + token->start, "%i", i)) {
+	if(SUCCESS != parseSignedIntegerFromChars(jsonString + token->start, jsonString + token->end, INT32_MIN, INT32_MAX,
+											  &value)) {
 		IOT_WARN("Token was not an integer.");
 		return JSON_PARSE_ERROR;
 	}
 
+	*i = (int32_t) value;
 	return SUCCESS;
 }
 
 IoT_Error_t parseInteger16Value(int16_t *i, const char *jsonString, jsmntok_t *token) {
+	int64_t value;
+
 	if(token->type != JSMN_PRIMITIVE) {
 		IOT_WARN("Token was not an integer");
 		return JSON_PARSE_ERROR;
 	}
 
-	if(1 != sscanf(jsonString + token->start, "%hi", i)) {
+	if(SUCCESS != parseSignedIntegerFromChars(jsonString + token->start, jsonString + token->end, INT16_MIN, INT16_MAX,
+											  &value)) {
 		IOT_WARN("Token was not an integer.");
 		return JSON_PARSE_ERROR;
 	}
 
+	*i = (int16_t) value;
 	return SUCCESS;
 }
 
 IoT_Error_t parseInteger8Value(int8_t *i, const char *jsonString, jsmntok_t *token) {
+	int64_t value;
+
 	if(token->type != JSMN_PRIMITIVE) {
 		IOT_WARN("Token was not an integer");
 		return JSON_PARSE_ERROR;
 	}
 
-	if(1 != sscanf(jsonString + token->start, "%hhi", i)) {
+	if(SUCCESS != parseSignedIntegerFromChars(jsonString + token->start, jsonString + token->end, INT8_MIN, INT8_MAX,
+											  &value)) {
 		IOT_WARN("Token was not an integer.");
 		return JSON_PARSE_ERROR;
 	}
 
+	*i = (int8_t) value;
 	return SUCCESS;
 }
 
@@ -135,7 +437,7 @@ IoT_Error_t parseFloatValue(float *f, const char *jsonString, jsmntok_t *token)
 		return JSON_PARSE_ERROR;
 	}
 
-	if(1 != sscanf(jsonString + token->start, "%f", f)) {
+	if(SUCCESS != parseFloatFromChars(jsonString + token->start, jsonString + token->end, f)) {
 		IOT_WARN("Token was not a float.");
 		return JSON_PARSE_ERROR;
 	}
@@ -149,7 +451,7 @@ IoT_Error_t parseDoubleValue(double *d, const char *jsonString, jsmntok_t *token
 		return JSON_PARSE_ERROR;
 	}
 
-	if(1 != sscanf(jsonString + token->start, "%lf", d)) {
+	if(SUCCESS != parseDoubleFromChars(jsonString + token->start, jsonString + token->end, d)) {
 		IOT_WARN("Token was not a double.");
 		return JSON_PARSE_ERROR;
 	}
@@ -222,6 +524,50 @@ jsmntok_t *findToken(const char *key, const char *jsonString, jsmntok_t *token)
 	return NULL;
 }
 
+void buildJsonTape(const jsmntok_t *pTokens, int32_t tokenCount, jsonTapeEntry_t *pTape) {
+	int32_t i;
+	int32_t top = -1;
+
+	/* The open tokens form a stack linked through their parent entries. A token is
+	 * closed by the first token starting at or after its end, which is its next. A
+	 * member key ends before its value, so the value's parent is the object. */
+	for(i = 0; i < tokenCount; i++) {
+		while(top >= 0 && pTokens[top].end <= pTokens[i].start) {
+			pTape[top].next = i;
+			top = pTape[top].parent;
+		}
+		pTape[i].parent = top;
+		top = i;
+	}
+
+	while(top >= 0) {
+		pTape[top].next = tokenCount;
+		top = pTape[top].parent;
+	}
+}
+
+jsmntok_t *findTokenOnTape(const char *key, const char *jsonString, jsmntok_t *pTokens, const jsonTapeEntry_t *pTape,
+						   jsmntok_t *token) {
+	int32_t objectIndex, end, i;
+
+	if(token->type != JSMN_OBJECT) {
+		IOT_WARN("Token was not an object.");
+		return NULL;
+	}
+
+	objectIndex = (int32_t) (token - pTokens);
+	end = pTape[objectIndex].next;
+
+	/* Members are key and value pairs, the next key follows the value */
+	for(i = objectIndex + 1; i + 1 < end; i = pTape[i + 1].next) {
+		if(0 == jsoneq(jsonString, &pTokens[i], key)) {
+			return &pTokens[i + 1];
+		}
+	}
+
+	return NULL;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,530 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_json_writer.c
+ * @brief Single pass JSON writer with shortest round-trip number formatting
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_JSON
+
+#include "aws_iot_json_writer.h"
+
+#include <string.h>
+
+static const char digitPairs[201] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+void aws_iot_json_writer_init(IoT_Json_Writer_t *pWriter, char *pBuffer, size_t bufferSize, size_t offset) {
+	pWriter->pBuffer = pBuffer;
+	pWriter->bufferSize = (NULL == pBuffer) ? 0 : bufferSize;
+	pWriter->length = offset;
+	if(offset < pWriter->bufferSize) {
+		pWriter->pBuffer[offset] = '\0';
+	}
+}
+
+bool aws_iot_json_writer_is_truncated(const IoT_Json_Writer_t *pWriter) {
+	return pWriter->length >= pWriter->bufferSize;
+}
+
+void aws_iot_json_writer_raw(IoT_Json_Writer_t *pWriter, const char *pData, size_t dataLen) {
+	size_t available;
+
+	if(pWriter->length + 1 < pWriter->bufferSize) {
+		available = pWriter->bufferSize - pWriter->length - 1;
+		if(dataLen > available) {
+			memcpy(pWriter->pBuffer + pWriter->length, pData, available);
+			pWriter->pBuffer[pWriter->bufferSize - 1] = '\0';
+		} else {
+			memcpy(pWriter->pBuffer + pWriter->length, pData, dataLen);
+			pWriter->pBuffer[pWriter->length + dataLen] = '\0';
+		}
+	}
+	pWriter->length += dataLen;
+}
+
+void aws_iot_json_writer_raw_string(IoT_Json_Writer_t *pWriter, const char *pData) {
+	aws_iot_json_writer_raw(pWriter, pData, strlen(pData));
+}
+
+void aws_iot_json_writer_char(IoT_Json_Writer_t *pWriter, char c) {
+	if(pWriter->length + 1 < pWriter->bufferSize) {
+		pWriter->pBuffer[pWriter->length] = c;
+		pWriter->pBuffer[pWriter->length + 1] = '\0';
+	}
+	pWriter->length++;
+}
+
+void aws_iot_json_writer_string(IoT_Json_Writer_t *pWriter, const char *pString) {
+	static const char hexDigits[] = "0123456789abcdef";
+	const char *pRunStart = pString;
+	const char *p;
+	char escaped[6];
+	unsigned char c;
+
+	aws_iot_json_writer_char(pWriter, '"');
+	for(p = pString; '\0' != *p; p++) {
+		c = (unsigned char) *p;
+		if(c >= 0x20 && '"' != c && '\\' != c) {
+			continue;
+		}
+
+		/* Flush the run of characters that need no escaping */
+		aws_iot_json_writer_raw(pWriter, pRunStart, (size_t) (p - pRunStart));
+		pRunStart = p + 1;
+
+		escaped[0] = '\\';
+		switch(c) {
+			case '"':
+			case '\\':
+				escaped[1] = (char) c;
+				break;
+			case '\b':
+				escaped[1] = 'b';
+				break;
+			case '\f':
+				escaped[1] = 'f';
+				break;
+			case '\n':
+				escaped[1] = 'n';
+				break;
+			case '\r':
+				escaped[1] = 'r';
+				break;
+			case '\t':
+				escaped[1] = 't';
+				break;
+			default:
+				escaped[1] = 'u';
+				escaped[2] = '0';
+				escaped[3] = '0';
+				escaped[4] = hexDigits[c >> 4];
+				escaped[5] = hexDigits[c & 0xF];
+				aws_iot_json_writer_raw(pWriter, escaped, 6);
+				continue;
+		}
+		aws_iot_json_writer_raw(pWriter, escaped, 2);
+	}
+	aws_iot_json_writer_raw(pWriter, pRunStart, (size_t) (p - pRunStart));
+	aws_iot_json_writer_char(pWriter, '"');
+}
+
+void aws_iot_json_writer_key(IoT_Json_Writer_t *pWriter, const char *pKey) {
+	aws_iot_json_writer_string(pWriter, pKey);
+	aws_iot_json_writer_char(pWriter, ':');
+}
+
+size_t aws_iot_json_format_uint(uint64_t value, char *pBuf) {
+	char digits[20];
+	char *p = digits + sizeof(digits);
+	size_t length;
+	uint32_t pair;
+
+	while(value >= 100) {
+		pair = (uint32_t) (value % 100) * 2;
+		value /= 100;
+		*--p = digitPairs[pair + 1];
+		*--p = digitPairs[pair];
+	}
+	if(value >= 10) {
+		pair = (uint32_t) value * 2;
+		*--p = digitPairs[pair + 1];
+		*--p = digitPairs[pair];
+	} else {
+		*--p = (char) ('0' + value);
+	}
+
+	length = (size_t) (digits + sizeof(digits) - p);
+	memcpy(pBuf, p, length);
+	pBuf[length] = '\0';
+	return length;
+}
+
+void aws_iot_json_writer_uint(IoT_Json_Writer_t *pWriter, uint64_t value) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+
+	aws_iot_json_writer_raw(pWriter, buf, aws_iot_json_format_uint(value, buf));
+}
+
+void aws_iot_json_writer_int(IoT_Json_Writer_t *pWriter, int64_t value) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+	size_t length;
+
+	if(value < 0) {
+		buf[0] = '-';
+		/* Negate in unsigned arithmetic so INT64_MIN does not overflow */
+		length = 1 + aws_iot_json_format_uint(0 - (uint64_t) value, buf + 1);
+	} else {
+		length = aws_iot_json_format_uint((uint64_t) value, buf);
+	}
+	aws_iot_json_writer_raw(pWriter, buf, length);
+}
+
+void aws_iot_json_writer_bool(IoT_Json_Writer_t *pWriter, bool value) {
+	if(value) {
+		aws_iot_json_writer_raw(pWriter, "true", 4);
+	} else {
+		aws_iot_json_writer_raw(pWriter, "false", 5);
+	}
+}
+
+/*
+ * Grisu2, after "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+ * (Florian Loitsch, 2010). The value and its rounding boundaries are scaled by a cached
+ * power of ten into a 64-bit fixed point window where the digits are generated with
+ * integer arithmetic only.
+ */
+
+typedef struct {
+	uint64_t f;
+	int32_t e;
+} DiyFp_t;
+
+#define DIYFP_SIGNIFICAND_SIZE 64
+
+/* Normalized 10^k for k = -348, -340, ..., 340 */
+static const uint64_t cachedPowersF[] = {
+		0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+		0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+		0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+		0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+		0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+		0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+		0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+		0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+		0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+		0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+		0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+		0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+		0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+		0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+		0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+		0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+		0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+		0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+		0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+		0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+		0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+		0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t cachedPowersE[] = {
+		-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+		-901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+		-582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+		-263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+		56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+		375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+		694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+		1013, 1039, 1066,
+};
+
+static const uint64_t powersOfTen[] = {
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+		10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+		1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+		10000000000000000000ULL
+};
+
+static DiyFp_t _diyFpMultiply(DiyFp_t x, DiyFp_t y) {
+	const uint64_t mask32 = 0xFFFFFFFFULL;
+	uint64_t a = x.f >> 32, b = x.f & mask32, c = y.f >> 32, d = y.f & mask32;
+	uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+	uint64_t middle = (bd >> 32) + (ad & mask32) + (bc & mask32);
+	DiyFp_t result;
+
+	middle += 1ULL << 31; /* round */
+	result.f = ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+	result.e = x.e + y.e + DIYFP_SIGNIFICAND_SIZE;
+	return result;
+}
+
+static DiyFp_t _diyFpNormalize(DiyFp_t x) {
+	while(0 == (x.f & (1ULL << 63))) {
+		x.f <<= 1;
+		x.e--;
+	}
+	return x;
+}
+
+/*
+ * Splits a binary floating point number with a significandBits wide significand (hidden bit
+ * excluded) into the normalized value and the normalized boundaries halfway to its neighbours.
+ */
+static void _diyFpBoundaries(uint64_t significand, int32_t biasedExponent, uint32_t significandBits,
+							 int32_t exponentBias, DiyFp_t *pValue, DiyFp_t *pMinus, DiyFp_t *pPlus) {
+	uint64_t hiddenBit = 1ULL << significandBits;
+	DiyFp_t v;
+
+	if(0 != biasedExponent) {
+		v.f = significand | hiddenBit;
+		v.e = biasedExponent - exponentBias - (int32_t) significandBits;
+	} else {
+		v.f = significand;
+		v.e = 1 - exponentBias - (int32_t) significandBits;
+	}
+
+	pPlus->f = (v.f << 1) + 1;
+	pPlus->e = v.e - 1;
+	*pPlus = _diyFpNormalize(*pPlus);
+
+	/* The gap below a power of two is half as wide */
+	if(v.f == hiddenBit && biasedExponent > 1) {
+		pMinus->f = (v.f << 2) - 1;
+		pMinus->e = v.e - 2;
+	} else {
+		pMinus->f = (v.f << 1) - 1;
+		pMinus->e = v.e - 1;
+	}
+	pMinus->f <<= pMinus->e - pPlus->e;
+	pMinus->e = pPlus->e;
+
+	*pValue = _diyFpNormalize(v);
+}
+
+static DiyFp_t _cachedPower(int32_t e, int32_t *pK) {
+	/* Smallest k with 10^k * 2^e in the [alpha, gamma] = [-60, -32] window, 0.30103 ~ log10(2) */
+	double dk = (-61 - e) * 0.30102999566398114 + 347;
+	int32_t k = (int32_t) dk;
+	uint32_t index;
+	DiyFp_t power;
+
+	if(dk - k > 0.0) {
+		k++;
+	}
+	index = (uint32_t) ((k >> 3) + 1);
+	*pK = -(-348 + (int32_t) (index << 3));
+
+	power.f = cachedPowersF[index];
+	power.e = cachedPowersE[index];
+	return power;
+}
+
+static void _grisuRound(char *pDigits, uint32_t length, uint64_t delta, uint64_t rest, uint64_t tenKappa,
+						uint64_t distance) {
+	/* Move the last digit down while that brings the number closer to the exact value */
+	while(rest < distance && delta - rest >= tenKappa
+		  && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+		pDigits[length - 1]--;
+		rest += tenKappa;
+	}
+}
+
+static uint32_t _countDigits(uint32_t n) {
+	uint32_t digits = 1;
+
+	while(n >= 10 && digits < 10) {
+		n /= 10;
+		digits++;
+	}
+	return digits;
+}
+
+static uint32_t _grisuDigitGen(DiyFp_t w, DiyFp_t mp, uint64_t delta, char *pDigits, int32_t *pK) {
+	DiyFp_t one;
+	uint64_t distance = mp.f - w.f;
+	uint64_t p2, rest;
+	uint32_t p1, kappa, length = 0, digit;
+	int32_t index;
+
+	one.f = 1ULL << -mp.e;
+	one.e = mp.e;
+	p1 = (uint32_t) (mp.f >> -one.e);
+	p2 = mp.f & (one.f - 1);
+	kappa = _countDigits(p1);
+
+	while(kappa > 0) {
+		digit = p1 / (uint32_t) powersOfTen[kappa - 1];
+		p1 %= (uint32_t) powersOfTen[kappa - 1];
+		if(0 != digit || 0 != length) {
+			pDigits[length++] = (char) ('0' + digit);
+		}
+		kappa--;
+		rest = ((uint64_t) p1 << -one.e) + p2;
+		if(rest <= delta) {
+			*pK += (int32_t) kappa;
+			_grisuRound(pDigits, length, delta, rest, powersOfTen[kappa] << -one.e, distance);
+			return length;
+		}
+	}
+
+	for(;;) {
+		p2 *= 10;
+		delta *= 10;
+		digit = (uint32_t) (p2 >> -one.e);
+		if(0 != digit || 0 != length) {
+			pDigits[length++] = (char) ('0' + digit);
+		}
+		p2 &= one.f - 1;
+		kappa++;
+		if(p2 < delta) {
+			index = (int32_t) kappa;
+			*pK -= index;
+			_grisuRound(pDigits, length, delta, p2, one.f, (index < 20) ? distance * powersOfTen[index] : 0);
+			return length;
+		}
+	}
+}
+
+static uint32_t _grisu2(DiyFp_t v, DiyFp_t minus, DiyFp_t plus, char *pDigits, int32_t *pK) {
+	DiyFp_t power = _cachedPower(plus.e, pK);
+	DiyFp_t w = _diyFpMultiply(v, power);
+	DiyFp_t wPlus = _diyFpMultiply(plus, power);
+	DiyFp_t wMinus = _diyFpMultiply(minus, power);
+
+	/* Stay strictly inside the boundaries to absorb the multiplication error */
+	wMinus.f++;
+	wPlus.f--;
+	return _grisuDigitGen(w, wPlus, wPlus.f - wMinus.f, pDigits, pK);
+}
+
+/* Lays out digits * 10^k as a JSON number */
+static size_t _formatDecimal(char *pBuf, const char *pDigits, uint32_t length, int32_t k) {
+	int32_t pointPosition = (int32_t) length + k; /* 10^(pointPosition - 1) <= value < 10^pointPosition */
+	char *p = pBuf;
+	int32_t exponent;
+	size_t exponentLength;
+
+	if(k >= 0 && pointPosition <= 21) {
+		/* 1234e7 -> 12340000000.0 */
+		memcpy(p, pDigits, length);
+		p += length;
+		memset(p, '0', (size_t) k);
+		p += k;
+		*p++ = '.';
+		*p++ = '0';
+	} else if(pointPosition > 0 && pointPosition <= 21) {
+		/* 1234e-2 -> 12.34 */
+		memcpy(p, pDigits, (size_t) pointPosition);
+		p += pointPosition;
+		*p++ = '.';
+		memcpy(p, pDigits + pointPosition, length - (size_t) pointPosition);
+		p += length - (size_t) pointPosition;
+	} else if(pointPosition > -6 && pointPosition <= 0) {
+		/* 1234e-6 -> 0.001234 */
+		*p++ = '0';
+		*p++ = '.';
+		memset(p, '0', (size_t) -pointPosition);
+		p += -pointPosition;
+		memcpy(p, pDigits, length);
+		p += length;
+	} else {
+		/* 1234e30 -> 1.234e33 */
+		*p++ = pDigits[0];
+		if(length > 1) {
+			*p++ = '.';
+			memcpy(p, pDigits + 1, length - 1);
+			p += length - 1;
+		}
+		*p++ = 'e';
+		exponent = pointPosition - 1;
+		if(exponent < 0) {
+			*p++ = '-';
+			exponent = -exponent;
+		}
+		exponentLength = aws_iot_json_format_uint((uint64_t) exponent, p);
+		p += exponentLength;
+	}
+
+	*p = '\0';
+	return (size_t) (p - pBuf);
+}
+
+static size_t _formatSpecial(char *pBuf, bool isNegative, bool isZero) {
+	char *p = pBuf;
+
+	if(!isZero) {
+		/* NaN and infinity have no JSON representation */
+		memcpy(pBuf, "null", 5);
+		return 4;
+	}
+	if(isNegative) {
+		*p++ = '-';
+	}
+	memcpy(p, "0.0", 4);
+	return (size_t) (p - pBuf) + 3;
+}
+
+size_t aws_iot_json_format_double(double value, char *pBuf) {
+	char digits[20];
+	DiyFp_t v, minus, plus;
+	uint64_t bits, significand;
+	int32_t biasedExponent, k = 0;
+	uint32_t length;
+	size_t signLength = 0;
+
+	memcpy(&bits, &value, sizeof(bits));
+	significand = bits & ((1ULL << 52) - 1);
+	biasedExponent = (int32_t) ((bits >> 52) & 0x7FF);
+
+	if(0x7FF == biasedExponent || (0 == biasedExponent && 0 == significand)) {
+		return _formatSpecial(pBuf, 0 != (bits >> 63), 0x7FF != biasedExponent);
+	}
+	if(0 != (bits >> 63)) {
+		pBuf[signLength++] = '-';
+	}
+
+	_diyFpBoundaries(significand, biasedExponent, 52, 1023, &v, &minus, &plus);
+	length = _grisu2(v, minus, plus, digits, &k);
+	return signLength + _formatDecimal(pBuf + signLength, digits, length, k);
+}
+
+size_t aws_iot_json_format_float(float value, char *pBuf) {
+	char digits[20];
+	DiyFp_t v, minus, plus;
+	uint32_t bits, significand;
+	int32_t biasedExponent, k = 0;
+	uint32_t length;
+	size_t signLength = 0;
+
+	memcpy(&bits, &value, sizeof(bits));
+	significand = bits & ((1UL << 23) - 1);
+	biasedExponent = (int32_t) ((bits >> 23) & 0xFF);
+
+	if(0xFF == biasedExponent || (0 == biasedExponent && 0 == significand)) {
+		return _formatSpecial(pBuf, 0 != (bits >> 31), 0xFF != biasedExponent);
+	}
+	if(0 != (bits >> 31)) {
+		pBuf[signLength++] = '-';
+	}
+
+	/* Same algorithm with the boundaries of the float, the digits stop as soon as the float is identified */
+	_diyFpBoundaries(significand, biasedExponent, 23, 127, &v, &minus, &plus);
+	length = _grisu2(v, minus, plus, digits, &k);
+	return signLength + _formatDecimal(pBuf + signLength, digits, length, k);
+}
+
+void aws_iot_json_writer_double(IoT_Json_Writer_t *pWriter, double value) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+
+	aws_iot_json_writer_raw(pWriter, buf, aws_iot_json_format_double(value, buf));
+}
+
+void aws_iot_json_writer_float(IoT_Json_Writer_t *pWriter, float value) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+
+	aws_iot_json_writer_raw(pWriter, buf, aws_iot_json_format_float(value, buf));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,617 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_log_async.c
+ * @brief Asynchronous ring-buffer logging backend
+ *
+ * The ring is a bounded multi-producer queue in the style of D. Vyukov: every cell carries a
+ * sequence number that tells producers whether the cell is free for their ticket and tells the
+ * consumer whether the cell has been published. Producers claim a ticket with a compare-and-swap
+ * on the enqueue position, so no lock is taken on the logging path.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ENABLE_IOT_LOG_ASYNC
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "aws_iot_log_async.h"
+
+#if (AWS_IOT_LOG_ASYNC_RING_SIZE & (AWS_IOT_LOG_ASYNC_RING_SIZE - 1)) != 0
+#error "AWS_IOT_LOG_ASYNC_RING_SIZE must be a power of two"
+#endif
+
+#define LOG_RING_MASK ((uint32_t) (AWS_IOT_LOG_ASYNC_RING_SIZE - 1))
+
+typedef enum {
+	LOG_LENGTH_NONE,
+	LOG_LENGTH_HH,
+	LOG_LENGTH_H,
+	LOG_LENGTH_L,
+	LOG_LENGTH_LL,
+	LOG_LENGTH_J,
+	LOG_LENGTH_Z,
+	LOG_LENGTH_T,
+	LOG_LENGTH_LONG_DOUBLE
+} LogLengthModifier_t;
+
+typedef enum {
+	LOG_ARG_SIGNED,
+	LOG_ARG_UNSIGNED,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_STRING,
+	LOG_ARG_POINTER,
+	LOG_ARG_UNSUPPORTED
+} LogArgClass_t;
+
+/* One parsed conversion specification of a format string */
+typedef struct {
+	const char *pStart;     /* the '%' */
+	const char *pModifier;  /* first character after flags, width and precision */
+	const char *pEnd;       /* one past the conversion character */
+	uint8_t stars;          /* '*' width/precision arguments */
+	bool isPrecisionStar;   /* the last '*' argument is the precision */
+	int32_t precision;      /* literal precision or -1 */
+	LogLengthModifier_t length;
+	LogArgClass_t argClass;
+} LogSpec_t;
+
+typedef union {
+	long long i;
+	unsigned long long u;
+	double d;
+	const void *p;
+} LogArg_t;
+
+typedef struct {
+	/* Cell sequence minus cell index, so a zero filled ring is ready to use */
+	uint32_t sequence;
+	uint8_t level;
+	uint8_t module;
+	uint8_t argCount;
+	uint16_t line;
+	uint16_t stringsUsed;
+	const char *pFunction;
+	const char *pFormat;
+	LogArg_t args[AWS_IOT_LOG_ASYNC_MAX_ARGS];
+	char strings[AWS_IOT_LOG_ASYNC_STRING_BYTES];
+} LogRecord_t;
+
+volatile uint8_t aws_iot_log_async_module_level[IOT_LOG_MODULE_COUNT];
+
+static LogRecord_t logRing[AWS_IOT_LOG_ASYNC_RING_SIZE];
+static uint32_t logEnqueuePos;
+static uint32_t logDequeuePos;
+static uint8_t logDrainInProgress;
+static uint32_t logDroppedCount;
+
+static IoT_Log_Sink_t logSink;
+static void *pLogSinkContext;
+
+static void _aws_iot_log_async_stdout_sink(void *pContext, IoT_Log_Level_t level, const char *pLine, size_t lineLen) {
+	IOT_UNUSED(pContext);
+	IOT_UNUSED(level);
+	fwrite(pLine, 1, lineLen, stdout);
+	fputc('\n', stdout);
+}
+
+static const char *_aws_iot_log_async_parse_spec(const char *pFormat, LogSpec_t *pSpec) {
+	const char *p = pFormat + 1;
+
+	pSpec->pStart = pFormat;
+	pSpec->stars = 0;
+	pSpec->isPrecisionStar = false;
+	pSpec->precision = -1;
+	pSpec->length = LOG_LENGTH_NONE;
+
+	while('-' == *p || '+' == *p || ' ' == *p || '#' == *p || '0' == *p || '\'' == *p) {
+		p++;
+	}
+	if('*' == *p) {
+		pSpec->stars++;
+		p++;
+	} else {
+		while(*p >= '0' && *p <= '9') {
+			p++;
+		}
+	}
+	if('.' == *p) {
+		p++;
+		if('*' == *p) {
+			pSpec->stars++;
+			pSpec->isPrecisionStar = true;
+			p++;
+		} else {
+			pSpec->precision = 0;
+			while(*p >= '0' && *p <= '9') {
+				pSpec->precision = (pSpec->precision * 10) + (*p - '0');
+				p++;
+			}
+		}
+	}
+
+	pSpec->pModifier = p;
+	switch(*p) {
+		case 'h':
+			p++;
+			pSpec->length = LOG_LENGTH_H;
+			if('h' == *p) {
+				p++;
+				pSpec->length = LOG_LENGTH_HH;
+			}
+			break;
+		case 'l':
+			p++;
+			pSpec->length = LOG_LENGTH_L;
+			if('l' == *p) {
+				p++;
+				pSpec->length = LOG_LENGTH_LL;
+			}
+			break;
+		case 'q':
+			p++;
+			pSpec->length = LOG_LENGTH_LL;
+			break;
+		case 'j':
+			p++;
+			pSpec->length = LOG_LENGTH_J;
+			break;
+		case 'z':
+			p++;
+			pSpec->length = LOG_LENGTH_Z;
+			break;
+		case 't':
+			p++;
+			pSpec->length = LOG_LENGTH_T;
+			break;
+		case 'L':
+			p++;
+			pSpec->length = LOG_LENGTH_LONG_DOUBLE;
+			break;
+		default:
+			break;
+	}
+
+	switch(*p) {
+		case 'd':
+		case 'i':
+			pSpec->argClass = LOG_ARG_SIGNED;
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			pSpec->argClass = LOG_ARG_UNSIGNED;
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			pSpec->argClass = LOG_ARG_DOUBLE;
+			break;
+		case 's':
+			/* Wide strings are not captured */
+			pSpec->argClass = (LOG_LENGTH_NONE == pSpec->length) ? LOG_ARG_STRING : LOG_ARG_UNSUPPORTED;
+			break;
+		case 'p':
+			pSpec->argClass = LOG_ARG_POINTER;
+			break;
+		default:
+			/* %n, unknown conversions and a truncated specification end the capture */
+			pSpec->argClass = LOG_ARG_UNSUPPORTED;
+			break;
+	}
+
+	if('\0' != *p) {
+		p++;
+	}
+	pSpec->pEnd = p;
+
+	return p;
+}
+
+static void _aws_iot_log_async_capture_string(LogRecord_t *pRecord, LogArg_t *pArg, const char *pString,
+											  int32_t precision) {
+	size_t available = sizeof(pRecord->strings) - pRecord->stringsUsed;
+	size_t len = 0;
+
+	if(NULL == pString) {
+		pString = "(null)";
+	}
+	if(0 == available) {
+		/* Point at the terminating NUL of the previous string */
+		pArg->u = pRecord->stringsUsed - 1;
+		return;
+	}
+
+	available--;
+	if(precision >= 0 && (size_t) precision < available) {
+		available = (size_t) precision;
+	}
+	while(len < available && '\0' != pString[len]) {
+		len++;
+	}
+
+	pArg->u = pRecord->stringsUsed;
+	memcpy(&pRecord->strings[pRecord->stringsUsed], pString, len);
+	pRecord->strings[pRecord->stringsUsed + len] = '\0';
+	pRecord->stringsUsed = (uint16_t) (pRecord->stringsUsed + len + 1);
+}
+
+static void _aws_iot_log_async_capture_args(LogRecord_t *pRecord, const char *pFormat, va_list args) {
+	LogSpec_t spec;
+	const char *p = pFormat;
+	int32_t precision;
+	uint8_t i;
+
+	pRecord->argCount = 0;
+	pRecord->stringsUsed = 0;
+
+	while('\0' != *p) {
+		if('%' != *p) {
+			p++;
+			continue;
+		}
+		if('%' == p[1]) {
+			p += 2;
+			continue;
+		}
+
+		p = _aws_iot_log_async_parse_spec(p, &spec);
+		if(LOG_ARG_UNSUPPORTED == spec.argClass
+		   || (uint32_t) (spec.stars + 1) > (uint32_t) (AWS_IOT_LOG_ASYNC_MAX_ARGS - pRecord->argCount)) {
+			return;
+		}
+
+		precision = spec.precision;
+		for(i = 0; i < spec.stars; i++) {
+			pRecord->args[pRecord->argCount].i = va_arg(args, int);
+			if(spec.isPrecisionStar && i + 1 == spec.stars && pRecord->args[pRecord->argCount].i >= 0) {
+				precision = (int32_t) pRecord->args[pRecord->argCount].i;
+			}
+			pRecord->argCount++;
+		}
+
+		switch(spec.argClass) {
+			case LOG_ARG_SIGNED:
+				switch(spec.length) {
+					case LOG_LENGTH_HH:
+						pRecord->args[pRecord->argCount].i = (signed char) va_arg(args, int);
+						break;
+					case LOG_LENGTH_H:
+						pRecord->args[pRecord->argCount].i = (short) va_arg(args, int);
+						break;
+					case LOG_LENGTH_L:
+						pRecord->args[pRecord->argCount].i = va_arg(args, long);
+						break;
+					case LOG_LENGTH_LL:
+						pRecord->args[pRecord->argCount].i = va_arg(args, long long);
+						break;
+					case LOG_LENGTH_J:
+						pRecord->args[pRecord->argCount].i = (long long) va_arg(args, intmax_t);
+						break;
+					case LOG_LENGTH_Z:
+						pRecord->args[pRecord->argCount].i = (long long) va_arg(args, size_t);
+						break;
+					case LOG_LENGTH_T:
+						pRecord->args[pRecord->argCount].i = (long long) va_arg(args, ptrdiff_t);
+						break;
+					default:
+						pRecord->args[pRecord->argCount].i = va_arg(args, int);
+						break;
+				}
+				break;
+			case LOG_ARG_UNSIGNED:
+				switch(spec.length) {
+					case LOG_LENGTH_HH:
+						pRecord->args[pRecord->argCount].u = (unsigned char) va_arg(args, unsigned int);
+						break;
+					case LOG_LENGTH_H:
+						pRecord->args[pRecord->argCount].u = (unsigned short) va_arg(args, unsigned int);
+						break;
+					case LOG_LENGTH_L:
+						pRecord->args[pRecord->argCount].u = va_arg(args, unsigned long);
+						break;
+					case LOG_LENGTH_LL:
+						pRecord->args[pRecord->argCount].u = va_arg(args, unsigned long long);
+						break;
+					case LOG_LENGTH_J:
+						pRecord->args[pRecord->argCount].u = (unsigned long long) va_arg(args, uintmax_t);
+						break;
+					case LOG_LENGTH_Z:
+						pRecord->args[pRecord->argCount].u = va_arg(args, size_t);
+						break;
+					case LOG_LENGTH_T:
+						pRecord->args[pRecord->argCount].u = (unsigned long long) va_arg(args, ptrdiff_t);
+						break;
+					default:
+						pRecord->args[pRecord->argCount].u = va_arg(args, unsigned int);
+						break;
+				}
+				break;
+			case LOG_ARG_DOUBLE:
+				if(LOG_LENGTH_LONG_DOUBLE == spec.length) {
+					pRecord->args[pRecord->argCount].d = (double) va_arg(args, long double);
+				} else {
+					pRecord->args[pRecord->argCount].d = va_arg(args, double);
+				}
+				break;
+			case LOG_ARG_STRING:
+				_aws_iot_log_async_capture_string(pRecord, &pRecord->args[pRecord->argCount],
+												  va_arg(args, const char *), precision);
+				break;
+			default:
+				pRecord->args[pRecord->argCount].p = va_arg(args, void *);
+				break;
+		}
+		pRecord->argCount++;
+	}
+}
+
+IoT_Error_t aws_iot_log_async_write(IoT_Log_Level_t level, IoT_Log_Module_t module, const char *pFunction,
+									uint16_t line, const char *pFormat, ...) {
+	LogRecord_t *pRecord;
+	uint32_t pos, sequence;
+	int32_t diff;
+	va_list args;
+
+	if(NULL == pFormat || (uint32_t) module >= IOT_LOG_MODULE_COUNT) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pos = __atomic_load_n(&logEnqueuePos, __ATOMIC_RELAXED);
+	for(;;) {
+		pRecord = &logRing[pos & LOG_RING_MASK];
+		sequence = __atomic_load_n(&pRecord->sequence, __ATOMIC_ACQUIRE) + (pos & LOG_RING_MASK);
+		diff = (int32_t) (sequence - pos);
+		if(0 == diff) {
+			if(__atomic_compare_exchange_n(&logEnqueuePos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if(diff < 0) {
+			/* Ring is full, never block the caller */
+			__atomic_fetch_add(&logDroppedCount, 1, __ATOMIC_RELAXED);
+			return FAILURE;
+		} else {
+			pos = __atomic_load_n(&logEnqueuePos, __ATOMIC_RELAXED);
+		}
+	}
+
+	pRecord->level = (uint8_t) level;
+	pRecord->module = (uint8_t) module;
+	pRecord->line = line;
+	pRecord->pFunction = pFunction;
+	pRecord->pFormat = pFormat;
+
+	va_start(args, pFormat);
+	_aws_iot_log_async_capture_args(pRecord, pFormat, args);
+	va_end(args);
+
+	__atomic_store_n(&pRecord->sequence, pos + 1 - (pos & LOG_RING_MASK), __ATOMIC_RELEASE);
+
+	return SUCCESS;
+}
+
+static size_t _aws_iot_log_async_append(char *pLine, size_t used, const char *pText, size_t len) {
+	size_t available = AWS_IOT_LOG_ASYNC_LINE_LEN - 1 - used;
+
+	if(len > available) {
+		len = available;
+	}
+	memcpy(pLine + used, pText, len);
+	return used + len;
+}
+
+static size_t _aws_iot_log_async_clamp(size_t used, int written) {
+	if(written < 0) {
+		return used;
+	}
+	if(used + (size_t) written > AWS_IOT_LOG_ASYNC_LINE_LEN - 1) {
+		return AWS_IOT_LOG_ASYNC_LINE_LEN - 1;
+	}
+	return used + (size_t) written;
+}
+
+#define LOG_FORMAT_ONE(pLine, used, spec, stars, pStarArgs, value) \
+	(0 == (stars) ? snprintf((pLine) + (used), AWS_IOT_LOG_ASYNC_LINE_LEN - (used), (spec), value) : \
+	 (1 == (stars) ? snprintf((pLine) + (used), AWS_IOT_LOG_ASYNC_LINE_LEN - (used), (spec), \
+							  (int) (pStarArgs)[0].i, value) : \
+	  snprintf((pLine) + (used), AWS_IOT_LOG_ASYNC_LINE_LEN - (used), (spec), \
+			   (int) (pStarArgs)[0].i, (int) (pStarArgs)[1].i, value)))
+
+static size_t _aws_iot_log_async_format_record(const LogRecord_t *pRecord, char *pLine) {
+	const char *p = pRecord->pFormat;
+	const char *pLiteral;
+	const LogArg_t *pArg = pRecord->args;
+	const LogArg_t *pArgEnd = pRecord->args + pRecord->argCount;
+	char spec[32];
+	size_t specLen, used = 0;
+	LogSpec_t parsed;
+	int written = 0;
+
+	switch(pRecord->level) {
+		case IOT_LOG_LEVEL_DEBUG:
+			written = snprintf(pLine, AWS_IOT_LOG_ASYNC_LINE_LEN, "DEBUG:   %s L#%d ",
+							   pRecord->pFunction, (int) pRecord->line);
+			break;
+		case IOT_LOG_LEVEL_WARN:
+			written = snprintf(pLine, AWS_IOT_LOG_ASYNC_LINE_LEN, "WARN:  %s L#%d ",
+							   pRecord->pFunction, (int) pRecord->line);
+			break;
+		case IOT_LOG_LEVEL_ERROR:
+			written = snprintf(pLine, AWS_IOT_LOG_ASYNC_LINE_LEN, "ERROR: %s L#%d ",
+							   pRecord->pFunction, (int) pRecord->line);
+			break;
+		default:
+			break;
+	}
+	if(NULL == pRecord->pFunction) {
+		written = 0;
+	}
+	used = _aws_iot_log_async_clamp(0, written);
+
+	while('\0' != *p && used < AWS_IOT_LOG_ASYNC_LINE_LEN - 1) {
+		pLiteral = p;
+		while('\0' != *p && '%' != *p) {
+			p++;
+		}
+		used = _aws_iot_log_async_append(pLine, used, pLiteral, (size_t) (p - pLiteral));
+		if('\0' == *p) {
+			break;
+		}
+		if('%' == p[1]) {
+			used = _aws_iot_log_async_append(pLine, used, "%", 1);
+			p += 2;
+			continue;
+		}
+
+		pLiteral = p;
+		p = _aws_iot_log_async_parse_spec(p, &parsed);
+		specLen = (size_t) (parsed.pModifier - parsed.pStart);
+		if(LOG_ARG_UNSUPPORTED == parsed.argClass || (pArgEnd - pArg) < (parsed.stars + 1)
+		   || specLen + 4 > sizeof(spec)) {
+			/* Not captured, emit the rest of the format string as is */
+			used = _aws_iot_log_async_append(pLine, used, pLiteral, strlen(pLiteral));
+			break;
+		}
+
+		/* Integers are widened to long long at capture time, rebuild the specification to match */
+		memcpy(spec, parsed.pStart, specLen);
+		if(LOG_ARG_SIGNED == parsed.argClass || (LOG_ARG_UNSIGNED == parsed.argClass && 'c' != parsed.pEnd[-1])) {
+			spec[specLen++] = 'l';
+			spec[specLen++] = 'l';
+		}
+		spec[specLen++] = parsed.pEnd[-1];
+		spec[specLen] = '\0';
+
+		switch(parsed.argClass) {
+			case LOG_ARG_SIGNED:
+				written = LOG_FORMAT_ONE(pLine, used, spec, parsed.stars, pArg, pArg[parsed.stars].i);
+				break;
+			case LOG_ARG_UNSIGNED:
+				if('c' == parsed.pEnd[-1]) {
+					written = LOG_FORMAT_ONE(pLine, used, spec, parsed.stars, pArg, (int) pArg[parsed.stars].u);
+				} else {
+					written = LOG_FORMAT_ONE(pLine, used, spec, parsed.stars, pArg, pArg[parsed.stars].u);
+				}
+				break;
+			case LOG_ARG_DOUBLE:
+				written = LOG_FORMAT_ONE(pLine, used, spec, parsed.stars, pArg, pArg[parsed.stars].d);
+				break;
+			case LOG_ARG_STRING:
+				written = LOG_FORMAT_ONE(pLine, used, spec, parsed.stars, pArg,
+										 &pRecord->strings[pArg[parsed.stars].u]);
+				break;
+			default:
+				written = LOG_FORMAT_ONE(pLine, used, spec, parsed.stars, pArg, pArg[parsed.stars].p);
+				break;
+		}
+		used = _aws_iot_log_async_clamp(used, written);
+		pArg += parsed.stars + 1;
+	}
+
+	pLine[used] = '\0';
+	return used;
+}
+
+size_t aws_iot_log_async_flush(void) {
+	char line[AWS_IOT_LOG_ASYNC_LINE_LEN];
+	IoT_Log_Sink_t sink;
+	LogRecord_t *pRecord;
+	uint32_t pos, sequence;
+	size_t lineLen, count = 0;
+
+	/* Single consumer, a concurrent flush simply leaves the work to the thread already draining */
+	if(0 != __atomic_exchange_n(&logDrainInProgress, 1, __ATOMIC_ACQUIRE)) {
+		return 0;
+	}
+
+	sink = (NULL != logSink) ? logSink : _aws_iot_log_async_stdout_sink;
+	pos = logDequeuePos;
+	for(;;) {
+		pRecord = &logRing[pos & LOG_RING_MASK];
+		sequence = __atomic_load_n(&pRecord->sequence, __ATOMIC_ACQUIRE) + (pos & LOG_RING_MASK);
+		if(sequence != pos + 1) {
+			break;
+		}
+
+		lineLen = _aws_iot_log_async_format_record(pRecord, line);
+		sink(pLogSinkContext, (IoT_Log_Level_t) pRecord->level, line, lineLen);
+		count++;
+
+		__atomic_store_n(&pRecord->sequence, pos + AWS_IOT_LOG_ASYNC_RING_SIZE - (pos & LOG_RING_MASK),
+						 __ATOMIC_RELEASE);
+		pos++;
+	}
+	logDequeuePos = pos;
+
+	__atomic_store_n(&logDrainInProgress, 0, __ATOMIC_RELEASE);
+
+	return count;
+}
+
+void aws_iot_log_async_set_sink(IoT_Log_Sink_t sink, void *pContext) {
+	pLogSinkContext = pContext;
+	logSink = sink;
+}
+
+IoT_Error_t aws_iot_log_async_set_level(IoT_Log_Module_t module, IoT_Log_Level_t level) {
+	if((uint32_t) module >= IOT_LOG_MODULE_COUNT) {
+		return NULL_VALUE_ERROR;
+	}
+	aws_iot_log_async_module_level[module] = (uint8_t) level;
+	return SUCCESS;
+}
+
+void aws_iot_log_async_set_level_all(IoT_Log_Level_t level) {
+	uint8_t i;
+
+	for(i = 0; i < IOT_LOG_MODULE_COUNT; i++) {
+		aws_iot_log_async_module_level[i] = (uint8_t) level;
+	}
+}
+
+IoT_Log_Level_t aws_iot_log_async_get_level(IoT_Log_Module_t module) {
+	if((uint32_t) module >= IOT_LOG_MODULE_COUNT) {
+		return IOT_LOG_LEVEL_NONE;
+	}
+	return (IoT_Log_Level_t) aws_iot_log_async_module_level[module];
+}
+
+uint32_t aws_iot_log_async_get_dropped_count(void) {
+	return __atomic_load_n(&logDroppedCount, __ATOMIC_RELAXED);
+}
+
+void aws_iot_log_async_reset_dropped_count(void) {
+	__atomic_store_n(&logDroppedCount, 0, __ATOMIC_RELAXED);
+}
+
+#endif /* ENABLE_IOT_LOG_ASYNC */
+
+#ifdef __cplusplus
+}
+#endif
@@ -39,10 +39,13 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include <string.h>
 
 #include "aws_iot_log.h"
 #include "aws_iot_mqtt_client_interface.h"
+#include "aws_iot_mqtt_client_common_internal.h"
 #include "aws_iot_version.h"
 
 #if !DISABLE_METRICS
@@ -65,7 +68,7 @@ ClientState aws_iot_mqtt_get_client_state(AWS_IoT_Client *pClient) {
 		return CLIENT_STATE_INVALID;
 	}
 
-	FUNC_EXIT_RC(pClient->clientStatus.clientState);
+	FUNC_EXIT_RC(IOT_CLIENT_STATE_LOAD(pClient));
 }
 
 #ifdef _ENABLE_THREAD_SUPPORT_
@@ -98,14 +101,47 @@ IoT_Error_t aws_iot_mqtt_client_unlock_mutex(AWS_IoT_Client *pClient, IoT_Mutex_
 	IOT_UNUSED(pClient);
 	return aws_iot_thread_mutex_unlock(pMutex);
 }
+
+#ifdef ENABLE_IOT_MUTEX_STATS
+IoT_Error_t aws_iot_mqtt_get_lock_stats(AWS_IoT_Client *pClient, IoT_Mutex_Stats_t *pReadStats,
+										IoT_Mutex_Stats_t *pWriteStats) {
+	IoT_Error_t rc = SUCCESS;
+
+	if(NULL == pClient) {
+		return NULL_VALUE_ERROR;
+	}
+
+	if(NULL != pReadStats) {
+		rc = aws_iot_thread_mutex_get_stats(&(pClient->clientData.tls_read_mutex), pReadStats);
+	}
+	if(SUCCESS == rc && NULL != pWriteStats) {
+		rc = aws_iot_thread_mutex_get_stats(&(pClient->clientData.tls_write_mutex), pWriteStats);
+	}
+
+	return rc;
+}
+
+IoT_Error_t aws_iot_mqtt_reset_lock_stats(AWS_IoT_Client *pClient) {
+	IoT_Error_t rc;
+
+	if(NULL == pClient) {
+		return NULL_VALUE_ERROR;
+	}
+
+	rc = aws_iot_thread_mutex_reset_stats(&(pClient->clientData.tls_read_mutex));
+	if(SUCCESS == rc) {
+		rc = aws_iot_thread_mutex_reset_stats(&(pClient->clientData.tls_write_mutex));
+	}
+
+	return rc;
+}
+#endif
 #endif
 
 IoT_Error_t aws_iot_mqtt_set_client_state(AWS_IoT_Client *pClient, ClientState expectedCurrentState,
 										  ClientState newState) {
 	IoT_Error_t rc;
-#ifdef _ENABLE_THREAD_SUPPORT_
-	IoT_Error_t threadRc = FAILURE;
-#endif
+	bool isSet;
 
 	FUNC_ENTRY;
 	if(NULL == pClient) {
@@ -113,25 +149,22 @@ IoT_Error_t aws_iot_mqtt_set_client_state(AWS_IoT_Client *pClient, ClientState e
 	}
 
 #ifdef _ENABLE_THREAD_SUPPORT_
-	rc = aws_iot_mqtt_client_lock_mutex(pClient, &(pClient->clientData.state_change_mutex));
-	if(SUCCESS != rc) {
-		return rc;
+	/* Of concurrent transitions out of the same state exactly one succeeds, no thread ever blocks */
+	isSet = __atomic_compare_exchange_n(&(pClient->clientStatus.clientState), &expectedCurrentState, newState, false,
+										__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+	isSet = (expectedCurrentState == pClient->clientStatus.clientState);
+	if(isSet) {
+		pClient->clientStatus.clientState = newState;
 	}
 #endif
-	if(expectedCurrentState == aws_iot_mqtt_get_client_state(pClient)) {
-		pClient->clientStatus.clientState = newState;
+
+	if(isSet) {
 		rc = SUCCESS;
 	} else {
 		rc = MQTT_UNEXPECTED_CLIENT_STATE_ERROR;
 	}
 
-#ifdef _ENABLE_THREAD_SUPPORT_
-	threadRc = aws_iot_mqtt_client_unlock_mutex(pClient, &(pClient->clientData.state_change_mutex));
-	if(SUCCESS == rc && SUCCESS != threadRc) {
-		rc = threadRc;
-	}
-#endif
-
 	FUNC_EXIT_RC(rc);
 }
 
@@ -169,6 +202,70 @@ IoT_Error_t aws_iot_mqtt_set_connect_params(AWS_IoT_Client *pClient, IoT_Client_
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+static IoT_Error_t _aws_iot_mqtt_init_buffers(AWS_IoT_Client *pClient, IoT_Client_Init_Params *pInitParams) {
+	IoT_Error_t rc;
+
+	pClient->clientData.pBufferPool = pInitParams->pBufferPool;
+
+	if(NULL == pInitParams->pBufferPool) {
+#ifdef DISABLE_IOT_MQTT_EMBEDDED_BUFFERS
+		IOT_ERROR("Clients without embedded buffers need a buffer pool");
+		return NULL_VALUE_ERROR;
+#else
+		pClient->clientData.pOwnWriteBuf = pClient->writeBufStorage;
+		pClient->clientData.ownWriteBufSize = AWS_IOT_MQTT_TX_BUF_LEN;
+		pClient->clientData.pOwnReadBuf = pClient->readBufStorage;
+		pClient->clientData.ownReadBufSize = AWS_IOT_MQTT_RX_BUF_LEN;
+#endif
+	} else {
+		rc = aws_iot_buffer_pool_acquire(pInitParams->pBufferPool,
+										 (0 != pInitParams->writeBufSize) ? pInitParams->writeBufSize
+																		  : AWS_IOT_MQTT_TX_BUF_LEN,
+										 &(pClient->clientData.pOwnWriteBuf), &(pClient->clientData.ownWriteBufSize));
+		if(SUCCESS != rc) {
+			return rc;
+		}
+		rc = aws_iot_buffer_pool_acquire(pInitParams->pBufferPool,
+										 (0 != pInitParams->readBufSize) ? pInitParams->readBufSize
+																		 : AWS_IOT_MQTT_RX_BUF_LEN,
+										 &(pClient->clientData.pOwnReadBuf), &(pClient->clientData.ownReadBufSize));
+		if(SUCCESS != rc) {
+			(void) aws_iot_buffer_pool_release(pInitParams->pBufferPool, pClient->clientData.pOwnWriteBuf);
+			return rc;
+		}
+	}
+
+	pClient->clientData.writeBuf = pClient->clientData.pOwnWriteBuf;
+	pClient->clientData.writeBufSize = pClient->clientData.ownWriteBufSize;
+	pClient->clientData.readBuf = pClient->clientData.pOwnReadBuf;
+	pClient->clientData.readBufSize = pClient->clientData.ownReadBufSize;
+	pClient->clientData.readBufIndex = 0;
+
+	return SUCCESS;
+}
+
+static void _aws_iot_mqtt_free_buffers(AWS_IoT_Client *pClient) {
+	if(NULL == pClient->clientData.pBufferPool) {
+		return;
+	}
+
+	aws_iot_mqtt_internal_restore_read_buffer(pClient);
+	aws_iot_mqtt_internal_restore_write_buffer(pClient);
+	if(NULL != pClient->clientData.pOwnWriteBuf) {
+		(void) aws_iot_buffer_pool_release(pClient->clientData.pBufferPool, pClient->clientData.pOwnWriteBuf);
+	}
+	if(NULL != pClient->clientData.pOwnReadBuf) {
+		(void) aws_iot_buffer_pool_release(pClient->clientData.pBufferPool, pClient->clientData.pOwnReadBuf);
+	}
+	pClient->clientData.pOwnWriteBuf = NULL;
+	pClient->clientData.pOwnReadBuf = NULL;
+	pClient->clientData.writeBuf = NULL;
+	pClient->clientData.readBuf = NULL;
+	pClient->clientData.writeBufSize = 0;
+	pClient->clientData.readBufSize = 0;
+	pClient->clientData.pBufferPool = NULL;
+}
+
 IoT_Error_t aws_iot_mqtt_free(AWS_IoT_Client *pClient)
 {
     IoT_Error_t rc = SUCCESS;
@@ -178,17 +275,7 @@ IoT_Error_t aws_iot_mqtt_free(AWS_IoT_Client *pClient)
     }else
 	{
 	#ifdef _ENABLE_THREAD_SUPPORT_
-		if (rc == SUCCESS)
-		{
-			rc = aws_iot_thread_mutex_destroy(&(pClient->clientData.state_change_mutex));
-		}
-
-		if (rc == SUCCESS)
-		{
-			rc = aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_read_mutex));
-		}else{
-			(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_read_mutex));
-		}
+		rc = aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_read_mutex));
 
 		if (rc == SUCCESS)
 		{
@@ -197,6 +284,8 @@ IoT_Error_t aws_iot_mqtt_free(AWS_IoT_Client *pClient)
 			(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_write_mutex));
 		}
 	#endif
+		_aws_iot_mqtt_free_buffers(pClient);
+		(void)iot_tls_free(&(pClient->networkStack));
 	}
 
     FUNC_EXIT_RC(rc);
@@ -216,17 +305,20 @@ IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, IoT_Client_Init_Params *p
 	}
 
 	for(i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++i) {
-		pClient->clientData.messageHandlers[i].topicName = NULL;
-		pClient->clientData.messageHandlers[i].pApplicationHandler = NULL;
-		pClient->clientData.messageHandlers[i].pApplicationHandlerData = NULL;
-		pClient->clientData.messageHandlers[i].qos = QOS0;
+		pClient->clientData.messageHandlers.topicName[i] = NULL;
+		pClient->clientData.messageHandlers.topicNameLen[i] = 0;
+		pClient->clientData.messageHandlers.pApplicationHandler[i] = NULL;
+		pClient->clientData.messageHandlers.pApplicationHandlerData[i] = NULL;
+		pClient->clientData.messageHandlers.qos[i] = QOS0;
 	}
 
 	pClient->clientData.packetTimeoutMs = pInitParams->mqttPacketTimeout_ms;
 	pClient->clientData.commandTimeoutMs = pInitParams->mqttCommandTimeout_ms;
-	pClient->clientData.writeBufSize = AWS_IOT_MQTT_TX_BUF_LEN;
-	pClient->clientData.readBufSize = AWS_IOT_MQTT_RX_BUF_LEN;
 	pClient->clientData.counterNetworkDisconnected = 0;
+	pClient->clientData.isWakeupPending = false;
+#ifndef DISABLE_IOT_CLIENT_METRICS
+	memset(&(pClient->clientData.metrics), 0, sizeof(IoT_Client_Metrics_t));
+#endif
 	pClient->clientData.disconnectHandler = pInitParams->disconnectHandler;
 	pClient->clientData.disconnectHandlerData = pInitParams->disconnectHandlerData;
 	pClient->clientData.nextPacketId = 1;
@@ -239,19 +331,13 @@ IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, IoT_Client_Init_Params *p
 
 #ifdef _ENABLE_THREAD_SUPPORT_
 	pClient->clientData.isBlockOnThreadLockEnabled = pInitParams->isBlockOnThreadLockEnabled;
-	rc = aws_iot_thread_mutex_init(&(pClient->clientData.state_change_mutex));
-	if(SUCCESS != rc) {
-		FUNC_EXIT_RC(rc);
-	}
 	rc = aws_iot_thread_mutex_init(&(pClient->clientData.tls_read_mutex));
 	if(SUCCESS != rc) {
-		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.state_change_mutex));
 		FUNC_EXIT_RC(rc);
 	}
 	rc = aws_iot_thread_mutex_init(&(pClient->clientData.tls_write_mutex));
 	if(SUCCESS != rc) {
 		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_read_mutex));
-		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.state_change_mutex));
 		FUNC_EXIT_RC(rc);
 	}
 #endif
@@ -266,7 +352,17 @@ IoT_Error_t aws_iot_mqtt_init(AWS_IoT_Client *pClient, IoT_Client_Init_Params *p
 	if(SUCCESS != rc) {
 		#ifdef _ENABLE_THREAD_SUPPORT_
 		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_read_mutex));
-		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.state_change_mutex));
+		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_write_mutex));
+		#endif
+		pClient->clientStatus.clientState = CLIENT_STATE_INVALID;
+		FUNC_EXIT_RC(rc);
+	}
+
+	rc = _aws_iot_mqtt_init_buffers(pClient, pInitParams);
+	if(SUCCESS != rc) {
+		(void)iot_tls_free(&(pClient->networkStack));
+		#ifdef _ENABLE_THREAD_SUPPORT_
+		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_read_mutex));
 		(void)aws_iot_thread_mutex_destroy(&(pClient->clientData.tls_write_mutex));
 		#endif
 		pClient->clientStatus.clientState = CLIENT_STATE_INVALID;
@@ -296,7 +392,7 @@ bool aws_iot_mqtt_is_client_connected(AWS_IoT_Client *pClient) {
 		FUNC_EXIT_RC(false);
 	}
 
-	switch(pClient->clientStatus.clientState) {
+	switch(IOT_CLIENT_STATE_LOAD(pClient)) {
 		case CLIENT_STATE_INVALID:
 		case CLIENT_STATE_INITIALIZED:
 		case CLIENT_STATE_CONNECTING:
@@ -40,6 +40,8 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include <aws_iot_mqtt_client.h>
 #include "aws_iot_mqtt_client_common_internal.h"
 
@@ -312,12 +314,74 @@ IoT_Error_t aws_iot_mqtt_internal_send_packet(AWS_IoT_Client *pClient, size_t le
 	if(sent == length) {
 		/* record the fact that we have successfully sent the packet */
 		//countdown_sec(&c->pingTimer, c->clientData.keepAliveInterval);
+		IOT_CLIENT_METRICS_COUNT_PACKET(pClient, sent, MQTT_HEADER_FIELD_TYPE(pClient->clientData.writeBuf[0]), length);
 		FUNC_EXIT_RC(SUCCESS);
 	}
 
 	FUNC_EXIT_RC(rc) 
 }
 
+IoT_Error_t aws_iot_mqtt_internal_grow_write_buffer(AWS_IoT_Client *pClient, size_t minSize) {
+	unsigned char *pBuffer;
+	size_t bufferSize;
+	IoT_Error_t rc;
+
+	if(NULL == pClient->clientData.pBufferPool || pClient->clientData.writeBuf != pClient->clientData.pOwnWriteBuf) {
+		return MQTT_TX_BUFFER_TOO_SHORT_ERROR;
+	}
+
+	rc = aws_iot_buffer_pool_acquire(pClient->clientData.pBufferPool, minSize, &pBuffer, &bufferSize);
+	if(SUCCESS != rc) {
+		return MQTT_TX_BUFFER_TOO_SHORT_ERROR;
+	}
+
+	pClient->clientData.writeBuf = pBuffer;
+	pClient->clientData.writeBufSize = bufferSize;
+	return SUCCESS;
+}
+
+void aws_iot_mqtt_internal_restore_write_buffer(AWS_IoT_Client *pClient) {
+	if(pClient->clientData.writeBuf == pClient->clientData.pOwnWriteBuf) {
+		return;
+	}
+
+	(void) aws_iot_buffer_pool_release(pClient->clientData.pBufferPool, pClient->clientData.writeBuf);
+	pClient->clientData.writeBuf = pClient->clientData.pOwnWriteBuf;
+	pClient->clientData.writeBufSize = pClient->clientData.ownWriteBufSize;
+}
+
+/* Moves the bytes of the packet read so far into a larger buffer from the pool */
+static IoT_Error_t _aws_iot_mqtt_internal_grow_read_buffer(AWS_IoT_Client *pClient, size_t minSize) {
+	unsigned char *pBuffer;
+	size_t bufferSize;
+	IoT_Error_t rc;
+
+	if(NULL == pClient->clientData.pBufferPool || pClient->clientData.readBuf != pClient->clientData.pOwnReadBuf) {
+		return MQTT_RX_BUFFER_TOO_SHORT_ERROR;
+	}
+
+	rc = aws_iot_buffer_pool_acquire(pClient->clientData.pBufferPool, minSize, &pBuffer, &bufferSize);
+	if(SUCCESS != rc) {
+		IOT_WARN("No pool buffer of %u bytes for an incoming packet", (unsigned) minSize);
+		return MQTT_RX_BUFFER_TOO_SHORT_ERROR;
+	}
+
+	memcpy(pBuffer, pClient->clientData.readBuf, pClient->clientData.readBufIndex);
+	pClient->clientData.readBuf = pBuffer;
+	pClient->clientData.readBufSize = bufferSize;
+	return SUCCESS;
+}
+
+void aws_iot_mqtt_internal_restore_read_buffer(AWS_IoT_Client *pClient) {
+	if(pClient->clientData.readBuf == pClient->clientData.pOwnReadBuf) {
+		return;
+	}
+
+	(void) aws_iot_buffer_pool_release(pClient->clientData.pBufferPool, pClient->clientData.readBuf);
+	pClient->clientData.readBuf = pClient->clientData.pOwnReadBuf;
+	pClient->clientData.readBufSize = pClient->clientData.ownReadBufSize;
+}
+
 static IoT_Error_t _aws_iot_mqtt_internal_readWrapper( AWS_IoT_Client *pClient, size_t offset, size_t size, Timer *pTimer, size_t * read_len ) {
     IoT_Error_t rc;
     int byteToRead;
@@ -392,6 +456,11 @@ static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, T
 	bytes_to_be_read = 0;
 	read_len = 0;
 
+	/* The previous packet has been handled, a borrowed buffer goes back to the pool */
+	if(0 == pClient->clientData.readBufIndex) {
+		aws_iot_mqtt_internal_restore_read_buffer(pClient);
+	}
+
     rc = _aws_iot_mqtt_internal_readWrapper( pClient, offset, 1, pTimer, &read_len );
 	/* 1. read the header byte.  This has the packet type in it */
 	if(NETWORK_SSL_NOTHING_TO_READ == rc) {
@@ -406,8 +475,11 @@ static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, T
 		return rc;
 	} 
      
-	/* if the buffer is too short then the message will be dropped silently */
-	if((rem_len + offset) >= pClient->clientData.readBufSize) {
+	/* if the buffer is too short and the pool has no larger one then the message will be dropped silently */
+	if((rem_len + offset) >= pClient->clientData.readBufSize
+	   && SUCCESS != _aws_iot_mqtt_internal_grow_read_buffer(pClient, rem_len + offset + 1)) {
+		IOT_CLIENT_METRICS_ADD(pClient, droppedOversizeMessages, 1);
+		IOT_CLIENT_METRICS_ADD(pClient, droppedOversizeBytes, rem_len);
 		bytes_to_be_read = pClient->clientData.readBufSize;
 		do {
 			rc = pClient->networkStack.read(&(pClient->networkStack), pClient->clientData.readBuf, bytes_to_be_read,
@@ -446,6 +518,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_read_packet(AWS_IoT_Client *pClient, T
     aws_iot_mqtt_internal_flushBuffers( pClient );
 	header.byte = pClient->clientData.readBuf[0];
 	*pPacketType = MQTT_HEADER_FIELD_TYPE(header.byte);
+	IOT_CLIENT_METRICS_COUNT_PACKET(pClient, received, *pPacketType, offset + rem_len);
 
 	FUNC_EXIT_RC(rc);
 }
@@ -510,16 +583,18 @@ static IoT_Error_t _aws_iot_mqtt_internal_deliver_message(AWS_IoT_Client *pClien
 
 	/* Find the right message handler - indexed by topic */
 	for(itr = 0; itr < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++itr) {
-		if(NULL != pClient->clientData.messageHandlers[itr].topicName) {
-			if(((topicNameLen == pClient->clientData.messageHandlers[itr].topicNameLen)
+		if(NULL != pClient->clientData.messageHandlers.topicName[itr]) {
+			if(((topicNameLen == pClient->clientData.messageHandlers.topicNameLen[itr])
 				&&
-				(strncmp(pTopicName, (char *) pClient->clientData.messageHandlers[itr].topicName, topicNameLen) == 0))
-			   || _aws_iot_mqtt_internal_is_topic_matched((char *) pClient->clientData.messageHandlers[itr].topicName,
+				(strncmp(pTopicName, (char *) pClient->clientData.messageHandlers.topicName[itr], topicNameLen) == 0))
+			   || _aws_iot_mqtt_internal_is_topic_matched((char *) pClient->clientData.messageHandlers.topicName[itr],
 														  pTopicName, topicNameLen)) {
-				if(NULL != pClient->clientData.messageHandlers[itr].pApplicationHandler) {
-					pClient->clientData.messageHandlers[itr].pApplicationHandler(pClient, pTopicName, topicNameLen,
+				if(NULL != pClient->clientData.messageHandlers.pApplicationHandler[itr]) {
+					IOT_CLIENT_METRICS_TIMESTAMP(callbackStartNs);
+					pClient->clientData.messageHandlers.pApplicationHandler[itr](pClient, pTopicName, topicNameLen,
 																				 pMessageParams,
-																				 pClient->clientData.messageHandlers[itr].pApplicationHandlerData);
+																				 pClient->clientData.messageHandlers.pApplicationHandlerData[itr]);
+					IOT_CLIENT_METRICS_RECORD_DURATION(pClient, callbackDuration, callbackStartNs);
 				}
 			}
 		}
@@ -552,6 +627,9 @@ static IoT_Error_t _aws_iot_mqtt_internal_handle_publish(AWS_IoT_Client *pClient
 		FUNC_EXIT_RC(rc);
 	}
 
+	/* Packets filling the read buffer are dropped, there is always room to terminate the payload in place */
+	((char *) msg.payload)[msg.payloadLen] = '\0';
+
 	rc = _aws_iot_mqtt_internal_deliver_message(pClient, topicName, topicNameLen, &msg);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
@@ -622,6 +700,7 @@ IoT_Error_t aws_iot_mqtt_internal_cycle_read(AWS_IoT_Client *pClient, Timer *pTi
 			break;
 		case PUBLISH: {
 			rc = _aws_iot_mqtt_internal_handle_publish(pClient, pTimer);
+			aws_iot_mqtt_internal_restore_read_buffer(pClient);
 			break;
 		}
 		case PUBREC:
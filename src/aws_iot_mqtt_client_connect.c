@@ -39,6 +39,8 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include <stdio.h>
 
 #include <aws_iot_mqtt_client.h>
@@ -398,11 +400,13 @@ static IoT_Error_t _aws_iot_mqtt_internal_connect(AWS_IoT_Client *pClient, IoT_C
 		}
 	}
 
+	IOT_CLIENT_METRICS_TIMESTAMP(networkConnectStartNs);
 	rc = pClient->networkStack.connect(&(pClient->networkStack), NULL);
 	if(SUCCESS != rc) {
 		/* TLS Connect failed, return error */
 		FUNC_EXIT_RC(rc);
 	}
+	IOT_CLIENT_METRICS_RECORD_DURATION(pClient, networkConnectDuration, networkConnectStartNs);
 
 	init_timer(&connect_timer);
 	countdown_ms(&connect_timer, pClient->clientData.commandTimeoutMs);
@@ -464,6 +468,7 @@ IoT_Error_t aws_iot_mqtt_connect(AWS_IoT_Client *pClient, IoT_Client_Connect_Par
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
     aws_iot_mqtt_internal_flushBuffers( pClient );
+	aws_iot_mqtt_internal_restore_read_buffer(pClient);
 	clientState = aws_iot_mqtt_get_client_state(pClient);
 
 	if(false == _aws_iot_mqtt_is_client_state_valid_for_connect(clientState)) {
@@ -570,10 +575,10 @@ IoT_Error_t aws_iot_mqtt_disconnect(AWS_IoT_Client *pClient) {
 	rc = _aws_iot_mqtt_internal_disconnect(pClient);
 
 	if(SUCCESS != rc) {
-		pClient->clientStatus.clientState = clientState;
+		IOT_CLIENT_STATE_STORE(pClient, clientState);
 	} else {
 		/* If called from Keepalive, this gets set to CLIENT_STATE_DISCONNECTED_ERROR */
-		pClient->clientStatus.clientState = CLIENT_STATE_DISCONNECTED_MANUALLY;
+		IOT_CLIENT_STATE_STORE(pClient, CLIENT_STATE_DISCONNECTED_MANUALLY);
 	}
 
 	FUNC_EXIT_RC(rc);
@@ -605,6 +610,8 @@ IoT_Error_t aws_iot_mqtt_attempt_reconnect(AWS_IoT_Client *pClient) {
 		FUNC_EXIT_RC(NETWORK_ALREADY_CONNECTED_ERROR);
 	}
 
+	IOT_CLIENT_METRICS_ADD(pClient, reconnectAttempts, 1);
+
 	/* Ignoring return code. failures expected if network is disconnected */
 	rc = aws_iot_mqtt_connect(pClient, NULL);
 
@@ -614,6 +621,8 @@ IoT_Error_t aws_iot_mqtt_attempt_reconnect(AWS_IoT_Client *pClient) {
 		FUNC_EXIT_RC(NETWORK_ATTEMPTING_RECONNECT);
 	}
 
+	IOT_CLIENT_METRICS_ADD(pClient, reconnectSuccesses, 1);
+
 	rc = aws_iot_mqtt_resubscribe(pClient);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
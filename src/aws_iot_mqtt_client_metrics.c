@@ -0,0 +1,224 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_mqtt_client_metrics.c
+ * @brief MQTT client metrics recording, snapshot and text rendering
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
+#include "aws_iot_mqtt_client_common_internal.h"
+
+#ifndef DISABLE_IOT_CLIENT_METRICS
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static const char *const packetTypeNames[AWS_IOT_CLIENT_METRICS_PACKET_TYPES] = {
+		"RESERVED", "CONNECT", "CONNACK", "PUBLISH", "PUBACK", "PUBREC", "PUBREL", "PUBCOMP",
+		"SUBSCRIBE", "SUBACK", "UNSUBSCRIBE", "UNSUBACK", "PINGREQ", "PINGRESP", "DISCONNECT", "RESERVED"
+};
+
+typedef struct {
+	char *pBuf;
+	size_t bufLen;
+	size_t used;
+	size_t lineStart;
+	const char *pClientLabel;
+	IoT_Error_t rc;
+} MetricsTextState_t;
+
+static uint32_t _aws_iot_mqtt_metrics_bucket_index(uint64_t durationUs) {
+	uint32_t index = 0;
+	uint64_t bound = AWS_IOT_CLIENT_METRICS_HISTOGRAM_FIRST_BOUND_US;
+
+	while(durationUs >= bound && index < AWS_IOT_CLIENT_METRICS_HISTOGRAM_BUCKETS - 1) {
+		bound <<= 1;
+		index++;
+	}
+	return index;
+}
+
+void aws_iot_mqtt_internal_metrics_record_duration(IoT_Client_Latency_Histogram_t *pHistogram, uint64_t startNs) {
+	uint64_t durationUs = (get_monotonic_time_ns() - startNs) / 1000;
+
+	pHistogram->count++;
+	pHistogram->sumUs += durationUs;
+	if(durationUs > pHistogram->maxUs) {
+		pHistogram->maxUs = (durationUs > UINT32_MAX) ? UINT32_MAX : (uint32_t) durationUs;
+	}
+	pHistogram->buckets[_aws_iot_mqtt_metrics_bucket_index(durationUs)]++;
+}
+
+void aws_iot_mqtt_internal_metrics_count_packet(IoT_Client_Packet_Counters_t *pCounters, uint8_t packetType,
+												size_t length) {
+	packetType &= (AWS_IOT_CLIENT_METRICS_PACKET_TYPES - 1);
+	pCounters->packets[packetType]++;
+	pCounters->bytes[packetType] += length;
+}
+
+IoT_Error_t aws_iot_mqtt_get_client_metrics(AWS_IoT_Client *pClient, IoT_Client_Metrics_t *pMetrics) {
+	if(NULL == pClient || NULL == pMetrics) {
+		return NULL_VALUE_ERROR;
+	}
+
+	*pMetrics = pClient->clientData.metrics;
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_mqtt_reset_client_metrics(AWS_IoT_Client *pClient) {
+	if(NULL == pClient) {
+		return NULL_VALUE_ERROR;
+	}
+
+	memset(&(pClient->clientData.metrics), 0, sizeof(IoT_Client_Metrics_t));
+	return SUCCESS;
+}
+
+static void _aws_iot_mqtt_metrics_printf(MetricsTextState_t *pState, const char *pFormat, ...) {
+	va_list args;
+	int written;
+
+	if(SUCCESS != pState->rc) {
+		return;
+	}
+
+	va_start(args, pFormat);
+	written = vsnprintf(pState->pBuf + pState->used, pState->bufLen - pState->used, pFormat, args);
+	va_end(args);
+
+	if(written < 0 || (size_t) written >= pState->bufLen - pState->used) {
+		/* Drop the partial line so the output only holds complete lines */
+		pState->used = pState->lineStart;
+		pState->pBuf[pState->used] = '\0';
+		pState->rc = MAX_SIZE_ERROR;
+		return;
+	}
+	pState->used += (size_t) written;
+}
+
+/* Writes the label set with an optional extra label, e.g. {client="x",type="PUBLISH"} */
+static void _aws_iot_mqtt_metrics_labels(MetricsTextState_t *pState, const char *pExtraKey, const char *pExtraValue) {
+	bool hasClient = (NULL != pState->pClientLabel);
+
+	if(!hasClient && NULL == pExtraKey) {
+		return;
+	}
+	_aws_iot_mqtt_metrics_printf(pState, "{");
+	if(hasClient) {
+		_aws_iot_mqtt_metrics_printf(pState, "client=\"%s\"", pState->pClientLabel);
+	}
+	if(NULL != pExtraKey) {
+		_aws_iot_mqtt_metrics_printf(pState, "%s%s=\"%s\"", hasClient ? "," : "", pExtraKey, pExtraValue);
+	}
+	_aws_iot_mqtt_metrics_printf(pState, "}");
+}
+
+static void _aws_iot_mqtt_metrics_counter(MetricsTextState_t *pState, const char *pName, const char *pExtraKey,
+										  const char *pExtraValue, unsigned long long value) {
+	pState->lineStart = pState->used;
+	_aws_iot_mqtt_metrics_printf(pState, "aws_iot_mqtt_%s", pName);
+	_aws_iot_mqtt_metrics_labels(pState, pExtraKey, pExtraValue);
+	_aws_iot_mqtt_metrics_printf(pState, " %llu\n", value);
+}
+
+static void _aws_iot_mqtt_metrics_packets(MetricsTextState_t *pState, const char *pDirection,
+										  const IoT_Client_Packet_Counters_t *pCounters) {
+	char name[32];
+	uint32_t type;
+
+	for(type = 0; type < AWS_IOT_CLIENT_METRICS_PACKET_TYPES; type++) {
+		if(0 == pCounters->packets[type]) {
+			continue;
+		}
+		snprintf(name, sizeof(name), "packets_%s_total", pDirection);
+		_aws_iot_mqtt_metrics_counter(pState, name, "type", packetTypeNames[type], pCounters->packets[type]);
+		snprintf(name, sizeof(name), "bytes_%s_total", pDirection);
+		_aws_iot_mqtt_metrics_counter(pState, name, "type", packetTypeNames[type], pCounters->bytes[type]);
+	}
+}
+
+static void _aws_iot_mqtt_metrics_histogram(MetricsTextState_t *pState, const char *pName,
+											const IoT_Client_Latency_Histogram_t *pHistogram) {
+	char bound[24];
+	char name[64];
+	unsigned long long cumulative = 0;
+	uint64_t upperBound = AWS_IOT_CLIENT_METRICS_HISTOGRAM_FIRST_BOUND_US;
+	uint32_t i;
+
+	if(0 != pHistogram->count) {
+		snprintf(name, sizeof(name), "%s_us_bucket", pName);
+		for(i = 0; i < AWS_IOT_CLIENT_METRICS_HISTOGRAM_BUCKETS; i++) {
+			cumulative += pHistogram->buckets[i];
+			if(AWS_IOT_CLIENT_METRICS_HISTOGRAM_BUCKETS - 1 == i) {
+				snprintf(bound, sizeof(bound), "+Inf");
+			} else {
+				snprintf(bound, sizeof(bound), "%llu", (unsigned long long) upperBound);
+			}
+			_aws_iot_mqtt_metrics_counter(pState, name, "le", bound, cumulative);
+			upperBound <<= 1;
+		}
+		snprintf(name, sizeof(name), "%s_us_sum", pName);
+		_aws_iot_mqtt_metrics_counter(pState, name, NULL, NULL, pHistogram->sumUs);
+		snprintf(name, sizeof(name), "%s_us_max", pName);
+		_aws_iot_mqtt_metrics_counter(pState, name, NULL, NULL, pHistogram->maxUs);
+	}
+	snprintf(name, sizeof(name), "%s_us_count", pName);
+	_aws_iot_mqtt_metrics_counter(pState, name, NULL, NULL, pHistogram->count);
+}
+
+IoT_Error_t aws_iot_mqtt_client_metrics_to_text(const IoT_Client_Metrics_t *pMetrics, const char *pClientLabel,
+												char *pBuf, size_t bufLen, size_t *pWrittenLen) {
+	MetricsTextState_t state;
+
+	if(NULL == pMetrics || NULL == pBuf || NULL == pWrittenLen || 0 == bufLen) {
+		return NULL_VALUE_ERROR;
+	}
+
+	state.pBuf = pBuf;
+	state.bufLen = bufLen;
+	state.used = 0;
+	state.lineStart = 0;
+	state.pClientLabel = pClientLabel;
+	state.rc = SUCCESS;
+	pBuf[0] = '\0';
+
+	_aws_iot_mqtt_metrics_packets(&state, "out", &(pMetrics->sent));
+	_aws_iot_mqtt_metrics_packets(&state, "in", &(pMetrics->received));
+	_aws_iot_mqtt_metrics_histogram(&state, "puback_latency", &(pMetrics->publishAckLatency));
+	_aws_iot_mqtt_metrics_histogram(&state, "suback_latency", &(pMetrics->subscribeAckLatency));
+	_aws_iot_mqtt_metrics_histogram(&state, "yield_duration", &(pMetrics->yieldDuration));
+	_aws_iot_mqtt_metrics_histogram(&state, "callback_duration", &(pMetrics->callbackDuration));
+	_aws_iot_mqtt_metrics_histogram(&state, "network_connect_duration", &(pMetrics->networkConnectDuration));
+	_aws_iot_mqtt_metrics_counter(&state, "reconnect_attempts_total", NULL, NULL, pMetrics->reconnectAttempts);
+	_aws_iot_mqtt_metrics_counter(&state, "reconnect_successes_total", NULL, NULL, pMetrics->reconnectSuccesses);
+	_aws_iot_mqtt_metrics_counter(&state, "dropped_oversize_messages_total", NULL, NULL,
+								  pMetrics->droppedOversizeMessages);
+	_aws_iot_mqtt_metrics_counter(&state, "dropped_oversize_bytes_total", NULL, NULL, pMetrics->droppedOversizeBytes);
+
+	*pWrittenLen = state.used;
+	return state.rc;
+}
+
+#endif /* DISABLE_IOT_CLIENT_METRICS */
+
+#ifdef __cplusplus
+}
+#endif
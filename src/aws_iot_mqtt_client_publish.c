@@ -40,6 +40,8 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include "aws_iot_mqtt_client_common_internal.h"
 
 /**
@@ -69,58 +71,92 @@ static IoT_Error_t _aws_iot_mqtt_read_string_with_len(char **stringVar, uint16_t
 }
 
 /**
-  * Serializes the supplied publish data into the supplied buffer, ready for sending
-  * @param pTxBuf the buffer into which the packet will be serialized
-  * @param txBufLen the length in bytes of the supplied buffer
-  * @param dup uint8_t - the MQTT dup flag
+ * @brief Fixed header and topic of a publish, as the serializer copies them
+ *
+ * The prefix starts with the fixed header byte and the topic name length. A publish handle
+ * keeps the topic in its prefix, aws_iot_mqtt_publish appends the topic of the caller to it.
+ */
+typedef struct {
+	QoS qos;							///< Quality of Service of the publish
+	uint32_t variableHeaderLen;			///< Remaining length of the publish without payload
+	const unsigned char *pPrefix;		///< Fixed header byte and topic name length, followed by the topic of a handle
+	uint16_t prefixLen;					///< Length of the prefix
+	const char *pTopicName;				///< Topic copied after the prefix, NULL when the prefix holds the topic
+	uint16_t topicNameLen;				///< Length of pTopicName
+} _PublishEncoding;
+
+/**
+  * Encodes the fixed header byte and the topic name length of a publish
+  * @param pPrefix the 3 bytes to fill
+  * @param pVariableHeaderLen returned remaining length of the publish without payload
+  * @param topicNameLen uint16_t - the length of the Topic Name
   * @param qos QoS - the MQTT QoS value
   * @param retained uint8_t - the MQTT retained flag
-  * @param packetId uint16_t - the MQTT packet identifier
-  * @param pTopicName char * - the MQTT topic in the publish
-  * @param topicNameLen uint16_t - the length of the Topic Name
+  *
+  * @return An IoT Error Type defining successful/failed call
+  */
+static IoT_Error_t _aws_iot_mqtt_internal_encode_publish_prefix(unsigned char *pPrefix, uint32_t *pVariableHeaderLen,
+																uint16_t topicNameLen, QoS qos, uint8_t retained) {
+	IoT_Error_t rc;
+	MQTTHeader header = {0};
+
+	rc = aws_iot_mqtt_internal_init_header(&header, PUBLISH, qos, 0, retained);
+	if(SUCCESS != rc) {
+		return rc;
+	}
+
+	pPrefix[0] = header.byte;
+	pPrefix[1] = (unsigned char) (topicNameLen / 256);
+	pPrefix[2] = (unsigned char) (topicNameLen % 256);
+	*pVariableHeaderLen = (uint32_t) topicNameLen + 2;
+	if(qos > 0) {
+		*pVariableHeaderLen += 2; /* packetId */
+	}
+
+	return SUCCESS;
+}
+
+/**
+  * Serializes a publish into the supplied buffer from its encoded prefix, ready for sending
+  * @param pTxBuf the buffer into which the packet will be serialized
+  * @param txBufLen the length in bytes of the supplied buffer
+  * @param pEncoding the prefix, topic and QoS of the publish
+  * @param packetId uint16_t - the MQTT packet identifier, ignored for QoS 0
   * @param pPayload byte buffer - the MQTT publish payload
   * @param payloadLen size_t - the length of the MQTT payload
   * @param pSerializedLen uint32_t - pointer to the variable that stores serialized len
   *
   * @return An IoT Error Type defining successful/failed call
   */
-static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBuf, size_t txBufLen, uint8_t dup,
-															QoS qos, uint8_t retained, uint16_t packetId,
-															const char *pTopicName, uint16_t topicNameLen,
+static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBuf, size_t txBufLen,
+															const _PublishEncoding *pEncoding, uint16_t packetId,
 															const unsigned char *pPayload, size_t payloadLen,
 															uint32_t *pSerializedLen) {
 	unsigned char *ptr;
 	uint32_t rem_len;
-	IoT_Error_t rc;
-	MQTTHeader header = {0};
 
-	FUNC_ENTRY;
-	if(NULL == pTxBuf || NULL == pPayload || NULL == pSerializedLen) {
-		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	if(NULL == pPayload) {
+		return NULL_VALUE_ERROR;
 	}
 
-	ptr = pTxBuf;
-	rem_len = 0;
-
-	rem_len += (uint32_t) (topicNameLen + payloadLen + 2);
-	if(qos > 0) {
-		rem_len += 2; /* packetId */
-	}
+	rem_len = pEncoding->variableHeaderLen + (uint32_t) payloadLen;
 	if(aws_iot_mqtt_internal_get_final_packet_length_from_remaining_length(rem_len) > txBufLen) {
-		FUNC_EXIT_RC(MQTT_TX_BUFFER_TOO_SHORT_ERROR);
+		return MQTT_TX_BUFFER_TOO_SHORT_ERROR;
 	}
 
-	rc = aws_iot_mqtt_internal_init_header(&header, PUBLISH, qos, dup, retained);
-	if(SUCCESS != rc) {
-		FUNC_EXIT_RC(rc);
+	ptr = pTxBuf;
+	*ptr++ = pEncoding->pPrefix[0];
+	ptr += aws_iot_mqtt_internal_write_len_to_buffer(ptr, rem_len); /* write remaining length */
+
+	/* topic name length, and the topic itself for a handle, in one copy */
+	memcpy(ptr, &pEncoding->pPrefix[1], (size_t) pEncoding->prefixLen - 1);
+	ptr += pEncoding->prefixLen - 1;
+	if(NULL != pEncoding->pTopicName) {
+		memcpy(ptr, pEncoding->pTopicName, pEncoding->topicNameLen);
+		ptr += pEncoding->topicNameLen;
 	}
-	aws_iot_mqtt_internal_write_char(&ptr, header.byte); /* write header */
-
-	ptr += aws_iot_mqtt_internal_write_len_to_buffer(ptr, rem_len); /* write remaining length */;
-
-	aws_iot_mqtt_internal_write_utf8_string(&ptr, pTopicName, topicNameLen);
 
-	if(qos > 0) {
+	if(pEncoding->qos > 0) {
 		aws_iot_mqtt_internal_write_uint_16(&ptr, packetId);
 	}
 
@@ -129,7 +165,52 @@ static IoT_Error_t _aws_iot_mqtt_internal_serialize_publish(unsigned char *pTxBu
 
 	*pSerializedLen = (uint32_t) (ptr - pTxBuf);
 
-	FUNC_EXIT_RC(SUCCESS);
+	return SUCCESS;
+}
+
+/**
+  * Points a publish encoding at the prefix of a publish handle
+  * @param pEncoding the encoding to fill
+  * @param pHandle the handle holding the prefix
+  */
+static void _aws_iot_mqtt_internal_encoding_from_handle(_PublishEncoding *pEncoding, const IoT_Publish_Handle *pHandle) {
+	pEncoding->qos = pHandle->qos;
+	pEncoding->variableHeaderLen = pHandle->variableHeaderLen;
+	pEncoding->pPrefix = pHandle->prefix;
+	pEncoding->prefixLen = pHandle->prefixLen;
+	pEncoding->pTopicName = NULL;
+	pEncoding->topicNameLen = 0;
+}
+
+/**
+  * Serializes a publish into the supplied buffer from its publish handle, ready for sending
+  * @param pTxBuf the buffer into which the packet will be serialized
+  * @param txBufLen the length in bytes of the supplied buffer
+  * @param pHandle the encoded fixed header and topic and the QoS of the publish
+  * @param packetId uint16_t - the MQTT packet identifier, ignored for QoS 0
+  * @param pPayload byte buffer - the MQTT publish payload
+  * @param payloadLen size_t - the length of the MQTT payload
+  * @param pSerializedLen uint32_t - pointer to the variable that stores serialized len
+  *
+  * @return An IoT Error Type defining successful/failed call
+  */
+IoT_Error_t aws_iot_mqtt_internal_serialize_publish_with_handle(unsigned char *pTxBuf, size_t txBufLen,
+																const IoT_Publish_Handle *pHandle, uint16_t packetId,
+																const unsigned char *pPayload, size_t payloadLen,
+																uint32_t *pSerializedLen) {
+	_PublishEncoding encoding;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+	if(NULL == pTxBuf || NULL == pHandle || NULL == pSerializedLen) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	_aws_iot_mqtt_internal_encoding_from_handle(&encoding, pHandle);
+	rc = _aws_iot_mqtt_internal_serialize_publish(pTxBuf, txBufLen, &encoding, packetId, pPayload, payloadLen,
+												  pSerializedLen);
+
+	FUNC_EXIT_RC(rc);
 }
 
 /**
@@ -188,14 +269,15 @@ IoT_Error_t aws_iot_mqtt_internal_serialize_ack(unsigned char *pTxBuf, size_t tx
  * Not meant to be called directly as it doesn't do validations or client state changes
  *
  * @param pClient Reference to the IoT Client
- * @param pTopicName Topic Name to publish to
- * @param topicNameLen Length of the topic name
- * @param pParams Pointer to Publish Message parameters
+ * @param pEncoding Prefix, topic and QoS of the publish
+ * @param pPayload Payload of the message
+ * @param payloadLen Length of the payload
+ * @param pPacketId Set to the packet identifier of a QoS 1 publish
  *
  * @return An IoT Error Type defining successful/failed publish
  */
-static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const char *pTopicName,
-												  uint16_t topicNameLen, IoT_Publish_Message_Params *pParams) {
+static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const _PublishEncoding *pEncoding,
+												  const void *pPayload, size_t payloadLen, uint16_t *pPacketId) {
 	Timer timer;
 	uint32_t len = 0;
 	uint16_t packet_id;
@@ -207,26 +289,35 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 	init_timer(&timer);
 	countdown_ms(&timer, pClient->clientData.commandTimeoutMs);
 
-	if(QOS1 == pParams->qos) {
-		pParams->id = aws_iot_mqtt_get_next_packet_id(pClient);
+	if(QOS1 == pEncoding->qos) {
+		*pPacketId = aws_iot_mqtt_get_next_packet_id(pClient);
 	}
 
-	rc = _aws_iot_mqtt_internal_serialize_publish(pClient->clientData.writeBuf, pClient->clientData.writeBufSize, 0,
-												  pParams->qos, pParams->isRetained, pParams->id, pTopicName,
-												  topicNameLen, (unsigned char *) pParams->payload,
-												  pParams->payloadLen, &len);
-	if(SUCCESS != rc) {
-		FUNC_EXIT_RC(rc);
+	/* A publish larger than the TX buffer borrows one from the pool until it is sent */
+	len = aws_iot_mqtt_internal_get_final_packet_length_from_remaining_length(
+			pEncoding->variableHeaderLen + (uint32_t) payloadLen);
+	if(len >= pClient->clientData.writeBufSize) {
+		rc = aws_iot_mqtt_internal_grow_write_buffer(pClient, (size_t) len + 1);
+		if(SUCCESS != rc) {
+			FUNC_EXIT_RC(rc);
+		}
 	}
 
-	/* send the publish packet */
-	rc = aws_iot_mqtt_internal_send_packet(pClient, len, &timer);
+	rc = _aws_iot_mqtt_internal_serialize_publish(pClient->clientData.writeBuf, pClient->clientData.writeBufSize,
+												  pEncoding, *pPacketId, (const unsigned char *) pPayload, payloadLen,
+												  &len);
+	IOT_CLIENT_METRICS_TIMESTAMP(sendStartNs);
+	if(SUCCESS == rc) {
+		/* send the publish packet */
+		rc = aws_iot_mqtt_internal_send_packet(pClient, len, &timer);
+	}
+	aws_iot_mqtt_internal_restore_write_buffer(pClient);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
 
 	/* Wait for ack if QoS1 */
-	if(QOS1 == pParams->qos) {
+	if(QOS1 == pEncoding->qos) {
 		rc = aws_iot_mqtt_internal_wait_for_read(pClient, PUBACK, &timer);
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
@@ -237,11 +328,52 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
+		IOT_CLIENT_METRICS_RECORD_DURATION(pClient, publishAckLatency, sendStartNs);
 	}
 
 	FUNC_EXIT_RC(SUCCESS);
 }
 
+/**
+ * @brief Check the client state, then publish with the client state set to publish in progress
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pEncoding Prefix, topic and QoS of the publish
+ * @param pPayload Payload of the message
+ * @param payloadLen Length of the payload
+ * @param pPacketId Set to the packet identifier of a QoS 1 publish
+ *
+ * @return An IoT Error Type defining successful/failed publish
+ */
+static IoT_Error_t _aws_iot_mqtt_publish_in_state(AWS_IoT_Client *pClient, const _PublishEncoding *pEncoding,
+												  const void *pPayload, size_t payloadLen, uint16_t *pPacketId) {
+	IoT_Error_t rc, pubRc;
+	ClientState clientState;
+
+	if(!aws_iot_mqtt_is_client_connected(pClient)) {
+		return NETWORK_DISCONNECTED_ERROR;
+	}
+
+	clientState = aws_iot_mqtt_get_client_state(pClient);
+	if(CLIENT_STATE_CONNECTED_IDLE != clientState && CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN != clientState) {
+		return MQTT_CLIENT_NOT_IDLE_ERROR;
+	}
+
+	rc = aws_iot_mqtt_set_client_state(pClient, clientState, CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS);
+	if(SUCCESS != rc) {
+		return rc;
+	}
+
+	pubRc = _aws_iot_mqtt_internal_publish(pClient, pEncoding, pPayload, payloadLen, pPacketId);
+
+	rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS, clientState);
+	if(SUCCESS == pubRc && SUCCESS != rc) {
+		pubRc = rc;
+	}
+
+	return pubRc;
+}
+
 /**
  * @brief Publish an MQTT message on a topic
  *
@@ -261,8 +393,9 @@ static IoT_Error_t _aws_iot_mqtt_internal_publish(AWS_IoT_Client *pClient, const
  */
 IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName, uint16_t topicNameLen,
 								 IoT_Publish_Message_Params *pParams) {
-	IoT_Error_t rc, pubRc;
-	ClientState clientState;
+	IoT_Error_t rc;
+	unsigned char prefix[3];
+	_PublishEncoding encoding;
 
 	FUNC_ENTRY;
 
@@ -270,28 +403,105 @@ IoT_Error_t aws_iot_mqtt_publish(AWS_IoT_Client *pClient, const char *pTopicName
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	if(!aws_iot_mqtt_is_client_connected(pClient)) {
-		FUNC_EXIT_RC(NETWORK_DISCONNECTED_ERROR);
+	rc = _aws_iot_mqtt_internal_encode_publish_prefix(prefix, &encoding.variableHeaderLen, topicNameLen,
+													  pParams->qos, pParams->isRetained);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
 	}
+	encoding.qos = pParams->qos;
+	encoding.pPrefix = prefix;
+	encoding.prefixLen = sizeof(prefix);
+	encoding.pTopicName = pTopicName;
+	encoding.topicNameLen = topicNameLen;
 
-	clientState = aws_iot_mqtt_get_client_state(pClient);
-	if(CLIENT_STATE_CONNECTED_IDLE != clientState && CLIENT_STATE_CONNECTED_WAIT_FOR_CB_RETURN != clientState) {
-		FUNC_EXIT_RC(MQTT_CLIENT_NOT_IDLE_ERROR);
+	rc = _aws_iot_mqtt_publish_in_state(pClient, &encoding, pParams->payload, pParams->payloadLen, &pParams->id);
+
+	FUNC_EXIT_RC(rc);
+}
+
+/**
+ * @brief Create a publish handle for repeated publishes on one topic
+ *
+ * Validates the topic once and encodes the fixed header, the topic length and a copy of the topic
+ * into the prefix of the handle, so that aws_iot_mqtt_publish_with_handle does not validate or
+ * encode the topic again.
+ *
+ * @param pHandle Handle to fill
+ * @param pTopicName Topic Name to publish to, copied into the handle
+ * @param topicNameLen Length of the topic name
+ * @param qos Quality of Service of the messages
+ * @param isRetained Retained flag of the messages
+ *
+ * @return NULL_VALUE_ERROR for a NULL or empty input, MAX_SIZE_ERROR if the topic
+ *   is longer than AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN, FAILURE if the topic holds a wildcard,
+ *   otherwise SUCCESS
+ */
+IoT_Error_t aws_iot_mqtt_publish_handle_create(IoT_Publish_Handle *pHandle, const char *pTopicName,
+											   uint16_t topicNameLen, QoS qos, uint8_t isRetained) {
+	IoT_Error_t rc;
+	uint16_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pHandle || NULL == pTopicName || 0 == topicNameLen) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	rc = aws_iot_mqtt_set_client_state(pClient, clientState, CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS);
+	/* Topic names of publishes must not hold wildcards, MQTT v3.1.1 Specification 3.3.2.1 */
+	for(i = 0; i < topicNameLen; i++) {
+		if('+' == pTopicName[i] || '#' == pTopicName[i]) {
+			FUNC_EXIT_RC(FAILURE);
+		}
+	}
+
+	if(AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN < topicNameLen) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
+	rc = _aws_iot_mqtt_internal_encode_publish_prefix(pHandle->prefix, &pHandle->variableHeaderLen, topicNameLen,
+													  qos, isRetained);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
+	memcpy(&pHandle->prefix[3], pTopicName, topicNameLen);
+	pHandle->prefixLen = (uint16_t) (topicNameLen + 3);
+	pHandle->qos = qos;
+
+	FUNC_EXIT_RC(rc);
+}
 
-	pubRc = _aws_iot_mqtt_internal_publish(pClient, pTopicName, topicNameLen, pParams);
+/**
+ * @brief Publish an MQTT message on the topic of a publish handle
+ *
+ * Same behavior as aws_iot_mqtt_publish, without validating and encoding the topic again.
+ *
+ * @param pClient Reference to the IoT Client
+ * @param pHandle Handle created by aws_iot_mqtt_publish_handle_create
+ * @param pPayload Payload of the message
+ * @param payloadLen Length of the payload
+ * @param pPacketId Set to the packet identifier of a QoS 1 publish, 0 for QoS 0. May be NULL
+ *
+ * @return An IoT Error Type defining successful/failed publish
+ */
+IoT_Error_t aws_iot_mqtt_publish_with_handle(AWS_IoT_Client *pClient, const IoT_Publish_Handle *pHandle,
+											 const void *pPayload, size_t payloadLen, uint16_t *pPacketId) {
+	IoT_Error_t rc;
+	uint16_t packetId = 0;
+	_PublishEncoding encoding;
 
-	rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS, clientState);
-	if(SUCCESS == pubRc && SUCCESS != rc) {
-		pubRc = rc;
+	FUNC_ENTRY;
+
+	if(NULL == pClient || NULL == pHandle || NULL == pPayload) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	_aws_iot_mqtt_internal_encoding_from_handle(&encoding, pHandle);
+	rc = _aws_iot_mqtt_publish_in_state(pClient, &encoding, pPayload, payloadLen, &packetId);
+	if(NULL != pPacketId) {
+		*pPacketId = packetId;
 	}
 
-	FUNC_EXIT_RC(pubRc);
+	FUNC_EXIT_RC(rc);
 }
 
 /**
@@ -39,6 +39,8 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include "aws_iot_mqtt_client_common_internal.h"
 
 /**
@@ -176,7 +178,7 @@ static uint32_t _aws_iot_mqtt_get_free_message_handler_index(AWS_IoT_Client *pCl
 	FUNC_ENTRY;
 
 	for(itr = 0; itr < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; itr++) {
-		if(pClient->clientData.messageHandlers[itr].topicName == NULL) {
+		if(pClient->clientData.messageHandlers.topicName[itr] == NULL) {
 			break;
 		}
 	}
@@ -235,6 +237,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, con
 	}
 
 	/* send the subscribe packet */
+	IOT_CLIENT_METRICS_TIMESTAMP(sendStartNs);
 	rc = aws_iot_mqtt_internal_send_packet(pClient, serializedLen, &timer);
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
@@ -252,6 +255,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, con
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
+	IOT_CLIENT_METRICS_RECORD_DURATION(pClient, subscribeAckLatency, sendStartNs);
 
 	/* TODO : Figure out how to test this before activating this check */
 	//if(txPacketId != rxPacketId) {
@@ -260,15 +264,15 @@ static IoT_Error_t _aws_iot_mqtt_internal_subscribe(AWS_IoT_Client *pClient, con
 	//	return RX_MESSAGE_INVALID_ERROR;
 	//}
 
-	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].topicName =
+	pClient->clientData.messageHandlers.topicName[indexOfFreeMessageHandler] =
 			pTopicName;
-	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].topicNameLen =
+	pClient->clientData.messageHandlers.topicNameLen[indexOfFreeMessageHandler] =
 			topicNameLen;
-	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].pApplicationHandler =
+	pClient->clientData.messageHandlers.pApplicationHandler[indexOfFreeMessageHandler] =
 			pApplicationHandler;
-	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].pApplicationHandlerData =
+	pClient->clientData.messageHandlers.pApplicationHandlerData[indexOfFreeMessageHandler] =
 			pApplicationHandlerData;
-	pClient->clientData.messageHandlers[indexOfFreeMessageHandler].qos = qos;
+	pClient->clientData.messageHandlers.qos[indexOfFreeMessageHandler] = qos;
 
 	FUNC_EXIT_RC(SUCCESS);
 }
@@ -357,7 +361,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_resubscribe(AWS_IoT_Client *pClient) {
 	existingSubCount = _aws_iot_mqtt_get_free_message_handler_index(pClient);
 
 	for(itr = 0; itr < existingSubCount; itr++) {
-		if(pClient->clientData.messageHandlers[itr].topicName == NULL) {
+		if(pClient->clientData.messageHandlers.topicName[itr] == NULL) {
 			continue;
 		}
 
@@ -366,9 +370,9 @@ static IoT_Error_t _aws_iot_mqtt_internal_resubscribe(AWS_IoT_Client *pClient) {
 
 		rc = _aws_iot_mqtt_serialize_subscribe(pClient->clientData.writeBuf, pClient->clientData.writeBufSize, 0,
 											   aws_iot_mqtt_get_next_packet_id(pClient), 1,
-											   &(pClient->clientData.messageHandlers[itr].topicName),
-											   &(pClient->clientData.messageHandlers[itr].topicNameLen),
-											   &(pClient->clientData.messageHandlers[itr].qos), &len);
+											   &(pClient->clientData.messageHandlers.topicName[itr]),
+											   &(pClient->clientData.messageHandlers.topicNameLen[itr]),
+											   &(pClient->clientData.messageHandlers.qos[itr]), &len);
 		if(SUCCESS != rc) {
 			FUNC_EXIT_RC(rc);
 		}
@@ -39,6 +39,8 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include "aws_iot_mqtt_client_common_internal.h"
 
 /**
@@ -146,8 +148,8 @@ static IoT_Error_t _aws_iot_mqtt_internal_unsubscribe(AWS_IoT_Client *pClient, c
 
 	/* Remove from message handler array */
 	for(i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++i) {
-		if(pClient->clientData.messageHandlers[i].topicName != NULL &&
-		   (strcmp(pClient->clientData.messageHandlers[i].topicName, pTopicFilter) == 0)) {
+		if(pClient->clientData.messageHandlers.topicName[i] != NULL &&
+		   (strcmp(pClient->clientData.messageHandlers.topicName[i], pTopicFilter) == 0)) {
 			subscriptionExists = true;
             break;
 		}
@@ -185,9 +187,9 @@ static IoT_Error_t _aws_iot_mqtt_internal_unsubscribe(AWS_IoT_Client *pClient, c
 
 	/* Remove from message handler array */
 	for(i = 0; i < AWS_IOT_MQTT_NUM_SUBSCRIBE_HANDLERS; ++i) {
-		if(pClient->clientData.messageHandlers[i].topicName != NULL &&
-		   (strcmp(pClient->clientData.messageHandlers[i].topicName, pTopicFilter) == 0)) {
-			pClient->clientData.messageHandlers[i].topicName = NULL;
+		if(pClient->clientData.messageHandlers.topicName[i] != NULL &&
+		   (strcmp(pClient->clientData.messageHandlers.topicName[i], pTopicFilter) == 0)) {
+			pClient->clientData.messageHandlers.topicName[i] = NULL;
 			/* We don't want to break here, in case the same topic is registered
              * with 2 callbacks. Unlikely scenario */
 		}
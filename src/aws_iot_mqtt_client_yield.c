@@ -39,13 +39,15 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_MQTT
+
 #include "aws_iot_mqtt_client_common_internal.h"
 
 /**
   * This is for the case when the aws_iot_mqtt_internal_send_packet Fails.
   */
 static void _aws_iot_mqtt_force_client_disconnect(AWS_IoT_Client *pClient) {
-	pClient->clientStatus.clientState = CLIENT_STATE_DISCONNECTED_ERROR;
+	IOT_CLIENT_STATE_STORE(pClient, CLIENT_STATE_DISCONNECTED_ERROR);
 	pClient->networkStack.disconnect(&(pClient->networkStack));
 	pClient->networkStack.destroy(&(pClient->networkStack));
 }
@@ -66,7 +68,7 @@ static IoT_Error_t _aws_iot_mqtt_handle_disconnect(AWS_IoT_Client *pClient) {
 	}
 
 	/* Reset to 0 since this was not a manual disconnect */
-	pClient->clientStatus.clientState = CLIENT_STATE_DISCONNECTED_ERROR;
+	IOT_CLIENT_STATE_STORE(pClient, CLIENT_STATE_DISCONNECTED_ERROR);
 	FUNC_EXIT_RC(NETWORK_DISCONNECTED_ERROR);
 }
 
@@ -178,6 +180,18 @@ static IoT_Error_t _aws_iot_mqtt_keep_alive(AWS_IoT_Client *pClient) {
  *         iot_is_mqtt_connected can be called to confirm.
  */
 
+/* Clears a wakeup requested with aws_iot_mqtt_wakeup and returns whether there was one */
+static bool _aws_iot_mqtt_take_wakeup(AWS_IoT_Client *pClient) {
+#ifdef _ENABLE_THREAD_SUPPORT_
+	return __atomic_exchange_n(&(pClient->clientData.isWakeupPending), false, __ATOMIC_ACQ_REL);
+#else
+	bool isWakeupPending = pClient->clientData.isWakeupPending;
+
+	pClient->clientData.isWakeupPending = false;
+	return isWakeupPending;
+#endif
+}
+
 static IoT_Error_t _aws_iot_mqtt_internal_yield(AWS_IoT_Client *pClient, uint32_t timeout_ms) {
 	IoT_Error_t yieldRc = SUCCESS;
 
@@ -189,7 +203,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_yield(AWS_IoT_Client *pClient, uint32_
 
 	FUNC_ENTRY;
 
-	// evaluate timeout at the end of the loop to make sure the actual yield runs at least once
+	// evaluate timeout and wakeup at the end of the loop to make sure the actual yield runs at least once
 	do {
 		clientState = aws_iot_mqtt_get_client_state(pClient);
 		if(CLIENT_STATE_PENDING_RECONNECT == clientState) {
@@ -234,7 +248,7 @@ static IoT_Error_t _aws_iot_mqtt_internal_yield(AWS_IoT_Client *pClient, uint32_
 		} else if(SUCCESS != yieldRc) {
 			break;
 		}
-	} while(!has_timer_expired(&timer));
+	} while(!_aws_iot_mqtt_take_wakeup(pClient) && !has_timer_expired(&timer));
 
 	FUNC_EXIT_RC(yieldRc);
 }
@@ -292,7 +306,9 @@ IoT_Error_t aws_iot_mqtt_yield(AWS_IoT_Client *pClient, uint32_t timeout_ms) {
 		}
 	}
 
+	IOT_CLIENT_METRICS_TIMESTAMP(yieldStartNs);
 	yieldRc = _aws_iot_mqtt_internal_yield(pClient, timeout_ms);
+	IOT_CLIENT_METRICS_RECORD_DURATION(pClient, yieldDuration, yieldStartNs);
 
 	if(NETWORK_DISCONNECTED_ERROR != yieldRc && NETWORK_ATTEMPTING_RECONNECT != yieldRc) {
 		rc = aws_iot_mqtt_set_client_state(pClient, CLIENT_STATE_CONNECTED_YIELD_IN_PROGRESS,
@@ -305,6 +321,28 @@ IoT_Error_t aws_iot_mqtt_yield(AWS_IoT_Client *pClient, uint32_t timeout_ms) {
 	FUNC_EXIT_RC(yieldRc);
 }
 
+IoT_Error_t aws_iot_mqtt_wakeup(AWS_IoT_Client *pClient) {
+	IoT_Error_t rc = SUCCESS;
+
+	FUNC_ENTRY;
+
+	if(NULL == pClient) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	/* The flag ends the yield loop, the network wakeup ends the read it is waiting in */
+#ifdef _ENABLE_THREAD_SUPPORT_
+	__atomic_store_n(&(pClient->clientData.isWakeupPending), true, __ATOMIC_RELEASE);
+#else
+	pClient->clientData.isWakeupPending = true;
+#endif
+	if(NULL != pClient->networkStack.wakeup) {
+		rc = pClient->networkStack.wakeup(&(pClient->networkStack));
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_profile.c
+ * @brief Per-function profiling driven by FUNC_ENTRY and FUNC_EXIT_RC
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ENABLE_IOT_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "aws_iot_profile.h"
+#include "timer_interface.h"
+
+#if (AWS_IOT_PROFILE_MAX_FUNCTIONS & (AWS_IOT_PROFILE_MAX_FUNCTIONS - 1)) != 0
+#error "AWS_IOT_PROFILE_MAX_FUNCTIONS must be a power of two"
+#endif
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+#define PROFILE_THREAD_LOCAL __thread
+#else
+#define PROFILE_THREAD_LOCAL
+#endif
+
+typedef struct {
+	const char *pFunction;
+	uint64_t startNs;
+} ProfileFrame_t;
+
+typedef struct {
+	uint32_t depth;
+	ProfileFrame_t stack[AWS_IOT_PROFILE_STACK_DEPTH];
+	IoT_Profile_Entry_t functions[AWS_IOT_PROFILE_MAX_FUNCTIONS];
+} ProfileThreadData_t;
+
+static ProfileThreadData_t profileThreads[AWS_IOT_PROFILE_MAX_THREADS];
+static uint32_t profileThreadCount;
+static uint32_t profileOverflowCount;
+
+static PROFILE_THREAD_LOCAL ProfileThreadData_t *pProfileThread;
+static PROFILE_THREAD_LOCAL uint8_t isProfileThreadUnavailable;
+
+static ProfileThreadData_t *_aws_iot_profile_get_thread_data(void) {
+	uint32_t index;
+
+	if(NULL != pProfileThread) {
+		return pProfileThread;
+	}
+	if(isProfileThreadUnavailable) {
+		return NULL;
+	}
+
+	index = __atomic_fetch_add(&profileThreadCount, 1, __ATOMIC_RELAXED);
+	if(index >= AWS_IOT_PROFILE_MAX_THREADS) {
+		isProfileThreadUnavailable = 1;
+		__atomic_fetch_add(&profileOverflowCount, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	pProfileThread = &profileThreads[index];
+	return pProfileThread;
+}
+
+static IoT_Profile_Entry_t *_aws_iot_profile_find_function(ProfileThreadData_t *pThread, const char *pFunction) {
+	/* __func__ is a unique static array per function so its address is the key */
+	uint32_t slot = (uint32_t) (((uintptr_t) pFunction >> 2) * 2654435761u);
+	uint32_t probes;
+	IoT_Profile_Entry_t *pEntry;
+
+	for(probes = 0; probes < AWS_IOT_PROFILE_MAX_FUNCTIONS; probes++, slot++) {
+		pEntry = &pThread->functions[slot & (AWS_IOT_PROFILE_MAX_FUNCTIONS - 1)];
+		if(pFunction == pEntry->pFunction) {
+			return pEntry;
+		}
+		if(NULL == pEntry->pFunction) {
+			pEntry->pFunction = pFunction;
+			return pEntry;
+		}
+	}
+
+	return NULL;
+}
+
+void aws_iot_profile_enter(const char *pFunction) {
+	ProfileThreadData_t *pThread = _aws_iot_profile_get_thread_data();
+
+	if(NULL == pThread) {
+		return;
+	}
+
+	if(AWS_IOT_PROFILE_STACK_DEPTH == pThread->depth) {
+		/* Most likely frames left behind by early returns, drop the oldest */
+		memmove(&pThread->stack[0], &pThread->stack[1], sizeof(ProfileFrame_t) * (AWS_IOT_PROFILE_STACK_DEPTH - 1));
+		pThread->depth--;
+		__atomic_fetch_add(&profileOverflowCount, 1, __ATOMIC_RELAXED);
+	}
+
+	pThread->stack[pThread->depth].pFunction = pFunction;
+	pThread->stack[pThread->depth].startNs = get_monotonic_time_ns();
+	pThread->depth++;
+}
+
+void aws_iot_profile_exit(const char *pFunction) {
+	uint64_t nowNs = get_monotonic_time_ns();
+	uint64_t elapsedNs;
+	ProfileThreadData_t *pThread = pProfileThread;
+	IoT_Profile_Entry_t *pEntry;
+	uint32_t i;
+
+	if(NULL == pThread) {
+		return;
+	}
+
+	for(i = pThread->depth; i > 0; i--) {
+		if(pFunction == pThread->stack[i - 1].pFunction) {
+			break;
+		}
+	}
+	if(0 == i) {
+		/* No matching FUNC_ENTRY */
+		return;
+	}
+
+	/* Frames above the match returned without FUNC_EXIT_RC */
+	pThread->depth = i - 1;
+	elapsedNs = nowNs - pThread->stack[i - 1].startNs;
+
+	pEntry = _aws_iot_profile_find_function(pThread, pFunction);
+	if(NULL == pEntry) {
+		__atomic_fetch_add(&profileOverflowCount, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	pEntry->callCount++;
+	pEntry->totalNs += elapsedNs;
+	if(elapsedNs > pEntry->maxNs) {
+		pEntry->maxNs = elapsedNs;
+	}
+}
+
+size_t aws_iot_profile_get_report(IoT_Profile_Entry_t *pEntries, size_t maxEntries) {
+	IoT_Profile_Entry_t merged[AWS_IOT_PROFILE_MAX_FUNCTIONS];
+	IoT_Profile_Entry_t current;
+	const IoT_Profile_Entry_t *pSource;
+	size_t mergedCount = 0, i, j;
+	uint32_t threadCount, t;
+
+	if(NULL == pEntries || 0 == maxEntries) {
+		return 0;
+	}
+
+	threadCount = __atomic_load_n(&profileThreadCount, __ATOMIC_RELAXED);
+	if(threadCount > AWS_IOT_PROFILE_MAX_THREADS) {
+		threadCount = AWS_IOT_PROFILE_MAX_THREADS;
+	}
+
+	for(t = 0; t < threadCount; t++) {
+		for(i = 0; i < AWS_IOT_PROFILE_MAX_FUNCTIONS; i++) {
+			pSource = &profileThreads[t].functions[i];
+			if(NULL == pSource->pFunction || 0 == pSource->callCount) {
+				continue;
+			}
+			for(j = 0; j < mergedCount; j++) {
+				if(merged[j].pFunction == pSource->pFunction) {
+					break;
+				}
+			}
+			if(j == mergedCount) {
+				if(AWS_IOT_PROFILE_MAX_FUNCTIONS == mergedCount) {
+					continue;
+				}
+				merged[j].pFunction = pSource->pFunction;
+				merged[j].callCount = 0;
+				merged[j].totalNs = 0;
+				merged[j].maxNs = 0;
+				mergedCount++;
+			}
+			merged[j].callCount += pSource->callCount;
+			merged[j].totalNs += pSource->totalNs;
+			if(pSource->maxNs > merged[j].maxNs) {
+				merged[j].maxNs = pSource->maxNs;
+			}
+		}
+	}
+
+	/* Insertion sort, hottest first */
+	for(i = 1; i < mergedCount; i++) {
+		current = merged[i];
+		for(j = i; j > 0 && merged[j - 1].totalNs < current.totalNs; j--) {
+			merged[j] = merged[j - 1];
+		}
+		merged[j] = current;
+	}
+
+	if(mergedCount > maxEntries) {
+		mergedCount = maxEntries;
+	}
+	memcpy(pEntries, merged, mergedCount * sizeof(IoT_Profile_Entry_t));
+
+	return mergedCount;
+}
+
+void aws_iot_profile_print_report(size_t maxEntries) {
+	IoT_Profile_Entry_t entries[AWS_IOT_PROFILE_MAX_FUNCTIONS];
+	size_t count, i;
+
+	if(maxEntries > AWS_IOT_PROFILE_MAX_FUNCTIONS) {
+		maxEntries = AWS_IOT_PROFILE_MAX_FUNCTIONS;
+	}
+	count = aws_iot_profile_get_report(entries, maxEntries);
+
+	printf("%-48s %10s %14s %12s %12s\n", "function", "calls", "total(ms)", "avg(us)", "max(us)");
+	for(i = 0; i < count; i++) {
+		printf("%-48s %10u %14.3f %12.3f %12.3f\n", entries[i].pFunction, (unsigned int) entries[i].callCount,
+			   (double) entries[i].totalNs / 1000000.0,
+			   (double) entries[i].totalNs / 1000.0 / (double) entries[i].callCount,
+			   (double) entries[i].maxNs / 1000.0);
+	}
+	if(0 != profileOverflowCount) {
+		printf("%u samples lost, consider raising the AWS_IOT_PROFILE_* limits\n", (unsigned int) profileOverflowCount);
+	}
+}
+
+void aws_iot_profile_reset(void) {
+	uint32_t t;
+
+	for(t = 0; t < AWS_IOT_PROFILE_MAX_THREADS; t++) {
+		memset(profileThreads[t].functions, 0, sizeof(profileThreads[t].functions));
+	}
+	__atomic_store_n(&profileOverflowCount, 0, __ATOMIC_RELAXED);
+}
+
+uint32_t aws_iot_profile_get_overflow_count(void) {
+	return __atomic_load_n(&profileOverflowCount, __ATOMIC_RELAXED);
+}
+
+#endif /* ENABLE_IOT_PROFILE */
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,15 +22,21 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
 #include <string.h>
 #include "aws_iot_mqtt_client_interface.h"
-#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_client.h"
 #include "aws_iot_error.h"
 #include "aws_iot_log.h"
 #include "aws_iot_shadow_actions.h"
+#include "aws_iot_shadow_coalesce.h"
 #include "aws_iot_shadow_json.h"
 #include "aws_iot_shadow_key.h"
+#include "aws_iot_shadow_mirror.h"
 #include "aws_iot_shadow_records.h"
+#include "aws_iot_shadow_reported_cache.h"
+#include "aws_iot_shadow_topics.h"
 
 const ShadowInitParameters_t ShadowInitParametersDefault = {(char *) AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, NULL, NULL,
 															NULL, false, NULL};
@@ -38,22 +44,54 @@ const ShadowInitParameters_t ShadowInitParametersDefault = {(char *) AWS_IOT_MQT
 const ShadowConnectParameters_t ShadowConnectParametersDefault = {(char *) AWS_IOT_MY_THING_NAME,
 								  (char *) AWS_IOT_MQTT_CLIENT_ID, 0, NULL};
 
-static char deleteAcceptedTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+ShadowClient_t defaultShadowClient;
+
+ShadowClient_t *getDefaultShadowClient(AWS_IoT_Client *pClient) {
+	if(NULL == pClient) {
+		return NULL;
+	}
+
+	/* The legacy API passes the MQTT client to every call, the default context follows it */
+	defaultShadowClient.pMqttClient = pClient;
+	return &defaultShadowClient;
+}
 
 void aws_iot_shadow_reset_last_received_version(void) {
-	shadowJsonVersionNum = 0;
+	aws_iot_shadow_client_reset_last_received_version(&defaultShadowClient);
+}
+
+void aws_iot_shadow_client_reset_last_received_version(ShadowClient_t *pShadow) {
+	if(NULL != pShadow) {
+		pShadow->jsonVersionNum = 0;
+	}
 }
 
 uint32_t aws_iot_shadow_get_last_received_version(void) {
-	return shadowJsonVersionNum;
+	return aws_iot_shadow_client_get_last_received_version(&defaultShadowClient);
+}
+
+uint32_t aws_iot_shadow_client_get_last_received_version(ShadowClient_t *pShadow) {
+	return (NULL != pShadow) ? pShadow->jsonVersionNum : 0;
 }
 
 void aws_iot_shadow_enable_discard_old_delta_msgs(void) {
-	shadowDiscardOldDeltaFlag = true;
+	aws_iot_shadow_client_enable_discard_old_delta_msgs(&defaultShadowClient);
+}
+
+void aws_iot_shadow_client_enable_discard_old_delta_msgs(ShadowClient_t *pShadow) {
+	if(NULL != pShadow) {
+		pShadow->discardOldDeltaFlag = true;
+	}
 }
 
 void aws_iot_shadow_disable_discard_old_delta_msgs(void) {
-	shadowDiscardOldDeltaFlag = false;
+	aws_iot_shadow_client_disable_discard_old_delta_msgs(&defaultShadowClient);
+}
+
+void aws_iot_shadow_client_disable_discard_old_delta_msgs(ShadowClient_t *pShadow) {
+	if(NULL != pShadow) {
+		pShadow->discardOldDeltaFlag = false;
+	}
 }
 
 IoT_Error_t aws_iot_shadow_free(AWS_IoT_Client *pClient)
@@ -69,13 +107,26 @@ IoT_Error_t aws_iot_shadow_free(AWS_IoT_Client *pClient)
     FUNC_EXIT_RC(rc);
 }
 
+IoT_Error_t aws_iot_shadow_client_free(ShadowClient_t *pShadow) {
+	if(NULL == pShadow) {
+		return NULL_VALUE_ERROR;
+	}
+
+	return aws_iot_shadow_free(pShadow->pMqttClient);
+}
+
 IoT_Error_t aws_iot_shadow_init(AWS_IoT_Client *pClient, ShadowInitParameters_t *pParams) {
+	return aws_iot_shadow_client_init(&defaultShadowClient, pClient, pParams);
+}
+
+IoT_Error_t aws_iot_shadow_client_init(ShadowClient_t *pShadow, AWS_IoT_Client *pClient,
+									   ShadowInitParameters_t *pParams) {
 	IoT_Client_Init_Params mqttInitParams = IoT_Client_Init_Params_initializer;
 	IoT_Error_t rc;
 
 	FUNC_ENTRY;
 
-	if(NULL == pClient || NULL == pParams) {
+	if(NULL == pShadow || NULL == pClient || NULL == pParams) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
@@ -96,26 +147,38 @@ IoT_Error_t aws_iot_shadow_init(AWS_IoT_Client *pClient, ShadowInitParameters_t
 		FUNC_EXIT_RC(rc);
 	}
 
-	resetClientTokenSequenceNum();
-	aws_iot_shadow_reset_last_received_version();
-	initDeltaTokens();
+	initializeRecords(pShadow, pClient);
+	pShadow->clientTokenNum = 0;
+	pShadow->discardOldDeltaFlag = true;
+	aws_iot_shadow_client_reset_last_received_version(pShadow);
+	initDeltaTokens(pShadow);
+	initReportedCache(pShadow);
+	initCoalescedUpdates(pShadow);
+	initShadowMirrors(pShadow);
 
 	FUNC_EXIT_RC(SUCCESS);
 }
 
 IoT_Error_t aws_iot_shadow_connect(AWS_IoT_Client *pClient, ShadowConnectParameters_t *pParams) {
+	return aws_iot_shadow_client_connect(getDefaultShadowClient(pClient), pParams);
+}
+
+IoT_Error_t aws_iot_shadow_client_connect(ShadowClient_t *pShadow, ShadowConnectParameters_t *pParams) {
 	IoT_Error_t rc = SUCCESS;
 	uint16_t deleteAcceptedTopicLen;
+	const ShadowTopicTable_t *pMyTopics;
+	const char *pDeleteAcceptedTopic;
 	IoT_Client_Connect_Params ConnectParams = iotClientConnectParamsDefault;
 
 	FUNC_ENTRY;
 
-	if(NULL == pClient || NULL == pParams || NULL == pParams->pMqttClientId) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient || NULL == pParams || NULL == pParams->pMqttClientId) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	snprintf(myThingName, MAX_SIZE_OF_THING_NAME, "%s", pParams->pMyThingName);
-	snprintf(mqttClientID, MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES, "%s", pParams->pMqttClientId);
+	snprintf(pShadow->myThingName, MAX_SIZE_OF_THING_NAME, "%s", pParams->pMyThingName);
+	snprintf(pShadow->mqttClientID, MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES, "%s", pParams->pMqttClientId);
+	pShadow->mqttClientIDLength = (uint16_t) strlen(pShadow->mqttClientID);
 
 	ConnectParams.keepAliveIntervalInSec = 600; // NOTE: Temporary fix
 	ConnectParams.MQTTVersion = MQTT_3_1_1;
@@ -126,117 +189,176 @@ IoT_Error_t aws_iot_shadow_connect(AWS_IoT_Client *pClient, ShadowConnectParamet
 	ConnectParams.pPassword = NULL;
 	ConnectParams.pUsername = NULL;
 
-	rc = aws_iot_mqtt_connect(pClient, &ConnectParams);
+	rc = aws_iot_mqtt_connect(pShadow->pMqttClient, &ConnectParams);
 
 	if(SUCCESS != rc) {
 		FUNC_EXIT_RC(rc);
 	}
 
-	initializeRecords(pClient);
+	initializeRecords(pShadow, pShadow->pMqttClient);
+	/* Takes the first topic table, kept for the client thing until the next connect */
+	pMyTopics = getShadowTopicTable(pShadow, pShadow->myThingName);
 
 	if(NULL != pParams->deleteActionHandler) {
-		snprintf(deleteAcceptedTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES,
-				 "$aws/things/%s/shadow/delete/accepted", myThingName);
-		deleteAcceptedTopicLen = (uint16_t) strlen(deleteAcceptedTopic);
-		rc = aws_iot_mqtt_subscribe(pClient, deleteAcceptedTopic, deleteAcceptedTopicLen, QOS1,
-									pParams->deleteActionHandler, (void *) myThingName);
+		pDeleteAcceptedTopic = getShadowTopic(pMyTopics, SHADOW_DELETE, SHADOW_ACCEPTED, &deleteAcceptedTopicLen);
+		memcpy(pShadow->deleteAcceptedTopic, pDeleteAcceptedTopic, (size_t) deleteAcceptedTopicLen + 1);
+		rc = aws_iot_mqtt_subscribe(pShadow->pMqttClient, pShadow->deleteAcceptedTopic, deleteAcceptedTopicLen, QOS1,
+									pParams->deleteActionHandler, (void *) pShadow->myThingName);
 	}
 
 	FUNC_EXIT_RC(rc);
 }
 
 IoT_Error_t aws_iot_shadow_register_delta(AWS_IoT_Client *pMqttClient, jsonStruct_t *pStruct) {
-	if(NULL == pMqttClient || NULL == pStruct) {
+	return aws_iot_shadow_client_register_delta(getDefaultShadowClient(pMqttClient), pStruct);
+}
+
+IoT_Error_t aws_iot_shadow_client_register_delta(ShadowClient_t *pShadow, jsonStruct_t *pStruct) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient || NULL == pStruct) {
+		return NULL_VALUE_ERROR;
+	}
+
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
+		return MQTT_CONNECTION_ERROR;
+	}
+
+	return registerJsonTokenOnDelta(pShadow, pStruct);
+}
+
+IoT_Error_t aws_iot_shadow_register_delta_schema(AWS_IoT_Client *pMqttClient, ShadowSchemaDelta_t *pSchemaDelta) {
+	return aws_iot_shadow_client_register_delta_schema(getDefaultShadowClient(pMqttClient), pSchemaDelta);
+}
+
+IoT_Error_t aws_iot_shadow_client_register_delta_schema(ShadowClient_t *pShadow, ShadowSchemaDelta_t *pSchemaDelta) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient || NULL == pSchemaDelta || NULL == pSchemaDelta->parse
+	   || NULL == pSchemaDelta->pState) {
 		return NULL_VALUE_ERROR;
 	}
 
-	if(!aws_iot_mqtt_is_client_connected(pMqttClient)) {
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
 		return MQTT_CONNECTION_ERROR;
 	}
 
-	return registerJsonTokenOnDelta(pStruct);
+	return registerSchemaOnDelta(pShadow, pSchemaDelta);
 }
 
 IoT_Error_t aws_iot_shadow_yield(AWS_IoT_Client *pClient, uint32_t timeout) {
-	if(NULL == pClient) {
+	return aws_iot_shadow_client_yield(getDefaultShadowClient(pClient), timeout);
+}
+
+IoT_Error_t aws_iot_shadow_client_yield(ShadowClient_t *pShadow, uint32_t timeout) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient) {
 		return NULL_VALUE_ERROR;
 	}
 
-	HandleExpiredResponseCallbacks();
-	return aws_iot_mqtt_yield(pClient, timeout);
+	HandleExpiredResponseCallbacks(pShadow);
+	handleExpiredCoalescedUpdates(pShadow);
+	handleShadowMirrorSnapshots(pShadow);
+	return aws_iot_mqtt_yield(pShadow->pMqttClient, timeout);
 }
 
 IoT_Error_t aws_iot_shadow_disconnect(AWS_IoT_Client *pClient) {
 	return aws_iot_mqtt_disconnect(pClient);
 }
 
+IoT_Error_t aws_iot_shadow_client_disconnect(ShadowClient_t *pShadow) {
+	if(NULL == pShadow) {
+		return NULL_VALUE_ERROR;
+	}
+
+	return aws_iot_mqtt_disconnect(pShadow->pMqttClient);
+}
+
 IoT_Error_t aws_iot_shadow_update(AWS_IoT_Client *pClient, const char *pThingName, char *pJsonString,
 								  fpActionCallback_t callback, void *pContextData, uint8_t timeout_seconds,
 								  bool isPersistentSubscribe) {
+	return aws_iot_shadow_client_update(getDefaultShadowClient(pClient), pThingName, pJsonString, callback,
+										pContextData, timeout_seconds, isPersistentSubscribe);
+}
+
+IoT_Error_t aws_iot_shadow_client_update(ShadowClient_t *pShadow, const char *pThingName, char *pJsonString,
+										 fpActionCallback_t callback, void *pContextData, uint8_t timeout_seconds,
+										 bool isPersistentSubscribe) {
 	IoT_Error_t rc;
 
-	if(NULL == pClient) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	if(!aws_iot_mqtt_is_client_connected(pClient)) {
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
 		FUNC_EXIT_RC(MQTT_CONNECTION_ERROR);
 	}
 
-	rc = aws_iot_shadow_internal_action(pThingName, SHADOW_UPDATE, pJsonString, strlen(pJsonString), callback, pContextData,
-										timeout_seconds, isPersistentSubscribe);
+	rc = aws_iot_shadow_internal_client_action(pShadow, pThingName, SHADOW_UPDATE, pJsonString, strlen(pJsonString),
+											   callback, pContextData, timeout_seconds, isPersistentSubscribe);
 
 	FUNC_EXIT_RC(rc);
 }
 
 IoT_Error_t aws_iot_shadow_delete(AWS_IoT_Client *pClient, const char *pThingName, fpActionCallback_t callback,
 								  void *pContextData, uint8_t timeout_seconds, bool isPersistentSubscribe) {
+	return aws_iot_shadow_client_delete(getDefaultShadowClient(pClient), pThingName, callback, pContextData,
+										timeout_seconds, isPersistentSubscribe);
+}
+
+IoT_Error_t aws_iot_shadow_client_delete(ShadowClient_t *pShadow, const char *pThingName, fpActionCallback_t callback,
+										 void *pContextData, uint8_t timeout_seconds, bool isPersistentSubscribe) {
 	char deleteRequestJsonBuf[MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE];
 	IoT_Error_t rc;
 
 	FUNC_ENTRY;
 
-	if(NULL == pClient) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	if(!aws_iot_mqtt_is_client_connected(pClient)) {
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
 		FUNC_EXIT_RC(MQTT_CONNECTION_ERROR);
 	}
 
-	rc = aws_iot_shadow_internal_delete_request_json(deleteRequestJsonBuf, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE );
+	rc = aws_iot_shadow_internal_client_delete_request_json(pShadow, deleteRequestJsonBuf,
+															MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE);
     if ( SUCCESS != rc ) {
         FUNC_EXIT_RC( rc );
     }
 
-	rc = aws_iot_shadow_internal_action(pThingName, SHADOW_DELETE, deleteRequestJsonBuf, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE, callback, pContextData,
-										timeout_seconds, isPersistentSubscribe);
+	rc = aws_iot_shadow_internal_client_action(pShadow, pThingName, SHADOW_DELETE, deleteRequestJsonBuf,
+											   MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE, callback, pContextData,
+											   timeout_seconds, isPersistentSubscribe);
 
 	FUNC_EXIT_RC(rc);
 }
 
 IoT_Error_t aws_iot_shadow_get(AWS_IoT_Client *pClient, const char *pThingName, fpActionCallback_t callback,
 							   void *pContextData, uint8_t timeout_seconds, bool isPersistentSubscribe) {
+	return aws_iot_shadow_client_get(getDefaultShadowClient(pClient), pThingName, callback, pContextData,
+									 timeout_seconds, isPersistentSubscribe);
+}
+
+IoT_Error_t aws_iot_shadow_client_get(ShadowClient_t *pShadow, const char *pThingName, fpActionCallback_t callback,
+									  void *pContextData, uint8_t timeout_seconds, bool isPersistentSubscribe) {
 	char getRequestJsonBuf[MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE];
 	IoT_Error_t rc;
 
 	FUNC_ENTRY;
 
-	if(NULL == pClient) {
+	if(NULL == pShadow || NULL == pShadow->pMqttClient) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	if(!aws_iot_mqtt_is_client_connected(pClient)) {
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
 		FUNC_EXIT_RC(MQTT_CONNECTION_ERROR);
 	}
 
-    rc = aws_iot_shadow_internal_get_request_json(getRequestJsonBuf, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE );
+    rc = aws_iot_shadow_internal_client_get_request_json(pShadow, getRequestJsonBuf,
+														 MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE);
     if (SUCCESS != rc) {
         FUNC_EXIT_RC(rc);
     }
 
-	rc = aws_iot_shadow_internal_action(pThingName, SHADOW_GET, getRequestJsonBuf, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE, callback, pContextData,
-										timeout_seconds, isPersistentSubscribe);
+	rc = aws_iot_shadow_internal_client_action(pShadow, pThingName, SHADOW_GET, getRequestJsonBuf,
+											   MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE, callback, pContextData,
+											   timeout_seconds, isPersistentSubscribe);
 	FUNC_EXIT_RC(rc);
 }
 
@@ -244,6 +366,14 @@ IoT_Error_t aws_iot_shadow_set_autoreconnect_status(AWS_IoT_Client *pClient, boo
 	return aws_iot_mqtt_autoreconnect_set_status(pClient, newStatus);
 }
 
+IoT_Error_t aws_iot_shadow_client_set_autoreconnect_status(ShadowClient_t *pShadow, bool newStatus) {
+	if(NULL == pShadow) {
+		return NULL_VALUE_ERROR;
+	}
+
+	return aws_iot_mqtt_autoreconnect_set_status(pShadow->pMqttClient, newStatus);
+}
+
 #ifdef __cplusplus
 }
 #endif
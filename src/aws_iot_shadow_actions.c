@@ -22,6 +22,10 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
+#include <string.h>
+
 #include "aws_iot_shadow_actions.h"
 
 #include "aws_iot_log.h"
@@ -32,6 +36,14 @@ extern "C" {
 IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions_t action,
 										   const char *pJsonDocumentToBeSent, size_t jsonSize, fpActionCallback_t callback,
 										   void *pCallbackContext, uint32_t timeout_seconds, bool isSticky) {
+	return aws_iot_shadow_internal_client_action(&defaultShadowClient, pThingName, action, pJsonDocumentToBeSent,
+												 jsonSize, callback, pCallbackContext, timeout_seconds, isSticky);
+}
+
+IoT_Error_t aws_iot_shadow_internal_client_action(ShadowClient_t *pShadow, const char *pThingName,
+												  ShadowActions_t action, const char *pJsonDocumentToBeSent,
+												  size_t jsonSize, fpActionCallback_t callback,
+												  void *pCallbackContext, uint32_t timeout_seconds, bool isSticky) {
 	IoT_Error_t ret_val = SUCCESS;
 	bool isClientTokenPresent = false;
 	bool isAckWaitListFree = false;
@@ -40,22 +52,26 @@ IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions
 
 	FUNC_ENTRY;
 
-	if(NULL == pThingName || NULL == pJsonDocumentToBeSent) {
+	if(NULL == pShadow || NULL == pThingName || NULL == pJsonDocumentToBeSent) {
 		FUNC_EXIT_RC(NULL_VALUE_ERROR);
 	}
 
-	isClientTokenPresent = extractClientToken(pJsonDocumentToBeSent, jsonSize, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
+	if(strlen(pThingName) >= MAX_SIZE_OF_THING_NAME) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
+	isClientTokenPresent = extractClientToken(pJsonDocumentToBeSent, &(pShadow->jsonParser), jsonSize, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
 
 	if(isClientTokenPresent && (NULL != callback)) {
-		if(getNextFreeIndexOfAckWaitList(&indexAckWaitList)) {
+		if(getNextFreeIndexOfAckWaitList(pShadow, extractedClientToken, &indexAckWaitList)) {
 			isAckWaitListFree = true;
 		}
 
 		if(isAckWaitListFree) {
-			if(!isSubscriptionPresent(pThingName, action)) {
-				ret_val = subscribeToShadowActionAcks(pThingName, action, isSticky);
+			if(!isSubscriptionPresent(pShadow, pThingName, action)) {
+				ret_val = subscribeToShadowActionAcks(pShadow, pThingName, action, isSticky);
 			} else {
-				incrementSubscriptionCnt(pThingName, action, isSticky);
+				incrementSubscriptionCnt(pShadow, pThingName, action, isSticky);
 			}
 		}
 		else {
@@ -64,12 +80,12 @@ IoT_Error_t aws_iot_shadow_internal_action(const char *pThingName, ShadowActions
 	}
 
 	if(SUCCESS == ret_val) {
-		ret_val = publishToShadowAction(pThingName, action, pJsonDocumentToBeSent);
+		ret_val = publishToShadowAction(pShadow, pThingName, action, pJsonDocumentToBeSent);
 	}
 
 	if(isClientTokenPresent && (NULL != callback) && (SUCCESS == ret_val) && isAckWaitListFree) {
-		addToAckWaitList(indexAckWaitList, pThingName, action, extractedClientToken, callback, pCallbackContext,
-						 timeout_seconds);
+		addToAckWaitList(pShadow, indexAckWaitList, pThingName, action, extractedClientToken, callback,
+						 pCallbackContext, timeout_seconds);
 	}
 
 	FUNC_EXIT_RC(ret_val);
@@ -0,0 +1,431 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_coalesce.c
+ * @brief Merges the updates to the same thing into one document per window
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
+#include "aws_iot_shadow_coalesce.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "timer_interface.h"
+#include "aws_iot_json_writer.h"
+#include "aws_iot_log.h"
+#include "aws_iot_shadow_actions.h"
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_json.h"
+#include "aws_iot_shadow_key.h"
+#include "aws_iot_shadow_records.h"
+
+#if SHADOW_COALESCED_UPDATE_BUFFER_BYTES > UINT16_MAX
+#error "SHADOW_COALESCED_UPDATE_BUFFER_BYTES must fit the uint16_t field offsets"
+#endif
+
+#define COALESCED_SECTION_COUNT 2
+
+/* State of a pass over the reported and desired members of a queued document */
+typedef struct {
+	CoalescedUpdate_t *pUpdate;
+	uint8_t section;
+	bool isApplying;
+	uint32_t newFieldCount;
+	size_t newBytes;
+} CoalesceMerge_t;
+
+static const char *const sectionNames[COALESCED_SECTION_COUNT] = {"reported", "desired"};
+
+void initCoalescedUpdates(ShadowClient_t *pShadow) {
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_COALESCED_UPDATES; i++) {
+		pShadow->coalescedUpdates[i].state = COALESCED_UPDATE_FREE;
+	}
+	pShadow->coalesceWindowMs = SHADOW_COALESCE_WINDOW_MS;
+}
+
+void aws_iot_shadow_set_update_coalescing_window(uint32_t windowMs) {
+	aws_iot_shadow_client_set_update_coalescing_window(&defaultShadowClient, windowMs);
+}
+
+void aws_iot_shadow_client_set_update_coalescing_window(ShadowClient_t *pShadow, uint32_t windowMs) {
+	if(NULL != pShadow) {
+		pShadow->coalesceWindowMs = windowMs;
+	}
+}
+
+static CoalescedUpdate_t *findPendingUpdate(ShadowClient_t *pShadow, const char *pThingName) {
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_COALESCED_UPDATES; i++) {
+		if(COALESCED_UPDATE_PENDING == pShadow->coalescedUpdates[i].state &&
+		   strcmp(pShadow->coalescedUpdates[i].thingName, pThingName) == 0) {
+			return &(pShadow->coalescedUpdates[i]);
+		}
+	}
+	return NULL;
+}
+
+static CoalescedField_t *findField(CoalescedUpdate_t *pUpdate, uint8_t section, const char *pKey, size_t keyLength) {
+	uint8_t i;
+
+	if(NULL == pUpdate) {
+		return NULL;
+	}
+
+	for(i = 0; i < pUpdate->fieldCount; i++) {
+		if(pUpdate->fields[i].section == section && pUpdate->fields[i].keyLength == keyLength &&
+		   memcmp(pUpdate->buffer + pUpdate->fields[i].keyOffset, pKey, keyLength) == 0) {
+			return &(pUpdate->fields[i]);
+		}
+	}
+	return NULL;
+}
+
+static uint16_t appendToBuffer(CoalescedUpdate_t *pUpdate, const char *pText, size_t length) {
+	uint16_t offset = pUpdate->bufferUsed;
+
+	memcpy(pUpdate->buffer + offset, pText, length);
+	pUpdate->bufferUsed = (uint16_t) (pUpdate->bufferUsed + length);
+	return offset;
+}
+
+static bool mergeMember(const char *pJsonDocument, const jsmntok_t *pKey, const jsmntok_t *pValue, int32_t valueIndex,
+						void *pContext) {
+	CoalesceMerge_t *pMerge = (CoalesceMerge_t *) pContext;
+	const char *pKeyText = pJsonDocument + pKey->start;
+	size_t keyLength = (size_t) (pKey->end - pKey->start);
+	const char *pValueText = pJsonDocument + pValue->start;
+	size_t valueLength = (size_t) (pValue->end - pValue->start);
+	CoalescedField_t *pField = findField(pMerge->pUpdate, pMerge->section, pKeyText, keyLength);
+
+	IOT_UNUSED(valueIndex);
+
+	if(JSMN_STRING == pValue->type) {
+		/* Keep the quotes so the value can be copied back verbatim */
+		pValueText--;
+		valueLength += 2;
+	}
+
+	if(!pMerge->isApplying) {
+		if(NULL == pField) {
+			pMerge->newFieldCount++;
+			pMerge->newBytes += keyLength + valueLength;
+		} else if(valueLength > pField->valueLength) {
+			pMerge->newBytes += valueLength;
+		}
+		return true;
+	}
+
+	if(NULL == pField) {
+		pField = &(pMerge->pUpdate->fields[pMerge->pUpdate->fieldCount++]);
+		pField->section = pMerge->section;
+		pField->keyLength = (uint16_t) keyLength;
+		pField->keyOffset = appendToBuffer(pMerge->pUpdate, pKeyText, keyLength);
+		pField->valueOffset = appendToBuffer(pMerge->pUpdate, pValueText, valueLength);
+	} else if(valueLength <= pField->valueLength) {
+		memcpy(pMerge->pUpdate->buffer + pField->valueOffset, pValueText, valueLength);
+	} else {
+		pField->valueOffset = appendToBuffer(pMerge->pUpdate, pValueText, valueLength);
+	}
+	pField->valueLength = (uint16_t) valueLength;
+
+	return true;
+}
+
+/* Measures or applies the reported and desired members of pJsonString against pUpdate, which may be NULL when
+ * measuring. The shadow JSON tokens are shared, so the document is parsed again on every pass. */
+static IoT_Error_t mergeDocument(ShadowClient_t *pShadow, CoalescedUpdate_t *pUpdate, const char *pJsonString,
+								 bool isApplying, CoalesceMerge_t *pMerge, bool *pHasVersion) {
+	ShadowJsonParser_t *pParser = &(pShadow->jsonParser);
+	int32_t tokenCount, sectionIndex;
+	jsmntok_t versionToken;
+
+	pMerge->pUpdate = pUpdate;
+	pMerge->isApplying = isApplying;
+	pMerge->newFieldCount = 0;
+	pMerge->newBytes = 0;
+
+	if(!isJsonValidAndParse(pJsonString, strlen(pJsonString), pParser, &tokenCount)) {
+		return SHADOW_JSON_ERROR;
+	}
+
+	if(NULL != pHasVersion) {
+		*pHasVersion = extractJsonSectionValue(pJsonString, pParser, tokenCount, 0, SHADOW_VERSION_STRING,
+											   &versionToken);
+	}
+
+	for(pMerge->section = 0; pMerge->section < COALESCED_SECTION_COUNT; pMerge->section++) {
+		sectionIndex = findJsonStateSection(pJsonString, pParser, tokenCount, sectionNames[pMerge->section]);
+		if(sectionIndex >= 0) {
+			forEachJsonObjectMember(pJsonString, pParser, tokenCount, sectionIndex, mergeMember, pMerge);
+		}
+	}
+
+	return SUCCESS;
+}
+
+static bool isMergeFitting(const CoalescedUpdate_t *pUpdate, const CoalesceMerge_t *pMerge,
+						   fpActionCallback_t callback) {
+	uint32_t fieldCount = (NULL == pUpdate) ? 0 : pUpdate->fieldCount;
+	size_t bufferUsed = (NULL == pUpdate) ? 0 : pUpdate->bufferUsed;
+	uint32_t callbackCount = (NULL == pUpdate) ? 0 : pUpdate->callbackCount;
+
+	if(fieldCount + pMerge->newFieldCount > MAX_SHADOW_COALESCED_FIELDS) {
+		return false;
+	}
+	if(bufferUsed + pMerge->newBytes > SHADOW_COALESCED_UPDATE_BUFFER_BYTES) {
+		return false;
+	}
+	if(NULL != callback && callbackCount >= MAX_SHADOW_COALESCED_CALLBACKS) {
+		return false;
+	}
+	return true;
+}
+
+static void coalescedAckCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+								 const char *pReceivedJsonDocument, void *pContextData) {
+	CoalescedUpdate_t *pUpdate = (CoalescedUpdate_t *) pContextData;
+	CoalescedCallback_t callbacks[MAX_SHADOW_COALESCED_CALLBACKS];
+	uint8_t callbackCount = pUpdate->callbackCount;
+	uint8_t i;
+
+	/* Free the slot first so the callbacks can queue the next update */
+	memcpy(callbacks, pUpdate->callbacks, callbackCount * sizeof(CoalescedCallback_t));
+	pUpdate->state = COALESCED_UPDATE_FREE;
+
+	for(i = 0; i < callbackCount; i++) {
+		callbacks[i].callback(pThingName, action, status, pReceivedJsonDocument, callbacks[i].pContextData);
+	}
+}
+
+static IoT_Error_t sendCoalescedUpdate(ShadowClient_t *pShadow, CoalescedUpdate_t *pUpdate) {
+	char *coalescedDocument = pShadow->coalescedDocument;
+	IoT_Json_Writer_t writer;
+	CoalescedField_t *pField;
+	bool isFirstField;
+	uint8_t section, i;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	aws_iot_json_writer_init(&writer, coalescedDocument, sizeof(pShadow->coalescedDocument), 0);
+	aws_iot_json_writer_raw(&writer, "{\"state\":{", 10);
+	for(section = 0; section < COALESCED_SECTION_COUNT; section++) {
+		isFirstField = true;
+		for(i = 0; i < pUpdate->fieldCount; i++) {
+			pField = &(pUpdate->fields[i]);
+			if(pField->section != section) {
+				continue;
+			}
+			if(isFirstField) {
+				aws_iot_json_writer_key(&writer, sectionNames[section]);
+				aws_iot_json_writer_char(&writer, '{');
+				isFirstField = false;
+			} else {
+				aws_iot_json_writer_char(&writer, ',');
+			}
+			/* Keys are copied as they were received, already escaped */
+			aws_iot_json_writer_char(&writer, '"');
+			aws_iot_json_writer_raw(&writer, pUpdate->buffer + pField->keyOffset, pField->keyLength);
+			aws_iot_json_writer_raw(&writer, "\":", 2);
+			aws_iot_json_writer_raw(&writer, pUpdate->buffer + pField->valueOffset, pField->valueLength);
+		}
+		if(!isFirstField) {
+			aws_iot_json_writer_raw(&writer, "},", 2);
+		}
+	}
+	if(0 == pUpdate->fieldCount) {
+		/* An empty state still needs the comma that finalize replaces */
+		aws_iot_json_writer_char(&writer, ',');
+	}
+	if(aws_iot_json_writer_is_truncated(&writer)) {
+		FUNC_EXIT_RC(SHADOW_JSON_BUFFER_TRUNCATED);
+	}
+
+	rc = aws_iot_shadow_client_finalize_json_document(pShadow, coalescedDocument, sizeof(pShadow->coalescedDocument));
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
+	rc = aws_iot_shadow_internal_client_action(pShadow, pUpdate->thingName, SHADOW_UPDATE, coalescedDocument,
+											   strlen(coalescedDocument), coalescedAckCallback, pUpdate,
+											   pUpdate->timeoutSeconds, pUpdate->isPersistentSubscribe);
+	if(SUCCESS == rc) {
+		pUpdate->state = COALESCED_UPDATE_IN_FLIGHT;
+	} else {
+		IOT_WARN("Coalesced update of %s not sent (%d), retrying after the next window", pUpdate->thingName, rc);
+		countdown_ms(&(pUpdate->windowTimer), pShadow->coalesceWindowMs);
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+void handleExpiredCoalescedUpdates(ShadowClient_t *pShadow) {
+	CoalescedUpdate_t *pUpdate;
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_COALESCED_UPDATES; i++) {
+		pUpdate = &(pShadow->coalescedUpdates[i]);
+		if(COALESCED_UPDATE_PENDING == pUpdate->state && has_timer_expired(&(pUpdate->windowTimer))) {
+			sendCoalescedUpdate(pShadow, pUpdate);
+		}
+	}
+}
+
+static CoalescedUpdate_t *startPendingUpdate(ShadowClient_t *pShadow, const char *pThingName) {
+	CoalescedUpdate_t *pUpdate;
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_COALESCED_UPDATES; i++) {
+		pUpdate = &(pShadow->coalescedUpdates[i]);
+		if(COALESCED_UPDATE_FREE == pUpdate->state) {
+			pUpdate->state = COALESCED_UPDATE_PENDING;
+			snprintf(pUpdate->thingName, MAX_SIZE_OF_THING_NAME, "%s", pThingName);
+			pUpdate->timeoutSeconds = 0;
+			pUpdate->isPersistentSubscribe = false;
+			pUpdate->fieldCount = 0;
+			pUpdate->callbackCount = 0;
+			pUpdate->bufferUsed = 0;
+			init_timer(&(pUpdate->windowTimer));
+			countdown_ms(&(pUpdate->windowTimer), pShadow->coalesceWindowMs);
+			return pUpdate;
+		}
+	}
+	return NULL;
+}
+
+IoT_Error_t aws_iot_shadow_update_coalesced(AWS_IoT_Client *pClient, const char *pThingName, const char *pJsonString,
+											fpActionCallback_t callback, void *pContextData, uint8_t timeout_seconds,
+											bool isPersistentSubscribe) {
+	return aws_iot_shadow_client_update_coalesced(getDefaultShadowClient(pClient), pThingName, pJsonString, callback,
+												  pContextData, timeout_seconds, isPersistentSubscribe);
+}
+
+IoT_Error_t aws_iot_shadow_client_update_coalesced(ShadowClient_t *pShadow, const char *pThingName,
+												   const char *pJsonString, fpActionCallback_t callback,
+												   void *pContextData, uint8_t timeout_seconds,
+												   bool isPersistentSubscribe) {
+	CoalescedUpdate_t *pUpdate;
+	CoalesceMerge_t merge;
+	bool hasVersion = false;
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pShadow || NULL == pShadow->pMqttClient || NULL == pThingName || NULL == pJsonString) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
+		FUNC_EXIT_RC(MQTT_CONNECTION_ERROR);
+	}
+
+	if(strlen(pThingName) >= MAX_SIZE_OF_THING_NAME) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
+	pUpdate = findPendingUpdate(pShadow, pThingName);
+	rc = mergeDocument(pShadow, pUpdate, pJsonString, false, &merge, &hasVersion);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+
+	if(hasVersion || (NULL != pUpdate && !isMergeFitting(pUpdate, &merge, callback))) {
+		if(NULL != pUpdate) {
+			/* pJsonString must not overtake the pending update. When it cannot be sent now it stays queued for the
+			 * next window, as at the end of a window, and the caller gets the error to retry pJsonString. */
+			rc = sendCoalescedUpdate(pShadow, pUpdate);
+			if(SUCCESS != rc) {
+				FUNC_EXIT_RC(rc);
+			}
+			pUpdate = NULL;
+		}
+		if(hasVersion) {
+			rc = aws_iot_shadow_internal_client_action(pShadow, pThingName, SHADOW_UPDATE, pJsonString,
+													   strlen(pJsonString), callback, pContextData, timeout_seconds,
+													   isPersistentSubscribe);
+			FUNC_EXIT_RC(rc);
+		}
+		mergeDocument(pShadow, NULL, pJsonString, false, &merge, NULL);
+	}
+
+	if(NULL == pUpdate) {
+		if(!isMergeFitting(NULL, &merge, callback)) {
+			FUNC_EXIT_RC(MAX_SIZE_ERROR);
+		}
+		pUpdate = startPendingUpdate(pShadow, pThingName);
+		if(NULL == pUpdate) {
+			IOT_WARN("No free coalesced update, raise MAX_SHADOW_COALESCED_UPDATES");
+			FUNC_EXIT_RC(FAILURE);
+		}
+	}
+
+	mergeDocument(pShadow, pUpdate, pJsonString, true, &merge, NULL);
+	if(NULL != callback) {
+		pUpdate->callbacks[pUpdate->callbackCount].callback = callback;
+		pUpdate->callbacks[pUpdate->callbackCount].pContextData = pContextData;
+		pUpdate->callbackCount++;
+	}
+	if(timeout_seconds > pUpdate->timeoutSeconds) {
+		pUpdate->timeoutSeconds = timeout_seconds;
+	}
+	pUpdate->isPersistentSubscribe = pUpdate->isPersistentSubscribe || isPersistentSubscribe;
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+IoT_Error_t aws_iot_shadow_flush_coalesced_updates(AWS_IoT_Client *pClient) {
+	return aws_iot_shadow_client_flush_coalesced_updates(getDefaultShadowClient(pClient));
+}
+
+IoT_Error_t aws_iot_shadow_client_flush_coalesced_updates(ShadowClient_t *pShadow) {
+	IoT_Error_t rc = SUCCESS;
+	IoT_Error_t sendRc;
+	uint8_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pShadow || NULL == pShadow->pMqttClient) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(!aws_iot_mqtt_is_client_connected(pShadow->pMqttClient)) {
+		FUNC_EXIT_RC(MQTT_CONNECTION_ERROR);
+	}
+
+	for(i = 0; i < MAX_SHADOW_COALESCED_UPDATES; i++) {
+		if(COALESCED_UPDATE_PENDING == pShadow->coalescedUpdates[i].state) {
+			sendRc = sendCoalescedUpdate(pShadow, &(pShadow->coalescedUpdates[i]));
+			if(SUCCESS == rc) {
+				rc = sendRc;
+			}
+		}
+	}
+
+	FUNC_EXIT_RC(rc);
+}
+
+#ifdef __cplusplus
+}
+#endif
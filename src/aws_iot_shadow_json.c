@@ -22,82 +22,68 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
 #include "aws_iot_shadow_json.h"
 
 #include <string.h>
 #include <stdbool.h>
 
+#include "aws_iot_json_tokenizer.h"
 #include "aws_iot_json_utils.h"
+#include "aws_iot_json_writer.h"
 #include "aws_iot_log.h"
 #include "aws_iot_shadow_key.h"
+#include "aws_iot_shadow_records.h"
 #include "aws_iot_config.h"
 
-extern char mqttClientID[MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES];
 #define AWS_IOT_SHADOW_CLIENT_TOKEN_KEY "{\"clientToken\":\""
-static uint32_t clientTokenNum = 0;
 
 //helper functions
-static IoT_Error_t convertDataToString(char *pStringBuffer, size_t maxSizoStringBuffer, JsonPrimitiveType type,
-									   void *pData);
-
-void resetClientTokenSequenceNum(void) {
-	clientTokenNum = 0;
-}
-
-static IoT_Error_t emptyJsonWithClientToken(char *pBuffer, size_t bufferSize) {
-
-    IoT_Error_t rc = SUCCESS;
-    size_t dataLenInBuffer = 0;
-
-	if(pBuffer != NULL)
-    {
-        dataLenInBuffer = (size_t)snprintf(pBuffer, bufferSize, AWS_IOT_SHADOW_CLIENT_TOKEN_KEY);
-    }else
-	{
-	    IOT_ERROR("NULL buffer in emptyJsonWithClientToken\n");
-        rc = FAILURE;
-	}
-
-	if(rc == SUCCESS)
-	{
-	    if ( dataLenInBuffer < bufferSize )
-	    {
-	        dataLenInBuffer += (size_t)snprintf(pBuffer + dataLenInBuffer, bufferSize - dataLenInBuffer, "%s-%d", mqttClientID, ( int )clientTokenNum++);
-	    }
-	    else
-	    {
-	        rc = FAILURE;
-	        IOT_ERROR("Supplied buffer too small to create JSON file\n");
-	    }
-    }
-
-	if(rc == SUCCESS)
-	{
-	    if ( dataLenInBuffer < bufferSize )
-	    {
-	        dataLenInBuffer += (size_t)snprintf( pBuffer + dataLenInBuffer, bufferSize - dataLenInBuffer, "\"}" );
-	        if ( dataLenInBuffer > bufferSize )
-	        {
-	            rc = FAILURE;
-	            IOT_ERROR( "Supplied buffer too small to create JSON file\n" );
-	        }
-	    }
-	    else
-	    {
-	        rc = FAILURE;
-	        IOT_ERROR( "Supplied buffer too small to create JSON file\n" );
-	    }
-    }
-
-    FUNC_EXIT_RC(rc);
+static void writeJsonValue(IoT_Json_Writer_t *pWriter, JsonPrimitiveType type, void *pData);
+
+static void writeClientToken(ShadowClient_t *pShadow, IoT_Json_Writer_t *pWriter) {
+	aws_iot_json_writer_raw_string(pWriter, pShadow->mqttClientID);
+	aws_iot_json_writer_char(pWriter, '-');
+	aws_iot_json_writer_uint(pWriter, pShadow->clientTokenNum++);
+}
+
+static IoT_Error_t emptyJsonWithClientToken(ShadowClient_t *pShadow, char *pBuffer, size_t bufferSize) {
+	IoT_Json_Writer_t writer;
+
+	if(pShadow == NULL || pBuffer == NULL) {
+		IOT_ERROR("NULL buffer in emptyJsonWithClientToken\n");
+		return FAILURE;
+	}
+
+	aws_iot_json_writer_init(&writer, pBuffer, bufferSize, 0);
+	aws_iot_json_writer_raw_string(&writer, AWS_IOT_SHADOW_CLIENT_TOKEN_KEY);
+	writeClientToken(pShadow, &writer);
+	aws_iot_json_writer_raw(&writer, "\"}", 2);
+
+	if(aws_iot_json_writer_is_truncated(&writer)) {
+		IOT_ERROR("Supplied buffer too small to create JSON file\n");
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_shadow_internal_client_get_request_json(ShadowClient_t *pShadow, char *pBuffer, size_t bufferSize) {
+	return emptyJsonWithClientToken(pShadow, pBuffer, bufferSize);
+}
+
+IoT_Error_t aws_iot_shadow_internal_client_delete_request_json(ShadowClient_t *pShadow, char *pBuffer,
+															   size_t bufferSize) {
+	return emptyJsonWithClientToken(pShadow, pBuffer, bufferSize);
 }
 
 IoT_Error_t aws_iot_shadow_internal_get_request_json(char *pBuffer, size_t bufferSize) {
-	return emptyJsonWithClientToken( pBuffer, bufferSize);
+	return aws_iot_shadow_internal_client_get_request_json(&defaultShadowClient, pBuffer, bufferSize);
 }
 
 IoT_Error_t aws_iot_shadow_internal_delete_request_json(char *pBuffer, size_t bufferSize ) {
-	return emptyJsonWithClientToken( pBuffer, bufferSize);
+	return aws_iot_shadow_internal_client_delete_request_json(&defaultShadowClient, pBuffer, bufferSize);
 }
 
 static inline IoT_Error_t checkReturnValueOfSnPrintf(int32_t snPrintfReturn, size_t maxSizeOfJsonDocument) {
@@ -110,281 +96,203 @@ static inline IoT_Error_t checkReturnValueOfSnPrintf(int32_t snPrintfReturn, siz
 }
 
 IoT_Error_t aws_iot_shadow_init_json_document(char *pJsonDocument, size_t maxSizeOfJsonDocument) {
-
-	IoT_Error_t ret_val = SUCCESS;
-	int32_t snPrintfReturn = 0;
+	IoT_Json_Writer_t writer;
 
 	if(pJsonDocument == NULL) {
 		return NULL_VALUE_ERROR;
 	}
-	snPrintfReturn = snprintf(pJsonDocument, maxSizeOfJsonDocument, "{\"state\":{");
 
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, maxSizeOfJsonDocument);
-
-	return ret_val;
+	aws_iot_json_writer_init(&writer, pJsonDocument, maxSizeOfJsonDocument, 0);
+	aws_iot_json_writer_raw(&writer, "{\"state\":{", 10);
 
+	return aws_iot_json_writer_is_truncated(&writer) ? SHADOW_JSON_BUFFER_TRUNCATED : SUCCESS;
 }
 
-IoT_Error_t aws_iot_shadow_add_desired(char *pJsonDocument, size_t maxSizeOfJsonDocument, uint8_t count, ...) {
-	IoT_Error_t ret_val = SUCCESS;
-	size_t tempSize = 0;
-	int8_t i;
-	size_t remSizeOfJsonBuffer = maxSizeOfJsonDocument;
-	int32_t snPrintfReturn = 0;
-	va_list pArgs;
-	jsonStruct_t *pTemporary = NULL;
-	va_start(pArgs, count);
+IoT_Error_t aws_iot_shadow_schema_begin_section(IoT_Json_Writer_t *pWriter, char *pJsonDocument,
+												size_t maxSizeOfJsonDocument, const char *pSection) {
+	size_t documentLength;
 
-	if(pJsonDocument == NULL) {
-		va_end(pArgs);
+	if(pWriter == NULL || pJsonDocument == NULL || pSection == NULL) {
 		return NULL_VALUE_ERROR;
 	}
 
-	tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-	if(tempSize <= 1) {
-		va_end(pArgs);
+	documentLength = strlen(pJsonDocument);
+	if(maxSizeOfJsonDocument - documentLength <= 1) {
 		return SHADOW_JSON_ERROR;
 	}
-	remSizeOfJsonBuffer = tempSize;
 
-	snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer, "\"desired\":{");
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
+	aws_iot_json_writer_init(pWriter, pJsonDocument, maxSizeOfJsonDocument, documentLength);
+	aws_iot_json_writer_key(pWriter, pSection);
+	aws_iot_json_writer_char(pWriter, '{');
+
+	return aws_iot_json_writer_is_truncated(pWriter) ? SHADOW_JSON_BUFFER_TRUNCATED : SUCCESS;
+}
+
+IoT_Error_t aws_iot_shadow_schema_end_section(IoT_Json_Writer_t *pWriter) {
+	aws_iot_json_writer_raw(pWriter, "},", 2);
+
+	return aws_iot_json_writer_is_truncated(pWriter) ? SHADOW_JSON_BUFFER_TRUNCATED : SUCCESS;
+}
 
-	if(ret_val != SUCCESS) {
-		va_end(pArgs);
-		return ret_val;
+/* Appends "section":{"key":value,...}, in a single pass after locating the end of the document once.
+ * The fields come from ppStructs when it is not NULL and from the variadic arguments otherwise. */
+static IoT_Error_t addJsonSection(char *pJsonDocument, size_t maxSizeOfJsonDocument, const char *pSection,
+								  uint8_t count, va_list *pArgs, jsonStruct_t *const *ppStructs) {
+	IoT_Json_Writer_t writer;
+	jsonStruct_t *pTemporary;
+	IoT_Error_t rc;
+	uint8_t i;
+
+	rc = aws_iot_shadow_schema_begin_section(&writer, pJsonDocument, maxSizeOfJsonDocument, pSection);
+	if(SUCCESS != rc) {
+		return rc;
 	}
 
 	for(i = 0; i < count; i++) {
-		tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-		if(tempSize <= 1) {
-			va_end(pArgs);
+		if(maxSizeOfJsonDocument - writer.length <= 1) {
 			return SHADOW_JSON_ERROR;
 		}
-		remSizeOfJsonBuffer = tempSize;
-		pTemporary = va_arg (pArgs, jsonStruct_t *);
-		if(pTemporary != NULL) {
-			snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer, "\"%s\":",
-									  pTemporary->pKey);
-			ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
-			if(ret_val != SUCCESS) {
-				va_end(pArgs);
-				return ret_val;
-			}
-			if(pTemporary->pKey != NULL && pTemporary->pData != NULL) {
-				ret_val = convertDataToString(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer,
-											  pTemporary->type, pTemporary->pData);
-			} else {
-				va_end(pArgs);
-				return NULL_VALUE_ERROR;
-			}
-			if(ret_val != SUCCESS) {
-				va_end(pArgs);
-				return ret_val;
-			}
-		} else {
-			va_end(pArgs);
+		pTemporary = (NULL != ppStructs) ? ppStructs[i] : va_arg (*pArgs, jsonStruct_t *);
+		if(pTemporary == NULL || pTemporary->pKey == NULL || pTemporary->pData == NULL) {
 			return NULL_VALUE_ERROR;
 		}
+		if(i > 0) {
+			aws_iot_json_writer_char(&writer, ',');
+		}
+		aws_iot_json_writer_key(&writer, pTemporary->pKey);
+		writeJsonValue(&writer, pTemporary->type, pTemporary->pData);
+		if(aws_iot_json_writer_is_truncated(&writer)) {
+			return SHADOW_JSON_BUFFER_TRUNCATED;
+		}
 	}
 
-	va_end(pArgs);
-	snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument) - 1, remSizeOfJsonBuffer, "},");
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
-	return ret_val;
+	return aws_iot_shadow_schema_end_section(&writer);
 }
 
-IoT_Error_t aws_iot_shadow_add_reported(char *pJsonDocument, size_t maxSizeOfJsonDocument, uint8_t count, ...) {
-	IoT_Error_t ret_val = SUCCESS;
-
-	int8_t i;
-	size_t remSizeOfJsonBuffer = maxSizeOfJsonDocument;
-	int32_t snPrintfReturn = 0;
-	size_t tempSize = 0;
-	jsonStruct_t *pTemporary;
+IoT_Error_t aws_iot_shadow_add_desired(char *pJsonDocument, size_t maxSizeOfJsonDocument, uint8_t count, ...) {
+	IoT_Error_t ret_val;
 	va_list pArgs;
-	va_start(pArgs, count);
 
-	if(pJsonDocument == NULL) {
-		va_end(pArgs);
-		return NULL_VALUE_ERROR;
-	}
+	va_start(pArgs, count);
+	ret_val = addJsonSection(pJsonDocument, maxSizeOfJsonDocument, "desired", count, &pArgs, NULL);
+	va_end(pArgs);
 
+	return ret_val;
+}
 
-	tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-	if(tempSize <= 1) {
-		va_end(pArgs);
-		return SHADOW_JSON_ERROR;
-	}
-	remSizeOfJsonBuffer = tempSize;
+IoT_Error_t aws_iot_shadow_add_reported(char *pJsonDocument, size_t maxSizeOfJsonDocument, uint8_t count, ...) {
+	IoT_Error_t ret_val;
+	va_list pArgs;
 
-	snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer, "\"reported\":{");
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
+	va_start(pArgs, count);
+	ret_val = addJsonSection(pJsonDocument, maxSizeOfJsonDocument, "reported", count, &pArgs, NULL);
+	va_end(pArgs);
 
-	if(ret_val != SUCCESS) {
-		va_end(pArgs);
-		return ret_val;
-	}
+	return ret_val;
+}
 
-	for(i = 0; i < count; i++) {
-		tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-		if(tempSize <= 1) {
-			va_end(pArgs);
-			return SHADOW_JSON_ERROR;
-		}
-		remSizeOfJsonBuffer = tempSize;
-
-		pTemporary = va_arg (pArgs, jsonStruct_t *);
-		if(pTemporary != NULL) {
-			snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer, "\"%s\":",
-									  pTemporary->pKey);
-			ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
-			if(ret_val != SUCCESS) {
-				va_end(pArgs);
-				return ret_val;
-			}
-			if(pTemporary->pKey != NULL && pTemporary->pData != NULL) {
-				ret_val = convertDataToString(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer,
-											  pTemporary->type, pTemporary->pData);
-			} else {
-				va_end(pArgs);
-				return NULL_VALUE_ERROR;
-			}
-			if(ret_val != SUCCESS) {
-				va_end(pArgs);
-				return ret_val;
-			}
-		} else {
-			va_end(pArgs);
-			return NULL_VALUE_ERROR;
-		}
+IoT_Error_t addJsonSectionFromArray(char *pJsonDocument, size_t maxSizeOfJsonDocument, const char *pSection,
+									uint8_t count, jsonStruct_t *const *ppStructs) {
+	if(NULL == ppStructs) {
+		return NULL_VALUE_ERROR;
 	}
 
-	va_end(pArgs);
-	snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument) - 1, remSizeOfJsonBuffer, "},");
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
-	return ret_val;
+	return addJsonSection(pJsonDocument, maxSizeOfJsonDocument, pSection, count, NULL, ppStructs);
 }
 
 
-int32_t FillWithClientTokenSize(char *pBufferToBeUpdatedWithClientToken, size_t maxSizeOfJsonDocument) {
-	int32_t snPrintfReturn;
-	snPrintfReturn = snprintf(pBufferToBeUpdatedWithClientToken, maxSizeOfJsonDocument, "%s-%d", mqttClientID,
-				  (int) clientTokenNum++);
+int32_t FillWithClientTokenSize(ShadowClient_t *pShadow, char *pBufferToBeUpdatedWithClientToken,
+								size_t maxSizeOfJsonDocument) {
+	IoT_Json_Writer_t writer;
+
+	aws_iot_json_writer_init(&writer, pBufferToBeUpdatedWithClientToken, maxSizeOfJsonDocument, 0);
+	writeClientToken(pShadow, &writer);
 
-	return snPrintfReturn;
+	return (int32_t) writer.length;
 }
 
-IoT_Error_t aws_iot_fill_with_client_token(char *pBufferToBeUpdatedWithClientToken, size_t maxSizeOfJsonDocument) {
+IoT_Error_t aws_iot_shadow_client_fill_with_client_token(ShadowClient_t *pShadow,
+														 char *pBufferToBeUpdatedWithClientToken,
+														 size_t maxSizeOfJsonDocument) {
 
 	int32_t snPrintfRet = 0;
-	snPrintfRet = FillWithClientTokenSize(pBufferToBeUpdatedWithClientToken, maxSizeOfJsonDocument);
-	return checkReturnValueOfSnPrintf(snPrintfRet, maxSizeOfJsonDocument);
-
-}
-
-IoT_Error_t aws_iot_finalize_json_document(char *pJsonDocument, size_t maxSizeOfJsonDocument) {
-	size_t remSizeOfJsonBuffer = maxSizeOfJsonDocument;
-	int32_t snPrintfReturn = 0;
-	size_t tempSize = 0;
-	IoT_Error_t ret_val = SUCCESS;
 
-	if(pJsonDocument == NULL) {
+	if(pShadow == NULL) {
 		return NULL_VALUE_ERROR;
 	}
 
-	tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-	if(tempSize <= 1) {
-		return SHADOW_JSON_ERROR;
-	}
-	remSizeOfJsonBuffer = tempSize;
+	snPrintfRet = FillWithClientTokenSize(pShadow, pBufferToBeUpdatedWithClientToken, maxSizeOfJsonDocument);
+	return checkReturnValueOfSnPrintf(snPrintfRet, maxSizeOfJsonDocument);
 
-	// strlen(ShadowTxBuffer) - 1 is to ensure we remove the last ,(comma) that was added
-	snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument) - 1, remSizeOfJsonBuffer, "}, \"%s\":\"",
-							  SHADOW_CLIENT_TOKEN_STRING);
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
+}
 
-	if(ret_val != SUCCESS) {
-		return ret_val;
-	}
-	// refactor this XXX repeated code
-	tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-	if(tempSize <= 1) {
-		return SHADOW_JSON_ERROR;
-	}
-	remSizeOfJsonBuffer = tempSize;
+IoT_Error_t aws_iot_fill_with_client_token(char *pBufferToBeUpdatedWithClientToken, size_t maxSizeOfJsonDocument) {
+	return aws_iot_shadow_client_fill_with_client_token(&defaultShadowClient, pBufferToBeUpdatedWithClientToken,
+														maxSizeOfJsonDocument);
+}
 
+IoT_Error_t aws_iot_finalize_json_document(char *pJsonDocument, size_t maxSizeOfJsonDocument) {
+	return aws_iot_shadow_client_finalize_json_document(&defaultShadowClient, pJsonDocument, maxSizeOfJsonDocument);
+}
 
-	snPrintfReturn = FillWithClientTokenSize(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer);
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
+IoT_Error_t aws_iot_shadow_client_finalize_json_document(ShadowClient_t *pShadow, char *pJsonDocument,
+														 size_t maxSizeOfJsonDocument) {
+	IoT_Json_Writer_t writer;
+	size_t documentLength;
 
-	if(ret_val != SUCCESS) {
-		return ret_val;
+	if(pShadow == NULL || pJsonDocument == NULL) {
+		return NULL_VALUE_ERROR;
 	}
-	tempSize = maxSizeOfJsonDocument - strlen(pJsonDocument);
-	if(tempSize <= 1) {
+
+	documentLength = strlen(pJsonDocument);
+	if(documentLength == 0 || maxSizeOfJsonDocument - documentLength <= 1) {
 		return SHADOW_JSON_ERROR;
 	}
-	remSizeOfJsonBuffer = tempSize;
-
 
-	snPrintfReturn = snprintf(pJsonDocument + strlen(pJsonDocument), remSizeOfJsonBuffer, "\"}");
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, remSizeOfJsonBuffer);
+	// documentLength - 1 is to ensure we remove the last ,(comma) that was added
+	aws_iot_json_writer_init(&writer, pJsonDocument, maxSizeOfJsonDocument, documentLength - 1);
+	aws_iot_json_writer_raw_string(&writer, "}, \"" SHADOW_CLIENT_TOKEN_STRING "\":\"");
+	writeClientToken(pShadow, &writer);
+	aws_iot_json_writer_raw(&writer, "\"}", 2);
 
-	return ret_val;
+	return aws_iot_json_writer_is_truncated(&writer) ? SHADOW_JSON_BUFFER_TRUNCATED : SUCCESS;
 }
 
-static IoT_Error_t convertDataToString(char *pStringBuffer, size_t maxSizoStringBuffer, JsonPrimitiveType type,
-									   void *pData) {
-	int32_t snPrintfReturn = 0;
-	IoT_Error_t ret_val = SUCCESS;
-
-	if(maxSizoStringBuffer == 0) {
-		return SHADOW_JSON_ERROR;
-	}
-
+static void writeJsonValue(IoT_Json_Writer_t *pWriter, JsonPrimitiveType type, void *pData) {
 	if(type == SHADOW_JSON_INT32) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%i,", *(int32_t *) (pData));
+		aws_iot_json_writer_int(pWriter, *(int32_t *) (pData));
 	} else if(type == SHADOW_JSON_INT16) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%hi,", *(int16_t *) (pData));
+		aws_iot_json_writer_int(pWriter, *(int16_t *) (pData));
 	} else if(type == SHADOW_JSON_INT8) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%hhi,", *(int8_t *) (pData));
+		aws_iot_json_writer_int(pWriter, *(int8_t *) (pData));
 	} else if(type == SHADOW_JSON_UINT32) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%u,", *(uint32_t *) (pData));
+		aws_iot_json_writer_uint(pWriter, *(uint32_t *) (pData));
 	} else if(type == SHADOW_JSON_UINT16) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%hu,", *(uint16_t *) (pData));
+		aws_iot_json_writer_uint(pWriter, *(uint16_t *) (pData));
 	} else if(type == SHADOW_JSON_UINT8) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%hhu,", *(uint8_t *) (pData));
+		aws_iot_json_writer_uint(pWriter, *(uint8_t *) (pData));
 	} else if(type == SHADOW_JSON_DOUBLE) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%f,", *(double *) (pData));
+		aws_iot_json_writer_double(pWriter, *(double *) (pData));
 	} else if(type == SHADOW_JSON_FLOAT) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%f,", *(float *) (pData));
+		aws_iot_json_writer_float(pWriter, *(float *) (pData));
 	} else if(type == SHADOW_JSON_BOOL) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%s,", *(bool *) (pData) ? "true" : "false");
+		aws_iot_json_writer_bool(pWriter, *(bool *) (pData));
 	} else if(type == SHADOW_JSON_STRING) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "\"%s\",", (char *) (pData));
+		aws_iot_json_writer_string(pWriter, (char *) (pData));
 	} else if(type == SHADOW_JSON_OBJECT) {
-		snPrintfReturn = snprintf(pStringBuffer, maxSizoStringBuffer, "%s,", (char *) (pData));
+		aws_iot_json_writer_raw_string(pWriter, (char *) (pData));
 	}
-
-
-	ret_val = checkReturnValueOfSnPrintf(snPrintfReturn, maxSizoStringBuffer);
-
-	return ret_val;
 }
 
-static jsmn_parser shadowJsonParser;
-static jsmntok_t jsonTokenStruct[MAX_JSON_TOKEN_EXPECTED];
-
-bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, void *pJsonHandler, int32_t *pTokenCount) {
+bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, ShadowJsonParser_t *pJsonHandler,
+						 int32_t *pTokenCount) {
+	jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
 	int32_t tokenCount;
 
-	IOT_UNUSED(pJsonHandler);
-
-	jsmn_init(&shadowJsonParser);
+	jsmn_init(&(pJsonHandler->parser));
 
-	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct,
-							sizeof(jsonTokenStruct) / sizeof(jsonTokenStruct[0]));
+	tokenCount = aws_iot_json_parse(&(pJsonHandler->parser), pJsonDocument, jsonSize, jsonTokenStruct,
+									sizeof(pJsonHandler->tokens) / sizeof(pJsonHandler->tokens[0]));
 
 	if(tokenCount < 0) {
 		IOT_WARN("Failed to parse JSON: %d\n", tokenCount);
@@ -397,12 +305,13 @@ bool isJsonValidAndParse(const char *pJsonDocument, size_t jsonSize, void *pJson
 		return false;
 	}
 
+	buildJsonTape(jsonTokenStruct, tokenCount, pJsonHandler->tape);
 	*pTokenCount = tokenCount;
 
 	return true;
 }	
 
-static IoT_Error_t UpdateValueIfNoObject(const char *pJsonString, jsonStruct_t *pDataStruct, jsmntok_t token) {
+IoT_Error_t UpdateValueIfNoObject(const char *pJsonString, jsonStruct_t *pDataStruct, jsmntok_t token) {
 	IoT_Error_t ret_val = SHADOW_JSON_ERROR;
 	if(pDataStruct->type == SHADOW_JSON_BOOL && pDataStruct->dataLength >= sizeof(bool)) {
 		ret_val = parseBooleanValue((bool *) pDataStruct->pData, pJsonString, &token);
@@ -429,14 +338,13 @@ static IoT_Error_t UpdateValueIfNoObject(const char *pJsonString, jsonStruct_t *
 	return ret_val;
 }
 
-bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, void *pJsonHandler, int32_t tokenCount,
+bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
 									 jsonStruct_t *pDataStruct, uint32_t *pDataLength, int32_t *pDataPosition) {
+	jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
 	int32_t i;
 	uint32_t dataLength;
 	jsmntok_t dataToken;
 
-	IOT_UNUSED(pJsonHandler);
-
 	for(i = 1; i < tokenCount; i++) {
 		if(jsoneq(pJsonDocument, &(jsonTokenStruct[i]), pDataStruct->pKey) == 0) {
 			dataToken = jsonTokenStruct[i + 1];
@@ -452,71 +360,212 @@ bool isJsonKeyMatchingAndUpdateValue(const char *pJsonDocument, void *pJsonHandl
 	return false;
 }
 
-bool isReceivedJsonValid(const char *pJsonDocument, size_t jsonSize ) {
-	int32_t tokenCount;
+/* Index of the first token after the value starting at index, skipping nested objects and arrays */
+static int32_t skipJsonValue(const ShadowJsonParser_t *pJsonHandler, int32_t index) {
+	return pJsonHandler->tape[index].next;
+}
+
+/* Index of the value of pKey among the direct members of the object at objectIndex, -1 if absent */
+static int32_t findJsonObjectMemberOfLength(const char *pJsonDocument, const ShadowJsonParser_t *pJsonHandler,
+											int32_t tokenCount, int32_t objectIndex, const char *pKey,
+											size_t keyLength) {
+	const jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
+	int32_t end = jsonTokenStruct[objectIndex].end;
+	int32_t i = objectIndex + 1;
+
+	while(i + 1 < tokenCount && jsonTokenStruct[i].start < end) {
+		if(JSMN_STRING == jsonTokenStruct[i].type
+		   && (size_t) (jsonTokenStruct[i].end - jsonTokenStruct[i].start) == keyLength
+		   && strncmp(pJsonDocument + jsonTokenStruct[i].start, pKey, keyLength) == 0) {
+			return i + 1;
+		}
+		i = skipJsonValue(pJsonHandler, i + 1);
+	}
+	return -1;
+}
 
-	jsmn_init(&shadowJsonParser);
+int32_t findJsonObjectMember(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							 int32_t objectIndex, const char *pKey) {
+	return findJsonObjectMemberOfLength(pJsonDocument, pJsonHandler, tokenCount, objectIndex, pKey, strlen(pKey));
+}
 
-	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct,
-							sizeof(jsonTokenStruct) / sizeof(jsonTokenStruct[0]));
+int32_t findJsonPath(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+					 int32_t objectIndex, const char *pPath) {
+	jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
+	const char *pSegment = pPath;
+	size_t segmentLength;
 
-	if(tokenCount < 0) {
-		IOT_WARN("Failed to parse JSON: %d\n", tokenCount);
+	for(;;) {
+		if(objectIndex < 0 || objectIndex >= tokenCount || jsonTokenStruct[objectIndex].type != JSMN_OBJECT) {
+			return -1;
+		}
+
+		segmentLength = strcspn(pSegment, ".");
+		objectIndex = findJsonObjectMemberOfLength(pJsonDocument, pJsonHandler, tokenCount, objectIndex, pSegment,
+												   segmentLength);
+		if(objectIndex < 0 || '\0' == pSegment[segmentLength]) {
+			return objectIndex;
+		}
+		pSegment += segmentLength + 1;
+	}
+}
+
+bool isJsonPathMatchingAndUpdateValue(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler,
+									  int32_t tokenCount, int32_t objectIndex, jsonStruct_t *pDataStruct,
+									  uint32_t *pDataLength, int32_t *pDataPosition) {
+	int32_t index;
+	jsmntok_t dataToken;
+
+	index = findJsonPath(pJsonDocument, pJsonHandler, tokenCount, objectIndex, pDataStruct->pKey);
+	if(index < 0) {
 		return false;
 	}
 
-	/* Assume the top-level element is an object */
+	dataToken = pJsonHandler->tokens[index];
+	UpdateValueIfNoObject(pJsonDocument, pDataStruct, dataToken);
+	*pDataPosition = dataToken.start;
+	*pDataLength = (uint32_t) (dataToken.end - dataToken.start);
+	return true;
+}
+
+int32_t findJsonStateSection(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							 const char *pSection) {
+	jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
+	int32_t index;
+
 	if(tokenCount < 1 || jsonTokenStruct[0].type != JSMN_OBJECT) {
+		return -1;
+	}
+
+	index = findJsonObjectMember(pJsonDocument, pJsonHandler, tokenCount, 0, "state");
+	if(index < 0 || jsonTokenStruct[index].type != JSMN_OBJECT) {
+		return -1;
+	}
+
+	index = findJsonObjectMember(pJsonDocument, pJsonHandler, tokenCount, index, pSection);
+	if(index < 0 || jsonTokenStruct[index].type != JSMN_OBJECT) {
+		return -1;
+	}
+	return index;
+}
+
+bool extractJsonSectionValue(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							 int32_t sectionIndex, const char *pKey, jsmntok_t *pValueToken) {
+	int32_t index;
+
+	if(sectionIndex < 0 || sectionIndex >= tokenCount) {
 		return false;
 	}
 
+	index = findJsonObjectMember(pJsonDocument, pJsonHandler, tokenCount, sectionIndex, pKey);
+	if(index < 0) {
+		return false;
+	}
+
+	*pValueToken = pJsonHandler->tokens[index];
 	return true;
 }
 
-bool extractClientToken(const char *pJsonDocument, size_t jsonSize, char *pExtractedClientToken, size_t clientTokenSize) {
-	int32_t tokenCount, i;
+int32_t forEachJsonObjectMember(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+								int32_t objectIndex, jsonMemberVisitor_t visitor, void *pContext) {
+	jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
+	int32_t end, i;
+	int32_t memberCount = 0;
+
+	if(objectIndex < 0 || objectIndex >= tokenCount || jsonTokenStruct[objectIndex].type != JSMN_OBJECT) {
+		return -1;
+	}
+
+	end = jsonTokenStruct[objectIndex].end;
+	i = objectIndex + 1;
+	while(i + 1 < tokenCount && jsonTokenStruct[i].start < end) {
+		if(!visitor(pJsonDocument, &(jsonTokenStruct[i]), &(jsonTokenStruct[i + 1]), i + 1, pContext)) {
+			break;
+		}
+		memberCount++;
+		i = skipJsonValue(pJsonHandler, i + 1);
+	}
+	return memberCount;
+}
+
+bool isReceivedJsonValid(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, size_t jsonSize ) {
+	int32_t tokenCount;
+
+	return isJsonValidAndParse(pJsonDocument, jsonSize, pJsonHandler, &tokenCount);
+}
+
+bool extractClientToken(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, size_t jsonSize,
+						char *pExtractedClientToken, size_t clientTokenSize) {
+	int32_t tokenCount;
+
+	if(!isJsonValidAndParse(pJsonDocument, jsonSize, pJsonHandler, &tokenCount)) {
+		return false;
+	}
+
+	return extractParsedClientToken(pJsonDocument, pJsonHandler, tokenCount, pExtractedClientToken, clientTokenSize);
+}
+
+bool extractParsedClientToken(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+							  char *pExtractedClientToken, size_t clientTokenSize) {
+	int32_t index;
 	size_t length;
 	jsmntok_t ClientJsonToken;
-	jsmn_init(&shadowJsonParser);
 
-	tokenCount = jsmn_parse(&shadowJsonParser, pJsonDocument, jsonSize, jsonTokenStruct,
-							sizeof(jsonTokenStruct) / sizeof(jsonTokenStruct[0]));
+	/* The client token is a member of the top-level object, the tape skips over the state */
+	index = findJsonObjectMember(pJsonDocument, pJsonHandler, tokenCount, 0, SHADOW_CLIENT_TOKEN_STRING);
+	if(index < 0) {
+		return false;
+	}
 
-	if(tokenCount < 0) {
-		IOT_WARN("Failed to parse JSON: %d\n", tokenCount);
+	ClientJsonToken = pJsonHandler->tokens[index];
+	length = (uint8_t) (ClientJsonToken.end - ClientJsonToken.start);
+	if(clientTokenSize >= length + 1) {
+		strncpy(pExtractedClientToken, pJsonDocument + ClientJsonToken.start, length);
+		pExtractedClientToken[length] = '\0';
+		return true;
+	}
+
+	IOT_WARN("Token size %zu too small for string %zu \n", clientTokenSize, length);
+	return false;
+}
+
+bool decodeClientTokenSequence(ShadowClient_t *pShadow, const char *pClientToken, uint32_t *pSequence) {
+	const char *pDigit;
+	uint32_t digit;
+	uint32_t sequence = 0;
+
+	/* Tokens written by writeClientToken are the client id, a dash and the sequence number */
+	if(strncmp(pClientToken, pShadow->mqttClientID, pShadow->mqttClientIDLength) != 0
+	   || '-' != pClientToken[pShadow->mqttClientIDLength]) {
 		return false;
 	}
 
-	/* Assume the top-level element is an object */
-	if(tokenCount < 1 || jsonTokenStruct[0].type != JSMN_OBJECT) {
+	pDigit = pClientToken + pShadow->mqttClientIDLength + 1;
+	if('\0' == *pDigit) {
 		return false;
 	}
 
-	for(i = 1; i < tokenCount; i++) {
-		if(jsoneq(pJsonDocument, &jsonTokenStruct[i], SHADOW_CLIENT_TOKEN_STRING) == 0) {
-			ClientJsonToken = jsonTokenStruct[i + 1];
-			length = (uint8_t) (ClientJsonToken.end - ClientJsonToken.start);
-            if (clientTokenSize >= length + 1)
-            {
-                strncpy( pExtractedClientToken, pJsonDocument + ClientJsonToken.start, length);
-                pExtractedClientToken[length] = '\0';
-                return true;
-            }else{
-                IOT_WARN( "Token size %zu too small for string %zu \n", clientTokenSize, length);
-                return false; 
-            }
+	for(; '\0' != *pDigit; pDigit++) {
+		if(*pDigit < '0' || *pDigit > '9') {
+			return false;
 		}
+		digit = (uint32_t) (*pDigit - '0');
+		if(sequence > (UINT32_MAX - digit) / 10) {
+			return false;
+		}
+		sequence = sequence * 10 + digit;
 	}
 
-	return false;
+	*pSequence = sequence;
+	return true;
 }
 
-bool extractVersionNumber(const char *pJsonDocument, void *pJsonHandler, int32_t tokenCount, uint32_t *pVersionNumber) {
+bool extractVersionNumber(const char *pJsonDocument, ShadowJsonParser_t *pJsonHandler, int32_t tokenCount,
+						  uint32_t *pVersionNumber) {
+	jsmntok_t *jsonTokenStruct = pJsonHandler->tokens;
 	int32_t i;
 	IoT_Error_t ret_val = SUCCESS;
 
-	IOT_UNUSED(pJsonHandler);
-
 	for(i = 1; i < tokenCount; i++) {
 		if(jsoneq(pJsonDocument, &(jsonTokenStruct[i]), SHADOW_VERSION_STRING) == 0) {
 			ret_val = parseUnsignedInteger32Value(pVersionNumber, pJsonDocument, &jsonTokenStruct[i + 1]);
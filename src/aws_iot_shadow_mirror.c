@@ -0,0 +1,651 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_mirror.c
+ * @brief In-memory copy of the shadow documents with a snapshot file
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
+#include "aws_iot_shadow_mirror.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "snapshot_storage_interface.h"
+#include "timer_interface.h"
+#include "aws_iot_json_utils.h"
+#include "aws_iot_json_writer.h"
+#include "aws_iot_log.h"
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_json.h"
+#include "aws_iot_shadow_key.h"
+#include "aws_iot_shadow_records.h"
+
+#if SHADOW_MIRROR_BUFFER_BYTES > UINT16_MAX
+#error "SHADOW_MIRROR_BUFFER_BYTES must fit the uint16_t field offsets"
+#endif
+#if SHADOW_MIRROR_MAX_PATH_LENGTH > UINT8_MAX
+#error "SHADOW_MIRROR_MAX_PATH_LENGTH must fit the uint8_t path lengths"
+#endif
+
+#define SHADOW_MIRROR_SECTION_COUNT 2
+
+#define SHADOW_TOPIC_PREFIX "$aws/things/"
+#define SHADOW_TOPIC_SHADOW "/shadow/"
+
+/* State of a walk over the members of a section, path holds the keys of the enclosing objects */
+typedef struct {
+	ShadowMirror_t *pMirror;
+	ShadowJsonParser_t *pParser;
+	int32_t tokenCount;
+	uint8_t section;
+	char path[SHADOW_MIRROR_MAX_PATH_LENGTH];
+	size_t pathLength;
+} MirrorMerge_t;
+
+typedef enum {
+	MIRROR_MESSAGE_GET_ACCEPTED, MIRROR_MESSAGE_UPDATE_ACCEPTED, MIRROR_MESSAGE_DELETE_ACCEPTED, MIRROR_MESSAGE_DELTA
+} MirrorMessage_t;
+
+static const char *const sectionNames[SHADOW_MIRROR_SECTION_COUNT] = {"desired", "reported"};
+
+void initShadowMirrors(ShadowClient_t *pShadow) {
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_MIRRORS; i++) {
+		pShadow->mirrors[i].isUsed = false;
+	}
+}
+
+static ShadowMirror_t *findMirror(ShadowClient_t *pShadow, const char *pThingName, size_t thingNameLength) {
+	ShadowMirror_t *pMirror;
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_MIRRORS; i++) {
+		pMirror = &(pShadow->mirrors[i]);
+		if(pMirror->isUsed && strlen(pMirror->thingName) == thingNameLength &&
+		   memcmp(pMirror->thingName, pThingName, thingNameLength) == 0) {
+			return pMirror;
+		}
+	}
+	return NULL;
+}
+
+static void clearMirror(ShadowMirror_t *pMirror) {
+	pMirror->fieldCount = 0;
+	pMirror->bufferUsed = 0;
+}
+
+static void markMirrorDirty(ShadowMirror_t *pMirror) {
+	if(!pMirror->isDirty) {
+		pMirror->isDirty = true;
+		countdown_ms(&(pMirror->snapshotTimer), pMirror->snapshotIntervalMs);
+	}
+}
+
+static MirrorField_t *findMirrorField(ShadowMirror_t *pMirror, uint8_t section, const char *pPath, size_t pathLength) {
+	uint16_t i;
+
+	for(i = 0; i < pMirror->fieldCount; i++) {
+		if(pMirror->fields[i].section == section && pMirror->fields[i].pathLength == pathLength &&
+		   memcmp(pMirror->buffer + pMirror->fields[i].offset, pPath, pathLength) == 0) {
+			return &(pMirror->fields[i]);
+		}
+	}
+	return NULL;
+}
+
+/* True if pPath is inside the object at pPrefix, e.g. "led.color" inside "led" */
+static bool isPathInside(const char *pPath, size_t pathLength, const char *pPrefix, size_t prefixLength) {
+	return pathLength > prefixLength && '.' == pPath[prefixLength] && memcmp(pPath, pPrefix, prefixLength) == 0;
+}
+
+static void removeMirrorFieldAt(ShadowMirror_t *pMirror, uint16_t index) {
+	pMirror->fieldCount--;
+	pMirror->fields[index] = pMirror->fields[pMirror->fieldCount];
+}
+
+/* Removes the value at pPath together with the values inside it and, with removeParents, the values at the paths
+ * pPath is inside of, which stop being leaves once pPath is set */
+static void removeMirrorPath(ShadowMirror_t *pMirror, uint8_t section, const char *pPath, size_t pathLength,
+							 bool removeParents) {
+	MirrorField_t *pField;
+	const char *pFieldPath;
+	uint16_t i = 0;
+
+	while(i < pMirror->fieldCount) {
+		pField = &(pMirror->fields[i]);
+		pFieldPath = pMirror->buffer + pField->offset;
+		if(pField->section == section &&
+		   ((pField->pathLength == pathLength && memcmp(pFieldPath, pPath, pathLength) == 0) ||
+			isPathInside(pFieldPath, pField->pathLength, pPath, pathLength) ||
+			(removeParents && isPathInside(pPath, pathLength, pFieldPath, pField->pathLength)))) {
+			removeMirrorFieldAt(pMirror, i);
+		} else {
+			i++;
+		}
+	}
+}
+
+/* Moves the fields to the start of the buffer in offset order, dropping the space of replaced values */
+static void compactMirror(ShadowMirror_t *pMirror) {
+	uint16_t order[MAX_SHADOW_MIRROR_FIELDS];
+	MirrorField_t *pField;
+	uint16_t i, j, index, used = 0;
+
+	for(i = 0; i < pMirror->fieldCount; i++) {
+		for(j = i; j > 0 && pMirror->fields[order[j - 1]].offset > pMirror->fields[i].offset; j--) {
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+	}
+
+	for(i = 0; i < pMirror->fieldCount; i++) {
+		index = order[i];
+		pField = &(pMirror->fields[index]);
+		memmove(pMirror->buffer + used, pMirror->buffer + pField->offset, pField->pathLength + pField->valueLength);
+		pField->offset = used;
+		used = (uint16_t) (used + pField->pathLength + pField->valueLength);
+	}
+	pMirror->bufferUsed = used;
+}
+
+static bool setMirrorValue(ShadowMirror_t *pMirror, uint8_t section, const char *pPath, size_t pathLength,
+						   const char *pValue, size_t valueLength) {
+	MirrorField_t *pField = findMirrorField(pMirror, section, pPath, pathLength);
+	size_t recordLength = pathLength + valueLength;
+
+	if(NULL != pField && valueLength <= pField->valueLength) {
+		memcpy(pMirror->buffer + pField->offset + pathLength, pValue, valueLength);
+		pField->valueLength = (uint16_t) valueLength;
+		return true;
+	}
+
+	removeMirrorPath(pMirror, section, pPath, pathLength, true);
+	if(pMirror->fieldCount >= MAX_SHADOW_MIRROR_FIELDS) {
+		return false;
+	}
+	if(pMirror->bufferUsed + recordLength > SHADOW_MIRROR_BUFFER_BYTES) {
+		compactMirror(pMirror);
+		if(pMirror->bufferUsed + recordLength > SHADOW_MIRROR_BUFFER_BYTES) {
+			return false;
+		}
+	}
+
+	pField = &(pMirror->fields[pMirror->fieldCount++]);
+	pField->section = section;
+	pField->offset = pMirror->bufferUsed;
+	pField->pathLength = (uint8_t) pathLength;
+	pField->valueLength = (uint16_t) valueLength;
+	memcpy(pMirror->buffer + pField->offset, pPath, pathLength);
+	memcpy(pMirror->buffer + pField->offset + pathLength, pValue, valueLength);
+	pMirror->bufferUsed = (uint16_t) (pMirror->bufferUsed + recordLength);
+	return true;
+}
+
+static bool mergeMirrorMember(const char *pJsonDocument, const jsmntok_t *pKey, const jsmntok_t *pValue,
+							  int32_t valueIndex, void *pContext) {
+	MirrorMerge_t *pMerge = (MirrorMerge_t *) pContext;
+	size_t parentLength = pMerge->pathLength;
+	size_t keyLength = (size_t) (pKey->end - pKey->start);
+	size_t pathLength = parentLength + (parentLength > 0 ? 1 : 0) + keyLength;
+	const char *pValueText = pJsonDocument + pValue->start;
+	size_t valueLength = (size_t) (pValue->end - pValue->start);
+
+	if(pathLength >= SHADOW_MIRROR_MAX_PATH_LENGTH) {
+		IOT_WARN("Shadow mirror of %s: path of %.*s too long, value dropped", pMerge->pMirror->thingName,
+				 (int) keyLength, pJsonDocument + pKey->start);
+		return true;
+	}
+	if(parentLength > 0) {
+		pMerge->path[parentLength] = '.';
+	}
+	memcpy(pMerge->path + pathLength - keyLength, pJsonDocument + pKey->start, keyLength);
+
+	if(JSMN_OBJECT == pValue->type) {
+		pMerge->pathLength = pathLength;
+		forEachJsonObjectMember(pJsonDocument, pMerge->pParser, pMerge->tokenCount, valueIndex, mergeMirrorMember,
+								pMerge);
+		pMerge->pathLength = parentLength;
+		return true;
+	}
+
+	if(JSMN_PRIMITIVE == pValue->type && 'n' == *pValueText) {
+		/* null removes the key and everything below it */
+		removeMirrorPath(pMerge->pMirror, pMerge->section, pMerge->path, pathLength, false);
+		return true;
+	}
+
+	if(JSMN_STRING == pValue->type) {
+		pValueText--;
+		valueLength += 2;
+	}
+	if(!setMirrorValue(pMerge->pMirror, pMerge->section, pMerge->path, pathLength, pValueText, valueLength)) {
+		IOT_WARN("Shadow mirror of %s full, %.*s dropped", pMerge->pMirror->thingName, (int) pathLength,
+				 pMerge->path);
+	}
+	return true;
+}
+
+static void mergeMirrorObject(ShadowMirror_t *pMirror, uint8_t section, const char *pJsonDocument,
+							  ShadowJsonParser_t *pParser, int32_t tokenCount, int32_t objectIndex) {
+	MirrorMerge_t merge;
+
+	if(objectIndex < 0) {
+		return;
+	}
+
+	merge.pMirror = pMirror;
+	merge.pParser = pParser;
+	merge.tokenCount = tokenCount;
+	merge.section = section;
+	merge.pathLength = 0;
+	forEachJsonObjectMember(pJsonDocument, pParser, tokenCount, objectIndex, mergeMirrorMember, &merge);
+}
+
+static bool parseMirrorTopic(const char *pTopicName, uint16_t topicNameLen, const char **ppThingName,
+							 size_t *pThingNameLength, MirrorMessage_t *pMessage) {
+	static const struct {
+		const char *pSuffix;
+		MirrorMessage_t message;
+	} suffixes[] = {
+			{"get/accepted", MIRROR_MESSAGE_GET_ACCEPTED},
+			{"update/accepted", MIRROR_MESSAGE_UPDATE_ACCEPTED},
+			{"delete/accepted", MIRROR_MESSAGE_DELETE_ACCEPTED},
+			{"update/delta", MIRROR_MESSAGE_DELTA}
+	};
+	size_t prefixLength = strlen(SHADOW_TOPIC_PREFIX);
+	size_t shadowLength = strlen(SHADOW_TOPIC_SHADOW);
+	size_t thingEnd, suffixLength, i;
+
+	if(topicNameLen <= prefixLength || strncmp(pTopicName, SHADOW_TOPIC_PREFIX, prefixLength) != 0) {
+		return false;
+	}
+
+	for(thingEnd = prefixLength; thingEnd < topicNameLen && '/' != pTopicName[thingEnd]; thingEnd++);
+	if(thingEnd + shadowLength > topicNameLen ||
+	   strncmp(pTopicName + thingEnd, SHADOW_TOPIC_SHADOW, shadowLength) != 0) {
+		return false;
+	}
+
+	for(i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+		suffixLength = strlen(suffixes[i].pSuffix);
+		if(thingEnd + shadowLength + suffixLength == topicNameLen &&
+		   strncmp(pTopicName + thingEnd + shadowLength, suffixes[i].pSuffix, suffixLength) == 0) {
+			*ppThingName = pTopicName + prefixLength;
+			*pThingNameLength = thingEnd - prefixLength;
+			*pMessage = suffixes[i].message;
+			return true;
+		}
+	}
+	return false;
+}
+
+void applyShadowMirrorMessage(ShadowClient_t *pShadow, const char *pTopicName, uint16_t topicNameLen,
+							  const char *pJsonDocument, int32_t tokenCount) {
+	ShadowJsonParser_t *pParser = &(pShadow->jsonParser);
+	ShadowMirror_t *pMirror;
+	const char *pThingName;
+	size_t thingNameLength;
+	MirrorMessage_t message;
+	jsmntok_t versionToken;
+	uint32_t version = 0;
+	bool hasVersion;
+	int32_t stateIndex;
+	uint8_t section;
+
+	if(!parseMirrorTopic(pTopicName, topicNameLen, &pThingName, &thingNameLength, &message)) {
+		return;
+	}
+
+	pMirror = findMirror(pShadow, pThingName, thingNameLength);
+	if(NULL == pMirror) {
+		return;
+	}
+
+	hasVersion = extractJsonSectionValue(pJsonDocument, pParser, tokenCount, 0, SHADOW_VERSION_STRING, &versionToken) &&
+				 SUCCESS == parseUnsignedInteger32Value(&version, pJsonDocument, &versionToken);
+
+	if(MIRROR_MESSAGE_UPDATE_ACCEPTED == message || MIRROR_MESSAGE_DELTA == message) {
+		/* An update and its delta carry the same version, both are applied */
+		if(hasVersion && version < pMirror->version) {
+			IOT_DEBUG("Shadow mirror of %s: ignoring version %u older than %u", pMirror->thingName, version,
+					  pMirror->version);
+			return;
+		}
+	} else {
+		/* get/accepted and delete/accepted are the whole document, deleting may restart the versions */
+		clearMirror(pMirror);
+		pMirror->hasDocument = true;
+	}
+
+	if(MIRROR_MESSAGE_DELTA == message) {
+		stateIndex = findJsonObjectMember(pJsonDocument, pParser, tokenCount, 0, "state");
+		mergeMirrorObject(pMirror, SHADOW_MIRROR_DESIRED, pJsonDocument, pParser, tokenCount, stateIndex);
+	} else if(MIRROR_MESSAGE_DELETE_ACCEPTED != message) {
+		for(section = 0; section < SHADOW_MIRROR_SECTION_COUNT; section++) {
+			mergeMirrorObject(pMirror, section, pJsonDocument, pParser, tokenCount,
+							  findJsonStateSection(pJsonDocument, pParser, tokenCount, sectionNames[section]));
+		}
+	}
+
+	if(hasVersion) {
+		pMirror->version = version;
+	}
+	markMirrorDirty(pMirror);
+}
+
+static IoT_Error_t writeMirrorSnapshot(ShadowClient_t *pShadow, ShadowMirror_t *pMirror) {
+	char *snapshotBuffer = pShadow->mirrorSnapshotBuffer;
+	IoT_Json_Writer_t writer;
+	MirrorField_t *pField;
+	bool isFirstField;
+	uint8_t section;
+	uint16_t i;
+
+	FUNC_ENTRY;
+
+	aws_iot_json_writer_init(&writer, snapshotBuffer, sizeof(pShadow->mirrorSnapshotBuffer), 0);
+	aws_iot_json_writer_char(&writer, '{');
+	aws_iot_json_writer_key(&writer, SHADOW_VERSION_STRING);
+	aws_iot_json_writer_uint(&writer, pMirror->version);
+	for(section = 0; section < SHADOW_MIRROR_SECTION_COUNT; section++) {
+		aws_iot_json_writer_char(&writer, ',');
+		aws_iot_json_writer_key(&writer, sectionNames[section]);
+		aws_iot_json_writer_char(&writer, '{');
+		isFirstField = true;
+		for(i = 0; i < pMirror->fieldCount; i++) {
+			pField = &(pMirror->fields[i]);
+			if(pField->section != section) {
+				continue;
+			}
+			if(!isFirstField) {
+				aws_iot_json_writer_char(&writer, ',');
+			}
+			isFirstField = false;
+			/* Paths are made of keys as they were received, already escaped */
+			aws_iot_json_writer_char(&writer, '"');
+			aws_iot_json_writer_raw(&writer, pMirror->buffer + pField->offset, pField->pathLength);
+			aws_iot_json_writer_raw(&writer, "\":", 2);
+			aws_iot_json_writer_raw(&writer, pMirror->buffer + pField->offset + pField->pathLength,
+									pField->valueLength);
+		}
+		aws_iot_json_writer_char(&writer, '}');
+	}
+	aws_iot_json_writer_char(&writer, '}');
+	if(aws_iot_json_writer_is_truncated(&writer)) {
+		FUNC_EXIT_RC(SHADOW_JSON_BUFFER_TRUNCATED);
+	}
+
+	if(SUCCESS != aws_iot_snapshot_storage_write(pMirror->snapshotFile, snapshotBuffer, writer.length)) {
+		IOT_ERROR("Shadow mirror snapshot %s could not be written", pMirror->snapshotFile);
+		FUNC_EXIT_RC(FAILURE);
+	}
+
+	pMirror->isDirty = false;
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+static bool loadMirrorMember(const char *pJsonDocument, const jsmntok_t *pKey, const jsmntok_t *pValue,
+							 int32_t valueIndex, void *pContext) {
+	MirrorMerge_t *pMerge = (MirrorMerge_t *) pContext;
+	const char *pValueText = pJsonDocument + pValue->start;
+	size_t valueLength = (size_t) (pValue->end - pValue->start);
+	size_t pathLength = (size_t) (pKey->end - pKey->start);
+
+	IOT_UNUSED(valueIndex);
+
+	if(JSMN_STRING == pValue->type) {
+		pValueText--;
+		valueLength += 2;
+	}
+	if(pathLength >= SHADOW_MIRROR_MAX_PATH_LENGTH ||
+	   !setMirrorValue(pMerge->pMirror, pMerge->section, pJsonDocument + pKey->start, pathLength, pValueText,
+					   valueLength)) {
+		IOT_WARN("Shadow mirror of %s: snapshot value %.*s dropped", pMerge->pMirror->thingName, (int) pathLength,
+				 pJsonDocument + pKey->start);
+	}
+	return true;
+}
+
+/* The snapshot holds the version and one flat object of paths per section, it is parsed with the shadow tokens */
+static void loadMirrorSnapshot(ShadowClient_t *pShadow, ShadowMirror_t *pMirror) {
+	char *snapshotBuffer = pShadow->mirrorSnapshotBuffer;
+	ShadowJsonParser_t *pParser = &(pShadow->jsonParser);
+	MirrorMerge_t merge;
+	jsmntok_t versionToken;
+	int32_t tokenCount;
+	size_t length = 0;
+	IoT_Error_t rc;
+
+	rc = aws_iot_snapshot_storage_read(pMirror->snapshotFile, snapshotBuffer, sizeof(pShadow->mirrorSnapshotBuffer) - 1,
+									   &length);
+	if(MAX_SIZE_ERROR == rc) {
+		IOT_WARN("Shadow mirror snapshot %s is too large, ignored", pMirror->snapshotFile);
+		return;
+	} else if(SUCCESS != rc) {
+		IOT_DEBUG("No shadow mirror snapshot %s", pMirror->snapshotFile);
+		return;
+	}
+	snapshotBuffer[length] = '\0';
+
+	if(!isJsonValidAndParse(snapshotBuffer, length, pParser, &tokenCount) ||
+	   !extractJsonSectionValue(snapshotBuffer, pParser, tokenCount, 0, SHADOW_VERSION_STRING, &versionToken) ||
+	   SUCCESS != parseUnsignedInteger32Value(&(pMirror->version), snapshotBuffer, &versionToken)) {
+		IOT_WARN("Shadow mirror snapshot %s is not valid, ignored", pMirror->snapshotFile);
+		pMirror->version = 0;
+		return;
+	}
+
+	merge.pMirror = pMirror;
+	merge.pParser = pParser;
+	merge.tokenCount = tokenCount;
+	merge.pathLength = 0;
+	for(merge.section = 0; merge.section < SHADOW_MIRROR_SECTION_COUNT; merge.section++) {
+		forEachJsonObjectMember(snapshotBuffer, pParser, tokenCount,
+								findJsonObjectMember(snapshotBuffer, pParser, tokenCount, 0,
+													 sectionNames[merge.section]),
+								loadMirrorMember, &merge);
+	}
+	pMirror->hasDocument = true;
+}
+
+void handleShadowMirrorSnapshots(ShadowClient_t *pShadow) {
+	ShadowMirror_t *pMirror;
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_MIRRORS; i++) {
+		pMirror = &(pShadow->mirrors[i]);
+		if(pMirror->isUsed && pMirror->isDirty && '\0' != pMirror->snapshotFile[0] &&
+		   has_timer_expired(&(pMirror->snapshotTimer))) {
+			if(SUCCESS != writeMirrorSnapshot(pShadow, pMirror)) {
+				/* Try again after another interval */
+				countdown_ms(&(pMirror->snapshotTimer), pMirror->snapshotIntervalMs);
+			}
+		}
+	}
+}
+
+IoT_Error_t aws_iot_shadow_mirror_enable(const char *pThingName, const char *pSnapshotFile,
+										 uint32_t snapshotIntervalMs) {
+	return aws_iot_shadow_client_mirror_enable(&defaultShadowClient, pThingName, pSnapshotFile, snapshotIntervalMs);
+}
+
+IoT_Error_t aws_iot_shadow_client_mirror_enable(ShadowClient_t *pShadow, const char *pThingName,
+												const char *pSnapshotFile, uint32_t snapshotIntervalMs) {
+	ShadowMirror_t *pMirror;
+	uint8_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pShadow || NULL == pThingName) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(strlen(pThingName) >= MAX_SIZE_OF_THING_NAME ||
+	   (NULL != pSnapshotFile && strlen(pSnapshotFile) >= SHADOW_MIRROR_MAX_FILE_PATH_LENGTH)) {
+		FUNC_EXIT_RC(MAX_SIZE_ERROR);
+	}
+
+	pMirror = findMirror(pShadow, pThingName, strlen(pThingName));
+	for(i = 0; NULL == pMirror && i < MAX_SHADOW_MIRRORS; i++) {
+		if(!pShadow->mirrors[i].isUsed) {
+			pMirror = &(pShadow->mirrors[i]);
+		}
+	}
+	if(NULL == pMirror) {
+		IOT_WARN("No free shadow mirror, raise MAX_SHADOW_MIRRORS");
+		FUNC_EXIT_RC(LIMIT_EXCEEDED_ERROR);
+	}
+
+	pMirror->isUsed = true;
+	pMirror->hasDocument = false;
+	pMirror->isDirty = false;
+	pMirror->version = 0;
+	snprintf(pMirror->thingName, MAX_SIZE_OF_THING_NAME, "%s", pThingName);
+	snprintf(pMirror->snapshotFile, SHADOW_MIRROR_MAX_FILE_PATH_LENGTH, "%s",
+			 (NULL != pSnapshotFile) ? pSnapshotFile : "");
+	pMirror->snapshotIntervalMs = snapshotIntervalMs;
+	init_timer(&(pMirror->snapshotTimer));
+	clearMirror(pMirror);
+
+	if(NULL != pSnapshotFile) {
+		loadMirrorSnapshot(pShadow, pMirror);
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+IoT_Error_t aws_iot_shadow_mirror_disable(const char *pThingName) {
+	return aws_iot_shadow_client_mirror_disable(&defaultShadowClient, pThingName);
+}
+
+IoT_Error_t aws_iot_shadow_client_mirror_disable(ShadowClient_t *pShadow, const char *pThingName) {
+	ShadowMirror_t *pMirror;
+
+	if(NULL == pShadow || NULL == pThingName) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pMirror = findMirror(pShadow, pThingName, strlen(pThingName));
+	if(NULL == pMirror) {
+		return FAILURE;
+	}
+
+	pMirror->isUsed = false;
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_shadow_mirror_get_field(const char *pThingName, ShadowMirrorSection_t section,
+											jsonStruct_t *pStruct) {
+	return aws_iot_shadow_client_mirror_get_field(&defaultShadowClient, pThingName, section, pStruct);
+}
+
+IoT_Error_t aws_iot_shadow_client_mirror_get_field(ShadowClient_t *pShadow, const char *pThingName,
+												   ShadowMirrorSection_t section, jsonStruct_t *pStruct) {
+	ShadowMirror_t *pMirror;
+	MirrorField_t *pField;
+	const char *pValue;
+	jsmntok_t valueToken;
+
+	FUNC_ENTRY;
+
+	if(NULL == pShadow || NULL == pThingName || NULL == pStruct || NULL == pStruct->pKey || NULL == pStruct->pData) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	pMirror = findMirror(pShadow, pThingName, strlen(pThingName));
+	if(NULL == pMirror) {
+		FUNC_EXIT_RC(FAILURE);
+	}
+
+	pField = findMirrorField(pMirror, (uint8_t) section, pStruct->pKey, strlen(pStruct->pKey));
+	if(NULL == pField) {
+		FUNC_EXIT_RC(FAILURE);
+	}
+
+	pValue = pMirror->buffer + pField->offset + pField->pathLength;
+	if(SHADOW_JSON_OBJECT == pStruct->type) {
+		if(pField->valueLength >= pStruct->dataLength) {
+			FUNC_EXIT_RC(SHADOW_JSON_BUFFER_TRUNCATED);
+		}
+		memcpy(pStruct->pData, pValue, pField->valueLength);
+		((char *) pStruct->pData)[pField->valueLength] = '\0';
+		FUNC_EXIT_RC(SUCCESS);
+	}
+
+	memset(&valueToken, 0, sizeof(valueToken));
+	valueToken.end = pField->valueLength;
+	valueToken.type = JSMN_PRIMITIVE;
+	if('"' == *pValue) {
+		valueToken.start = 1;
+		valueToken.end = pField->valueLength - 1;
+		valueToken.type = JSMN_STRING;
+	} else if('[' == *pValue) {
+		valueToken.type = JSMN_ARRAY;
+	}
+
+	FUNC_EXIT_RC(UpdateValueIfNoObject(pValue, pStruct, valueToken));
+}
+
+IoT_Error_t aws_iot_shadow_mirror_get_version(const char *pThingName, uint32_t *pVersion) {
+	return aws_iot_shadow_client_mirror_get_version(&defaultShadowClient, pThingName, pVersion);
+}
+
+IoT_Error_t aws_iot_shadow_client_mirror_get_version(ShadowClient_t *pShadow, const char *pThingName,
+													 uint32_t *pVersion) {
+	ShadowMirror_t *pMirror;
+
+	if(NULL == pShadow || NULL == pThingName || NULL == pVersion) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pMirror = findMirror(pShadow, pThingName, strlen(pThingName));
+	if(NULL == pMirror || !pMirror->hasDocument) {
+		return FAILURE;
+	}
+
+	*pVersion = pMirror->version;
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_shadow_mirror_save(const char *pThingName) {
+	return aws_iot_shadow_client_mirror_save(&defaultShadowClient, pThingName);
+}
+
+IoT_Error_t aws_iot_shadow_client_mirror_save(ShadowClient_t *pShadow, const char *pThingName) {
+	ShadowMirror_t *pMirror;
+
+	if(NULL == pShadow || NULL == pThingName) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pMirror = findMirror(pShadow, pThingName, strlen(pThingName));
+	if(NULL == pMirror || '\0' == pMirror->snapshotFile[0]) {
+		return FAILURE;
+	}
+
+	return writeMirrorSnapshot(pShadow, pMirror);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,6 +22,8 @@
 extern "C" {
 #endif
 
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
 #include "aws_iot_shadow_records.h"
 
 #include <string.h>
@@ -31,56 +33,12 @@ extern "C" {
 #include "aws_iot_json_utils.h"
 #include "aws_iot_log.h"
 #include "aws_iot_shadow_json.h"
+#include "aws_iot_shadow_mirror.h"
+#include "aws_iot_shadow_reported_cache.h"
+#include "aws_iot_shadow_topics.h"
 #include "aws_iot_config.h"
 
-typedef struct {
-	char clientTokenID[MAX_SIZE_CLIENT_ID_WITH_SEQUENCE];
-	char thingName[MAX_SIZE_OF_THING_NAME];
-	ShadowActions_t action;
-	fpActionCallback_t callback;
-	void *pCallbackContext;
-	bool isFree;
-	Timer timer;
-} ToBeReceivedAckRecord_t;
-
-typedef struct {
-	const char *pKey;
-	void *pStruct;
-	jsonStructCallback_t callback;
-	bool isFree;
-} JsonTokenTable_t;
-
-typedef struct {
-	char Topic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	uint8_t count;
-	bool isFree;
-	bool isSticky;
-} SubscriptionRecord_t;
-
-typedef enum {
-	SHADOW_ACCEPTED, SHADOW_REJECTED, SHADOW_ACTION
-} ShadowAckTopicTypes_t;
-
-ToBeReceivedAckRecord_t AckWaitList[MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME];
-
-AWS_IoT_Client *pMqttClient;
-
-char myThingName[MAX_SIZE_OF_THING_NAME];
-char mqttClientID[MAX_SIZE_OF_UNIQUE_CLIENT_ID_BYTES];
-
-char shadowDeltaTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-
-#define MAX_TOPICS_AT_ANY_GIVEN_TIME 2*MAX_THINGNAME_HANDLED_AT_ANY_GIVEN_TIME
-SubscriptionRecord_t SubscriptionList[MAX_TOPICS_AT_ANY_GIVEN_TIME];
-
 #define SUBSCRIBE_SETTLING_TIME 2
-char shadowRxBuf[SHADOW_MAX_SIZE_OF_RX_BUFFER];
-
-static JsonTokenTable_t tokenTable[MAX_JSON_TOKEN_EXPECTED];
-static uint32_t tokenTableIndex = 0;
-static bool deltaTopicSubscribedFlag = false;
-uint32_t shadowJsonVersionNum = 0;
-bool shadowDiscardOldDeltaFlag = true;
 
 // local helper functions
 static void AckStatusCallback(AWS_IoT_Client *pClient, char *topicName,
@@ -89,157 +47,162 @@ static void AckStatusCallback(AWS_IoT_Client *pClient, char *topicName,
 static void shadow_delta_callback(AWS_IoT_Client *pClient, char *topicName,
 								  uint16_t topicNameLen, IoT_Publish_Message_Params *params, void *pData);
 
-static void topicNameFromThingAndAction(char *pTopic, const char *pThingName, ShadowActions_t action,
-										ShadowAckTopicTypes_t ackType);
-
-static int16_t getNextFreeIndexOfSubscriptionList(void);
+static int16_t getNextFreeIndexOfSubscriptionList(ShadowClient_t *pShadow);
 
-static void unsubscribeFromAcceptedAndRejected(uint8_t index);
+static void unsubscribeFromAcceptedAndRejected(ShadowClient_t *pShadow, uint8_t index);
 
-void initDeltaTokens(void) {
+void initDeltaTokens(ShadowClient_t *pShadow) {
 	uint32_t i;
 	for(i = 0; i < MAX_JSON_TOKEN_EXPECTED; i++) {
-		tokenTable[i].isFree = true;
+		pShadow->tokenTable[i].isFree = true;
 	}
-	tokenTableIndex = 0;
-	deltaTopicSubscribedFlag = false;
+	pShadow->tokenTableIndex = 0;
+	pShadow->pSchemaDelta = NULL;
+	pShadow->deltaTopicSubscribedFlag = false;
 }
 
-IoT_Error_t registerJsonTokenOnDelta(jsonStruct_t *pStruct) {
-
+static IoT_Error_t subscribeToDelta(ShadowClient_t *pShadow) {
 	IoT_Error_t rc = SUCCESS;
 
-	if(!deltaTopicSubscribedFlag) {
-		snprintf(shadowDeltaTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES, "$aws/things/%s/shadow/update/delta", myThingName);
-		rc = aws_iot_mqtt_subscribe(pMqttClient, shadowDeltaTopic, (uint16_t) strlen(shadowDeltaTopic), QOS0,
-									shadow_delta_callback, NULL);
-		deltaTopicSubscribedFlag = true;
+	const ShadowTopicTable_t *pTopics;
+	const char *pDeltaTopic;
+	uint16_t deltaTopicLength;
+
+	if(!pShadow->deltaTopicSubscribedFlag) {
+		pTopics = getShadowTopicTable(pShadow, pShadow->myThingName);
+		if(NULL == pTopics) {
+			return MAX_SIZE_ERROR;
+		}
+		pDeltaTopic = getShadowDeltaTopic(pTopics, &deltaTopicLength);
+		memcpy(pShadow->deltaTopic, pDeltaTopic, (size_t) deltaTopicLength + 1);
+		rc = aws_iot_mqtt_subscribe(pShadow->pMqttClient, pShadow->deltaTopic, deltaTopicLength, QOS0,
+									shadow_delta_callback, pShadow);
+		pShadow->deltaTopicSubscribedFlag = true;
 	}
 
-	if(tokenTableIndex >= MAX_JSON_TOKEN_EXPECTED) {
+	return rc;
+}
+
+IoT_Error_t registerSchemaOnDelta(ShadowClient_t *pShadow, ShadowSchemaDelta_t *pSchemaDelta) {
+	pShadow->pSchemaDelta = pSchemaDelta;
+
+	return subscribeToDelta(pShadow);
+}
+
+IoT_Error_t registerJsonTokenOnDelta(ShadowClient_t *pShadow, jsonStruct_t *pStruct) {
+
+	IoT_Error_t rc = subscribeToDelta(pShadow);
+
+	if(pShadow->tokenTableIndex >= MAX_JSON_TOKEN_EXPECTED) {
 		return FAILURE;
 	}
 
-	tokenTable[tokenTableIndex].pKey = pStruct->pKey;
-	tokenTable[tokenTableIndex].callback = pStruct->cb;
-	tokenTable[tokenTableIndex].pStruct = pStruct;
-	tokenTable[tokenTableIndex].isFree = false;
-	tokenTableIndex++;
+	pShadow->tokenTable[pShadow->tokenTableIndex].pKey = pStruct->pKey;
+	pShadow->tokenTable[pShadow->tokenTableIndex].callback = pStruct->cb;
+	pShadow->tokenTable[pShadow->tokenTableIndex].pStruct = pStruct;
+	pShadow->tokenTable[pShadow->tokenTableIndex].isFree = false;
+	pShadow->tokenTable[pShadow->tokenTableIndex].isPath = (NULL != strchr(pStruct->pKey, '.'));
+	pShadow->tokenTableIndex++;
 
 	return rc;
 }
 
-static int16_t getNextFreeIndexOfSubscriptionList(void) {
+static int16_t getNextFreeIndexOfSubscriptionList(ShadowClient_t *pShadow) {
 	uint8_t i;
 	for(i = 0; i < MAX_TOPICS_AT_ANY_GIVEN_TIME; i++) {
-		if(SubscriptionList[i].isFree) {
-			SubscriptionList[i].isFree = false;
+		if(pShadow->subscriptionList[i].isFree) {
+			pShadow->subscriptionList[i].isFree = false;
 			return i;
 		}
 	}
 	return -1;
 }
 
-static void topicNameFromThingAndAction(char *pTopic, const char *pThingName, ShadowActions_t action,
-										ShadowAckTopicTypes_t ackType) {
-
-	char actionBuf[10];
-	char ackTypeBuf[10];
-
-	if(SHADOW_GET == action) {
-		strncpy(actionBuf, "get", 10);
-	} else if(SHADOW_UPDATE == action) {
-		strncpy(actionBuf, "update", 10);
-	} else if(SHADOW_DELETE == action) {
-		strncpy(actionBuf, "delete", 10);
-	}
+static bool isSubscriptionTopic(const SubscriptionRecord_t *pSubscription, const char *pTopic, uint16_t topicLength) {
+	return 0 == strncmp(pSubscription->Topic, pTopic, topicLength) && '\0' == pSubscription->Topic[topicLength];
+}
 
-	if(SHADOW_ACCEPTED == ackType) {
-		strncpy(ackTypeBuf, "accepted", 10);
-	} else if(SHADOW_REJECTED == ackType) {
-		strncpy(ackTypeBuf, "rejected", 10);
-	}
+static int16_t findIndexOfAckWaitList(ShadowClient_t *pShadow, const char *pClientToken) {
+	uint8_t i;
+	uint32_t sequence;
 
-	if(SHADOW_ACTION == ackType) {
-		snprintf(pTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES, "$aws/things/%s/shadow/%s", pThingName, actionBuf);
-	} else {
-		snprintf(pTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES, "$aws/things/%s/shadow/%s/%s", pThingName, actionBuf,
-				 ackTypeBuf);
+	/* Our own tokens are waited for in the slot given by their sequence number */
+	if(decodeClientTokenSequence(pShadow, pClientToken, &sequence)) {
+		i = (uint8_t) (sequence % MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME);
+		if(!pShadow->ackWaitList[i].isFree && pShadow->ackWaitList[i].hasTokenSequence
+		   && pShadow->ackWaitList[i].tokenSequence == sequence) {
+			return i;
+		}
 	}
-}
 
-static bool isValidShadowVersionUpdate(const char *pTopicName) {
-	if(strstr(pTopicName, myThingName) != NULL &&
-	   ((strstr(pTopicName, "get/accepted") != NULL) ||
-		(strstr(pTopicName, "delta") != NULL))) {
-		return true;
+	/* Tokens chosen by the application, or placed elsewhere because their slot was busy */
+	for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
+		if(!pShadow->ackWaitList[i].isFree) {
+			if(strcmp(pShadow->ackWaitList[i].clientTokenID, pClientToken) == 0) {
+				return i;
+			}
+		}
 	}
-	return false;
+	return -1;
 }
 
 static void AckStatusCallback(AWS_IoT_Client *pClient, char *topicName, uint16_t topicNameLen,
 							  IoT_Publish_Message_Params *params, void *pData) {
+	SubscriptionRecord_t *pSubscription = (SubscriptionRecord_t *) pData;
+	ShadowClient_t *pShadow = pSubscription->pShadow;
+	Shadow_Ack_Status_t status = pSubscription->status;
+	ShadowActions_t action = pSubscription->action;
+	bool isMyThing = pSubscription->isMyThing;
+	const char *pJsonDocument = (const char *) params->payload;
 	int32_t tokenCount;
-	uint8_t i;
-	void *pJsonHandler = NULL;
+	int16_t i;
 	char temporaryClientToken[MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE];
 
 	IOT_UNUSED(pClient);
-	IOT_UNUSED(topicNameLen);
-	IOT_UNUSED(pData);
-
-	if(params->payloadLen >= SHADOW_MAX_SIZE_OF_RX_BUFFER) {
-		IOT_WARN("Payload larger than RX Buffer");
-		return;
-	}
-
-	memcpy(shadowRxBuf, params->payload, params->payloadLen);
-	shadowRxBuf[params->payloadLen] = '\0';    // jsmn_parse relies on a string
 
-	if(!isJsonValidAndParse(shadowRxBuf, SHADOW_MAX_SIZE_OF_RX_BUFFER, pJsonHandler, &tokenCount)) {
+	if(!isJsonValidAndParse(pJsonDocument, params->payloadLen, &(pShadow->jsonParser), &tokenCount)) {
 		IOT_WARN("Received JSON is not valid");
 		return;
 	}
 
-	if(isValidShadowVersionUpdate(topicName)) {
-		uint32_t tempVersionNumber = 0;
-		if(extractVersionNumber(shadowRxBuf, pJsonHandler, tokenCount, &tempVersionNumber)) {
-			if(tempVersionNumber > shadowJsonVersionNum) {
-				shadowJsonVersionNum = tempVersionNumber;
+	applyShadowMirrorMessage(pShadow, topicName, topicNameLen, pJsonDocument, tokenCount);
+
+	if(isMyThing && SHADOW_ACK_ACCEPTED == status) {
+		if(SHADOW_GET == action) {
+			uint32_t tempVersionNumber = 0;
+			if(extractVersionNumber(pJsonDocument, &(pShadow->jsonParser), tokenCount, &tempVersionNumber)) {
+				if(tempVersionNumber > pShadow->jsonVersionNum) {
+					pShadow->jsonVersionNum = tempVersionNumber;
+				}
 			}
 		}
+
+		if(SHADOW_UPDATE == action || SHADOW_GET == action) {
+			updateReportedCacheFromDocument(pShadow, pJsonDocument, tokenCount, SHADOW_UPDATE == action);
+		} else if(SHADOW_DELETE == action) {
+			aws_iot_shadow_client_reset_reported_cache(pShadow);
+		}
 	}
 
-	if(extractClientToken(shadowRxBuf, SHADOW_MAX_SIZE_OF_RX_BUFFER, temporaryClientToken, MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE)) {
-		for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
-			if(!AckWaitList[i].isFree) {
-				if(strcmp(AckWaitList[i].clientTokenID, temporaryClientToken) == 0) {
-					Shadow_Ack_Status_t status = SHADOW_ACK_REJECTED;
-					if(strstr(topicName, "accepted") != NULL) {
-						status = SHADOW_ACK_ACCEPTED;
-					} else if(strstr(topicName, "rejected") != NULL) {
-						status = SHADOW_ACK_REJECTED;
-					}
-					if(status == SHADOW_ACK_ACCEPTED || status == SHADOW_ACK_REJECTED) {
-						if(AckWaitList[i].callback != NULL) {
-							AckWaitList[i].callback(AckWaitList[i].thingName, AckWaitList[i].action, status,
-													shadowRxBuf, AckWaitList[i].pCallbackContext);
-						}
-						unsubscribeFromAcceptedAndRejected(i);
-						AckWaitList[i].isFree = true;
-						return;
-					}
-				}
+	if(extractParsedClientToken(pJsonDocument, &(pShadow->jsonParser), tokenCount, temporaryClientToken,
+								MAX_SIZE_CLIENT_TOKEN_CLIENT_SEQUENCE)) {
+		i = findIndexOfAckWaitList(pShadow, temporaryClientToken);
+		if(i >= 0) {
+			if(pShadow->ackWaitList[i].callback != NULL) {
+				pShadow->ackWaitList[i].callback(pShadow->ackWaitList[i].thingName, pShadow->ackWaitList[i].action, status,
+										pJsonDocument, pShadow->ackWaitList[i].pCallbackContext);
 			}
+			unsubscribeFromAcceptedAndRejected(pShadow, (uint8_t) i);
+			pShadow->ackWaitList[i].isFree = true;
 		}
 	}
 }
 
-static int16_t findIndexOfSubscriptionList(const char *pTopic) {
+static int16_t findIndexOfSubscriptionList(ShadowClient_t *pShadow, const char *pTopic, uint16_t topicLength) {
 	uint8_t i;
 	for(i = 0; i < MAX_TOPICS_AT_ANY_GIVEN_TIME; i++) {
-		if(!SubscriptionList[i].isFree) {
-			if((strcmp(pTopic, SubscriptionList[i].Topic) == 0)) {
+		if(!pShadow->subscriptionList[i].isFree) {
+			if(isSubscriptionTopic(&pShadow->subscriptionList[i], pTopic, topicLength)) {
 				return i;
 			}
 		}
@@ -247,76 +210,86 @@ static int16_t findIndexOfSubscriptionList(const char *pTopic) {
 	return -1;
 }
 
-static void unsubscribeFromAcceptedAndRejected(uint8_t index) {
+static void unsubscribeFromAcceptedAndRejected(ShadowClient_t *pShadow, uint8_t index) {
 
-	char TemporaryTopicNameAccepted[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	char TemporaryTopicNameRejected[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	const ShadowTopicTable_t *pTopics;
+	const char *pAcceptedTopic, *pRejectedTopic;
+	uint16_t acceptedTopicLength, rejectedTopicLength;
 	IoT_Error_t ret_val = SUCCESS;
 
 	int16_t indexSubList;
 
-	topicNameFromThingAndAction(TemporaryTopicNameAccepted, AckWaitList[index].thingName, AckWaitList[index].action,
-								SHADOW_ACCEPTED);
-	topicNameFromThingAndAction(TemporaryTopicNameRejected, AckWaitList[index].thingName, AckWaitList[index].action,
-								SHADOW_REJECTED);
+	pTopics = getShadowTopicTable(pShadow, pShadow->ackWaitList[index].thingName);
+	if(NULL == pTopics) {
+		return;
+	}
+	pAcceptedTopic = getShadowTopic(pTopics, pShadow->ackWaitList[index].action, SHADOW_ACCEPTED, &acceptedTopicLength);
+	pRejectedTopic = getShadowTopic(pTopics, pShadow->ackWaitList[index].action, SHADOW_REJECTED, &rejectedTopicLength);
 
-	indexSubList = findIndexOfSubscriptionList(TemporaryTopicNameAccepted);
+	indexSubList = findIndexOfSubscriptionList(pShadow, pAcceptedTopic, acceptedTopicLength);
 	if((indexSubList >= 0)) {
-		if(!SubscriptionList[indexSubList].isSticky && (SubscriptionList[indexSubList].count == 1)) {
-			ret_val = aws_iot_mqtt_unsubscribe(pMqttClient, TemporaryTopicNameAccepted,
-											   (uint16_t) strlen(TemporaryTopicNameAccepted));
+		if(!pShadow->subscriptionList[indexSubList].isSticky && (pShadow->subscriptionList[indexSubList].count == 1)) {
+			ret_val = aws_iot_mqtt_unsubscribe(pShadow->pMqttClient, pShadow->subscriptionList[indexSubList].Topic,
+											   acceptedTopicLength);
 			if(ret_val == SUCCESS) {
-				SubscriptionList[indexSubList].isFree = true;
+				pShadow->subscriptionList[indexSubList].isFree = true;
 			}
-		} else if(SubscriptionList[indexSubList].count > 1) {
-			SubscriptionList[indexSubList].count--;
+		} else if(pShadow->subscriptionList[indexSubList].count > 1) {
+			pShadow->subscriptionList[indexSubList].count--;
 		}
 	}
 
-	indexSubList = findIndexOfSubscriptionList(TemporaryTopicNameRejected);
+	indexSubList = findIndexOfSubscriptionList(pShadow, pRejectedTopic, rejectedTopicLength);
 	if((indexSubList >= 0)) {
-		if(!SubscriptionList[indexSubList].isSticky && (SubscriptionList[indexSubList].count == 1)) {
-			ret_val = aws_iot_mqtt_unsubscribe(pMqttClient, TemporaryTopicNameRejected,
-											   (uint16_t) strlen(TemporaryTopicNameRejected));
+		if(!pShadow->subscriptionList[indexSubList].isSticky && (pShadow->subscriptionList[indexSubList].count == 1)) {
+			ret_val = aws_iot_mqtt_unsubscribe(pShadow->pMqttClient, pShadow->subscriptionList[indexSubList].Topic,
+											   rejectedTopicLength);
 			if(ret_val == SUCCESS) {
-				SubscriptionList[indexSubList].isFree = true;
+				pShadow->subscriptionList[indexSubList].isFree = true;
 			}
-		} else if(SubscriptionList[indexSubList].count > 1) {
-			SubscriptionList[indexSubList].count--;
+		} else if(pShadow->subscriptionList[indexSubList].count > 1) {
+			pShadow->subscriptionList[indexSubList].count--;
 		}
 	}
 }
 
-void initializeRecords(AWS_IoT_Client *pClient) {
+void initializeRecords(ShadowClient_t *pShadow, AWS_IoT_Client *pClient) {
 	uint8_t i;
 	for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
-		AckWaitList[i].isFree = true;
+		pShadow->ackWaitList[i].isFree = true;
 	}
 	for(i = 0; i < MAX_TOPICS_AT_ANY_GIVEN_TIME; i++) {
-		SubscriptionList[i].isFree = true;
-		SubscriptionList[i].count = 0;
-		SubscriptionList[i].isSticky = false;
+		pShadow->subscriptionList[i].isFree = true;
+		pShadow->subscriptionList[i].count = 0;
+		pShadow->subscriptionList[i].isSticky = false;
+		pShadow->subscriptionList[i].pShadow = pShadow;
 	}
+	initShadowTopicTables(pShadow);
 
-	pMqttClient = pClient;
+	pShadow->pMqttClient = pClient;
 }
 
-bool isSubscriptionPresent(const char *pThingName, ShadowActions_t action) {
+bool isSubscriptionPresent(ShadowClient_t *pShadow, const char *pThingName, ShadowActions_t action) {
 
 	uint8_t i = 0;
 	bool isAcceptedPresent = false;
 	bool isRejectedPresent = false;
-	char TemporaryTopicNameAccepted[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	char TemporaryTopicNameRejected[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	const ShadowTopicTable_t *pTopics;
+	const char *pAcceptedTopic, *pRejectedTopic;
+	uint16_t acceptedTopicLength, rejectedTopicLength;
 
-	topicNameFromThingAndAction(TemporaryTopicNameAccepted, pThingName, action, SHADOW_ACCEPTED);
-	topicNameFromThingAndAction(TemporaryTopicNameRejected, pThingName, action, SHADOW_REJECTED);
+	pTopics = getShadowTopicTable(pShadow, pThingName);
+	if(NULL == pTopics) {
+		return false;
+	}
+	pAcceptedTopic = getShadowTopic(pTopics, action, SHADOW_ACCEPTED, &acceptedTopicLength);
+	pRejectedTopic = getShadowTopic(pTopics, action, SHADOW_REJECTED, &rejectedTopicLength);
 
 	for(i = 0; i < MAX_TOPICS_AT_ANY_GIVEN_TIME; i++) {
-		if(!SubscriptionList[i].isFree) {
-			if((strcmp(TemporaryTopicNameAccepted, SubscriptionList[i].Topic) == 0)) {
+		if(!pShadow->subscriptionList[i].isFree) {
+			if(isSubscriptionTopic(&pShadow->subscriptionList[i], pAcceptedTopic, acceptedTopicLength)) {
 				isAcceptedPresent = true;
-			} else if((strcmp(TemporaryTopicNameRejected, SubscriptionList[i].Topic) == 0)) {
+			} else if(isSubscriptionTopic(&pShadow->subscriptionList[i], pRejectedTopic, rejectedTopicLength)) {
 				isRejectedPresent = true;
 			}
 		}
@@ -329,32 +302,53 @@ bool isSubscriptionPresent(const char *pThingName, ShadowActions_t action) {
 	return false;
 }
 
-IoT_Error_t subscribeToShadowActionAcks(const char *pThingName, ShadowActions_t action, bool isSticky) {
+static void setAckSubscription(ShadowClient_t *pShadow, int16_t index, const char *pThingName,
+							   ShadowActions_t action, Shadow_Ack_Status_t status) {
+	pShadow->subscriptionList[index].pShadow = pShadow;
+	pShadow->subscriptionList[index].action = action;
+	pShadow->subscriptionList[index].status = status;
+	pShadow->subscriptionList[index].isMyThing = (strcmp(pThingName, pShadow->myThingName) == 0);
+}
+
+IoT_Error_t subscribeToShadowActionAcks(ShadowClient_t *pShadow, const char *pThingName, ShadowActions_t action,
+										bool isSticky) {
 	IoT_Error_t ret_val = SUCCESS;
 
 	bool clearBothEntriesFromList = true;
 	int16_t indexAcceptedSubList = 0;
 	int16_t indexRejectedSubList = 0;
 	Timer subSettlingtimer;
-	indexAcceptedSubList = getNextFreeIndexOfSubscriptionList();
-	indexRejectedSubList = getNextFreeIndexOfSubscriptionList();
+	const ShadowTopicTable_t *pTopics;
+	const char *pTopic;
+	uint16_t topicLength;
+
+	pTopics = getShadowTopicTable(pShadow, pThingName);
+	if(NULL == pTopics) {
+		return MAX_SIZE_ERROR;
+	}
+
+	indexAcceptedSubList = getNextFreeIndexOfSubscriptionList(pShadow);
+	indexRejectedSubList = getNextFreeIndexOfSubscriptionList(pShadow);
 
 	if(indexAcceptedSubList >= 0 && indexRejectedSubList >= 0) {
-		topicNameFromThingAndAction(SubscriptionList[indexAcceptedSubList].Topic, pThingName, action, SHADOW_ACCEPTED);
-		ret_val = aws_iot_mqtt_subscribe(pMqttClient, SubscriptionList[indexAcceptedSubList].Topic,
-										 (uint16_t) strlen(SubscriptionList[indexAcceptedSubList].Topic), QOS0,
-										 AckStatusCallback, NULL);
+		setAckSubscription(pShadow, indexAcceptedSubList, pThingName, action, SHADOW_ACK_ACCEPTED);
+		setAckSubscription(pShadow, indexRejectedSubList, pThingName, action, SHADOW_ACK_REJECTED);
+		pTopic = getShadowTopic(pTopics, action, SHADOW_ACCEPTED, &topicLength);
+		memcpy(pShadow->subscriptionList[indexAcceptedSubList].Topic, pTopic, (size_t) topicLength + 1);
+		ret_val = aws_iot_mqtt_subscribe(pShadow->pMqttClient, pShadow->subscriptionList[indexAcceptedSubList].Topic,
+										 topicLength, QOS0,
+										 AckStatusCallback, &(pShadow->subscriptionList[indexAcceptedSubList]));
 		if(ret_val == SUCCESS) {
-			SubscriptionList[indexAcceptedSubList].count = 1;
-			SubscriptionList[indexAcceptedSubList].isSticky = isSticky;
-			topicNameFromThingAndAction(SubscriptionList[indexRejectedSubList].Topic, pThingName, action,
-										SHADOW_REJECTED);
-			ret_val = aws_iot_mqtt_subscribe(pMqttClient, SubscriptionList[indexRejectedSubList].Topic,
-											 (uint16_t) strlen(SubscriptionList[indexRejectedSubList].Topic), QOS0,
-											 AckStatusCallback, NULL);
+			pShadow->subscriptionList[indexAcceptedSubList].count = 1;
+			pShadow->subscriptionList[indexAcceptedSubList].isSticky = isSticky;
+			pTopic = getShadowTopic(pTopics, action, SHADOW_REJECTED, &topicLength);
+			memcpy(pShadow->subscriptionList[indexRejectedSubList].Topic, pTopic, (size_t) topicLength + 1);
+			ret_val = aws_iot_mqtt_subscribe(pShadow->pMqttClient, pShadow->subscriptionList[indexRejectedSubList].Topic,
+											 topicLength, QOS0,
+											 AckStatusCallback, &(pShadow->subscriptionList[indexRejectedSubList]));
 			if(ret_val == SUCCESS) {
-				SubscriptionList[indexRejectedSubList].count = 1;
-				SubscriptionList[indexRejectedSubList].isSticky = isSticky;
+				pShadow->subscriptionList[indexRejectedSubList].count = 1;
+				pShadow->subscriptionList[indexRejectedSubList].isSticky = isSticky;
 				clearBothEntriesFromList = false;
 
 				// wait for SUBSCRIBE_SETTLING_TIME seconds to let the subscription take effect
@@ -368,15 +362,15 @@ IoT_Error_t subscribeToShadowActionAcks(const char *pThingName, ShadowActions_t
 
 	if(clearBothEntriesFromList) {
 		if(indexAcceptedSubList >= 0) {
-			SubscriptionList[indexAcceptedSubList].isFree = true;
+			pShadow->subscriptionList[indexAcceptedSubList].isFree = true;
 			
-			if(SubscriptionList[indexAcceptedSubList].count == 1) {
-			    aws_iot_mqtt_unsubscribe(pMqttClient, SubscriptionList[indexAcceptedSubList].Topic,
-				(uint16_t) strlen(SubscriptionList[indexAcceptedSubList].Topic));
+			if(pShadow->subscriptionList[indexAcceptedSubList].count == 1) {
+			    aws_iot_mqtt_unsubscribe(pShadow->pMqttClient, pShadow->subscriptionList[indexAcceptedSubList].Topic,
+				(uint16_t) strlen(pShadow->subscriptionList[indexAcceptedSubList].Topic));
 		    }
 		}
 		if(indexRejectedSubList >= 0) {
-			SubscriptionList[indexRejectedSubList].isFree = true;
+			pShadow->subscriptionList[indexRejectedSubList].isFree = true;
 		}
 
 	}
@@ -384,54 +378,77 @@ IoT_Error_t subscribeToShadowActionAcks(const char *pThingName, ShadowActions_t
 	return ret_val;
 }
 
-void incrementSubscriptionCnt(const char *pThingName, ShadowActions_t action, bool isSticky) {
-	char TemporaryTopicNameAccepted[MAX_SHADOW_TOPIC_LENGTH_BYTES];
-	char TemporaryTopicNameRejected[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+void incrementSubscriptionCnt(ShadowClient_t *pShadow, const char *pThingName, ShadowActions_t action,
+							  bool isSticky) {
+	const ShadowTopicTable_t *pTopics;
+	const char *pAcceptedTopic, *pRejectedTopic;
+	uint16_t acceptedTopicLength, rejectedTopicLength;
 	uint8_t i;
-	topicNameFromThingAndAction(TemporaryTopicNameAccepted, pThingName, action, SHADOW_ACCEPTED);
-	topicNameFromThingAndAction(TemporaryTopicNameRejected, pThingName, action, SHADOW_REJECTED);
+
+	pTopics = getShadowTopicTable(pShadow, pThingName);
+	if(NULL == pTopics) {
+		return;
+	}
+	pAcceptedTopic = getShadowTopic(pTopics, action, SHADOW_ACCEPTED, &acceptedTopicLength);
+	pRejectedTopic = getShadowTopic(pTopics, action, SHADOW_REJECTED, &rejectedTopicLength);
 
 	for(i = 0; i < MAX_TOPICS_AT_ANY_GIVEN_TIME; i++) {
-		if(!SubscriptionList[i].isFree) {
-			if((strcmp(TemporaryTopicNameAccepted, SubscriptionList[i].Topic) == 0)
-			   || (strcmp(TemporaryTopicNameRejected, SubscriptionList[i].Topic) == 0)) {
-				SubscriptionList[i].count++;
-				SubscriptionList[i].isSticky = isSticky;
+		if(!pShadow->subscriptionList[i].isFree) {
+			if(isSubscriptionTopic(&pShadow->subscriptionList[i], pAcceptedTopic, acceptedTopicLength)
+			   || isSubscriptionTopic(&pShadow->subscriptionList[i], pRejectedTopic, rejectedTopicLength)) {
+				pShadow->subscriptionList[i].count++;
+				pShadow->subscriptionList[i].isSticky = isSticky;
 			}
 		}
 	}
 }
 
-IoT_Error_t publishToShadowAction(const char *pThingName, ShadowActions_t action, const char *pJsonDocumentToBeSent) {
+IoT_Error_t publishToShadowAction(ShadowClient_t *pShadow, const char *pThingName, ShadowActions_t action,
+								  const char *pJsonDocumentToBeSent) {
 	IoT_Error_t ret_val = SUCCESS;
-	char TemporaryTopicName[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+	const ShadowTopicTable_t *pTopics;
+	const char *pTopic;
+	uint16_t topicLength;
 	IoT_Publish_Message_Params msgParams;
 
 	if(NULL == pThingName || NULL == pJsonDocumentToBeSent) {
 		return NULL_VALUE_ERROR;
 	}
 
-	topicNameFromThingAndAction(TemporaryTopicName, pThingName, action, SHADOW_ACTION);
+	pTopics = getShadowTopicTable(pShadow, pThingName);
+	if(NULL == pTopics) {
+		return MAX_SIZE_ERROR;
+	}
+	pTopic = getShadowTopic(pTopics, action, SHADOW_ACTION, &topicLength);
 
 	msgParams.qos = QOS0;
 	msgParams.isRetained = 0;
 	msgParams.payloadLen = strlen(pJsonDocumentToBeSent);
 	msgParams.payload = (char *) pJsonDocumentToBeSent;
-	ret_val = aws_iot_mqtt_publish(pMqttClient, TemporaryTopicName, (uint16_t) strlen(TemporaryTopicName), &msgParams);
+	ret_val = aws_iot_mqtt_publish(pShadow->pMqttClient, pTopic, topicLength, &msgParams);
 
 	return ret_val;
 }
 
-bool getNextFreeIndexOfAckWaitList(uint8_t *pIndex) {
+bool getNextFreeIndexOfAckWaitList(ShadowClient_t *pShadow, const char *pClientToken, uint8_t *pIndex) {
 	uint8_t i;
+	uint32_t sequence;
 	bool rc = false;
 
 	if(NULL == pIndex) {
 		return false;
 	}
 
+	if(NULL != pClientToken && decodeClientTokenSequence(pShadow, pClientToken, &sequence)) {
+		i = (uint8_t) (sequence % MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME);
+		if(pShadow->ackWaitList[i].isFree) {
+			*pIndex = i;
+			return true;
+		}
+	}
+
 	for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
-		if(AckWaitList[i].isFree) {
+		if(pShadow->ackWaitList[i].isFree) {
 			*pIndex = i;
 			rc = true;
 			break;
@@ -441,30 +458,32 @@ bool getNextFreeIndexOfAckWaitList(uint8_t *pIndex) {
 	return rc;
 }
 
-void addToAckWaitList(uint8_t indexAckWaitList, const char *pThingName, ShadowActions_t action,
-					  const char *pExtractedClientToken, fpActionCallback_t callback, void *pCallbackContext,
-					  uint32_t timeout_seconds) {
-	AckWaitList[indexAckWaitList].callback = callback;
-	memcpy(AckWaitList[indexAckWaitList].clientTokenID, pExtractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE);
-	memcpy(AckWaitList[indexAckWaitList].thingName, pThingName, MAX_SIZE_OF_THING_NAME);
-	AckWaitList[indexAckWaitList].pCallbackContext = pCallbackContext;
-	AckWaitList[indexAckWaitList].action = action;
-	init_timer(&(AckWaitList[indexAckWaitList].timer));
-	countdown_sec(&(AckWaitList[indexAckWaitList].timer), timeout_seconds);
-	AckWaitList[indexAckWaitList].isFree = false;
+void addToAckWaitList(ShadowClient_t *pShadow, uint8_t indexAckWaitList, const char *pThingName,
+					  ShadowActions_t action, const char *pExtractedClientToken, fpActionCallback_t callback,
+					  void *pCallbackContext, uint32_t timeout_seconds) {
+	pShadow->ackWaitList[indexAckWaitList].callback = callback;
+	memcpy(pShadow->ackWaitList[indexAckWaitList].clientTokenID, pExtractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE);
+	pShadow->ackWaitList[indexAckWaitList].hasTokenSequence =
+		decodeClientTokenSequence(pShadow, pExtractedClientToken, &(pShadow->ackWaitList[indexAckWaitList].tokenSequence));
+	memcpy(pShadow->ackWaitList[indexAckWaitList].thingName, pThingName, MAX_SIZE_OF_THING_NAME);
+	pShadow->ackWaitList[indexAckWaitList].pCallbackContext = pCallbackContext;
+	pShadow->ackWaitList[indexAckWaitList].action = action;
+	init_timer(&(pShadow->ackWaitList[indexAckWaitList].timer));
+	countdown_sec(&(pShadow->ackWaitList[indexAckWaitList].timer), timeout_seconds);
+	pShadow->ackWaitList[indexAckWaitList].isFree = false;
 }
 
-void HandleExpiredResponseCallbacks(void) {
+void HandleExpiredResponseCallbacks(ShadowClient_t *pShadow) {
 	uint8_t i;
 	for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
-		if(!AckWaitList[i].isFree) {
-			if(has_timer_expired(&(AckWaitList[i].timer))) {
-				if(AckWaitList[i].callback != NULL) {
-					AckWaitList[i].callback(AckWaitList[i].thingName, AckWaitList[i].action, SHADOW_ACK_TIMEOUT,
-											shadowRxBuf, AckWaitList[i].pCallbackContext);
+		if(!pShadow->ackWaitList[i].isFree) {
+			if(has_timer_expired(&(pShadow->ackWaitList[i].timer))) {
+				if(pShadow->ackWaitList[i].callback != NULL) {
+					pShadow->ackWaitList[i].callback(pShadow->ackWaitList[i].thingName, pShadow->ackWaitList[i].action, SHADOW_ACK_TIMEOUT,
+											"", pShadow->ackWaitList[i].pCallbackContext);
 				}
-				AckWaitList[i].isFree = true;
-				unsubscribeFromAcceptedAndRejected(i);
+				pShadow->ackWaitList[i].isFree = true;
+				unsubscribeFromAcceptedAndRejected(pShadow, i);
 			}
 		}
 	}
@@ -472,56 +491,71 @@ void HandleExpiredResponseCallbacks(void) {
 
 static void shadow_delta_callback(AWS_IoT_Client *pClient, char *topicName,
 								  uint16_t topicNameLen, IoT_Publish_Message_Params *params, void *pData) {
+	ShadowClient_t *pShadow = (ShadowClient_t *) pData;
+	const char *pJsonDocument = (const char *) params->payload;
 	int32_t tokenCount;
 	uint32_t i = 0;
-	void *pJsonHandler = NULL;
 	int32_t DataPosition;
 	uint32_t dataLength;
 	uint32_t tempVersionNumber = 0;
+	int32_t stateIndex;
+	bool isMatching;
+	ShadowSchemaDelta_t *pSchemaDelta = pShadow->pSchemaDelta;
+	uint32_t fields;
 
 	FUNC_ENTRY;
 
 	IOT_UNUSED(pClient);
-	IOT_UNUSED(topicName);
-	IOT_UNUSED(topicNameLen);
-	IOT_UNUSED(pData);
 
-	if(params->payloadLen >= SHADOW_MAX_SIZE_OF_RX_BUFFER) {
-		IOT_WARN("Payload larger than RX Buffer");
-		return;
-	}
-
-	memcpy(shadowRxBuf, params->payload, params->payloadLen);
-	shadowRxBuf[params->payloadLen] = '\0';    // jsmn_parse relies on a string
-
-	if(!isJsonValidAndParse(shadowRxBuf, SHADOW_MAX_SIZE_OF_RX_BUFFER, pJsonHandler, &tokenCount)) {
+	if(!isJsonValidAndParse(pJsonDocument, params->payloadLen, &(pShadow->jsonParser), &tokenCount)) {
 		IOT_WARN("Received JSON is not valid");
 		return;
 	}
 
-	if(shadowDiscardOldDeltaFlag) {
-		if(extractVersionNumber(shadowRxBuf, pJsonHandler, tokenCount, &tempVersionNumber)) {
-			if(tempVersionNumber > shadowJsonVersionNum) {
-				shadowJsonVersionNum = tempVersionNumber;
+	if(pShadow->discardOldDeltaFlag) {
+		if(extractVersionNumber(pJsonDocument, &(pShadow->jsonParser), tokenCount, &tempVersionNumber)) {
+			if(tempVersionNumber > pShadow->jsonVersionNum) {
+				pShadow->jsonVersionNum = tempVersionNumber;
 			} else {
 				IOT_WARN("Old Delta Message received - Ignoring rx: %d local: %d", tempVersionNumber,
-						 shadowJsonVersionNum);
+						 pShadow->jsonVersionNum);
 				return;
 			}
 		}
 	}
 
-	for(i = 0; i < tokenTableIndex; i++) {
-		if(!tokenTable[i].isFree) {
-			if(isJsonKeyMatchingAndUpdateValue(shadowRxBuf, pJsonHandler, tokenCount,
-											   (jsonStruct_t *) tokenTable[i].pStruct, &dataLength, &DataPosition)) {
-				if(tokenTable[i].callback != NULL) {
-					tokenTable[i].callback(shadowRxBuf + DataPosition, dataLength,
-										   (jsonStruct_t *) tokenTable[i].pStruct);
+	applyShadowMirrorMessage(pShadow, topicName, topicNameLen, pJsonDocument, tokenCount);
+
+	/* Dotted paths are resolved from the state object of the delta, against the tokens parsed above */
+	stateIndex = findJsonObjectMember(pJsonDocument, &(pShadow->jsonParser), tokenCount, 0, "state");
+
+	for(i = 0; i < pShadow->tokenTableIndex; i++) {
+		if(!pShadow->tokenTable[i].isFree) {
+			if(pShadow->tokenTable[i].isPath) {
+				isMatching = isJsonPathMatchingAndUpdateValue(pJsonDocument, &(pShadow->jsonParser), tokenCount,
+															  stateIndex, (jsonStruct_t *) pShadow->tokenTable[i].pStruct,
+															  &dataLength, &DataPosition);
+			} else {
+				isMatching = isJsonKeyMatchingAndUpdateValue(pJsonDocument, &(pShadow->jsonParser), tokenCount,
+															 (jsonStruct_t *) pShadow->tokenTable[i].pStruct,
+															 &dataLength, &DataPosition);
+			}
+			if(isMatching) {
+				if(pShadow->tokenTable[i].callback != NULL) {
+					pShadow->tokenTable[i].callback(pJsonDocument + DataPosition, dataLength,
+										   (jsonStruct_t *) pShadow->tokenTable[i].pStruct);
 				}
 			}
 		}
 	}
+
+	if(NULL != pSchemaDelta && stateIndex >= 0) {
+		fields = pSchemaDelta->parse(pJsonDocument, pShadow->jsonParser.tokens, pShadow->jsonParser.tape, stateIndex,
+									 pSchemaDelta->pState);
+		if(0 != fields && NULL != pSchemaDelta->callback) {
+			pSchemaDelta->callback(pSchemaDelta->pState, fields, pSchemaDelta->pContext);
+		}
+	}
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,335 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_reported_cache.c
+ * @brief Last acknowledged reported state, used to report only the keys that changed
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IOT_LOG_MODULE IOT_LOG_MODULE_SHADOW
+
+#include "aws_iot_shadow_reported_cache.h"
+
+#include <string.h>
+#include <stdbool.h>
+
+#include "aws_iot_json_utils.h"
+#include "aws_iot_log.h"
+#include "aws_iot_shadow_json.h"
+#include "aws_iot_shadow_records.h"
+
+#if MAX_SHADOW_REPORTED_CACHE_ENTRIES > 255
+#error "MAX_SHADOW_REPORTED_CACHE_ENTRIES must fit the uint8_t field count of the JSON builder"
+#endif
+
+#define FNV1A_OFFSET_BASIS 2166136261u
+#define FNV1A_PRIME 16777619u
+
+static uint32_t hashText(const char *pText, size_t length) {
+	uint32_t hash = FNV1A_OFFSET_BASIS;
+	size_t i;
+
+	for(i = 0; i < length; i++) {
+		hash = (hash ^ (uint8_t) pText[i]) * FNV1A_PRIME;
+	}
+	return hash;
+}
+
+static void readCurrentValue(const jsonStruct_t *pStruct, ReportedValue_t *pValue) {
+	switch(pStruct->type) {
+		case SHADOW_JSON_INT32:
+			pValue->i = *(int32_t *) pStruct->pData;
+			break;
+		case SHADOW_JSON_INT16:
+			pValue->i = *(int16_t *) pStruct->pData;
+			break;
+		case SHADOW_JSON_INT8:
+			pValue->i = *(int8_t *) pStruct->pData;
+			break;
+		case SHADOW_JSON_UINT32:
+			pValue->u = *(uint32_t *) pStruct->pData;
+			break;
+		case SHADOW_JSON_UINT16:
+			pValue->u = *(uint16_t *) pStruct->pData;
+			break;
+		case SHADOW_JSON_UINT8:
+			pValue->u = *(uint8_t *) pStruct->pData;
+			break;
+		case SHADOW_JSON_BOOL:
+			pValue->u = *(bool *) pStruct->pData;
+			break;
+		case SHADOW_JSON_FLOAT:
+			pValue->d = *(float *) pStruct->pData;
+			break;
+		case SHADOW_JSON_DOUBLE:
+			pValue->d = *(double *) pStruct->pData;
+			break;
+		case SHADOW_JSON_STRING:
+		case SHADOW_JSON_OBJECT:
+		default:
+			pValue->hash = hashText((const char *) pStruct->pData, strlen((const char *) pStruct->pData));
+			break;
+	}
+}
+
+static IoT_Error_t parseAckedValue(const char *pJsonDocument, jsmntok_t *pToken, JsonPrimitiveType type,
+								   ReportedValue_t *pValue) {
+	const char *pFirst = pJsonDocument + pToken->start;
+	const char *pLast = pJsonDocument + pToken->end;
+	IoT_Error_t rc = JSON_PARSE_ERROR;
+	float floatValue;
+	bool boolValue;
+
+	if(SHADOW_JSON_OBJECT != type && SHADOW_JSON_STRING != type && JSMN_PRIMITIVE != pToken->type) {
+		return JSON_PARSE_ERROR;
+	}
+
+	switch(type) {
+		case SHADOW_JSON_INT32:
+			rc = parseSignedIntegerFromChars(pFirst, pLast, INT32_MIN, INT32_MAX, &pValue->i);
+			break;
+		case SHADOW_JSON_INT16:
+			rc = parseSignedIntegerFromChars(pFirst, pLast, INT16_MIN, INT16_MAX, &pValue->i);
+			break;
+		case SHADOW_JSON_INT8:
+			rc = parseSignedIntegerFromChars(pFirst, pLast, INT8_MIN, INT8_MAX, &pValue->i);
+			break;
+		case SHADOW_JSON_UINT32:
+			rc = parseUnsignedIntegerFromChars(pFirst, pLast, UINT32_MAX, &pValue->u);
+			break;
+		case SHADOW_JSON_UINT16:
+			rc = parseUnsignedIntegerFromChars(pFirst, pLast, UINT16_MAX, &pValue->u);
+			break;
+		case SHADOW_JSON_UINT8:
+			rc = parseUnsignedIntegerFromChars(pFirst, pLast, UINT8_MAX, &pValue->u);
+			break;
+		case SHADOW_JSON_BOOL:
+			rc = parseBooleanValue(&boolValue, pJsonDocument, pToken);
+			pValue->u = boolValue;
+			break;
+		case SHADOW_JSON_FLOAT:
+			/* Parsed as a float so that it compares equal to the value that was sent */
+			rc = parseFloatFromChars(pFirst, pLast, &floatValue);
+			pValue->d = floatValue;
+			break;
+		case SHADOW_JSON_DOUBLE:
+			rc = parseDoubleFromChars(pFirst, pLast, &pValue->d);
+			break;
+		case SHADOW_JSON_STRING:
+			/* The local copy is unescaped, only plain strings can be compared */
+			if(JSMN_STRING != pToken->type || NULL != memchr(pFirst, '\\', (size_t) (pLast - pFirst))) {
+				return JSON_PARSE_ERROR;
+			}
+			pValue->hash = hashText(pFirst, (size_t) (pLast - pFirst));
+			rc = SUCCESS;
+			break;
+		case SHADOW_JSON_OBJECT:
+		default:
+			pValue->hash = hashText(pFirst, (size_t) (pLast - pFirst));
+			rc = SUCCESS;
+			break;
+	}
+
+	return rc;
+}
+
+static bool isEntryDirty(const ReportedCacheEntry_t *pEntry) {
+	ReportedValue_t current;
+	double difference;
+
+	if(pEntry->isForced || !pEntry->hasAckedValue) {
+		return true;
+	}
+
+	readCurrentValue(pEntry->pStruct, &current);
+	switch(pEntry->pStruct->type) {
+		case SHADOW_JSON_INT32:
+		case SHADOW_JSON_INT16:
+		case SHADOW_JSON_INT8:
+			return current.i != pEntry->acked.i;
+		case SHADOW_JSON_UINT32:
+		case SHADOW_JSON_UINT16:
+		case SHADOW_JSON_UINT8:
+		case SHADOW_JSON_BOOL:
+			return current.u != pEntry->acked.u;
+		case SHADOW_JSON_FLOAT:
+		case SHADOW_JSON_DOUBLE:
+			difference = current.d - pEntry->acked.d;
+			if(difference < 0) {
+				difference = -difference;
+			}
+			/* Written so that NaN is always dirty */
+			return !(difference <= pEntry->epsilon);
+		case SHADOW_JSON_STRING:
+		case SHADOW_JSON_OBJECT:
+		default:
+			return current.hash != pEntry->acked.hash;
+	}
+}
+
+static ReportedCacheEntry_t *findEntryByKey(ShadowClient_t *pShadow, const char *pKey) {
+	uint8_t i;
+
+	for(i = 0; i < pShadow->reportedCacheCount; i++) {
+		if(strcmp(pShadow->reportedCache[i].pStruct->pKey, pKey) == 0) {
+			return &(pShadow->reportedCache[i]);
+		}
+	}
+	return NULL;
+}
+
+void initReportedCache(ShadowClient_t *pShadow) {
+	pShadow->reportedCacheCount = 0;
+}
+
+IoT_Error_t aws_iot_shadow_register_reported(jsonStruct_t *pStruct, float epsilon) {
+	return aws_iot_shadow_client_register_reported(&defaultShadowClient, pStruct, epsilon);
+}
+
+IoT_Error_t aws_iot_shadow_client_register_reported(ShadowClient_t *pShadow, jsonStruct_t *pStruct, float epsilon) {
+	ReportedCacheEntry_t *pEntry;
+
+	if(NULL == pShadow || NULL == pStruct || NULL == pStruct->pKey || NULL == pStruct->pData) {
+		return NULL_VALUE_ERROR;
+	}
+
+	pEntry = findEntryByKey(pShadow, pStruct->pKey);
+	if(NULL == pEntry) {
+		if(pShadow->reportedCacheCount >= MAX_SHADOW_REPORTED_CACHE_ENTRIES) {
+			IOT_WARN("Reported cache is full, raise MAX_SHADOW_REPORTED_CACHE_ENTRIES");
+			return FAILURE;
+		}
+		pEntry = &(pShadow->reportedCache[pShadow->reportedCacheCount++]);
+		pEntry->hasAckedValue = false;
+		pEntry->isForced = false;
+	} else if(pEntry->pStruct->type != pStruct->type) {
+		pEntry->hasAckedValue = false;
+	}
+
+	pEntry->pStruct = pStruct;
+	pEntry->epsilon = epsilon;
+
+	return SUCCESS;
+}
+
+IoT_Error_t aws_iot_shadow_mark_reported_dirty(jsonStruct_t *pStruct) {
+	return aws_iot_shadow_client_mark_reported_dirty(&defaultShadowClient, pStruct);
+}
+
+IoT_Error_t aws_iot_shadow_client_mark_reported_dirty(ShadowClient_t *pShadow, jsonStruct_t *pStruct) {
+	uint8_t i;
+
+	if(NULL == pShadow || NULL == pStruct) {
+		return NULL_VALUE_ERROR;
+	}
+
+	for(i = 0; i < pShadow->reportedCacheCount; i++) {
+		if(pShadow->reportedCache[i].pStruct == pStruct) {
+			pShadow->reportedCache[i].isForced = true;
+			return SUCCESS;
+		}
+	}
+	return FAILURE;
+}
+
+IoT_Error_t aws_iot_shadow_add_reported_dirty(char *pJsonDocument, size_t maxSizeOfJsonDocument,
+											  uint8_t *pDirtyCount) {
+	return aws_iot_shadow_client_add_reported_dirty(&defaultShadowClient, pJsonDocument, maxSizeOfJsonDocument,
+													pDirtyCount);
+}
+
+IoT_Error_t aws_iot_shadow_client_add_reported_dirty(ShadowClient_t *pShadow, char *pJsonDocument,
+													 size_t maxSizeOfJsonDocument, uint8_t *pDirtyCount) {
+	jsonStruct_t *dirtyStructs[MAX_SHADOW_REPORTED_CACHE_ENTRIES];
+	uint8_t dirtyCount = 0;
+	IoT_Error_t rc;
+	uint8_t i;
+
+	if(NULL == pShadow || NULL == pJsonDocument || NULL == pDirtyCount) {
+		return NULL_VALUE_ERROR;
+	}
+
+	for(i = 0; i < pShadow->reportedCacheCount; i++) {
+		if(isEntryDirty(&(pShadow->reportedCache[i]))) {
+			dirtyStructs[dirtyCount++] = pShadow->reportedCache[i].pStruct;
+		}
+	}
+
+	*pDirtyCount = 0;
+	if(0 == dirtyCount) {
+		return SUCCESS;
+	}
+
+	/* Forced keys stay forced until an accepted update reports them */
+	rc = addJsonSectionFromArray(pJsonDocument, maxSizeOfJsonDocument, "reported", dirtyCount, dirtyStructs);
+	if(SUCCESS == rc) {
+		*pDirtyCount = dirtyCount;
+	}
+
+	return rc;
+}
+
+void aws_iot_shadow_reset_reported_cache(void) {
+	aws_iot_shadow_client_reset_reported_cache(&defaultShadowClient);
+}
+
+void aws_iot_shadow_client_reset_reported_cache(ShadowClient_t *pShadow) {
+	uint8_t i;
+
+	if(NULL == pShadow) {
+		return;
+	}
+
+	for(i = 0; i < pShadow->reportedCacheCount; i++) {
+		pShadow->reportedCache[i].hasAckedValue = false;
+	}
+}
+
+void updateReportedCacheFromDocument(ShadowClient_t *pShadow, const char *pJsonDocument, int32_t tokenCount,
+									 bool isUpdateAccepted) {
+	int32_t sectionIndex;
+	jsmntok_t valueToken;
+	ReportedCacheEntry_t *pEntry;
+	uint8_t i;
+
+	if(0 == pShadow->reportedCacheCount) {
+		return;
+	}
+
+	sectionIndex = findJsonStateSection(pJsonDocument, &(pShadow->jsonParser), tokenCount, "reported");
+	if(sectionIndex < 0) {
+		return;
+	}
+
+	for(i = 0; i < pShadow->reportedCacheCount; i++) {
+		pEntry = &(pShadow->reportedCache[i]);
+		if(extractJsonSectionValue(pJsonDocument, &(pShadow->jsonParser), tokenCount, sectionIndex, pEntry->pStruct->pKey, &valueToken)) {
+			/* A null or unparsable value leaves nothing to compare against */
+			pEntry->hasAckedValue = (SUCCESS == parseAckedValue(pJsonDocument, &valueToken, pEntry->pStruct->type,
+																&pEntry->acked));
+			if(isUpdateAccepted) {
+				pEntry->isForced = false;
+			}
+		}
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_shadow_topics.c
+ * @brief Shadow topics of each thing, built once instead of on every action
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_shadow_topics.h"
+
+#include <string.h>
+
+#if MAX_SHADOW_TOPIC_TABLES < 1 || MAX_SHADOW_TOPIC_TABLES > 255
+#error "MAX_SHADOW_TOPIC_TABLES must be between 1 and 255"
+#endif
+
+#define SHADOW_TOPIC_PREFIX "$aws/things/"
+#define SHADOW_TOPIC_INFIX "/shadow/"
+#define SHADOW_ACTION_COUNT 3
+#define SHADOW_DELTA_TOPIC_INDEX (SHADOW_ACTION_COUNT * 3)
+
+static const char *const actionNames[SHADOW_ACTION_COUNT] = {"get", "update", "delete"};
+static const uint8_t actionNameLengths[SHADOW_ACTION_COUNT] = {3, 6, 6};
+
+/* Appends the thing prefix, already at the start of the storage, the action and the suffix */
+static void appendTopic(ShadowTopicTable_t *pTable, uint16_t *pUsed, uint16_t prefixLength, uint8_t topicIndex,
+						const char *pAction, uint8_t actionLength, const char *pSuffix, uint8_t suffixLength) {
+	char *pTopic = pTable->storage + *pUsed;
+
+	if(0 != *pUsed) {
+		memcpy(pTopic, pTable->storage, prefixLength);
+	}
+	memcpy(pTopic + prefixLength, pAction, actionLength);
+	memcpy(pTopic + prefixLength + actionLength, pSuffix, suffixLength);
+	pTopic[prefixLength + actionLength + suffixLength] = '\0';
+
+	pTable->topics[topicIndex].offset = *pUsed;
+	pTable->topics[topicIndex].length = (uint16_t) (prefixLength + actionLength + suffixLength);
+	*pUsed = (uint16_t) (*pUsed + pTable->topics[topicIndex].length + 1);
+}
+
+static void buildShadowTopicTable(ShadowTopicTable_t *pTable, const char *pThingName, size_t thingNameLength) {
+	uint16_t prefixLength;
+	uint16_t used = 0;
+	uint8_t action;
+
+	memcpy(pTable->thingName, pThingName, thingNameLength + 1);
+
+	memcpy(pTable->storage, SHADOW_TOPIC_PREFIX, sizeof(SHADOW_TOPIC_PREFIX) - 1);
+	prefixLength = (uint16_t) (sizeof(SHADOW_TOPIC_PREFIX) - 1);
+	memcpy(pTable->storage + prefixLength, pThingName, thingNameLength);
+	prefixLength = (uint16_t) (prefixLength + thingNameLength);
+	memcpy(pTable->storage + prefixLength, SHADOW_TOPIC_INFIX, sizeof(SHADOW_TOPIC_INFIX) - 1);
+	prefixLength = (uint16_t) (prefixLength + sizeof(SHADOW_TOPIC_INFIX) - 1);
+
+	for(action = 0; action < SHADOW_ACTION_COUNT; action++) {
+		appendTopic(pTable, &used, prefixLength, (uint8_t) (action * 3 + SHADOW_ACCEPTED), actionNames[action],
+					actionNameLengths[action], "/accepted", 9);
+		appendTopic(pTable, &used, prefixLength, (uint8_t) (action * 3 + SHADOW_REJECTED), actionNames[action],
+					actionNameLengths[action], "/rejected", 9);
+		pTable->topics[action * 3 + SHADOW_ACTION].offset = pTable->topics[action * 3 + SHADOW_ACCEPTED].offset;
+		pTable->topics[action * 3 + SHADOW_ACTION].length = (uint16_t) (prefixLength + actionNameLengths[action]);
+	}
+	appendTopic(pTable, &used, prefixLength, SHADOW_DELTA_TOPIC_INDEX, "update", 6, "/delta", 6);
+
+	pTable->isUsed = true;
+}
+
+void initShadowTopicTables(ShadowClient_t *pShadow) {
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_TOPIC_TABLES; i++) {
+		pShadow->topicTables[i].isUsed = false;
+	}
+	pShadow->nextTopicTable = 0;
+}
+
+const ShadowTopicTable_t *getShadowTopicTable(ShadowClient_t *pShadow, const char *pThingName) {
+	ShadowTopicTable_t *pTable;
+	size_t thingNameLength;
+	uint8_t i;
+
+	for(i = 0; i < MAX_SHADOW_TOPIC_TABLES; i++) {
+		if(pShadow->topicTables[i].isUsed && 0 == strcmp(pShadow->topicTables[i].thingName, pThingName)) {
+			return &pShadow->topicTables[i];
+		}
+	}
+
+	thingNameLength = strlen(pThingName);
+	if(thingNameLength >= MAX_SIZE_OF_THING_NAME) {
+		return NULL;
+	}
+
+	/* The first table is built at connect for the client thing, other things take the rest in turn */
+	if(!pShadow->topicTables[0].isUsed || 1 == MAX_SHADOW_TOPIC_TABLES) {
+		i = 0;
+	} else {
+		i = (uint8_t) (1 + pShadow->nextTopicTable % (MAX_SHADOW_TOPIC_TABLES - 1));
+		pShadow->nextTopicTable = (uint8_t) (pShadow->nextTopicTable + 1);
+	}
+
+	pTable = &pShadow->topicTables[i];
+	buildShadowTopicTable(pTable, pThingName, thingNameLength);
+	return pTable;
+}
+
+const char *getShadowTopic(const ShadowTopicTable_t *pTable, ShadowActions_t action, ShadowAckTopicTypes_t ackType,
+						   uint16_t *pLength) {
+	const ShadowTopicSpan_t *pSpan = &pTable->topics[(uint8_t) action * 3 + (uint8_t) ackType];
+
+	*pLength = pSpan->length;
+	return pTable->storage + pSpan->offset;
+}
+
+const char *getShadowDeltaTopic(const ShadowTopicTable_t *pTable, uint16_t *pLength) {
+	*pLength = pTable->topics[SHADOW_DELTA_TOPIC_INDEX].length;
+	return pTable->storage + pTable->topics[SHADOW_DELTA_TOPIC_INDEX].offset;
+}
+
+#ifdef __cplusplus
+}
+#endif
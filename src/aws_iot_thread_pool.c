@@ -0,0 +1,219 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_thread_pool.c
+ * @brief Fixed size pool of worker threads running queued tasks
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "aws_iot_thread_pool.h"
+
+#ifdef _ENABLE_THREAD_SUPPORT_
+
+#include <string.h>
+
+#include "aws_iot_log.h"
+#include "timer_interface.h"
+
+static void _aws_iot_thread_pool_worker(void *pArg) {
+	IoT_Thread_Pool_t *pPool = (IoT_Thread_Pool_t *) pArg;
+	IoT_Thread_Pool_Job_t job;
+
+	aws_iot_thread_mutex_lock(&pPool->lock);
+	for(;;) {
+		while(0 == pPool->queueCount && !pPool->isStopping) {
+			aws_iot_thread_cond_wait(&pPool->workAvailable, &pPool->lock);
+		}
+		if(0 == pPool->queueCount) {
+			break;
+		}
+
+		job = pPool->queue[pPool->queueHead];
+		pPool->queueHead = (uint16_t) ((pPool->queueHead + 1) % AWS_IOT_THREAD_POOL_QUEUE_SIZE);
+		pPool->queueCount--;
+		pPool->busyCount++;
+		aws_iot_thread_mutex_unlock(&pPool->lock);
+
+		job.task(job.pArg);
+
+		aws_iot_thread_mutex_lock(&pPool->lock);
+		pPool->busyCount--;
+		if(0 == pPool->queueCount && 0 == pPool->busyCount) {
+			aws_iot_thread_cond_broadcast(&pPool->idle);
+		}
+	}
+	aws_iot_thread_mutex_unlock(&pPool->lock);
+}
+
+/* Lets the started workers drain the queue and exit, then releases the synchronization objects */
+static IoT_Error_t _aws_iot_thread_pool_stop(IoT_Thread_Pool_t *pPool) {
+	IoT_Error_t rc = SUCCESS, stepRc;
+	uint8_t i;
+
+	aws_iot_thread_mutex_lock(&pPool->lock);
+	pPool->isStopping = true;
+	aws_iot_thread_cond_broadcast(&pPool->workAvailable);
+	aws_iot_thread_mutex_unlock(&pPool->lock);
+
+	for(i = 0; i < pPool->threadCount; i++) {
+		stepRc = aws_iot_thread_join(&pPool->threads[i]);
+		if(SUCCESS == rc) {
+			rc = stepRc;
+		}
+	}
+	pPool->threadCount = 0;
+
+	stepRc = aws_iot_thread_cond_destroy(&pPool->idle);
+	if(SUCCESS == rc) {
+		rc = stepRc;
+	}
+	stepRc = aws_iot_thread_cond_destroy(&pPool->workAvailable);
+	if(SUCCESS == rc) {
+		rc = stepRc;
+	}
+	stepRc = aws_iot_thread_mutex_destroy(&pPool->lock);
+	if(SUCCESS == rc) {
+		rc = stepRc;
+	}
+
+	return rc;
+}
+
+IoT_Error_t aws_iot_thread_pool_init(IoT_Thread_Pool_t *pPool, uint8_t threadCount,
+									 const IoT_Thread_Params_t *pParams) {
+	IoT_Error_t rc;
+	uint8_t i;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	if(0 == threadCount || threadCount > AWS_IOT_THREAD_POOL_MAX_THREADS) {
+		FUNC_EXIT_RC(LIMIT_EXCEEDED_ERROR);
+	}
+
+	memset(pPool, 0, sizeof(IoT_Thread_Pool_t));
+
+	rc = aws_iot_thread_mutex_init(&pPool->lock);
+	if(SUCCESS != rc) {
+		FUNC_EXIT_RC(rc);
+	}
+	rc = aws_iot_thread_cond_init(&pPool->workAvailable);
+	if(SUCCESS != rc) {
+		aws_iot_thread_mutex_destroy(&pPool->lock);
+		FUNC_EXIT_RC(rc);
+	}
+	rc = aws_iot_thread_cond_init(&pPool->idle);
+	if(SUCCESS != rc) {
+		aws_iot_thread_cond_destroy(&pPool->workAvailable);
+		aws_iot_thread_mutex_destroy(&pPool->lock);
+		FUNC_EXIT_RC(rc);
+	}
+
+	for(i = 0; i < threadCount; i++) {
+		rc = aws_iot_thread_create(&pPool->threads[i], _aws_iot_thread_pool_worker, pPool, pParams);
+		if(SUCCESS != rc) {
+			IOT_ERROR("Failed to start thread pool worker %u", i);
+			(void) _aws_iot_thread_pool_stop(pPool);
+			FUNC_EXIT_RC(rc);
+		}
+		pPool->threadCount++;
+	}
+
+	FUNC_EXIT_RC(SUCCESS);
+}
+
+IoT_Error_t aws_iot_thread_pool_submit(IoT_Thread_Pool_t *pPool, IoT_Thread_Pool_Task_t task, void *pArg) {
+	IoT_Error_t rc = SUCCESS;
+	uint16_t tail;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool || NULL == task) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	aws_iot_thread_mutex_lock(&pPool->lock);
+	if(pPool->isStopping) {
+		rc = FAILURE;
+	} else if(AWS_IOT_THREAD_POOL_QUEUE_SIZE == pPool->queueCount) {
+		rc = LIMIT_EXCEEDED_ERROR;
+	} else {
+		tail = (uint16_t) ((pPool->queueHead + pPool->queueCount) % AWS_IOT_THREAD_POOL_QUEUE_SIZE);
+		pPool->queue[tail].task = task;
+		pPool->queue[tail].pArg = pArg;
+		pPool->queueCount++;
+		aws_iot_thread_cond_signal(&pPool->workAvailable);
+	}
+	aws_iot_thread_mutex_unlock(&pPool->lock);
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_thread_pool_wait_idle(IoT_Thread_Pool_t *pPool, uint32_t timeoutMs) {
+	IoT_Error_t rc = SUCCESS;
+	Timer timer;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	init_timer(&timer);
+	countdown_ms(&timer, timeoutMs);
+
+	aws_iot_thread_mutex_lock(&pPool->lock);
+	while(0 != pPool->queueCount || 0 != pPool->busyCount) {
+		if(has_timer_expired(&timer)) {
+			rc = THREAD_WAIT_TIMEOUT_ERROR;
+			break;
+		}
+		rc = aws_iot_thread_cond_timedwait(&pPool->idle, &pPool->lock, left_ms(&timer));
+		if(SUCCESS != rc && THREAD_WAIT_TIMEOUT_ERROR != rc) {
+			break;
+		}
+		rc = SUCCESS;
+	}
+	aws_iot_thread_mutex_unlock(&pPool->lock);
+
+	FUNC_EXIT_RC(rc);
+}
+
+IoT_Error_t aws_iot_thread_pool_destroy(IoT_Thread_Pool_t *pPool) {
+	IoT_Error_t rc;
+
+	FUNC_ENTRY;
+
+	if(NULL == pPool) {
+		FUNC_EXIT_RC(NULL_VALUE_ERROR);
+	}
+
+	rc = _aws_iot_thread_pool_stop(pPool);
+
+	FUNC_EXIT_RC(rc);
+}
+
+#endif /* _ENABLE_THREAD_SUPPORT_ */
+
+#ifdef __cplusplus
+}
+#endif
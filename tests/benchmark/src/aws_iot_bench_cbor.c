@@ -0,0 +1,184 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_bench_cbor.c
+ * @brief Size and CPU cost of CBOR telemetry against the JSON writer and the shadow delta parser
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aws_iot_cbor.h"
+#include "aws_iot_json_writer.h"
+#include "aws_iot_shadow_json.h"
+#include "timer_interface.h"
+
+#define BENCH_ITERATIONS 200000
+#define BENCH_FIELD_COUNT 10
+#define BENCH_BUFFER_SIZE 512
+
+static float temperature = 23.45f;
+static float humidity = 61.2f;
+static float setpoint = 21.5f;
+static double latitude = 47.620422;
+static double longitude = -122.349358;
+static int16_t rssi = -67;
+static uint32_t uptime = 4123987;
+static uint16_t fanSpeed = 1450;
+static uint8_t battery = 87;
+static bool heating = true;
+
+static jsonStruct_t fields[BENCH_FIELD_COUNT];
+static jsonStruct_t *pFields[BENCH_FIELD_COUNT];
+
+static void initField(uint8_t index, const char *pKey, void *pData, size_t dataLength, JsonPrimitiveType type) {
+	fields[index].pKey = pKey;
+	fields[index].pData = pData;
+	fields[index].dataLength = dataLength;
+	fields[index].type = type;
+	fields[index].cb = NULL;
+	pFields[index] = &fields[index];
+}
+
+/* The flat object the shadow JSON builder writes for the same fields */
+static size_t writeJson(char *pBuffer, size_t bufferSize) {
+	IoT_Json_Writer_t writer;
+	uint8_t i;
+
+	aws_iot_json_writer_init(&writer, pBuffer, bufferSize, 0);
+	aws_iot_json_writer_char(&writer, '{');
+	for(i = 0; i < BENCH_FIELD_COUNT; i++) {
+		if(i > 0) {
+			aws_iot_json_writer_char(&writer, ',');
+		}
+		aws_iot_json_writer_key(&writer, fields[i].pKey);
+		switch(fields[i].type) {
+			case SHADOW_JSON_FLOAT:
+				aws_iot_json_writer_float(&writer, *(float *) fields[i].pData);
+				break;
+			case SHADOW_JSON_DOUBLE:
+				aws_iot_json_writer_double(&writer, *(double *) fields[i].pData);
+				break;
+			case SHADOW_JSON_INT16:
+				aws_iot_json_writer_int(&writer, *(int16_t *) fields[i].pData);
+				break;
+			case SHADOW_JSON_UINT32:
+				aws_iot_json_writer_uint(&writer, *(uint32_t *) fields[i].pData);
+				break;
+			case SHADOW_JSON_UINT16:
+				aws_iot_json_writer_uint(&writer, *(uint16_t *) fields[i].pData);
+				break;
+			case SHADOW_JSON_UINT8:
+				aws_iot_json_writer_uint(&writer, *(uint8_t *) fields[i].pData);
+				break;
+			case SHADOW_JSON_BOOL:
+				aws_iot_json_writer_bool(&writer, *(bool *) fields[i].pData);
+				break;
+			default:
+				break;
+		}
+	}
+	aws_iot_json_writer_char(&writer, '}');
+
+	return writer.length;
+}
+
+/* Updates the fields the way the shadow delta callback does */
+static uint8_t readJson(const char *pJson, size_t jsonLength, ShadowJsonParser_t *pParser) {
+	int32_t tokenCount, dataPosition;
+	uint32_t dataLength;
+	uint8_t i, updated = 0;
+
+	if(!isJsonValidAndParse(pJson, jsonLength, pParser, &tokenCount)) {
+		return 0;
+	}
+	for(i = 0; i < BENCH_FIELD_COUNT; i++) {
+		if(isJsonKeyMatchingAndUpdateValue(pJson, pParser, tokenCount, &fields[i], &dataLength, &dataPosition)) {
+			updated++;
+		}
+	}
+
+	return updated;
+}
+
+static void report(const char *pName, uint64_t jsonNs, uint64_t cborNs) {
+	printf("%-7s json %8.1f ns/msg   cbor %8.1f ns/msg   speedup %5.2fx\n", pName,
+		   (double) jsonNs / BENCH_ITERATIONS, (double) cborNs / BENCH_ITERATIONS, (double) jsonNs / (double) cborNs);
+}
+
+int main(void) {
+	static char jsonBuffer[BENCH_BUFFER_SIZE];
+	static uint8_t cborBuffer[BENCH_BUFFER_SIZE];
+	static ShadowJsonParser_t parser;
+	size_t jsonLength, cborLength = 0;
+	volatile size_t sink = 0;
+	uint8_t updated = 0;
+	uint64_t startNs, jsonNs, cborNs;
+	uint32_t iteration;
+
+	initField(0, "temperature", &temperature, sizeof(temperature), SHADOW_JSON_FLOAT);
+	initField(1, "humidity", &humidity, sizeof(humidity), SHADOW_JSON_FLOAT);
+	initField(2, "setpoint", &setpoint, sizeof(setpoint), SHADOW_JSON_FLOAT);
+	initField(3, "latitude", &latitude, sizeof(latitude), SHADOW_JSON_DOUBLE);
+	initField(4, "longitude", &longitude, sizeof(longitude), SHADOW_JSON_DOUBLE);
+	initField(5, "rssi", &rssi, sizeof(rssi), SHADOW_JSON_INT16);
+	initField(6, "uptime", &uptime, sizeof(uptime), SHADOW_JSON_UINT32);
+	initField(7, "fanSpeed", &fanSpeed, sizeof(fanSpeed), SHADOW_JSON_UINT16);
+	initField(8, "battery", &battery, sizeof(battery), SHADOW_JSON_UINT8);
+	initField(9, "heating", &heating, sizeof(heating), SHADOW_JSON_BOOL);
+
+	jsonLength = writeJson(jsonBuffer, BENCH_BUFFER_SIZE);
+	if(SUCCESS != aws_iot_cbor_encode_fields(cborBuffer, BENCH_BUFFER_SIZE, &cborLength, BENCH_FIELD_COUNT, pFields)) {
+		printf("Failed to encode the CBOR telemetry\n");
+		return 1;
+	}
+	printf("size    json %8u bytes      cbor %8u bytes      ratio   %5.2fx\n", (unsigned) jsonLength,
+		   (unsigned) cborLength, (double) jsonLength / (double) cborLength);
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		sink += writeJson(jsonBuffer, BENCH_BUFFER_SIZE);
+	}
+	jsonNs = get_monotonic_time_ns() - startNs;
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		aws_iot_cbor_encode_fields(cborBuffer, BENCH_BUFFER_SIZE, &cborLength, BENCH_FIELD_COUNT, pFields);
+		sink += cborLength;
+	}
+	cborNs = get_monotonic_time_ns() - startNs;
+	report("encode", jsonNs, cborNs);
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		sink += readJson(jsonBuffer, jsonLength, &parser);
+	}
+	jsonNs = get_monotonic_time_ns() - startNs;
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		aws_iot_cbor_decode_fields(cborBuffer, cborLength, BENCH_FIELD_COUNT, pFields, &updated);
+		sink += updated;
+	}
+	cborNs = get_monotonic_time_ns() - startNs;
+	report("decode", jsonNs, cborNs);
+
+	if(BENCH_FIELD_COUNT != readJson(jsonBuffer, jsonLength, &parser) || BENCH_FIELD_COUNT != updated) {
+		printf("Not every field was decoded\n");
+		return 1;
+	}
+
+	return 0;
+}
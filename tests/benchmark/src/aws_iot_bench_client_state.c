@@ -0,0 +1,163 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_bench_client_state.c
+ * @brief Client state transitions by compare and swap against transitions under a state mutex
+ *
+ * Every thread repeatedly moves the client from idle to publish in progress and back, as publisher
+ * threads sharing one client do. A failed transition is counted and retried, like a publish that
+ * returned MQTT_CLIENT_NOT_IDLE_ERROR.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aws_iot_mqtt_client_common_internal.h"
+#include "timer_interface.h"
+
+#ifndef _ENABLE_THREAD_SUPPORT_
+#error "Build the benchmarks with _ENABLE_THREAD_SUPPORT_"
+#endif
+
+#define BENCH_TRANSITIONS_PER_THREAD 1000000
+#define BENCH_MAX_THREADS 8
+
+typedef struct {
+	ClientState clientState;
+	IoT_Mutex_t stateChangeMutex;
+} ReferenceClient;
+
+typedef struct {
+	bool useReference;
+	uint32_t failedTransitions;
+} BenchThread;
+
+static AWS_IoT_Client sdkClient;
+static ReferenceClient referenceClient;
+static pthread_barrier_t startBarrier;
+
+/* The state transition as it was before, with blocking locks */
+static __attribute__((noinline)) IoT_Error_t referenceSetClientState(ReferenceClient *pClient,
+																	 ClientState expectedCurrentState,
+																	 ClientState newState) {
+	IoT_Error_t rc, threadRc;
+
+	rc = aws_iot_thread_mutex_lock(&(pClient->stateChangeMutex));
+	if(SUCCESS != rc) {
+		return rc;
+	}
+	if(expectedCurrentState == pClient->clientState) {
+		pClient->clientState = newState;
+		rc = SUCCESS;
+	} else {
+		rc = MQTT_UNEXPECTED_CLIENT_STATE_ERROR;
+	}
+	threadRc = aws_iot_thread_mutex_unlock(&(pClient->stateChangeMutex));
+	if(SUCCESS == rc && SUCCESS != threadRc) {
+		rc = threadRc;
+	}
+	return rc;
+}
+
+static IoT_Error_t setState(bool useReference, ClientState expectedCurrentState, ClientState newState) {
+	if(useReference) {
+		return referenceSetClientState(&referenceClient, expectedCurrentState, newState);
+	}
+	return aws_iot_mqtt_set_client_state(&sdkClient, expectedCurrentState, newState);
+}
+
+static void *benchThreadMain(void *pArg) {
+	BenchThread *pThread = (BenchThread *) pArg;
+	uint32_t done = 0;
+
+	pthread_barrier_wait(&startBarrier);
+	while(done < BENCH_TRANSITIONS_PER_THREAD) {
+		if(SUCCESS != setState(pThread->useReference, CLIENT_STATE_CONNECTED_IDLE,
+							   CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS)) {
+			pThread->failedTransitions++;
+			continue;
+		}
+		(void) setState(pThread->useReference, CLIENT_STATE_CONNECTED_PUBLISH_IN_PROGRESS,
+						CLIENT_STATE_CONNECTED_IDLE);
+		done += 2;
+	}
+	pthread_barrier_wait(&startBarrier);
+
+	return NULL;
+}
+
+/* Returns the wall time of threadCount threads each making BENCH_TRANSITIONS_PER_THREAD transitions */
+static uint64_t runThreads(bool useReference, uint32_t threadCount, uint32_t *pFailedTransitions) {
+	pthread_t threads[BENCH_MAX_THREADS];
+	BenchThread benchThreads[BENCH_MAX_THREADS];
+	uint64_t startNs, elapsedNs;
+	uint32_t i;
+
+	sdkClient.clientStatus.clientState = CLIENT_STATE_CONNECTED_IDLE;
+	referenceClient.clientState = CLIENT_STATE_CONNECTED_IDLE;
+	pthread_barrier_init(&startBarrier, NULL, threadCount + 1);
+
+	for(i = 0; i < threadCount; i++) {
+		benchThreads[i].useReference = useReference;
+		benchThreads[i].failedTransitions = 0;
+		pthread_create(&threads[i], NULL, benchThreadMain, &benchThreads[i]);
+	}
+
+	pthread_barrier_wait(&startBarrier);
+	startNs = get_monotonic_time_ns();
+	pthread_barrier_wait(&startBarrier);
+	elapsedNs = get_monotonic_time_ns() - startNs;
+
+	*pFailedTransitions = 0;
+	for(i = 0; i < threadCount; i++) {
+		pthread_join(threads[i], NULL);
+		*pFailedTransitions += benchThreads[i].failedTransitions;
+	}
+	pthread_barrier_destroy(&startBarrier);
+
+	return elapsedNs;
+}
+
+static void report(uint32_t threadCount) {
+	uint32_t referenceFailed, sdkFailed;
+	uint64_t referenceNs = runThreads(true, threadCount, &referenceFailed);
+	uint64_t sdkNs = runThreads(false, threadCount, &sdkFailed);
+	double transitions = (double) BENCH_TRANSITIONS_PER_THREAD * threadCount;
+
+	printf("%u thread%s  mutex %7.1f ns/transition (%9u retries)   compare and swap %7.1f ns/transition (%9u retries)   speedup %5.2fx\n",
+		   threadCount, (1 == threadCount) ? " " : "s", (double) referenceNs / transitions, referenceFailed,
+		   (double) sdkNs / transitions, sdkFailed, (double) referenceNs / (double) sdkNs);
+}
+
+int main(void) {
+	uint32_t threadCount;
+
+	memset(&sdkClient, 0, sizeof(sdkClient));
+	if(SUCCESS != aws_iot_thread_mutex_init(&(referenceClient.stateChangeMutex))) {
+		printf("Failed to create the reference mutex\n");
+		return 1;
+	}
+
+	/* One thread is the uncontended cost, more threads fight over the same client */
+	for(threadCount = 1; threadCount <= BENCH_MAX_THREADS; threadCount *= 2) {
+		report(threadCount);
+	}
+
+	(void) aws_iot_thread_mutex_destroy(&(referenceClient.stateChangeMutex));
+	return 0;
+}
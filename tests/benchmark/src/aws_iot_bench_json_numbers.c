@@ -0,0 +1,147 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_bench_json_numbers.c
+ * @brief Number parsing of aws_iot_json_utils against the sscanf based parsing it replaced
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aws_iot_json_utils.h"
+#include "timer_interface.h"
+
+#define BENCH_ITERATIONS 200000
+#define BENCH_MAX_TOKENS 64
+
+/* A telemetry-heavy delta document */
+static const char benchDocument[] = "{\"temperature\":23.45,\"humidity\":61.2,\"pressure\":1013.25,\"voltage\":3.297,"
+		"\"latitude\":47.620422,\"longitude\":-122.349358,\"rssi\":-67,\"uptime\":4123987,\"counter\":17,"
+		"\"setpoint\":21.5,\"fanSpeed\":1450,\"ratio\":0.000125,\"energy\":1.25e3,\"offset\":-3}";
+
+static IoT_Error_t referenceParseInteger32(int32_t *i, const char *jsonString, jsmntok_t *token) {
+	return (1 == sscanf(jsonString + token->start, "%i", i)) ? SUCCESS : JSON_PARSE_ERROR;
+}
+
+static IoT_Error_t referenceParseFloat(float *f, const char *jsonString, jsmntok_t *token) {
+	return (1 == sscanf(jsonString + token->start, "%f", f)) ? SUCCESS : JSON_PARSE_ERROR;
+}
+
+static IoT_Error_t referenceParseDouble(double *d, const char *jsonString, jsmntok_t *token) {
+	return (1 == sscanf(jsonString + token->start, "%lf", d)) ? SUCCESS : JSON_PARSE_ERROR;
+}
+
+static bool isIntegerToken(const char *jsonString, jsmntok_t *token) {
+	int i;
+
+	for(i = token->start; i < token->end; i++) {
+		if('.' == jsonString[i] || 'e' == jsonString[i] || 'E' == jsonString[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void report(const char *pName, uint64_t referenceNs, uint64_t sdkNs, uint32_t operations) {
+	printf("%-10s sscanf %8.1f ns/op   json_utils %8.1f ns/op   speedup %5.2fx\n", pName,
+		   (double) referenceNs / operations, (double) sdkNs / operations, (double) referenceNs / (double) sdkNs);
+}
+
+int main(void) {
+	jsmn_parser parser;
+	jsmntok_t tokens[BENCH_MAX_TOKENS];
+	jsmntok_t *valueTokens[BENCH_MAX_TOKENS];
+	jsmntok_t *integerTokens[BENCH_MAX_TOKENS];
+	uint32_t valueCount = 0, integerCount = 0, iteration, i;
+	volatile double doubleSink = 0;
+	volatile float floatSink = 0;
+	volatile int32_t integerSink = 0;
+	int32_t integerValue;
+	float floatValue;
+	double doubleValue;
+	uint64_t startNs, referenceNs, sdkNs;
+	int tokenCount;
+
+	jsmn_init(&parser);
+	tokenCount = jsmn_parse(&parser, benchDocument, strlen(benchDocument), tokens, BENCH_MAX_TOKENS);
+	if(tokenCount < 0) {
+		printf("Failed to tokenize the benchmark document\n");
+		return 1;
+	}
+	for(i = 2; i < (uint32_t) tokenCount; i += 2) {
+		valueTokens[valueCount++] = &tokens[i];
+		if(isIntegerToken(benchDocument, &tokens[i])) {
+			integerTokens[integerCount++] = &tokens[i];
+		}
+	}
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		for(i = 0; i < integerCount; i++) {
+			referenceParseInteger32(&integerValue, benchDocument, integerTokens[i]);
+			integerSink += integerValue;
+		}
+	}
+	referenceNs = get_monotonic_time_ns() - startNs;
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		for(i = 0; i < integerCount; i++) {
+			parseInteger32Value(&integerValue, benchDocument, integerTokens[i]);
+			integerSink += integerValue;
+		}
+	}
+	sdkNs = get_monotonic_time_ns() - startNs;
+	report("int32", referenceNs, sdkNs, BENCH_ITERATIONS * integerCount);
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		for(i = 0; i < valueCount; i++) {
+			referenceParseFloat(&floatValue, benchDocument, valueTokens[i]);
+			floatSink += floatValue;
+		}
+	}
+	referenceNs = get_monotonic_time_ns() - startNs;
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		for(i = 0; i < valueCount; i++) {
+			parseFloatValue(&floatValue, benchDocument, valueTokens[i]);
+			floatSink += floatValue;
+		}
+	}
+	sdkNs = get_monotonic_time_ns() - startNs;
+	report("float", referenceNs, sdkNs, BENCH_ITERATIONS * valueCount);
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		for(i = 0; i < valueCount; i++) {
+			referenceParseDouble(&doubleValue, benchDocument, valueTokens[i]);
+			doubleSink += doubleValue;
+		}
+	}
+	referenceNs = get_monotonic_time_ns() - startNs;
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		for(i = 0; i < valueCount; i++) {
+			parseDoubleValue(&doubleValue, benchDocument, valueTokens[i]);
+			doubleSink += doubleValue;
+		}
+	}
+	sdkNs = get_monotonic_time_ns() - startNs;
+	report("double", referenceNs, sdkNs, BENCH_ITERATIONS * valueCount);
+
+	return 0;
+}
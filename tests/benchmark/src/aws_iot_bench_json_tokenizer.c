@@ -0,0 +1,115 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_bench_json_tokenizer.c
+ * @brief Throughput of aws_iot_json_tokenize against jsmn_parse on multi-KB shadow documents
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aws_iot_json_tokenizer.h"
+#include "timer_interface.h"
+
+#define BENCH_ITERATIONS 20000
+#define BENCH_MAX_TOKENS 512
+#define BENCH_DOCUMENT_SIZE 8192
+#define BENCH_SENSOR_COUNT 40
+
+static char compactDocument[BENCH_DOCUMENT_SIZE];
+static char indentedDocument[BENCH_DOCUMENT_SIZE];
+static jsmntok_t jsmnTokens[BENCH_MAX_TOKENS];
+static jsmntok_t tokenizerTokens[BENCH_MAX_TOKENS];
+
+/* A reported state of sensors with descriptive strings, the shape gateways relay in bulk */
+static size_t buildDocument(char *pBuffer, const char *pNewline, const char *pIndent) {
+	size_t length;
+	uint32_t i;
+
+	length = (size_t) snprintf(pBuffer, BENCH_DOCUMENT_SIZE, "{%s%s\"state\":{%s%s%s\"reported\":{", pNewline,
+							   pIndent, pNewline, pIndent, pIndent);
+	for(i = 0; i < BENCH_SENSOR_COUNT; i++) {
+		length += (size_t) snprintf(pBuffer + length, BENCH_DOCUMENT_SIZE - length,
+									"%s%s%s%s\"sensor%02u\":{\"value\":%u.%02u,\"unit\":\"celsius\","
+									"\"label\":\"Cold aisle temperature probe, rack %u \\\"north\\\"\"}%s",
+									pNewline, pIndent, pIndent, pIndent, i, 20 + i, i * 7 % 100, i,
+									(i + 1 < BENCH_SENSOR_COUNT) ? "," : "");
+	}
+	length += (size_t) snprintf(pBuffer + length, BENCH_DOCUMENT_SIZE - length,
+								"%s%s%s}%s%s}%s,%s\"clientToken\":\"gateway-0001-0000001234\",%s\"version\":4711%s}",
+								pNewline, pIndent, pIndent, pNewline, pIndent, pNewline, pIndent, pIndent, pNewline);
+	return length;
+}
+
+static bool isSameTokenization(const char *pDocument, size_t length) {
+	jsmn_parser parser;
+	int expected, actual;
+
+	jsmn_init(&parser);
+	expected = jsmn_parse(&parser, pDocument, length, jsmnTokens, BENCH_MAX_TOKENS);
+	jsmn_init(&parser);
+	actual = aws_iot_json_tokenize(&parser, pDocument, length, tokenizerTokens, BENCH_MAX_TOKENS);
+
+	return expected > 0 && expected == actual
+		   && 0 == memcmp(jsmnTokens, tokenizerTokens, (size_t) expected * sizeof(jsmntok_t));
+}
+
+static void report(const char *pName, size_t length, uint64_t jsmnNs, uint64_t tokenizerNs) {
+	double megabytes = (double) length * BENCH_ITERATIONS / (1024.0 * 1024.0);
+
+	printf("%-9s %5zu bytes   jsmn %7.1f MB/s   tokenizer %7.1f MB/s   speedup %5.2fx\n", pName, length,
+		   megabytes * 1e9 / (double) jsmnNs, megabytes * 1e9 / (double) tokenizerNs,
+		   (double) jsmnNs / (double) tokenizerNs);
+}
+
+static int benchDocument(const char *pName, const char *pDocument, size_t length) {
+	jsmn_parser parser;
+	volatile int tokenSink = 0;
+	uint64_t startNs, jsmnNs, tokenizerNs;
+	uint32_t iteration;
+
+	if(!isSameTokenization(pDocument, length)) {
+		printf("%s: tokenizer and jsmn disagree\n", pName);
+		return 1;
+	}
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		jsmn_init(&parser);
+		tokenSink += jsmn_parse(&parser, pDocument, length, jsmnTokens, BENCH_MAX_TOKENS);
+	}
+	jsmnNs = get_monotonic_time_ns() - startNs;
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		jsmn_init(&parser);
+		tokenSink += aws_iot_json_tokenize(&parser, pDocument, length, tokenizerTokens, BENCH_MAX_TOKENS);
+	}
+	tokenizerNs = get_monotonic_time_ns() - startNs;
+
+	report(pName, length, jsmnNs, tokenizerNs);
+	return 0;
+}
+
+int main(void) {
+	size_t compactLength = buildDocument(compactDocument, "", "");
+	size_t indentedLength = buildDocument(indentedDocument, "\n", "    ");
+
+	return benchDocument("compact", compactDocument, compactLength)
+		   | benchDocument("indented", indentedDocument, indentedLength);
+}
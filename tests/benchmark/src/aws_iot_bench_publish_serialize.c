@@ -0,0 +1,128 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_bench_publish_serialize.c
+ * @brief PUBLISH serialization from a publish handle against serializing topic and header on every message
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aws_iot_mqtt_client_common_internal.h"
+#include "timer_interface.h"
+
+#define BENCH_ITERATIONS 2000000
+#define BENCH_BUFFER_SIZE 512
+
+static const char benchTopic[] = "$aws/things/thermostat-livingroom-0042/telemetry/environment";
+static const char benchPayload[] = "{\"temperature\":23.45,\"humidity\":61.2,\"pressure\":1013.25,\"seq\":1234}";
+
+/* The publish serializer as it was before publish handles, run for every message. Kept out of line
+ * like the SDK serializer so that the constant topic is not folded into it */
+static __attribute__((noinline)) IoT_Error_t referenceSerializePublish(unsigned char *pTxBuf, size_t txBufLen, uint8_t dup, QoS qos,
+											 uint8_t retained, uint16_t packetId, const char *pTopicName,
+											 uint16_t topicNameLen, const unsigned char *pPayload,
+											 size_t payloadLen, uint32_t *pSerializedLen) {
+	unsigned char *ptr;
+	uint32_t rem_len;
+	IoT_Error_t rc;
+	MQTTHeader header = {0};
+
+	if(NULL == pTxBuf || NULL == pPayload || NULL == pSerializedLen) {
+		return NULL_VALUE_ERROR;
+	}
+
+	ptr = pTxBuf;
+	rem_len = (uint32_t) (topicNameLen + payloadLen + 2);
+	if(qos > 0) {
+		rem_len += 2;
+	}
+	if(aws_iot_mqtt_internal_get_final_packet_length_from_remaining_length(rem_len) > txBufLen) {
+		return MQTT_TX_BUFFER_TOO_SHORT_ERROR;
+	}
+
+	rc = aws_iot_mqtt_internal_init_header(&header, PUBLISH, qos, dup, retained);
+	if(SUCCESS != rc) {
+		return rc;
+	}
+	aws_iot_mqtt_internal_write_char(&ptr, header.byte);
+	ptr += aws_iot_mqtt_internal_write_len_to_buffer(ptr, rem_len);
+	aws_iot_mqtt_internal_write_utf8_string(&ptr, pTopicName, topicNameLen);
+	if(qos > 0) {
+		aws_iot_mqtt_internal_write_uint_16(&ptr, packetId);
+	}
+	memcpy(ptr, pPayload, payloadLen);
+	ptr += payloadLen;
+
+	*pSerializedLen = (uint32_t) (ptr - pTxBuf);
+	return SUCCESS;
+}
+
+static void report(const char *pName, uint64_t referenceNs, uint64_t sdkNs, uint32_t operations) {
+	printf("%-6s per message %8.1f ns/op   publish handle %8.1f ns/op   speedup %5.2fx\n", pName,
+		   (double) referenceNs / operations, (double) sdkNs / operations, (double) referenceNs / (double) sdkNs);
+}
+
+static int benchQoS(const char *pName, QoS qos) {
+	static unsigned char referenceBuf[BENCH_BUFFER_SIZE];
+	static unsigned char sdkBuf[BENCH_BUFFER_SIZE];
+	IoT_Publish_Handle handle;
+	const char *volatile pTopic = benchTopic;
+	uint32_t referenceLen = 0, sdkLen = 0, iteration;
+	volatile uint32_t sink = 0;
+	uint64_t startNs, referenceNs, sdkNs;
+
+	if(SUCCESS != aws_iot_mqtt_publish_handle_create(&handle, benchTopic, (uint16_t) strlen(benchTopic), qos, 0)) {
+		printf("Failed to create the publish handle\n");
+		return 1;
+	}
+
+	/* The caller passes the topic length it computed for every publish */
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		referenceSerializePublish(referenceBuf, BENCH_BUFFER_SIZE, 0, qos, 0, (uint16_t) iteration, pTopic,
+								  (uint16_t) strlen(pTopic), (const unsigned char *) benchPayload,
+								  sizeof(benchPayload) - 1, &referenceLen);
+		sink += referenceBuf[referenceLen - 1];
+	}
+	referenceNs = get_monotonic_time_ns() - startNs;
+
+	startNs = get_monotonic_time_ns();
+	for(iteration = 0; iteration < BENCH_ITERATIONS; iteration++) {
+		aws_iot_mqtt_internal_serialize_publish_with_handle(sdkBuf, BENCH_BUFFER_SIZE, &handle, (uint16_t) iteration,
+															(const unsigned char *) benchPayload,
+															sizeof(benchPayload) - 1, &sdkLen);
+		sink += sdkBuf[sdkLen - 1];
+	}
+	sdkNs = get_monotonic_time_ns() - startNs;
+
+	if(referenceLen != sdkLen || 0 != memcmp(referenceBuf, sdkBuf, sdkLen)) {
+		printf("%s packets differ\n", pName);
+		return 1;
+	}
+
+	report(pName, referenceNs, sdkNs, BENCH_ITERATIONS);
+	return 0;
+}
+
+int main(void) {
+	if(0 != benchQoS("QoS0", QOS0) || 0 != benchQoS("QoS1", QOS1)) {
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_threads_common.h
+ * @brief Checks and test runner shared by the threaded tests
+ *
+ * A test is a function returning true when it passed. A failed check prints its location and
+ * returns false from the test, so checks may only be used on the thread running the test.
+ */
+
+#ifndef AWS_IOT_TESTS_THREADS_COMMON_H_
+#define AWS_IOT_TESTS_THREADS_COMMON_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "aws_iot_config.h"
+
+#ifndef _ENABLE_THREAD_SUPPORT_
+#error "Build the threaded tests with _ENABLE_THREAD_SUPPORT_"
+#endif
+
+#define THREADS_CHECK(condition) \
+	do { \
+		if(!(condition)) { \
+			printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #condition); \
+			return false; \
+		} \
+	} while(0)
+
+#define THREADS_CHECK_EQUAL_INT(expected, actual) \
+	do { \
+		long long expectedValue = (long long) (expected); \
+		long long actualValue = (long long) (actual); \
+		if(expectedValue != actualValue) { \
+			printf("FAIL %s:%d %s expected %lld, got %lld\n", __FILE__, __LINE__, #actual, expectedValue, \
+				   actualValue); \
+			return false; \
+		} \
+	} while(0)
+
+typedef struct {
+	const char *pName;
+	bool (*test)(void);
+} ThreadsTest;
+
+static inline uint64_t threadsTestNowMs(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000ULL + (uint64_t) now.tv_nsec / 1000000ULL;
+}
+
+static inline void threadsTestSleepMs(uint32_t ms) {
+	struct timespec delay;
+
+	delay.tv_sec = ms / 1000;
+	delay.tv_nsec = (long) (ms % 1000) * 1000000L;
+	nanosleep(&delay, NULL);
+}
+
+/* Runs every test of the table, returns the process exit status */
+static inline int runThreadsTests(const char *pGroup, const ThreadsTest *pTests, size_t testCount) {
+	size_t i, failures = 0;
+
+	for(i = 0; i < testCount; i++) {
+		if(pTests[i].test()) {
+			printf("OK   %s.%s\n", pGroup, pTests[i].pName);
+		} else {
+			printf("     in %s.%s\n", pGroup, pTests[i].pName);
+			failures++;
+		}
+	}
+	printf("%s: %u tests, %u failures\n", pGroup, (unsigned) testCount, (unsigned) failures);
+
+	return 0 == failures ? 0 : 1;
+}
+
+#endif /* AWS_IOT_TESTS_THREADS_COMMON_H_ */
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_threads_jobs_engine.c
+ * @brief Tests of the jobs engine worker threads
+ */
+
+#include <string.h>
+
+#include "aws_iot_tests_threads_common.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_jobs_engine.h"
+
+#define ENGINE_SUBSCRIPTION_COUNT 3
+#define SUBACK_SIZE 5
+#define SHORT_TIMEOUT_MS 50
+#define LONG_TIMEOUT_MS 5000
+
+/* One client per engine, the unit test configuration has room for the subscriptions of one */
+static AWS_IoT_Client clients[2];
+static AwsIotJobsEngine engines[2];
+static const char *THING_NAMES[2] = {"T1", "T2"};
+
+/* Handlers run on the workers, the test waits for them on these semaphores */
+static IoT_Semaphore_t handlerRan;
+static IoT_Semaphore_t gateStarted;
+static IoT_Semaphore_t gateOpen;
+static uint32_t handlerCount;
+static bool isGateClosed;
+static uint32_t gateDelayMs;
+
+static JobExecutionStatus testHandler(AwsIotJobsEngine *pEngine, AwsIotJobsEngineJob *pJob, void *pContext) {
+	IOT_UNUSED(pEngine);
+	IOT_UNUSED(pJob);
+	IOT_UNUSED(pContext);
+
+	if(__atomic_load_n(&isGateClosed, __ATOMIC_ACQUIRE)) {
+		aws_iot_thread_semaphore_post(&gateStarted);
+		aws_iot_thread_semaphore_wait(&gateOpen);
+	}
+	__atomic_fetch_add(&handlerCount, 1, __ATOMIC_RELAXED);
+	aws_iot_thread_semaphore_post(&handlerRan);
+
+	return JOB_EXECUTION_SUCCEEDED;
+}
+
+static void openGateAfterDelay(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	threadsTestSleepMs(gateDelayMs);
+	__atomic_store_n(&isGateClosed, false, __ATOMIC_RELEASE);
+	aws_iot_thread_semaphore_post(&gateOpen);
+}
+
+static void setTLSRxBufferForEngineSubacks(void) {
+	size_t i;
+
+	for(i = 0; i < ENGINE_SUBSCRIPTION_COUNT; i++) {
+		RxBuffer.pBuffer[i * SUBACK_SIZE] = (unsigned char) (0x90);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 1] = (unsigned char) (0x2 + 1);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 2] = (unsigned char) (2);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 3] = (unsigned char) (0);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 4] = (unsigned char) (QOS0);
+	}
+	RxBuffer.NoMsgFlag = false;
+	RxBuffer.len = ENGINE_SUBSCRIPTION_COUNT * SUBACK_SIZE;
+	RxIndex = 0;
+}
+
+/* Delivers a notify-next message for the thing of the engine on the test thread */
+static bool deliverExecution(size_t engineIndex, const char *pJobId) {
+	char topic[MAX_JOB_TOPIC_LENGTH_BYTES + 1];
+	char message[128];
+	IoT_Publish_Message_Params params;
+	int topicLength;
+
+	topicLength = aws_iot_jobs_get_api_topic(topic, sizeof(topic), JOB_NOTIFY_NEXT_TOPIC, JOB_REQUEST_TYPE,
+											 THING_NAMES[engineIndex], NULL);
+	THREADS_CHECK(topicLength > 0 && topicLength < MAX_JOB_TOPIC_LENGTH_BYTES);
+	snprintf(message, sizeof(message), "{\"execution\":{\"jobId\":\"%s\",\"executionNumber\":1,\"jobDocument\":{}}}",
+			 pJobId);
+
+	params.qos = QOS0;
+	params.isRetained = 0;
+	params.isDup = 0;
+	params.id = 0;
+	params.payload = (void *) message;
+	params.payloadLen = strlen(message);
+
+	setTLSRxBufferWithMsgOnSubscribedTopic(topic, (size_t) topicLength, QOS0, params, message);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_yield(&clients[engineIndex], 100));
+
+	return true;
+}
+
+static bool setUp(size_t engineCount) {
+	IoT_Client_Init_Params initParams = iotClientInitParamsDefault;
+	IoT_Client_Connect_Params connectParams = iotClientConnectParamsDefault;
+	AwsIotJobsEngineParams engineParams = awsIotJobsEngineParamsDefault;
+	size_t i;
+
+	handlerCount = 0;
+	isGateClosed = false;
+	gateDelayMs = 0;
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&handlerRan, 0));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&gateStarted, 0));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&gateOpen, 0));
+
+	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
+	ConnectMQTTParamsSetup(&connectParams, (char *) AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	engineParams.handler = testHandler;
+	for(i = 0; i < engineCount; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_init(&clients[i], &initParams));
+		setTLSRxBufferForConnack(&connectParams, 0, 0);
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_connect(&clients[i], &connectParams));
+		ResetTLSBuffer();
+
+		engineParams.pThingName = THING_NAMES[i];
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_init(&engines[i], &clients[i], &engineParams));
+		setTLSRxBufferForEngineSubacks();
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start(&engines[i]));
+	}
+
+	return true;
+}
+
+static bool tearDown(size_t engineCount) {
+	size_t i;
+
+	for(i = 0; i < engineCount; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_free(&engines[i]));
+		aws_iot_mqtt_disconnect(&clients[i]);
+		aws_iot_mqtt_free(&clients[i]);
+	}
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&gateOpen));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&gateStarted));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&handlerRan));
+
+	return true;
+}
+
+static bool startRejectsBadParams(void) {
+	THREADS_CHECK(setUp(1));
+
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_start_workers(NULL, 1));
+	THREADS_CHECK_EQUAL_INT(MAX_SIZE_ERROR, aws_iot_jobs_engine_start_workers(&engines[0], 0));
+	THREADS_CHECK_EQUAL_INT(MAX_SIZE_ERROR,
+							aws_iot_jobs_engine_start_workers(&engines[0], AWS_IOT_JOBS_ENGINE_MAX_WORKERS + 1));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_stop_workers(NULL));
+	THREADS_CHECK_EQUAL_INT(FAILURE, aws_iot_jobs_engine_stop_workers(&engines[0]));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start_workers(&engines[0], 1));
+	THREADS_CHECK_EQUAL_INT(FAILURE, aws_iot_jobs_engine_start_workers(&engines[0], 1));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_stop_workers(&engines[0]));
+	THREADS_CHECK_EQUAL_INT(FAILURE, aws_iot_jobs_engine_stop_workers(&engines[0]));
+
+	return tearDown(1);
+}
+
+/* A queued execution wakes an idle worker, nothing runs before */
+static bool queuedExecutionWakesWorker(void) {
+	THREADS_CHECK(setUp(1));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start_workers(&engines[0], AWS_IOT_JOBS_ENGINE_MAX_WORKERS));
+
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR, aws_iot_thread_semaphore_timedwait(&handlerRan, SHORT_TIMEOUT_MS));
+	THREADS_CHECK(deliverExecution(0, "J1"));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&handlerRan, LONG_TIMEOUT_MS));
+	THREADS_CHECK(deliverExecution(0, "J2"));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&handlerRan, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(2, __atomic_load_n(&handlerCount, __ATOMIC_RELAXED));
+	THREADS_CHECK(false == aws_iot_jobs_engine_run_next(&engines[0]));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_stop_workers(&engines[0]));
+	return tearDown(1);
+}
+
+/* Executions queued before the workers start are run once they are started */
+static bool startRunsExecutionsAlreadyQueued(void) {
+	THREADS_CHECK(setUp(1));
+
+	THREADS_CHECK(deliverExecution(0, "J1"));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start_workers(&engines[0], 1));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&handlerRan, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(1, __atomic_load_n(&handlerCount, __ATOMIC_RELAXED));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_stop_workers(&engines[0]));
+	return tearDown(1);
+}
+
+/* Every engine has its own workers */
+static bool enginesHaveTheirOwnWorkers(void) {
+	THREADS_CHECK(setUp(2));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start_workers(&engines[0], 1));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start_workers(&engines[1], 1));
+
+	THREADS_CHECK(deliverExecution(0, "J1"));
+	THREADS_CHECK(deliverExecution(1, "J1"));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&handlerRan, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&handlerRan, LONG_TIMEOUT_MS));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_stop_workers(&engines[0]));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_stop_workers(&engines[1]));
+	return tearDown(2);
+}
+
+/* Stopping waits for the running handler and leaves queued executions queued */
+static bool stopLeavesQueuedExecutions(void) {
+	IoT_Thread_t opener;
+
+	THREADS_CHECK(setUp(1));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_start_workers(&engines[0], 1));
+
+	isGateClosed = true;
+	THREADS_CHECK(deliverExecution(0, "J1"));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&gateStarted, LONG_TIMEOUT_MS));
+	THREADS_CHECK(deliverExecution(0, "J2"));
+
+	gateDelayMs = SHORT_TIMEOUT_MS;
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&opener, openGateAfterDelay, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_jobs_engine_stop_workers(&engines[0]));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&opener));
+	THREADS_CHECK_EQUAL_INT(1, __atomic_load_n(&handlerCount, __ATOMIC_RELAXED));
+
+	THREADS_CHECK(aws_iot_jobs_engine_run_next(&engines[0]));
+	THREADS_CHECK_EQUAL_INT(2, __atomic_load_n(&handlerCount, __ATOMIC_RELAXED));
+
+	return tearDown(1);
+}
+
+static const ThreadsTest tests[] = {
+	{"StartRejectsBadParams", startRejectsBadParams},
+	{"QueuedExecutionWakesWorker", queuedExecutionWakesWorker},
+	{"StartRunsExecutionsAlreadyQueued", startRunsExecutionsAlreadyQueued},
+	{"EnginesHaveTheirOwnWorkers", enginesHaveTheirOwnWorkers},
+	{"StopLeavesQueuedExecutions", stopLeavesQueuedExecutions},
+};
+
+int main(void) {
+	return runThreadsTests("JobsEngineWorkerTests", tests, sizeof(tests) / sizeof(tests[0]));
+}
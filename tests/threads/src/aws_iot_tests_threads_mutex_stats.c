@@ -0,0 +1,257 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_threads_mutex_stats.c
+ * @brief Tests of the mutex contention statistics
+ */
+
+#include <string.h>
+
+#include "aws_iot_tests_threads_common.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_mqtt_client.h"
+#include "aws_iot_mqtt_client_interface.h"
+
+#ifndef ENABLE_IOT_MUTEX_STATS
+#error "Build the threaded tests with ENABLE_IOT_MUTEX_STATS"
+#endif
+
+#define HOLD_MS 50
+#define NS_PER_MS 1000000ULL
+
+static IoT_Mutex_t mutex;
+static IoT_Semaphore_t aboutToLock;
+static IoT_Error_t otherThreadRc;
+
+static void lockAndUnlock(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	aws_iot_thread_semaphore_post(&aboutToLock);
+	otherThreadRc = aws_iot_thread_mutex_lock(&mutex);
+	if(SUCCESS == otherThreadRc) {
+		otherThreadRc = aws_iot_thread_mutex_unlock(&mutex);
+	}
+}
+
+static void tryLock(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	otherThreadRc = aws_iot_thread_mutex_trylock(&mutex);
+}
+
+static bool setUp(void) {
+	otherThreadRc = FAILURE;
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_init(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&aboutToLock, 0));
+	return true;
+}
+
+static bool tearDown(void) {
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&aboutToLock));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_destroy(&mutex));
+	return true;
+}
+
+/* Holds the mutex while another thread blocks on it for HOLD_MS */
+static bool blockAnotherThread(void) {
+	IoT_Thread_t locker;
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_lock(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&locker, lockAndUnlock, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_wait(&aboutToLock));
+	threadsTestSleepMs(HOLD_MS);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&locker));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, otherThreadRc);
+	return true;
+}
+
+static bool statsRejectNull(void) {
+	IoT_Mutex_Stats_t stats;
+
+	THREADS_CHECK(setUp());
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_mutex_get_stats(NULL, &stats));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_mutex_get_stats(&mutex, NULL));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_mutex_reset_stats(NULL));
+	return tearDown();
+}
+
+/* Uncontended locks are counted but neither contended nor timed */
+static bool uncontendedLockIsNotContended(void) {
+	IoT_Mutex_Stats_t stats;
+	uint32_t i;
+
+	THREADS_CHECK(setUp());
+
+	for(i = 0; i < 3; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_lock(&mutex));
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&mutex));
+	}
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_trylock(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&mutex));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_get_stats(&mutex, &stats));
+	THREADS_CHECK_EQUAL_INT(4, stats.acquireCount);
+	THREADS_CHECK_EQUAL_INT(0, stats.contendedCount);
+	THREADS_CHECK_EQUAL_INT(0, stats.failedTryCount);
+	THREADS_CHECK_EQUAL_INT(0, stats.totalWaitNs);
+	THREADS_CHECK_EQUAL_INT(0, stats.maxWaitNs);
+
+	return tearDown();
+}
+
+/* A trylock on a held mutex fails and is counted as failed and contended */
+static bool trylockOnHeldMutexIsCounted(void) {
+	IoT_Mutex_Stats_t stats;
+	IoT_Thread_t trier;
+
+	THREADS_CHECK(setUp());
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_lock(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&trier, tryLock, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&trier));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&mutex));
+	THREADS_CHECK_EQUAL_INT(MUTEX_LOCK_ERROR, otherThreadRc);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_get_stats(&mutex, &stats));
+	THREADS_CHECK_EQUAL_INT(1, stats.acquireCount);
+	THREADS_CHECK_EQUAL_INT(1, stats.contendedCount);
+	THREADS_CHECK_EQUAL_INT(1, stats.failedTryCount);
+	THREADS_CHECK_EQUAL_INT(0, stats.totalWaitNs);
+
+	return tearDown();
+}
+
+/* A lock that blocks records its wait */
+static bool blockedLockRecordsWait(void) {
+	IoT_Mutex_Stats_t stats;
+
+	THREADS_CHECK(setUp());
+	THREADS_CHECK(blockAnotherThread());
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_get_stats(&mutex, &stats));
+	THREADS_CHECK_EQUAL_INT(2, stats.acquireCount);
+	THREADS_CHECK_EQUAL_INT(1, stats.contendedCount);
+	THREADS_CHECK_EQUAL_INT(0, stats.failedTryCount);
+	/* The waiter may reach the lock a little after the semaphore */
+	THREADS_CHECK(stats.maxWaitNs >= (HOLD_MS / 2) * NS_PER_MS);
+	THREADS_CHECK_EQUAL_INT(stats.maxWaitNs, stats.totalWaitNs);
+	THREADS_CHECK(stats.maxHoldNs >= HOLD_MS * NS_PER_MS);
+
+	return tearDown();
+}
+
+/* The time spent waiting on a condition variable is not hold time */
+static bool condWaitStopsHoldTimer(void) {
+	IoT_Mutex_Stats_t stats;
+	IoT_Cond_t cond;
+
+	THREADS_CHECK(setUp());
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_cond_init(&cond));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_lock(&mutex));
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR, aws_iot_thread_cond_timedwait(&cond, &mutex, HOLD_MS));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&mutex));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_get_stats(&mutex, &stats));
+	THREADS_CHECK_EQUAL_INT(1, stats.acquireCount);
+	THREADS_CHECK(stats.totalHoldNs < (HOLD_MS / 2) * NS_PER_MS);
+	THREADS_CHECK(stats.maxHoldNs < (HOLD_MS / 2) * NS_PER_MS);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_cond_destroy(&cond));
+	return tearDown();
+}
+
+/* Reset sets every field to zero */
+static bool resetZeroesEveryField(void) {
+	IoT_Mutex_Stats_t stats, zero;
+	IoT_Thread_t trier;
+
+	THREADS_CHECK(setUp());
+
+	THREADS_CHECK(blockAnotherThread());
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_lock(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&trier, tryLock, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&trier));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&mutex));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_get_stats(&mutex, &stats));
+	THREADS_CHECK(0 != stats.acquireCount);
+	THREADS_CHECK(0 != stats.contendedCount);
+	THREADS_CHECK(0 != stats.failedTryCount);
+	THREADS_CHECK(0 != stats.totalWaitNs);
+	THREADS_CHECK(0 != stats.maxWaitNs);
+	THREADS_CHECK(0 != stats.totalHoldNs);
+	THREADS_CHECK(0 != stats.maxHoldNs);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_reset_stats(&mutex));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_get_stats(&mutex, &stats));
+	memset(&zero, 0, sizeof(zero));
+	THREADS_CHECK(0 == memcmp(&zero, &stats, sizeof(stats)));
+
+	return tearDown();
+}
+
+/* The client reports and resets the statistics of its TLS locks */
+static bool clientLockStats(void) {
+	IoT_Client_Init_Params initParams = iotClientInitParamsDefault;
+	IoT_Client_Connect_Params connectParams = iotClientConnectParamsDefault;
+	IoT_Mutex_Stats_t readStats, writeStats, zero;
+	AWS_IoT_Client client;
+
+	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_init(&client, &initParams));
+	ConnectMQTTParamsSetup(&connectParams, (char *) AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_connect(&client, &connectParams));
+
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_mqtt_get_lock_stats(NULL, &readStats, &writeStats));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_mqtt_reset_lock_stats(NULL));
+
+	/* Connecting wrote the CONNECT packet and read the CONNACK */
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_get_lock_stats(&client, &readStats, &writeStats));
+	THREADS_CHECK(0 != readStats.acquireCount);
+	THREADS_CHECK(0 != writeStats.acquireCount);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_get_lock_stats(&client, NULL, &writeStats));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_reset_lock_stats(&client));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_get_lock_stats(&client, &readStats, &writeStats));
+	memset(&zero, 0, sizeof(zero));
+	THREADS_CHECK(0 == memcmp(&zero, &readStats, sizeof(readStats)));
+	THREADS_CHECK(0 == memcmp(&zero, &writeStats, sizeof(writeStats)));
+
+	aws_iot_mqtt_disconnect(&client);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_get_lock_stats(&client, NULL, &writeStats));
+	THREADS_CHECK(0 != writeStats.acquireCount);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_mqtt_free(&client));
+
+	return true;
+}
+
+static const ThreadsTest tests[] = {
+	{"StatsRejectNull", statsRejectNull},
+	{"UncontendedLockIsNotContended", uncontendedLockIsNotContended},
+	{"TrylockOnHeldMutexIsCounted", trylockOnHeldMutexIsCounted},
+	{"BlockedLockRecordsWait", blockedLockRecordsWait},
+	{"CondWaitStopsHoldTimer", condWaitStopsHoldTimer},
+	{"ResetZeroesEveryField", resetZeroesEveryField},
+	{"ClientLockStats", clientLockStats},
+};
+
+int main(void) {
+	return runThreadsTests("MutexStatsTests", tests, sizeof(tests) / sizeof(tests[0]));
+}
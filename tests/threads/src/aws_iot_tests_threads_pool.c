@@ -0,0 +1,194 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_threads_pool.c
+ * @brief Tests of the thread pool
+ */
+
+#include <string.h>
+
+#include "aws_iot_tests_threads_common.h"
+#include "aws_iot_thread_pool.h"
+
+#define SHORT_TIMEOUT_MS 50
+#define LONG_TIMEOUT_MS 5000
+#define QUEUED_TASKS 5
+
+static IoT_Thread_Pool_t pool;
+
+/* A gate task blocks its worker until the test opens the gate */
+static IoT_Semaphore_t gateStarted;
+static IoT_Semaphore_t gateOpen;
+static uint32_t taskCount;
+static uint32_t gateDelayMs;
+
+static void countTask(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	__atomic_fetch_add(&taskCount, 1, __ATOMIC_RELAXED);
+}
+
+static void gateTask(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	aws_iot_thread_semaphore_post(&gateStarted);
+	aws_iot_thread_semaphore_wait(&gateOpen);
+	__atomic_fetch_add(&taskCount, 1, __ATOMIC_RELAXED);
+}
+
+static void openGateAfterDelay(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	threadsTestSleepMs(gateDelayMs);
+	aws_iot_thread_semaphore_post(&gateOpen);
+}
+
+static bool setUp(void) {
+	taskCount = 0;
+	gateDelayMs = 0;
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&gateStarted, 0));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&gateOpen, 0));
+	return true;
+}
+
+static bool tearDown(void) {
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&gateOpen));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&gateStarted));
+	return true;
+}
+
+/* Starts a single worker and blocks it on the gate, so submitted tasks stay queued */
+static bool startBlockedPool(void) {
+	THREADS_CHECK(setUp());
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_init(&pool, 1, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_submit(&pool, gateTask, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&gateStarted, LONG_TIMEOUT_MS));
+	return true;
+}
+
+static bool initRejectsBadParams(void) {
+	IoT_Thread_Params_t params = iotThreadParamsDefault;
+
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_pool_init(NULL, 1, NULL));
+	THREADS_CHECK_EQUAL_INT(LIMIT_EXCEEDED_ERROR, aws_iot_thread_pool_init(&pool, 0, NULL));
+	THREADS_CHECK_EQUAL_INT(LIMIT_EXCEEDED_ERROR,
+							aws_iot_thread_pool_init(&pool, AWS_IOT_THREAD_POOL_MAX_THREADS + 1, NULL));
+
+	/* Workers that cannot be started fail the init */
+	params.cpuAffinity = 1 << 20;
+	THREADS_CHECK_EQUAL_INT(THREAD_CREATE_ERROR, aws_iot_thread_pool_init(&pool, 2, &params));
+
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_pool_submit(NULL, countTask, NULL));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_pool_wait_idle(NULL, 0));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_pool_destroy(NULL));
+
+	return true;
+}
+
+/* Every submitted task runs once */
+static bool runsSubmittedTasks(void) {
+	uint32_t i;
+
+	THREADS_CHECK(setUp());
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_init(&pool, AWS_IOT_THREAD_POOL_MAX_THREADS, NULL));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_pool_submit(&pool, NULL, NULL));
+
+	for(i = 0; i < AWS_IOT_THREAD_POOL_QUEUE_SIZE; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_submit(&pool, countTask, NULL));
+	}
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_wait_idle(&pool, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(AWS_IOT_THREAD_POOL_QUEUE_SIZE, taskCount);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_destroy(&pool));
+	return tearDown();
+}
+
+/* Submit fails with LIMIT_EXCEEDED_ERROR once the ring is full, and works again once it drains */
+static bool submitFailsWhenQueueIsFull(void) {
+	uint32_t i;
+
+	THREADS_CHECK(startBlockedPool());
+
+	for(i = 0; i < AWS_IOT_THREAD_POOL_QUEUE_SIZE; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_submit(&pool, countTask, NULL));
+	}
+	THREADS_CHECK_EQUAL_INT(LIMIT_EXCEEDED_ERROR, aws_iot_thread_pool_submit(&pool, countTask, NULL));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_post(&gateOpen));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_wait_idle(&pool, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(AWS_IOT_THREAD_POOL_QUEUE_SIZE + 1, taskCount);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_submit(&pool, countTask, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_wait_idle(&pool, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(AWS_IOT_THREAD_POOL_QUEUE_SIZE + 2, taskCount);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_destroy(&pool));
+	return tearDown();
+}
+
+/* wait_idle times out while a task is running, and succeeds once it has finished */
+static bool waitIdleTimesOutWhileTaskRuns(void) {
+	uint64_t startMs, elapsedMs;
+
+	THREADS_CHECK(startBlockedPool());
+
+	startMs = threadsTestNowMs();
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR, aws_iot_thread_pool_wait_idle(&pool, SHORT_TIMEOUT_MS));
+	elapsedMs = threadsTestNowMs() - startMs;
+	THREADS_CHECK(elapsedMs >= SHORT_TIMEOUT_MS);
+	THREADS_CHECK(elapsedMs < LONG_TIMEOUT_MS);
+	THREADS_CHECK_EQUAL_INT(0, taskCount);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_post(&gateOpen));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_wait_idle(&pool, LONG_TIMEOUT_MS));
+	THREADS_CHECK_EQUAL_INT(1, taskCount);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_destroy(&pool));
+	return tearDown();
+}
+
+/* destroy returns only after the running task and every queued task have run */
+static bool destroyRunsQueuedTasks(void) {
+	IoT_Thread_t opener;
+	uint32_t i;
+
+	THREADS_CHECK(startBlockedPool());
+
+	for(i = 0; i < QUEUED_TASKS; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_submit(&pool, countTask, NULL));
+	}
+
+	/* The gate opens while destroy is waiting for the worker */
+	gateDelayMs = SHORT_TIMEOUT_MS;
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&opener, openGateAfterDelay, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_pool_destroy(&pool));
+	THREADS_CHECK_EQUAL_INT(QUEUED_TASKS + 1, taskCount);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&opener));
+
+	return tearDown();
+}
+
+static const ThreadsTest tests[] = {
+	{"InitRejectsBadParams", initRejectsBadParams},
+	{"RunsSubmittedTasks", runsSubmittedTasks},
+	{"SubmitFailsWhenQueueIsFull", submitFailsWhenQueueIsFull},
+	{"WaitIdleTimesOutWhileTaskRuns", waitIdleTimesOutWhileTaskRuns},
+	{"DestroyRunsQueuedTasks", destroyRunsQueuedTasks},
+};
+
+int main(void) {
+	return runThreadsTests("ThreadPoolTests", tests, sizeof(tests) / sizeof(tests[0]));
+}
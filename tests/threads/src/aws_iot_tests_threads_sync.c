@@ -0,0 +1,278 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_threads_sync.c
+ * @brief Tests of the condition variables, semaphores and threads of the platform threading layer
+ */
+
+/* CPU_SETSIZE is a GNU extension */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <sched.h>
+#include <string.h>
+
+#include "aws_iot_tests_threads_common.h"
+#include "threads_interface.h"
+
+#define SHORT_TIMEOUT_MS 50
+#define LONG_TIMEOUT_MS 5000
+#define BROADCAST_WAITERS 3
+
+typedef struct {
+	IoT_Mutex_t lock;
+	IoT_Cond_t cond;
+	IoT_Semaphore_t semaphore;
+	uint32_t delayMs;
+	uint32_t waiterCount;
+	uint32_t wokenCount;
+	bool isSet;
+} SyncFixture;
+
+static SyncFixture fixture;
+
+static bool initFixture(uint32_t semaphoreCount) {
+	memset(&fixture, 0, sizeof(fixture));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_init(&fixture.lock));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_cond_init(&fixture.cond));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_init(&fixture.semaphore, semaphoreCount));
+	return true;
+}
+
+static bool destroyFixture(void) {
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_destroy(&fixture.semaphore));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_cond_destroy(&fixture.cond));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_destroy(&fixture.lock));
+	return true;
+}
+
+static void postAfterDelay(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	threadsTestSleepMs(fixture.delayMs);
+	aws_iot_thread_semaphore_post(&fixture.semaphore);
+}
+
+static void setAndSignalAfterDelay(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	threadsTestSleepMs(fixture.delayMs);
+	aws_iot_thread_mutex_lock(&fixture.lock);
+	fixture.isSet = true;
+	aws_iot_thread_cond_signal(&fixture.cond);
+	aws_iot_thread_mutex_unlock(&fixture.lock);
+}
+
+static void waitForBroadcast(void *pArg) {
+	IOT_UNUSED(pArg);
+
+	aws_iot_thread_mutex_lock(&fixture.lock);
+	fixture.waiterCount++;
+	/* The other waiters share the condition, a signal could wake one of them instead of the test */
+	aws_iot_thread_cond_broadcast(&fixture.cond);
+	while(!fixture.isSet) {
+		aws_iot_thread_cond_wait(&fixture.cond, &fixture.lock);
+	}
+	fixture.wokenCount++;
+	aws_iot_thread_mutex_unlock(&fixture.lock);
+}
+
+static void storeArgument(void *pArg) {
+	*((uint32_t *) pArg) = 42;
+}
+
+/* timedwait(0) only tries, it never blocks */
+static bool semaphoreTryDoesNotWait(void) {
+	uint64_t startMs;
+
+	THREADS_CHECK(initFixture(0));
+
+	startMs = threadsTestNowMs();
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR, aws_iot_thread_semaphore_timedwait(&fixture.semaphore, 0));
+	THREADS_CHECK(threadsTestNowMs() - startMs < SHORT_TIMEOUT_MS);
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_post(&fixture.semaphore));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&fixture.semaphore, 0));
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR, aws_iot_thread_semaphore_timedwait(&fixture.semaphore, 0));
+
+	return destroyFixture();
+}
+
+/* The initial count is taken one by one */
+static bool semaphoreCountsDown(void) {
+	THREADS_CHECK(initFixture(2));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&fixture.semaphore, 0));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_wait(&fixture.semaphore));
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR, aws_iot_thread_semaphore_timedwait(&fixture.semaphore, 0));
+
+	return destroyFixture();
+}
+
+/* A timed wait on a zero count returns once the timeout has elapsed */
+static bool semaphoreTimedWaitTimesOut(void) {
+	uint64_t startMs, elapsedMs;
+
+	THREADS_CHECK(initFixture(0));
+
+	startMs = threadsTestNowMs();
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR,
+							aws_iot_thread_semaphore_timedwait(&fixture.semaphore, SHORT_TIMEOUT_MS));
+	elapsedMs = threadsTestNowMs() - startMs;
+	THREADS_CHECK(elapsedMs >= SHORT_TIMEOUT_MS);
+	THREADS_CHECK(elapsedMs < LONG_TIMEOUT_MS);
+
+	return destroyFixture();
+}
+
+/* A post from another thread ends a timed wait before its timeout */
+static bool semaphorePostWakesTimedWait(void) {
+	IoT_Thread_t poster;
+	uint64_t startMs;
+
+	THREADS_CHECK(initFixture(0));
+	fixture.delayMs = SHORT_TIMEOUT_MS;
+
+	startMs = threadsTestNowMs();
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&poster, postAfterDelay, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_semaphore_timedwait(&fixture.semaphore, LONG_TIMEOUT_MS));
+	THREADS_CHECK(threadsTestNowMs() - startMs < LONG_TIMEOUT_MS);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&poster));
+
+	return destroyFixture();
+}
+
+/* A timed wait times out on CLOCK_MONOTONIC and returns with the mutex held */
+static bool condTimedWaitTimesOut(void) {
+	uint64_t startMs, elapsedMs;
+
+	THREADS_CHECK(initFixture(0));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_lock(&fixture.lock));
+	startMs = threadsTestNowMs();
+	THREADS_CHECK_EQUAL_INT(THREAD_WAIT_TIMEOUT_ERROR,
+							aws_iot_thread_cond_timedwait(&fixture.cond, &fixture.lock, SHORT_TIMEOUT_MS));
+	elapsedMs = threadsTestNowMs() - startMs;
+	THREADS_CHECK_EQUAL_INT(MUTEX_LOCK_ERROR, aws_iot_thread_mutex_trylock(&fixture.lock));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_mutex_unlock(&fixture.lock));
+
+	THREADS_CHECK(elapsedMs >= SHORT_TIMEOUT_MS);
+	THREADS_CHECK(elapsedMs < LONG_TIMEOUT_MS);
+
+	return destroyFixture();
+}
+
+/* A signal ends a timed wait before its timeout */
+static bool condSignalWakesTimedWait(void) {
+	IoT_Thread_t signaller;
+	IoT_Error_t rc = SUCCESS;
+
+	THREADS_CHECK(initFixture(0));
+	fixture.delayMs = SHORT_TIMEOUT_MS;
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&signaller, setAndSignalAfterDelay, NULL, NULL));
+	aws_iot_thread_mutex_lock(&fixture.lock);
+	while(!fixture.isSet && SUCCESS == rc) {
+		rc = aws_iot_thread_cond_timedwait(&fixture.cond, &fixture.lock, LONG_TIMEOUT_MS);
+	}
+	aws_iot_thread_mutex_unlock(&fixture.lock);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&signaller));
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, rc);
+	THREADS_CHECK(fixture.isSet);
+
+	return destroyFixture();
+}
+
+/* A broadcast wakes every waiter */
+static bool condBroadcastWakesAll(void) {
+	IoT_Thread_t waiters[BROADCAST_WAITERS];
+	IoT_Error_t rc = SUCCESS;
+	uint32_t i;
+
+	THREADS_CHECK(initFixture(0));
+
+	for(i = 0; i < BROADCAST_WAITERS; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&waiters[i], waitForBroadcast, NULL, NULL));
+	}
+
+	aws_iot_thread_mutex_lock(&fixture.lock);
+	while(BROADCAST_WAITERS != fixture.waiterCount && SUCCESS == rc) {
+		rc = aws_iot_thread_cond_timedwait(&fixture.cond, &fixture.lock, LONG_TIMEOUT_MS);
+	}
+	fixture.isSet = true;
+	aws_iot_thread_cond_broadcast(&fixture.cond);
+	aws_iot_thread_mutex_unlock(&fixture.lock);
+	THREADS_CHECK_EQUAL_INT(SUCCESS, rc);
+
+	for(i = 0; i < BROADCAST_WAITERS; i++) {
+		THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&waiters[i]));
+	}
+	THREADS_CHECK_EQUAL_INT(BROADCAST_WAITERS, fixture.wokenCount);
+
+	return destroyFixture();
+}
+
+/* The routine runs with its argument, under the requested affinity and stack size */
+static bool threadRunsRoutine(void) {
+	IoT_Thread_Params_t params = iotThreadParamsDefault;
+	IoT_Thread_t thread;
+	uint32_t value = 0;
+
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&thread, storeArgument, &value, NULL));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&thread));
+	THREADS_CHECK_EQUAL_INT(42, value);
+
+	value = 0;
+	params.cpuAffinity = 0;
+	params.stackSize = 256 * 1024;
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_create(&thread, storeArgument, &value, &params));
+	THREADS_CHECK_EQUAL_INT(SUCCESS, aws_iot_thread_join(&thread));
+	THREADS_CHECK_EQUAL_INT(42, value);
+
+	return true;
+}
+
+static bool threadCreateRejectsBadParams(void) {
+	IoT_Thread_Params_t params = iotThreadParamsDefault;
+	IoT_Thread_t thread;
+
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_create(NULL, storeArgument, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_create(&thread, NULL, NULL, NULL));
+	THREADS_CHECK_EQUAL_INT(NULL_VALUE_ERROR, aws_iot_thread_join(NULL));
+
+	params.cpuAffinity = CPU_SETSIZE;
+	THREADS_CHECK_EQUAL_INT(THREAD_CREATE_ERROR, aws_iot_thread_create(&thread, storeArgument, NULL, &params));
+
+	return true;
+}
+
+static const ThreadsTest tests[] = {
+	{"SemaphoreTryDoesNotWait", semaphoreTryDoesNotWait},
+	{"SemaphoreCountsDown", semaphoreCountsDown},
+	{"SemaphoreTimedWaitTimesOut", semaphoreTimedWaitTimesOut},
+	{"SemaphorePostWakesTimedWait", semaphorePostWakesTimedWait},
+	{"CondTimedWaitTimesOut", condTimedWaitTimesOut},
+	{"CondSignalWakesTimedWait", condSignalWakesTimedWait},
+	{"CondBroadcastWakesAll", condBroadcastWakesAll},
+	{"ThreadRunsRoutine", threadRunsRoutine},
+	{"ThreadCreateRejectsBadParams", threadCreateRejectsBadParams},
+};
+
+int main(void) {
+	return runThreadsTests("ThreadSyncTests", tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_buffer_pool_helper.c
+ * @brief IoT Client Unit Testing - Buffer Pool Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_buffer_pool.h"
+#include "aws_iot_log.h"
+
+#define SMALL_BLOCK_SIZE 256
+#define SMALL_BLOCK_COUNT 4
+#define LARGE_BLOCK_SIZE 1024
+#define LARGE_BLOCK_COUNT 1
+#define LARGE_PAYLOAD_LEN 600
+
+static uint64_t smallMemory[SMALL_BLOCK_SIZE * SMALL_BLOCK_COUNT / sizeof(uint64_t)];
+static uint64_t largeMemory[LARGE_BLOCK_SIZE * LARGE_BLOCK_COUNT / sizeof(uint64_t)];
+static IoT_Buffer_Pool_t pool;
+
+static IoT_Client_Init_Params initParams;
+static IoT_Client_Connect_Params connectParams;
+static AWS_IoT_Client iotClient;
+static IoT_Publish_Message_Params testPubMsgParams;
+
+static char subTopic[] = "sdk/Pool";
+static char largePayload[LARGE_PAYLOAD_LEN + 1];
+static size_t receivedPayloadLen;
+static bool isPayloadMatched;
+
+static void disconnectHandler(AWS_IoT_Client *pClient, void *pData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(pData);
+}
+
+static void largeMessageCallback(AWS_IoT_Client *pClient, char *pTopicName, uint16_t topicNameLen,
+								 IoT_Publish_Message_Params *pParams, void *pData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(pTopicName);
+	IOT_UNUSED(topicNameLen);
+	IOT_UNUSED(pData);
+
+	receivedPayloadLen = pParams->payloadLen;
+	isPayloadMatched = (LARGE_PAYLOAD_LEN == pParams->payloadLen
+						&& 0 == memcmp(pParams->payload, largePayload, LARGE_PAYLOAD_LEN));
+}
+
+static void initPool(void) {
+	IoT_Buffer_Pool_Class_t classes[2];
+
+	/* Given largest first, the pool sorts them */
+	classes[0].blockSize = LARGE_BLOCK_SIZE;
+	classes[0].blockCount = LARGE_BLOCK_COUNT;
+	classes[0].pMemory = (unsigned char *) largeMemory;
+	classes[1].blockSize = SMALL_BLOCK_SIZE;
+	classes[1].blockCount = SMALL_BLOCK_COUNT;
+	classes[1].pMemory = (unsigned char *) smallMemory;
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_init(&pool, classes, 2));
+}
+
+static void connectPooledClient(void) {
+	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, disconnectHandler);
+	initParams.pBufferPool = &pool;
+	initParams.writeBufSize = SMALL_BLOCK_SIZE;
+	initParams.readBufSize = SMALL_BLOCK_SIZE;
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_init(&iotClient, &initParams));
+
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_connect(&iotClient, &connectParams));
+	ResetTLSBuffer();
+}
+
+/* Queues a QoS 0 publish of largePayload, whose remaining length takes two bytes */
+static void setTLSRxBufferForLargeMessage(void) {
+	size_t topicLen = strlen(subTopic);
+	size_t remLen = 2 + topicLen + LARGE_PAYLOAD_LEN;
+	size_t cursor = 0;
+
+	RxBuffer.NoMsgFlag = false;
+	RxBuffer.pBuffer[cursor++] = 0x30;
+	RxBuffer.pBuffer[cursor++] = (unsigned char) (0x80 | (remLen % 128));
+	RxBuffer.pBuffer[cursor++] = (unsigned char) (remLen / 128);
+	RxBuffer.pBuffer[cursor++] = (unsigned char) (topicLen >> 8);
+	RxBuffer.pBuffer[cursor++] = (unsigned char) (topicLen & 0xFF);
+	memcpy(&RxBuffer.pBuffer[cursor], subTopic, topicLen);
+	cursor += topicLen;
+	memcpy(&RxBuffer.pBuffer[cursor], largePayload, LARGE_PAYLOAD_LEN);
+	cursor += LARGE_PAYLOAD_LEN;
+
+	RxBuffer.len = cursor;
+	RxIndex = 0;
+}
+
+TEST_GROUP_C_SETUP(BufferPoolTests) {
+	size_t i;
+
+	for(i = 0; i < LARGE_PAYLOAD_LEN; i++) {
+		largePayload[i] = (char) ('a' + i % 26);
+	}
+	largePayload[LARGE_PAYLOAD_LEN] = '\0';
+	receivedPayloadLen = 0;
+	isPayloadMatched = false;
+	memset(&iotClient, 0, sizeof(iotClient));
+	ResetTLSBuffer();
+	initPool();
+}
+
+TEST_GROUP_C_TEARDOWN(BufferPoolTests) {
+	(void) aws_iot_buffer_pool_destroy(&pool);
+}
+
+TEST_C(BufferPoolTests, AcquirePicksSmallestFittingClass) {
+	unsigned char *pSmall[SMALL_BLOCK_COUNT];
+	unsigned char *pLarge;
+	unsigned char *pExtra;
+	size_t size;
+	uint16_t minFree;
+	uint8_t i;
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_acquire(&pool, 300, &pLarge, &size));
+	CHECK_EQUAL_C_INT(LARGE_BLOCK_SIZE, (int) size);
+
+	for(i = 0; i < SMALL_BLOCK_COUNT; i++) {
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_acquire(&pool, 100, &pSmall[i], &size));
+		CHECK_EQUAL_C_INT(SMALL_BLOCK_SIZE, (int) size);
+	}
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR, aws_iot_buffer_pool_acquire(&pool, 100, &pExtra, &size));
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR, aws_iot_buffer_pool_acquire(&pool, 2048, &pExtra, &size));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_release(&pool, pLarge));
+	/* The small class is exhausted, a small request falls back to the large class */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_acquire(&pool, 100, &pExtra, &size));
+	CHECK_EQUAL_C_INT(LARGE_BLOCK_SIZE, (int) size);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_release(&pool, pExtra));
+
+	for(i = 0; i < SMALL_BLOCK_COUNT; i++) {
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_release(&pool, pSmall[i]));
+	}
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_COUNT, aws_iot_buffer_pool_get_free_count(&pool, SMALL_BLOCK_SIZE, &minFree));
+	CHECK_EQUAL_C_INT(0, minFree);
+	CHECK_EQUAL_C_INT(LARGE_BLOCK_COUNT, aws_iot_buffer_pool_get_free_count(&pool, LARGE_BLOCK_SIZE, NULL));
+	CHECK_EQUAL_C_INT(0, aws_iot_buffer_pool_get_free_count(&pool, 512, NULL));
+}
+
+TEST_C(BufferPoolTests, ReleaseRejectsForeignBlocks) {
+	unsigned char foreign[16];
+	unsigned char *pBlock;
+	size_t size;
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_buffer_pool_release(&pool, NULL));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_buffer_pool_release(&pool, foreign));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_acquire(&pool, 1, &pBlock, &size));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_buffer_pool_release(&pool, pBlock + 8));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_release(&pool, pBlock));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_buffer_pool_release(&pool, pBlock));
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_COUNT, aws_iot_buffer_pool_get_free_count(&pool, SMALL_BLOCK_SIZE, NULL));
+}
+
+TEST_C(BufferPoolTests, InitRejectsInvalidClasses) {
+	IoT_Buffer_Pool_t otherPool;
+	IoT_Buffer_Pool_Class_t classes[AWS_IOT_BUFFER_POOL_MAX_CLASSES + 1];
+
+	memset(classes, 0, sizeof(classes));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_buffer_pool_init(NULL, classes, 1));
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR,
+					  aws_iot_buffer_pool_init(&otherPool, classes, AWS_IOT_BUFFER_POOL_MAX_CLASSES + 1));
+
+	classes[0].blockSize = 100;
+	classes[0].blockCount = 2;
+	classes[0].pMemory = (unsigned char *) smallMemory;
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_buffer_pool_init(&otherPool, classes, 1));
+
+	classes[0].blockSize = 64;
+	classes[0].blockCount = 0;
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_buffer_pool_init(&otherPool, classes, 1));
+}
+
+TEST_C(BufferPoolTests, ClientTakesBuffersFromPool) {
+	connectPooledClient();
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_COUNT - 2, aws_iot_buffer_pool_get_free_count(&pool, SMALL_BLOCK_SIZE, NULL));
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_SIZE, (int) iotClient.clientData.writeBufSize);
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_SIZE, (int) iotClient.clientData.readBufSize);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_disconnect(&iotClient));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_free(&iotClient));
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_COUNT, aws_iot_buffer_pool_get_free_count(&pool, SMALL_BLOCK_SIZE, NULL));
+}
+
+TEST_C(BufferPoolTests, LargeMessageBorrowsPoolBuffer) {
+	uint16_t minFree;
+
+	connectPooledClient();
+	setTLSRxBufferForSuback(subTopic, strlen(subTopic), QOS0, testPubMsgParams);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_subscribe(&iotClient, subTopic, (uint16_t) strlen(subTopic), QOS0,
+													   largeMessageCallback, NULL));
+
+	setTLSRxBufferForLargeMessage();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_yield(&iotClient, 100));
+	CHECK_EQUAL_C_INT(LARGE_PAYLOAD_LEN, (int) receivedPayloadLen);
+	CHECK_C(isPayloadMatched);
+
+	/* The large block went back to the pool once the message was delivered */
+	CHECK_EQUAL_C_INT(LARGE_BLOCK_COUNT, aws_iot_buffer_pool_get_free_count(&pool, LARGE_BLOCK_SIZE, &minFree));
+	CHECK_EQUAL_C_INT(0, minFree);
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_SIZE, (int) iotClient.clientData.readBufSize);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_disconnect(&iotClient));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_free(&iotClient));
+}
+
+TEST_C(BufferPoolTests, LargePublishBorrowsPoolBuffer) {
+	IoT_Publish_Message_Params params;
+	unsigned char *pLarge;
+	size_t size;
+
+	connectPooledClient();
+
+	params.qos = QOS0;
+	params.isRetained = 0;
+	params.payload = largePayload;
+	params.payloadLen = LARGE_PAYLOAD_LEN;
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_publish(&iotClient, subTopic, (uint16_t) strlen(subTopic), &params));
+	/* Fixed header with a two byte remaining length, then the topic and the payload */
+	CHECK_EQUAL_C_INT(3 + 2 + (int) strlen(subTopic) + LARGE_PAYLOAD_LEN, (int) TxBuffer.len);
+	CHECK_EQUAL_C_INT(0, memcmp(TxBuffer.pBuffer + 3 + 2 + strlen(subTopic), largePayload, LARGE_PAYLOAD_LEN));
+	CHECK_EQUAL_C_INT(LARGE_BLOCK_COUNT, aws_iot_buffer_pool_get_free_count(&pool, LARGE_BLOCK_SIZE, NULL));
+	CHECK_EQUAL_C_INT(SMALL_BLOCK_SIZE, (int) iotClient.clientData.writeBufSize);
+
+	/* Without a free large block the publish fails as it did before */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_acquire(&pool, LARGE_BLOCK_SIZE, &pLarge, &size));
+	CHECK_EQUAL_C_INT(MQTT_TX_BUFFER_TOO_SHORT_ERROR,
+					  aws_iot_mqtt_publish(&iotClient, subTopic, (uint16_t) strlen(subTopic), &params));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_buffer_pool_release(&pool, pLarge));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_disconnect(&iotClient));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_free(&iotClient));
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_cbor_helper.c
+ * @brief IoT Client Unit Testing - CBOR Tests helper
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_cbor.h"
+#include "aws_iot_log.h"
+
+static uint8_t cborBuffer[256];
+static IoT_Cbor_Writer_t writer;
+static uint32_t callbackCount;
+
+static void checkEncoding(const uint8_t *pExpected, size_t expectedLength) {
+	CHECK_EQUAL_C_INT((int) expectedLength, (int) writer.length);
+	CHECK_EQUAL_C_INT(0, memcmp(pExpected, cborBuffer, expectedLength));
+	aws_iot_cbor_writer_init(&writer, cborBuffer, sizeof(cborBuffer));
+}
+
+static void initField(jsonStruct_t *pField, const char *pKey, void *pData, size_t dataLength,
+					  JsonPrimitiveType type) {
+	pField->pKey = pKey;
+	pField->pData = pData;
+	pField->dataLength = dataLength;
+	pField->type = type;
+	pField->cb = NULL;
+}
+
+static void countingCallback(const char *pJsonValueBuffer, uint32_t valueLength, jsonStruct_t *pJsonStruct_t) {
+	IOT_UNUSED(pJsonValueBuffer);
+	IOT_UNUSED(pJsonStruct_t);
+	CHECK_C(valueLength > 0);
+	callbackCount++;
+}
+
+TEST_GROUP_C_SETUP(CborTests) {
+	memset(cborBuffer, 0xAA, sizeof(cborBuffer));
+	aws_iot_cbor_writer_init(&writer, cborBuffer, sizeof(cborBuffer));
+	callbackCount = 0;
+}
+
+TEST_GROUP_C_TEARDOWN(CborTests) { }
+
+/* Expected encodings from RFC 7049 Appendix A */
+TEST_C(CborTests, EncodesIntegers) {
+	static const uint8_t zero[] = {0x00};
+	static const uint8_t twentyThree[] = {0x17};
+	static const uint8_t twentyFour[] = {0x18, 0x18};
+	static const uint8_t thousand[] = {0x19, 0x03, 0xe8};
+	static const uint8_t million[] = {0x1a, 0x00, 0x0f, 0x42, 0x40};
+	static const uint8_t trillion[] = {0x1b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10, 0x00};
+	static const uint8_t minusOne[] = {0x20};
+	static const uint8_t minusThousand[] = {0x39, 0x03, 0xe7};
+	static const uint8_t text[] = {0x64, 0x49, 0x45, 0x54, 0x46};
+	static const uint8_t map[] = {0xa2, 0x61, 0x61, 0x01, 0x61, 0x62, 0x82, 0x02, 0x03};
+	static const uint8_t simple[] = {0xf4, 0xf5, 0xf6};
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Encodes integers \n");
+
+	aws_iot_cbor_writer_uint(&writer, 0);
+	checkEncoding(zero, sizeof(zero));
+	aws_iot_cbor_writer_uint(&writer, 23);
+	checkEncoding(twentyThree, sizeof(twentyThree));
+	aws_iot_cbor_writer_int(&writer, 24);
+	checkEncoding(twentyFour, sizeof(twentyFour));
+	aws_iot_cbor_writer_int(&writer, 1000);
+	checkEncoding(thousand, sizeof(thousand));
+	aws_iot_cbor_writer_uint(&writer, 1000000);
+	checkEncoding(million, sizeof(million));
+	aws_iot_cbor_writer_uint(&writer, 1000000000000ULL);
+	checkEncoding(trillion, sizeof(trillion));
+	aws_iot_cbor_writer_int(&writer, -1);
+	checkEncoding(minusOne, sizeof(minusOne));
+	aws_iot_cbor_writer_int(&writer, -1000);
+	checkEncoding(minusThousand, sizeof(minusThousand));
+	aws_iot_cbor_writer_text(&writer, "IETF", 4);
+	checkEncoding(text, sizeof(text));
+
+	aws_iot_cbor_writer_map(&writer, 2);
+	aws_iot_cbor_writer_text(&writer, "a", 1);
+	aws_iot_cbor_writer_uint(&writer, 1);
+	aws_iot_cbor_writer_text(&writer, "b", 1);
+	aws_iot_cbor_writer_array(&writer, 2);
+	aws_iot_cbor_writer_uint(&writer, 2);
+	aws_iot_cbor_writer_uint(&writer, 3);
+	checkEncoding(map, sizeof(map));
+
+	aws_iot_cbor_writer_bool(&writer, false);
+	aws_iot_cbor_writer_bool(&writer, true);
+	aws_iot_cbor_writer_null(&writer);
+	checkEncoding(simple, sizeof(simple));
+
+	IOT_DEBUG("-->Success - Encodes integers \n");
+}
+
+TEST_C(CborTests, EncodesSmallestFloats) {
+	static const uint8_t zero[] = {0xf9, 0x00, 0x00};
+	static const uint8_t minusZero[] = {0xf9, 0x80, 0x00};
+	static const uint8_t oneAndHalf[] = {0xf9, 0x3e, 0x00};
+	static const uint8_t halfMax[] = {0xf9, 0x7b, 0xff};
+	static const uint8_t halfSubnormal[] = {0xf9, 0x00, 0x01};
+	static const uint8_t hundredThousand[] = {0xfa, 0x47, 0xc3, 0x50, 0x00};
+	static const uint8_t oneDotOne[] = {0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a};
+	static const uint8_t minusFour[] = {0xf9, 0xc4, 0x00};
+	static const uint8_t largeDouble[] = {0xfb, 0x7e, 0x37, 0xe4, 0x3c, 0x88, 0x00, 0x75, 0x9c};
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Encodes smallest floats \n");
+
+	aws_iot_cbor_writer_float(&writer, 0.0f);
+	checkEncoding(zero, sizeof(zero));
+	aws_iot_cbor_writer_double(&writer, -0.0);
+	checkEncoding(minusZero, sizeof(minusZero));
+	aws_iot_cbor_writer_float(&writer, 1.5f);
+	checkEncoding(oneAndHalf, sizeof(oneAndHalf));
+	aws_iot_cbor_writer_double(&writer, 65504.0);
+	checkEncoding(halfMax, sizeof(halfMax));
+	aws_iot_cbor_writer_double(&writer, 5.960464477539063e-8);
+	checkEncoding(halfSubnormal, sizeof(halfSubnormal));
+	aws_iot_cbor_writer_float(&writer, 100000.0f);
+	checkEncoding(hundredThousand, sizeof(hundredThousand));
+	aws_iot_cbor_writer_double(&writer, 1.1);
+	checkEncoding(oneDotOne, sizeof(oneDotOne));
+	aws_iot_cbor_writer_double(&writer, -4.0);
+	checkEncoding(minusFour, sizeof(minusFour));
+	aws_iot_cbor_writer_double(&writer, 1.0e300);
+	checkEncoding(largeDouble, sizeof(largeDouble));
+
+	IOT_DEBUG("-->Success - Encodes smallest floats \n");
+}
+
+TEST_C(CborTests, FieldsRoundTrip) {
+	int32_t i32 = -2000000000, i32Out = 0;
+	int16_t i16 = -300, i16Out = 0;
+	int8_t i8 = -5, i8Out = 0;
+	uint32_t u32 = 4000000000u, u32Out = 0;
+	uint16_t u16 = 65535, u16Out = 0;
+	uint8_t u8 = 200, u8Out = 0;
+	float f = 23.45f, fOut = 0;
+	double d = -122.349358, dOut = 0;
+	bool b = true, bOut = false;
+	char s[] = "eco", sOut[8] = "";
+	jsonStruct_t in[10], out[10];
+	jsonStruct_t *pIn[10], *pOut[10];
+	size_t encodedLength = 0;
+	uint8_t updated = 0, i;
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Fields round trip \n");
+
+	initField(&in[0], "i32", &i32, sizeof(i32), SHADOW_JSON_INT32);
+	initField(&in[1], "i16", &i16, sizeof(i16), SHADOW_JSON_INT16);
+	initField(&in[2], "i8", &i8, sizeof(i8), SHADOW_JSON_INT8);
+	initField(&in[3], "u32", &u32, sizeof(u32), SHADOW_JSON_UINT32);
+	initField(&in[4], "u16", &u16, sizeof(u16), SHADOW_JSON_UINT16);
+	initField(&in[5], "u8", &u8, sizeof(u8), SHADOW_JSON_UINT8);
+	initField(&in[6], "f", &f, sizeof(f), SHADOW_JSON_FLOAT);
+	initField(&in[7], "d", &d, sizeof(d), SHADOW_JSON_DOUBLE);
+	initField(&in[8], "b", &b, sizeof(b), SHADOW_JSON_BOOL);
+	initField(&in[9], "s", s, sizeof(s), SHADOW_JSON_STRING);
+	initField(&out[0], "i32", &i32Out, sizeof(i32Out), SHADOW_JSON_INT32);
+	initField(&out[1], "i16", &i16Out, sizeof(i16Out), SHADOW_JSON_INT16);
+	initField(&out[2], "i8", &i8Out, sizeof(i8Out), SHADOW_JSON_INT8);
+	initField(&out[3], "u32", &u32Out, sizeof(u32Out), SHADOW_JSON_UINT32);
+	initField(&out[4], "u16", &u16Out, sizeof(u16Out), SHADOW_JSON_UINT16);
+	initField(&out[5], "u8", &u8Out, sizeof(u8Out), SHADOW_JSON_UINT8);
+	initField(&out[6], "f", &fOut, sizeof(fOut), SHADOW_JSON_FLOAT);
+	initField(&out[7], "d", &dOut, sizeof(dOut), SHADOW_JSON_DOUBLE);
+	initField(&out[8], "b", &bOut, sizeof(bOut), SHADOW_JSON_BOOL);
+	initField(&out[9], "s", sOut, sizeof(sOut), SHADOW_JSON_STRING);
+	for(i = 0; i < 10; i++) {
+		pIn[i] = &in[i];
+		/* Decoding does not depend on the order of the fields */
+		pOut[9 - i] = &out[i];
+		out[i].cb = countingCallback;
+	}
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_cbor_encode_fields(cborBuffer, sizeof(cborBuffer), &encodedLength, 10, pIn));
+	CHECK_EQUAL_C_INT(0xa0 | 10, cborBuffer[0]);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_cbor_decode_fields(cborBuffer, encodedLength, 10, pOut, &updated));
+
+	CHECK_EQUAL_C_INT(10, updated);
+	CHECK_EQUAL_C_INT(10, callbackCount);
+	CHECK_EQUAL_C_INT(i32, i32Out);
+	CHECK_EQUAL_C_INT(i16, i16Out);
+	CHECK_EQUAL_C_INT(i8, i8Out);
+	CHECK_C(u32 == u32Out);
+	CHECK_EQUAL_C_INT(u16, u16Out);
+	CHECK_EQUAL_C_INT(u8, u8Out);
+	CHECK_C(f == fOut);
+	CHECK_C(d == dOut);
+	CHECK_C(bOut);
+	CHECK_EQUAL_C_STRING(s, sOut);
+
+	IOT_DEBUG("-->Success - Fields round trip \n");
+}
+
+TEST_C(CborTests, EncodeTruncatedAndMeasured) {
+	uint32_t counter = 1000000;
+	char mode[] = "comfort";
+	jsonStruct_t fields[2];
+	jsonStruct_t *pFields[2] = {&fields[0], &fields[1]};
+	size_t measuredLength = 0, encodedLength = 0;
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Encode truncated and measured \n");
+
+	initField(&fields[0], "counter", &counter, sizeof(counter), SHADOW_JSON_UINT32);
+	initField(&fields[1], "mode", mode, sizeof(mode), SHADOW_JSON_STRING);
+
+	/* 1 map + 8 key + 5 counter + 5 key + 8 mode */
+	CHECK_EQUAL_C_INT(SHADOW_JSON_BUFFER_TRUNCATED, aws_iot_cbor_encode_fields(NULL, 0, &measuredLength, 2, pFields));
+	CHECK_EQUAL_C_INT(27, (int) measuredLength);
+
+	CHECK_EQUAL_C_INT(SHADOW_JSON_BUFFER_TRUNCATED,
+					  aws_iot_cbor_encode_fields(cborBuffer, 10, &encodedLength, 2, pFields));
+	CHECK_EQUAL_C_INT(27, (int) encodedLength);
+	CHECK_EQUAL_C_INT(0xAA, cborBuffer[10]);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_cbor_encode_fields(cborBuffer, 27, &encodedLength, 2, pFields));
+	CHECK_EQUAL_C_INT(27, (int) encodedLength);
+
+	fields[1].type = SHADOW_JSON_OBJECT;
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, aws_iot_cbor_encode_fields(cborBuffer, 27, &encodedLength, 2, pFields));
+	fields[1].pData = NULL;
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_cbor_encode_fields(cborBuffer, 27, &encodedLength, 2, pFields));
+
+	IOT_DEBUG("-->Success - Encode truncated and measured \n");
+}
+
+TEST_C(CborTests, DecodeSkipsUnknownAndMismatched) {
+	/* {"x":[1,{"y":2}], 7:"z", "u8":-1, "s":"toolongvalue", "i16":300, "f":2, "b":1} */
+	static const uint8_t document[] = {0xa7,
+		0x61, 'x', 0x82, 0x01, 0xa1, 0x61, 'y', 0x02,
+		0x07, 0x61, 'z',
+		0x62, 'u', '8', 0x20,
+		0x61, 's', 0x6c, 't', 'o', 'o', 'l', 'o', 'n', 'g', 'v', 'a', 'l', 'u', 'e',
+		0x63, 'i', '1', '6', 0x19, 0x01, 0x2c,
+		0x61, 'f', 0x02,
+		0x61, 'b', 0x01};
+	uint8_t u8 = 7;
+	char s[8] = "keep";
+	int16_t i16 = 0;
+	float f = 0;
+	bool b = false;
+	jsonStruct_t fields[5];
+	jsonStruct_t *pFields[5] = {&fields[0], &fields[1], &fields[2], &fields[3], &fields[4]};
+	uint8_t updated = 0;
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Decode skips unknown and mismatched \n");
+
+	initField(&fields[0], "u8", &u8, sizeof(u8), SHADOW_JSON_UINT8);
+	initField(&fields[1], "s", s, sizeof(s), SHADOW_JSON_STRING);
+	initField(&fields[2], "i16", &i16, sizeof(i16), SHADOW_JSON_INT16);
+	initField(&fields[3], "f", &f, sizeof(f), SHADOW_JSON_FLOAT);
+	initField(&fields[4], "b", &b, sizeof(b), SHADOW_JSON_BOOL);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_cbor_decode_fields(document, sizeof(document), 5, pFields, &updated));
+	CHECK_EQUAL_C_INT(2, updated);
+	CHECK_EQUAL_C_INT(7, u8);
+	CHECK_EQUAL_C_STRING("keep", s);
+	CHECK_EQUAL_C_INT(300, i16);
+	CHECK_C(2.0f == f);
+	CHECK_C(!b);
+
+	IOT_DEBUG("-->Success - Decode skips unknown and mismatched \n");
+}
+
+TEST_C(CborTests, DecodeKeyWithEmbeddedNul) {
+	/* {"ab\0xyz":1, "a":2} */
+	static const uint8_t document[] = {0xa2,
+		0x66, 'a', 'b', '\0', 'x', 'y', 'z', 0x01,
+		0x61, 'a', 0x02};
+	int32_t ab = 0, a = 0;
+	jsonStruct_t fields[2];
+	jsonStruct_t *pFields[2] = {&fields[0], &fields[1]};
+	uint8_t updated = 0;
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Decode key with embedded NUL \n");
+
+	/* Heap copies of the keys, so that reading past them is caught by the sanitizers */
+	initField(&fields[0], strdup("ab"), &ab, sizeof(ab), SHADOW_JSON_INT32);
+	initField(&fields[1], strdup("a"), &a, sizeof(a), SHADOW_JSON_INT32);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_cbor_decode_fields(document, sizeof(document), 2, pFields, &updated));
+	CHECK_EQUAL_C_INT(1, updated);
+	CHECK_EQUAL_C_INT(0, ab);
+	CHECK_EQUAL_C_INT(2, a);
+
+	free((void *) fields[0].pKey);
+	free((void *) fields[1].pKey);
+
+	IOT_DEBUG("-->Success - Decode key with embedded NUL \n");
+}
+
+TEST_C(CborTests, DecodeRejectsMalformed) {
+	static const uint8_t notMap[] = {0x82, 0x01, 0x02};
+	static const uint8_t shortKey[] = {0xa1, 0x65, 'a', 'b'};
+	static const uint8_t missingValue[] = {0xa1, 0x61, 'a'};
+	static const uint8_t shortValue[] = {0xa1, 0x61, 'a', 0x1a, 0x00, 0x01};
+	static const uint8_t indefinite[] = {0xbf, 0x61, 'a', 0x01, 0xff};
+	static const uint8_t hugeArray[] = {0xa1, 0x61, 'x', 0x9b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+	int32_t a = 0;
+	jsonStruct_t field;
+	jsonStruct_t *pField = &field;
+
+	IOT_DEBUG("\n-->Running CBOR Tests - Decode rejects malformed \n");
+
+	initField(&field, "a", &a, sizeof(a), SHADOW_JSON_INT32);
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_cbor_decode_fields(NULL, 0, 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_cbor_decode_fields(notMap, 0, 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_cbor_decode_fields(notMap, sizeof(notMap), 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_cbor_decode_fields(shortKey, sizeof(shortKey), 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR,
+					  aws_iot_cbor_decode_fields(missingValue, sizeof(missingValue), 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_cbor_decode_fields(shortValue, sizeof(shortValue), 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_cbor_decode_fields(indefinite, sizeof(indefinite), 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, aws_iot_cbor_decode_fields(hugeArray, sizeof(hugeArray), 1, &pField, NULL));
+	CHECK_EQUAL_C_INT(0, a);
+
+	IOT_DEBUG("-->Success - Decode rejects malformed \n");
+}
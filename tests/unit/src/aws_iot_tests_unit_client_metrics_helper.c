@@ -0,0 +1,220 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_client_metrics_helper.c
+ * @brief IoT Client Unit Testing - Client Metrics Tests helper
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_mqtt_client_interface.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_log.h"
+
+/* MQTT control packet types as counted by the metrics */
+#define METRICS_TEST_CONNECT 1
+#define METRICS_TEST_CONNACK 2
+#define METRICS_TEST_PUBLISH 3
+#define METRICS_TEST_PUBACK 4
+#define METRICS_TEST_SUBSCRIBE 8
+#define METRICS_TEST_SUBACK 9
+
+static IoT_Client_Init_Params initParams;
+static IoT_Client_Connect_Params connectParams;
+static IoT_Publish_Message_Params testPubMsgParams;
+static AWS_IoT_Client iotClient;
+static char metricsPayload[] = "metrics payload";
+static uint8_t callbackCount;
+
+static void metricsCallback(AWS_IoT_Client *pClient, char *pTopicName, uint16_t topicNameLen,
+							IoT_Publish_Message_Params *pParams, void *pClientData) {
+	IOT_UNUSED(pClient);
+	IOT_UNUSED(pTopicName);
+	IOT_UNUSED(topicNameLen);
+	IOT_UNUSED(pParams);
+	IOT_UNUSED(pClientData);
+	callbackCount++;
+}
+
+static uint32_t histogramBucketTotal(const IoT_Client_Latency_Histogram_t *pHistogram) {
+	uint32_t total = 0, i;
+
+	for(i = 0; i < AWS_IOT_CLIENT_METRICS_HISTOGRAM_BUCKETS; i++) {
+		total += pHistogram->buckets[i];
+	}
+	return total;
+}
+
+TEST_GROUP_C_SETUP(ClientMetricsTests) {
+	IoT_Error_t rc;
+
+	ResetTLSBuffer();
+	InitMQTTParamsSetup(&initParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
+	rc = aws_iot_mqtt_init(&iotClient, &initParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	rc = aws_iot_mqtt_connect(&iotClient, &connectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	testPubMsgParams.qos = QOS1;
+	testPubMsgParams.isRetained = 0;
+	testPubMsgParams.payload = (void *) metricsPayload;
+	testPubMsgParams.payloadLen = strlen(metricsPayload);
+	callbackCount = 0;
+
+	ResetTLSBuffer();
+}
+
+TEST_GROUP_C_TEARDOWN(ClientMetricsTests) { }
+
+TEST_C(ClientMetricsTests, NullParams) {
+	IoT_Client_Metrics_t metrics;
+	char text[16];
+	size_t textLen;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - Null params \n");
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_get_client_metrics(NULL, &metrics));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_get_client_metrics(&iotClient, NULL));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_reset_client_metrics(NULL));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_client_metrics_to_text(NULL, NULL, text, sizeof(text), &textLen));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_client_metrics_to_text(&metrics, NULL, NULL, 0, &textLen));
+}
+
+TEST_C(ClientMetricsTests, ConnectIsCounted) {
+	IoT_Client_Metrics_t metrics;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - Connect is counted \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_get_client_metrics(&iotClient, &metrics));
+	CHECK_EQUAL_C_INT(1, metrics.sent.packets[METRICS_TEST_CONNECT]);
+	CHECK_C(0 < metrics.sent.bytes[METRICS_TEST_CONNECT]);
+	CHECK_EQUAL_C_INT(1, metrics.received.packets[METRICS_TEST_CONNACK]);
+	CHECK_EQUAL_C_INT(4, (int) metrics.received.bytes[METRICS_TEST_CONNACK]);
+	CHECK_EQUAL_C_INT(1, metrics.networkConnectDuration.count);
+	CHECK_EQUAL_C_INT(1, histogramBucketTotal(&metrics.networkConnectDuration));
+}
+
+TEST_C(ClientMetricsTests, PublishQoS1RecordsPacketsAndLatency) {
+	IoT_Client_Metrics_t metrics;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - QoS1 publish records packets and latency \n");
+
+	setTLSRxBufferForPuback();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_publish(&iotClient, "sdk/Test", 8, &testPubMsgParams));
+
+	aws_iot_mqtt_get_client_metrics(&iotClient, &metrics);
+	CHECK_EQUAL_C_INT(1, metrics.sent.packets[METRICS_TEST_PUBLISH]);
+	/* fixed header, topic length and name, packet id, payload */
+	CHECK_EQUAL_C_INT(2 + 2 + 8 + 2 + (int) strlen(metricsPayload), (int) metrics.sent.bytes[METRICS_TEST_PUBLISH]);
+	CHECK_EQUAL_C_INT(1, metrics.received.packets[METRICS_TEST_PUBACK]);
+	CHECK_EQUAL_C_INT(1, metrics.publishAckLatency.count);
+	CHECK_EQUAL_C_INT(1, histogramBucketTotal(&metrics.publishAckLatency));
+	CHECK_C(metrics.publishAckLatency.maxUs <= metrics.publishAckLatency.sumUs);
+}
+
+TEST_C(ClientMetricsTests, SubscribeAndCallbackAreRecorded) {
+	IoT_Client_Metrics_t metrics;
+	IoT_Error_t rc;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - Subscribe and callback are recorded \n");
+
+	setTLSRxBufferForSuback("sdk/Test", 8, QOS0, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, "sdk/Test", 8, QOS0, metricsCallback, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	testPubMsgParams.qos = QOS0;
+	setTLSRxBufferWithMsgOnSubscribedTopic("sdk/Test", 8, QOS0, testPubMsgParams, metricsPayload);
+	rc = aws_iot_mqtt_yield(&iotClient, 100);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(1, callbackCount);
+
+	aws_iot_mqtt_get_client_metrics(&iotClient, &metrics);
+	CHECK_EQUAL_C_INT(1, metrics.sent.packets[METRICS_TEST_SUBSCRIBE]);
+	CHECK_EQUAL_C_INT(1, metrics.received.packets[METRICS_TEST_SUBACK]);
+	CHECK_EQUAL_C_INT(1, metrics.subscribeAckLatency.count);
+	CHECK_EQUAL_C_INT(1, metrics.received.packets[METRICS_TEST_PUBLISH]);
+	CHECK_EQUAL_C_INT(1, metrics.callbackDuration.count);
+	CHECK_EQUAL_C_INT(1, metrics.yieldDuration.count);
+}
+
+TEST_C(ClientMetricsTests, ResetClearsMetrics) {
+	IoT_Client_Metrics_t metrics;
+	IoT_Client_Metrics_t zeroMetrics;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - Reset clears metrics \n");
+
+	memset(&zeroMetrics, 0, sizeof(zeroMetrics));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_reset_client_metrics(&iotClient));
+	aws_iot_mqtt_get_client_metrics(&iotClient, &metrics);
+	CHECK_EQUAL_C_INT(0, memcmp(&zeroMetrics, &metrics, sizeof(metrics)));
+}
+
+TEST_C(ClientMetricsTests, TextRendering) {
+	IoT_Client_Metrics_t metrics;
+	char text[4096];
+	size_t textLen;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - Text rendering \n");
+
+	memset(&metrics, 0, sizeof(metrics));
+	metrics.sent.packets[METRICS_TEST_PUBLISH] = 3;
+	metrics.sent.bytes[METRICS_TEST_PUBLISH] = 120;
+	/* 10us lands in the first bucket, 40us in [32, 64) */
+	metrics.publishAckLatency.count = 2;
+	metrics.publishAckLatency.sumUs = 50;
+	metrics.publishAckLatency.maxUs = 40;
+	metrics.publishAckLatency.buckets[0] = 1;
+	metrics.publishAckLatency.buckets[2] = 1;
+	metrics.reconnectAttempts = 2;
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_client_metrics_to_text(&metrics, "dev1", text, sizeof(text), &textLen));
+	CHECK_EQUAL_C_INT((int) strlen(text), (int) textLen);
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_packets_out_total{client=\"dev1\",type=\"PUBLISH\"} 3\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_bytes_out_total{client=\"dev1\",type=\"PUBLISH\"} 120\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_puback_latency_us_bucket{client=\"dev1\",le=\"16\"} 1\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_puback_latency_us_bucket{client=\"dev1\",le=\"32\"} 1\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_puback_latency_us_bucket{client=\"dev1\",le=\"64\"} 2\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_puback_latency_us_bucket{client=\"dev1\",le=\"+Inf\"} 2\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_puback_latency_us_sum{client=\"dev1\"} 50\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_puback_latency_us_count{client=\"dev1\"} 2\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_suback_latency_us_count{client=\"dev1\"} 0\n"));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_reconnect_attempts_total{client=\"dev1\"} 2\n"));
+	/* Packet types never seen are left out */
+	CHECK_C(NULL == strstr(text, "SUBSCRIBE"));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_client_metrics_to_text(&metrics, NULL, text, sizeof(text), &textLen));
+	CHECK_C(NULL != strstr(text, "aws_iot_mqtt_reconnect_attempts_total 2\n"));
+}
+
+TEST_C(ClientMetricsTests, TextRenderingTruncatesAtLineBoundary) {
+	IoT_Client_Metrics_t metrics;
+	char text[100];
+	size_t textLen;
+
+	IOT_DEBUG("\n-->Running Client Metrics Tests - Text rendering truncates at a line boundary \n");
+
+	memset(&metrics, 0, sizeof(metrics));
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, aws_iot_mqtt_client_metrics_to_text(&metrics, "dev1", text, sizeof(text),
+																		  &textLen));
+	CHECK_EQUAL_C_INT((int) strlen(text), (int) textLen);
+	CHECK_C(0 < textLen);
+	CHECK_EQUAL_C_INT('\n', text[textLen - 1]);
+}
@@ -19,6 +19,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "aws_iot_mqtt_client.h"
 #include "aws_iot_tests_unit_mock_tls_params.h"
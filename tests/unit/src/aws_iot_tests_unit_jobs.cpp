@@ -58,3 +58,16 @@ TEST_GROUP_C(JobsInterfaceTest) {
 TEST_GROUP_C_WRAPPER(JobsInterfaceTest, TestSubscribeAndUnsubscribe)
 TEST_GROUP_C_WRAPPER(JobsInterfaceTest, TestSendQuery)
 TEST_GROUP_C_WRAPPER(JobsInterfaceTest, TestSendUpdate)
+
+TEST_GROUP_C(JobsEngineTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(JobsEngineTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(JobsEngineTests)
+};
+
+TEST_GROUP_C_WRAPPER(JobsEngineTests, InitWithNullParams)
+TEST_GROUP_C_WRAPPER(JobsEngineTests, StartSubscribesAndPrefetches)
+TEST_GROUP_C_WRAPPER(JobsEngineTests, RunsJobAndSendsFinalUpdate)
+TEST_GROUP_C_WRAPPER(JobsEngineTests, PrefetchFollowsFinalUpdate)
+TEST_GROUP_C_WRAPPER(JobsEngineTests, DuplicateExecutionsRunOnce)
+TEST_GROUP_C_WRAPPER(JobsEngineTests, ProgressIsCoalescedAndRateLimited)
+TEST_GROUP_C_WRAPPER(JobsEngineTests, OversizedDocumentFailsExecution)
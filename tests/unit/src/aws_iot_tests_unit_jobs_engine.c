@@ -0,0 +1,330 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws_iot_jobs_engine.h>
+
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_config.h"
+#include <CppUTest/TestHarness_c.h>
+#include <aws_iot_log.h>
+
+#define ENGINE_SUBSCRIPTION_COUNT 3
+#define SUBACK_SIZE 5
+
+static AWS_IoT_Client client;
+static IoT_Client_Connect_Params connectParams;
+static IoT_Client_Init_Params mqttInitParams;
+static AwsIotJobsEngine engine;
+
+static const char *THING_NAME = "T1";
+
+static int HANDLER_CONTEXT = 7;
+
+static int handlerCount;
+static char lastJobId[MAX_SIZE_OF_JOB_ID + 1];
+static char lastJobDocument[AWS_IOT_JOBS_ENGINE_DOCUMENT_BYTES];
+static int64_t lastExecutionNumber;
+static bool isReportingProgress;
+
+static JobExecutionStatus testHandler(AwsIotJobsEngine *pEngine, AwsIotJobsEngineJob *pJob, void *pContext) {
+	CHECK_C(pEngine == &engine);
+	CHECK_C(pContext == &HANDLER_CONTEXT);
+
+	handlerCount++;
+	strcpy(lastJobId, pJob->jobId);
+	strcpy(lastJobDocument, pJob->pJobDocument);
+	lastExecutionNumber = pJob->executionNumber;
+	CHECK_EQUAL_C_INT((int) strlen(pJob->pJobDocument), (int) pJob->jobDocumentLength);
+
+	if(isReportingProgress) {
+		/* Only the latest of two reports goes out */
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_report_progress(pEngine, pJob, "{\"step\":\"1\"}"));
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_report_progress(pEngine, pJob, "{\"step\":\"2\"}"));
+		lastPublishMessagePayloadLen = 0;
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(pEngine));
+		CHECK_EQUAL_C_STRING("{\"status\":\"IN_PROGRESS\",\"statusDetails\":{\"step\":\"2\"},\"executionNumber\":3}",
+							 LastPublishMessagePayload);
+
+		/* Within the update interval the next report waits */
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_report_progress(pEngine, pJob, "{\"step\":\"3\"}"));
+		lastPublishMessagePayloadLen = 0;
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(pEngine));
+		CHECK_EQUAL_C_INT(0, (int) lastPublishMessagePayloadLen);
+	}
+
+	return JOB_EXECUTION_SUCCEEDED;
+}
+
+static void setTLSRxBufferForEngineSubacks(void) {
+	size_t i;
+
+	for(i = 0; i < ENGINE_SUBSCRIPTION_COUNT; i++) {
+		RxBuffer.pBuffer[i * SUBACK_SIZE] = (unsigned char) (0x90);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 1] = (unsigned char) (0x2 + 1);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 2] = (unsigned char) (2);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 3] = (unsigned char) (0);
+		RxBuffer.pBuffer[i * SUBACK_SIZE + 4] = (unsigned char) (QOS0);
+	}
+	RxBuffer.NoMsgFlag = false;
+	RxBuffer.len = ENGINE_SUBSCRIPTION_COUNT * SUBACK_SIZE;
+	RxIndex = 0;
+}
+
+static void deliverMessage(AwsIotJobExecutionTopicType topicType, AwsIotJobExecutionTopicReplyType replyType,
+						   const char *pMessage) {
+	char topic[MAX_JOB_TOPIC_LENGTH_BYTES + 1];
+	IoT_Publish_Message_Params params;
+	int topicLength;
+
+	topicLength = aws_iot_jobs_get_api_topic(topic, sizeof(topic), topicType, replyType, THING_NAME, NULL);
+	CHECK_C(topicLength > 0 && topicLength < MAX_JOB_TOPIC_LENGTH_BYTES);
+
+	params.qos = QOS0;
+	params.isRetained = 0;
+	params.isDup = 0;
+	params.id = 0;
+	params.payload = (void *) pMessage;
+	params.payloadLen = strlen(pMessage);
+
+	setTLSRxBufferWithMsgOnSubscribedTopic(topic, (size_t) topicLength, QOS0, params, (char *) pMessage);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_mqtt_yield(&client, 100));
+}
+
+static void checkLastPublish(AwsIotJobExecutionTopicType topicType, const char *pJobId, const char *pPayload) {
+	char expectedTopic[MAX_JOB_TOPIC_LENGTH_BYTES + 1];
+
+	aws_iot_jobs_get_api_topic(expectedTopic, sizeof(expectedTopic), topicType, JOB_REQUEST_TYPE, THING_NAME, pJobId);
+	CHECK_EQUAL_C_STRING(expectedTopic, LastPublishMessageTopic);
+	CHECK_EQUAL_C_STRING(pPayload, LastPublishMessagePayload);
+}
+
+static void clearLastPublish(void) {
+	LastPublishMessageTopic[0] = 0;
+	lastPublishMessageTopicLen = 0;
+	LastPublishMessagePayload[0] = 0;
+	lastPublishMessagePayloadLen = 0;
+}
+
+TEST_GROUP_C_SETUP(JobsEngineTests) {
+	AwsIotJobsEngineParams engineParams = awsIotJobsEngineParamsDefault;
+	IoT_Error_t rc;
+
+	InitMQTTParamsSetup(&mqttInitParams, AWS_IOT_MQTT_HOST, AWS_IOT_MQTT_PORT, false, NULL);
+	rc = aws_iot_mqtt_init(&client, &mqttInitParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ConnectMQTTParamsSetup(&connectParams, (char *) AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	rc = aws_iot_mqtt_connect(&client, &connectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+
+	handlerCount = 0;
+	lastJobId[0] = '\0';
+	lastJobDocument[0] = '\0';
+	lastExecutionNumber = 0;
+	isReportingProgress = false;
+
+	engineParams.pThingName = THING_NAME;
+	engineParams.handler = testHandler;
+	engineParams.pHandlerContext = &HANDLER_CONTEXT;
+	rc = aws_iot_jobs_engine_init(&engine, &client, &engineParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	setTLSRxBufferForEngineSubacks();
+	rc = aws_iot_jobs_engine_start(&engine);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	clearLastPublish();
+}
+
+TEST_GROUP_C_TEARDOWN(JobsEngineTests) {
+	IoT_Error_t rc = aws_iot_jobs_engine_free(&engine);
+	IOT_UNUSED(rc);
+	rc = aws_iot_mqtt_disconnect(&client);
+	IOT_UNUSED(rc);
+}
+
+TEST_C(JobsEngineTests, InitWithNullParams) {
+	AwsIotJobsEngine otherEngine;
+	AwsIotJobsEngineParams engineParams = awsIotJobsEngineParamsDefault;
+
+	IOT_DEBUG("-->Running Jobs Engine Tests - init with null params \n");
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_init(NULL, &client, &engineParams));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_init(&otherEngine, NULL, &engineParams));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_init(&otherEngine, &client, NULL));
+
+	engineParams.pThingName = THING_NAME;
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_init(&otherEngine, &client, &engineParams));
+
+	engineParams.handler = testHandler;
+	engineParams.pThingName = "A-thing-name-longer-than-the-configured-maximum";
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, aws_iot_jobs_engine_init(&otherEngine, &client, &engineParams));
+
+	CHECK_C(false == aws_iot_jobs_engine_run_next(NULL));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_jobs_engine_service(NULL));
+
+	IOT_DEBUG("-->Success - init with null params \n");
+}
+
+TEST_C(JobsEngineTests, StartSubscribesAndPrefetches) {
+	char expectedTopic[MAX_JOB_TOPIC_LENGTH_BYTES + 1];
+
+	IOT_DEBUG("-->Running Jobs Engine Tests - start subscribes and prefetches \n");
+
+	aws_iot_jobs_get_api_topic(expectedTopic, sizeof(expectedTopic), JOB_START_NEXT_TOPIC, JOB_REJECTED_REPLY_TYPE,
+							   THING_NAME, NULL);
+	CHECK_EQUAL_C_STRING(expectedTopic, LastSubscribeMessage);
+	aws_iot_jobs_get_api_topic(expectedTopic, sizeof(expectedTopic), JOB_START_NEXT_TOPIC, JOB_ACCEPTED_REPLY_TYPE,
+							   THING_NAME, NULL);
+	CHECK_EQUAL_C_STRING(expectedTopic, SecondLastSubscribeMessage);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	checkLastPublish(JOB_START_NEXT_TOPIC, NULL, "{}");
+
+	/* One request at a time */
+	clearLastPublish();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	CHECK_EQUAL_C_INT(0, (int) lastPublishMessageTopicLen);
+
+	/* Nothing pending, wait for notify-next */
+	deliverMessage(JOB_START_NEXT_TOPIC, JOB_ACCEPTED_REPLY_TYPE, "{\"timestamp\":1}");
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	CHECK_EQUAL_C_INT(0, (int) lastPublishMessageTopicLen);
+	CHECK_C(false == aws_iot_jobs_engine_run_next(&engine));
+
+	IOT_DEBUG("-->Success - start subscribes and prefetches \n");
+}
+
+TEST_C(JobsEngineTests, RunsJobAndSendsFinalUpdate) {
+	IOT_DEBUG("-->Running Jobs Engine Tests - runs job and sends final update \n");
+
+	/* start-next stays in flight, so the final update is the last publish */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	deliverMessage(JOB_NOTIFY_NEXT_TOPIC, JOB_REQUEST_TYPE,
+				   "{\"execution\":{\"jobId\":\"J1\",\"status\":\"QUEUED\",\"versionNumber\":1,\"executionNumber\":2,"
+				   "\"jobDocument\":{\"operation\":\"reboot\"}},\"timestamp\":5}");
+	CHECK_EQUAL_C_INT(0, handlerCount);
+
+	CHECK_C(aws_iot_jobs_engine_run_next(&engine));
+	CHECK_EQUAL_C_INT(1, handlerCount);
+	CHECK_EQUAL_C_STRING("J1", lastJobId);
+	CHECK_EQUAL_C_STRING("{\"operation\":\"reboot\"}", lastJobDocument);
+	CHECK_C(2 == lastExecutionNumber);
+	CHECK_C(false == aws_iot_jobs_engine_run_next(&engine));
+
+	clearLastPublish();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	checkLastPublish(JOB_UPDATE_TOPIC, "J1", "{\"status\":\"SUCCEEDED\",\"executionNumber\":2}");
+
+	IOT_DEBUG("-->Success - runs job and sends final update \n");
+}
+
+TEST_C(JobsEngineTests, PrefetchFollowsFinalUpdate) {
+	IOT_DEBUG("-->Running Jobs Engine Tests - prefetch follows final update \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	deliverMessage(JOB_START_NEXT_TOPIC, JOB_ACCEPTED_REPLY_TYPE,
+				   "{\"execution\":{\"jobId\":\"J1\",\"status\":\"IN_PROGRESS\",\"executionNumber\":1,"
+				   "\"jobDocument\":{}},\"timestamp\":5}");
+	CHECK_C(aws_iot_jobs_engine_run_next(&engine));
+
+	/* The final update goes out first, then start-next asks for the next execution */
+	clearLastPublish();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	checkLastPublish(JOB_START_NEXT_TOPIC, NULL, "{}");
+
+	/* The next execution is queued as soon as the reply arrives */
+	deliverMessage(JOB_START_NEXT_TOPIC, JOB_ACCEPTED_REPLY_TYPE,
+				   "{\"execution\":{\"jobId\":\"J2\",\"status\":\"IN_PROGRESS\",\"executionNumber\":1,"
+				   "\"jobDocument\":{\"n\":2}},\"timestamp\":6}");
+	CHECK_C(aws_iot_jobs_engine_run_next(&engine));
+	CHECK_EQUAL_C_STRING("J2", lastJobId);
+	CHECK_EQUAL_C_INT(2, handlerCount);
+
+	IOT_DEBUG("-->Success - prefetch follows final update \n");
+}
+
+TEST_C(JobsEngineTests, DuplicateExecutionsRunOnce) {
+	const char *pMessage = "{\"execution\":{\"jobId\":\"J1\",\"status\":\"IN_PROGRESS\",\"executionNumber\":4,"
+						   "\"jobDocument\":{}},\"timestamp\":5}";
+
+	IOT_DEBUG("-->Running Jobs Engine Tests - duplicate executions run once \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	deliverMessage(JOB_NOTIFY_NEXT_TOPIC, JOB_REQUEST_TYPE, pMessage);
+	deliverMessage(JOB_START_NEXT_TOPIC, JOB_ACCEPTED_REPLY_TYPE, pMessage);
+	CHECK_C(aws_iot_jobs_engine_run_next(&engine));
+	CHECK_C(false == aws_iot_jobs_engine_run_next(&engine));
+
+	/* A reply racing with the final update does not run the execution again */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	deliverMessage(JOB_START_NEXT_TOPIC, JOB_ACCEPTED_REPLY_TYPE, pMessage);
+	CHECK_C(false == aws_iot_jobs_engine_run_next(&engine));
+	CHECK_EQUAL_C_INT(1, handlerCount);
+
+	/* and start-next is asked again */
+	clearLastPublish();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	checkLastPublish(JOB_START_NEXT_TOPIC, NULL, "{}");
+
+	IOT_DEBUG("-->Success - duplicate executions run once \n");
+}
+
+TEST_C(JobsEngineTests, ProgressIsCoalescedAndRateLimited) {
+	IOT_DEBUG("-->Running Jobs Engine Tests - progress is coalesced and rate limited \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	deliverMessage(JOB_NOTIFY_NEXT_TOPIC, JOB_REQUEST_TYPE,
+				   "{\"execution\":{\"jobId\":\"J1\",\"status\":\"QUEUED\",\"executionNumber\":3,"
+				   "\"jobDocument\":{}},\"timestamp\":5}");
+
+	isReportingProgress = true;
+	CHECK_C(aws_iot_jobs_engine_run_next(&engine));
+
+	/* The final update carries the latest details and is not held back by the interval */
+	clearLastPublish();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	checkLastPublish(JOB_UPDATE_TOPIC, "J1",
+					 "{\"status\":\"SUCCEEDED\",\"statusDetails\":{\"step\":\"3\"},\"executionNumber\":3}");
+
+	IOT_DEBUG("-->Success - progress is coalesced and rate limited \n");
+}
+
+TEST_C(JobsEngineTests, OversizedDocumentFailsExecution) {
+	char message[AWS_IOT_JOBS_ENGINE_DOCUMENT_BYTES + 128];
+	char document[AWS_IOT_JOBS_ENGINE_DOCUMENT_BYTES + 1];
+
+	IOT_DEBUG("-->Running Jobs Engine Tests - oversized document fails execution \n");
+
+	memset(document, 'x', sizeof(document) - 1);
+	document[sizeof(document) - 1] = '\0';
+	snprintf(message, sizeof(message), "{\"execution\":{\"jobId\":\"J1\",\"jobDocument\":{\"blob\":\"%s\"}}}", document);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	deliverMessage(JOB_NOTIFY_NEXT_TOPIC, JOB_REQUEST_TYPE, message);
+	CHECK_C(false == aws_iot_jobs_engine_run_next(&engine));
+
+	clearLastPublish();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_jobs_engine_service(&engine));
+	checkLastPublish(JOB_UPDATE_TOPIC, "J1",
+					 "{\"status\":\"FAILED\",\"statusDetails\":{\"reason\":\"job document too large\"}}");
+	CHECK_EQUAL_C_INT(0, handlerCount);
+
+	IOT_DEBUG("-->Success - oversized document fails execution \n");
+}
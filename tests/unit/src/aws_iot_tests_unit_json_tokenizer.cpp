@@ -0,0 +1,34 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_json_tokenizer.cpp
+ * @brief IoT Client Unit Testing - JSON Tokenizer Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(JsonTokenizer) {
+	TEST_GROUP_C_SETUP_WRAPPER(JsonTokenizer)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(JsonTokenizer)
+};
+
+TEST_GROUP_C_WRAPPER(JsonTokenizer, MatchesJsmnOnDocuments)
+TEST_GROUP_C_WRAPPER(JsonTokenizer, MatchesJsmnOnEveryPrefix)
+TEST_GROUP_C_WRAPPER(JsonTokenizer, MatchesJsmnWhenTokensRunOut)
+TEST_GROUP_C_WRAPPER(JsonTokenizer, MatchesJsmnOnMalformedInput)
+TEST_GROUP_C_WRAPPER(JsonTokenizer, MatchesJsmnOnMutatedDocuments)
+TEST_GROUP_C_WRAPPER(JsonTokenizer, ResumesAfterPartialInput)
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_json_tokenizer_helper.c
+ * @brief IoT Client Unit Testing - JSON Tokenizer Tests helper
+ *
+ * Differential tests, every input is tokenized by jsmn_parse and aws_iot_json_tokenize and the
+ * return codes, parser states and tokens must be identical.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_json_tokenizer.h"
+#include "aws_iot_log.h"
+
+#define TOKENIZER_TEST_MAX_TOKENS 128
+#define TOKENIZER_TEST_BUFFER_SIZE 1024
+#define TOKENIZER_TEST_MUTATIONS 4000
+
+static jsmntok_t jsmnTokens[TOKENIZER_TEST_MAX_TOKENS];
+static jsmntok_t tokenizerTokens[TOKENIZER_TEST_MAX_TOKENS];
+static jsmn_parser jsmnParser;
+static jsmn_parser tokenizerParser;
+
+/* Strings longer than a block, escapes on block boundaries, indentation runs and non-ASCII bytes */
+static const char *documents[] = {
+		"{}",
+		"[]",
+		"{\"a\":1}",
+		"{\"state\":{\"reported\":{\"temperature\":23.5,\"humidity\":61,\"on\":true,\"mode\":null}},"
+		"\"clientToken\":\"C-SDK_UnitTestClient-0\",\"version\":17,\"timestamp\":1507318483}",
+		"{\"state\":{\"desired\":{\"color\":\"RED\",\"sequence\":[\"RED\",\"GREEN\",\"BLUE\"]}},"
+		"\"metadata\":{\"desired\":{\"color\":{\"timestamp\":12345},\"sequence\":[{\"timestamp\":12345},"
+		"{\"timestamp\":12345},{\"timestamp\":12345}]}},\"version\":10}",
+		"{\n    \"state\": {\n        \"reported\": {\n            \"firmware\": \"1.2.3-rc4+build.5678\",\n"
+		"\t\t\t\"ports\": [ 80 , 443 ,\r\n 8883 ]\n        }\n    }\n}\n",
+		"{\"escaped\":\"a quote \\\" a backslash \\\\ a slash \\/ and \\b\\f\\n\\r\\t in a long string\"}",
+		"{\"k\":\"0123456789abcd\\\"0123456789abcdef\\\\\",\"u\":\"\\u00e9\\uD83D\\uDE00 and \\u0041BC\"}",
+		"{\"boundary\":\"0123456789\\\\\",\"next\":\"0123456789a\\\"\"}",
+		"{\"utf8\":\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\",\"number\":-1.25e+10,\"big\":123456789012345678901234567890}",
+		"{\"a\":[[[[[[1]]]]]],\"b\":{\"c\":{\"d\":{\"e\":{}}}},\"f\":[{},[],\"\",0]}",
+		"{\"jobs\":{\"queuedJobs\":[{\"jobId\":\"job-0001\",\"queuedAt\":1507318483,\"lastUpdatedAt\":1507318483,"
+		"\"executionNumber\":1,\"versionNumber\":1}],\"inProgressJobs\":[]},\"timestamp\":1507318484}",
+		"\"top level string\"",
+		"12345678901234567890",
+		"true false null",
+		"{unquoted: key, other : [alpha, beta]}",
+		"{\"a\":1,}",
+		"{\"a\":\"b\":\"c\"}",
+		"{\"a\" 1 2 3}",
+		"{,,::}",
+		"    \t\t\t\t\n\n\n\n                                 {\"x\":                       \"y\"}                   ",
+};
+
+/* Inputs jsmn rejects or only partially accepts */
+static const char *malformedDocuments[] = {
+		"{\"a\":\"\\x\"}",
+		"{\"a\":\"\\u12G4\"}",
+		"{\"a\":\"\\u12\"}",
+		"{\"a\":\"0123456789abcdef\\q\"}",
+		"{\"a\":tr\x01ue}",
+		"{\"a\":tr\x7f" "ue}",
+		"{\"a\":caf\xc3\xa9}",
+		"{\"a\":1]}",
+		"}",
+		"]",
+		"{\"a\":[1,2}",
+		"[1,2,3]]",
+		"{\"a\":\"abc\\",
+		"{\"a\":\"abc",
+		"{\"a\":[1,2",
+		"[\"a\",\"b\"}",
+		"{\"0123456789abcdefghij\":01234567890123456789\x02}",
+};
+
+/* Inputs with a NUL byte, jsmn stops there */
+static const char nulInString[] = "{\"a\":\"b\0c\"}";
+static const char nulAfterBackslash[] = "{\"a\":\"b\\\0c\"}";
+static const char nulInPrimitive[] = "{\"a\":12\0" "3}";
+static const char nulAtTopLevel[] = "{\"a\":1}\0{\"b\":2}";
+
+static void checkSameParse(void) {
+	unsigned int i;
+
+	CHECK_EQUAL_C_INT(jsmnParser.pos, tokenizerParser.pos);
+	CHECK_EQUAL_C_INT(jsmnParser.toknext, tokenizerParser.toknext);
+	CHECK_EQUAL_C_INT(jsmnParser.toksuper, tokenizerParser.toksuper);
+
+	for(i = 0; i < jsmnParser.toknext; i++) {
+		CHECK_EQUAL_C_INT(jsmnTokens[i].type, tokenizerTokens[i].type);
+		CHECK_EQUAL_C_INT(jsmnTokens[i].start, tokenizerTokens[i].start);
+		CHECK_EQUAL_C_INT(jsmnTokens[i].end, tokenizerTokens[i].end);
+		CHECK_EQUAL_C_INT(jsmnTokens[i].size, tokenizerTokens[i].size);
+	}
+}
+
+static int checkSameAsJsmn(const char *pJson, size_t length, unsigned int maxTokens) {
+	int expected, actual;
+
+	memset(jsmnTokens, 0, sizeof(jsmnTokens));
+	memset(tokenizerTokens, 0, sizeof(tokenizerTokens));
+	jsmn_init(&jsmnParser);
+	jsmn_init(&tokenizerParser);
+
+	expected = jsmn_parse(&jsmnParser, pJson, length, jsmnTokens, maxTokens);
+	actual = aws_iot_json_tokenize(&tokenizerParser, pJson, length, tokenizerTokens, maxTokens);
+
+	CHECK_EQUAL_C_INT(expected, actual);
+	checkSameParse();
+
+	return expected;
+}
+
+TEST_GROUP_C_SETUP(JsonTokenizer) {
+}
+
+TEST_GROUP_C_TEARDOWN(JsonTokenizer) {
+}
+
+TEST_C(JsonTokenizer, MatchesJsmnOnDocuments) {
+	size_t i;
+
+	IOT_DEBUG("\n-->Running Json Tokenizer Tests - Matches jsmn on documents \n");
+
+	for(i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+		CHECK_C(0 < checkSameAsJsmn(documents[i], strlen(documents[i]), TOKENIZER_TEST_MAX_TOKENS));
+	}
+}
+
+TEST_C(JsonTokenizer, MatchesJsmnOnEveryPrefix) {
+	size_t i, length;
+
+	IOT_DEBUG("\n-->Running Json Tokenizer Tests - Matches jsmn on every prefix \n");
+
+	for(i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+		for(length = 0; length <= strlen(documents[i]); length++) {
+			checkSameAsJsmn(documents[i], length, TOKENIZER_TEST_MAX_TOKENS);
+		}
+	}
+}
+
+TEST_C(JsonTokenizer, MatchesJsmnWhenTokensRunOut) {
+	size_t i;
+	unsigned int maxTokens;
+	int tokenCount;
+
+	IOT_DEBUG("\n-->Running Json Tokenizer Tests - Matches jsmn when tokens run out \n");
+
+	for(i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+		tokenCount = checkSameAsJsmn(documents[i], strlen(documents[i]), TOKENIZER_TEST_MAX_TOKENS);
+		for(maxTokens = 0; maxTokens < (unsigned int) tokenCount; maxTokens++) {
+			CHECK_EQUAL_C_INT(JSMN_ERROR_NOMEM, checkSameAsJsmn(documents[i], strlen(documents[i]), maxTokens));
+		}
+	}
+}
+
+TEST_C(JsonTokenizer, MatchesJsmnOnMalformedInput) {
+	size_t i;
+
+	IOT_DEBUG("\n-->Running Json Tokenizer Tests - Matches jsmn on malformed input \n");
+
+	for(i = 0; i < sizeof(malformedDocuments) / sizeof(malformedDocuments[0]); i++) {
+		CHECK_C(0 > checkSameAsJsmn(malformedDocuments[i], strlen(malformedDocuments[i]), TOKENIZER_TEST_MAX_TOKENS));
+	}
+
+	checkSameAsJsmn(nulInString, sizeof(nulInString) - 1, TOKENIZER_TEST_MAX_TOKENS);
+	checkSameAsJsmn(nulAfterBackslash, sizeof(nulAfterBackslash) - 1, TOKENIZER_TEST_MAX_TOKENS);
+	checkSameAsJsmn(nulInPrimitive, sizeof(nulInPrimitive) - 1, TOKENIZER_TEST_MAX_TOKENS);
+	CHECK_EQUAL_C_INT(3, checkSameAsJsmn(nulAtTopLevel, sizeof(nulAtTopLevel) - 1, TOKENIZER_TEST_MAX_TOKENS));
+}
+
+TEST_C(JsonTokenizer, MatchesJsmnOnMutatedDocuments) {
+	/* Bytes that change the structure, plus NUL, control and non-ASCII bytes */
+	static const char alphabet[] = "{}[]\":,\\ \tu0aZ\x01\x7f\x80-";
+	char buffer[TOKENIZER_TEST_BUFFER_SIZE];
+	uint32_t seed = 12345;
+	size_t i, length, mutation;
+	uint32_t changes;
+
+	IOT_DEBUG("\n-->Running Json Tokenizer Tests - Matches jsmn on mutated documents \n");
+
+	for(mutation = 0; mutation < TOKENIZER_TEST_MUTATIONS; mutation++) {
+		i = mutation % (sizeof(documents) / sizeof(documents[0]));
+		length = strlen(documents[i]);
+		memcpy(buffer, documents[i], length);
+		for(changes = 1 + mutation % 3; changes > 0; changes--) {
+			seed = seed * 1103515245u + 12345u;
+			buffer[(seed >> 8) % length] = alphabet[(seed >> 20) % sizeof(alphabet)];
+		}
+		checkSameAsJsmn(buffer, length, TOKENIZER_TEST_MAX_TOKENS);
+	}
+}
+
+TEST_C(JsonTokenizer, ResumesAfterPartialInput) {
+	const char *pJson = documents[4];
+	size_t split;
+	int expected, actual;
+
+	IOT_DEBUG("\n-->Running Json Tokenizer Tests - Resumes after partial input \n");
+
+	for(split = 1; split < strlen(pJson); split += 7) {
+		CHECK_EQUAL_C_INT(JSMN_ERROR_PART, checkSameAsJsmn(pJson, split, TOKENIZER_TEST_MAX_TOKENS));
+
+		expected = jsmn_parse(&jsmnParser, pJson, strlen(pJson), jsmnTokens, TOKENIZER_TEST_MAX_TOKENS);
+		actual = aws_iot_json_tokenize(&tokenizerParser, pJson, strlen(pJson), tokenizerTokens,
+									   TOKENIZER_TEST_MAX_TOKENS);
+		CHECK_C(0 < expected);
+		CHECK_EQUAL_C_INT(expected, actual);
+		checkSameParse();
+	}
+}
@@ -89,3 +89,16 @@ TEST_GROUP_C_WRAPPER(JsonUtils, ParseUnsignedInteger8bitLargeInteger)
 TEST_GROUP_C_WRAPPER(JsonUtils, ParseUnsignedInteger8bitErrorOnNegativeInteger)
 TEST_GROUP_C_WRAPPER(JsonUtils, ParseUnsignedInteger8bitErrorOnBoolean)
 TEST_GROUP_C_WRAPPER(JsonUtils, ParseUnsignedInteger8bitErrorOnString)
+
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseIntegerErrorOnOverflow)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseIntegerLimits)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseIntegerErrorOnFraction)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseUnsignedIntegerErrorOnOverflow)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseIntegerCustomBounds)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseNumberStopsAtTokenEnd)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseDoubleExponent)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseDoubleMatchesStrtod)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseFloatMatchesStrtof)
+TEST_GROUP_C_WRAPPER(JsonUtils, ParseDoubleErrorOnMalformedNumber)
+TEST_GROUP_C_WRAPPER(JsonUtils, JsonTapeLinks)
+TEST_GROUP_C_WRAPPER(JsonUtils, FindTokenOnTape)
@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <CppUTest/TestHarness_c.h>
 
@@ -832,3 +833,282 @@ TEST_C(JsonUtils, ParseUnsignedInteger8bitErrorOnString) {
 	CHECK_EQUAL_C_INT(3, r);
 	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, rc);
 }
+
+TEST_C(JsonUtils, ParseIntegerErrorOnOverflow) {
+	int r;
+	const char *json = "{\"a\":2147483648,\"b\":-2147483649,\"c\":32768,\"d\":-129,\"e\":99999999999999999999999}";
+	int32_t parsedInteger32 = 5;
+	int16_t parsedInteger16;
+	int8_t parsedInteger8;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse integer returns error on overflow \n");
+
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_EQUAL_C_INT(11, r);
+
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger32Value(&parsedInteger32, json, t + 2));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger32Value(&parsedInteger32, json, t + 4));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger16Value(&parsedInteger16, json, t + 6));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger8Value(&parsedInteger8, json, t + 8));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger32Value(&parsedInteger32, json, t + 10));
+	/* The destination is left untouched on error */
+	CHECK_EQUAL_C_INT(5, parsedInteger32);
+}
+
+TEST_C(JsonUtils, ParseIntegerLimits) {
+	int r;
+	const char *json = "{\"a\":-2147483648,\"b\":-32768,\"c\":-128,\"d\":-0}";
+	int32_t parsedInteger32;
+	int16_t parsedInteger16;
+	int8_t parsedInteger8;
+	int64_t parsedInteger64;
+	const char *pMin64 = "-9223372036854775808";
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse integer limits \n");
+
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_EQUAL_C_INT(9, r);
+
+	CHECK_EQUAL_C_INT(SUCCESS, parseInteger32Value(&parsedInteger32, json, t + 2));
+	CHECK_C(INT32_MIN == parsedInteger32);
+	CHECK_EQUAL_C_INT(SUCCESS, parseInteger16Value(&parsedInteger16, json, t + 4));
+	CHECK_EQUAL_C_INT(INT16_MIN, parsedInteger16);
+	CHECK_EQUAL_C_INT(SUCCESS, parseInteger8Value(&parsedInteger8, json, t + 6));
+	CHECK_EQUAL_C_INT(INT8_MIN, parsedInteger8);
+	CHECK_EQUAL_C_INT(SUCCESS, parseInteger32Value(&parsedInteger32, json, t + 8));
+	CHECK_EQUAL_C_INT(0, parsedInteger32);
+
+	CHECK_EQUAL_C_INT(SUCCESS, parseSignedIntegerFromChars(pMin64, pMin64 + strlen(pMin64), INT64_MIN, INT64_MAX,
+														   &parsedInteger64));
+	CHECK_C(INT64_MIN == parsedInteger64);
+}
+
+TEST_C(JsonUtils, ParseIntegerErrorOnFraction) {
+	int r;
+	const char *json = "{\"a\":1.5,\"b\":1e3,\"c\":0x10}";
+	int32_t parsedInteger;
+	uint32_t parsedUnsignedInteger;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse integer returns error on fraction, exponent and hex \n");
+
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_EQUAL_C_INT(7, r);
+
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger32Value(&parsedInteger, json, t + 2));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseUnsignedInteger32Value(&parsedUnsignedInteger, json, t + 4));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseInteger32Value(&parsedInteger, json, t + 6));
+}
+
+TEST_C(JsonUtils, ParseUnsignedIntegerErrorOnOverflow) {
+	int r;
+	const char *json = "{\"a\":4294967295,\"b\":4294967296,\"c\":65536,\"d\":256}";
+	uint32_t parsedInteger32;
+	uint16_t parsedInteger16;
+	uint8_t parsedInteger8;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse unsigned integer returns error on overflow \n");
+
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_EQUAL_C_INT(9, r);
+
+	CHECK_EQUAL_C_INT(SUCCESS, parseUnsignedInteger32Value(&parsedInteger32, json, t + 2));
+	CHECK_C(UINT32_MAX == parsedInteger32);
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseUnsignedInteger32Value(&parsedInteger32, json, t + 4));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseUnsignedInteger16Value(&parsedInteger16, json, t + 6));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseUnsignedInteger8Value(&parsedInteger8, json, t + 8));
+}
+
+TEST_C(JsonUtils, ParseIntegerCustomBounds) {
+	const char *pSeven = "7";
+	const char *pFive = "5";
+	const char *pMinusFive = "-5";
+	const char *pMinusZero = "-0";
+	const char *pMinusThree = "-3";
+	uint64_t parsedUnsigned = 0;
+	int64_t parsedSigned = 0;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse integer with bounds below the type limits \n");
+
+	/* A single digit above a small maximum */
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseUnsignedIntegerFromChars(pSeven, pSeven + 1, 5, &parsedUnsigned));
+	CHECK_EQUAL_C_INT(0, (int) parsedUnsigned);
+	CHECK_EQUAL_C_INT(SUCCESS, parseUnsignedIntegerFromChars(pFive, pFive + 1, 5, &parsedUnsigned));
+	CHECK_EQUAL_C_INT(5, (int) parsedUnsigned);
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pSeven, pSeven + 1, -5, 5, &parsedSigned));
+
+	/* Negative numbers against a minimum that is not negative */
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pMinusFive, pMinusFive + 2, 0, 10,
+																	&parsedSigned));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pMinusZero, pMinusZero + 2, 0, 10,
+																	&parsedSigned));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pMinusFive, pMinusFive + 2, 1, 10,
+																	&parsedSigned));
+	CHECK_EQUAL_C_INT(0, (int) parsedSigned);
+
+	/* A small negative minimum */
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pMinusFive, pMinusFive + 2, -3, 3,
+																	&parsedSigned));
+	CHECK_EQUAL_C_INT(SUCCESS, parseSignedIntegerFromChars(pMinusThree, pMinusThree + 2, -3, 3, &parsedSigned));
+	CHECK_EQUAL_C_INT(-3, (int) parsedSigned);
+
+	/* A positive number against a negative maximum */
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pFive, pFive + 1, -10, -1, &parsedSigned));
+}
+
+TEST_C(JsonUtils, ParseNumberStopsAtTokenEnd) {
+	const char *pNumbers = "12345";
+	const char *pDouble = "2.5e1";
+	int64_t parsedInteger;
+	double parsedDouble;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse number stops at the end of the range \n");
+
+	/* The characters following the range must not be read */
+	CHECK_EQUAL_C_INT(SUCCESS, parseSignedIntegerFromChars(pNumbers, pNumbers + 2, INT64_MIN, INT64_MAX,
+														   &parsedInteger));
+	CHECK_EQUAL_C_INT(12, (int) parsedInteger);
+	CHECK_EQUAL_C_INT(SUCCESS, parseDoubleFromChars(pDouble, pDouble + 3, &parsedDouble));
+	CHECK_EQUAL_C_REAL(2.5, parsedDouble, 0.0);
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseDoubleFromChars(pDouble, pDouble + 4, &parsedDouble));
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseSignedIntegerFromChars(pNumbers, pNumbers, INT64_MIN, INT64_MAX,
+																	&parsedInteger));
+}
+
+TEST_C(JsonUtils, ParseDoubleExponent) {
+	int r;
+	const char *json = "{\"a\":1.5e3,\"b\":-2E-2,\"c\":1e+400,\"d\":1e-400}";
+	double parsedDouble;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse double with exponent \n");
+
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_EQUAL_C_INT(9, r);
+
+	CHECK_EQUAL_C_INT(SUCCESS, parseDoubleValue(&parsedDouble, json, t + 2));
+	CHECK_EQUAL_C_REAL(1500.0, parsedDouble, 0.0);
+	CHECK_EQUAL_C_INT(SUCCESS, parseDoubleValue(&parsedDouble, json, t + 4));
+	CHECK_EQUAL_C_REAL(-0.02, parsedDouble, 0.0);
+	CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseDoubleValue(&parsedDouble, json, t + 6));
+	CHECK_EQUAL_C_INT(SUCCESS, parseDoubleValue(&parsedDouble, json, t + 8));
+	CHECK_EQUAL_C_REAL(0.0, parsedDouble, 0.0);
+}
+
+static const char *const numberSamples[] = {
+		"0", "-0.0", "1", "20.5", "0.1", "0.000004", "3.4028235e38", "1.7976931348623157e308", "2.2250738585072014e-308",
+		"123456789012345678", "9007199254740993", "0.30000000000000004", "-98.765432", "1e22", "1e23", "4.9e-324",
+		"12345.6789e-3", "123456789.123456789123456789", "7.0e-10", "-273.15"
+};
+
+TEST_C(JsonUtils, ParseDoubleMatchesStrtod) {
+	const char *pSample;
+	double parsedDouble;
+	size_t i;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse double matches strtod \n");
+
+	for(i = 0; i < sizeof(numberSamples) / sizeof(numberSamples[0]); i++) {
+		pSample = numberSamples[i];
+		CHECK_EQUAL_C_INT(SUCCESS, parseDoubleFromChars(pSample, pSample + strlen(pSample), &parsedDouble));
+		CHECK_C(strtod(pSample, NULL) == parsedDouble);
+	}
+}
+
+TEST_C(JsonUtils, ParseFloatMatchesStrtof) {
+	const char *pSample;
+	char generated[32];
+	uint64_t seed = 1;
+	float parsedFloat;
+	size_t i;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse float matches strtof \n");
+
+	for(i = 0; i < sizeof(numberSamples) / sizeof(numberSamples[0]); i++) {
+		pSample = numberSamples[i];
+		if(0 == strcmp("1.7976931348623157e308", pSample)) {
+			/* Does not fit a float */
+			CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseFloatFromChars(pSample, pSample + strlen(pSample), &parsedFloat));
+			continue;
+		}
+		CHECK_EQUAL_C_INT(SUCCESS, parseFloatFromChars(pSample, pSample + strlen(pSample), &parsedFloat));
+		CHECK_C(strtof(pSample, NULL) == parsedFloat);
+	}
+
+	/* Pseudo random telemetry-like values, fixed seed so failures are reproducible */
+	for(i = 0; i < 20000; i++) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		snprintf(generated, sizeof(generated), "%s%u.%0*u", (seed >> 63) ? "-" : "", (unsigned int) ((seed >> 40) % 100000),
+				 (int) ((seed >> 20) % 9) + 1, (unsigned int) ((seed >> 8) % 1000000000));
+		CHECK_EQUAL_C_INT(SUCCESS, parseFloatFromChars(generated, generated + strlen(generated), &parsedFloat));
+		CHECK_C(strtof(generated, NULL) == parsedFloat);
+	}
+}
+
+TEST_C(JsonUtils, ParseDoubleErrorOnMalformedNumber) {
+	static const char *const malformed[] = { "", "-", "+1", ".5", "1.", "1e", "1e+", "--1", "1.2.3", "nan", "inf", "1 " };
+	double parsedDouble;
+	size_t i;
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Parse double returns error on malformed numbers \n");
+
+	for(i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+		CHECK_EQUAL_C_INT(JSON_PARSE_ERROR, parseDoubleFromChars(malformed[i], malformed[i] + strlen(malformed[i]),
+																 &parsedDouble));
+	}
+}
+
+TEST_C(JsonUtils, JsonTapeLinks) {
+	int r;
+	jsonTapeEntry_t tape[128];
+	const char *json = "{\"a\":[1,{\"b\":2},3],\"c\":{\"d\":{}},\"e\":\"f\"}";
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Json tape parent and next links \n");
+
+	jsmn_init(&test_parser);
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_EQUAL_C_INT(14, r);
+	buildJsonTape(t, r, tape);
+
+	/* 0 {  1 "a"  2 [  3 1  4 {  5 "b"  6 2  7 3  8 "c"  9 {  10 "d"  11 {}  12 "e"  13 "f" */
+	CHECK_EQUAL_C_INT(-1, tape[0].parent);
+	CHECK_EQUAL_C_INT(r, tape[0].next);
+	CHECK_EQUAL_C_INT(0, tape[1].parent);
+	CHECK_EQUAL_C_INT(2, tape[1].next);
+	CHECK_EQUAL_C_INT(0, tape[2].parent);
+	CHECK_EQUAL_C_INT(8, tape[2].next);
+	CHECK_EQUAL_C_INT(2, tape[4].parent);
+	CHECK_EQUAL_C_INT(7, tape[4].next);
+	CHECK_EQUAL_C_INT(4, tape[6].parent);
+	CHECK_EQUAL_C_INT(9, tape[11].parent);
+	CHECK_EQUAL_C_INT(12, tape[11].next);
+	CHECK_EQUAL_C_INT(0, tape[13].parent);
+	CHECK_EQUAL_C_INT(r, tape[13].next);
+}
+
+TEST_C(JsonUtils, FindTokenOnTape) {
+	int r;
+	jsonTapeEntry_t tape[128];
+	jsmntok_t *pToken;
+	const char *json = "{\"list\":[{\"id\":1},{\"id\":2},{\"id\":3}],\"nested\":{\"id\":4},\"id\":5}";
+
+	IOT_DEBUG("\n-->Running Json Utils Tests - Find token on tape \n");
+
+	jsmn_init(&test_parser);
+	r = jsmn_parse(&test_parser, json, strlen(json), t, sizeof(t) / sizeof(t[0]));
+	CHECK_C(r > 0);
+	buildJsonTape(t, r, tape);
+
+	/* The id members nested in the array and the object are skipped */
+	pToken = findTokenOnTape("id", json, t, tape, t);
+	CHECK_C(NULL != pToken);
+	CHECK_EQUAL_C_INT(0, strncmp("5", json + pToken->start, (size_t) (pToken->end - pToken->start)));
+	CHECK_C(pToken == findToken("id", json, t));
+
+	pToken = findTokenOnTape("nested", json, t, tape, t);
+	CHECK_C(NULL != pToken);
+	pToken = findTokenOnTape("id", json, t, tape, pToken);
+	CHECK_C(NULL != pToken);
+	CHECK_EQUAL_C_INT(0, strncmp("4", json + pToken->start, (size_t) (pToken->end - pToken->start)));
+
+	CHECK_C(NULL == findTokenOnTape("missing", json, t, tape, t));
+	CHECK_C(NULL == findTokenOnTape("id", json, t, tape, &t[2]));
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_json_writer.cpp
+ * @brief IoT Client Unit Testing - JSON Writer Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(JsonWriterTests) {
+  TEST_GROUP_C_SETUP_WRAPPER(JsonWriterTests)
+  TEST_GROUP_C_TEARDOWN_WRAPPER(JsonWriterTests)
+};
+
+TEST_GROUP_C_WRAPPER(JsonWriterTests, WritesStructure)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, EscapesStrings)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, TruncatesLikeSnprintf)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, MeasuresWithoutBuffer)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, FormatsIntegers)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, FormatsShortestDoubles)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, FormatsShortestFloats)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, DoublesRoundTrip)
+TEST_GROUP_C_WRAPPER(JsonWriterTests, ShadowDocumentWithManyFields)
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_json_writer_helper.c
+ * @brief IoT Client Unit Testing - JSON Writer Tests helper
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_json_writer.h"
+#include "aws_iot_json_utils.h"
+#include "aws_iot_jobs_json.h"
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_log.h"
+
+#define WRITER_TEST_FIELDS 100
+
+static char writerBuffer[4096];
+static IoT_Json_Writer_t writer;
+
+static void checkDouble(const char *pExpected, double value) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+	size_t length = aws_iot_json_format_double(value, buf);
+
+	CHECK_EQUAL_C_STRING(pExpected, buf);
+	CHECK_EQUAL_C_INT((int) strlen(pExpected), (int) length);
+}
+
+static void checkFloat(const char *pExpected, float value) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+	size_t length = aws_iot_json_format_float(value, buf);
+
+	CHECK_EQUAL_C_STRING(pExpected, buf);
+	CHECK_EQUAL_C_INT((int) strlen(pExpected), (int) length);
+}
+
+TEST_GROUP_C_SETUP(JsonWriterTests) {
+	memset(writerBuffer, 'x', sizeof(writerBuffer));
+	aws_iot_json_writer_init(&writer, writerBuffer, sizeof(writerBuffer), 0);
+}
+
+TEST_GROUP_C_TEARDOWN(JsonWriterTests) { }
+
+TEST_C(JsonWriterTests, WritesStructure) {
+	IOT_DEBUG("\n-->Running Json Writer Tests - Writes structure \n");
+
+	aws_iot_json_writer_char(&writer, '{');
+	aws_iot_json_writer_key(&writer, "a");
+	aws_iot_json_writer_int(&writer, -5);
+	aws_iot_json_writer_char(&writer, ',');
+	aws_iot_json_writer_key(&writer, "b");
+	aws_iot_json_writer_bool(&writer, false);
+	aws_iot_json_writer_char(&writer, ',');
+	aws_iot_json_writer_key(&writer, "c");
+	aws_iot_json_writer_raw_string(&writer, "{\"nested\":null}");
+	aws_iot_json_writer_char(&writer, '}');
+
+	CHECK_EQUAL_C_STRING("{\"a\":-5,\"b\":false,\"c\":{\"nested\":null}}", writerBuffer);
+	CHECK_EQUAL_C_INT((int) strlen(writerBuffer), (int) writer.length);
+	CHECK_C(!aws_iot_json_writer_is_truncated(&writer));
+
+	/* Continuing at an offset keeps what is already in the buffer */
+	aws_iot_json_writer_init(&writer, writerBuffer, sizeof(writerBuffer), 4);
+	aws_iot_json_writer_uint(&writer, 7);
+	CHECK_EQUAL_C_STRING("{\"a\"7", writerBuffer);
+}
+
+TEST_C(JsonWriterTests, EscapesStrings) {
+	IOT_DEBUG("\n-->Running Json Writer Tests - Escapes strings \n");
+
+	aws_iot_json_writer_string(&writer, "say \"hi\"\\\n\t\x01 done");
+	CHECK_EQUAL_C_STRING("\"say \\\"hi\\\"\\\\\\n\\t\\u0001 done\"", writerBuffer);
+}
+
+TEST_C(JsonWriterTests, TruncatesLikeSnprintf) {
+	char small[8];
+	char expected[8];
+
+	IOT_DEBUG("\n-->Running Json Writer Tests - Truncates like snprintf \n");
+
+	aws_iot_json_writer_init(&writer, small, sizeof(small), 0);
+	aws_iot_json_writer_raw_string(&writer, "{\"key\":");
+	CHECK_C(!aws_iot_json_writer_is_truncated(&writer));
+	aws_iot_json_writer_uint(&writer, 12345);
+
+	snprintf(expected, sizeof(expected), "{\"key\":%u", 12345);
+	CHECK_EQUAL_C_STRING(expected, small);
+	CHECK_C(aws_iot_json_writer_is_truncated(&writer));
+	CHECK_EQUAL_C_INT(12, (int) writer.length);
+}
+
+TEST_C(JsonWriterTests, MeasuresWithoutBuffer) {
+	AwsIotJobExecutionUpdateRequest request;
+	int requiredLength;
+
+	IOT_DEBUG("\n-->Running Json Writer Tests - Measures without a buffer \n");
+
+	aws_iot_json_writer_init(&writer, NULL, 0, 0);
+	aws_iot_json_writer_key(&writer, "key");
+	aws_iot_json_writer_double(&writer, 0.5);
+	CHECK_EQUAL_C_INT(9, (int) writer.length);
+
+	memset(&request, 0, sizeof(request));
+	request.status = JOB_EXECUTION_SUCCEEDED;
+	request.clientToken = "tok\"en";
+	requiredLength = aws_iot_jobs_json_serialize_update_job_execution_request(NULL, 0, &request);
+	CHECK_EQUAL_C_INT(requiredLength, aws_iot_jobs_json_serialize_update_job_execution_request(writerBuffer,
+																							   sizeof(writerBuffer), &request));
+	CHECK_EQUAL_C_STRING("{\"status\":\"SUCCEEDED\",\"clientToken\":\"tok\\\"en\"}", writerBuffer);
+	CHECK_EQUAL_C_INT((int) strlen(writerBuffer), requiredLength);
+}
+
+TEST_C(JsonWriterTests, FormatsIntegers) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+
+	IOT_DEBUG("\n-->Running Json Writer Tests - Formats integers \n");
+
+	aws_iot_json_format_uint(0, buf);
+	CHECK_EQUAL_C_STRING("0", buf);
+	aws_iot_json_format_uint(UINT64_MAX, buf);
+	CHECK_EQUAL_C_STRING("18446744073709551615", buf);
+
+	aws_iot_json_writer_int(&writer, INT64_MIN);
+	aws_iot_json_writer_char(&writer, ' ');
+	aws_iot_json_writer_int(&writer, INT32_MAX);
+	aws_iot_json_writer_char(&writer, ' ');
+	aws_iot_json_writer_int(&writer, -9);
+	CHECK_EQUAL_C_STRING("-9223372036854775808 2147483647 -9", writerBuffer);
+}
+
+TEST_C(JsonWriterTests, FormatsShortestDoubles) {
+	IOT_DEBUG("\n-->Running Json Writer Tests - Formats shortest doubles \n");
+
+	checkDouble("0.0", 0.0);
+	checkDouble("-0.0", -0.0);
+	checkDouble("1.0", 1.0);
+	checkDouble("100.0", 100.0);
+	checkDouble("0.1", 0.1);
+	checkDouble("0.3", 0.3);
+	checkDouble("-273.15", -273.15);
+	checkDouble("0.000001", 1e-6);
+	checkDouble("1e-7", 1e-7);
+	checkDouble("100000000000000000000.0", 1e20);
+	checkDouble("1e21", 1e21);
+	checkDouble("1.7976931348623157e308", 1.7976931348623157e308);
+	checkDouble("5e-324", 5e-324);
+	checkDouble("4.090799808502197", (double) 4.0908f);
+}
+
+TEST_C(JsonWriterTests, FormatsShortestFloats) {
+	IOT_DEBUG("\n-->Running Json Writer Tests - Formats shortest floats \n");
+
+	checkFloat("3.445", 3.445f);
+	checkFloat("0.1", 0.1f);
+	checkFloat("16777216.0", 16777216.0f);
+	checkFloat("3.4028235e38", 3.4028235e38f);
+	checkFloat("1e-45", 1e-45f);
+	checkFloat("-23.45", -23.45f);
+}
+
+TEST_C(JsonWriterTests, DoublesRoundTrip) {
+	char buf[AWS_IOT_JSON_NUMBER_MAX_LEN];
+	uint64_t bits = 88172645463325252ULL;
+	uint32_t floatBits;
+	double value, parsedDouble;
+	float floatValue, parsedFloat;
+	size_t length;
+	int i;
+
+	IOT_DEBUG("\n-->Running Json Writer Tests - Doubles and floats round trip \n");
+
+	for(i = 0; i < 100000; i++) {
+		bits ^= bits << 13;
+		bits ^= bits >> 7;
+		bits ^= bits << 17;
+
+		memcpy(&value, &bits, sizeof(value));
+		if(value == value && value - value == 0) {
+			length = aws_iot_json_format_double(value, buf);
+			CHECK_EQUAL_C_INT(SUCCESS, parseDoubleFromChars(buf, buf + length, &parsedDouble));
+			CHECK_C(parsedDouble == value);
+		}
+
+		floatBits = (uint32_t) bits;
+		memcpy(&floatValue, &floatBits, sizeof(floatValue));
+		if(floatValue == floatValue && floatValue - floatValue == 0) {
+			length = aws_iot_json_format_float(floatValue, buf);
+			CHECK_C(strtof(buf, NULL) == floatValue);
+			CHECK_EQUAL_C_INT(SUCCESS, parseFloatFromChars(buf, buf + length, &parsedFloat));
+			CHECK_C(parsedFloat == floatValue);
+		}
+	}
+}
+
+TEST_C(JsonWriterTests, ShadowDocumentWithManyFields) {
+	jsonStruct_t fields[WRITER_TEST_FIELDS];
+	char keys[WRITER_TEST_FIELDS][8];
+	float values[WRITER_TEST_FIELDS];
+	jsmn_parser parser;
+	jsmntok_t tokens[2 * WRITER_TEST_FIELDS + 64];
+	IoT_Error_t rc = SUCCESS;
+	int i, tokenCount;
+
+	IOT_DEBUG("\n-->Running Json Writer Tests - Shadow document with many fields \n");
+
+	rc = aws_iot_shadow_init_json_document(writerBuffer, sizeof(writerBuffer));
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	for(i = 0; i < WRITER_TEST_FIELDS; i++) {
+		snprintf(keys[i], sizeof(keys[i]), "f%d", i);
+		values[i] = (float) i / 8.0f;
+		fields[i].pKey = keys[i];
+		fields[i].pData = &values[i];
+		fields[i].type = SHADOW_JSON_FLOAT;
+		fields[i].dataLength = sizeof(float);
+		fields[i].cb = NULL;
+	}
+	/* The variadic API takes at most what fits in a call, so add in batches of ten */
+	for(i = 0; i < WRITER_TEST_FIELDS && SUCCESS == rc; i += 10) {
+		if(0 == i) {
+			rc = aws_iot_shadow_add_reported(writerBuffer, sizeof(writerBuffer), 10, &fields[i], &fields[i + 1],
+											 &fields[i + 2], &fields[i + 3], &fields[i + 4], &fields[i + 5],
+											 &fields[i + 6], &fields[i + 7], &fields[i + 8], &fields[i + 9]);
+		} else {
+			rc = aws_iot_shadow_add_desired(writerBuffer, sizeof(writerBuffer), 10, &fields[i], &fields[i + 1],
+											&fields[i + 2], &fields[i + 3], &fields[i + 4], &fields[i + 5],
+											&fields[i + 6], &fields[i + 7], &fields[i + 8], &fields[i + 9]);
+		}
+	}
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_finalize_json_document(writerBuffer, sizeof(writerBuffer)));
+
+	CHECK_C(NULL != strstr(writerBuffer, "{\"state\":{\"reported\":{\"f0\":0.0,\"f1\":0.125,\"f2\":0.25,"));
+	CHECK_C(NULL != strstr(writerBuffer, "\"f99\":12.375}}, \"clientToken\":\""));
+
+	jsmn_init(&parser);
+	tokenCount = jsmn_parse(&parser, writerBuffer, strlen(writerBuffer), tokens, sizeof(tokens) / sizeof(tokens[0]));
+	CHECK_C(tokenCount > 2 * WRITER_TEST_FIELDS);
+}
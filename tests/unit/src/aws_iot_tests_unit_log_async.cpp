@@ -0,0 +1,34 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_log_async.cpp
+ * @brief IoT Client Unit Testing - Asynchronous Logger Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(LogAsyncTests) {
+  TEST_GROUP_C_SETUP_WRAPPER(LogAsyncTests)
+  TEST_GROUP_C_TEARDOWN_WRAPPER(LogAsyncTests)
+};
+
+TEST_GROUP_C_WRAPPER(LogAsyncTests, FormatsDeferredArguments)
+TEST_GROUP_C_WRAPPER(LogAsyncTests, CopiesStringArguments)
+TEST_GROUP_C_WRAPPER(LogAsyncTests, StringPrecisionFromArgument)
+TEST_GROUP_C_WRAPPER(LogAsyncTests, InfoHasNoPrefix)
+TEST_GROUP_C_WRAPPER(LogAsyncTests, PerModuleLevels)
+TEST_GROUP_C_WRAPPER(LogAsyncTests, DropsWhenRingIsFull)
@@ -0,0 +1,150 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_log_async_helper.c
+ * @brief IoT Client Unit Testing - Asynchronous Logger Tests helper
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_log.h"
+#include "aws_iot_log_async.h"
+
+#define CAPTURED_LINE_LENGTH 256
+
+static char capturedLine[CAPTURED_LINE_LENGTH];
+static uint32_t capturedCount;
+
+static void captureSink(void *pContext, IoT_Log_Level_t level, const char *pLine, size_t lineLen) {
+	IOT_UNUSED(pContext);
+	IOT_UNUSED(level);
+	if(lineLen >= CAPTURED_LINE_LENGTH) {
+		lineLen = CAPTURED_LINE_LENGTH - 1;
+	}
+	memcpy(capturedLine, pLine, lineLen);
+	capturedLine[lineLen] = '\0';
+	capturedCount++;
+}
+
+TEST_GROUP_C_SETUP(LogAsyncTests) {
+	aws_iot_log_async_flush();
+	aws_iot_log_async_set_sink(captureSink, NULL);
+	aws_iot_log_async_set_level_all(IOT_LOG_LEVEL_DEBUG);
+	/* Keep the test progress messages of this file out of the ring */
+	aws_iot_log_async_set_level(IOT_LOG_MODULE_APP, IOT_LOG_LEVEL_NONE);
+	aws_iot_log_async_reset_dropped_count();
+	capturedLine[0] = '\0';
+	capturedCount = 0;
+}
+
+TEST_GROUP_C_TEARDOWN(LogAsyncTests) {
+	aws_iot_log_async_flush();
+	aws_iot_log_async_set_sink(NULL, NULL);
+	aws_iot_log_async_set_level_all(IOT_LOG_LEVEL_DEBUG);
+}
+
+TEST_C(LogAsyncTests, FormatsDeferredArguments) {
+	IoT_Error_t rc;
+
+	IOT_DEBUG("\n-->Running Log Async Tests - Formats deferred arguments \n");
+
+	rc = aws_iot_log_async_write(IOT_LOG_LEVEL_DEBUG, IOT_LOG_MODULE_MQTT, "func", 42,
+								 "int %d uint %u hex %04x ll %lld char %c float %.2f ptr %s",
+								 -7, 7u, 0xAB, -1234567890123LL, 'z', 1.5, "end");
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(0, capturedCount);
+
+	CHECK_EQUAL_C_INT(1, aws_iot_log_async_flush());
+	CHECK_EQUAL_C_STRING("DEBUG:   func L#42 int -7 uint 7 hex 00ab ll -1234567890123 char z float 1.50 ptr end",
+						 capturedLine);
+}
+
+TEST_C(LogAsyncTests, CopiesStringArguments) {
+	char mutableString[16];
+
+	IOT_DEBUG("\n-->Running Log Async Tests - Copies string arguments \n");
+
+	strcpy(mutableString, "before");
+	aws_iot_log_async_write(IOT_LOG_LEVEL_WARN, IOT_LOG_MODULE_SHADOW, "func", 1, "value %s %hhu%%", mutableString, 300);
+	strcpy(mutableString, "after");
+
+	CHECK_EQUAL_C_INT(1, aws_iot_log_async_flush());
+	CHECK_EQUAL_C_STRING("WARN:  func L#1 value before 44%", capturedLine);
+}
+
+TEST_C(LogAsyncTests, StringPrecisionFromArgument) {
+	const char topic[] = {'a', '/', 'b', 'X', 'X'};
+
+	IOT_DEBUG("\n-->Running Log Async Tests - String precision from argument \n");
+
+	aws_iot_log_async_write(IOT_LOG_LEVEL_ERROR, IOT_LOG_MODULE_MQTT, "func", 7, "topic %.*s|%5d|", 3, topic, 12);
+
+	CHECK_EQUAL_C_INT(1, aws_iot_log_async_flush());
+	CHECK_EQUAL_C_STRING("ERROR: func L#7 topic a/b|   12|", capturedLine);
+}
+
+TEST_C(LogAsyncTests, InfoHasNoPrefix) {
+	IOT_DEBUG("\n-->Running Log Async Tests - Info has no prefix \n");
+
+	aws_iot_log_async_write(IOT_LOG_LEVEL_INFO, IOT_LOG_MODULE_APP, NULL, 9, "Connecting...");
+
+	CHECK_EQUAL_C_INT(1, aws_iot_log_async_flush());
+	CHECK_EQUAL_C_STRING("Connecting...", capturedLine);
+}
+
+TEST_C(LogAsyncTests, PerModuleLevels) {
+	IOT_DEBUG("\n-->Running Log Async Tests - Per module levels \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_log_async_set_level(IOT_LOG_MODULE_MQTT, IOT_LOG_LEVEL_WARN));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_log_async_set_level(IOT_LOG_MODULE_COUNT, IOT_LOG_LEVEL_WARN));
+	CHECK_EQUAL_C_INT(IOT_LOG_LEVEL_WARN, aws_iot_log_async_get_level(IOT_LOG_MODULE_MQTT));
+
+	CHECK_C(!aws_iot_log_async_is_enabled(IOT_LOG_MODULE_MQTT, IOT_LOG_LEVEL_DEBUG));
+	CHECK_C(!aws_iot_log_async_is_enabled(IOT_LOG_MODULE_MQTT, IOT_LOG_LEVEL_INFO));
+	CHECK_C(aws_iot_log_async_is_enabled(IOT_LOG_MODULE_MQTT, IOT_LOG_LEVEL_WARN));
+	CHECK_C(aws_iot_log_async_is_enabled(IOT_LOG_MODULE_MQTT, IOT_LOG_LEVEL_ERROR));
+	CHECK_C(aws_iot_log_async_is_enabled(IOT_LOG_MODULE_SHADOW, IOT_LOG_LEVEL_DEBUG));
+
+	aws_iot_log_async_set_level_all(IOT_LOG_LEVEL_NONE);
+	CHECK_C(!aws_iot_log_async_is_enabled(IOT_LOG_MODULE_SHADOW, IOT_LOG_LEVEL_ERROR));
+}
+
+TEST_C(LogAsyncTests, DropsWhenRingIsFull) {
+	char expectedLine[64];
+	uint32_t i;
+
+	IOT_DEBUG("\n-->Running Log Async Tests - Drops when ring is full \n");
+
+	for(i = 0; i < AWS_IOT_LOG_ASYNC_RING_SIZE; i++) {
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_log_async_write(IOT_LOG_LEVEL_DEBUG, IOT_LOG_MODULE_APP, "func", 1,
+														   "record %u", (unsigned int) i));
+	}
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_log_async_write(IOT_LOG_LEVEL_DEBUG, IOT_LOG_MODULE_APP, "func", 1,
+													   "record %u", (unsigned int) i));
+	CHECK_EQUAL_C_INT(1, aws_iot_log_async_get_dropped_count());
+
+	CHECK_EQUAL_C_INT(AWS_IOT_LOG_ASYNC_RING_SIZE, aws_iot_log_async_flush());
+	snprintf(expectedLine, sizeof(expectedLine), "DEBUG:   func L#1 record %u",
+			 (unsigned int) (AWS_IOT_LOG_ASYNC_RING_SIZE - 1));
+	CHECK_EQUAL_C_STRING(expectedLine, capturedLine);
+
+	/* The ring is reusable once drained */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_log_async_write(IOT_LOG_LEVEL_DEBUG, IOT_LOG_MODULE_APP, "func", 1, "again"));
+	CHECK_EQUAL_C_INT(1, aws_iot_log_async_flush());
+}
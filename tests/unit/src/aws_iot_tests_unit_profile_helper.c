@@ -0,0 +1,153 @@
+/*
+* Copyright 2015-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License").
+* You may not use this file except in compliance with the License.
+* A copy of the License is located at
+*
+* http://aws.amazon.com/apache2.0
+*
+* or in the "license" file accompanying this file. This file is distributed
+* on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+* express or implied. See the License for the specific language governing
+* permissions and limitations under the License.
+*/
+
+/**
+ * @file aws_iot_tests_unit_profile_helper.c
+ * @brief IoT Client Unit Testing - Profiler Tests helper
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_profile.h"
+#include "aws_iot_mqtt_client_interface.h"
+#include "aws_iot_log.h"
+
+static const char outerFunction[] = "outer";
+static const char innerFunction[] = "inner";
+static const char leakyFunction[] = "leaky";
+
+static const IoT_Profile_Entry_t *findEntry(const IoT_Profile_Entry_t *pEntries, size_t count, const char *pFunction) {
+	size_t i;
+
+	for(i = 0; i < count; i++) {
+		if(0 == strcmp(pEntries[i].pFunction, pFunction)) {
+			return &pEntries[i];
+		}
+	}
+	return NULL;
+}
+
+static void busyWaitNs(uint64_t durationNs) {
+	uint64_t start = get_monotonic_time_ns();
+	while(get_monotonic_time_ns() - start < durationNs) {
+	}
+}
+
+TEST_GROUP_C_SETUP(ProfileTests) {
+	aws_iot_profile_reset();
+}
+
+TEST_GROUP_C_TEARDOWN(ProfileTests) {
+	aws_iot_profile_reset();
+}
+
+TEST_C(ProfileTests, CountsNestedCalls) {
+	IoT_Profile_Entry_t entries[8];
+	const IoT_Profile_Entry_t *pOuter, *pInner;
+	size_t count;
+	int i;
+
+	IOT_DEBUG("\n-->Running Profile Tests - Counts nested calls \n");
+
+	for(i = 0; i < 3; i++) {
+		aws_iot_profile_enter(outerFunction);
+		aws_iot_profile_enter(innerFunction);
+		busyWaitNs(100000);
+		aws_iot_profile_exit(innerFunction);
+		aws_iot_profile_exit(outerFunction);
+	}
+
+	count = aws_iot_profile_get_report(entries, 8);
+	pOuter = findEntry(entries, count, outerFunction);
+	pInner = findEntry(entries, count, innerFunction);
+	CHECK_C(NULL != pOuter);
+	CHECK_C(NULL != pInner);
+	CHECK_EQUAL_C_INT(3, pOuter->callCount);
+	CHECK_EQUAL_C_INT(3, pInner->callCount);
+	/* Inclusive time of the caller covers the callee */
+	CHECK_C(pOuter->totalNs >= pInner->totalNs);
+	CHECK_C(pInner->totalNs >= 300000);
+	CHECK_C(pInner->maxNs >= 100000);
+	CHECK_C(pInner->maxNs <= pInner->totalNs);
+}
+
+TEST_C(ProfileTests, EarlyReturnFramesAreDiscarded) {
+	IoT_Profile_Entry_t entries[8];
+	const IoT_Profile_Entry_t *pOuter;
+	size_t count;
+
+	IOT_DEBUG("\n-->Running Profile Tests - Early return frames are discarded \n");
+
+	aws_iot_profile_enter(outerFunction);
+	aws_iot_profile_enter(leakyFunction);
+	/* leaky returns without FUNC_EXIT_RC */
+	aws_iot_profile_exit(outerFunction);
+
+	count = aws_iot_profile_get_report(entries, 8);
+	pOuter = findEntry(entries, count, outerFunction);
+	CHECK_C(NULL != pOuter);
+	CHECK_EQUAL_C_INT(1, pOuter->callCount);
+	CHECK_C(NULL == findEntry(entries, count, leakyFunction));
+}
+
+TEST_C(ProfileTests, ExitWithoutEntryIsIgnored) {
+	IoT_Profile_Entry_t entries[8];
+
+	IOT_DEBUG("\n-->Running Profile Tests - Exit without entry is ignored \n");
+
+	aws_iot_profile_exit(innerFunction);
+
+	CHECK_EQUAL_C_INT(0, aws_iot_profile_get_report(entries, 8));
+}
+
+TEST_C(ProfileTests, ReportIsSortedAndTruncated) {
+	IoT_Profile_Entry_t entries[8];
+	size_t count;
+
+	IOT_DEBUG("\n-->Running Profile Tests - Report is sorted and truncated \n");
+
+	aws_iot_profile_enter(innerFunction);
+	busyWaitNs(10000);
+	aws_iot_profile_exit(innerFunction);
+	aws_iot_profile_enter(leakyFunction);
+	busyWaitNs(500000);
+	aws_iot_profile_exit(leakyFunction);
+
+	count = aws_iot_profile_get_report(entries, 8);
+	CHECK_EQUAL_C_INT(2, count);
+	CHECK_EQUAL_C_STRING(leakyFunction, entries[0].pFunction);
+	CHECK_C(entries[0].totalNs >= entries[1].totalNs);
+
+	count = aws_iot_profile_get_report(entries, 1);
+	CHECK_EQUAL_C_INT(1, count);
+	CHECK_EQUAL_C_STRING(leakyFunction, entries[0].pFunction);
+}
+
+TEST_C(ProfileTests, RecordsSdkFunctions) {
+	IoT_Profile_Entry_t entries[8];
+	AWS_IoT_Client client;
+	size_t count;
+
+	IOT_DEBUG("\n-->Running Profile Tests - Records SDK functions \n");
+
+	/* aws_iot_mqtt_init is bracketed with FUNC_ENTRY/FUNC_EXIT_RC and fails early on NULL params */
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_mqtt_init(&client, NULL));
+
+	count = aws_iot_profile_get_report(entries, 8);
+	CHECK_C(NULL != findEntry(entries, count, "aws_iot_mqtt_init"));
+}
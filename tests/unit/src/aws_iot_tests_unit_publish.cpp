@@ -46,3 +46,11 @@ TEST_GROUP_C_WRAPPER(PublishTests, publishQoS1Success10msDelayedPuback)
 TEST_GROUP_C_WRAPPER(PublishTests, publishQoS0NoPubackSuccess)
 /* E:10 - Publish with QoS1 send success, Puback received */
 TEST_GROUP_C_WRAPPER(PublishTests, publishQoS1Success)
+/* E:11 - Publish handle with Null/empty or wildcard Topic Name */
+TEST_GROUP_C_WRAPPER(PublishTests, publishHandleCreateInvalidTopic)
+/* E:12 - Publish with handle QoS0 sends the same packet as publish */
+TEST_GROUP_C_WRAPPER(PublishTests, publishWithHandleQoS0SamePacket)
+/* E:13 - Publish with handle QoS1 send success, Puback received, handle reused */
+TEST_GROUP_C_WRAPPER(PublishTests, publishWithHandleQoS1Success)
+/* E:14 - Publish handle keeps its own copy of the topic */
+TEST_GROUP_C_WRAPPER(PublishTests, publishHandleOwnsTopic)
@@ -24,6 +24,7 @@
 
 #include "aws_iot_mqtt_client_interface.h"
 #include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_mock_tls_params.h"
 #include "aws_iot_log.h"
 
 static IoT_Client_Init_Params initParams;
@@ -203,3 +204,116 @@ TEST_C(PublishTests, publishQoS1Success) {
 
 	IOT_DEBUG("-->Success - E:10 - Publish with QoS1 send success, Puback received \n");
 }
+
+/* E:11 - Publish handle with Null/empty or wildcard Topic Name */
+TEST_C(PublishTests, publishHandleCreateInvalidTopic) {
+	IoT_Publish_Handle handle;
+	char longTopic[AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN + 1];
+	IoT_Error_t rc = SUCCESS;
+
+	IOT_DEBUG("-->Running Publish Tests - E:11 - Publish handle with Null/empty or wildcard Topic Name \n");
+
+	memset(longTopic, 'a', sizeof(longTopic));
+
+	rc = aws_iot_mqtt_publish_handle_create(NULL, subTopic, subTopicLen, QOS0, 0);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+	rc = aws_iot_mqtt_publish_handle_create(&handle, NULL, subTopicLen, QOS0, 0);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+	rc = aws_iot_mqtt_publish_handle_create(&handle, subTopic, 0, QOS0, 0);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+	rc = aws_iot_mqtt_publish_handle_create(&handle, "sdk/+/Test", 10, QOS0, 0);
+	CHECK_EQUAL_C_INT(FAILURE, rc);
+	rc = aws_iot_mqtt_publish_handle_create(&handle, "sdk/#", 5, QOS0, 0);
+	CHECK_EQUAL_C_INT(FAILURE, rc);
+	rc = aws_iot_mqtt_publish_handle_create(&handle, longTopic, AWS_IOT_MQTT_PUBLISH_HANDLE_MAX_TOPIC_LEN + 1, QOS0, 0);
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, rc);
+
+	rc = aws_iot_mqtt_publish_with_handle(&iotClient, NULL, cPayload, strlen(cPayload), NULL);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+
+	IOT_DEBUG("-->Success - E:11 - Publish handle with Null/empty or wildcard Topic Name \n");
+}
+
+/* E:12 - Publish with handle QoS0 sends the same packet as publish */
+TEST_C(PublishTests, publishWithHandleQoS0SamePacket) {
+	IoT_Publish_Handle handle;
+	unsigned char expectedPacket[TLSMaxBufferSize];
+	size_t expectedLen;
+	uint16_t packetId = 1;
+	IoT_Error_t rc = SUCCESS;
+
+	IOT_DEBUG("-->Running Publish Tests - E:12 - Publish with handle QoS0 sends the same packet as publish \n");
+
+	testPubMsgParams.qos = QOS0;
+	testPubMsgParams.isRetained = 1;
+	rc = aws_iot_mqtt_publish(&iotClient, subTopic, subTopicLen, &testPubMsgParams);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	expectedLen = TxBuffer.len;
+	memcpy(expectedPacket, TxBuffer.pBuffer, expectedLen);
+
+	ResetTLSBuffer();
+	rc = aws_iot_mqtt_publish_handle_create(&handle, subTopic, subTopicLen, QOS0, 1);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	rc = aws_iot_mqtt_publish_with_handle(&iotClient, &handle, testPubMsgParams.payload, testPubMsgParams.payloadLen,
+										  &packetId);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	CHECK_EQUAL_C_INT(expectedLen, TxBuffer.len);
+	CHECK_EQUAL_C_INT(0, memcmp(expectedPacket, TxBuffer.pBuffer, expectedLen));
+	CHECK_EQUAL_C_INT(0, packetId);
+	CHECK_EQUAL_C_INT(CLIENT_STATE_CONNECTED_IDLE, aws_iot_mqtt_get_client_state(&iotClient));
+
+	IOT_DEBUG("-->Success - E:12 - Publish with handle QoS0 sends the same packet as publish \n");
+}
+
+/* E:13 - Publish with handle QoS1 send success, Puback received, handle reused */
+TEST_C(PublishTests, publishWithHandleQoS1Success) {
+	IoT_Publish_Handle handle;
+	uint16_t firstPacketId = 0;
+	uint16_t secondPacketId = 0;
+	IoT_Error_t rc = SUCCESS;
+
+	IOT_DEBUG("-->Running Publish Tests - E:13 - Publish with handle QoS1 send success, Puback received \n");
+
+	rc = aws_iot_mqtt_publish_handle_create(&handle, subTopic, subTopicLen, QOS1, 0);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	setTLSRxBufferForPuback();
+	rc = aws_iot_mqtt_publish_with_handle(&iotClient, &handle, "first", 5, &firstPacketId);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_C(0 != firstPacketId);
+	CHECK_EQUAL_C_STRING(subTopic, LastPublishMessageTopic);
+	CHECK_EQUAL_C_STRING("first", LastPublishMessagePayload);
+
+	ResetTLSBuffer();
+	setTLSRxBufferForPuback();
+	rc = aws_iot_mqtt_publish_with_handle(&iotClient, &handle, "second message", 14, &secondPacketId);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_C(0 != secondPacketId);
+	CHECK_C(firstPacketId != secondPacketId);
+	CHECK_EQUAL_C_STRING(subTopic, LastPublishMessageTopic);
+	CHECK_EQUAL_C_STRING("second message", LastPublishMessagePayload);
+
+	IOT_DEBUG("-->Success - E:13 - Publish with handle QoS1 send success, Puback received \n");
+}
+
+/* E:14 - Publish handle keeps its own copy of the topic */
+TEST_C(PublishTests, publishHandleOwnsTopic) {
+	IoT_Publish_Handle handle;
+	char topic[sizeof(subTopic)];
+	IoT_Error_t rc = SUCCESS;
+
+	IOT_DEBUG("-->Running Publish Tests - E:14 - Publish handle keeps its own copy of the topic \n");
+
+	memcpy(topic, subTopic, sizeof(topic));
+	rc = aws_iot_mqtt_publish_handle_create(&handle, topic, subTopicLen, QOS0, 0);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	memset(topic, 'x', sizeof(topic));
+
+	rc = aws_iot_mqtt_publish_with_handle(&iotClient, &handle, "payload", 7, NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_STRING(subTopic, LastPublishMessageTopic);
+	CHECK_EQUAL_C_STRING("payload", LastPublishMessagePayload);
+
+	IOT_DEBUG("-->Success - E:14 - Publish handle keeps its own copy of the topic \n");
+}
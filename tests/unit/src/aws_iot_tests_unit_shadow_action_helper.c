@@ -214,7 +214,7 @@ TEST_C(ShadowActionTests, UpdateTheJSONDocument) {
 	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
 
 	snprintf(expectedUpdateRequestJson, SIZE_OF_UPDATE_DOCUMENT,
-			 "{\"state\":{\"reported\":{\"doubleData\":4.090800,\"floatData\":3.445000},\"desired\":{\"boolData\":true}}, \"clientToken\":\"%s-0\"}",
+			 "{\"state\":{\"reported\":{\"doubleData\":4.090799808502197,\"floatData\":3.445},\"desired\":{\"boolData\":true}}, \"clientToken\":\"%s-0\"}",
 			AWS_IOT_MQTT_CLIENT_ID);
 	CHECK_EQUAL_C_STRING(expectedUpdateRequestJson, updateRequestJson);
 
@@ -842,17 +842,18 @@ TEST_C(ShadowActionTests, IsReceivedJsonValid)
 {
 	bool ret_val;
 	char getRequestJson[TEST_JSON_SIZE];
+	ShadowJsonParser_t jsonParser;
 	
 	IOT_DEBUG("-->Running Shadow Action Tests - IsReceivedJsonValid \n");
 		
 	snprintf(getRequestJson, TEST_JSON_SIZE, TEST_JSON_RESPONSE_FULL_DOCUMENT);	
 	
 	//Test by cutting the JSON document
-	ret_val = isReceivedJsonValid(getRequestJson, 3);
+	ret_val = isReceivedJsonValid(getRequestJson, &jsonParser, 3);
 	CHECK_EQUAL_C_INT(false, ret_val);
 		
 	//Happy path
-	ret_val = isReceivedJsonValid(getRequestJson, TEST_JSON_SIZE);
+	ret_val = isReceivedJsonValid(getRequestJson, &jsonParser, TEST_JSON_SIZE);
 	CHECK_EQUAL_C_INT(true, ret_val);
 	
 	IOT_DEBUG("-->Success - IsReceivedJsonValid");
@@ -863,21 +864,22 @@ TEST_C(ShadowActionTests, ExtractClientToken)
 	bool ret_val;
 	char getRequestJson[TEST_JSON_SIZE];
 	char extractedClientToken[MAX_SIZE_CLIENT_ID_WITH_SEQUENCE];
+	ShadowJsonParser_t jsonParser;
 	
 	IOT_DEBUG("-->Running Shadow Action Tests - ExtractClientToken \n");
 
 	//Try JSON with no token
 	snprintf(getRequestJson, TEST_JSON_SIZE, "{}");
-	ret_val = extractClientToken(getRequestJson, TEST_JSON_SIZE, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
+	ret_val = extractClientToken(getRequestJson, &jsonParser, TEST_JSON_SIZE, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
 	CHECK_EQUAL_C_INT(false, ret_val);
 	
 	//Try JSON with token but not enough memory
 	snprintf(getRequestJson, TEST_JSON_SIZE, TEST_JSON_RESPONSE_FULL_DOCUMENT);	
-	ret_val = extractClientToken(getRequestJson, TEST_JSON_SIZE, extractedClientToken, 1 );
+	ret_val = extractClientToken(getRequestJson, &jsonParser, TEST_JSON_SIZE, extractedClientToken, 1 );
 	CHECK_EQUAL_C_INT(false, ret_val);
 	
 	//Happy path
-	ret_val = extractClientToken(getRequestJson, TEST_JSON_SIZE, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
+	ret_val = extractClientToken(getRequestJson, &jsonParser, TEST_JSON_SIZE, extractedClientToken, MAX_SIZE_CLIENT_ID_WITH_SEQUENCE );
 	CHECK_EQUAL_C_INT(true, ret_val);
 	
 	IOT_DEBUG("-->Success - ExtractClientToken");
@@ -942,3 +944,83 @@ TEST_C(ShadowActionTests, NoCallbackForShadowAction) {
 
 	IOT_DEBUG("-->Success - No callback for shadow action");
 }
+
+static void *pContextRx;
+
+static void contextCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+							const char *pReceivedJsonDocument, void *pContextData) {
+	actionCallback(pThingName, action, status, pReceivedJsonDocument, pContextData);
+	pContextRx = pContextData;
+}
+
+static void deliverGetResponse(const char *pTopic, const char *pDocument) {
+	IoT_Publish_Message_Params params;
+	IoT_Error_t ret_val;
+
+	ResetTLSBuffer();
+	params.payloadLen = strlen(pDocument);
+	params.payload = (void *) pDocument;
+	params.qos = QOS0;
+	setTLSRxBufferWithMsgOnSubscribedTopic((char *) pTopic, strlen(pTopic), QOS0, params, params.payload);
+	ret_val = aws_iot_shadow_yield(&client, 200);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+}
+
+TEST_C(ShadowActionTests, CollidingTokenSlotsAreMatched) {
+	IoT_Error_t ret_val = SUCCESS;
+	char firstRequestJson[TEST_JSON_SIZE];
+	char secondRequestJson[TEST_JSON_SIZE];
+	char secondResponseJson[TEST_JSON_SIZE];
+	int firstContext, secondContext;
+
+	IOT_DEBUG("-->Running Shadow Action Tests - Colliding token slots are matched \n");
+
+	/* Both sequence numbers map to the first slot of the ack wait list */
+	snprintf(firstRequestJson, TEST_JSON_SIZE, "{\"clientToken\":\"%s-0\"}", AWS_IOT_MQTT_CLIENT_ID);
+	snprintf(secondRequestJson, TEST_JSON_SIZE, "{\"clientToken\":\"%s-%d\"}", AWS_IOT_MQTT_CLIENT_ID,
+			 MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME);
+	snprintf(secondResponseJson, TEST_JSON_SIZE, "{\"state\":{},\"clientToken\":\"%s-%d\"}", AWS_IOT_MQTT_CLIENT_ID,
+			 MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME);
+
+	ret_val = aws_iot_shadow_internal_action(AWS_IOT_MY_THING_NAME, SHADOW_GET, firstRequestJson, TEST_JSON_SIZE,
+											 contextCallback, &firstContext, 4, false);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+	ret_val = aws_iot_shadow_internal_action(AWS_IOT_MY_THING_NAME, SHADOW_GET, secondRequestJson, TEST_JSON_SIZE,
+											 contextCallback, &secondContext, 4, false);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	pContextRx = NULL;
+	deliverGetResponse(GET_REJECTED_TOPIC, secondResponseJson);
+	CHECK_C(&secondContext == pContextRx);
+	CHECK_EQUAL_C_INT(SHADOW_ACK_REJECTED, ackStatusRx);
+
+	pContextRx = NULL;
+	deliverGetResponse(GET_ACCEPTED_TOPIC, TEST_JSON_RESPONSE_FULL_DOCUMENT);
+	CHECK_C(&firstContext == pContextRx);
+	CHECK_EQUAL_C_INT(SHADOW_ACK_ACCEPTED, ackStatusRx);
+
+	IOT_DEBUG("-->Success - Colliding token slots are matched \n");
+}
+
+#define TEST_JSON_RESPONSE_APPLICATION_TOKEN "{\"state\":{},\"clientToken\":\"" AWS_IOT_MQTT_CLIENT_ID "-app-7\"}"
+
+TEST_C(ShadowActionTests, ApplicationTokenIsMatched) {
+	IoT_Error_t ret_val = SUCCESS;
+	char requestJson[TEST_JSON_SIZE];
+	int context;
+
+	IOT_DEBUG("-->Running Shadow Action Tests - Application chosen token is matched \n");
+
+	snprintf(requestJson, TEST_JSON_SIZE, "{\"clientToken\":\"%s-app-7\"}", AWS_IOT_MQTT_CLIENT_ID);
+	ret_val = aws_iot_shadow_internal_action(AWS_IOT_MY_THING_NAME, SHADOW_GET, requestJson, TEST_JSON_SIZE,
+											 contextCallback, &context, 4, false);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	pContextRx = NULL;
+	deliverGetResponse(GET_ACCEPTED_TOPIC, TEST_JSON_RESPONSE_APPLICATION_TOKEN);
+	CHECK_C(&context == pContextRx);
+	CHECK_EQUAL_C_INT(SHADOW_ACK_ACCEPTED, ackStatusRx);
+	CHECK_EQUAL_C_STRING(TEST_JSON_RESPONSE_APPLICATION_TOKEN, jsonFullDocument);
+
+	IOT_DEBUG("-->Success - Application chosen token is matched \n");
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_client_helper.c
+ * @brief IoT Client Unit Testing - Shadow Client Context Tests Helper
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_shadow_helper.h"
+
+#include "aws_iot_shadow_client.h"
+#include "aws_iot_log.h"
+
+#define TEST_JSON_SIZE 120
+#define THING_A "thingA"
+#define THING_B "thingB"
+#define CLIENT_ID_A "clientA"
+#define CLIENT_ID_B "clientB"
+#define DELTA_TOPIC_A AWS_THINGS_TOPIC THING_A SHADOW_TOPIC UPDATE_TOPIC "/delta"
+#define DELTA_TOPIC_B AWS_THINGS_TOPIC THING_B SHADOW_TOPIC UPDATE_TOPIC "/delta"
+#define GET_PUB_TOPIC_A AWS_THINGS_TOPIC THING_A SHADOW_TOPIC GET_TOPIC
+#define GET_ACCEPTED_TOPIC_A AWS_THINGS_TOPIC THING_A SHADOW_TOPIC GET_TOPIC ACCEPTED_TOPIC
+
+static ShadowClient_t shadowA;
+static ShadowClient_t shadowB;
+static AWS_IoT_Client clientA;
+static AWS_IoT_Client clientB;
+
+static uint32_t ackCount;
+static Shadow_Ack_Status_t ackStatus;
+static void *pAckContext;
+
+static void actionCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+						   const char *pReceivedJsonDocument, void *pContextData) {
+	IOT_UNUSED(pThingName);
+	IOT_UNUSED(action);
+	IOT_UNUSED(pReceivedJsonDocument);
+
+	ackCount++;
+	ackStatus = status;
+	pAckContext = pContextData;
+}
+
+static void initHandler(jsonStruct_t *pHandler, const char *pKey, void *pData, size_t dataLength,
+						JsonPrimitiveType type) {
+	pHandler->cb = NULL;
+	pHandler->pKey = pKey;
+	pHandler->pData = pData;
+	pHandler->dataLength = dataLength;
+	pHandler->type = type;
+}
+
+static void connectShadow(ShadowClient_t *pShadow, AWS_IoT_Client *pClient, char *pThingName, char *pClientId) {
+	ShadowInitParameters_t shadowInitParams;
+	ShadowConnectParameters_t shadowConnectParams;
+	IoT_Client_Connect_Params connectParams;
+
+	shadowInitParams.pHost = AWS_IOT_MQTT_HOST;
+	shadowInitParams.port = AWS_IOT_MQTT_PORT;
+	shadowInitParams.pClientCRT = AWS_IOT_CERTIFICATE_FILENAME;
+	shadowInitParams.pRootCA = AWS_IOT_ROOT_CA_FILENAME;
+	shadowInitParams.pClientKey = AWS_IOT_PRIVATE_KEY_FILENAME;
+	shadowInitParams.disconnectHandler = NULL;
+	shadowInitParams.enableAutoReconnect = false;
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_init(pShadow, pClient, &shadowInitParams));
+
+	shadowConnectParams.pMyThingName = pThingName;
+	shadowConnectParams.pMqttClientId = pClientId;
+	shadowConnectParams.mqttClientIdLen = (uint16_t) strlen(pClientId);
+	shadowConnectParams.deleteActionHandler = NULL;
+	ResetTLSBuffer();
+	ConnectMQTTParamsSetup(&connectParams, pClientId, (uint16_t) strlen(pClientId));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_connect(pShadow, &shadowConnectParams));
+}
+
+static void registerDelta(ShadowClient_t *pShadow, const char *pDeltaTopic, jsonStruct_t *pHandler) {
+	IoT_Publish_Message_Params params;
+
+	params.qos = QOS0;
+	params.isRetained = 0;
+	params.payload = NULL;
+	params.payloadLen = 0;
+	ResetTLSBuffer();
+	setTLSRxBufferForSuback((char *) pDeltaTopic, strlen(pDeltaTopic), QOS0, params);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_register_delta(pShadow, pHandler));
+}
+
+static void deliverMessage(ShadowClient_t *pShadow, const char *pTopic, const char *pDocument) {
+	IoT_Publish_Message_Params params;
+
+	ResetTLSBuffer();
+	params.payloadLen = strlen(pDocument);
+	params.payload = (void *) pDocument;
+	params.qos = QOS0;
+	setTLSRxBufferWithMsgOnSubscribedTopic((char *) pTopic, strlen(pTopic), QOS0, params, params.payload);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_yield(pShadow, 200));
+}
+
+TEST_GROUP_C_SETUP(ShadowClientTests) {
+	connectShadow(&shadowA, &clientA, THING_A, CLIENT_ID_A);
+	connectShadow(&shadowB, &clientB, THING_B, CLIENT_ID_B);
+	ackCount = 0;
+	pAckContext = NULL;
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowClientTests) {
+	IoT_Error_t rc = aws_iot_shadow_client_disconnect(&shadowA);
+	IOT_UNUSED(rc);
+	rc = aws_iot_shadow_client_disconnect(&shadowB);
+	IOT_UNUSED(rc);
+}
+
+TEST_C(ShadowClientTests, ClientTokensArePerContext) {
+	char documentA[TEST_JSON_SIZE];
+	char documentB[TEST_JSON_SIZE];
+	char tokenA[TEST_JSON_SIZE];
+	jsonStruct_t reported;
+	int32_t level = 1;
+
+	IOT_DEBUG("\n-->Running Shadow Client Tests - client tokens are per context \n");
+
+	initHandler(&reported, "level", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(documentA, TEST_JSON_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_add_reported(documentA, TEST_JSON_SIZE, 1, &reported));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(documentB, TEST_JSON_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_add_reported(documentB, TEST_JSON_SIZE, 1, &reported));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_finalize_json_document(&shadowA, documentA, TEST_JSON_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_finalize_json_document(&shadowB, documentB, TEST_JSON_SIZE));
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"level\":1}}, \"clientToken\":\"" CLIENT_ID_A "-0\"}", documentA);
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"level\":1}}, \"clientToken\":\"" CLIENT_ID_B "-0\"}", documentB);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_fill_with_client_token(&shadowA, tokenA, TEST_JSON_SIZE));
+	CHECK_EQUAL_C_STRING(CLIENT_ID_A "-1", tokenA);
+
+	IOT_DEBUG("-->Success - client tokens are per context \n");
+}
+
+TEST_C(ShadowClientTests, DeltaOnlyReachesItsContext) {
+	jsonStruct_t handlerA, handlerB;
+	int32_t valueA = 0, valueB = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Client Tests - delta only reaches its context \n");
+
+	initHandler(&handlerA, "level", &valueA, sizeof(int32_t), SHADOW_JSON_INT32);
+	initHandler(&handlerB, "level", &valueB, sizeof(int32_t), SHADOW_JSON_INT32);
+	registerDelta(&shadowA, DELTA_TOPIC_A, &handlerA);
+	registerDelta(&shadowB, DELTA_TOPIC_B, &handlerB);
+
+	deliverMessage(&shadowA, DELTA_TOPIC_A, "{\"state\":{\"level\":7},\"version\":5}");
+	CHECK_EQUAL_C_INT(7, valueA);
+	CHECK_EQUAL_C_INT(0, valueB);
+	CHECK_EQUAL_C_INT(5, aws_iot_shadow_client_get_last_received_version(&shadowA));
+	CHECK_EQUAL_C_INT(0, aws_iot_shadow_client_get_last_received_version(&shadowB));
+
+	/* Version 2 is old for A but not for B */
+	deliverMessage(&shadowB, DELTA_TOPIC_B, "{\"state\":{\"level\":3},\"version\":2}");
+	CHECK_EQUAL_C_INT(7, valueA);
+	CHECK_EQUAL_C_INT(3, valueB);
+	CHECK_EQUAL_C_INT(2, aws_iot_shadow_client_get_last_received_version(&shadowB));
+
+	IOT_DEBUG("-->Success - delta only reaches its context \n");
+}
+
+TEST_C(ShadowClientTests, AckOnlyReachesItsContext) {
+	IoT_Publish_Message_Params subscribeParams;
+	int context = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Client Tests - acknowledgments only reach their context \n");
+
+	subscribeParams.qos = QOS1;
+	subscribeParams.isRetained = 0;
+	subscribeParams.payload = NULL;
+	subscribeParams.payloadLen = 0;
+	ResetTLSBuffer();
+	setTLSRxBufferForDoubleSuback(GET_PUB_TOPIC_A, strlen(GET_PUB_TOPIC_A), QOS1, subscribeParams);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_get(&shadowA, THING_A, actionCallback, &context, 4, false));
+
+	/* B does not know the token, its own yield must not call A's callback */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_yield(&shadowB, 100));
+	CHECK_EQUAL_C_INT(0, ackCount);
+
+	deliverMessage(&shadowA, GET_ACCEPTED_TOPIC_A,
+				   "{\"state\":{},\"version\":9,\"clientToken\":\"" CLIENT_ID_A "-0\"}");
+	CHECK_EQUAL_C_INT(1, ackCount);
+	CHECK_EQUAL_C_INT(SHADOW_ACK_ACCEPTED, ackStatus);
+	CHECK_C(&context == pAckContext);
+	CHECK_EQUAL_C_INT(9, aws_iot_shadow_client_get_last_received_version(&shadowA));
+	CHECK_EQUAL_C_INT(0, aws_iot_shadow_client_get_last_received_version(&shadowB));
+
+	IOT_DEBUG("-->Success - acknowledgments only reach their context \n");
+}
+
+TEST_C(ShadowClientTests, SettingsArePerContext) {
+	jsonStruct_t reported;
+	int32_t level = 1;
+	char document[TEST_JSON_SIZE];
+	uint8_t dirtyCount = 0;
+	uint32_t version;
+
+	IOT_DEBUG("\n-->Running Shadow Client Tests - settings are per context \n");
+
+	initHandler(&reported, "level", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_register_reported(&shadowA, &reported, 0));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_client_mark_reported_dirty(&shadowB, &reported));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(document, TEST_JSON_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_add_reported_dirty(&shadowB, document, TEST_JSON_SIZE,
+																		&dirtyCount));
+	CHECK_EQUAL_C_INT(0, dirtyCount);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_add_reported_dirty(&shadowA, document, TEST_JSON_SIZE,
+																		&dirtyCount));
+	CHECK_EQUAL_C_INT(1, dirtyCount);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_mirror_enable(&shadowA, THING_A, NULL, 0));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_client_mirror_get_version(&shadowA, THING_A, &version));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_client_mirror_disable(&shadowB, THING_A));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_client_mirror_disable(&shadowA, THING_A));
+
+	IOT_DEBUG("-->Success - settings are per context \n");
+}
+
+TEST_C(ShadowClientTests, InvalidParams) {
+	ShadowClient_t uninitialized;
+	jsonStruct_t handler;
+	int32_t value = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Client Tests - invalid parameters \n");
+
+	initHandler(&handler, "level", &value, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_init(NULL, &clientA, NULL));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_yield(NULL, 100));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_register_delta(NULL, &handler));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_get(NULL, THING_A, NULL, NULL, 4, false));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_mirror_enable(NULL, THING_A, NULL, 0));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_register_reported(NULL, &handler, 0));
+
+	memset(&uninitialized, 0, sizeof(uninitialized));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_yield(&uninitialized, 100));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_client_update(&uninitialized, THING_A, "{}", NULL, NULL, 4,
+																	 false));
+
+	IOT_DEBUG("-->Success - invalid parameters \n");
+}
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_coalesce_helper.c
+ * @brief IoT Client Unit Testing - Shadow Update Coalescing Tests Helper
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_shadow_helper.h"
+
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_records.h"
+#include "aws_iot_log.h"
+
+#define UPDATE_PUB_TOPIC AWS_THINGS_TOPIC AWS_IOT_MY_THING_NAME SHADOW_TOPIC UPDATE_TOPIC
+#define TEST_COALESCE_WINDOW_MS 50
+#define TEST_MAX_CALLBACKS 4
+
+static AWS_IoT_Client client;
+static IoT_Client_Connect_Params connectParams;
+static ShadowInitParameters_t shadowInitParams;
+static ShadowConnectParameters_t shadowConnectParams;
+
+static uint8_t callbackCount;
+static Shadow_Ack_Status_t callbackStatus[TEST_MAX_CALLBACKS];
+static void *callbackContext[TEST_MAX_CALLBACKS];
+
+static void actionCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+						   const char *pReceivedJsonDocument, void *pContextData) {
+	IOT_UNUSED(pThingName);
+	IOT_UNUSED(action);
+	IOT_UNUSED(pReceivedJsonDocument);
+
+	if(callbackCount < TEST_MAX_CALLBACKS) {
+		callbackStatus[callbackCount] = status;
+		callbackContext[callbackCount] = pContextData;
+	}
+	callbackCount++;
+}
+
+static void expectUpdateSubscription(void) {
+	IoT_Publish_Message_Params subscribeParams;
+
+	subscribeParams.qos = QOS1;
+	subscribeParams.isRetained = 0;
+	subscribeParams.payload = NULL;
+	subscribeParams.payloadLen = 0;
+	ResetTLSBuffer();
+	setTLSRxBufferForDoubleSuback(UPDATE_PUB_TOPIC, strlen(UPDATE_PUB_TOPIC), QOS1, subscribeParams);
+	LastPublishMessagePayload[0] = '\0';
+	LastPublishMessageTopic[0] = '\0';
+}
+
+static void deliverUpdateAccepted(const char *pClientTokenSuffix) {
+	IoT_Publish_Message_Params params;
+	char acceptedDocument[120];
+
+	snprintf(acceptedDocument, sizeof(acceptedDocument), "{\"state\":{},\"version\":2,\"clientToken\":\"%s-%s\"}",
+			 AWS_IOT_MQTT_CLIENT_ID, pClientTokenSuffix);
+	ResetTLSBuffer();
+	params.payloadLen = strlen(acceptedDocument);
+	params.payload = acceptedDocument;
+	params.qos = QOS0;
+	setTLSRxBufferWithMsgOnSubscribedTopic(UPDATE_ACCEPTED_TOPIC, strlen(UPDATE_ACCEPTED_TOPIC), QOS0, params,
+										   params.payload);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 200));
+}
+
+TEST_GROUP_C_SETUP(ShadowCoalesceTests) {
+	IoT_Error_t ret_val;
+
+	shadowInitParams.pHost = AWS_IOT_MQTT_HOST;
+	shadowInitParams.port = AWS_IOT_MQTT_PORT;
+	shadowInitParams.pClientCRT = AWS_IOT_CERTIFICATE_FILENAME;
+	shadowInitParams.pRootCA = AWS_IOT_ROOT_CA_FILENAME;
+	shadowInitParams.pClientKey = AWS_IOT_PRIVATE_KEY_FILENAME;
+	shadowInitParams.disconnectHandler = NULL;
+	shadowInitParams.enableAutoReconnect = false;
+	ret_val = aws_iot_shadow_init(&client, &shadowInitParams);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	shadowConnectParams.pMyThingName = AWS_IOT_MY_THING_NAME;
+	shadowConnectParams.pMqttClientId = AWS_IOT_MQTT_CLIENT_ID;
+	shadowConnectParams.mqttClientIdLen = (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID);
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	ret_val = aws_iot_shadow_connect(&client, &shadowConnectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	aws_iot_shadow_set_update_coalescing_window(TEST_COALESCE_WINDOW_MS);
+	callbackCount = 0;
+	LastPublishMessagePayload[0] = '\0';
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowCoalesceTests) {
+	IoT_Error_t rc = aws_iot_shadow_disconnect(&client);
+	IOT_UNUSED(rc);
+	aws_iot_shadow_set_update_coalescing_window(SHADOW_COALESCE_WINDOW_MS);
+}
+
+TEST_C(ShadowCoalesceTests, MergesUpdatesWithinWindow) {
+	int first = 1, second = 2, third = 3;
+
+	IOT_DEBUG("\n-->Running Shadow Coalesce Tests - Merges updates within the window \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"button\":1,\"mask\":\"ab\"}}, \"clientToken\":\"app-1\"}",
+			actionCallback, &first, 2, false));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"button\":2},\"desired\":{\"led\":{\"on\":true}}}}",
+			actionCallback, &second, 4, false));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"mask\":\"abcdef\",\"button\":3}}}", actionCallback, &third, 1, false));
+
+	/* Nothing goes out before the window ends */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 10));
+	CHECK_EQUAL_C_STRING("", LastPublishMessagePayload);
+
+	usleep((TEST_COALESCE_WINDOW_MS + 10) * 1000);
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 10));
+	CHECK_EQUAL_C_STRING(UPDATE_PUB_TOPIC, LastPublishMessageTopic);
+	/* The mock only captures the start of publish packets longer than 127 bytes */
+	CHECK_C(0 == strncmp("{\"state\":{\"reported\":{\"button\":3,\"mask\":\"abcdef\"},\"desired\":{\"led\":{\"on\":true}}}",
+						 LastPublishMessagePayload, strlen(LastPublishMessagePayload)));
+	CHECK_C(strlen(LastPublishMessagePayload) > 60);
+	CHECK_EQUAL_C_INT(0, callbackCount);
+
+	/* A single response completes every merged request */
+	deliverUpdateAccepted("0");
+	CHECK_EQUAL_C_INT(3, callbackCount);
+	CHECK_EQUAL_C_INT(SHADOW_ACK_ACCEPTED, callbackStatus[0]);
+	CHECK_EQUAL_C_INT(SHADOW_ACK_ACCEPTED, callbackStatus[2]);
+	CHECK_C(&first == callbackContext[0]);
+	CHECK_C(&second == callbackContext[1]);
+	CHECK_C(&third == callbackContext[2]);
+}
+
+TEST_C(ShadowCoalesceTests, FlushSendsPendingUpdate) {
+	char expectedDocument[200];
+
+	IOT_DEBUG("\n-->Running Shadow Coalesce Tests - Flush sends the pending update \n");
+
+	aws_iot_shadow_set_update_coalescing_window(60000);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"desired\":{\"led\":false}}}", NULL, NULL, 2, false));
+
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_flush_coalesced_updates(&client));
+	snprintf(expectedDocument, sizeof(expectedDocument),
+			 "{\"state\":{\"desired\":{\"led\":false}}, \"clientToken\":\"%s-0\"}", AWS_IOT_MQTT_CLIENT_ID);
+	CHECK_EQUAL_C_STRING(expectedDocument, LastPublishMessagePayload);
+
+	/* Nothing is left to send */
+	LastPublishMessagePayload[0] = '\0';
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_flush_coalesced_updates(&client));
+	CHECK_EQUAL_C_STRING("", LastPublishMessagePayload);
+}
+
+TEST_C(ShadowCoalesceTests, FullUpdateIsSentEarly) {
+	char document[80];
+	int i;
+
+	IOT_DEBUG("\n-->Running Shadow Coalesce Tests - A full update is sent early \n");
+
+	aws_iot_shadow_set_update_coalescing_window(60000);
+	for(i = 0; i < MAX_SHADOW_COALESCED_FIELDS; i++) {
+		snprintf(document, sizeof(document), "{\"state\":{\"reported\":{\"key%d\":%d}}}", i, i);
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME, document, NULL,
+																   NULL, 2, false));
+	}
+	/* Updating a queued key still fits */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"key0\":100}}}", NULL, NULL, 2, false));
+	CHECK_EQUAL_C_STRING("", LastPublishMessagePayload);
+
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"extra\":1}}}", NULL, NULL, 2, false));
+	CHECK_C(NULL != strstr(LastPublishMessagePayload, "{\"state\":{\"reported\":{\"key0\":100,\"key1\":1,"));
+	CHECK_C(NULL == strstr(LastPublishMessagePayload, "extra"));
+
+	/* The new key started the next update */
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_flush_coalesced_updates(&client));
+	CHECK_C(NULL != strstr(LastPublishMessagePayload, "{\"state\":{\"reported\":{\"extra\":1}}"));
+}
+
+TEST_C(ShadowCoalesceTests, VersionedDocumentIsNotMerged) {
+	const char *pVersionedDocument = "{\"state\":{\"reported\":{\"a\":2}},\"version\":7,\"clientToken\":\"app-9\"}";
+	int context = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Coalesce Tests - Versioned documents are not merged \n");
+
+	aws_iot_shadow_set_update_coalescing_window(60000);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"a\":1}}}", actionCallback, &context, 2, true));
+
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME, pVersionedDocument,
+															   NULL, NULL, 2, false));
+	CHECK_EQUAL_C_STRING(pVersionedDocument, LastPublishMessagePayload);
+
+	/* The pending update went out first and is waiting for its response */
+	deliverUpdateAccepted("0");
+	CHECK_EQUAL_C_INT(1, callbackCount);
+	CHECK_C(&context == callbackContext[0]);
+}
+
+static void setAckWaitListFull(bool isFull) {
+	ShadowClient_t *pShadow = getDefaultShadowClient(&client);
+	uint8_t i;
+
+	for(i = 0; i < MAX_ACKS_TO_COMEIN_AT_ANY_GIVEN_TIME; i++) {
+		pShadow->ackWaitList[i].isFree = !isFull;
+	}
+}
+
+TEST_C(ShadowCoalesceTests, FailedEarlySendKeepsPendingUpdate) {
+	const char *pVersionedDocument = "{\"state\":{\"reported\":{\"a\":2}},\"version\":7,\"clientToken\":\"app-9\"}";
+	int context = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Coalesce Tests - A failed early send keeps the pending update \n");
+
+	aws_iot_shadow_set_update_coalescing_window(60000);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+			"{\"state\":{\"reported\":{\"a\":1}}}", actionCallback, &context, 2, false));
+
+	/* The pending update cannot be sent, so the versioned document is not sent before it */
+	setAckWaitListFull(true);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME, pVersionedDocument,
+															   NULL, NULL, 2, false));
+	setAckWaitListFull(false);
+	CHECK_EQUAL_C_STRING("", LastPublishMessagePayload);
+
+	/* The pending update is still queued with its callback */
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_flush_coalesced_updates(&client));
+	CHECK_C(NULL != strstr(LastPublishMessagePayload, "{\"state\":{\"reported\":{\"a\":1}}"));
+	/* The failed send used up client token 0 */
+	deliverUpdateAccepted("1");
+	CHECK_EQUAL_C_INT(1, callbackCount);
+	CHECK_C(&context == callbackContext[0]);
+
+	/* Nothing is pending anymore, so the versioned document goes out right away */
+	expectUpdateSubscription();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME, pVersionedDocument,
+															   NULL, NULL, 2, false));
+	CHECK_EQUAL_C_STRING(pVersionedDocument, LastPublishMessagePayload);
+}
+
+TEST_C(ShadowCoalesceTests, InvalidArguments) {
+	char largeDocument[SHADOW_COALESCED_UPDATE_BUFFER_BYTES + 64];
+	size_t length;
+
+	IOT_DEBUG("\n-->Running Shadow Coalesce Tests - Invalid arguments \n");
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_update_coalesced(NULL, AWS_IOT_MY_THING_NAME, "{}", NULL,
+																		NULL, 2, false));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME, NULL, NULL,
+																		NULL, 2, false));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_ERROR, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME,
+																		 "{\"state\":", NULL, NULL, 2, false));
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, aws_iot_shadow_update_coalesced(&client,
+			"a-thing-name-that-is-longer-than-the-limit", "{}", NULL, NULL, 2, false));
+
+	length = (size_t) snprintf(largeDocument, sizeof(largeDocument), "{\"state\":{\"reported\":{\"big\":\"");
+	memset(largeDocument + length, 'x', SHADOW_COALESCED_UPDATE_BUFFER_BYTES);
+	snprintf(largeDocument + length + SHADOW_COALESCED_UPDATE_BUFFER_BYTES, 8, "\"}}}");
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, aws_iot_shadow_update_coalesced(&client, AWS_IOT_MY_THING_NAME, largeDocument,
+																	  NULL, NULL, 2, false));
+}
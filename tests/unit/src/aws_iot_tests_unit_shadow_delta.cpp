@@ -30,4 +30,5 @@ TEST_GROUP_C_WRAPPER(ShadowDeltaTest, registerDeltaSuccess)
 TEST_GROUP_C_WRAPPER(ShadowDeltaTest, registerDeltaInt)
 TEST_GROUP_C_WRAPPER(ShadowDeltaTest, registerDeltaIntNoCallback)
 TEST_GROUP_C_WRAPPER(ShadowDeltaTest, DeltaNestedObject)
+TEST_GROUP_C_WRAPPER(ShadowDeltaTest, DeltaNestedPath)
 TEST_GROUP_C_WRAPPER(ShadowDeltaTest, DeltaVersionIgnoreOldVersion)
@@ -207,6 +207,71 @@ TEST_C(ShadowDeltaTest, DeltaNestedObject) {
 }
 
 
+static uint8_t pathCallbackCount = 0;
+
+void pathCallback(const char *pJsonStringData, uint32_t JsonStringDataLen, jsonStruct_t *pContext) {
+	printf("\nkey[%s]==Data[%.*s]\n", pContext->pKey, JsonStringDataLen, pJsonStringData);
+	pathCallbackCount++;
+}
+
+TEST_C(ShadowDeltaTest, DeltaNestedPath) {
+	IoT_Error_t ret_val = SUCCESS;
+	IoT_Publish_Message_Params params;
+	jsonStruct_t colorHandler, levelHandler, missingHandler;
+	char color[10] = "";
+	int32_t level = 0;
+	int32_t missing = -1;
+	char deltaJSONString[] = "{\"state\":{\"color\":\"blue\",\"config\":{\"led\":{\"color\":\"red\",\"level\":4}}},"
+		"\"version\":1}";
+
+	printf("\n-->Running Shadow Delta Tests - Delta received on nested paths \n");
+
+	colorHandler.cb = pathCallback;
+	colorHandler.pKey = "config.led.color";
+	colorHandler.type = SHADOW_JSON_STRING;
+	colorHandler.pData = color;
+	colorHandler.dataLength = sizeof(color);
+
+	levelHandler.cb = pathCallback;
+	levelHandler.pKey = "config.led.level";
+	levelHandler.type = SHADOW_JSON_INT32;
+	levelHandler.pData = &level;
+	levelHandler.dataLength = sizeof(int32_t);
+
+	missingHandler.cb = pathCallback;
+	missingHandler.pKey = "config.fan.level";
+	missingHandler.type = SHADOW_JSON_INT32;
+	missingHandler.pData = &missing;
+	missingHandler.dataLength = sizeof(int32_t);
+
+	params.payloadLen = strlen(deltaJSONString);
+	params.payload = deltaJSONString;
+	params.qos = QOS0;
+
+	ResetTLSBuffer();
+	setTLSRxBufferForSuback(shadowDeltaTopic, strlen(shadowDeltaTopic), QOS0, params);
+
+	ret_val = aws_iot_shadow_register_delta(&client, &colorHandler);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+	ret_val = aws_iot_shadow_register_delta(&client, &levelHandler);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+	ret_val = aws_iot_shadow_register_delta(&client, &missingHandler);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	pathCallbackCount = 0;
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(shadowDeltaTopic, strlen(shadowDeltaTopic), QOS0, params, params.payload);
+
+	ret_val = aws_iot_shadow_yield(&client, 3000);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	// The top level "color" is not the one registered
+	CHECK_EQUAL_C_STRING("red", color);
+	CHECK_EQUAL_C_INT(4, level);
+	CHECK_EQUAL_C_INT(-1, missing);
+	CHECK_EQUAL_C_INT(2, pathCallbackCount);
+}
+
 // Send back to back version and ensure a wrong version is ignored with old message enabled
 TEST_C(ShadowDeltaTest, DeltaVersionIgnoreOldVersion) {
 	IoT_Error_t ret_val = SUCCESS;
@@ -77,7 +77,7 @@ TEST_GROUP_C_TEARDOWN(ShadowJsonBuilderTests) {
 	IOT_UNUSED(rc);
 }
 
-#define TEST_JSON_RESPONSE_UPDATE_DOCUMENT "{\"state\":{\"reported\":{\"doubleData\":4.090800,\"floatData\":3.445000}}, \"clientToken\":\"" AWS_IOT_MQTT_CLIENT_ID "-0\"}"
+#define TEST_JSON_RESPONSE_UPDATE_DOCUMENT "{\"state\":{\"reported\":{\"doubleData\":4.090799808502197,\"floatData\":3.445}}, \"clientToken\":\"" AWS_IOT_MQTT_CLIENT_ID "-0\"}"
 
 #define SIZE_OF_UPFATE_BUF 200
 
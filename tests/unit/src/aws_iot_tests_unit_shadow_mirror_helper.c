@@ -0,0 +1,349 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_mirror_helper.c
+ * @brief IoT Client Unit Testing - Shadow Mirror Tests Helper
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_shadow_helper.h"
+
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_actions.h"
+#include "aws_iot_shadow_json.h"
+#include "aws_iot_log.h"
+#include "snapshot_storage_interface.h"
+
+#define TEST_JSON_SIZE 120
+#define TEST_SNAPSHOT_FILE "aws_iot_tests_unit_shadow_mirror.json"
+#define DELTA_TOPIC AWS_THINGS_TOPIC AWS_IOT_MY_THING_NAME SHADOW_TOPIC UPDATE_TOPIC "/delta"
+#define TEST_JSON_RESPONSE_GET_DOCUMENT "{\"state\":{\"desired\":{\"led\":{\"on\":true,\"color\":\"blue\"}},\"reported\":{\"temperature\":21.5,\"led\":{\"on\":false}}},\"metadata\":{\"reported\":{\"temperature\":{\"timestamp\":1}}},\"version\":3,\"clientToken\":\"" AWS_IOT_MQTT_CLIENT_ID "-0\"}"
+
+static AWS_IoT_Client client;
+static IoT_Client_Connect_Params connectParams;
+static ShadowInitParameters_t shadowInitParams;
+static ShadowConnectParameters_t shadowConnectParams;
+
+static bool isDeltaRegistered;
+static bool deltaData;
+static jsonStruct_t deltaHandler;
+
+static void actionCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+						   const char *pReceivedJsonDocument, void *pContextData) {
+	IOT_UNUSED(pThingName);
+	IOT_UNUSED(action);
+	IOT_UNUSED(status);
+	IOT_UNUSED(pReceivedJsonDocument);
+	IOT_UNUSED(pContextData);
+}
+
+static void initHandler(jsonStruct_t *pHandler, const char *pKey, void *pData, size_t dataLength,
+						JsonPrimitiveType type) {
+	pHandler->cb = NULL;
+	pHandler->pKey = pKey;
+	pHandler->pData = pData;
+	pHandler->dataLength = dataLength;
+	pHandler->type = type;
+}
+
+static void deliverMessage(const char *pTopic, const char *pDocument) {
+	IoT_Publish_Message_Params params;
+
+	ResetTLSBuffer();
+	params.payloadLen = strlen(pDocument);
+	params.payload = (void *) pDocument;
+	params.qos = QOS0;
+	setTLSRxBufferWithMsgOnSubscribedTopic((char *) pTopic, strlen(pTopic), QOS0, params, params.payload);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 200));
+}
+
+static void deliverDelta(const char *pDocument) {
+	IoT_Publish_Message_Params params;
+
+	if(!isDeltaRegistered) {
+		params.qos = QOS0;
+		params.isRetained = 0;
+		params.payload = NULL;
+		params.payloadLen = 0;
+		ResetTLSBuffer();
+		setTLSRxBufferForSuback(DELTA_TOPIC, strlen(DELTA_TOPIC), QOS0, params);
+		initHandler(&deltaHandler, "unused", &deltaData, sizeof(bool), SHADOW_JSON_BOOL);
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_delta(&client, &deltaHandler));
+		isDeltaRegistered = true;
+	}
+	deliverMessage(DELTA_TOPIC, pDocument);
+}
+
+static void deliverGetAccepted(const char *pAcceptedDocument) {
+	IoT_Publish_Message_Params subscribeParams;
+	char getRequestJson[TEST_JSON_SIZE];
+
+	subscribeParams.qos = QOS1;
+	subscribeParams.isRetained = 0;
+	subscribeParams.payload = NULL;
+	subscribeParams.payloadLen = 0;
+	ResetTLSBuffer();
+	setTLSRxBufferForPuback();
+	setTLSRxBufferForDoubleSuback(GET_PUB_TOPIC, strlen(GET_PUB_TOPIC), QOS1, subscribeParams);
+
+	aws_iot_shadow_internal_get_request_json(getRequestJson, TEST_JSON_SIZE);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_internal_action(AWS_IOT_MY_THING_NAME, SHADOW_GET, getRequestJson,
+															   strlen(getRequestJson), actionCallback, NULL, 4,
+															   false));
+	deliverMessage(GET_ACCEPTED_TOPIC, pAcceptedDocument);
+}
+
+static void initShadow(void) {
+	shadowInitParams.pHost = AWS_IOT_MQTT_HOST;
+	shadowInitParams.port = AWS_IOT_MQTT_PORT;
+	shadowInitParams.pClientCRT = AWS_IOT_CERTIFICATE_FILENAME;
+	shadowInitParams.pRootCA = AWS_IOT_ROOT_CA_FILENAME;
+	shadowInitParams.pClientKey = AWS_IOT_PRIVATE_KEY_FILENAME;
+	shadowInitParams.disconnectHandler = NULL;
+	shadowInitParams.enableAutoReconnect = false;
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init(&client, &shadowInitParams));
+}
+
+TEST_GROUP_C_SETUP(ShadowMirrorTests) {
+	remove(TEST_SNAPSHOT_FILE);
+	initShadow();
+
+	shadowConnectParams.pMyThingName = AWS_IOT_MY_THING_NAME;
+	shadowConnectParams.pMqttClientId = AWS_IOT_MQTT_CLIENT_ID;
+	shadowConnectParams.mqttClientIdLen = (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID);
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_connect(&client, &shadowConnectParams));
+
+	isDeltaRegistered = false;
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowMirrorTests) {
+	IoT_Error_t rc = aws_iot_shadow_disconnect(&client);
+	IOT_UNUSED(rc);
+	aws_iot_shadow_enable_discard_old_delta_msgs();
+	remove(TEST_SNAPSHOT_FILE);
+}
+
+TEST_C(ShadowMirrorTests, GetAcceptedReplacesMirror) {
+	jsonStruct_t field;
+	bool on = false;
+	char color[10];
+	float temperature = 0;
+	uint32_t version = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - get/accepted replaces the mirror \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, NULL, 0));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, &version));
+
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, &version));
+	CHECK_EQUAL_C_INT(3, version);
+
+	initHandler(&field, "led.on", &on, sizeof(bool), SHADOW_JSON_BOOL);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(true, on);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_REPORTED, &field));
+	CHECK_EQUAL_C_INT(false, on);
+
+	initHandler(&field, "led.color", color, sizeof(color), SHADOW_JSON_STRING);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_STRING("blue", color);
+
+	initHandler(&field, "temperature", &temperature, sizeof(float), SHADOW_JSON_FLOAT);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_REPORTED,
+															   &field));
+	CHECK_EQUAL_C_REAL(21.5, temperature, 0.0001);
+
+	/* Metadata and the objects themselves are not mirrored */
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	initHandler(&field, "led", color, sizeof(color), SHADOW_JSON_OBJECT);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+}
+
+TEST_C(ShadowMirrorTests, DeltaMergesIntoDesired) {
+	jsonStruct_t field;
+	int32_t level = 0;
+	char list[16];
+	uint32_t version = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - Delta merges into desired \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, NULL, 0));
+
+	deliverDelta("{\"version\":5,\"timestamp\":1,\"state\":{\"fan\":{\"level\":2},\"list\":[1,2]}}");
+	initHandler(&field, "fan.level", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(2, level);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_REPORTED,
+															   &field));
+	initHandler(&field, "list", list, sizeof(list), SHADOW_JSON_OBJECT);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_STRING("[1,2]", list);
+
+	/* A partial document alone does not make the mirror complete */
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, &version));
+
+	/* A leaf replacing an object drops the values inside it, null removes */
+	deliverDelta("{\"version\":6,\"state\":{\"fan\":7,\"list\":null}}");
+	initHandler(&field, "fan", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(7, level);
+	initHandler(&field, "fan.level", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	initHandler(&field, "list", list, sizeof(list), SHADOW_JSON_OBJECT);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+}
+
+TEST_C(ShadowMirrorTests, OlderVersionIgnored) {
+	jsonStruct_t field;
+	int32_t level = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - Messages older than the mirror are ignored \n");
+
+	aws_iot_shadow_disable_discard_old_delta_msgs();
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, NULL, 0));
+	initHandler(&field, "level", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+
+	deliverDelta("{\"version\":8,\"state\":{\"level\":3}}");
+	deliverDelta("{\"version\":7,\"state\":{\"level\":1}}");
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(3, level);
+
+	/* The same version is applied, an update and its delta share it */
+	deliverDelta("{\"version\":8,\"state\":{\"level\":4}}");
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(4, level);
+}
+
+TEST_C(ShadowMirrorTests, SnapshotRestoresMirror) {
+	jsonStruct_t field;
+	char mode[10];
+	int32_t level = 0;
+	uint32_t version = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - Snapshot restores the mirror \n");
+
+	/* No snapshot yet, the mirror starts empty */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, TEST_SNAPSHOT_FILE, 60000));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, &version));
+
+	deliverDelta("{\"version\":12,\"state\":{\"fan\":{\"level\":2,\"mode\":\"auto\"}}}");
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_save(AWS_IOT_MY_THING_NAME));
+
+	/* A restarted process loads the snapshot before anything is received */
+	initShadow();
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, &version));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, TEST_SNAPSHOT_FILE, 60000));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, &version));
+	CHECK_EQUAL_C_INT(12, version);
+
+	initHandler(&field, "fan.level", &level, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(2, level);
+	initHandler(&field, "fan.mode", mode, sizeof(mode), SHADOW_JSON_STRING);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_STRING("auto", mode);
+}
+
+TEST_C(ShadowMirrorTests, SnapshotWrittenFromYield) {
+	char snapshot[128];
+	size_t length;
+	FILE *pFile;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - Snapshot written from yield \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, TEST_SNAPSHOT_FILE, 0));
+	deliverDelta("{\"version\":2,\"state\":{\"on\":true}}");
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 10));
+
+	pFile = fopen(TEST_SNAPSHOT_FILE, "rb");
+	CHECK_C(NULL != pFile);
+	length = fread(snapshot, 1, sizeof(snapshot) - 1, pFile);
+	fclose(pFile);
+	snapshot[length] = '\0';
+	CHECK_EQUAL_C_STRING("{\"version\":2,\"desired\":{\"on\":true},\"reported\":{}}", snapshot);
+}
+
+TEST_C(ShadowMirrorTests, SnapshotStorageReplacesSnapshot) {
+	char snapshot[8];
+	size_t length = 0;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - Snapshot storage replaces the snapshot \n");
+
+	remove(TEST_SNAPSHOT_FILE);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_snapshot_storage_read(TEST_SNAPSHOT_FILE, snapshot, sizeof(snapshot),
+															 &length));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_snapshot_storage_write(TEST_SNAPSHOT_FILE, "{\"a\":1}", 7));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_snapshot_storage_write(TEST_SNAPSHOT_FILE, "{}", 2));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_snapshot_storage_read(TEST_SNAPSHOT_FILE, snapshot, sizeof(snapshot), &length));
+	CHECK_EQUAL_C_INT(2, length);
+	CHECK_C(0 == memcmp("{}", snapshot, 2));
+	/* The temporary file was renamed */
+	CHECK_C(NULL == fopen(TEST_SNAPSHOT_FILE ".tmp", "rb"));
+
+	/* A snapshot that fills the buffer exactly fits, one byte more is too large */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_snapshot_storage_write(TEST_SNAPSHOT_FILE, "{\"a\":12}", 8));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_snapshot_storage_read(TEST_SNAPSHOT_FILE, snapshot, sizeof(snapshot), &length));
+	CHECK_EQUAL_C_INT(8, length);
+	CHECK_C(0 == memcmp("{\"a\":12}", snapshot, 8));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_snapshot_storage_write(TEST_SNAPSHOT_FILE, "{\"ab\":12}", 9));
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, aws_iot_snapshot_storage_read(TEST_SNAPSHOT_FILE, snapshot, sizeof(snapshot),
+																	&length));
+
+	/* A snapshot that cannot be created is an error */
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_snapshot_storage_write("missing-directory/snapshot.json", "{}", 2));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_snapshot_storage_write(NULL, "{}", 2));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_snapshot_storage_read(TEST_SNAPSHOT_FILE, NULL, 0, &length));
+}
+
+TEST_C(ShadowMirrorTests, InvalidParams) {
+	jsonStruct_t field;
+	uint32_t version;
+	char thingName[8];
+	int32_t value;
+	int i;
+
+	IOT_DEBUG("\n-->Running Shadow Mirror Tests - Invalid parameters \n");
+
+	initHandler(&field, "value", &value, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_mirror_enable(NULL, NULL, 0));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED,
+																		 NULL));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_mirror_get_version(AWS_IOT_MY_THING_NAME, NULL));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_get_field(AWS_IOT_MY_THING_NAME, SHADOW_MIRROR_DESIRED, &field));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_disable(AWS_IOT_MY_THING_NAME));
+
+	/* Without a snapshot file there is nothing to save */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(AWS_IOT_MY_THING_NAME, NULL, 0));
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mirror_save(AWS_IOT_MY_THING_NAME));
+
+	for(i = 1; i < MAX_SHADOW_MIRRORS; i++) {
+		snprintf(thingName, sizeof(thingName), "thing%d", i);
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable(thingName, NULL, 0));
+	}
+	CHECK_EQUAL_C_INT(LIMIT_EXCEEDED_ERROR, aws_iot_shadow_mirror_enable("another", NULL, 0));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_disable(AWS_IOT_MY_THING_NAME));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mirror_enable("another", NULL, 0));
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_reported_cache_helper.c
+ * @brief IoT Client Unit Testing - Shadow Reported State Cache Tests Helper
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_tests_unit_mock_tls_params.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_tests_unit_shadow_helper.h"
+
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_actions.h"
+#include "aws_iot_shadow_json.h"
+#include "aws_iot_log.h"
+
+#define SIZE_OF_UPDATE_DOCUMENT 200
+#define TEST_JSON_SIZE 120
+#define TEST_JSON_RESPONSE_GET_DOCUMENT "{\"state\":{\"desired\":{\"temperature\":30},\"reported\":{\"temperature\":21.5,\"mode\":\"eco\",\"count\":7}},\"metadata\":{\"reported\":{\"count\":{\"timestamp\":1}}},\"version\":3,\"clientToken\":\"" AWS_IOT_MQTT_CLIENT_ID "-0\"}"
+
+static AWS_IoT_Client client;
+static IoT_Client_Connect_Params connectParams;
+static ShadowInitParameters_t shadowInitParams;
+static ShadowConnectParameters_t shadowConnectParams;
+
+static float temperature;
+static char mode[10];
+static int32_t count;
+static jsonStruct_t temperatureHandler;
+static jsonStruct_t modeHandler;
+static jsonStruct_t countHandler;
+static char updateRequestJson[SIZE_OF_UPDATE_DOCUMENT];
+
+static void actionCallback(const char *pThingName, ShadowActions_t action, Shadow_Ack_Status_t status,
+						   const char *pReceivedJsonDocument, void *pContextData) {
+	IOT_UNUSED(pThingName);
+	IOT_UNUSED(action);
+	IOT_UNUSED(status);
+	IOT_UNUSED(pReceivedJsonDocument);
+	IOT_UNUSED(pContextData);
+}
+
+static void initHandler(jsonStruct_t *pHandler, const char *pKey, void *pData, size_t dataLength,
+						JsonPrimitiveType type) {
+	pHandler->cb = NULL;
+	pHandler->pKey = pKey;
+	pHandler->pData = pData;
+	pHandler->dataLength = dataLength;
+	pHandler->type = type;
+}
+
+static void deliverAcceptedDocument(const char *pRequestTopic, ShadowActions_t action, char *pRequestJson,
+									const char *pAcceptedTopic, const char *pAcceptedDocument) {
+	IoT_Publish_Message_Params params;
+	IoT_Publish_Message_Params subscribeParams;
+	IoT_Error_t ret_val;
+
+	subscribeParams.qos = QOS1;
+	subscribeParams.isRetained = 0;
+	subscribeParams.payload = NULL;
+	subscribeParams.payloadLen = 0;
+	ResetTLSBuffer();
+	setTLSRxBufferForPuback();
+	setTLSRxBufferForDoubleSuback((char *) pRequestTopic, strlen(pRequestTopic), QOS1, subscribeParams);
+
+	ret_val = aws_iot_shadow_internal_action(AWS_IOT_MY_THING_NAME, action, pRequestJson, strlen(pRequestJson),
+											 actionCallback, NULL, 4, false);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	ResetTLSBuffer();
+	params.payloadLen = strlen(pAcceptedDocument);
+	params.payload = (void *) pAcceptedDocument;
+	params.qos = QOS0;
+	setTLSRxBufferWithMsgOnSubscribedTopic((char *) pAcceptedTopic, strlen(pAcceptedTopic), QOS0, params,
+										   params.payload);
+	ret_val = aws_iot_shadow_yield(&client, 200);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+}
+
+static void deliverGetAccepted(const char *pAcceptedDocument) {
+	char getRequestJson[TEST_JSON_SIZE];
+
+	aws_iot_shadow_internal_get_request_json(getRequestJson, TEST_JSON_SIZE);
+	deliverAcceptedDocument(GET_PUB_TOPIC, SHADOW_GET, getRequestJson, GET_ACCEPTED_TOPIC, pAcceptedDocument);
+}
+
+static uint8_t buildDirtyDocument(void) {
+	uint8_t dirtyCount = 0;
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_add_reported_dirty(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT,
+																  &dirtyCount));
+	return dirtyCount;
+}
+
+TEST_GROUP_C_SETUP(ShadowReportedCacheTests) {
+	IoT_Error_t ret_val;
+
+	shadowInitParams.pHost = AWS_IOT_MQTT_HOST;
+	shadowInitParams.port = AWS_IOT_MQTT_PORT;
+	shadowInitParams.pClientCRT = AWS_IOT_CERTIFICATE_FILENAME;
+	shadowInitParams.pRootCA = AWS_IOT_ROOT_CA_FILENAME;
+	shadowInitParams.pClientKey = AWS_IOT_PRIVATE_KEY_FILENAME;
+	shadowInitParams.disconnectHandler = NULL;
+	shadowInitParams.enableAutoReconnect = false;
+	ret_val = aws_iot_shadow_init(&client, &shadowInitParams);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	shadowConnectParams.pMyThingName = AWS_IOT_MY_THING_NAME;
+	shadowConnectParams.pMqttClientId = AWS_IOT_MQTT_CLIENT_ID;
+	shadowConnectParams.mqttClientIdLen = (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID);
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	ret_val = aws_iot_shadow_connect(&client, &shadowConnectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	temperature = 21.5f;
+	strcpy(mode, "eco");
+	count = 7;
+	initHandler(&temperatureHandler, "temperature", &temperature, sizeof(float), SHADOW_JSON_FLOAT);
+	initHandler(&modeHandler, "mode", mode, sizeof(mode), SHADOW_JSON_STRING);
+	initHandler(&countHandler, "count", &count, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_reported(&temperatureHandler, 0));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_reported(&modeHandler, 0));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_reported(&countHandler, 0));
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowReportedCacheTests) {
+	IoT_Error_t rc = aws_iot_shadow_disconnect(&client);
+	IOT_UNUSED(rc);
+}
+
+TEST_C(ShadowReportedCacheTests, EverythingDirtyBeforeAck) {
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - Everything dirty before an ack \n");
+
+	CHECK_EQUAL_C_INT(3, buildDirtyDocument());
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"temperature\":21.5,\"mode\":\"eco\",\"count\":7},", updateRequestJson);
+
+	/* Nothing acknowledged yet, so the same keys are reported again */
+	CHECK_EQUAL_C_INT(3, buildDirtyDocument());
+}
+
+TEST_C(ShadowReportedCacheTests, OnlyChangedKeysAfterGetAccepted) {
+	char expectedJson[SIZE_OF_UPDATE_DOCUMENT];
+
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - Only changed keys after get/accepted \n");
+
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+
+	CHECK_EQUAL_C_INT(0, buildDirtyDocument());
+	CHECK_EQUAL_C_STRING("{\"state\":{", updateRequestJson);
+
+	count = 8;
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_finalize_json_document(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT));
+	snprintf(expectedJson, SIZE_OF_UPDATE_DOCUMENT, "{\"state\":{\"reported\":{\"count\":8}}, \"clientToken\":\"%s-1\"}",
+			 AWS_IOT_MQTT_CLIENT_ID);
+	CHECK_EQUAL_C_STRING(expectedJson, updateRequestJson);
+}
+
+TEST_C(ShadowReportedCacheTests, UpdateAcceptedRefreshesCache) {
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - update/accepted refreshes the cache \n");
+
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+
+	strcpy(mode, "boost");
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_finalize_json_document(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT));
+	deliverAcceptedDocument(AWS_THINGS_TOPIC AWS_IOT_MY_THING_NAME SHADOW_TOPIC UPDATE_TOPIC, SHADOW_UPDATE,
+							updateRequestJson, UPDATE_ACCEPTED_TOPIC,
+							"{\"state\":{\"reported\":{\"mode\":\"boost\"}},\"version\":4,\"clientToken\":\""
+							AWS_IOT_MQTT_CLIENT_ID "-1\"}");
+
+	CHECK_EQUAL_C_INT(0, buildDirtyDocument());
+}
+
+TEST_C(ShadowReportedCacheTests, EpsilonSuppressesSmallChanges) {
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - Epsilon suppresses small changes \n");
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_reported(&temperatureHandler, 0.5f));
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+
+	temperature = 21.9f;
+	CHECK_EQUAL_C_INT(0, buildDirtyDocument());
+	temperature = 21.1f;
+	CHECK_EQUAL_C_INT(0, buildDirtyDocument());
+	temperature = 22.25f;
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"temperature\":22.25},", updateRequestJson);
+}
+
+TEST_C(ShadowReportedCacheTests, MarkDirtyForcesKey) {
+	jsonStruct_t unregisteredHandler;
+
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - Marking a key dirty forces it until it is accepted \n");
+
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mark_reported_dirty(&countHandler));
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"count\":7},", updateRequestJson);
+	/* Building the document does not send it, the key stays forced */
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_finalize_json_document(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT));
+	deliverAcceptedDocument(AWS_THINGS_TOPIC AWS_IOT_MY_THING_NAME SHADOW_TOPIC UPDATE_TOPIC, SHADOW_UPDATE,
+							updateRequestJson, UPDATE_ACCEPTED_TOPIC,
+							"{\"state\":{\"reported\":{\"count\":7}},\"version\":4,\"clientToken\":\""
+							AWS_IOT_MQTT_CLIENT_ID "-1\"}");
+	CHECK_EQUAL_C_INT(0, buildDirtyDocument());
+
+	initHandler(&unregisteredHandler, "other", &count, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_mark_reported_dirty(&unregisteredHandler));
+}
+
+TEST_C(ShadowReportedCacheTests, ForcedKeySurvivesRejectedUpdate) {
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - A forced key survives a rejected update \n");
+
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_mark_reported_dirty(&countHandler));
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_finalize_json_document(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT));
+	deliverAcceptedDocument(AWS_THINGS_TOPIC AWS_IOT_MY_THING_NAME SHADOW_TOPIC UPDATE_TOPIC, SHADOW_UPDATE,
+							updateRequestJson, UPDATE_REJECTED_TOPIC,
+							"{\"code\":409,\"message\":\"Version conflict\",\"clientToken\":\""
+							AWS_IOT_MQTT_CLIENT_ID "-1\"}");
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"count\":7},", updateRequestJson);
+
+	/* A get/accepted holding the key refreshes the cache but is no report of the forced value */
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+	CHECK_EQUAL_C_INT(1, buildDirtyDocument());
+}
+
+TEST_C(ShadowReportedCacheTests, ResetReportsEverything) {
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - Reset reports everything \n");
+
+	deliverGetAccepted(TEST_JSON_RESPONSE_GET_DOCUMENT);
+	CHECK_EQUAL_C_INT(0, buildDirtyDocument());
+
+	aws_iot_shadow_reset_reported_cache();
+	CHECK_EQUAL_C_INT(3, buildDirtyDocument());
+}
+
+TEST_C(ShadowReportedCacheTests, RegisterLimits) {
+	jsonStruct_t handlers[MAX_SHADOW_REPORTED_CACHE_ENTRIES];
+	char keys[MAX_SHADOW_REPORTED_CACHE_ENTRIES][8];
+	uint8_t dirtyCount;
+	int i;
+
+	IOT_DEBUG("\n-->Running Shadow Reported Cache Tests - Registration limits \n");
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_register_reported(NULL, 0));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_add_reported_dirty(updateRequestJson, SIZE_OF_UPDATE_DOCUMENT,
+																		   NULL));
+
+	/* Registering the same key again does not take a slot */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_reported(&countHandler, 0));
+	for(i = 0; i < MAX_SHADOW_REPORTED_CACHE_ENTRIES - 3; i++) {
+		snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+		initHandler(&handlers[i], keys[i], &count, sizeof(int32_t), SHADOW_JSON_INT32);
+		CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_reported(&handlers[i], 0));
+	}
+	initHandler(&handlers[i], "full", &count, sizeof(int32_t), SHADOW_JSON_INT32);
+	CHECK_EQUAL_C_INT(FAILURE, aws_iot_shadow_register_reported(&handlers[i], 0));
+
+	/* Too many dirty keys for the buffer */
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(updateRequestJson, 40));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_BUFFER_TRUNCATED, aws_iot_shadow_add_reported_dirty(updateRequestJson, 40,
+																					   &dirtyCount));
+	CHECK_EQUAL_C_INT(0, dirtyCount);
+}
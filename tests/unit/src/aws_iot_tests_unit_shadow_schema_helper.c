@@ -0,0 +1,236 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_schema_helper.c
+ * @brief IoT Client Unit Testing - Shadow Schema Tests helper
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_shadow_interface.h"
+#include "aws_iot_shadow_schema.h"
+#include "aws_iot_tests_unit_helper_functions.h"
+#include "aws_iot_log.h"
+
+#define TEST_THERMOSTAT_SCHEMA(FIELD, STRING_FIELD) \
+	FIELD(temperature, float) \
+	FIELD(setPoint, int32_t) \
+	FIELD(fanSpeed, uint8_t) \
+	FIELD(humidity, double) \
+	FIELD(windowOpen, bool) \
+	STRING_FIELD(mode, 16)
+
+AWS_IOT_SHADOW_SCHEMA_DECLARE(TestThermostat, TEST_THERMOSTAT_SCHEMA)
+AWS_IOT_SHADOW_SCHEMA_DEFINE(TestThermostat, TEST_THERMOSTAT_SCHEMA)
+
+#define SCHEMA_TEST_DOCUMENT_SIZE 256
+#define SCHEMA_TEST_MAX_TOKENS 32
+
+#undef AWS_IOT_MY_THING_NAME
+#define AWS_IOT_MY_THING_NAME "AWS-IoT-C-SDK"
+
+static AWS_IoT_Client client;
+static IoT_Client_Connect_Params connectParams;
+static ShadowInitParameters_t shadowInitParams;
+static ShadowConnectParameters_t shadowConnectParams;
+static char shadowDeltaTopic[MAX_SHADOW_TOPIC_LENGTH_BYTES];
+
+static TestThermostat_t deltaState;
+static uint32_t deltaFields;
+static uint32_t deltaCallbackCount;
+
+static void schemaDeltaCallback(void *pState, uint32_t fields, void *pContext) {
+	CHECK_C(&deltaState == pState);
+	CHECK_C(&deltaCallbackCount == pContext);
+	deltaFields = fields;
+	deltaCallbackCount++;
+}
+
+static uint32_t parseDocument(const char *pJson, TestThermostat_t *pState) {
+	static jsmntok_t tokens[SCHEMA_TEST_MAX_TOKENS];
+	static jsonTapeEntry_t tape[SCHEMA_TEST_MAX_TOKENS];
+	jsmn_parser parser;
+	int tokenCount;
+
+	jsmn_init(&parser);
+	tokenCount = jsmn_parse(&parser, pJson, strlen(pJson), tokens, SCHEMA_TEST_MAX_TOKENS);
+	CHECK_C(0 < tokenCount);
+	buildJsonTape(tokens, tokenCount, tape);
+
+	return TestThermostat_parse(pJson, tokens, tape, 0, pState);
+}
+
+TEST_GROUP_C_SETUP(ShadowSchemaTests) {
+	IoT_Error_t ret_val;
+
+	shadowInitParams.pHost = AWS_IOT_MQTT_HOST;
+	shadowInitParams.port = AWS_IOT_MQTT_PORT;
+	shadowInitParams.pClientCRT = AWS_IOT_CERTIFICATE_FILENAME;
+	shadowInitParams.pRootCA = AWS_IOT_ROOT_CA_FILENAME;
+	shadowInitParams.pClientKey = AWS_IOT_PRIVATE_KEY_FILENAME;
+	shadowInitParams.disconnectHandler = NULL;
+	shadowInitParams.enableAutoReconnect = false;
+	ret_val = aws_iot_shadow_init(&client, &shadowInitParams);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	shadowConnectParams.pMyThingName = AWS_IOT_MY_THING_NAME;
+	shadowConnectParams.pMqttClientId = AWS_IOT_MQTT_CLIENT_ID;
+	shadowConnectParams.mqttClientIdLen = (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID);
+	ConnectMQTTParamsSetup(&connectParams, AWS_IOT_MQTT_CLIENT_ID, (uint16_t) strlen(AWS_IOT_MQTT_CLIENT_ID));
+	setTLSRxBufferForConnack(&connectParams, 0, 0);
+	ret_val = aws_iot_shadow_connect(&client, &shadowConnectParams);
+	CHECK_EQUAL_C_INT(SUCCESS, ret_val);
+
+	snprintf(shadowDeltaTopic, MAX_SHADOW_TOPIC_LENGTH_BYTES, "$aws/things/%s/shadow/update/delta",
+			 AWS_IOT_MY_THING_NAME);
+	memset(&deltaState, 0, sizeof(deltaState));
+	deltaFields = 0;
+	deltaCallbackCount = 0;
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowSchemaTests) {
+}
+
+TEST_C(ShadowSchemaTests, ParsesSchemaFields) {
+	TestThermostat_t state;
+	uint32_t fields;
+
+	IOT_DEBUG("\n-->Running Shadow Schema Tests - Parses schema fields \n");
+
+	memset(&state, 0, sizeof(state));
+	fields = parseDocument("{\"temperature\":21.5,\"nested\":{\"setPoint\":99,\"mode\":\"off\"},\"setPoint\":-4,"
+						   "\"fanSpeed\":300,\"windowOpen\":true,\"mode\":\"eco\",\"humidity\":\"high\","
+						   "\"unknown\":[1,2,3]}", &state);
+
+	CHECK_EQUAL_C_INT(AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, temperature)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, setPoint)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, windowOpen)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, mode), fields);
+	CHECK_EQUAL_C_REAL(21.5, state.temperature, 0.0);
+	CHECK_EQUAL_C_INT(-4, state.setPoint);
+	CHECK_EQUAL_C_INT(0, state.fanSpeed);
+	CHECK_EQUAL_C_INT(true, state.windowOpen);
+	CHECK_EQUAL_C_STRING("eco", state.mode);
+
+	CHECK_EQUAL_C_INT(0, parseDocument("{\"temperatures\":1,\"mod\":\"x\"}", &state));
+	CHECK_EQUAL_C_INT(0, parseDocument("[1,2]", &state));
+}
+
+TEST_C(ShadowSchemaTests, SerializesLikeAddReported) {
+	char schemaDocument[SCHEMA_TEST_DOCUMENT_SIZE];
+	char structDocument[SCHEMA_TEST_DOCUMENT_SIZE];
+	TestThermostat_t state;
+	jsonStruct_t temperature, fanSpeed, windowOpen, mode;
+
+	IOT_DEBUG("\n-->Running Shadow Schema Tests - Serializes like add reported \n");
+
+	state.temperature = 19.25f;
+	state.setPoint = 20;
+	state.fanSpeed = 3;
+	state.humidity = 0.5;
+	state.windowOpen = false;
+	strcpy(state.mode, "say \"hi\"");
+
+	temperature.pKey = "temperature";
+	temperature.pData = &state.temperature;
+	temperature.type = SHADOW_JSON_FLOAT;
+	fanSpeed.pKey = "fanSpeed";
+	fanSpeed.pData = &state.fanSpeed;
+	fanSpeed.type = SHADOW_JSON_UINT8;
+	windowOpen.pKey = "windowOpen";
+	windowOpen.pData = &state.windowOpen;
+	windowOpen.type = SHADOW_JSON_BOOL;
+	mode.pKey = "mode";
+	mode.pData = state.mode;
+	mode.type = SHADOW_JSON_STRING;
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(schemaDocument, SCHEMA_TEST_DOCUMENT_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, TestThermostat_add_reported(schemaDocument, SCHEMA_TEST_DOCUMENT_SIZE, &state,
+					  AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, temperature)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, fanSpeed)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, windowOpen)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, mode)));
+	CHECK_EQUAL_C_INT(SUCCESS, TestThermostat_add_desired(schemaDocument, SCHEMA_TEST_DOCUMENT_SIZE, &state,
+					  AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, mode)));
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(structDocument, SCHEMA_TEST_DOCUMENT_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_add_reported(structDocument, SCHEMA_TEST_DOCUMENT_SIZE, 4, &temperature,
+					  &fanSpeed, &windowOpen, &mode));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_add_desired(structDocument, SCHEMA_TEST_DOCUMENT_SIZE, 1, &mode));
+
+	CHECK_EQUAL_C_STRING(structDocument, schemaDocument);
+
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(schemaDocument, SCHEMA_TEST_DOCUMENT_SIZE));
+	CHECK_EQUAL_C_INT(SUCCESS, TestThermostat_add_reported(schemaDocument, SCHEMA_TEST_DOCUMENT_SIZE, &state,
+					  AWS_IOT_SHADOW_SCHEMA_ALL_FIELDS));
+	CHECK_EQUAL_C_STRING("{\"state\":{\"reported\":{\"temperature\":19.25,\"setPoint\":20,\"fanSpeed\":3,"
+						 "\"humidity\":0.5,\"windowOpen\":false,\"mode\":\"say \\\"hi\\\"\"},", schemaDocument);
+}
+
+TEST_C(ShadowSchemaTests, SerializeTruncated) {
+	char document[24];
+	TestThermostat_t state;
+
+	IOT_DEBUG("\n-->Running Shadow Schema Tests - Serialize truncated \n");
+
+	memset(&state, 0, sizeof(state));
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_init_json_document(document, sizeof(document)));
+	CHECK_EQUAL_C_INT(SHADOW_JSON_BUFFER_TRUNCATED, TestThermostat_add_reported(document, sizeof(document), &state,
+					  AWS_IOT_SHADOW_SCHEMA_ALL_FIELDS));
+}
+
+TEST_C(ShadowSchemaTests, DeltaUpdatesSchemaState) {
+	char deltaJSONString[] = "{\"state\":{\"setPoint\":22,\"mode\":\"away\",\"other\":{\"setPoint\":1}},"
+							 "\"version\":3}";
+	ShadowSchemaDelta_t schemaDelta = AWS_IOT_SHADOW_SCHEMA_DELTA_INIT(TestThermostat, &deltaState,
+																	   schemaDeltaCallback, &deltaCallbackCount);
+	IoT_Publish_Message_Params params;
+
+	IOT_DEBUG("\n-->Running Shadow Schema Tests - Delta updates schema state \n");
+
+	params.payloadLen = strlen(deltaJSONString);
+	params.payload = deltaJSONString;
+	params.qos = QOS0;
+
+	ResetTLSBuffer();
+	setTLSRxBufferForSuback(shadowDeltaTopic, strlen(shadowDeltaTopic), QOS0, params);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_register_delta_schema(&client, &schemaDelta));
+
+	ResetTLSBuffer();
+	setTLSRxBufferWithMsgOnSubscribedTopic(shadowDeltaTopic, strlen(shadowDeltaTopic), QOS0, params, params.payload);
+	CHECK_EQUAL_C_INT(SUCCESS, aws_iot_shadow_yield(&client, 3000));
+
+	CHECK_EQUAL_C_INT(1, deltaCallbackCount);
+	CHECK_EQUAL_C_INT(AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, setPoint)
+					  | AWS_IOT_SHADOW_SCHEMA_FIELD(TestThermostat, mode), deltaFields);
+	CHECK_EQUAL_C_INT(22, deltaState.setPoint);
+	CHECK_EQUAL_C_STRING("away", deltaState.mode);
+}
+
+TEST_C(ShadowSchemaTests, InvalidParams) {
+	ShadowSchemaDelta_t schemaDelta = AWS_IOT_SHADOW_SCHEMA_DELTA_INIT(TestThermostat, NULL, NULL, NULL);
+	char document[SCHEMA_TEST_DOCUMENT_SIZE];
+
+	IOT_DEBUG("\n-->Running Shadow Schema Tests - Invalid params \n");
+
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_register_delta_schema(&client, NULL));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, aws_iot_shadow_register_delta_schema(&client, &schemaDelta));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, TestThermostat_add_reported(document, sizeof(document), NULL, 0));
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, TestThermostat_add_reported(NULL, sizeof(document), &deltaState, 0));
+	CHECK_EQUAL_C_INT(0, TestThermostat_parse(NULL, NULL, NULL, 0, &deltaState));
+}
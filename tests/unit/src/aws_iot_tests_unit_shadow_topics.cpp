@@ -0,0 +1,32 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_topics.cpp
+ * @brief IoT Client Unit Testing - Shadow Topic Table Tests
+ */
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness_c.h>
+
+TEST_GROUP_C(ShadowTopicsTests) {
+	TEST_GROUP_C_SETUP_WRAPPER(ShadowTopicsTests)
+	TEST_GROUP_C_TEARDOWN_WRAPPER(ShadowTopicsTests)
+};
+
+TEST_GROUP_C_WRAPPER(ShadowTopicsTests, BuildsAllTopicsOfThing)
+TEST_GROUP_C_WRAPPER(ShadowTopicsTests, ReusesTableOfKnownThing)
+TEST_GROUP_C_WRAPPER(ShadowTopicsTests, RotatesTablesOfOtherThings)
+TEST_GROUP_C_WRAPPER(ShadowTopicsTests, RejectsTooLongThingName)
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2010-2015 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file aws_iot_tests_unit_shadow_topics_helper.c
+ * @brief IoT Client Unit Testing - Shadow Topic Table Tests Helper
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <CppUTest/TestHarness_c.h>
+
+#include "aws_iot_shadow_actions.h"
+#include "aws_iot_shadow_topics.h"
+#include "aws_iot_log.h"
+
+static ShadowClient_t shadowClient;
+
+static void checkTopic(const ShadowTopicTable_t *pTable, ShadowActions_t action, ShadowAckTopicTypes_t ackType,
+					   const char *pExpected) {
+	const char *pTopic;
+	uint16_t length;
+
+	pTopic = getShadowTopic(pTable, action, ackType, &length);
+	CHECK_EQUAL_C_INT(strlen(pExpected), length);
+	CHECK_C(0 == strncmp(pExpected, pTopic, length));
+}
+
+TEST_GROUP_C_SETUP(ShadowTopicsTests) {
+	memset(&shadowClient, 0, sizeof(shadowClient));
+	initShadowTopicTables(&shadowClient);
+}
+
+TEST_GROUP_C_TEARDOWN(ShadowTopicsTests) {
+}
+
+TEST_C(ShadowTopicsTests, BuildsAllTopicsOfThing) {
+	const ShadowTopicTable_t *pTable;
+	const char *pTopic;
+	uint16_t length;
+
+	IOT_DEBUG("-->Running Shadow Topics Tests - Builds All Topics Of Thing \n");
+
+	pTable = getShadowTopicTable(&shadowClient, "lamp");
+	CHECK_C(NULL != pTable);
+
+	checkTopic(pTable, SHADOW_GET, SHADOW_ACCEPTED, "$aws/things/lamp/shadow/get/accepted");
+	checkTopic(pTable, SHADOW_GET, SHADOW_REJECTED, "$aws/things/lamp/shadow/get/rejected");
+	checkTopic(pTable, SHADOW_GET, SHADOW_ACTION, "$aws/things/lamp/shadow/get");
+	checkTopic(pTable, SHADOW_UPDATE, SHADOW_ACCEPTED, "$aws/things/lamp/shadow/update/accepted");
+	checkTopic(pTable, SHADOW_UPDATE, SHADOW_REJECTED, "$aws/things/lamp/shadow/update/rejected");
+	checkTopic(pTable, SHADOW_UPDATE, SHADOW_ACTION, "$aws/things/lamp/shadow/update");
+	checkTopic(pTable, SHADOW_DELETE, SHADOW_ACCEPTED, "$aws/things/lamp/shadow/delete/accepted");
+	checkTopic(pTable, SHADOW_DELETE, SHADOW_REJECTED, "$aws/things/lamp/shadow/delete/rejected");
+	checkTopic(pTable, SHADOW_DELETE, SHADOW_ACTION, "$aws/things/lamp/shadow/delete");
+
+	pTopic = getShadowDeltaTopic(pTable, &length);
+	CHECK_EQUAL_C_STRING("$aws/things/lamp/shadow/update/delta", pTopic);
+	CHECK_EQUAL_C_INT(strlen("$aws/things/lamp/shadow/update/delta"), length);
+
+	/* Accepted and rejected topics are NUL terminated, for the subscription list and unsubscribe */
+	pTopic = getShadowTopic(pTable, SHADOW_UPDATE, SHADOW_REJECTED, &length);
+	CHECK_EQUAL_C_STRING("$aws/things/lamp/shadow/update/rejected", pTopic);
+
+	IOT_DEBUG("-->Success - Builds All Topics Of Thing \n");
+}
+
+TEST_C(ShadowTopicsTests, ReusesTableOfKnownThing) {
+	const ShadowTopicTable_t *pFirst;
+	const ShadowTopicTable_t *pOther;
+
+	IOT_DEBUG("-->Running Shadow Topics Tests - Reuses Table Of Known Thing \n");
+
+	pFirst = getShadowTopicTable(&shadowClient, "lamp");
+	pOther = getShadowTopicTable(&shadowClient, "fan");
+	CHECK_C(NULL != pFirst);
+	CHECK_C(NULL != pOther);
+	CHECK_C(pFirst != pOther);
+	CHECK_C(pFirst == getShadowTopicTable(&shadowClient, "lamp"));
+	CHECK_C(pOther == getShadowTopicTable(&shadowClient, "fan"));
+	CHECK_EQUAL_C_INT(1, shadowClient.nextTopicTable);
+
+	IOT_DEBUG("-->Success - Reuses Table Of Known Thing \n");
+}
+
+TEST_C(ShadowTopicsTests, RotatesTablesOfOtherThings) {
+	const ShadowTopicTable_t *pMine;
+	const ShadowTopicTable_t *pTable;
+	char thingName[16];
+	uint8_t i;
+
+	IOT_DEBUG("-->Running Shadow Topics Tests - Rotates Tables Of Other Things \n");
+
+	pMine = getShadowTopicTable(&shadowClient, "mine");
+	CHECK_C(&shadowClient.topicTables[0] == pMine);
+
+	for(i = 0; i < 2 * MAX_SHADOW_TOPIC_TABLES; i++) {
+		snprintf(thingName, sizeof(thingName), "thing%u", (unsigned) i);
+		pTable = getShadowTopicTable(&shadowClient, thingName);
+		CHECK_C(NULL != pTable);
+		CHECK_C(pMine != pTable);
+		CHECK_EQUAL_C_STRING(thingName, pTable->thingName);
+	}
+
+	/* The table of the client thing is never taken over */
+	CHECK_C(pMine == getShadowTopicTable(&shadowClient, "mine"));
+	checkTopic(pMine, SHADOW_GET, SHADOW_ACTION, "$aws/things/mine/shadow/get");
+
+	IOT_DEBUG("-->Success - Rotates Tables Of Other Things \n");
+}
+
+TEST_C(ShadowTopicsTests, RejectsTooLongThingName) {
+	char thingName[MAX_SIZE_OF_THING_NAME + 1];
+	IoT_Error_t ret_val;
+
+	IOT_DEBUG("-->Running Shadow Topics Tests - Rejects Too Long Thing Name \n");
+
+	memset(thingName, 'a', MAX_SIZE_OF_THING_NAME);
+	thingName[MAX_SIZE_OF_THING_NAME] = '\0';
+	CHECK_C(NULL == getShadowTopicTable(&shadowClient, thingName));
+
+	ret_val = aws_iot_shadow_internal_client_action(&shadowClient, thingName, SHADOW_GET, "{}", 2, NULL, NULL, 4,
+													false);
+	CHECK_EQUAL_C_INT(MAX_SIZE_ERROR, ret_val);
+
+	thingName[MAX_SIZE_OF_THING_NAME - 1] = '\0';
+	CHECK_C(NULL != getShadowTopicTable(&shadowClient, thingName));
+
+	IOT_DEBUG("-->Success - Rejects Too Long Thing Name \n");
+}
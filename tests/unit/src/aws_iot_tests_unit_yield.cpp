@@ -52,3 +52,10 @@ TEST_GROUP_C_WRAPPER(YieldTests, disconnectAutoReconnectSuccess)
 TEST_GROUP_C_WRAPPER(YieldTests, disconnectManualAutoReconnect)
 /* G:12 - Yield, resubscribe to all topics on reconnect */
 TEST_GROUP_C_WRAPPER(YieldTests, resubscribeSuccessfulReconnect)
+
+/* G:13 - Wakeup with Null/empty Client Instance */
+TEST_GROUP_C_WRAPPER(YieldTests, NullClientWakeup)
+/* G:14 - Wakeup ends a long yield after the pending message is handled */
+TEST_GROUP_C_WRAPPER(YieldTests, WakeupEndsYieldEarly)
+/* G:15 - A wakeup ends only one yield */
+TEST_GROUP_C_WRAPPER(YieldTests, WakeupEndsOneYield)
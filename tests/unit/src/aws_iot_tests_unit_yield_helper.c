@@ -450,3 +450,74 @@ TEST_C(YieldTests, resubscribeSuccessfulReconnect) {
 
 	IOT_DEBUG("-->Success - G:12 - Yield, resubscribe to all topics on reconnect \n");
 }
+
+/* G:13 - Wakeup with Null/empty Client Instance */
+TEST_C(YieldTests, NullClientWakeup) {
+	IoT_Error_t rc = aws_iot_mqtt_wakeup(NULL);
+	CHECK_EQUAL_C_INT(NULL_VALUE_ERROR, rc);
+}
+
+/* G:14 - Wakeup ends a long yield after the pending message is handled */
+TEST_C(YieldTests, WakeupEndsYieldEarly) {
+	IoT_Error_t rc;
+	char cPayload[100];
+	char expectedCallbackString[100];
+	uint64_t yieldStartNs;
+
+	IOT_DEBUG("-->Running Yield Tests - G:14 - Wakeup ends a long yield after the pending message is handled \n");
+
+	testPubMsgParams.qos = QOS1;
+	testPubMsgParams.isRetained = 0;
+	snprintf(cPayload, 100, "%s : %d ", "hello from SDK", 0);
+	testPubMsgParams.payload = (void *) cPayload;
+	testPubMsgParams.payloadLen = strlen(cPayload);
+
+	setTLSRxBufferForSuback(subTopic, subTopicLen, QOS1, testPubMsgParams);
+	rc = aws_iot_mqtt_subscribe(&iotClient, subTopic, subTopicLen, QOS0, iot_tests_unit_acr_subscribe_callback_handler,
+								NULL);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	ResetTLSBuffer();
+	snprintf(CallbackMsgString, 100, "NOT_VISITED");
+	snprintf(expectedCallbackString, 100, "Message for %s", subTopic);
+	setTLSRxBufferWithMsgOnSubscribedTopic(subTopic, subTopicLen, QOS1, testPubMsgParams, expectedCallbackString);
+
+	tlsWakeupCount = 0;
+	rc = aws_iot_mqtt_wakeup(&iotClient);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_EQUAL_C_INT(1, tlsWakeupCount);
+
+	yieldStartNs = get_monotonic_time_ns();
+	rc = aws_iot_mqtt_yield(&iotClient, 5000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_C(get_monotonic_time_ns() - yieldStartNs < 1000000000ULL);
+	CHECK_EQUAL_C_STRING(expectedCallbackString, CallbackMsgString);
+	CHECK_EQUAL_C_INT(CLIENT_STATE_CONNECTED_IDLE, aws_iot_mqtt_get_client_state(&iotClient));
+
+	IOT_DEBUG("-->Success - G:14 - Wakeup ends a long yield after the pending message is handled \n");
+}
+
+/* G:15 - A wakeup ends only one yield */
+TEST_C(YieldTests, WakeupEndsOneYield) {
+	IoT_Error_t rc;
+	uint64_t yieldStartNs;
+
+	IOT_DEBUG("-->Running Yield Tests - G:15 - A wakeup ends only one yield \n");
+
+	rc = aws_iot_mqtt_wakeup(&iotClient);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	rc = aws_iot_mqtt_wakeup(&iotClient);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+
+	yieldStartNs = get_monotonic_time_ns();
+	rc = aws_iot_mqtt_yield(&iotClient, 5000);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_C(get_monotonic_time_ns() - yieldStartNs < 1000000000ULL);
+
+	yieldStartNs = get_monotonic_time_ns();
+	rc = aws_iot_mqtt_yield(&iotClient, 200);
+	CHECK_EQUAL_C_INT(SUCCESS, rc);
+	CHECK_C(get_monotonic_time_ns() - yieldStartNs >= 200000000ULL);
+
+	IOT_DEBUG("-->Success - G:15 - A wakeup ends only one yield \n");
+}
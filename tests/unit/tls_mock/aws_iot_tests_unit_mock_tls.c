@@ -30,6 +30,7 @@ IoT_Error_t iot_tls_init(Network *pNetwork, char *pRootCALocation, char *pDevice
 	pNetwork->disconnect = iot_tls_disconnect;
 	pNetwork->isConnected = iot_tls_is_connected;
 	pNetwork->destroy = iot_tls_destroy;
+	pNetwork->wakeup = iot_tls_wakeup;
 
 	return SUCCESS;
 }
@@ -200,3 +201,14 @@ IoT_Error_t iot_tls_destroy(Network *pNetwork) {
 	IOT_UNUSED(pNetwork);
 	return SUCCESS;
 }
+
+IoT_Error_t iot_tls_wakeup(Network *pNetwork) {
+	IOT_UNUSED(pNetwork);
+	tlsWakeupCount++;
+	return SUCCESS;
+}
+
+IoT_Error_t iot_tls_free(Network *pNetwork) {
+	IOT_UNUSED(pNetwork);
+	return SUCCESS;
+}
@@ -45,3 +45,5 @@ char *invalidRootCAPathFilter;
 char *invalidCertPathFilter;
 char *invalidPrivKeyPathFilter;
 uint16_t invalidPortFilter;
+
+uint32_t tlsWakeupCount;
@@ -68,4 +68,6 @@ extern char *invalidCertPathFilter;
 extern char *invalidPrivKeyPathFilter;
 extern uint16_t invalidPortFilter;
 
+extern uint32_t tlsWakeupCount;
+
 #endif /* UNITTESTS_MOCKS_TLS_PARAMS_H_ */